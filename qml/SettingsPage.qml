@@ -42,6 +42,33 @@ ScrollViewPage {
                 Text {
                     text: "Usable threads: " + jobSettings.idleThreadCount
                 }
+
+                RowLayout {
+                    InformationButton {
+                        showItemOnClick: imageCacheHelpAreaId
+                    }
+
+                    Text {
+                        text: "Image Cache Size (MB)"
+                    }
+
+                    QC.SpinBox {
+                        from: 0
+                        to: 16384
+                        stepSize: 64
+                        editable: true
+                        value: jobSettings.imageCacheSize
+                        onValueChanged: {
+                            jobSettings.imageCacheSize = value;
+                        }
+                    }
+                }
+
+                HelpArea {
+                    id: imageCacheHelpAreaId
+                    Layout.fillWidth: true
+                    text: "The amount of memory CaveWhere uses to keep decoded note images. A larger cache makes loading notes and scraps faster, because images don't need to be decoded again. Setting this to 0 disables the cache."
+                }
             }
         }
 
@@ -75,6 +102,17 @@ ScrollViewPage {
                     }
                 }
 
+                ComboBoxWithInfo {
+                    enabled: renderingSettings.dxt1Algorithm === OpenGLSettings.DXT1_Squish
+                    text: "CPU Compression Quality"
+                    helpText: "The quality of DXT1 compression, when images are compressed on the CPU. Best gives the best image quality, but is the slowest. Balanced and Fast compress images much faster, with slightly lower quality. The default is Best.";
+                    model: renderingSettings.dxt1QualityModel
+                    currentIndex: renderingSettings.dxt1Quality
+                    onCurrentIndexChanged: {
+                        renderingSettings.dxt1Quality = currentIndex
+                    }
+                }
+
                 SupportedCheckLabel {
                     Layout.fillWidth: true
                     text: "Anisotropy"
@@ -14,7 +14,8 @@
 #include "cwDXT1Compresser.h"
 #include "cwAsyncFuture.h"
 #include "cwOpenGLSettings.h"
-#include "cwImageDatabase.h"
+#include "cwImageDatabaseWriter.h"
+#include "cwMipmapPyramid.h"
 
 //For creating compressed DXT texture maps
 #include <squish.h>
@@ -91,8 +92,11 @@ QFuture<cwTrackedImagePtr> cwAddImageTask::images() const
     QString filename = databaseFilename();
     auto imageTypes = ImageTypes;
 
+    //All images are written through a single connection, in batches
+    auto databaseWriter = std::make_shared<cwImageDatabaseWriter>(filename);
+
     std::function<PrivateImageData (const QString&)> loadImagesFromPath
-            = [filename, imageTypes](const QString& imagePath) {
+            = [filename, imageTypes, databaseWriter](const QString& imagePath) {
         //Where the database image ideas are stored
         cwImage image;
 
@@ -100,7 +104,7 @@ QFuture<cwTrackedImagePtr> cwAddImageTask::images() const
         QImage originalImage;
 
         if(imageTypes & Original) {
-            originalImage = copyOriginalImage(imagePath, &image, filename);
+            originalImage = copyOriginalImage(imagePath, &image, databaseWriter.get());
         } else {
             originalImage = QImage(imagePath);
         }
@@ -115,13 +119,13 @@ QFuture<cwTrackedImagePtr> cwAddImageTask::images() const
     };
 
     std::function<PrivateImageData (const QImage&)> loadFromImages
-            = [filename, imageTypes](const QImage& image) {
+            = [filename, imageTypes, databaseWriter](const QImage& image) {
         if(!image.isNull()) {
             //Where the database image ideas are stored
             cwImage imageId;
 
             if(imageTypes & Original) {
-                copyOriginalImage(image, &imageId, filename);
+                copyOriginalImage(image, &imageId, databaseWriter.get());
             }
 
             return PrivateImageData(cwTrackedImage::createShared(imageId, filename),
@@ -149,8 +153,12 @@ QFuture<cwTrackedImagePtr> cwAddImageTask::images() const
 
     //For creating icon from private image data
     std::function<cwTrackedImagePtr (const PrivateImageData&)> createIcon
-            = [filename, imageTypes](const PrivateImageData& imageData) {
-        Q_ASSERT(!imageData.OriginalImage.isNull());
+            = [filename, imageTypes, databaseWriter](const PrivateImageData& imageData) {
+        Q_ASSERT(!imageData.isNull());
+
+        //The icon is the last user of imageData's original, the mipmaps have their own reference.
+        //Taking it releases it as soon as the icon and the first mipmap level are done with it.
+        const QImage originalImage = imageData.takeOriginalImage();
 
         if(!(imageTypes & Icon)) {
             return cwTrackedImage::createShared(-1, filename, cwTrackedImage::NoOwnership);
@@ -161,7 +169,6 @@ QFuture<cwTrackedImagePtr> cwAddImageTask::images() const
                                                 filename,
                                                 cwTrackedImage::NoOwnership);
         }
-        const QImage& originalImage = imageData.OriginalImage;
         QSize scaledSize = QSize(512, 512);
 
         if(originalImage.size().height() <= scaledSize.height() &&
@@ -190,90 +197,87 @@ QFuture<cwTrackedImagePtr> cwAddImageTask::images() const
 
         //Write the data to database
         cwImageData iconImageData(scaledSize, dotMeter, format, jpgData);
-        int imageId = cwImageDatabase(filename).addImage(iconImageData);
+        int imageId = databaseWriter->addImage(iconImageData).result();
         return cwTrackedImage::createShared(imageId, filename);
     };
 
-    struct Mipmap {
-        QImage image;
-        int id;
-    };
-
-    //Scaling images for mipmaps
-    std::function<QList<Mipmap> (const PrivateImageData&)> scaleImage
-            = [](const PrivateImageData& imageData)->QList<Mipmap> {
-        const QImage& originalImage = imageData.OriginalImage;
-
-        QSizeF clipArea;
-        QImage scaledImage = ensureImageDivisibleBy4(originalImage, &clipArea);
-        QList<int> mipmapIds = imageData.Id->mipmaps();
-
-        auto mipmapId = [mipmapIds](int index) {
-            if(index < mipmapIds.size()) {
-                return mipmapIds.at(index);
+    //For creating mipmaps. The levels are created one at a time. Each level is handed to the
+    //compresser as soon as it's ready, and is released once it has been compressed.
+    //
+    //Level 0 is the original image. It's never copied, even if it needs padding, the compresser
+    //and the first reduction read the padding from the edge pixels. createIcon() releases
+    //imageData's reference, so the original is freed once the icon and level 0 are done with it.
+    //Peak memory is about 1.5x the original: the original, level 1 that's created while level 0
+    //is compressed, and the compressed levels.
+    std::function<QFuture<cwTrackedImagePtr> (const PrivateImageData&)> compressAndUpload
+            = [filename, databaseWriter](const PrivateImageData& imageData)->QFuture<cwTrackedImagePtr> {
+
+        class MipmapStream {
+        public:
+            cwMipmapPyramid Pyramid;
+            QList<int> MipmapIds;
+            QList<QFuture<cwDXT1Compresser::CompressedImage>> CompressFutures;
+            AsyncFuture::Deferred<void> LevelsQueued = AsyncFuture::deferred<void>();
+
+            int mipmapId(int index) const {
+                if(index < MipmapIds.size()) {
+                    return MipmapIds.at(index);
+                }
+                return -1;
             }
-            return -1;
         };
 
-        int numberOfLevels = numberOfMipmapLevels(scaledImage.size());
-
-        QSize scaledImageSize = scaledImage.size();
-
-        QList<Mipmap> scaledImages;
+        auto stream = std::make_shared<MipmapStream>();
+        stream->MipmapIds = imageData.Id->mipmaps();
 
-        for(int i = 0; i < numberOfLevels; i++) {
-            //Rescaled the image
-            scaledImage = scaledImage.scaled(scaledImageSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
-            scaledImages.append({scaledImage, mipmapId(i)});
+        //Compresses the current level and then creates the next level in a thread
+        auto queueLevel = std::make_shared<std::function<void ()>>();
+        std::weak_ptr<std::function<void ()>> weakQueueLevel = queueLevel;
+        *queueLevel = [stream, weakQueueLevel]() {
+            cwDXT1Compresser compresser;
+            compresser.setPaddedSize(stream->Pyramid.levelSize());
+            stream->CompressFutures.append(compresser.compress({stream->Pyramid.level()}));
 
-            //Create the new width and height, by halfing them
-            scaledImageSize = half(scaledImageSize);
-        }
-
-        return scaledImages;
-    };
+            if(!stream->Pyramid.hasNextLevel()) {
+                stream->LevelsQueued.complete();
+                return;
+            }
 
-    //For creating mipmaps
-    std::function<QFuture<cwTrackedImagePtr> (const QList<Mipmap>& image)> compressAndUpload
-            = [filename](const QList<Mipmap>& mipmaps)->QFuture<cwTrackedImagePtr> {
+            auto queueLevel = weakQueueLevel.lock();
+            auto nextLevelFuture = QtConcurrent::run([stream]() { stream->Pyramid.nextLevel(); });
+            AsyncFuture::observe(nextLevelFuture).subscribe([queueLevel]() { (*queueLevel)(); });
+        };
 
-        QList<QImage> mipmapImages = cw::transform(mipmaps,
-                                               [](const Mipmap& mipmap)
-        {
-            return mipmap.image;
+        QImage originalImage = imageData.originalImage();
+        auto firstLevelFuture = QtConcurrent::run([stream, originalImage]() {
+            stream->Pyramid.setImage(originalImage, sizeDivisibleBy4(originalImage.size()));
         });
+        AsyncFuture::observe(firstLevelFuture).subscribe([queueLevel]() { (*queueLevel)(); });
 
-        cwDXT1Compresser compresser;
-        auto compressFuture = compresser.compress(mipmapImages);
-
-        return AsyncFuture::observe(compressFuture)
-                .subscribe([compressFuture, mipmaps, filename]()
+        return AsyncFuture::observe(stream->LevelsQueued.future())
+                .subscribe([stream, filename, databaseWriter]()
         {
-            struct CompressedMipmap {
-                cwDXT1Compresser::CompressedImage image;
-                int id;
-            };
-
-            auto compressionResults = compressFuture.results();
-            Q_ASSERT(mipmaps.size() == compressionResults.size());
+            auto compressCombine = AsyncFuture::combine() << stream->CompressFutures;
 
-            auto mipmapIter = mipmaps.begin();
-            QList<CompressedMipmap> mipmaps = cw::transform(compressionResults,
-                                                        [&mipmapIter](const cwDXT1Compresser::CompressedImage& compressedImage)
+            return AsyncFuture::observe(compressCombine.future())
+                    .subscribe([stream, filename, databaseWriter]()
             {
-                CompressedMipmap mipmap = {compressedImage, mipmapIter->id};
-                mipmapIter++;
-                return mipmap;
-            });
-
-            std::function<cwTrackedImagePtr (const CompressedMipmap&)> updateDatabase
-                    = [filename](const CompressedMipmap& mipmap) {
-                cwImageData imageData = cwImageProvider::createDxt1(mipmap.image.size, mipmap.image.data);
-                int imageId = cwImageDatabase(filename).addOrUpdateImage(imageData, mipmap.id);
-                return cwTrackedImage::createShared(imageId, filename);
-            };
+                //Queue all the levels at once, so they're written in the same transaction
+                QList<QFuture<int>> idFutures;
+                idFutures.reserve(stream->CompressFutures.size());
+                for(int i = 0; i < stream->CompressFutures.size(); i++) {
+                    auto compressedImage = stream->CompressFutures.at(i).result();
+                    cwImageData imageData = cwImageProvider::createDxt1(compressedImage.size, compressedImage.data);
+                    idFutures.append(databaseWriter->addOrUpdateImage(imageData, stream->mipmapId(i)));
+                }
+
+                std::function<cwTrackedImagePtr (const QFuture<int>&)> waitForDatabase
+                        = [filename](const QFuture<int>& idFuture) {
+                    return cwTrackedImage::createShared(idFuture.result(), filename);
+                };
 
-            return QtConcurrent::mapped(mipmaps, updateDatabase);
+                return QtConcurrent::mapped(idFutures, waitForDatabase);
+            }).future();
         }).future();
     };
 
@@ -297,7 +301,6 @@ QFuture<cwTrackedImagePtr> cwAddImageTask::images() const
                        imagesFuture,
                        regeneratedFuture,
                        imageTypes,
-                       scaleImage,
                        compressAndUpload,
                        createIcon
                        ]()
@@ -315,29 +318,21 @@ QFuture<cwTrackedImagePtr> cwAddImageTask::images() const
         std::copy_if(imageData.begin(), imageData.end(), std::back_inserter(filterData),
                      [](const PrivateImageData& data)
         {
-            return !data.OriginalImage.isNull();
+            return !data.isNull();
         });
 
         QFuture<QVector<QFuture<cwTrackedImagePtr>>> compressAndUploadFuture = AsyncFuture::completed(QVector<QFuture<cwTrackedImagePtr>>());
 
         if(imageTypes & Mipmaps) {
-            auto scaleFuture = QtConcurrent::mapped(filterData, scaleImage);
-
-            compressAndUploadFuture = AsyncFuture::observe(scaleFuture)
-                    .subscribe([compressAndUpload, scaleFuture]()
-            {
-                QList<QList<Mipmap>> allImages = scaleFuture.results();
-                QVector<QFuture<cwTrackedImagePtr>> ids;
-                ids.reserve(allImages.size());
+            QVector<QFuture<cwTrackedImagePtr>> ids;
+            ids.reserve(filterData.size());
 
-                std::transform(allImages.begin(),
-                               allImages.end(),
-                               std::back_inserter(ids),
-                               compressAndUpload);
+            std::transform(filterData.begin(),
+                           filterData.end(),
+                           std::back_inserter(ids),
+                           compressAndUpload);
 
-                return ids;
-            }
-            ).future();
+            compressAndUploadFuture = AsyncFuture::completed(ids);
         }
 
         auto iconFuture = QtConcurrent::mapped(filterData, createIcon);
@@ -421,7 +416,7 @@ void cwAddImageTask::runTask() {
   */
 QImage cwAddImageTask::copyOriginalImage(QString imagePath,
                                          cwImage* imageIdContainer,
-                                         const QString &databaseFilename) {
+                                         cwImageDatabaseWriter* databaseWriter) {
 
     //Copy original directly into the database
     QFile originalFile;
@@ -456,7 +451,7 @@ QImage cwAddImageTask::copyOriginalImage(QString imagePath,
     *imageIdContainer = addImageToDatabase(image,
                                            format,
                                            originalImageByteData,
-                                           databaseFilename);
+                                           databaseWriter);
 
     return image;
 }
@@ -466,7 +461,7 @@ QImage cwAddImageTask::copyOriginalImage(QString imagePath,
   */
 void cwAddImageTask::copyOriginalImage(const QImage &image,
                                        cwImage *imageIds,
-                                       const QString &databaseFilename)
+                                       cwImageDatabaseWriter* databaseWriter)
 {
     QByteArray format = "png"; //Alternative is to use "webp", but it seems to be pretty memory leaky
     QByteArray imageData;
@@ -487,7 +482,7 @@ void cwAddImageTask::copyOriginalImage(const QImage &image,
     *imageIds = addImageToDatabase(image,
                                    format,
                                    imageData,
-                                   databaseFilename);
+                                   databaseWriter);
 }
 
 /**
@@ -496,7 +491,7 @@ void cwAddImageTask::copyOriginalImage(const QImage &image,
 cwImage cwAddImageTask::addImageToDatabase(const QImage &image,
                                            const QByteArray &format,
                                            const QByteArray &imageData,
-                                           const QString &databaseFilename)
+                                           cwImageDatabaseWriter* databaseWriter)
 {
     cwImage imageIdContainer = originalMetaData(image);
 
@@ -506,7 +501,7 @@ cwImage cwAddImageTask::addImageToDatabase(const QImage &image,
                                   format,
                                   imageData);
 
-    int imageId = cwImageDatabase(databaseFilename).addImage(originalImageData);
+    int imageId = databaseWriter->addImage(originalImageData).result();
 
     imageIdContainer.setOriginal(imageId);
 
@@ -522,8 +517,7 @@ cwImage cwAddImageTask::addImageToDatabase(const QImage &image,
   OPENGL IS EXTREMELY SENSITVE WITH THE NUMBER OF MIPMAPS NEEDED, don't modify
   */
 int cwAddImageTask::numberOfMipmapLevels(QSize imageSize) {
-    double largestDimension = static_cast<double>(std::max(imageSize.width(), imageSize.height()));
-    return std::max(1, static_cast<int>(log2(largestDimension)) + 1);
+    return cwMipmapPyramid::numberOfLevels(imageSize);
 }
 
 QStringList cwAddImageTask::supportedImageFormats()
@@ -532,92 +526,42 @@ QStringList cwAddImageTask::supportedImageFormats()
 }
 
 /**
- * @brief cwAddImageTask::ensureImageDivisibleBy4
- * @param originalImage
- * @param renderTextureSize
- * @return The image that's divisible by 4 in both the height and width
- * The image will be place an 0, 0 (upper left corner).  Extra padding
- * will be added to the right and bottom of the image.  RenderSize will
- * return with normalize area where the image is valid. RenderSize should
- * be close to 1.0 or exactly 1.0 if the originalImage's dimensions are
+ * @brief cwAddImageTask::sizeDivisibleBy4
+ * @param imageSize
+ * @return The size of the first mipmap level, imageSize rounded up so the height and width are
  * divisible by 4.
  *
- *  The mipmaps should be
- * compressed with DXT1 compression, and for ANGLE (for windows)
+ * The mipmaps should be compressed with DXT1 compression, and for ANGLE (for windows)
  * the mipmaps dimension have to be divisible by 4.  This is
  * a D3D requirement (ANGLE converts opengl to D3D on windows).
  * If the mipmap isn't divisible by 4 it will cause a crash (an abort).
  *
- * renderTextureSize hold the area of the image that should be
- * used for rendering.  This value should be in normalized cooridanates
- * frome 0.0 to 1.0.  Usually the renderTextureSize should be close to
- * 1.0.  This (width, height) can be multiplied against the texture coordinates
- * to get the true texture cordinates.
+ * The image is placed at the bottom left of the padded size, the extra padding is at the top
+ * and right of the image. The padding isn't copied, cwMipmapPyramid and cwDXT1Compresser
+ * repeat the top row and last column of the image for it. cwImageProvider::scaleTexCoords()
+ * returns the area of the texture that's the image.
  */
-QImage cwAddImageTask::ensureImageDivisibleBy4(QImage originalImage, QSizeF *clipArea)
+QSize cwAddImageTask::sizeDivisibleBy4(QSize imageSize)
 {
-    Q_ASSERT(clipArea != nullptr);
-
-    QSize imageSize = originalImage.size();
-    int widthRemainder = imageSize.width() % 4;
-    int heightRemainder = imageSize.height() % 4;
-
-    if(widthRemainder == 0 && heightRemainder == 0) {
-        //Simple case, everything peachy
-        *clipArea = QSizeF(1.0, 1.0);
-        return originalImage;
-    }
-
-    //Need to add padding to the image
-    int newWidth;
-    if(widthRemainder == 0) {
-        newWidth = imageSize.width();
-    } else {
-        newWidth = ((imageSize.width() / 4) + 1) * 4; //Integer math
-    }
-    double validWidth = imageSize.width() / (double)newWidth;
-
-    int newHeight;
-    if(heightRemainder == 0) {
-        newHeight = imageSize.height();
-    } else {
-        newHeight = ((imageSize.height() / 4) + 1) * 4; //Integer math
-    }
-    double validHeight = imageSize.height() / (double)newHeight;
-
-    QImage paddedImage(newWidth, newHeight, QImage::Format_ARGB32_Premultiplied);
-
-    int heightDiff = newHeight - imageSize.height();
-    int widthDiff = newWidth - imageSize.width();
-
-
-    QPainter painter(&paddedImage);
+    auto roundUp = [](int value) {
+        return ((value + 3) / 4) * 4; //Integer math
+    };
 
-    if(heightRemainder != 0) {
-        QImage topImage = originalImage.copy(0, 0, imageSize.width(), 1);
-        for(int i = 0; i < heightDiff; i++) {
-            painter.drawImage(QPoint(0, i), topImage);
-        }
-    }
+    return QSize(roundUp(imageSize.width()), roundUp(imageSize.height()));
+}
 
-    if(widthRemainder != 0) {
-        QRect copyArea(imageSize.width() - 1, 0, 1, imageSize.height());
-        QImage rightImage = originalImage.copy(copyArea);
-        for(int i = 0; i < widthDiff; i++) {
-            painter.drawImage(QPoint(imageSize.width() + i, heightDiff), rightImage);
-        }
+/**
+ * Returns the original image and releases it, for this and all of it's copies
+ */
+QImage cwAddImageTask::PrivateImageData::takeOriginalImage() const
+{
+    if(OriginalImage == nullptr) {
+        return QImage();
     }
 
-    painter.drawImage(QPoint(0, heightDiff), originalImage);
-    painter.end();
-
-    Q_ASSERT(validWidth > 0);
-    Q_ASSERT(validHeight > 0);
-    Q_ASSERT(validWidth <= 1.0);
-    Q_ASSERT(validHeight <= 1.0);
-
-    *clipArea = QSizeF(validWidth, validHeight);
-    return paddedImage;
+    QImage image = *OriginalImage;
+    *OriginalImage = QImage();
+    return image;
 }
 
 cwImage cwAddImageTask::originalMetaData(const QImage &image)
@@ -27,8 +27,10 @@
 
 //Std includes
 #include <type_traits>
+#include <memory>
 
 class CompressImageKernal;
+class cwImageDatabaseWriter;
 
 class CAVEWHERE_LIB_EXPORT cwAddImageTask : public cwProjectIOTask
 {
@@ -86,15 +88,20 @@ private:
         PrivateImageData() { }
         PrivateImageData(cwTrackedImagePtr id, QImage original, QString name = QString("default image")) :
             Id(id),
-            OriginalImage(original),
+            OriginalImage(std::make_shared<QImage>(original)),
             Name(name)
         {
 
         }
 
+        bool isNull() const { return OriginalImage == nullptr || OriginalImage->isNull(); }
+        QImage originalImage() const { return OriginalImage != nullptr ? *OriginalImage : QImage(); }
+        QImage takeOriginalImage() const;
 
         cwTrackedImagePtr Id;
-        QImage OriginalImage;
+
+        //Shared between the copies, so the original can be released for all of them
+        std::shared_ptr<QImage> OriginalImage;
         QString Name;
     };
 
@@ -107,18 +114,18 @@ private:
 
     static QImage copyOriginalImage(QString image,
                                     cwImage* imageIds,
-                                    const QString& databaseFilename);
+                                    cwImageDatabaseWriter* databaseWriter);
 
     static void copyOriginalImage(const QImage& image,
                                   cwImage* imageIds,
-                                  const QString& databaseFilename);
+                                  cwImageDatabaseWriter* databaseWriter);
 
     static cwImage addImageToDatabase(const QImage& image,
                                       const QByteArray& format,
                                       const QByteArray& imageData,
-                                      const QString& databaseFilename);
+                                      cwImageDatabaseWriter* databaseWriter);
 
-    static QImage ensureImageDivisibleBy4(QImage originalImage, QSizeF* clipArea);
+    static QSize sizeDivisibleBy4(QSize imageSize);
 
     static int half(int value);
 
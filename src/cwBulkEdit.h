@@ -0,0 +1,45 @@
+#ifndef CWBULKEDIT_H
+#define CWBULKEDIT_H
+
+//Qt includes
+#include <QtGlobal>
+
+/**
+ * @brief The cwBulkEdit class bulk edits a cwCavingRegion, cwCave, or cwTrip for it's scope
+ *
+ * This calls beginBulkEdit() when it's created and endBulkEdit() when it's destroyed, so
+ * every return path ends the bulk edit. During the bulk edit the object, and everything in
+ * it, doesn't emit signals. When the scope ends, the object emits one reset signal that
+ * listeners treat as a single change.
+ *
+ * \code
+ * {
+ *     cwBulkEdit<cwTrip> edit(trip);
+ *     for(...) {
+ *         trip->addShotToLastChunk(from, to, shot);
+ *     }
+ * } //Emits cwTrip::chunksReset()
+ * \endcode
+ */
+template<typename T>
+class cwBulkEdit
+{
+public:
+    explicit cwBulkEdit(T* object) :
+        Object(object)
+    {
+        Object->beginBulkEdit();
+    }
+
+    ~cwBulkEdit()
+    {
+        Object->endBulkEdit();
+    }
+
+private:
+    Q_DISABLE_COPY(cwBulkEdit)
+
+    T* Object;
+};
+
+#endif // CWBULKEDIT_H
@@ -20,6 +20,12 @@ class cwCSVLineModel;
  * @brief The cwCSVImporterManager class
  *
  * The csv import manager, manages the cwCSVImporterTask.
+ *
+ * CSV imports don't go through cwSurveyImportManager's staged import, like Compass files do. A
+ * CSV import is a single file, so there's nothing to parse in parallel or merge. The file is
+ * parsed again on a worker thread whenever a setting changes, to update the preview. The parsed
+ * caves are handed off, instead of copied, and the CSV importer page adds them to the region in
+ * one addCaves() call.
  */
 class CAVEWHERE_LIB_EXPORT cwCSVImporterManager : public QObject
 {
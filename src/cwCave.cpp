@@ -83,6 +83,9 @@ cwCave& cwCave::Copy(const cwCave& object) {
     for(int i = 0; i < object.tripCount(); i++) {
         cwTrip* trip = object.trip(i);
         cwTrip* newTrip = new cwTrip(*trip); //Deep copy of the trip
+        if(isBulkEditing()) {
+            newTrip->beginBulkEdit();
+        }
         newTrip->setParent(this);
         newTrip->setParentCave(this);
         newTrip->errorModel()->setParentModel(ErrorModel);
@@ -233,6 +236,57 @@ QModelIndex cwCave::index(int row, int column, const QModelIndex &parent) const
    return QAbstractListModel::index(row, column, parent);
 }
 
+/**
+  \brief Starts a bulk edit of the cave
+
+  This starts a bulk edit on all the trips in the cave, see cwTrip::beginBulkEdit(). Trips
+  that are added during the bulk edit are also bulk edited. The cave doesn't emit signals
+  until the outer most endBulkEdit(), which emits resetTrips() and resets the model once.
+  Listeners should drop their connections to the trips when beginResetTrips() is emitted.
+  */
+void cwCave::beginBulkEdit()
+{
+    BulkEditDepth++;
+    if(BulkEditDepth > 1) {
+        return;
+    }
+
+    emit beginResetTrips();
+    beginResetModel();
+
+    BulkEditName = Name;
+
+    blockSignals(true);
+    foreach(cwTrip* trip, Trips) {
+        trip->beginBulkEdit();
+    }
+}
+
+/**
+  \brief Ends the bulk edit started with beginBulkEdit()
+  */
+void cwCave::endBulkEdit()
+{
+    Q_ASSERT(BulkEditDepth > 0);
+    BulkEditDepth--;
+    if(BulkEditDepth > 0) {
+        return;
+    }
+
+    foreach(cwTrip* trip, Trips) {
+        trip->endBulkEdit();
+    }
+    blockSignals(false);
+
+    endResetModel();
+
+    if(BulkEditName != Name) {
+        emit nameChanged();
+    }
+
+    emit resetTrips();
+}
+
 /**
   \brief Sets the undo stack for the cave and all of it's children
   */
@@ -284,6 +338,9 @@ void cwCave::InsertRemoveTrip::insertTrips() {
     for(int i = 0; i < Trips.size(); i++) {
         int index = BeginIndex + i;
         cave->Trips.insert(index, Trips[i]);
+        if(cave->isBulkEditing()) {
+            Trips[i]->beginBulkEdit();
+        }
         Trips[i]->setParentCave(cave);
         Trips[i]->errorModel()->setParentModel(cave->errorModel());
 //        cave->errorModel()->addParent(Trips[i]);
@@ -304,6 +361,9 @@ void cwCave::InsertRemoveTrip::removeTrips() {
     for(int i = Trips.size() - 1; i >= 0; i--) {
         int index = BeginIndex + i;
         cave->Trips.removeAt(index);
+        if(cave->isBulkEditing()) {
+            Trips[i]->endBulkEdit();
+        }
         Trips[i]->setParentCave(nullptr);
         Trips[i]->errorModel()->setParentModel(nullptr);
     }
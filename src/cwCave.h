@@ -85,6 +85,10 @@ public:
 
     QList< cwStation > stations() const;
 
+    void beginBulkEdit();
+    void endBulkEdit();
+    bool isBulkEditing() const;
+
 signals:
     void beginInsertTrips(int begin, int end);
     void insertedTrips(int begin, int end);
@@ -92,6 +96,9 @@ signals:
     void beginRemoveTrips(int begin, int end);
     void removedTrips(int begin, int end);
 
+    void beginResetTrips();
+    void resetTrips();
+
     void nameChanged();
 
     void stationPositionPositionChanged();
@@ -111,6 +118,9 @@ private:
 
     cwSurveyNetwork Network;
 
+    int BulkEditDepth = 0; //!< The number of nested beginBulkEdit() calls
+    QString BulkEditName; //!< The name when the bulk edit started
+
     cwCave& Copy(const cwCave& object);
     void addTripNullHelper();
 
@@ -213,6 +223,13 @@ inline cwLength *cwCave::depth() const
     return Depth;
 }
 
+/**
+  \brief Returns true if the cave is between beginBulkEdit() and endBulkEdit()
+  */
+inline bool cwCave::isBulkEditing() const {
+    return BulkEditDepth > 0;
+}
+
 /**
   \brief Gets the index of the trip inside of the cave
   */
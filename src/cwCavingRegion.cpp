@@ -124,6 +124,9 @@ cwCavingRegion& cwCavingRegion::copy(const cwCavingRegion& object) {
 
         cwCave* newCave = new cwCave(*cave);
         newCave->setParent(this);  //Uncomment because this cause problems with QML
+        if(isBulkEditing()) {
+            newCave->beginBulkEdit();
+        }
 
         if(threadIsNull) {
             moveToThread(nullptr);
@@ -241,6 +244,52 @@ cwProject *cwCavingRegion::parentProject() const
     return dynamic_cast<cwProject*>(parent());
 }
 
+/**
+  \brief Starts a bulk edit of the region
+
+  This starts a bulk edit on all the caves in the region, see cwCave::beginBulkEdit(). Caves
+  that are added during the bulk edit are also bulk edited. The region doesn't emit signals
+  until the outer most endBulkEdit(), which emits resetCaves() and resets the model once.
+  Listeners should drop their connections to the caves when beginResetCaves() is emitted.
+  */
+void cwCavingRegion::beginBulkEdit()
+{
+    BulkEditDepth++;
+    if(BulkEditDepth > 1) {
+        return;
+    }
+
+    emit beginResetCaves();
+    beginResetModel();
+
+    blockSignals(true);
+    foreach(cwCave* cave, Caves) {
+        cave->beginBulkEdit();
+    }
+}
+
+/**
+  \brief Ends the bulk edit started with beginBulkEdit()
+  */
+void cwCavingRegion::endBulkEdit()
+{
+    Q_ASSERT(BulkEditDepth > 0);
+    BulkEditDepth--;
+    if(BulkEditDepth > 0) {
+        return;
+    }
+
+    foreach(cwCave* cave, Caves) {
+        cave->endBulkEdit();
+    }
+    blockSignals(false);
+
+    endResetModel();
+
+    emit resetCaves();
+    emit caveCountChanged();
+}
+
 /**
   \brief Sets the undo stack for this region
 
@@ -295,6 +344,9 @@ void cwCavingRegion::InsertRemoveCave::insertCaves() {
         int index = BeginIndex + i;
         regionPtr->Caves.insert(index, Caves[i]);
         Caves[i]->setParent(regionPtr);
+        if(regionPtr->isBulkEditing()) {
+            Caves[i]->beginBulkEdit();
+        }
     }
 
     OwnsCaves = false;
@@ -317,6 +369,9 @@ void cwCavingRegion::InsertRemoveCave::removeCaves() {
     for(int i = Caves.size() - 1; i >= 0; i--) {
         int index = BeginIndex + i;
         regionPtr->Caves.removeAt(index);
+        if(regionPtr->isBulkEditing()) {
+            Caves[i]->endBulkEdit();
+        }
         Caves[i]->setParent(nullptr);
     }
 
@@ -60,6 +60,11 @@ public:
     int indexOf(cwCave* cave);
 
     cwProject* parentProject() const;
+
+    void beginBulkEdit();
+    void endBulkEdit();
+    bool isBulkEditing() const;
+
 signals:
     void beginInsertCaves(int begin, int end);
     void insertedCaves(int begin, int end);
@@ -67,6 +72,9 @@ signals:
     void beginRemoveCaves(int begin, int end);
     void removedCaves(int begin, int end);
 
+    void beginResetCaves();
+    void resetCaves();
+
     void caveCountChanged();
 
 public slots:
@@ -77,6 +85,8 @@ protected:
     virtual void setUndoStackForChildren();
 
 private:
+    int BulkEditDepth = 0; //!< The number of nested beginBulkEdit() calls
+
     cwCavingRegion& copy(const cwCavingRegion& object);
 
     void unparentCave(cwCave* cave);
@@ -148,4 +158,11 @@ inline QList<cwCave*> cwCavingRegion::caves() const {
     return Caves;
 }
 
+/**
+  \brief Returns true if the region is between beginBulkEdit() and endBulkEdit()
+  */
+inline bool cwCavingRegion::isBulkEditing() const {
+    return BulkEditDepth > 0;
+}
+
 #endif // CWCAVINGREGION_H
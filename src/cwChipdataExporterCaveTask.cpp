@@ -117,12 +117,9 @@ void cwChipdataExportCaveTask::writeChunk(QTextStream& stream, cwSurveyChunk* ch
     cwSurveyChunkTrimmer::trim(chunk);
 
     //Go through all the shots
-    for(int i = 0; i < chunk->shotCount(); i++) {
-        cwShot shot = chunk->shot(i);
-        cwStation from = chunk->station(i);
-        cwStation to = chunk->station(i + 1);
-
-        writeShot(stream, trip->calibrations(), feetAndInches, from, to, shot);
+    const cwSurveyChunkData& data = chunk->surveyData();
+    for(int i = 0; i < data.shotCount() && i + 1 < data.stationCount(); i++) {
+        writeShot(stream, trip->calibrations(), feetAndInches, data, i);
     }
 }
 
@@ -130,37 +127,39 @@ void cwChipdataExportCaveTask::writeChunk(QTextStream& stream, cwSurveyChunk* ch
   This writes a shot to the strem
 
   calibrations - The calibrations for the trip
-  fromStation - the from station of the shot
-  toStation - the to station of the shot
-  shot - The shot's data
+  data - The chunk's stations and shots
+  shotIndex - The index of the shot in data, it's from station has the same index
   LRUDShotOnly - This shot is really just printing out the last station's LRUD data
   this hould has zero length, direction and clino readings.
   */
 void cwChipdataExportCaveTask::writeShot(QTextStream &stream,
                                         cwTripCalibration* calibrations,
                                         bool feetAndInches,
-                                        const cwStation &fromStation,
-                                        const cwStation &toStation,
-                                        cwShot shot)
+                                        const cwSurveyChunkData &data,
+                                        int shotIndex)
 {
-    stream << toStation.name().rightJustified(5, ' ', true);
-    stream << fromStation.name().rightJustified(5, ' ', true);
+    const int from = shotIndex;
+    const int to = shotIndex + 1;
+    const double distance = data.distances().at(shotIndex);
+
+    stream << data.stationNames().at(to).rightJustified(5, ' ', true);
+    stream << data.stationNames().at(from).rightJustified(5, ' ', true);
 
-    if (shot.distanceState() == cwDistanceStates::Valid) {
+    if (data.distanceStates().at(shotIndex) == cwDistanceStates::Valid) {
         if (feetAndInches) {
-            stream << formatNumber(floor(shot.distance()), 0, 4);
-            stream << formatNumber(fmod(shot.distance(), 1.0) * 12.0, 0, 3);
+            stream << formatNumber(floor(distance), 0, 4);
+            stream << formatNumber(fmod(distance, 1.0) * 12.0, 0, 3);
         } else {
             switch (calibrations->distanceUnit()) {
             case cwUnits::Feet:
-                stream << formatNumber(shot.distance(), 2, 6) << ' ';
+                stream << formatNumber(distance, 2, 6) << ' ';
                 break;
             case cwUnits::Inches:
-                stream << formatNumber(shot.distance() / 12.0, 0, 4);
-                stream << formatNumber(fmod(shot.distance(), 12.0), 0, 3);
+                stream << formatNumber(distance / 12.0, 0, 4);
+                stream << formatNumber(fmod(distance, 12.0), 0, 3);
                 break;
             default:
-                stream << formatNumber(cwUnits::convert(shot.distance(), calibrations->distanceUnit(), cwUnits::Meters), 2, 6) << ' ';
+                stream << formatNumber(cwUnits::convert(distance, calibrations->distanceUnit(), cwUnits::Meters), 2, 6) << ' ';
                 break;
             }
         }
@@ -168,29 +167,29 @@ void cwChipdataExportCaveTask::writeShot(QTextStream &stream,
         stream << "       ";
     }
 
-    if (!shot.isDistanceIncluded()) {
+    if (!data.distancesIncluded().at(shotIndex)) {
         stream << "*";
     } else {
         stream << " ";
     }
 
-    if (shot.compassState() == cwCompassStates::Valid) {
-        stream << formatNumber(shot.compass(), 2, 6);
+    if (data.compassStates().at(shotIndex) == cwCompassStates::Valid) {
+        stream << formatNumber(data.compasses().at(shotIndex), 2, 6);
     } else {
         stream << "      ";
     }
-    if (shot.backCompassState() == cwCompassStates::Valid) {
-        stream << formatNumber(shot.backCompass(), 2, 6);
+    if (data.backCompassStates().at(shotIndex) == cwCompassStates::Valid) {
+        stream << formatNumber(data.backCompasses().at(shotIndex), 2, 6);
     } else {
         stream << "      ";
     }
-    if (shot.clinoState() == cwClinoStates::Valid) {
-        stream << formatNumber(shot.clino(), 1, 5);
+    if (data.clinoStates().at(shotIndex) == cwClinoStates::Valid) {
+        stream << formatNumber(data.clinos().at(shotIndex), 1, 5);
     } else {
         stream << "     ";
     }
-    if (shot.backClinoState() == cwClinoStates::Valid) {
-        stream << formatNumber(shot.backClino(), 1, 5);
+    if (data.backClinoStates().at(shotIndex) == cwClinoStates::Valid) {
+        stream << formatNumber(data.backClinos().at(shotIndex), 1, 5);
     } else {
         stream << "     ";
     }
@@ -204,10 +203,10 @@ void cwChipdataExportCaveTask::writeShot(QTextStream &stream,
     }
 
 
-    writeLrudMeasurement(stream, toStation.leftInputState(),  toStation.left(),  calibrations->distanceUnit(), lrudUnit);
-    writeLrudMeasurement(stream, toStation.rightInputState(), toStation.right(), calibrations->distanceUnit(), lrudUnit);
-    writeLrudMeasurement(stream, toStation.upInputState(),    toStation.up(),    calibrations->distanceUnit(), lrudUnit);
-    writeLrudMeasurement(stream, toStation.downInputState(),  toStation.down(),  calibrations->distanceUnit(), lrudUnit);
+    writeLrudMeasurement(stream, data.leftStates().at(to),  data.lefts().at(to),  calibrations->distanceUnit(), lrudUnit);
+    writeLrudMeasurement(stream, data.rightStates().at(to), data.rights().at(to), calibrations->distanceUnit(), lrudUnit);
+    writeLrudMeasurement(stream, data.upStates().at(to),    data.ups().at(to),    calibrations->distanceUnit(), lrudUnit);
+    writeLrudMeasurement(stream, data.downStates().at(to),  data.downs().at(to),  calibrations->distanceUnit(), lrudUnit);
 
     stream << chipdataNewLine();
 }
@@ -236,9 +235,9 @@ QString cwChipdataExportCaveTask::formatNumber(double number, int maxPrecision,
 
 bool cwChipdataExportCaveTask::isFeetAndInches(cwTrip *trip)
 {
-    return trip->calibrations()->distanceUnit() == cwUnits::Feet && !containsShot(trip, [&](cwShot shot) {
-        if (shot.distanceState() == cwDistanceStates::Valid) {
-            double f = fmod(shot.distance() * 12.0, 1.0);
+    return trip->calibrations()->distanceUnit() == cwUnits::Feet && !containsShot(trip, [&](const cwSurveyChunkData& data, int i) {
+        if (data.distanceStates().at(i) == cwDistanceStates::Valid) {
+            double f = fmod(data.distances().at(i) * 12.0, 1.0);
             return f > 1e-6 && f < (1 - 1e-6);
         }
         return false;
@@ -249,8 +248,9 @@ template<typename P>
 bool cwChipdataExportCaveTask::containsShot(cwTrip* trip, P predicate)
 {
     foreach (cwSurveyChunk* chunk, trip->chunks()) {
-        foreach (cwShot shot, chunk->shots()) {
-            if (predicate(shot)) {
+        const cwSurveyChunkData& data = chunk->surveyData();
+        for (int i = 0; i < data.shotCount(); i++) {
+            if (predicate(data, i)) {
                 return true;
             }
         }
@@ -18,6 +18,7 @@ class cwTrip;
 class cwTripCalibration;
 class cwSurveyChunk;
 class cwShot;
+class cwSurveyChunkData;
 
 class cwChipdataExportCaveTask : public cwCaveExporterTask
 {
@@ -38,7 +39,7 @@ private:
     void writeHeader(QTextStream& stream, cwTrip* trip, QString caveName = QString());
     void writeDataFormat(QTextStream& stream, cwTrip* trip);
     void writeChunk(QTextStream& stream, cwSurveyChunk* chunk, bool feetAndInches);
-    void writeShot(QTextStream &stream, cwTripCalibration *calibrations, bool feetAndInches, const cwStation &fromStation, const cwStation &toStation, cwShot shot);
+    void writeShot(QTextStream &stream, cwTripCalibration *calibrations, bool feetAndInches, const cwSurveyChunkData &data, int shotIndex);
     void writeLrudMeasurement(QTextStream &stream, cwDistanceStates::State state, double measurement, cwUnits::LengthUnit fromUnit, cwUnits::LengthUnit toUnit);
     static QString formatNumber(double number, int maxPrecision, int columnWidth);
 
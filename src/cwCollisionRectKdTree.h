@@ -12,11 +12,14 @@
 #include <QRectF>
 class QPainter;
 
+//Our includes
+#include "cwGlobals.h"
+
 /**
   \brief This class is used to accelerate the text rendering by
   detecting rectangle collisions.
   */
-class cwCollisionRectKdTree
+class CAVEWHERE_LIB_EXPORT cwCollisionRectKdTree
 {
 public:
     cwCollisionRectKdTree();
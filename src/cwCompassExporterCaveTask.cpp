@@ -188,17 +188,21 @@ void cwCompassExportCaveTask::writeChunk(QTextStream& stream,
     //Trim the invalid stations off
     cwSurveyChunkTrimmer::trim(chunk);
 
-    //Go through all the shots
+    const QMap<int, cwTripCalibration*> calibrations = chunk->calibrations();
+
+    //Go through all the shots. The writer changes the shot, so the stations and shots are
+    //built, but each to station is reused as the next from station
+    cwStation from = chunk->station(0);
     for(int i = 0; i < chunk->shotCount(); i++) {
         //Change the calibration
-        cwTripCalibration* overrideCalibration = chunk->calibrations().value(i, nullptr);
+        cwTripCalibration* overrideCalibration = calibrations.value(i, nullptr);
         calibration = overrideCalibration == nullptr ? calibration : overrideCalibration;
 
         cwShot shot = chunk->shot(i);
-        cwStation from = chunk->station(i);
         cwStation to = chunk->station(i + 1);
 
         writeShot(stream, calibration, from, to, shot, false);
+        from = to;
     }
 
     //Write the last stations LRUD
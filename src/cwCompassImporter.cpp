@@ -14,111 +14,304 @@
 #include "cwStation.h"
 #include "cwShot.h"
 #include "cwLength.h"
+#include "cwBulkEdit.h"
 
 //Qt includes
 #include <QFileInfo>
+#include <QBuffer>
+#include <QSharedPointer>
+#include <QtConcurrent>
+
+//Std includes
+#include <functional>
+
+/**
+ * @brief The cwCompassImporter::DataFile class
+ *
+ * Reads and parses one compass data file into a cave. Data files don't share anything, so
+ * each one can be parsed on it's own thread. Messages are kept, so they can be reported in
+ * the same order as the files.
+ */
+class cwCompassImporter::DataFile {
+public:
+    DataFile(QString filename);
+
+    void read();
+    void parse(const cwTask* task);
+
+    QString CurrentFilename;
+    QByteArray Data; //The file's contents, after read()
+    cwCave* CurrentCave; //Owned by the importer, after parse()
+    QStringList Messages;
+    bool CurrentFileGood;
+    bool StopImport; //Couldn't read the file, stops the whole import
+
+private:
+    //Status info
+    int LineCount;
+    cwTrip* CurrentTrip;
+
+    //Regex
+    QRegExp SurveyNameRegExp;
+    QRegExp DateRegExp;
+    QRegExp CalibrationRegExp;
+    cwStationRenamer StationRenamer;
+
+    void addMessage(QString message);
+
+    void verifyCompassDataFileExists();
+    void parseSurvey(QIODevice* file);
+    bool isFileGood(QFile* file, QString infoHelp);
+
+    void parseCaveName(QIODevice* file);
+    void parseTripName(QIODevice* file);
+    void parseTripDate(QIODevice* file);
+    void parseSurveyTeam(QIODevice* file);
+    void parseSurveyFormatAndCalibration(QIODevice* file);
+    void parseSurveyData(QIODevice* file);
+
+    bool convertNumber(QString numberString, QString field, double* value);
+};
 
 cwCompassImporter::cwCompassImporter(QObject *parent) :
-    cwTask(parent),
-    SurveyNameRegExp("^SURVEY NAME:\\s*"),
-    DateRegExp("SURVEY DATE:\\s*(\\d+)\\s+(\\d+)\\s+(\\d+)"),
-    CalibrationRegExp("DECLINATION:\\s*(\\S+)(?:\\s+FORMAT:\\s*)?(\\w+)(?:\\s+CORRECTIONS:\\s*(\\S+)\\s+(\\S+)\\s+(\\S+)\\s*)?(?:\\s+CORRECTIONS2:\\s*(\\S+)\\s+(\\S+))?.*")
+    cwTask(parent)
+{
+    setName("Importing Compass files");
+}
+
+cwCompassImporter::~cwCompassImporter()
+{
+    qDeleteAll(Caves);
+}
+
+/**
+ * @brief cwCompassImporter::caves
+ * @return Returns copies of the resulting caves.
+ */
+QList<cwCave> cwCompassImporter::caves() const
+{
+    QList<cwCave> caves;
+    caves.reserve(Caves.size());
+    for(cwCave* cave : Caves) {
+        caves.append(cwCave(*cave));
+    }
+    return caves;
+}
 
+/**
+ * @brief cwCompassImporter::takeCaves
+ * @return Returns the resulting caves, the caller owns them.
+ *
+ * The caves don't belong to any thread, use moveToThread() to pull them to the caller's
+ * thread. This doesn't copy the caves, like caves() does.
+ */
+QList<cwCave*> cwCompassImporter::takeCaves()
 {
-//    CalibrationRegExp.setMinimal(true);
+    QList<cwCave*> caves = Caves;
+    Caves.clear();
+    return caves;
 }
 
 /**
  * @brief cwCompassImporter::runTask
  *
- * This begins the parser
+ * This runs the import in stages. Each stage runs on all the files, in parallel, on the task
+ * thread pool, before the next stage starts:
+ *
+ * 1. Reads each file into memory
+ * 2. Parses each file into a cave
+ * 3. Merges the caves and messages in the same order as the files
+ *
+ * The name of the task is the current stage, and the progress is the number of files that
+ * have finished the stage. Stopping the task stops all the stages.
  */
 void cwCompassImporter::runTask()
 {
+    qDeleteAll(Caves);
     Caves.clear();
 
-    for(int i = 0; i < CompassDataFiles.size() && isRunning(); i++) {
-        CurrentFilename = CompassDataFiles.at(i);
-        Caves.append(cwCave());
-        CurrentCave = &Caves.last();
-        CurrentFileGood = true;
-        CurrentTrip = nullptr;
-        LineCount = 0;
+    QList<QSharedPointer<DataFile>> dataFiles;
+    dataFiles.reserve(CompassDataFiles.size());
+    for(const QString& filename : CompassDataFiles) {
+        dataFiles.append(QSharedPointer<DataFile>::create(filename));
+    }
+
+    auto runStage = [this, &dataFiles](const QString& stageName, std::function<void (DataFile*)> stage) {
+        if(!isRunning()) {
+            return;
+        }
+
+        setName(stageName);
+        setNumberOfSteps(dataFiles.size());
+        setProgress(0);
+
+        QList<QFuture<void>> futures;
+        futures.reserve(dataFiles.size());
+        for(const auto& dataFile : dataFiles) {
+            DataFile* dataFilePtr = dataFile.data();
+            futures.append(QtConcurrent::run(cwTask::threadPool(), [this, dataFilePtr, &stage]() {
+                if(isRunning()) {
+                    stage(dataFilePtr);
+                }
+            }));
+        }
+
+        for(int i = 0; i < futures.size(); i++) {
+            futures[i].waitForFinished();
+            setProgress(i + 1);
+        }
+    };
+
+    runStage("Reading Compass files", [](DataFile* dataFile) {
+        dataFile->read();
+    });
 
-        //Make sure file is good
-        verifyCompassDataFileExists();
+    runStage("Parsing Compass files", [this](DataFile* dataFile) {
+        dataFile->parse(this);
+    });
 
-        //Parse the current file
-        parseFile();
+    //Merge in the same order as the files
+    setName("Merging Compass files");
+    for(const auto& dataFile : dataFiles) {
+        if(!isRunning()) {
+            break;
+        }
+
+        for(const QString& message : dataFile->Messages) {
+            emit statusMessage(message);
+        }
 
-        if(!CurrentFileGood) {
-            //Parsing error in the last cave, remove it from list
+        if(dataFile->CurrentFileGood) {
+            Caves.append(dataFile->CurrentCave);
+        } else {
+            //Parsing error in the cave, don't add it
             emit statusMessage(QString("Couldn't parse cave found in %1").
-                               arg(CurrentFilename));
-            Caves.removeLast();
+                               arg(dataFile->CurrentFilename));
+            delete dataFile->CurrentCave;
+        }
+        dataFile->CurrentCave = nullptr;
+
+        if(dataFile->StopImport) {
+            stop();
         }
     }
 
-    for(auto& cave : Caves) {
-        cave.moveToThread(nullptr);
+    //Caves that weren't merged
+    for(const auto& dataFile : dataFiles) {
+        delete dataFile->CurrentCave;
     }
 
     done();
 }
 
+cwCompassImporter::DataFile::DataFile(QString filename) :
+    CurrentFilename(filename),
+    CurrentCave(nullptr),
+    CurrentFileGood(true),
+    StopImport(false),
+    LineCount(0),
+    CurrentTrip(nullptr),
+    SurveyNameRegExp("^SURVEY NAME:\\s*"),
+    DateRegExp("SURVEY DATE:\\s*(\\d+)\\s+(\\d+)\\s+(\\d+)"),
+    CalibrationRegExp("DECLINATION:\\s*(\\S+)(?:\\s+FORMAT:\\s*)?(\\w+)(?:\\s+CORRECTIONS:\\s*(\\S+)\\s+(\\S+)\\s+(\\S+)\\s*)?(?:\\s+CORRECTIONS2:\\s*(\\S+)\\s+(\\S+))?.*")
+{
+}
+
 /**
- * @brief cwCompassImporter::verifyCompassDataFileExists
+ * @brief cwCompassImporter::DataFile::read
+ *
+ * Reads the whole file into memory
  */
-void cwCompassImporter::verifyCompassDataFileExists()
+void cwCompassImporter::DataFile::read()
 {
+    //Make sure file is good
+    verifyCompassDataFileExists();
+
     if(!CurrentFileGood) { return; }
 
-    QFileInfo fileInfo(CurrentFilename);
-    if(!fileInfo.exists()) {
-        //TODO: Fix error message
-        emit statusMessage(QString("I can't parse %1 because it does not exist!").arg(CurrentFilename));
-        CurrentFileGood = false;
-    }
+    //Open the file
+    QFile file(CurrentFilename);
+    bool okay = file.open(QFile::ReadOnly);
 
-    if(!fileInfo.isReadable()) {
+    if(!okay) {
         //TODO: Fix error message
-        emit statusMessage(QString("I can't parse %1 because it's not readable, change the permissions?").arg(CurrentFilename));
-        stop();
+        addMessage(QString("I couldn't open %1").arg(CurrentFilename));
+        StopImport = true;
+        return;
     }
 
+    Data = file.readAll();
+    isFileGood(&file, "file");
 }
 
 /**
- * @brief cwCompassImporter::parseFile
+ * @brief cwCompassImporter::DataFile::parse
  *
- * Tries to parse the compass import file
+ * Tries to parse the compass import file, that's been read. This stops early if task
+ * isn't running.
  */
-void cwCompassImporter::parseFile()
+void cwCompassImporter::DataFile::parse(const cwTask* task)
 {
-    if(!CurrentFileGood) { return; }
+    CurrentCave = new cwCave();
 
-    //Open the file
-    QFile file(CurrentFilename);
-    bool okay = file.open(QFile::ReadOnly);
+    {
+        //The trips are built shot by shot, without emitting signals for each shot
+        cwBulkEdit<cwCave> edit(CurrentCave);
 
-    if(!okay) {
+        QBuffer buffer(&Data);
+        buffer.open(QIODevice::ReadOnly);
+
+        while (!buffer.atEnd() && CurrentFileGood && task->isRunning()) {
+            parseSurvey(&buffer);
+        }
+
+        buffer.close();
+    }
+
+    Data.clear();
+
+    //Let the importer pull the cave to it's thread
+    CurrentCave->moveToThread(nullptr);
+}
+
+/**
+ * @brief cwCompassImporter::DataFile::addMessage
+ * @param message
+ */
+void cwCompassImporter::DataFile::addMessage(QString message)
+{
+    Messages.append(message);
+}
+
+/**
+ * @brief cwCompassImporter::DataFile::verifyCompassDataFileExists
+ */
+void cwCompassImporter::DataFile::verifyCompassDataFileExists()
+{
+    if(!CurrentFileGood) { return; }
+
+    QFileInfo fileInfo(CurrentFilename);
+    if(!fileInfo.exists()) {
         //TODO: Fix error message
-        emit statusMessage(QString("I couldn't open %1").arg(CurrentFilename));
-        stop();
+        addMessage(QString("I can't parse %1 because it does not exist!").arg(CurrentFilename));
+        CurrentFileGood = false;
     }
 
-    while (!file.atEnd()) {
-        parseSurvey(&file);
+    if(!fileInfo.isReadable()) {
+        //TODO: Fix error message
+        addMessage(QString("I can't parse %1 because it's not readable, change the permissions?").arg(CurrentFilename));
+        StopImport = true;
     }
+
 }
 
 /**
- * @brief cwCompassImporter::parseSurvey
+ * @brief cwCompassImporter::DataFile::parseSurvey
  * @param file
  *
  * This tries to parse the survey out of the file
  */
-void cwCompassImporter::parseSurvey(QFile *file)
+void cwCompassImporter::DataFile::parseSurvey(QIODevice *file)
 {
     if(!CurrentFileGood) { return; }
 
@@ -140,20 +333,20 @@ void cwCompassImporter::parseSurvey(QFile *file)
 }
 
 /**
- * @brief cwCompassImporter::isFileGood
+ * @brief cwCompassImporter::DataFile::isFileGood
  * @param file
  * @param infoHelp
  * @return True if the file is still good, and false if it has errored
  */
-bool cwCompassImporter::isFileGood(QFile *file, QString infoHelp)
+bool cwCompassImporter::DataFile::isFileGood(QFile *file, QString infoHelp)
 {
     if(file->error() != QFile::NoError) {
         //TODO: Fix error message
-        emit statusMessage(QString("Hmm, while trying to parse %1, the Compass data file (%1) has error: %2. In %3 on line %4")
-                           .arg(file->errorString())
-                           .arg(infoHelp)
-                           .arg(CurrentFilename)
-                           .arg(LineCount));
+        addMessage(QString("Hmm, while trying to parse %1, the Compass data file (%1) has error: %2. In %3 on line %4")
+                   .arg(file->errorString())
+                   .arg(infoHelp)
+                   .arg(CurrentFilename)
+                   .arg(LineCount));
         CurrentFileGood = false;
         return false;
     }
@@ -161,10 +354,10 @@ bool cwCompassImporter::isFileGood(QFile *file, QString infoHelp)
 }
 
 /**
- * @brief cwCompassImporter::parseCaveName
+ * @brief cwCompassImporter::DataFile::parseCaveName
  * @param file
  */
-void cwCompassImporter::parseCaveName(QFile *file)
+void cwCompassImporter::DataFile::parseCaveName(QIODevice *file)
 {
     if(!CurrentFileGood) { return; }
     QString caveName = file->readLine();
@@ -174,22 +367,20 @@ void cwCompassImporter::parseCaveName(QFile *file)
     LineCount++;
 
     if(caveName.size() > 80) {
-        emit statusMessage(QString("I found the cave name to be longer than 80 characters. I'm trimming it to 80 characters, in %1 on line %2")
-                           .arg(CurrentFilename)
-                           .arg(LineCount));
+        addMessage(QString("I found the cave name to be longer than 80 characters. I'm trimming it to 80 characters, in %1 on line %2")
+                   .arg(CurrentFilename)
+                   .arg(LineCount));
         caveName.resize(80);
     }
 
-
-    if(!isFileGood(file, "cave name")) { return; }
     CurrentCave->setName(caveName);
 }
 
 /**
- * @brief cwCompassImporter::parseTripName
+ * @brief cwCompassImporter::DataFile::parseTripName
  * @param file
  */
-void cwCompassImporter::parseTripName(QFile *file)
+void cwCompassImporter::DataFile::parseTripName(QIODevice *file)
 {
     if(!CurrentFileGood) { return; }
     QString tripName = file->readLine();
@@ -198,18 +389,16 @@ void cwCompassImporter::parseTripName(QFile *file)
 
     LineCount++;
 
-    if(!isFileGood(file, "survey name")) { return; }
-
     CurrentTrip->setName(tripName);
 }
 
 /**
- * @brief cwCompassImporter::parseTripDate
+ * @brief cwCompassImporter::DataFile::parseTripDate
  * @param file
  *
  * This parses the trip's date from the input file
  */
-void cwCompassImporter::parseTripDate(QFile *file)
+void cwCompassImporter::DataFile::parseTripDate(QIODevice *file)
 {
     if(!CurrentFileGood) { return; }
 
@@ -217,14 +406,12 @@ void cwCompassImporter::parseTripDate(QFile *file)
 
     LineCount++;
 
-    if(!isFileGood(file, "survey date")) { return; }
-
     if(DateRegExp.indexIn(dateString) == -1)  {
         //Couldn't parse the date
         //TODO: Add warning that we couldn't parse the date
-        emit statusMessage(QString("I couldn't parse the date in %1 on line %2")
-                           .arg(CurrentFilename)
-                           .arg(LineCount));
+        addMessage(QString("I couldn't parse the date in %1 on line %2")
+                   .arg(CurrentFilename)
+                   .arg(LineCount));
     } else {
         QString monthString = DateRegExp.cap(1);
         QString dayString = DateRegExp.cap(2);
@@ -234,17 +421,17 @@ void cwCompassImporter::parseTripDate(QFile *file)
         int month = monthString.toInt(&okay);
         if(!okay) {
             //TODO: Add warning that we couldn't parse the date
-            emit statusMessage(QString("I couldn't understand the month.  I found \"%1\". It needs to be a number. Line %2")
-                               .arg(monthString)
-                               .arg(LineCount));
+            addMessage(QString("I couldn't understand the month.  I found \"%1\". It needs to be a number. Line %2")
+                       .arg(monthString)
+                       .arg(LineCount));
             return;
         }
 
         if(month < 1 || month > 12) {
             //Bad month
-            emit statusMessage(QString("I found the month to be \"%1\" it needs to be between 1 and 12. Line %2")
-                               .arg(month)
-                               .arg(LineCount));
+            addMessage(QString("I found the month to be \"%1\" it needs to be between 1 and 12. Line %2")
+                       .arg(month)
+                       .arg(LineCount));
 
             return;
         }
@@ -252,36 +439,36 @@ void cwCompassImporter::parseTripDate(QFile *file)
         int day = dayString.toInt(&okay);
         if(!okay) {
             //TODO: Add warning that we couldn't parse the date
-            emit statusMessage(QString("I couldn't understand the day.  I found \"%1\". It needs to be a number. Line %2")
-                               .arg(dayString)
-                               .arg(LineCount));
+            addMessage(QString("I couldn't understand the day.  I found \"%1\". It needs to be a number. Line %2")
+                       .arg(dayString)
+                       .arg(LineCount));
             return;
         }
 
         if(day < 1 || day > 31) {
-            emit statusMessage(QString("I found an wrong day of the month, %1 on line %2. It should be between 1 and 31.")
-                               .arg(day)
-                               .arg(LineCount));
+            addMessage(QString("I found an wrong day of the month, %1 on line %2. It should be between 1 and 31.")
+                       .arg(day)
+                       .arg(LineCount));
             return;
         }
 
         int year = yearString.toInt(&okay);
         if(!okay) {
-            emit statusMessage(QString("I found the year isn't a number, on line %1").arg(LineCount));
+            addMessage(QString("I found the year isn't a number, on line %1").arg(LineCount));
             return;
         }
 
         if(year < 0) {
-            emit statusMessage(QString("I found that the is negitive, on line %1").arg(LineCount));
+            addMessage(QString("I found that the is negitive, on line %1").arg(LineCount));
             return;
         }
 
         if(year < 1900) {
             int newYear = 1900 + year;
-            emit statusMessage(QString("I assuming year that %1 is really %2 on line %3")
-                               .arg(year)
-                               .arg(newYear)
-                               .arg(LineCount));
+            addMessage(QString("I assuming year that %1 is really %2 on line %3")
+                       .arg(year)
+                       .arg(newYear)
+                       .arg(LineCount));
             year = newYear;
         }
 
@@ -291,35 +478,33 @@ void cwCompassImporter::parseTripDate(QFile *file)
 }
 
 /**
- * @brief cwCompassImporter::parseSurveyTeam
+ * @brief cwCompassImporter::DataFile::parseSurveyTeam
  * @param file
  */
-void cwCompassImporter::parseSurveyTeam(QFile *file)
+void cwCompassImporter::DataFile::parseSurveyTeam(QIODevice *file)
 {
     if(!CurrentFileGood) { return; }
     QString surveyTeamLabel = file->readLine();
     surveyTeamLabel = surveyTeamLabel.trimmed();
 
     LineCount++;
-    if(!isFileGood(file, "survey team")) { return; }
 
     if(surveyTeamLabel.compare("SURVEY TEAM:") != 0) {
-        emit statusMessage(QString("I was expecting to find \"SURVEY TEAM:\" but instead found \"%1\", in %2 on line %3")
-                           .arg(surveyTeamLabel)
-                           .arg(CurrentFilename)
-                           .arg(LineCount));
+        addMessage(QString("I was expecting to find \"SURVEY TEAM:\" but instead found \"%1\", in %2 on line %3")
+                   .arg(surveyTeamLabel)
+                   .arg(CurrentFilename)
+                   .arg(LineCount));
     }
 
     QString surveyTeam = file->readLine();
     surveyTeam = surveyTeam.trimmed();
 
     LineCount++;
-    if(!isFileGood(file, "survey team")) { return; }
 
     if(surveyTeam.size() > 100) {
-        emit statusMessage(QString("I found the team to be longer than 100 characters. I'm trimming it to 100 characters, in %1 on line %2")
-                           .arg(CurrentFilename)
-                           .arg(LineCount));
+        addMessage(QString("I found the team to be longer than 100 characters. I'm trimming it to 100 characters, in %1 on line %2")
+                   .arg(CurrentFilename)
+                   .arg(LineCount));
         surveyTeam.resize(100);
     }
 
@@ -344,17 +529,16 @@ void cwCompassImporter::parseSurveyTeam(QFile *file)
 }
 
 /**
- * @brief cwCompassImporter::parseSurveyFormatAndCalibration
+ * @brief cwCompassImporter::DataFile::parseSurveyFormatAndCalibration
  * @param file
  */
-void cwCompassImporter::parseSurveyFormatAndCalibration(QFile *file)
+void cwCompassImporter::DataFile::parseSurveyFormatAndCalibration(QIODevice *file)
 {
     if(!CurrentFileGood) { return; }
     QString calibrationLine = file->readLine();
     calibrationLine = calibrationLine.trimmed();
 
     LineCount++;
-    if(!isFileGood(file, "calibration")) { return; }
 
     if(CalibrationRegExp.exactMatch(calibrationLine)) {
         QString declinationString = CalibrationRegExp.cap(1);
@@ -398,9 +582,9 @@ void cwCompassImporter::parseSurveyFormatAndCalibration(QFile *file)
                 fileFormatString.size() == 13 ||
                 fileFormatString.size() == 15) {
             if(fileFormatString.at(0) != 'D') {
-                emit statusMessage(QString("I can only understand Degrees for the Bearing Units. Converting all Bearing units to Degrees. In %1 on line %2")
-                                   .arg(CurrentFilename)
-                                   .arg(LineCount));
+                addMessage(QString("I can only understand Degrees for the Bearing Units. Converting all Bearing units to Degrees. In %1 on line %2")
+                           .arg(CurrentFilename)
+                           .arg(LineCount));
             }
 
             if(fileFormatString.at(1) == 'D') {
@@ -409,15 +593,15 @@ void cwCompassImporter::parseSurveyFormatAndCalibration(QFile *file)
                 CurrentTrip->calibrations()->setDistanceUnit(cwUnits::Meters);
             } else {
                 CurrentTrip->calibrations()->setDistanceUnit(cwUnits::Feet);
-                emit statusMessage(QString("I can't use Feet and Inches.  Converting all length measurements to decimal feet. In %1 on line %2")
-                                   .arg(CurrentFilename)
-                                   .arg(LineCount));
+                addMessage(QString("I can't use Feet and Inches.  Converting all length measurements to decimal feet. In %1 on line %2")
+                           .arg(CurrentFilename)
+                           .arg(LineCount));
             }
 
             if(fileFormatString.at(3) != 'D') {
-                emit statusMessage(QString("I can only understand Degrees for the Inclination Units. Converting all Inclination units to Degrees. In %1 on line %2")
-                                   .arg(CurrentFilename)
-                                   .arg(LineCount));
+                addMessage(QString("I can only understand Degrees for the Inclination Units. Converting all Inclination units to Degrees. In %1 on line %2")
+                           .arg(CurrentFilename)
+                           .arg(LineCount));
             }
 
             if(fileFormatString.size() >= 12) {
@@ -433,45 +617,41 @@ void cwCompassImporter::parseSurveyFormatAndCalibration(QFile *file)
             CurrentTrip->calibrations()->setDistanceUnit(cwUnits::Feet);
             CurrentTrip->calibrations()->setBackSights(false);
         } else {
-            emit statusMessage(QString("I found that the file format to be %1. It must be 11, 12, 13, 15 characters long. In file %2, on line %3")
-                               .arg(fileFormatString.size())
-                               .arg(CurrentFilename)
-                               .arg(LineCount)
-                               );
+            addMessage(QString("I found that the file format to be %1. It must be 11, 12, 13, 15 characters long. In file %2, on line %3")
+                       .arg(fileFormatString.size())
+                       .arg(CurrentFilename)
+                       .arg(LineCount)
+                       );
         }
 
     } else {
-        emit statusMessage(QString("I couldn't understand the calibration line found in %1 on line %2")
-                           .arg(CurrentFilename)
-                           .arg(LineCount));
+        addMessage(QString("I couldn't understand the calibration line found in %1 on line %2")
+                   .arg(CurrentFilename)
+                   .arg(LineCount));
         CurrentFileGood = false;
     }
 }
 
 /**
- * @brief cwCompassImporter::parseSurveyData
+ * @brief cwCompassImporter::DataFile::parseSurveyData
  * @param file
  */
-void cwCompassImporter::parseSurveyData(QFile *file)
+void cwCompassImporter::DataFile::parseSurveyData(QIODevice *file)
 {
     //Skip 3 lines
     file->readLine();
     LineCount++;
-    if(!isFileGood(file, "")) { return; }
 
     file->readLine();
     LineCount++;
-    if(!isFileGood(file, "")) { return; }
 
     file->readLine();
     LineCount++;
-    if(!isFileGood(file, "")) { return; }
 
     QString dataLine;
     while(!file->atEnd()) {
         dataLine = file->readLine();
         LineCount++;
-        if(!isFileGood(file, "data line")) { return; }
 
         //Make sure not at the end of the survey section
         if(!dataLine.isEmpty() && (dataLine.toLocal8Bit().at(0) == 0x0C
@@ -588,31 +768,31 @@ void cwCompassImporter::parseSurveyData(QFile *file)
                 }
             }
         } else {
-            emit statusMessage(QString("Data string doesn't have enough fields. I need at least 9 but found only %1 in %2 on line %3")
-                               .arg(dataStrings.size())
-                               .arg(CurrentFilename)
-                               .arg(LineCount));
+            addMessage(QString("Data string doesn't have enough fields. I need at least 9 but found only %1 in %2 on line %3")
+                       .arg(dataStrings.size())
+                       .arg(CurrentFilename)
+                       .arg(LineCount));
         }
     }
 }
 
 /**
- * @brief cwCompassImporter::covertNumber
+ * @brief cwCompassImporter::DataFile::covertNumber
  * @param name
  * @param field
  * @param value
  * @return
  */
-bool cwCompassImporter::convertNumber(QString numberString, QString field, double *value)
+bool cwCompassImporter::DataFile::convertNumber(QString numberString, QString field, double *value)
 {
     bool okay;
     *value = numberString.toDouble(&okay);
     if(!okay) {
-        emit statusMessage(QString("I couldn't read %1 because it's not a number (I found \"%4\" instead) in %2 on line %3")
-                           .arg(field)
-                           .arg(CurrentFilename)
-                           .arg(LineCount)
-                           .arg(numberString));
+        addMessage(QString("I couldn't read %1 because it's not a number (I found \"%4\" instead) in %2 on line %3")
+                   .arg(field)
+                   .arg(CurrentFilename)
+                   .arg(LineCount)
+                   .arg(numberString));
         return false;
     }
     return true;
@@ -23,17 +23,20 @@ class QFile;
 /**
  * @brief The cwCompassImporter class
  *
- * This allow cavewhere to import a compass dat file.
+ * This allow cavewhere to import compass dat files. Each file is read and parsed on
+ * it's own thread, and the caves are merged in the same order as the files.
  */
 class CAVEWHERE_LIB_EXPORT cwCompassImporter : public cwTask
 {
     Q_OBJECT
 public:
     explicit cwCompassImporter(QObject *parent = 0);
+    ~cwCompassImporter();
 
     void setCompassDataFiles(QStringList filename);
 
     QList<cwCave> caves() const;
+    QList<cwCave*> takeCaves();
 
 protected:
     void runTask();
@@ -43,51 +46,15 @@ signals:
 public slots:
 
 private:
+    class DataFile;
+
     //Input
     QStringList CompassDataFiles;
 
     //Output
-    QList<cwCave> Caves;
-
-    //Status info
-    int LineCount;
-    QString CurrentFilename;
-    cwCave* CurrentCave;
-    cwTrip* CurrentTrip;
-    bool CurrentFileGood;
-
-    //Regex
-    QRegExp SurveyNameRegExp;
-    QRegExp DateRegExp;
-    QRegExp CalibrationRegExp;
-    cwStationRenamer StationRenamer;
-
-    void verifyCompassDataFileExists();
-    void parseFile();
-    void parseSurvey(QFile* file);
-    bool isFileGood(QFile* file, QString infoHelp);
-
-    void parseCaveName(QFile* file);
-    void parseTripName(QFile* file);
-    void parseTripDate(QFile* file);
-    void parseSurveyTeam(QFile* file);
-    void parseSurveyFormatAndCalibration(QFile* file);
-    void parseSurveyData(QFile* file);
-
-    bool convertNumber(QString numberString, QString field, double* value);
-
+    QList<cwCave*> Caves;
 };
 
-
-/**
- * @brief cwCompassImporter::cave
- * @return Returns the resulting cave.
- */
-inline QList<cwCave> cwCompassImporter::caves() const
-{
-    return Caves;
-}
-
 /**
  * @brief cwCompassImporter::setCompassDataFiles
  * @param filenames - Sets the compass data file list
@@ -14,11 +14,14 @@
 #include "cwAddImageTask.h"
 #include "cwAsyncFuture.h"
 #include "cwImageDatabase.h"
+#include "cwMipmapPyramid.h"
+#include "cwDXT1Encoder.h"
 
 //Qt includes
 #include <QByteArray>
 #include <QBuffer>
 #include <QImageWriter>
+#include <QImageReader>
 #include <QList>
 #include <QColorSpace>
 #include <QJsonDocument>
@@ -28,6 +31,7 @@
 
 //Std includes
 #include <algorithm>
+#include <cstring>
 
 //Async Future
 #include <asyncfuture.h>
@@ -61,8 +65,8 @@ QFuture<cwTrackedImagePtr> cwCropImageTask::crop()
 {
     auto filename = databaseFilename();
     auto originalImage = Original;
-    auto cropRect = CropRect;
     auto format = Format;
+    QRect cropArea = cwCropImageTask::cropArea(CropRect, originalImage, format);
 
     struct Image {
         int id;
@@ -70,88 +74,270 @@ QFuture<cwTrackedImagePtr> cwCropImageTask::crop()
         int dotsPerMeter;
     };
 
-    auto addCropToDatabase = [filename](QRect cropRect, const cwImage& image) {
-        QVariantMap map({
-                            {cwImageProvider::cropIdKey(), image.original()},
-                            {cwImageProvider::cropXKey(), cropRect.x()},
-                            {cwImageProvider::cropYKey(), cropRect.y()},
-                            {cwImageProvider::cropWidthKey(), cropRect.width()},
-                            {cwImageProvider::cropHeightKey(), cropRect.height()}
-                        });
-        auto document = QJsonDocument::fromVariant(map);
-        auto json = document.toJson(QJsonDocument::Compact);
-
-        cwImageData imageData(cropRect.size(),
-                              image.originalDotsPerMeter(),
-                              cwImageProvider::croppedReferenceExtension(),
-                              json);
-
-        cwImageDatabase database(filename);
-        return database.addImage(imageData);
-    };
-
-    auto cropImage = [filename, originalImage, cropRect, addCropToDatabase]()->Image {
+    auto cropImage = [filename, originalImage, cropArea]()->Image {
             cwImageProvider provider;
             provider.setProjectPath(filename);
-            cwImageData imageData = provider.data(originalImage.original());
-            QImage image = provider.image(imageData);
-            image.setColorSpace(QColorSpace());
-            QRect cropArea = nearestDXT1Rect(mapNormalizedToIndex(cropRect,
-                                                                  originalImage.originalSize()));
+            //Shared through cwImageCache, so scraps on the same note only decode the note once
+            const QImage image = provider.image(originalImage.original());
             if(!image.isNull()) {
-                int id = addCropToDatabase(cropArea, originalImage);
-                return Image({id, image.copy(cropArea), originalImage.originalDotsPerMeter()});
+                int id = addCropToDatabase(filename, cropArea, originalImage);
+
+                //Only change the color space of the copy, the cached image is shared
+                QImage croppedImage = image.copy(cropArea);
+                croppedImage.setColorSpace(QColorSpace());
+                return Image({id, croppedImage, originalImage.originalDotsPerMeter()});
             }
 
             QImage badImage(cropArea.size(), QImage::Format_ARGB32);
             badImage.fill(QColor("red"));
-            qDebug() << "Original image is bad id:" << originalImage.original() << imageData.data().size() << imageData.size() << imageData.format() << LOCATION;
+            qDebug() << "Original image is bad id:" << originalImage.original() << LOCATION;
             return Image({-1, badImage, 0});
     };
 
-    auto cropFuture = QtConcurrent::run(cropImage);
+    auto cropAndCompress = [cropImage, filename, format]() {
+        auto cropFuture = QtConcurrent::run(cropImage);
+
+        auto addImageFuture = AsyncFuture::observe(cropFuture)
+                .subscribe([cropFuture, filename, format]()
+        {
+            int imageTypes = cwAddImageTask::None;
+            if(format == cwTextureUploadTask::DXT1Mipmaps) {
+                imageTypes |= cwAddImageTask::Mipmaps;
+            }
+
+            Image cropRGBImage = cropFuture.result();
+            if(cropRGBImage.id < 0) {
+                //Bad image, add the red image crop
+                imageTypes |= cwAddImageTask::Original;
+            }
+
+            cwAddImageTask addImages;
+            addImages.setDatabaseFilename(filename);
+            addImages.setNewImages({cropRGBImage.croppedImage});
+            addImages.setImageTypes(imageTypes);
+
+            return addImages.images();
+        }).future();
+
+        return AsyncFuture::observe(addImageFuture)
+                .subscribe([addImageFuture, cropFuture]()
+        {
+            auto cropRGBImage = cropFuture.result();
+            auto images = addImageFuture.results();
+            if(!images.isEmpty()) {
+                auto imagePtr = images.first();
+                if(cropRGBImage.id > 0) {
+                    //Update with the ref image
+                    imagePtr->setOriginalDotsPerMeter(cropRGBImage.dotsPerMeter);
+                    imagePtr->setOriginalSize(cropRGBImage.croppedImage.size());
+                    imagePtr->setOriginal(cropRGBImage.id);
+                }
+                return images.first();
+            }
+            return cwTrackedImagePtr();
+        }).future();
+    };
+
+    if(format == cwTextureUploadTask::DXT1Mipmaps && originalImage.isMipmapsValid()) {
+        //Try copying the blocks out of the original's mipmaps, without decoding the original
+        auto blockCropFuture = QtConcurrent::run([filename, originalImage, cropArea]() {
+            return cropMipmapBlocks(filename, originalImage, cropArea);
+        });
+
+        return AsyncFuture::observe(blockCropFuture)
+                .subscribe([blockCropFuture, cropAndCompress]()
+        {
+            cwTrackedImagePtr image = blockCropFuture.result();
+            if(!image.isNull()) {
+                return AsyncFuture::completed(image);
+            }
+            return cropAndCompress();
+        }).future();
+    }
+
+    return cropAndCompress();
+}
+
+/**
+ * Adds a reference to cropArea of image's original to the database. Returns the id of the reference.
+ */
+int cwCropImageTask::addCropToDatabase(const QString& filename, QRect cropArea, const cwImage& image)
+{
+    QVariantMap map({
+                        {cwImageProvider::cropIdKey(), image.original()},
+                        {cwImageProvider::cropXKey(), cropArea.x()},
+                        {cwImageProvider::cropYKey(), cropArea.y()},
+                        {cwImageProvider::cropWidthKey(), cropArea.width()},
+                        {cwImageProvider::cropHeightKey(), cropArea.height()}
+                    });
+    auto document = QJsonDocument::fromVariant(map);
+    auto json = document.toJson(QJsonDocument::Compact);
+
+    cwImageData imageData(cropArea.size(),
+                          image.originalDotsPerMeter(),
+                          cwImageProvider::croppedReferenceExtension(),
+                          json);
+
+    cwImageDatabase database(filename);
+    return database.addImage(imageData);
+}
+
+/**
+ * Creates the cropped image's mipmaps from original's DXT1 mipmaps, without decoding the original
+ * or running the compresser on the whole crop.
+ *
+ * cropArea is block aligned in the original's level 0. Levels where the crop is still block aligned
+ * are copied block by block. The lower levels, where the crop isn't aligned, only decode the blocks
+ * that cover the crop and re-encode them.
+ *
+ * Returns a null pointer if the crop can't be made from the mipmaps, for example, if the crop goes
+ * outside of the original, or the mipmaps are missing. The caller should fall back to cropping
+ * the original.
+ */
+cwTrackedImagePtr cwCropImageTask::cropMipmapBlocks(const QString &filename, const cwImage &original, QRect cropArea)
+{
+    const QList<int> originalMipmaps = original.mipmaps();
+    const int numberOfLevels = cwMipmapPyramid::numberOfLevels(cropArea.size());
+    if(originalMipmaps.size() < numberOfLevels || original.originalSize().isEmpty()) {
+        return cwTrackedImagePtr();
+    }
+
+    //The mipmaps are mirrored for OpenGL, so the crop is flipped into texture coordinates
+    const QPoint textureOrigin(cropArea.x(), original.originalSize().height() - cropArea.bottom() - 1);
+
+    cwImageProvider provider;
+    provider.setProjectPath(filename);
 
-    auto addImageFuture = AsyncFuture::observe(cropFuture)
-            .subscribe([cropFuture, filename, format]()
+    //The crop references the original, make sure it's there, without reading it's data
+    cwImageData originalMetadata = provider.originalMetadata(original);
+    if(originalMetadata.size() != original.originalSize()
+            || (originalMetadata.format() != cwImageProvider::croppedReferenceExtension()
+                && !QImageReader::supportedImageFormats().contains(originalMetadata.format().toLower())))
     {
-        int imageTypes = cwAddImageTask::None;
-        if(format == cwTextureUploadTask::DXT1Mipmaps) {
-            imageTypes |= cwAddImageTask::Mipmaps;
+        return cwTrackedImagePtr();
+    }
+
+    QList<cwImageData> croppedMipmaps;
+    croppedMipmaps.reserve(numberOfLevels);
+
+    QSize levelSize = cropArea.size();
+    for(int level = 0; level < numberOfLevels; level++) {
+        cwImageData originalLevel = provider.data(originalMipmaps.at(level));
+        if(originalLevel.format() != cwImageProvider::dxt1GzExtension()
+                || originalLevel.data().size() < cwDXT1Encoder::storageSize(originalLevel.size()))
+        {
+            return cwTrackedImagePtr();
         }
 
-        Image cropRGBImage = cropFuture.result();
-        if(cropRGBImage.id < 0) {
-            //Bad image, add the red image crop
-            imageTypes |= cwAddImageTask::Original;
+        QRect levelRect(QPoint(textureOrigin.x() >> level, textureOrigin.y() >> level), levelSize);
+        bool aligned = textureOrigin.x() % (4 << level) == 0
+                && textureOrigin.y() % (4 << level) == 0;
+
+        QByteArray levelData;
+        if(aligned) {
+            levelData = copyBlocks(originalLevel, levelRect);
+        } else {
+            levelData = reencodeBlocks(originalLevel, levelRect);
         }
 
-        cwAddImageTask addImages;
-        addImages.setDatabaseFilename(filename);
-        addImages.setNewImages({cropRGBImage.croppedImage});
-        addImages.setImageTypes(imageTypes);
+        if(levelData.isEmpty()) {
+            return cwTrackedImagePtr();
+        }
 
-        return addImages.images();
-    }).future();
+        croppedMipmaps.append(cwImageProvider::createDxt1(levelSize, levelData));
+        levelSize = cwMipmapPyramid::halfSize(levelSize);
+    }
 
-    auto finishedFuture = AsyncFuture::observe(addImageFuture)
-            .subscribe([addImageFuture, cropFuture]()
-    {
-        auto cropRGBImage = cropFuture.result();
-        auto images = addImageFuture.results();
-        if(!images.isEmpty()) {
-            auto imagePtr = images.first();
-            if(cropRGBImage.id > 0) {
-                //Update with the ref image
-                imagePtr->setOriginalDotsPerMeter(cropRGBImage.dotsPerMeter);
-                imagePtr->setOriginalSize(cropRGBImage.croppedImage.size());
-                imagePtr->setOriginal(cropRGBImage.id);
-            }
-            return images.first();
-        }
+    int referenceId = addCropToDatabase(filename, cropArea, original);
+    if(referenceId < 0) {
         return cwTrackedImagePtr();
-    }).future();
+    }
+
+    QList<int> newIds;
+    for(int i = 0; i < croppedMipmaps.size(); i++) {
+        newIds.append(-1);
+    }
+    QList<int> mipmapIds = cwImageDatabase(filename).addOrUpdateImages(croppedMipmaps, newIds);
+
+    cwImage croppedImage;
+    croppedImage.setOriginal(referenceId);
+    croppedImage.setOriginalSize(cropArea.size());
+    croppedImage.setOriginalDotsPerMeter(original.originalDotsPerMeter());
+    croppedImage.setMipmaps(mipmapIds);
+
+    auto croppedImagePtr = cwTrackedImage::createShared(croppedImage, filename);
+    if(mipmapIds.contains(-1)) {
+        //croppedImagePtr removes the images that were added, when it goes out of scope
+        return cwTrackedImagePtr();
+    }
+
+    return croppedImagePtr;
+}
+
+/**
+ * Returns the blocks of dxt1Level, that cover rect. rect is in texture coordinates and must
+ * start on a block. Returns an empty array if rect isn't inside of dxt1Level.
+ */
+QByteArray cwCropImageTask::copyBlocks(const cwImageData &dxt1Level, QRect rect)
+{
+    constexpr int blockSize = 4;
+    constexpr int bytesPerBlock = 8;
+
+    Q_ASSERT(rect.x() % blockSize == 0);
+    Q_ASSERT(rect.y() % blockSize == 0);
+
+    auto blocks = [](int pixels) { return (pixels + blockSize - 1) / blockSize; };
+
+    const int sourceBlocksPerRow = blocks(dxt1Level.size().width());
+    const int sourceBlockRows = blocks(dxt1Level.size().height());
+
+    const int firstColumn = rect.x() / blockSize;
+    const int firstRow = rect.y() / blockSize;
+    const int columns = blocks(rect.width());
+    const int rows = blocks(rect.height());
+
+    if(rect.x() < 0 || rect.y() < 0
+            || firstColumn + columns > sourceBlocksPerRow
+            || firstRow + rows > sourceBlockRows)
+    {
+        return QByteArray();
+    }
+
+    const QByteArray source = dxt1Level.data();
+    QByteArray output(columns * rows * bytesPerBlock, 0);
+    for(int row = 0; row < rows; row++) {
+        const char* sourceRow = source.constData() + ((firstRow + row) * sourceBlocksPerRow + firstColumn) * bytesPerBlock;
+        memcpy(output.data() + row * columns * bytesPerBlock, sourceRow, static_cast<size_t>(columns * bytesPerBlock));
+    }
+    return output;
+}
 
-    return finishedFuture;
+/**
+ * Returns rect of dxt1Level as dxt1 data, for rects that don't start on a block. Only the blocks
+ * that cover rect are decoded. Returns an empty array if rect isn't inside of dxt1Level.
+ */
+QByteArray cwCropImageTask::reencodeBlocks(const cwImageData &dxt1Level, QRect rect)
+{
+    constexpr int blockSize = 4;
+    auto floorBlock = [](int value) { return value / blockSize * blockSize; };
+    auto ceilBlock = [](int value) { return (value + blockSize - 1) / blockSize * blockSize; };
+
+    QRect coverRect(QPoint(floorBlock(rect.x()), floorBlock(rect.y())),
+                    QPoint(ceilBlock(rect.x() + rect.width()) - 1, ceilBlock(rect.y() + rect.height()) - 1));
+
+    QByteArray coverBlocks = copyBlocks(dxt1Level, coverRect);
+    if(coverBlocks.isEmpty()) {
+        return QByteArray();
+    }
+
+    //decompressDxt1() isn't mirrored, so flip the rect back into image coordinates
+    QImage cover = cwImageProvider::decompressDxt1(cwImageData(coverRect.size(), 0, cwImageProvider::dxt1GzExtension(), coverBlocks));
+    QRect imageRect(rect.x() - coverRect.x(),
+                    coverRect.bottom() - rect.bottom(),
+                    rect.width(),
+                    rect.height());
+
+    return cwDXT1Encoder::compressImage(cover.copy(imageRect), cwDXT1Encoder::RangeFit);
 }
 
 /**
@@ -201,8 +387,50 @@ QRect cwCropImageTask::nearestDXT1Rect(QRect rect)
         return 4 * static_cast<int>(std::ceil(value / 4.0));
     };
 
-
     return QRect(QPoint(nearestFloor(rect.left()), nearestFloor(rect.top())),
                  QSize(nearestCeiling(rect.width()), nearestCeiling(rect.height())));
 }
 
+/**
+ * Returns the pixel rect of original that crop() cuts out for the normalized rect
+ *
+ * The rect is rounded to dxt1 blocks. For DXT1Mipmaps, the rect is also lined up with the blocks
+ * of the original's mipmaps, so cropMipmapBlocks() can copy them. The mipmaps are mirrored for
+ * OpenGL and padded at the top, so if the original's height isn't a multiple of 4, the rect is
+ * moved up by the padding. It's only moved if it stays inside of the original.
+ */
+QRect cwCropImageTask::cropArea(QRectF normalized, const cwImage &original, cwTextureUploadTask::Format format)
+{
+    const QSize imageSize = original.originalSize();
+    QRect rect = nearestDXT1Rect(mapNormalizedToIndex(normalized, imageSize));
+
+    if(format == cwTextureUploadTask::DXT1Mipmaps && original.isMipmapsValid()) {
+        int paddingHeight = (4 - imageSize.height() % 4) % 4;
+        if(rect.top() >= paddingHeight) {
+            rect.translate(0, -paddingHeight);
+        }
+    }
+
+    return rect;
+}
+
+/**
+ * Returns the normalized rect of original that's covered by the image that crop() creates
+ *
+ * This is the rect passed to setRectF() after it has been rounded by cropArea(). The texture
+ * coordinates of the cropped image should be relative to this rect, not the requested one.
+ */
+QRectF cwCropImageTask::normalizedCropArea(QRectF normalized, const cwImage &original, cwTextureUploadTask::Format format)
+{
+    const QSize imageSize = original.originalSize();
+    if(imageSize.isEmpty()) {
+        return normalized;
+    }
+
+    //Flip back from opengl to the normalized note coordinates
+    QRect rect = cropArea(normalized, original, format);
+    double width = imageSize.width();
+    double height = imageSize.height();
+    return QRectF(QPointF(rect.x() / width, 1.0 - (rect.y() + rect.height()) / height),
+                  QSizeF(rect.width() / width, rect.height() / height));
+}
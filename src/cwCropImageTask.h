@@ -40,6 +40,9 @@ public:
 
     QFuture<cwTrackedImagePtr> crop();
 
+    static QRect cropArea(QRectF normalized, const cwImage& original, cwTextureUploadTask::Format format);
+    static QRectF normalizedCropArea(QRectF normalized, const cwImage& original, cwTextureUploadTask::Format format);
+
 protected:
     virtual void runTask();
 
@@ -54,6 +57,11 @@ private:
 
     static QRect mapNormalizedToIndex(QRectF normalized, QSize size);
     static QRect nearestDXT1Rect(QRect rect);
+
+    static int addCropToDatabase(const QString& filename, QRect cropArea, const cwImage& image);
+    static cwTrackedImagePtr cropMipmapBlocks(const QString& filename, const cwImage& original, QRect cropArea);
+    static QByteArray copyBlocks(const cwImageData& dxt1Level, QRect rect);
+    static QByteArray reencodeBlocks(const cwImageData& dxt1Level, QRect rect);
 };
 
 #endif // CWCROPIMAGETASK_H
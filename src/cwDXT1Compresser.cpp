@@ -4,6 +4,7 @@
 #include "cwAsyncFuture.h"
 #include "cwOpenGLUtils.h"
 #include "cwOpenGLSettings.h"
+#include "cwDXT1Encoder.h"
 
 //Qt includes
 #include <QPoint>
@@ -13,6 +14,9 @@
 #include <QOpenGLFunctions>
 #include <QVector>
 
+//Std includes
+#include <algorithm>
+
 //For creating compressed DXT texture maps
 #include <squish.h>
 
@@ -34,7 +38,15 @@ QFuture<cwDXT1Compresser::CompressedImage> cwDXT1Compresser::compress(const QLis
     case cwOpenGLSettings::DXT1_GPU:
         return openglCompression(images, true);
     case cwOpenGLSettings::DXT1_Squish:
-        return squishCompression(images, true);
+        switch(cwOpenGLSettings::instance()->dxt1Quality()) {
+        case cwOpenGLSettings::DXT1_IterativeClusterFit:
+            return squishCompression(images, true);
+        case cwOpenGLSettings::DXT1_Balanced:
+            return nativeCompression(images, cwDXT1Encoder::RangeFit, true);
+        case cwOpenGLSettings::DXT1_Fast:
+            return nativeCompression(images, cwDXT1Encoder::BoundingBox, true);
+        }
+        break;
     }
 
     return squishCompression(images, true);
@@ -43,7 +55,8 @@ QFuture<cwDXT1Compresser::CompressedImage> cwDXT1Compresser::compress(const QLis
 
 QFuture<cwDXT1Compresser::CompressedImage> cwDXT1Compresser::openglCompression(const QList<QImage> &images, bool threaded)
 {
-    auto compressImages = [images]() {
+    QSize paddedSize = PaddedSize;
+    auto compressImages = [images, paddedSize]() {
         QOffscreenSurface* surface = nullptr;
         auto createSurface = [&surface]() {
             surface = new QOffscreenSurface();
@@ -67,7 +80,7 @@ QFuture<cwDXT1Compresser::CompressedImage> cwDXT1Compresser::openglCompression(c
 
         QList<cwDXT1Compresser::CompressedImage> compressedImages;
         for(auto image : images) {
-            compressedImages.append(compresser.openglDxt1Compression(image));
+            compressedImages.append(compresser.openglDxt1Compression(image, paddedSize));
         }
 
         compressionContext->doneCurrent();
@@ -97,13 +110,40 @@ QFuture<cwDXT1Compresser::CompressedImage> cwDXT1Compresser::openglCompression(c
 
 QFuture<cwDXT1Compresser::CompressedImage> cwDXT1Compresser::squishCompression(const QList<QImage> &images, bool threaded)
 {
+    QSize paddedSize = PaddedSize;
     std::function<QFuture<cwDXT1Compresser::CompressedImage> (const QImage&)> compress =
-            [](const QImage& image)
+            [paddedSize](const QImage& image)
     {
           return squishCompressImageThreaded(image,
+                                             paddedSize,
                                              squish::kDxt1 | squish::kColourIterativeClusterFit);
     };
 
+    return cpuCompression(images, compress, threaded);
+}
+
+/**
+ * Compresses the images on the CPU with cwDXT1Encoder, this is much faster than squishCompression(),
+ * but doesn't look as good
+ */
+QFuture<cwDXT1Compresser::CompressedImage> cwDXT1Compresser::nativeCompression(const QList<QImage> &images,
+                                                                               cwDXT1Encoder::Mode mode,
+                                                                               bool threaded)
+{
+    QSize paddedSize = PaddedSize;
+    std::function<QFuture<cwDXT1Compresser::CompressedImage> (const QImage&)> compress =
+            [mode, paddedSize](const QImage& image)
+    {
+          return nativeCompressImageThreaded(image, paddedSize, mode);
+    };
+
+    return cpuCompression(images, compress, threaded);
+}
+
+QFuture<cwDXT1Compresser::CompressedImage> cwDXT1Compresser::cpuCompression(const QList<QImage> &images,
+                                                                            std::function<QFuture<CompressedImage> (const QImage &)> compress,
+                                                                            bool threaded)
+{
     auto futureResults = [](const QList<QFuture<cwDXT1Compresser::CompressedImage>>& imageFutures) {
         auto compressFutures = AsyncFuture::combine() << imageFutures;
 
@@ -165,74 +205,62 @@ public:
     /**
       \param x - The x parameter
       \param y - The y parameter
-      \param rgba - The source rgba
       \param blockData - The output blockdata
       */
-    Block(int x, int y, const QImage& rgbaImage, void* blockData) :
-        image(rgbaImage)
+    Block(int x, int y, void* blockData)
     {
         Position = QPoint(x, y);
-        RGBA = image.constBits();
         BlockData = blockData;
     }
 
     QPoint Position;
-    const QImage image;
-    u8 const* RGBA;
     void* BlockData;
 };
 
 /**
   \brief This class compresses a signle block.  This allow squish library to be
   threaded.
+
+  If the kernal is created with a cwDXT1Encoder::Mode, cwDXT1Encoder is used instead of squish.
   */
 class CompressImageKernal {
 public:
-    CompressImageKernal(QSize imageSize, int flags, float* metric) {
-        ImageSize = imageSize;
+    CompressImageKernal(const QImage& image, QSize paddedSize, int flags, float* metric) :
+        Image(image)
+    {
+        ImageSize = image.size();
+        PaddedSize = paddedSize;
         Flags = flags;
         Metric = metric;
     }
 
-    QSize ImageSize;
-    int Flags;
-    float* Metric;
+    CompressImageKernal(const QImage& image, QSize paddedSize, cwDXT1Encoder::Mode mode) :
+        Image(image)
+    {
+        ImageSize = image.size();
+        PaddedSize = paddedSize;
+        UseSquish = false;
+        Mode = mode;
+    }
 
+    const QImage Image;
+    QSize ImageSize;
+    QSize PaddedSize;
+    int Flags = 0;
+    float* Metric = nullptr;
+    bool UseSquish = true;
+    cwDXT1Encoder::Mode Mode = cwDXT1Encoder::RangeFit;
 
     void operator()(Block block) {
         // build the 4x4 block of pixels
         u8 sourceRgba[16*4];
-        u8* targetPixel = sourceRgba;
-        int mask = 0;
-        for( int py = 0; py < 4; ++py )
-        {
-            for( int px = 0; px < 4; ++px )
-            {
-                // get the source pixel in the image
-                int sx = block.Position.x() + px;
-                int sy = block.Position.y() + py;
-
-                // enable if we're in the image
-                if( sx < ImageSize.width() && sy < ImageSize.height() )
-                {
-                    // copy the rgba value
-                    u8 const* sourcePixel = block.RGBA + 4*( ImageSize.width() * sy + sx );
-                    for( int i = 0; i < 4; ++i ) {
-                        *targetPixel++ = *sourcePixel++;
-                    }
-
-                    // enable this pixel
-                    mask |= ( 1 << ( 4*py + px ) );
-                }
-                else
-                {
-                    // skip this pixel as its outside the image
-                    targetPixel += 4;
-                }
-            }
-        }
+        int mask = cwDXT1Encoder::readBlock(Image, block.Position.x(), block.Position.y(), sourceRgba, PaddedSize);
 
-        CompressMasked(sourceRgba, mask, block.BlockData, Flags);
+        if(UseSquish) {
+            CompressMasked(sourceRgba, mask, block.BlockData, Flags);
+        } else {
+            cwDXT1Encoder::compressBlock(sourceRgba, mask, block.BlockData, Mode);
+        }
     }
 
 };
@@ -266,32 +294,52 @@ static int FixFlags( int flags )
   The only differance is this is threaded.
   */
 QFuture<cwDXT1Compresser::CompressedImage> cwDXT1Compresser::squishCompressImageThreaded( QImage image,
+                                                                                 QSize paddedSize,
                                                                                  int flags,
                                                                                  float* metric) {
-    int outputFileSize = squish::GetStorageRequirements(image.width(), image.height(), squish::kDxt1);
+    // fix any bad flags
+    flags = FixFlags( flags );
+    return compressBlocksThreaded(image, paddedSize, CompressImageKernal(image, paddedSize, flags, metric));
+}
+
+/**
+  \brief Compresses the image with cwDXT1Encoder, one block at a time in the thread pool
+  */
+QFuture<cwDXT1Compresser::CompressedImage> cwDXT1Compresser::nativeCompressImageThreaded(QImage image,
+                                                                                         QSize paddedSize,
+                                                                                         cwDXT1Encoder::Mode mode)
+{
+    return compressBlocksThreaded(image, paddedSize, CompressImageKernal(image, paddedSize, mode));
+}
+
+/**
+  \brief Runs kernal over all the blocks of the image in the thread pool
+
+  If paddedSize is larger than the image, the blocks cover paddedSize
+  */
+QFuture<cwDXT1Compresser::CompressedImage> cwDXT1Compresser::compressBlocksThreaded(QImage image,
+                                                                                    QSize paddedSize,
+                                                                                    const CompressImageKernal& kernal)
+{
+    const QSize size = paddedSize.expandedTo(image.size());
+    int outputFileSize = cwDXT1Encoder::storageSize(size);
 
     //Allocate the compress data
     QByteArray outputData;
     outputData.resize(outputFileSize);
 
-    //Convert the image to a real format
-    QImage convertedFormat = cwOpenGLUtils::toGLTexture(image);
-
-    // fix any bad flags
-    flags = FixFlags( flags );
-
     // initialise the block output
     u8* targetBlock = reinterpret_cast< u8* >( outputData.data() );
-    int bytesPerBlock = ( ( flags & kDxt1 ) != 0 ) ? 8 : 16;
+    int bytesPerBlock = 8;
 
     // loop over pixels and create blocks
     QVector<Block> computeBlocks;
-    computeBlocks.reserve((image.height() / 4 + 1) * (image.width() / 4 + 1) );
-    for( int y = 0; y < image.height(); y += 4 )
+    computeBlocks.reserve((size.height() / 4 + 1) * (size.width() / 4 + 1) );
+    for( int y = 0; y < size.height(); y += 4 )
     {
-        for( int x = 0; x < image.width(); x += 4 )
+        for( int x = 0; x < size.width(); x += 4 )
         {
-            computeBlocks.append(Block(x, y, convertedFormat, targetBlock));
+            computeBlocks.append(Block(x, y, targetBlock));
 
             // advance
             targetBlock += bytesPerBlock;
@@ -299,22 +347,24 @@ QFuture<cwDXT1Compresser::CompressedImage> cwDXT1Compresser::squishCompressImage
     }
 
     //This takes all the compute blocks and compresses them using squish
-    auto blockFuture = QtConcurrent::map(computeBlocks, CompressImageKernal(image.size(), flags, metric));
+    //The blocks read directly from image, so a converted copy of the whole image isn't needed
+    auto blockFuture = QtConcurrent::map(computeBlocks, kernal);
 
     return AsyncFuture::observe(blockFuture)
-            .subscribe([outputData, image, computeBlocks]() {
-        return CompressedImage(outputData, image.size());
+            .subscribe([outputData, size, computeBlocks]() {
+        return CompressedImage(outputData, size);
     }).future();
 }
 
 /**
  * @brief cwAddImageTask::graphicsDriverDx1Compression
  * @param image - The image to compress
+ * @param paddedSize - The size the image is padded to, see setPaddedSize()
  * @return Returns the compress image in DXT1 compression
  *
  * This assumes that the opengl context is bound
  */
-cwDXT1Compresser::CompressedImage cwDXT1Compresser::OpenGLCompresser::openglDxt1Compression(QImage image)
+cwDXT1Compresser::CompressedImage cwDXT1Compresser::OpenGLCompresser::openglDxt1Compression(QImage image, QSize paddedSize)
 {
     auto gl = std::make_unique<QOpenGLFunctions_2_1>();
     bool couldInit = gl->initializeOpenGLFunctions();
@@ -331,9 +381,22 @@ cwDXT1Compresser::CompressedImage cwDXT1Compresser::OpenGLCompresser::openglDxt1
     QImage convertedImage = cwOpenGLUtils::toGLTexture(image);
     CompressedImage outputImage;
 
+    const QSize size = paddedSize.expandedTo(image.size());
+    if(size != image.size()) {
+        //The upload needs a copy anyway, pad the mirrored copy by repeating the edge pixels
+        QImage paddedImage(size, convertedImage.format());
+        for(int y = 0; y < size.height(); y++) {
+            const quint32* source = reinterpret_cast<const quint32*>(convertedImage.constScanLine(std::min(y, image.height() - 1)));
+            quint32* destination = reinterpret_cast<quint32*>(paddedImage.scanLine(y));
+            std::copy(source, source + image.width(), destination);
+            std::fill(destination + image.width(), destination + size.width(), source[image.width() - 1]);
+        }
+        convertedImage = paddedImage;
+    }
+
     gl->glTexImage2D(GL_TEXTURE_2D,
                  0, GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
-                 image.width(), image.height(),
+                 size.width(), size.height(),
                  0, GL_RGBA,
                  GL_UNSIGNED_BYTE,
                  convertedImage.bits());
@@ -352,7 +415,7 @@ cwDXT1Compresser::CompressedImage cwDXT1Compresser::OpenGLCompresser::openglDxt1
         QByteArray compressedByteArray(compressed_size, 0);
         gl->glGetCompressedTexImage(GL_TEXTURE_2D, 0, compressedByteArray.data());
 
-        outputImage = CompressedImage(compressedByteArray, image.size());
+        outputImage = CompressedImage(compressedByteArray, size);
     }
 
     gl->glDeleteTextures(1, &texture);
@@ -8,6 +8,9 @@
 
 //Our includes
 #include "cwGlobals.h"
+#include "cwDXT1Encoder.h"
+
+class CompressImageKernal;
 
 class CAVEWHERE_LIB_EXPORT cwDXT1Compresser
 {
@@ -27,24 +30,60 @@ public:
     cwDXT1Compresser();
     ~cwDXT1Compresser();
 
+    void setPaddedSize(QSize paddedSize);
+    QSize paddedSize() const;
+
     QFuture<CompressedImage> compress(const QList<QImage>& images);
     QFuture<CompressedImage> openglCompression(const QList<QImage>& images, bool threaded = true);
     QFuture<CompressedImage> squishCompression(const QList<QImage>& images, bool threaded = true);
+    QFuture<CompressedImage> nativeCompression(const QList<QImage>& images, cwDXT1Encoder::Mode mode, bool threaded = true);
 
     QList<CompressedImage> results(QFuture<CompressedImage> future) const;
 
 private:
 
 
+    QSize PaddedSize;
+
     static QFuture<CompressedImage> squishCompressImageThreaded(QImage image,
+                                                                QSize paddedSize,
                                                                 int flags,
                                                                 float* metric = 0);
+    static QFuture<CompressedImage> nativeCompressImageThreaded(QImage image,
+                                                                QSize paddedSize,
+                                                                cwDXT1Encoder::Mode mode);
+    static QFuture<CompressedImage> compressBlocksThreaded(QImage image,
+                                                           QSize paddedSize,
+                                                           const CompressImageKernal& kernal);
+
+    static QFuture<CompressedImage> cpuCompression(const QList<QImage>& images,
+                                                   std::function<QFuture<CompressedImage> (const QImage&)> compress,
+                                                   bool threaded);
 
     class OpenGLCompresser : public QOpenGLFunctions_2_1 {
     public:
-        CompressedImage openglDxt1Compression(QImage image);
+        CompressedImage openglDxt1Compression(QImage image, QSize paddedSize = QSize());
     };
 
 };
 
+/**
+ * Sets the size that the images are padded to. Images that are smaller than paddedSize are
+ * compressed as if they were padded, by repeating their top row and last column, see
+ * cwDXT1Encoder::readBlock(). The compressed image has the padded size. By default, images
+ * aren't padded.
+ */
+inline void cwDXT1Compresser::setPaddedSize(QSize paddedSize)
+{
+    PaddedSize = paddedSize;
+}
+
+/**
+ * Returns the size that the images are padded to
+ */
+inline QSize cwDXT1Compresser::paddedSize() const
+{
+    return PaddedSize;
+}
+
 #endif // CWDXT1COMPRESSER_H
@@ -0,0 +1,436 @@
+//Our includes
+#include "cwDXT1Encoder.h"
+
+//Std includes
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+/**
+ * The pixels of a 4x4 block, one array per channel. W is 1 for pixels that are in the image
+ * and 0 for pixels that should be ignored.
+ */
+class PixelBlock {
+public:
+    float R[16];
+    float G[16];
+    float B[16];
+    float W[16];
+};
+
+class Palette {
+public:
+    float R[4];
+    float G[4];
+    float B[4];
+};
+
+//How much of color0 is in each palette index
+const float Color0Weights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+
+quint16 to565(float r, float g, float b)
+{
+    auto quantize = [](float value, int max) {
+        return std::min(max, std::max(0, static_cast<int>(value * max / 255.0f + 0.5f)));
+    };
+    return static_cast<quint16>((quantize(r, 31) << 11) | (quantize(g, 63) << 5) | quantize(b, 31));
+}
+
+void from565(quint16 color, float* r, float* g, float* b)
+{
+    int r5 = (color >> 11) & 0x1f;
+    int g6 = (color >> 5) & 0x3f;
+    int b5 = color & 0x1f;
+    *r = static_cast<float>((r5 << 3) | (r5 >> 2));
+    *g = static_cast<float>((g6 << 2) | (g6 >> 4));
+    *b = static_cast<float>((b5 << 3) | (b5 >> 2));
+}
+
+Palette createPalette(quint16 color0, quint16 color1)
+{
+    Palette palette;
+    from565(color0, &palette.R[0], &palette.G[0], &palette.B[0]);
+    from565(color1, &palette.R[1], &palette.G[1], &palette.B[1]);
+    for(int i = 2; i < 4; i++) {
+        float w = Color0Weights[i];
+        palette.R[i] = w * palette.R[0] + (1.0f - w) * palette.R[1];
+        palette.G[i] = w * palette.G[0] + (1.0f - w) * palette.G[1];
+        palette.B[i] = w * palette.B[0] + (1.0f - w) * palette.B[1];
+    }
+    return palette;
+}
+
+/**
+ * Finds the closest palette color for each pixel. Returns the total squared error.
+ */
+float closestIndices(const PixelBlock& pixels, const Palette& palette, int* indices)
+{
+    float error = 0.0f;
+    for(int i = 0; i < 16; i++) {
+        float best = std::numeric_limits<float>::max();
+        int bestIndex = 0;
+        for(int p = 0; p < 4; p++) {
+            float dr = pixels.R[i] - palette.R[p];
+            float dg = pixels.G[i] - palette.G[p];
+            float db = pixels.B[i] - palette.B[p];
+            float distance = dr * dr + dg * dg + db * db;
+            bool closer = distance < best;
+            best = closer ? distance : best;
+            bestIndex = closer ? p : bestIndex;
+        }
+        indices[i] = bestIndex;
+        error += best * pixels.W[i];
+    }
+    return error;
+}
+
+/**
+ * Projects each pixel onto the line between the palette's endpoints and rounds to the nearest
+ * of the four palette colors
+ */
+void projectedIndices(const PixelBlock& pixels, const Palette& palette, int* indices)
+{
+    //Index for 0/3, 1/3, 2/3 and 3/3 of the way from color1 to color0
+    const int levelToIndex[4] = {1, 3, 2, 0};
+
+    float dr = palette.R[0] - palette.R[1];
+    float dg = palette.G[0] - palette.G[1];
+    float db = palette.B[0] - palette.B[1];
+    float lengthSquared = dr * dr + dg * dg + db * db;
+    float scale = lengthSquared > 0.0f ? 3.0f / lengthSquared : 0.0f;
+
+    for(int i = 0; i < 16; i++) {
+        float t = ((pixels.R[i] - palette.R[1]) * dr
+                   + (pixels.G[i] - palette.G[1]) * dg
+                   + (pixels.B[i] - palette.B[1]) * db) * scale;
+        int level = std::min(3, std::max(0, static_cast<int>(t + 0.5f)));
+        indices[i] = levelToIndex[level];
+    }
+}
+
+/**
+ * Solves for the endpoints that minimize the squared error of the pixels with fixed indices.
+ * Returns false if the system is degenerate, for example when all pixels use the same index.
+ */
+bool leastSquaresEndpoints(const PixelBlock& pixels, const int* indices, quint16* color0, quint16* color1)
+{
+    //Normal equations, a is the weight of color0 and b is the weight of color1
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    float aR = 0.0f, aG = 0.0f, aB = 0.0f;
+    float bR = 0.0f, bG = 0.0f, bB = 0.0f;
+
+    for(int i = 0; i < 16; i++) {
+        float a = Color0Weights[indices[i]] * pixels.W[i];
+        float b = (1.0f - Color0Weights[indices[i]]) * pixels.W[i];
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        aR += a * pixels.R[i];
+        aG += a * pixels.G[i];
+        aB += a * pixels.B[i];
+        bR += b * pixels.R[i];
+        bG += b * pixels.G[i];
+        bB += b * pixels.B[i];
+    }
+
+    float determinant = aa * bb - ab * ab;
+    if(std::abs(determinant) < 1e-6f) {
+        return false;
+    }
+
+    float inverse = 1.0f / determinant;
+    auto solve0 = [=](float ap, float bp) { return (bb * ap - ab * bp) * inverse; };
+    auto solve1 = [=](float ap, float bp) { return (aa * bp - ab * ap) * inverse; };
+
+    *color0 = to565(solve0(aR, bR), solve0(aG, bG), solve0(aB, bB));
+    *color1 = to565(solve1(aR, bR), solve1(aG, bG), solve1(aB, bB));
+    return true;
+}
+
+/**
+ * Writes the block in 4 color mode, which needs color0 > color1
+ */
+void writeBlock(quint16 color0, quint16 color1, const int* indices, quint8* block)
+{
+    int indexXor = 0;
+    if(color0 < color1) {
+        //Swapping the endpoints swaps indices 0 <-> 1 and 2 <-> 3
+        std::swap(color0, color1);
+        indexXor = 1;
+    }
+
+    bool singleColor = color0 == color1;
+
+    block[0] = static_cast<quint8>(color0 & 0xff);
+    block[1] = static_cast<quint8>(color0 >> 8);
+    block[2] = static_cast<quint8>(color1 & 0xff);
+    block[3] = static_cast<quint8>(color1 >> 8);
+
+    for(int row = 0; row < 4; row++) {
+        quint8 packed = 0;
+        for(int column = 0; column < 4; column++) {
+            int index = singleColor ? 0 : indices[row * 4 + column] ^ indexXor;
+            packed |= static_cast<quint8>(index << (2 * column));
+        }
+        block[4 + row] = packed;
+    }
+}
+
+void boundingBoxEndpoints(const PixelBlock& pixels, quint16* color0, quint16* color1)
+{
+    float min[3] = {255.0f, 255.0f, 255.0f};
+    float max[3] = {0.0f, 0.0f, 0.0f};
+    float sum[3] = {0.0f, 0.0f, 0.0f};
+    float count = 0.0f;
+    const float* channels[3] = {pixels.R, pixels.G, pixels.B};
+
+    for(int c = 0; c < 3; c++) {
+        for(int i = 0; i < 16; i++) {
+            bool valid = pixels.W[i] > 0.0f;
+            min[c] = std::min(min[c], valid ? channels[c][i] : 255.0f);
+            max[c] = std::max(max[c], valid ? channels[c][i] : 0.0f);
+            sum[c] += channels[c][i] * pixels.W[i];
+        }
+    }
+
+    for(int i = 0; i < 16; i++) {
+        count += pixels.W[i];
+    }
+
+    //Flip the green and blue diagonal if they go against red
+    float covariance[3] = {0.0f, 0.0f, 0.0f};
+    for(int c = 0; c < 3; c++) {
+        for(int i = 0; i < 16; i++) {
+            covariance[c] += (pixels.R[i] - sum[0] / count) * (channels[c][i] - sum[c] / count) * pixels.W[i];
+        }
+    }
+
+    //Inset the box, this reduces the error from the endpoints
+    float start[3];
+    float end[3];
+    for(int c = 0; c < 3; c++) {
+        float inset = (max[c] - min[c]) / 16.0f;
+        start[c] = max[c] - inset;
+        end[c] = min[c] + inset;
+        if(c > 0 && covariance[c] < 0.0f) {
+            std::swap(start[c], end[c]);
+        }
+    }
+
+    *color0 = to565(start[0], start[1], start[2]);
+    *color1 = to565(end[0], end[1], end[2]);
+}
+
+void rangeFitEndpoints(const PixelBlock& pixels, quint16* color0, quint16* color1)
+{
+    const float* channels[3] = {pixels.R, pixels.G, pixels.B};
+
+    float count = 0.0f;
+    float mean[3] = {0.0f, 0.0f, 0.0f};
+    for(int i = 0; i < 16; i++) {
+        count += pixels.W[i];
+    }
+    for(int c = 0; c < 3; c++) {
+        for(int i = 0; i < 16; i++) {
+            mean[c] += channels[c][i] * pixels.W[i];
+        }
+        mean[c] /= count;
+    }
+
+    float covariance[3][3] = {};
+    for(int c0 = 0; c0 < 3; c0++) {
+        for(int c1 = c0; c1 < 3; c1++) {
+            float sum = 0.0f;
+            for(int i = 0; i < 16; i++) {
+                sum += (channels[c0][i] - mean[c0]) * (channels[c1][i] - mean[c1]) * pixels.W[i];
+            }
+            covariance[c0][c1] = sum;
+            covariance[c1][c0] = sum;
+        }
+    }
+
+    //Principal axis, by power iteration. Start from the row of the channel with the most variance,
+    //a fixed start, like gray, fails for blocks where the axis is orthogonal to it (red and blue)
+    int largestChannel = 0;
+    for(int c = 1; c < 3; c++) {
+        if(covariance[c][c] > covariance[largestChannel][largestChannel]) {
+            largestChannel = c;
+        }
+    }
+    float axis[3] = {covariance[largestChannel][0], covariance[largestChannel][1], covariance[largestChannel][2]};
+    for(int iteration = 0; iteration < 8; iteration++) {
+        float next[3];
+        for(int c = 0; c < 3; c++) {
+            next[c] = covariance[c][0] * axis[0] + covariance[c][1] * axis[1] + covariance[c][2] * axis[2];
+        }
+        float largest = std::max(std::abs(next[0]), std::max(std::abs(next[1]), std::abs(next[2])));
+        if(largest <= 0.0f) {
+            //All the pixels are the same color
+            *color0 = to565(mean[0], mean[1], mean[2]);
+            *color1 = *color0;
+            return;
+        }
+        for(int c = 0; c < 3; c++) {
+            axis[c] = next[c] / largest;
+        }
+    }
+
+    float length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+    for(int c = 0; c < 3; c++) {
+        axis[c] /= length;
+    }
+
+    float minT = std::numeric_limits<float>::max();
+    float maxT = -std::numeric_limits<float>::max();
+    for(int i = 0; i < 16; i++) {
+        bool valid = pixels.W[i] > 0.0f;
+        float t = (pixels.R[i] - mean[0]) * axis[0]
+                + (pixels.G[i] - mean[1]) * axis[1]
+                + (pixels.B[i] - mean[2]) * axis[2];
+        minT = std::min(minT, valid ? t : minT);
+        maxT = std::max(maxT, valid ? t : maxT);
+    }
+
+    *color0 = to565(mean[0] + axis[0] * maxT, mean[1] + axis[1] * maxT, mean[2] + axis[2] * maxT);
+    *color1 = to565(mean[0] + axis[0] * minT, mean[1] + axis[1] * minT, mean[2] + axis[2] * minT);
+}
+
+}
+
+/**
+ * Compresses a block of 16 pixels into 8 bytes of DXT1 data.
+ *
+ * rgba - 16 pixels, 4 bytes each in r, g, b, a order, row by row (the same input as squish::CompressMasked)
+ * mask - Bit i is set if pixel i should be used
+ * block - The 8 bytes of output
+ */
+void cwDXT1Encoder::compressBlock(const quint8 *rgba, int mask, void *block, Mode mode)
+{
+    quint8* output = static_cast<quint8*>(block);
+
+    PixelBlock pixels;
+    for(int i = 0; i < 16; i++) {
+        pixels.R[i] = rgba[4 * i];
+        pixels.G[i] = rgba[4 * i + 1];
+        pixels.B[i] = rgba[4 * i + 2];
+        pixels.W[i] = (mask >> i) & 1 ? 1.0f : 0.0f;
+    }
+
+    int indices[16] = {};
+
+    if((mask & 0xffff) == 0) {
+        writeBlock(0, 0, indices, output);
+        return;
+    }
+
+    quint16 color0;
+    quint16 color1;
+
+    switch(mode) {
+    case BoundingBox:
+        boundingBoxEndpoints(pixels, &color0, &color1);
+        projectedIndices(pixels, createPalette(color0, color1), indices);
+        break;
+    case RangeFit: {
+        rangeFitEndpoints(pixels, &color0, &color1);
+        float error = closestIndices(pixels, createPalette(color0, color1), indices);
+
+        quint16 refined0;
+        quint16 refined1;
+        if(error > 0.0f && leastSquaresEndpoints(pixels, indices, &refined0, &refined1)) {
+            int refinedIndices[16];
+            float refinedError = closestIndices(pixels, createPalette(refined0, refined1), refinedIndices);
+            if(refinedError < error) {
+                color0 = refined0;
+                color1 = refined1;
+                std::copy(refinedIndices, refinedIndices + 16, indices);
+            }
+        }
+        break;
+    }
+    }
+
+    writeBlock(color0, color1, indices, output);
+}
+
+/**
+ * Reads the 4x4 block at x, y into rgba, as non-premultiplied r, g, b, a bytes. The image is read
+ * mirrored, like cwOpenGLUtils::toGLTexture(), but without converting a copy of the whole image.
+ *
+ * If paddedSize is larger than the image, the image is read as if it was padded to paddedSize,
+ * without making a padded copy. The padding is at the top and right of the image and repeats the
+ * edge pixels, like cwAddImageTask::sizeDivisibleBy4() describes.
+ *
+ * Returns the mask of the pixels that are in the (padded) image, see compressBlock()
+ */
+int cwDXT1Encoder::readBlock(const QImage &image, int x, int y, quint8 *rgba, QSize paddedSize)
+{
+    auto pixel = [&image](int px, int py)->QRgb {
+        //Mirrored, the padding above the image repeats the top row
+        int sourceY = std::max(0, image.height() - 1 - py);
+        switch(image.format()) {
+        case QImage::Format_RGB32:
+        case QImage::Format_ARGB32:
+            return reinterpret_cast<const QRgb*>(image.constScanLine(sourceY))[px];
+        case QImage::Format_ARGB32_Premultiplied:
+            return qUnpremultiply(reinterpret_cast<const QRgb*>(image.constScanLine(sourceY))[px]);
+        default:
+            return image.pixel(px, sourceY);
+        }
+    };
+
+    const QSize size = paddedSize.expandedTo(image.size());
+
+    int mask = 0;
+    quint8* target = rgba;
+    for(int py = 0; py < 4; py++) {
+        for(int px = 0; px < 4; px++) {
+            int sx = x + px;
+            int sy = y + py;
+
+            if(sx < size.width() && sy < size.height()) {
+                //The padding to the right of the image repeats the last column
+                QRgb source = pixel(std::min(sx, image.width() - 1), sy);
+                target[0] = static_cast<quint8>(qRed(source));
+                target[1] = static_cast<quint8>(qGreen(source));
+                target[2] = static_cast<quint8>(qBlue(source));
+                target[3] = static_cast<quint8>(qAlpha(source));
+                mask |= 1 << (4 * py + px);
+            }
+            target += 4;
+        }
+    }
+
+    return mask;
+}
+
+/**
+ * Compresses the whole image in the calling thread. The output is the same layout that
+ * cwDXT1Compresser creates.
+ */
+QByteArray cwDXT1Encoder::compressImage(const QImage &image, Mode mode)
+{
+    QByteArray output(storageSize(image.size()), 0);
+    quint8* block = reinterpret_cast<quint8*>(output.data());
+
+    quint8 rgba[16 * 4];
+    for(int y = 0; y < image.height(); y += 4) {
+        for(int x = 0; x < image.width(); x += 4) {
+            int mask = readBlock(image, x, y, rgba);
+            compressBlock(rgba, mask, block, mode);
+            block += 8;
+        }
+    }
+
+    return output;
+}
+
+/**
+ * Returns the number of bytes of DXT1 data for an image of imageSize
+ */
+int cwDXT1Encoder::storageSize(QSize imageSize)
+{
+    return ((imageSize.width() + 3) / 4) * ((imageSize.height() + 3) / 4) * 8;
+}
@@ -0,0 +1,44 @@
+#ifndef CWDXT1ENCODER_H
+#define CWDXT1ENCODER_H
+
+//Our includes
+#include "cwGlobals.h"
+
+//Qt includes
+#include <QImage>
+#include <QByteArray>
+
+/**
+ * @brief The cwDXT1Encoder class is a fast DXT1 encoder, an alternative to squish's
+ * iterative cluster fit
+ *
+ * Blocks are always encoded in 4 color mode, alpha is ignored.
+ *
+ * BoundingBox - Uses the inset bounding box of the block's colors as the endpoints and projects the
+ * colors onto the line between them. This is the fastest mode.
+ *
+ * RangeFit - Uses the principal axis of the block's colors, picks the closest palette color for each pixel,
+ * and then refines the endpoints once with least squares. This is close to squish's quality
+ * at a fraction of the cost.
+ *
+ * The per pixel loops work on fixed size arrays of 16 floats, without branches, so the compiler can
+ * vectorize them.
+ */
+class CAVEWHERE_LIB_EXPORT cwDXT1Encoder
+{
+public:
+    enum Mode {
+        BoundingBox,
+        RangeFit
+    };
+
+    cwDXT1Encoder() = delete;
+
+    static void compressBlock(const quint8* rgba, int mask, void* block, Mode mode);
+    static int readBlock(const QImage& image, int x, int y, quint8* rgba, QSize paddedSize = QSize());
+    static QByteArray compressImage(const QImage& image, Mode mode);
+
+    static int storageSize(QSize imageSize);
+};
+
+#endif // CWDXT1ENCODER_H
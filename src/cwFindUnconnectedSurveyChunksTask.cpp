@@ -37,179 +37,64 @@ QList<cwFindUnconnectedSurveyChunksTask::Result> cwFindUnconnectedSurveyChunksTa
 
 /**
  * @brief cwFindUnconnectedSurveyChunksTask::runTask
+ *
+ * This always rebuilds Connectivity from all the chunks in the cave. cwLinePlotTask runs this on
+ * a copy of the region that's made for every run, so the chunk pointers can't be used to update
+ * Connectivity from the last run. cwLinePlotTask only runs this for caves that have changed.
  */
 void cwFindUnconnectedSurveyChunksTask::runTask()
 {
 
     //Do a full refresh
-    Connected.clear();
-    Unconnected.clear();
-    ChunkConnectedTo.clear();
-    ChunkToStationSet.clear();
+    Connectivity.clear();
     Results.clear();
 
-    //Index the cwSurveyChunk to station name sets
-    indexChunkToStations();
-
-    //Update the database which chunks are connected to other chunks
-    updateConnectedTo();
+    //Connect all the chunks by their stations
+    indexChunks();
 
-    //Add the first survey chunk in the first trip as Connected
-    //This will recursively find all the other connected trips, the connected set
-    //will be populated after this call
-    addFirstChunkAsConnected();
+    //The first survey chunk in the first trip is connected to the cave, every chunk
+    //connected to it is also connected to the cave
+    cwSurveyChunk* firstChunk = firstConnectedChunk();
 
     //update the unconnect chunks, this should be empty if there's no unconnected chunks
-    updateResults();
+    updateResults(firstChunk);
 
     done();
 }
 
 /**
- * @brief cwSurveyChunkConnectedToCaveTask::indexAllStationsToChunk
- */
-void cwFindUnconnectedSurveyChunksTask::indexChunkToStations()
-{
-    foreach(cwTrip* trip, Cave->trips()) {
-        foreach(cwSurveyChunk* chunk, trip->chunks()) {
-            ChunkToStationSet.insert(chunk, chunkToStationNameSet(chunk));
-        }
-    }
-}
-
-
-/**
- * @brief cwSurveyChunkConnectedToCaveTask::isChunksConnect
- * @param chunk1
- * @param chunk2
- * @return True if the chunk1 and chunk2 are connected
- *
- * Make sure chunk1 and chunk2 are added to ChunkToStationSet
- *
- * Returns false if chunk1 and chunk2 are equal to each other
- */
-bool cwFindUnconnectedSurveyChunksTask::isChunksConnect(cwSurveyChunk *chunk1, cwSurveyChunk *chunk2) const
-{
-    if(chunk1 == chunk2) { return false; }
-    Q_ASSERT(ChunkToStationSet.contains(chunk1) && ChunkToStationSet.contains(chunk2));
-
-    QSet<QString> set1 = ChunkToStationSet.value(chunk1);
-    QSet<QString> set2 = ChunkToStationSet.value(chunk2);
-
-    for(auto iter = set1.begin(); iter != set1.end(); iter++) {
-        if(set2.contains(*iter)) {
-            return true;
-        }
-    }
-    return false;
-}
-
-/**
- * @brief cwSurveyChunkConnectedToCaveTask::chunkToStationNameSet
- * @param chunk
- * @return
- */
-QSet<QString> cwFindUnconnectedSurveyChunksTask::chunkToStationNameSet(cwSurveyChunk *chunk) const
-{
-    QSet<QString> stationNameSet;
-    for(int i = 0; i < chunk->stationCount(); i++) {
-        QString name = chunk->data(cwSurveyChunk::StationNameRole, i).toString().toUpper();
-        if(!name.isEmpty()) {
-            stationNameSet.insert(name);
-        }
-    }
-    return stationNameSet;
-}
-
-/**
- * @brief cwSurveyChunkConnectedToCaveTask::addConnectedTo
- * @param chunk1
- * @param chunk2
+ * @brief cwFindUnconnectedSurveyChunksTask::indexChunks
  *
- * Attempts to index chunk1 and chunk2 if they're connected and aren't already connect. If chunk1
- * and chunk2 aren't connected, this function does nothing. If the chunk1 and chunk2 are already
- * indexed as connected, this function does nothing.
+ * Adds all the chunks in the cave to Connectivity
  */
-void cwFindUnconnectedSurveyChunksTask::addConnectedTo(cwSurveyChunk *chunk1, cwSurveyChunk *chunk2)
-{
-    if(isChunksConnect(chunk1, chunk2)) {
-        if(!ChunkConnectedTo.contains(chunk1, chunk2)) {
-            ChunkConnectedTo.insert(chunk1, chunk2);
-            ChunkConnectedTo.insert(chunk2, chunk1);
-        }
-    }
-}
-
-/**
- * @brief cwSurveyChunkConnectedToCaveTask::updateConnectedTo
- * @param chunk
- *
- * Loops through all the chunks in the cave and tries to connect the with chunk.
- * The ChunkConnectedTo database will be update with the connected chunk pairs
- */
-void cwFindUnconnectedSurveyChunksTask::updateConnectedTo(cwSurveyChunk *chunk)
+void cwFindUnconnectedSurveyChunksTask::indexChunks()
 {
     foreach(cwTrip* trip, Cave->trips()) {
-        foreach(cwSurveyChunk* currentChunk, trip->chunks()) {
-            addConnectedTo(chunk, currentChunk);
-        }
-    }
-}
-
-/**
- * @brief cwSurveyChunkConnectedToCaveTask::updateConnectedTo
- *
- * Loops through all the chunks in the cave and connects them to one another
- */
-void cwFindUnconnectedSurveyChunksTask::updateConnectedTo()
-{
-    foreach(cwTrip* trip, Cave->trips()) {
-        foreach(cwSurveyChunk* currentChunk, trip->chunks()) {
-            updateConnectedTo(currentChunk);
+        foreach(cwSurveyChunk* chunk, trip->chunks()) {
+            Connectivity.addChunk(chunk);
         }
     }
 }
 
 /**
- * @brief cwSurveyChunkConnectedToCaveTask::addFirstChunkAsConnected
+ * @brief cwFindUnconnectedSurveyChunksTask::firstConnectedChunk
+ * @return The first valid survey chunk that has a station name, or nullptr if there isn't one
  */
-void cwFindUnconnectedSurveyChunksTask::addFirstChunkAsConnected()
+cwSurveyChunk* cwFindUnconnectedSurveyChunksTask::firstConnectedChunk() const
 {
     foreach(cwTrip* trip, Cave->trips()) {
         foreach(cwSurveyChunk* chunk, trip->chunks()) {
             if(chunk->isValid()) {
-                for(int i = 0; i < chunk->stationCount(); i++) {
-                   QString stationName = chunk->data(cwSurveyChunk::StationNameRole, i).toString().toUpper();
-                   if(!stationName.isEmpty()) {
+                foreach(const QString& name, chunk->surveyData().stationNames()) {
+                   if(!name.isEmpty()) {
                        //Found the first survey chunk that has a valid station name
-                       insertChunkToConnected(chunk);
-                       return;
+                       return chunk;
                    }
                 }
             }
         }
     }
-}
-
-/**
- * @brief cwSurveyChunkConnectedToCaveTask::insertChunkToConnected
- * @param chunk
- *
- * This is a recursive function that inserts the chunk into the connected list.
- * All other chunks that are connected tho chunk and it's "child" are also added
- * to the connected list. The connected list are the chunks that are connected to
- * the cave
- */
-void cwFindUnconnectedSurveyChunksTask::insertChunkToConnected(cwSurveyChunk *chunk)
-{
-    if(!Connected.contains(chunk)) {
-        Connected.insert(chunk);
-
-        auto chunksConnetedToChunk = ChunkConnectedTo.values(chunk);
-        foreach(cwSurveyChunk* currentChunk, chunksConnetedToChunk) {
-            insertChunkToConnected(currentChunk);
-        }
-    }
+    return nullptr;
 }
 
 /**
@@ -217,7 +102,7 @@ void cwFindUnconnectedSurveyChunksTask::insertChunkToConnected(cwSurveyChunk *ch
  *
  * This update's a list of unconnected values
  */
-void cwFindUnconnectedSurveyChunksTask::updateResults()
+void cwFindUnconnectedSurveyChunksTask::updateResults(cwSurveyChunk* firstChunk)
 {
     Results.clear();
 
@@ -230,7 +115,8 @@ void cwFindUnconnectedSurveyChunksTask::updateResults()
         for(int c = 0; c < trip->chunkCount(); c++) {
             cwSurveyChunk* chunk = trip->chunk(c);
 
-            if(!Connected.contains(chunk) && !chunk->isStationAndShotsEmpty()) {
+            bool connected = firstChunk != nullptr && Connectivity.isConnected(firstChunk, chunk);
+            if(!connected && !chunk->isStationAndShotsEmpty()) {
                 //Found an unconnect chunk, create a result
                 Result result(t, c, error);
                 Results.append(result);
@@ -13,19 +13,21 @@
 #include "cwTask.h"
 #include "cwError.h"
 #include "cwGlobals.h"
+#include "cwSurveyChunkConnectivity.h"
 class cwCave;
 class cwSurveyChunk;
 
 //Qt includes
-#include <QHash>
-#include <QMultiHash>
-#include <QSet>
+#include <QList>
 
 /**
  * @brief The cwSurveyChunkConnectedToCaveTask class
  *
  * This returns a list of unconnected survey chunks. A unconnected survey chunk is a survey leg
  * that is floating in the cave, and isn't connected to the rest of the cave
+ *
+ * The chunks are connected with cwSurveyChunkConnectivity, so this is linear in the number
+ * of stations in the cave.
  */
 class CAVEWHERE_LIB_EXPORT cwFindUnconnectedSurveyChunksTask : public cwTask
 {
@@ -53,24 +55,13 @@ protected:
 private:
     cwCave* Cave;
 
-    QSet<cwSurveyChunk*> Connected; //Connect to the main cave
-    QSet<cwSurveyChunk*> Unconnected; //Not connected
-    QMultiHash<cwSurveyChunk*, cwSurveyChunk*> ChunkConnectedTo; //How the chunks are connect to each other
-
-    QHash<cwSurveyChunk*, QSet<QString>> ChunkToStationSet; //Index of cwSurveyChunk to station names set
+    cwSurveyChunkConnectivity Connectivity; //How the chunks are connect to each other
 
     QList<Result> Results;
 
-    void indexChunkToStations();
-
-    bool isChunksConnect(cwSurveyChunk* chunk1, cwSurveyChunk* chunk2) const;
-    QSet<QString> chunkToStationNameSet(cwSurveyChunk* chunk) const;
-    void addConnectedTo(cwSurveyChunk* chunk1, cwSurveyChunk* chunk2);
-    void updateConnectedTo(cwSurveyChunk* chunk);
-    void updateConnectedTo();
-    void addFirstChunkAsConnected();
-    void insertChunkToConnected(cwSurveyChunk* chunk);
-    void updateResults();
+    void indexChunks();
+    cwSurveyChunk* firstConnectedChunk() const;
+    void updateResults(cwSurveyChunk* firstChunk);
 
 
 };
@@ -0,0 +1,88 @@
+//Our includes
+#include "cwFrustumCuller.h"
+
+//Qt includes
+#include <QVector4D>
+#include <QVector2D>
+
+cwFrustumCuller::cwFrustumCuller()
+{
+}
+
+cwFrustumCuller::cwFrustumCuller(const QMatrix4x4 &viewProjection, const QRect &viewport) :
+    ViewProjection(viewProjection),
+    Viewport(viewport)
+{
+}
+
+/**
+ * Returns the smallest box that contains all the points
+ */
+cwFrustumCuller::Box cwFrustumCuller::Box::fromPoints(const QVector<QVector3D> &points)
+{
+    Box box;
+    for(const QVector3D& point : points) {
+        box.expand(point);
+    }
+    return box;
+}
+
+/**
+ * Returns Visible if the box should be drawn, otherwise the reason it was culled. Empty
+ * boxes are always outside of the frustum.
+ */
+cwFrustumCuller::Result cwFrustumCuller::test(const cwFrustumCuller::Box &box) const
+{
+    if(box.isEmpty()) {
+        return OutsideFrustum;
+    }
+
+    //Bits for each of the six clipping planes, set if the corner is outside of the plane
+    int outsideAll = 0x3F;
+    bool inFrontOfCamera = true;
+    QVector2D screenMin(std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
+    QVector2D screenMax = -screenMin;
+
+    for(int i = 0; i < 8; i++) {
+        QVector4D corner(i & 1 ? box.Max.x() : box.Min.x(),
+                         i & 2 ? box.Max.y() : box.Min.y(),
+                         i & 4 ? box.Max.z() : box.Min.z(),
+                         1.0f);
+        QVector4D clip = ViewProjection * corner;
+        const float w = clip.w();
+
+        int outside = 0;
+        outside |= clip.x() < -w ? 0x01 : 0;
+        outside |= clip.x() > w ? 0x02 : 0;
+        outside |= clip.y() < -w ? 0x04 : 0;
+        outside |= clip.y() > w ? 0x08 : 0;
+        outside |= clip.z() < -w ? 0x10 : 0;
+        outside |= clip.z() > w ? 0x20 : 0;
+        outsideAll &= outside;
+
+        if(w > 0.0f) {
+            QVector2D normalized(clip.x() / w, clip.y() / w);
+            screenMin = QVector2D(qMin(screenMin.x(), normalized.x()), qMin(screenMin.y(), normalized.y()));
+            screenMax = QVector2D(qMax(screenMax.x(), normalized.x()), qMax(screenMax.y(), normalized.y()));
+        } else {
+            //The box crosses the camera plane, so it can't be projected, and isn't small
+            inFrontOfCamera = false;
+        }
+    }
+
+    if(outsideAll != 0) {
+        return OutsideFrustum;
+    }
+
+    if(MinimumScreenSize > 0.0 && inFrontOfCamera) {
+        //Normalized device coordinates go from -1 to 1
+        QVector2D size = (screenMax - screenMin) * 0.5f;
+        double width = size.x() * Viewport.width();
+        double height = size.y() * Viewport.height();
+        if(width < MinimumScreenSize && height < MinimumScreenSize) {
+            return TooSmall;
+        }
+    }
+
+    return Visible;
+}
@@ -0,0 +1,107 @@
+#ifndef CWFRUSTUMCULLER_H
+#define CWFRUSTUMCULLER_H
+
+//Our includes
+#include "cwGlobals.h"
+
+//Qt includes
+#include <QMatrix4x4>
+#include <QVector3D>
+#include <QVector>
+#include <QRect>
+
+//Std includes
+#include <limits>
+
+/**
+ * @brief The cwFrustumCuller class finds bounding boxes that don't need to be drawn
+ *
+ * A box is culled if it's outside of the camera's view frustum, or if it covers less than
+ * minimumScreenSize() pixels on the screen, in both width and height.
+ *
+ * The frustum test is conservative, a box is only culled if all of it's corners are outside
+ * the same clipping plane. Boxes near the corners of the frustum may be drawn even though
+ * they aren't visible.
+ *
+ * This doesn't need a OpenGL context, so it can be tested, and measured with software rendering.
+ */
+class CAVEWHERE_LIB_EXPORT cwFrustumCuller
+{
+public:
+    enum Result {
+        Visible,
+        OutsideFrustum,
+        TooSmall
+    };
+
+    /**
+     * An axis aligned bounding box, in world coordinates
+     */
+    class Box {
+    public:
+        Box() {}
+        Box(QVector3D min, QVector3D max) :
+            Min(min),
+            Max(max)
+        {}
+
+        QVector3D Min = QVector3D(std::numeric_limits<float>::max(),
+                                  std::numeric_limits<float>::max(),
+                                  std::numeric_limits<float>::max());
+        QVector3D Max = -Min;
+
+        bool isEmpty() const;
+        void expand(const QVector3D& point);
+
+        static Box fromPoints(const QVector<QVector3D>& points);
+    };
+
+    cwFrustumCuller();
+    cwFrustumCuller(const QMatrix4x4& viewProjection, const QRect& viewport);
+
+    double minimumScreenSize() const;
+    void setMinimumScreenSize(double pixels);
+
+    Result test(const Box& box) const;
+
+private:
+    QMatrix4x4 ViewProjection;
+    QRect Viewport;
+    double MinimumScreenSize = 2.0;
+};
+
+/**
+ * Returns true if no points have been added to the box
+ */
+inline bool cwFrustumCuller::Box::isEmpty() const
+{
+    return Min.x() > Max.x();
+}
+
+/**
+ * Grows the box so it contains point
+ */
+inline void cwFrustumCuller::Box::expand(const QVector3D &point)
+{
+    Min = QVector3D(qMin(Min.x(), point.x()), qMin(Min.y(), point.y()), qMin(Min.z(), point.z()));
+    Max = QVector3D(qMax(Max.x(), point.x()), qMax(Max.y(), point.y()), qMax(Max.z(), point.z()));
+}
+
+/**
+ * Returns the smallest width or height, in pixels, that a box can be drawn with
+ */
+inline double cwFrustumCuller::minimumScreenSize() const
+{
+    return MinimumScreenSize;
+}
+
+/**
+ * Sets the smallest width or height, in pixels, that a box can be drawn with. Boxes that are
+ * smaller in both directions are culled. Zero disables culling small boxes.
+ */
+inline void cwFrustumCuller::setMinimumScreenSize(double pixels)
+{
+    MinimumScreenSize = pixels;
+}
+
+#endif // CWFRUSTUMCULLER_H
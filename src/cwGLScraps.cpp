@@ -31,12 +31,28 @@ cwGLScraps::cwGLScraps(QObject *parent) :
 
 void cwGLScraps::initialize() {
     initializeShaders();
+
+    PointBuffer = QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
+    PointBuffer.create();
+
+    TexCoordBuffer = QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
+    TexCoordBuffer.create();
+
+    IndexBuffer = QOpenGLBuffer(QOpenGLBuffer::IndexBuffer);
+    IndexBuffer.create();
+
+    //The new buffers are empty
+    RebuildBuffers = true;
 }
 
 void cwGLScraps::releaseResources()
 {
     deleteShaders(Program);
 
+    PointBuffer.destroy();
+    TexCoordBuffer.destroy();
+    IndexBuffer.destroy();
+
     for(auto scrap : Scraps) {
         scrap.releaseResources();
     }
@@ -44,40 +60,66 @@ void cwGLScraps::releaseResources()
 }
 
 void cwGLScraps::draw() {
+    Statistics = CullingStatistics();
+
     if(Scraps.isEmpty()) { return; }
     if(!visible()) { return; }
 
+    QMatrix4x4 viewProjection = camera()->viewProjectionMatrix();
+    cwFrustumCuller culler(viewProjection, camera()->viewport());
+
     Program->bind();
-    Program->setUniformValue(UniformModelViewProjectionMatrix, camera()->viewProjectionMatrix());
+    Program->setUniformValue(UniformModelViewProjectionMatrix, viewProjection);
     Program->enableAttributeArray(vVertex);
     Program->enableAttributeArray(vScrapTexCoords);
 
     glEnable(GL_DEPTH_TEST);
 
-    foreach(GLScrap scrap, Scraps) {
+    //Every scrap is in the same buffers, so they're only bound once
+    IndexBuffer.bind();
+
+    PointBuffer.bind();
+    Program->setAttributeBuffer(vVertex, GL_FLOAT, 0, 3);
+
+    TexCoordBuffer.bind();
+    Program->setAttributeBuffer(vScrapTexCoords, GL_FLOAT, 0, 2);
+
+    Statistics.Total = Scraps.size();
+
+    for(const GLScrap& scrap : Scraps) {
+        if(CullingEnabled) {
+            switch(culler.test(scrap.BoundingBox)) {
+            case cwFrustumCuller::OutsideFrustum:
+                Statistics.FrustumCulled++;
+                continue;
+            case cwFrustumCuller::TooSmall:
+                Statistics.SmallCulled++;
+                continue;
+            case cwFrustumCuller::Visible:
+                break;
+            }
+        }
+
         Program->setUniformValue(UniformScaleTexCoords, scrap.Texture->scaleTexCoords());
 
         scrap.Texture->updateData();
 
         scrap.Texture->bind();
 
-        scrap.IndexBuffer.bind();
-
-        scrap.PointBuffer.bind();
-        Program->setAttributeBuffer(vVertex, GL_FLOAT, 0, 3);
-
-        scrap.TexCoords.bind();
-        Program->setAttributeBuffer(vScrapTexCoords, GL_FLOAT, 0, 2);
-
-        glDrawElements(GL_TRIANGLES, scrap.NumberOfIndices, GL_UNSIGNED_INT, nullptr);
-
-        scrap.IndexBuffer.release();
-        scrap.PointBuffer.release();
-        scrap.TexCoords.release();
+        glDrawElements(GL_TRIANGLES,
+                       scrap.NumberOfIndices,
+                       GL_UNSIGNED_INT,
+                       reinterpret_cast<const void*>(scrap.FirstIndex * sizeof(uint)));
 
         scrap.Texture->release();
+
+        Statistics.Drawn++;
     }
 
+    IndexBuffer.release();
+    PointBuffer.release();
+    TexCoordBuffer.release();
+
     glBindTexture(GL_TEXTURE_2D, 0);
 
     Program->disableAttributeArray(vVertex);
@@ -125,6 +167,7 @@ void cwGLScraps::updateData()
 
             //Update the geometry intersector
             geometryItersecter()->addObject(geometryObject);
+            BuffersDirty = true;
             break;
         }
         case PendingScrapCommand::RemoveScrap:
@@ -133,6 +176,8 @@ void cwGLScraps::updateData()
                  GLScrap& glScrap = Scraps[command.scrap()];
                  geometryItersecter()->removeObject(this, glScrap.ScrapId);
                  glScrap.releaseResources();
+
+                 //The scrap's range in the merged buffers isn't drawn, and is reused by the next rebuild
                  Scraps.remove(command.scrap());
             }
             break;
@@ -142,10 +187,147 @@ void cwGLScraps::updateData()
         }
     }
 
+    if(BuffersDirty) {
+        updateBuffers();
+    }
+
     scene()->update();
     PendingChanges.clear();
 }
 
+/**
+ * Writes the scraps that have changed into PointBuffer, TexCoordBuffer and IndexBuffer.
+ *
+ * Only the changed scraps' ranges are written. A scrap that still fits in it's range is written
+ * in place, otherwise it's moved to the free space at the end of the buffers. If there isn't
+ * enough free space, the buffers are rebuilt with rebuildBuffers().
+ */
+void cwGLScraps::updateBuffers()
+{
+    if(!RebuildBuffers) {
+        PointBuffer.bind();
+        TexCoordBuffer.bind();
+        IndexBuffer.bind();
+
+        for(GLScrap& scrap : Scraps) {
+            if(!scrap.BufferDirty) {
+                continue;
+            }
+
+            const int numberOfPoints = scrap.Data.points().size();
+            const int numberOfIndices = scrap.Data.indices().size();
+            if(numberOfPoints > scrap.PointCapacity || numberOfIndices > scrap.IndexCapacity) {
+                if(PointsUsed + numberOfPoints > PointsAllocated
+                        || IndicesUsed + numberOfIndices > IndicesAllocated)
+                {
+                    RebuildBuffers = true;
+                    break;
+                }
+
+                //The old range isn't used anymore
+                scrap.FirstPoint = PointsUsed;
+                scrap.PointCapacity = numberOfPoints;
+                scrap.FirstIndex = IndicesUsed;
+                scrap.IndexCapacity = numberOfIndices;
+                PointsUsed += numberOfPoints;
+                IndicesUsed += numberOfIndices;
+            }
+
+            writeScrapBuffers(scrap);
+        }
+
+        PointBuffer.release();
+        TexCoordBuffer.release();
+        IndexBuffer.release();
+    }
+
+    if(RebuildBuffers) {
+        rebuildBuffers();
+    }
+
+    BuffersDirty = false;
+}
+
+/**
+ * Copies every scrap's geometry into new buffers, packed one after the other.
+ *
+ * Each scrap's indices are offset by the number of points before it, so a scrap is drawn
+ * with the range of indices, from FirstIndex, without rebinding the buffers. The buffers
+ * are allocated with free space at the end, so scraps that grow can be moved there by
+ * updateBuffers(), without copying every scrap again.
+ */
+void cwGLScraps::rebuildBuffers()
+{
+    PointsUsed = 0;
+    IndicesUsed = 0;
+    for(GLScrap& scrap : Scraps) {
+        scrap.FirstPoint = PointsUsed;
+        scrap.PointCapacity = scrap.Data.points().size();
+        scrap.FirstIndex = IndicesUsed;
+        scrap.IndexCapacity = scrap.Data.indices().size();
+        PointsUsed += scrap.PointCapacity;
+        IndicesUsed += scrap.IndexCapacity;
+    }
+
+    PointsAllocated = PointsUsed + PointsUsed / 2;
+    IndicesAllocated = IndicesUsed + IndicesUsed / 2;
+
+    PointBuffer.bind();
+    PointBuffer.allocate(PointsAllocated * static_cast<int>(sizeof(QVector3D)));
+
+    TexCoordBuffer.bind();
+    TexCoordBuffer.allocate(PointsAllocated * static_cast<int>(sizeof(QVector2D)));
+
+    IndexBuffer.bind();
+    IndexBuffer.allocate(IndicesAllocated * static_cast<int>(sizeof(uint)));
+
+    for(GLScrap& scrap : Scraps) {
+        writeScrapBuffers(scrap);
+    }
+
+    PointBuffer.release();
+    TexCoordBuffer.release();
+    IndexBuffer.release();
+
+    RebuildBuffers = false;
+}
+
+/**
+ * Writes the scrap's points, texture coordinates and indices into it's range of the merged
+ * buffers. The buffers need to be bound, and the scrap's data needs to fit in it's range.
+ */
+void cwGLScraps::writeScrapBuffers(GLScrap &scrap)
+{
+    const QVector<QVector3D> points = scrap.Data.points();
+    const QVector<uint> scrapIndices = scrap.Data.indices();
+    Q_ASSERT(points.size() <= scrap.PointCapacity);
+    Q_ASSERT(scrapIndices.size() <= scrap.IndexCapacity);
+
+    //Keep the texture coordinates lined up with the points
+    QVector<QVector2D> texCoords = scrap.Data.texCoords();
+    texCoords.resize(points.size());
+
+    QVector<uint> indices;
+    indices.reserve(scrapIndices.size());
+    const uint firstPoint = static_cast<uint>(scrap.FirstPoint);
+    for(uint index : scrapIndices) {
+        indices.append(firstPoint + index);
+    }
+
+    PointBuffer.write(scrap.FirstPoint * static_cast<int>(sizeof(QVector3D)),
+                      points.constData(),
+                      points.size() * static_cast<int>(sizeof(QVector3D)));
+    TexCoordBuffer.write(scrap.FirstPoint * static_cast<int>(sizeof(QVector2D)),
+                         texCoords.constData(),
+                         texCoords.size() * static_cast<int>(sizeof(QVector2D)));
+    IndexBuffer.write(scrap.FirstIndex * static_cast<int>(sizeof(uint)),
+                      indices.constData(),
+                      indices.size() * static_cast<int>(sizeof(uint)));
+
+    scrap.NumberOfIndices = indices.size();
+    scrap.BufferDirty = false;
+}
+
 /**
  * @brief cwGLScraps::addScrapToUpdate
  * @param scrap - The scrap.  This isn't used, just for book keeping
@@ -238,7 +420,12 @@ void cwGLScraps::initializeShaders() {
 }
 
 cwGLScraps::GLScrap::GLScrap() :
+    FirstPoint(0),
+    PointCapacity(0),
+    FirstIndex(0),
+    IndexCapacity(0),
     NumberOfIndices(0),
+    BufferDirty(false),
     ScrapId(-1),
     Texture(nullptr)
 
@@ -249,18 +436,15 @@ cwGLScraps::GLScrap::GLScrap() :
 cwGLScraps::GLScrap::GLScrap(const cwTriangulatedData& data,
                              cwProject *project,
                              const cwFutureManagerToken &token) :
+    FirstPoint(0),
+    PointCapacity(0),
+    FirstIndex(0),
+    IndexCapacity(0),
+    NumberOfIndices(0),
+    BufferDirty(false),
     ScrapId(-1),
     Texture(new cwImageTexture())
 {
-    PointBuffer = QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
-    PointBuffer.create();
-
-    IndexBuffer = QOpenGLBuffer(QOpenGLBuffer::IndexBuffer);
-    IndexBuffer.create();
-
-    TexCoords = QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
-    TexCoords.create();
-
     //Upload the texture to the graphics card
     Texture->initialize();
     Texture->setProject(project->filename());
@@ -272,33 +456,19 @@ cwGLScraps::GLScrap::GLScrap(const cwTriangulatedData& data,
 /**
  * @brief cwGLScraps::GLScrap::update
  * @param data.  This update the data in the glSCrap
+ *
+ * The geometry is uploaded by cwGLScraps::updateBuffers()
  */
 void cwGLScraps::GLScrap::update(const cwTriangulatedData &data)
 {
-    PointBuffer.bind();
-    int pointBufferSize = data.points().size() * sizeof(QVector3D);
-    PointBuffer.allocate(data.points().constData(), pointBufferSize);
-    PointBuffer.release();
-
-    IndexBuffer.bind();
-    int indexBufferSize = data.indices().size() * sizeof(uint);
-    IndexBuffer.allocate(data.indices().constData(), indexBufferSize);
-    IndexBuffer.release();
-    NumberOfIndices = data.indices().size();
-
-    TexCoords.bind();
-    int texCoordSize = data.texCoords().size() * sizeof(QVector2D);
-    TexCoords.allocate(data.texCoords().constData(), texCoordSize);
-    TexCoords.release();
-
+    Data = data;
+    BufferDirty = true;
+    BoundingBox = cwFrustumCuller::Box::fromPoints(data.points());
     Texture->setImage(data.croppedImage());
 }
 
 void cwGLScraps::GLScrap::releaseResources()
 {
-    PointBuffer.destroy();
-    IndexBuffer.destroy();
-    TexCoords.destroy();
     Texture->releaseResources();
     delete Texture;
 }
@@ -14,6 +14,7 @@
 #include "cwImageTexture.h"
 #include "cwGeometryItersecter.h"
 #include "cwFutureManagerToken.h"
+#include "cwFrustumCuller.h"
 class cwCavingRegion;
 class cwProject;
 class cwScrap;
@@ -31,6 +32,17 @@ class cwGLScraps : public cwGLObject
     Q_PROPERTY(bool visible READ visible WRITE setVisible NOTIFY visibleChanged)
 
 public:
+    /**
+     * What happened to the scraps in the last draw(), see cullingStatistics()
+     */
+    class CullingStatistics {
+    public:
+        int Total = 0;
+        int FrustumCulled = 0;
+        int SmallCulled = 0;
+        int Drawn = 0;
+    };
+
     explicit cwGLScraps(QObject *parent = 0);
 
     cwProject* project() const;
@@ -50,6 +62,11 @@ public:
     bool visible() const;
     void setVisible(bool visible);
 
+    bool isCullingEnabled() const;
+    void setCullingEnabled(bool enabled);
+
+    CullingStatistics cullingStatistics() const;
+
 signals:
     void projectChanged();
     void visibleChanged();
@@ -95,11 +112,18 @@ private:
                 cwProject* project,
                 const cwFutureManagerToken& token);
 
-        QOpenGLBuffer PointBuffer;
-        QOpenGLBuffer IndexBuffer;
-        QOpenGLBuffer TexCoords;
+        cwTriangulatedData Data; //Copied into the merged buffers
+        cwFrustumCuller::Box BoundingBox;
 
+        //The scrap's range in the merged buffers. The capacities are the size of the range, the
+        //scrap's data can shrink without moving.
+        int FirstPoint;
+        int PointCapacity;
+        int FirstIndex;
+        int IndexCapacity;
         int NumberOfIndices;
+        bool BufferDirty; //Data needs to be written to the merged buffers
+
         int ScrapId; //For intersection
 
         cwImageTexture* Texture;
@@ -124,9 +148,26 @@ private:
     QHash<cwScrap*, GLScrap> Scraps;
     int MaxScrapId;
 
+    //All the scraps' geometry, so the buffers are only bound once per draw()
+    QOpenGLBuffer PointBuffer;
+    QOpenGLBuffer TexCoordBuffer;
+    QOpenGLBuffer IndexBuffer;
+    int PointsUsed = 0; //Ranges after this are free
+    int IndicesUsed = 0;
+    int PointsAllocated = 0;
+    int IndicesAllocated = 0;
+    bool BuffersDirty = false; //A scrap has BufferDirty set
+    bool RebuildBuffers = true; //All the scraps need to be copied into new buffers
+
+    bool CullingEnabled = true;
+    CullingStatistics Statistics;
+
     bool Visible; //!< True if the scraps are visible and false if they're not
 
     void initializeShaders();
+    void updateBuffers();
+    void rebuildBuffers();
+    void writeScrapBuffers(GLScrap& scrap);
 
 };
 
@@ -144,4 +185,27 @@ inline bool cwGLScraps::visible() const {
     return Visible;
 }
 
+/**
+Returns true if scraps that aren't visible, or are too small to see, are skipped by draw()
+*/
+inline bool cwGLScraps::isCullingEnabled() const {
+    return CullingEnabled;
+}
+
+/**
+Enables or disables culling, see isCullingEnabled(). This should only be called in the rendering
+thread.
+*/
+inline void cwGLScraps::setCullingEnabled(bool enabled) {
+    CullingEnabled = enabled;
+}
+
+/**
+Returns how many scraps were culled and drawn in the last draw(). This should only be called in the
+rendering thread.
+*/
+inline cwGLScraps::CullingStatistics cwGLScraps::cullingStatistics() const {
+    return Statistics;
+}
+
 #endif // CWGLSCRAPS_H
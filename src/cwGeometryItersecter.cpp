@@ -9,13 +9,15 @@
 #include "cwDebug.h"
 #include "cwGeometryItersecter.h"
 
-//Std limits
+//Std includes
 #include <limits>
 #include <math.h>
+#include <algorithm>
+#include <numeric>
 
 //Qt includes
 #include <QtNumeric>
-#include <QPlane3D>
+#include <QVarLengthArray>
 
 cwGeometryItersecter::cwGeometryItersecter()
 {
@@ -26,15 +28,17 @@ cwGeometryItersecter::cwGeometryItersecter()
  * @param object
  *
  * Add the object to the itersector
+ *
+ * If the object already exists is the interecter, the object will be replaced.
  */
 void cwGeometryItersecter::addObject(const cwGeometryItersecter::Object &object)
 {
     switch(object.type()) {
     case Triangles:
-        addTriangles(object);
+        addObjectData(object, 3);
         break;
     case Lines:
-        addLines(object);
+        addObjectData(object, 2);
         break;
     default:
         break;
@@ -52,19 +56,16 @@ void cwGeometryItersecter::addObject(const cwGeometryItersecter::Object &object)
 void cwGeometryItersecter::clear(cwGLObject *parentObject)
 {
     if(parentObject == nullptr) {
-        Nodes.clear();
-        return;
+        Objects.clear();
+    } else {
+        Objects.erase(std::remove_if(Objects.begin(), Objects.end(),
+                                     [parentObject](const ObjectData& data)
+        {
+            return data.Object.parent() == parentObject;
+        }), Objects.end());
     }
 
-    QList<Node>::iterator iter = Nodes.begin();
-    while(iter != Nodes.end()) {
-        Node& currentNode = *iter;
-        if(currentNode.Object.parent() == parentObject) {
-            iter = Nodes.erase(iter);
-        } else {
-            iter++;
-        }
-    }
+    rebuildObjectHierarchy();
 }
 
 /**
@@ -76,206 +77,608 @@ void cwGeometryItersecter::clear(cwGLObject *parentObject)
  */
 void cwGeometryItersecter::removeObject(cwGLObject *parentObject, uint id)
 {
-    QList<Node>::iterator iter = Nodes.begin();
-    while(iter != Nodes.end()) {
-        Node& currentNode = *iter;
-        if(currentNode.Object.parent() == parentObject &&
-                currentNode.Object.id() == id)
-        {
-            iter = Nodes.erase(iter);
-        } else {
-            ++iter;
-        }
+    auto newEnd = std::remove_if(Objects.begin(), Objects.end(),
+                                 [parentObject, id](const ObjectData& data)
+    {
+        return data.Object.parent() == parentObject && data.Object.id() == id;
+    });
+
+    if(newEnd != Objects.end()) {
+        Objects.erase(newEnd, Objects.end());
+        rebuildObjectHierarchy();
     }
 }
 
 /**
  * @brief cwGeometryItersecter::intersects
  * @param ray
- * @return Closes intersection to on the ray, or if no match, use nearest neighbor search
+ * @return Closest triangle intersection on the ray, or if there's no intersection, the closest point on
+ * the ray to the nearest primitive. If there's nothing in front of the ray, this returns NaN.
  */
 double cwGeometryItersecter::intersects(const QRay3D &ray) const
 {
-    QList<double> intersections;
-
-    foreach(Node node, Nodes) {
-
-        double t = node.BoundingBox.intersection(ray);
-        if(!qIsNaN(t)) {
-            intersections.append(t);
-        }
+    double t = closestIntersection(ray);
+    if(!qIsNaN(t)) {
+        return t;
     }
 
-    //See if we've intersected anything
-    if(intersections.size() == 0) {
-        return nearestNeighbor(ray); //Do a nearest neighbor search
-    }
-
-    //Find the max value int intersections
-    double maxValue = -std::numeric_limits<double>::max();
-    foreach(double t, intersections) {
-        maxValue = qMax(t, maxValue);
+    //Do a nearest neighbor search
+    QList<Neighbor> neighbors = nearestNeighbors(ray, 1);
+    if(neighbors.isEmpty()) {
+        return qSNaN();
     }
-
-    return maxValue;
+    return neighbors.first().T;
 }
 
 /**
- * @brief cwGeometryItersecter::addTriangles
- * @param object
+ * @brief cwGeometryItersecter::nearestNeighbors
+ * @param ray
+ * @param k - The maximum number of neighbors
+ * @return The k primitives (triangles or lines) that are closest to the ray, sorted by distance.
  *
- * Adds the object as a triangle, if the object already exist is the
- * interecter, the object will be replaced.
+ * A triangle's distance is the distance to it's closest edge. Only primitives that are in front of
+ * the ray's origin are returned.
  */
-void cwGeometryItersecter::addTriangles(const cwGeometryItersecter::Object &object)
+QList<cwGeometryItersecter::Neighbor> cwGeometryItersecter::nearestNeighbors(const QRay3D &ray, int k) const
 {
-    //Make sure the object has the right number of indices
-    if(object.indexes().size() % 3 != 0) {
-        qDebug() << "Can't add object" << object.parent() << object.id() << "because it has an invalid indexes" << LOCATION;
-        return;
+    QList<Neighbor> neighbors;
+    if(k <= 0 || ObjectHierarchy.Nodes.isEmpty()) {
+        return neighbors;
     }
 
-    removeObject(object.parent(), object.id());
+    const QVector3D origin = ray.origin();
+    const QVector3D direction = ray.direction();
+
+    auto worstDistance = [&neighbors, k]() {
+        return neighbors.size() < k ? std::numeric_limits<double>::max() : neighbors.last().Distance;
+    };
 
-    for(int i = 0; i < object.indexes().size(); i+=3) {
-        Nodes.append(Node(object, i));
+    auto addNeighbor = [&neighbors, k](const Neighbor& neighbor) {
+        auto iter = std::upper_bound(neighbors.begin(), neighbors.end(), neighbor,
+                                     [](const Neighbor& a, const Neighbor& b) { return a.Distance < b.Distance; });
+        neighbors.insert(iter, neighbor);
+        if(neighbors.size() > k) {
+            neighbors.removeLast();
+        }
+    };
+
+    //Visits the nodes of a hierarchy, nearest first, skipping nodes that can't be closer than the k'th neighbor
+    auto traverse = [&](const BoundingVolumeHierarchy& hierarchy, auto visitLeaf) {
+        QVarLengthArray<int, 64> stack;
+        stack.append(0);
+        while(!stack.isEmpty()) {
+            const BoundingVolumeHierarchy::Node& node = hierarchy.Nodes.at(stack.last());
+            stack.removeLast();
+
+            if(node.Box.lineDistance(origin, direction) >= worstDistance()) {
+                continue;
+            }
+
+            if(node.Count > 0) {
+                for(int i = node.Start; i < node.Start + node.Count; i++) {
+                    visitLeaf(hierarchy.Order.at(i));
+                }
+            } else {
+                int left = &node - hierarchy.Nodes.constData() + 1;
+                int right = node.Right;
+                double leftDistance = hierarchy.Nodes.at(left).Box.lineDistance(origin, direction);
+                double rightDistance = hierarchy.Nodes.at(right).Box.lineDistance(origin, direction);
+
+                //Push the farther child first, so the nearer child is visited first
+                if(leftDistance < rightDistance) {
+                    stack.append(right);
+                    stack.append(left);
+                } else {
+                    stack.append(left);
+                    stack.append(right);
+                }
+            }
+        }
+    };
+
+    traverse(ObjectHierarchy, [&](int objectIndex) {
+        const ObjectData& data = Objects.at(objectIndex);
+        int indexesPerPrimitive = data.indexesPerPrimitive();
+
+        traverse(data.Hierarchy, [&](int primitive) {
+            double bestDistance = std::numeric_limits<double>::max();
+            double bestT = 0.0;
+
+            //Lines have one edge, triangles have three
+            int numberOfEdges = indexesPerPrimitive == 2 ? 1 : 3;
+            for(int edge = 0; edge < numberOfEdges; edge++) {
+                QVector3D p0 = data.point(primitive, edge);
+                QVector3D p1 = data.point(primitive, (edge + 1) % indexesPerPrimitive);
+
+                double t;
+                double distance = raySegmentDistance(origin, direction, p0, p1, &t);
+                if(t > 0.0 && distance < bestDistance) {
+                    bestDistance = distance;
+                    bestT = t;
+                }
+            }
+
+            if(bestT > 0.0 && bestDistance < worstDistance()) {
+                addNeighbor(Neighbor(data.Object.parent(), data.Object.id(), bestT, bestDistance));
+            }
+        });
+    });
+
+    return neighbors;
+}
+
+/**
+ * Returns the number of primitives (triangles and lines) in the intersecter
+ */
+int cwGeometryItersecter::primitiveCount() const
+{
+    int count = 0;
+    for(const ObjectData& data : Objects) {
+        count += data.primitiveCount();
     }
+    return count;
 }
 
 /**
- * @brief cwGeometryItersecter::addLines
+ * @brief cwGeometryItersecter::addObjectData
  * @param object
+ * @param indexesPerPrimitive - 3 for triangles and 2 for lines
  *
- * Adds the object as a lines.
+ * Adds the object and builds the hierarchy over it's primitives.
  *
- * If the object already exists in the intersecter the object will be replace with
- * the new data.
+ * If the object already exist is the interecter, the object will be replaced.
  */
-void cwGeometryItersecter::addLines(const cwGeometryItersecter::Object &object)
+void cwGeometryItersecter::addObjectData(const cwGeometryItersecter::Object &object, int indexesPerPrimitive)
 {
     //Make sure the object has the right number of indices
-    if(object.indexes().size() % 2 != 0) {
+    if(object.indexes().size() % indexesPerPrimitive != 0) {
         qDebug() << "Can't add object" << object.parent() << object.id() << "because it has an invalid indexes" << LOCATION;
         return;
     }
 
-    removeObject(object.parent(), object.id());
+    uint numberOfPoints = static_cast<uint>(object.points().size());
+    bool validIndexes = std::all_of(object.indexes().begin(), object.indexes().end(),
+                                    [numberOfPoints](uint index) { return index < numberOfPoints; });
+    if(!validIndexes) {
+        qDebug() << "Can't add object" << object.parent() << object.id() << "because it has indexes out of range" << LOCATION;
+        return;
+    }
+
+    Objects.erase(std::remove_if(Objects.begin(), Objects.end(),
+                                 [&object](const ObjectData& data)
+    {
+        return data.Object.parent() == object.parent() && data.Object.id() == object.id();
+    }), Objects.end());
 
-    for(int i = 0; i < object.indexes().size(); i+=2) {
-        Node node = Node(object, i);
+    ObjectData data;
+    data.Object = object;
 
-        //Make sure the node is valid
-        if(!node.BoundingBox.isNull()) {
-            Nodes.append(node);
+    QVector<Bounds> primitiveBounds;
+    primitiveBounds.resize(data.primitiveCount());
+    for(int i = 0; i < primitiveBounds.size(); i++) {
+        for(int vertex = 0; vertex < indexesPerPrimitive; vertex++) {
+            primitiveBounds[i].expand(data.point(i, vertex));
         }
     }
+    data.Hierarchy.build(primitiveBounds);
+
+    if(!data.Hierarchy.Nodes.isEmpty()) {
+        Objects.append(data);
+    }
+
+    rebuildObjectHierarchy();
 }
 
+/**
+ * @brief cwGeometryItersecter::rebuildObjectHierarchy
+ *
+ * Rebuilds the top level hierarchy over all the objects. This is cheap, because it only
+ * depends on the number of objects, not the number of primitives.
+ */
+void cwGeometryItersecter::rebuildObjectHierarchy()
+{
+    QVector<Bounds> objectBounds;
+    objectBounds.reserve(Objects.size());
+    for(const ObjectData& data : Objects) {
+        objectBounds.append(data.Hierarchy.bounds());
+    }
+    ObjectHierarchy.build(objectBounds);
+}
 
 /**
- * @brief cwGeometryItersecter::nearestNeighbor
+ * @brief cwGeometryItersecter::closestIntersection
  * @param ray
- * @return Finds the point on the ray that's the nearest neigbor of the ray
+ * @return The closest t where the ray intersects a triangle, or NaN if it doesn't intersect
+ * any triangles
  */
-double cwGeometryItersecter::nearestNeighbor(const QRay3D &ray) const
+double cwGeometryItersecter::closestIntersection(const QRay3D &ray) const
 {
+    if(ObjectHierarchy.Nodes.isEmpty()) {
+        return qSNaN();
+    }
 
-    QVector<QVector3D> points;
-    points.resize(8);
-
-    double bestT = 0.0;
-    double bestDistance = std::numeric_limits<double>::max();
+    const QVector3D origin = ray.origin();
+    const QVector3D direction = ray.direction();
+    const QVector3D inverseDirection(1.0f / direction.x(), 1.0f / direction.y(), 1.0f / direction.z());
 
-    foreach(Node node, Nodes) {
+    double bestT = std::numeric_limits<double>::max();
 
-        QVector3D min = node.BoundingBox.minimum();
-        QVector3D max = node.BoundingBox.maximum();
+    auto traverse = [&](const BoundingVolumeHierarchy& hierarchy, auto visitLeaf) {
+        QVarLengthArray<int, 64> stack;
+        stack.append(0);
+        while(!stack.isEmpty()) {
+            int nodeIndex = stack.last();
+            stack.removeLast();
 
-        points[0] = min;
-        points[1] = QVector3D(max.x(), min.y(), min.z());
-        points[2] = QVector3D(max.x(), max.y(), min.z());
-        points[3] = QVector3D(min.x(), max.y(), min.z());
-        points[4] = QVector3D(min.x(), min.y(), max.z());
-        points[5] = QVector3D(max.x(), min.y(), max.z());
-        points[6] = QVector3D(min.x(), max.y(), max.z());
-        points[7] = max;
+            const BoundingVolumeHierarchy::Node& node = hierarchy.Nodes.at(nodeIndex);
+            if(!node.Box.intersects(origin, inverseDirection, bestT)) {
+                continue;
+            }
 
-        for(int i = 0; i < 8; i++) {
-            const QVector3D& point = points.at(i);
-            double distance = ray.distance(point);
-            if(distance < bestDistance) {
-                double t = ray.projectedDistance(point);
-                if(t > 0.0) {
-                    bestDistance = distance;
-                    bestT = t;
+            if(node.Count > 0) {
+                for(int i = node.Start; i < node.Start + node.Count; i++) {
+                    visitLeaf(hierarchy.Order.at(i));
                 }
+            } else {
+                stack.append(node.Right);
+                stack.append(nodeIndex + 1);
             }
         }
-    }
+    };
 
-    if(bestT == 0.0) {
+    traverse(ObjectHierarchy, [&](int objectIndex) {
+        const ObjectData& data = Objects.at(objectIndex);
+        if(data.Object.type() != Triangles) {
+            //Rays can't hit lines, lines are found with nearestNeighbors()
+            return;
+        }
+
+        traverse(data.Hierarchy, [&](int primitive) {
+            double t;
+            if(rayTriangle(origin, direction,
+                           data.point(primitive, 0),
+                           data.point(primitive, 1),
+                           data.point(primitive, 2),
+                           &t))
+            {
+                bestT = qMin(bestT, t);
+            }
+        });
+    });
+
+    if(bestT == std::numeric_limits<double>::max()) {
         return qSNaN();
     }
 
     return bestT;
 }
 
+/**
+ * @brief cwGeometryItersecter::rayTriangle
+ * @return True if the ray hits the triangle (from either side) in front of the ray's origin. t
+ * is set to the intersection.
+ *
+ * This uses the Möller–Trumbore algorithm.
+ */
+bool cwGeometryItersecter::rayTriangle(const QVector3D &origin, const QVector3D &direction,
+                                       const QVector3D &p0, const QVector3D &p1, const QVector3D &p2,
+                                       double *t)
+{
+    const float epsilon = 1e-7f;
+
+    QVector3D edge1 = p1 - p0;
+    QVector3D edge2 = p2 - p0;
+    QVector3D pVector = QVector3D::crossProduct(direction, edge2);
+    float determinant = QVector3D::dotProduct(edge1, pVector);
+    if(qAbs(determinant) < epsilon) {
+        //Parallel to the triangle, or the triangle is degenerate
+        return false;
+    }
+
+    float inverseDeterminant = 1.0f / determinant;
+    QVector3D tVector = origin - p0;
+    float u = QVector3D::dotProduct(tVector, pVector) * inverseDeterminant;
+    if(u < 0.0f || u > 1.0f) {
+        return false;
+    }
+
+    QVector3D qVector = QVector3D::crossProduct(tVector, edge1);
+    float v = QVector3D::dotProduct(direction, qVector) * inverseDeterminant;
+    if(v < 0.0f || u + v > 1.0f) {
+        return false;
+    }
+
+    float hitT = QVector3D::dotProduct(edge2, qVector) * inverseDeterminant;
+    if(hitT <= 0.0f) {
+        return false;
+    }
+
+    *t = hitT;
+    return true;
+}
+
+/**
+ * @brief cwGeometryItersecter::raySegmentDistance
+ * @return The distance between the ray and the line segment from p0 to p1. t is set to the
+ * closest point on the ray.
+ */
+double cwGeometryItersecter::raySegmentDistance(const QVector3D &origin, const QVector3D &direction,
+                                                const QVector3D &p0, const QVector3D &p1,
+                                                double *t)
+{
+    //Minimizes |origin + rayT * direction - (p0 + s * edge)|^2 with rayT >= 0 and 0 <= s <= 1
+    const double epsilon = 1e-12;
+
+    QVector3D edge = p1 - p0;
+    QVector3D r = origin - p0;
+    double a = QVector3D::dotProduct(direction, direction);
+    double b = QVector3D::dotProduct(direction, edge);
+    double c = QVector3D::dotProduct(edge, edge);
+    double f = QVector3D::dotProduct(edge, r);
+    double g = QVector3D::dotProduct(direction, r);
+
+    double rayT;
+    double s;
+    if(c <= epsilon) {
+        //The segment is a point
+        s = 0.0;
+        rayT = qMax(0.0, -g / a);
+    } else {
+        double denominator = a * c - b * b;
+        rayT = denominator > epsilon ? qMax(0.0, (b * f - c * g) / denominator) : 0.0;
+        s = (b * rayT + f) / c;
+
+        if(s < 0.0 || s > 1.0) {
+            s = qBound(0.0, s, 1.0);
+            rayT = qMax(0.0, (b * s - g) / a);
+            s = qBound(0.0, (b * rayT + f) / c, 1.0);
+        }
+    }
+
+    QVector3D rayPoint = origin + direction * static_cast<float>(rayT);
+    QVector3D segmentPoint = p0 + edge * static_cast<float>(s);
+
+    *t = rayT;
+    return (rayPoint - segmentPoint).length();
+}
+
+bool cwGeometryItersecter::Bounds::isEmpty() const
+{
+    return Min.x() > Max.x();
+}
 
-cwGeometryItersecter::Node::Node(const cwGeometryItersecter::Object &object, int indexInIndexes) :
-    Object(object),
-    IndexInIndexes(indexInIndexes)
+void cwGeometryItersecter::Bounds::expand(const QVector3D &point)
 {
+    Min = QVector3D(qMin(Min.x(), point.x()), qMin(Min.y(), point.y()), qMin(Min.z(), point.z()));
+    Max = QVector3D(qMax(Max.x(), point.x()), qMax(Max.y(), point.y()), qMax(Max.z(), point.z()));
+}
 
-    switch(object.type()) {
-    case Triangles:
-        BoundingBox = triangleToBoundingBox();
-        break;
-    case Lines:
-        BoundingBox = lineToBoundingBox();
-        break;
-    default:
-        break;
+void cwGeometryItersecter::Bounds::expand(const cwGeometryItersecter::Bounds &bounds)
+{
+    if(bounds.isEmpty()) {
+        return;
+    }
+    expand(bounds.Min);
+    expand(bounds.Max);
+}
+
+QVector3D cwGeometryItersecter::Bounds::center() const
+{
+    return (Min + Max) * 0.5f;
+}
+
+float cwGeometryItersecter::Bounds::surfaceArea() const
+{
+    if(isEmpty()) {
+        return 0.0f;
     }
+    QVector3D size = Max - Min;
+    return 2.0f * (size.x() * size.y() + size.y() * size.z() + size.z() * size.x());
+}
 
+int cwGeometryItersecter::Bounds::longestAxis() const
+{
+    QVector3D size = Max - Min;
+    if(size.x() >= size.y() && size.x() >= size.z()) {
+        return 0;
+    }
+    return size.y() >= size.z() ? 1 : 2;
 }
 
 /**
- * @brief cwGeometryItersecter::Node::triangleToBoundingBox
- * @return Creates a bounding box around a triangle
+ * Returns true if the ray intersects the box before maxT. This uses the slab test.
  */
-QBox3D cwGeometryItersecter::Node::triangleToBoundingBox() const
+bool cwGeometryItersecter::Bounds::intersects(const QVector3D &origin, const QVector3D &inverseDirection, double maxT) const
 {
-    QVector3D p1 = Object.points().at(Object.indexes().at(IndexInIndexes));
-    QVector3D p2 = Object.points().at(Object.indexes().at(IndexInIndexes + 1));
-    QVector3D p3 = Object.points().at(Object.indexes().at(IndexInIndexes + 2));
+    float tNear = 0.0f;
+    float tFar = static_cast<float>(qMin(maxT, static_cast<double>(std::numeric_limits<float>::max())));
 
-    QVector3D maxPoint(qMax(p1.x(), qMax(p2.x(), p3.x())),
-                       qMax(p1.y(), qMax(p2.y(), p3.y())),
-                       qMax(p1.z(), qMax(p2.z(), p3.z())));
+    for(int axis = 0; axis < 3; axis++) {
+        float t1 = (Min[axis] - origin[axis]) * inverseDirection[axis];
+        float t2 = (Max[axis] - origin[axis]) * inverseDirection[axis];
 
-    QVector3D minPoint(qMin(p1.x(), qMin(p2.x(), p3.x())),
-                       qMin(p1.y(), qMin(p2.y(), p3.y())),
-                       qMin(p1.z(), qMin(p2.z(), p3.z())));
+        //NaN happens when the ray is in the slab's plane and parallel to it, which is a hit
+        if(qIsNaN(t1) || qIsNaN(t2)) {
+            continue;
+        }
+
+        tNear = qMax(tNear, qMin(t1, t2));
+        tFar = qMin(tFar, qMax(t1, t2));
+    }
 
-    return QBox3D(minPoint, maxPoint);
+    return tNear <= tFar;
 }
 
 /**
- * @brief cwGeometryItersecter::Node::lineToBoundingBox
- * @return Creates a bounding box around a line
+ * Returns a lower bound of the distance between the box and the line through the ray.
+ *
+ * This uses the box's bounding sphere, so it's cheap and conservative.
+ */
+double cwGeometryItersecter::Bounds::lineDistance(const QVector3D &origin, const QVector3D &direction) const
+{
+    QVector3D center = this->center();
+    double radius = (Max - center).length();
+    double distance = QVector3D::crossProduct(center - origin, direction).length() / direction.length();
+    return qMax(0.0, distance - radius);
+}
+
+/**
+ * Builds the hierarchy over primitiveBounds. The indexes in Order are the indexes in primitiveBounds.
  */
-QBox3D cwGeometryItersecter::Node::lineToBoundingBox() const
+void cwGeometryItersecter::BoundingVolumeHierarchy::build(const QVector<Bounds> &primitiveBounds)
 {
-    QVector3D p1 = Object.points().at(Object.indexes().at(IndexInIndexes));
-    QVector3D p2 = Object.points().at(Object.indexes().at(IndexInIndexes + 1));
+    Nodes.clear();
+    Order.resize(primitiveBounds.size());
+    std::iota(Order.begin(), Order.end(), 0);
 
-    QVector3D maxPoint(qMax(p1.x(), p2.x()),
-                       qMax(p1.y(), p2.y()),
-                       qMax(p1.z(), p2.z()));
+    if(primitiveBounds.isEmpty()) {
+        return;
+    }
 
-    QVector3D minPoint(qMin(p1.x(), p2.x()),
-                       qMin(p1.y(), p2.y()),
-                       qMin(p1.z(), p2.z()));
+    QVector<QVector3D> centers;
+    centers.reserve(primitiveBounds.size());
+    for(const Bounds& bounds : primitiveBounds) {
+        centers.append(bounds.center());
+    }
 
-    return QBox3D(minPoint, maxPoint);
+    Nodes.reserve(primitiveBounds.size() * 2);
+    buildNode(0, primitiveBounds.size(), primitiveBounds, centers);
+    Nodes.squeeze();
+}
+
+/**
+ * Returns the bounds of the whole hierarchy
+ */
+cwGeometryItersecter::Bounds cwGeometryItersecter::BoundingVolumeHierarchy::bounds() const
+{
+    return Nodes.isEmpty() ? Bounds() : Nodes.first().Box;
+}
+
+/**
+ * Recursively builds the node for Order[start] to Order[end - 1] and returns the node's index.
+ *
+ * The split is found by binning the primitive's centers along the longest axis and picking
+ * the bin boundary with the lowest surface area heuristic cost.
+ */
+int cwGeometryItersecter::BoundingVolumeHierarchy::buildNode(int start, int end,
+                                                             const QVector<Bounds> &primitiveBounds,
+                                                             const QVector<QVector3D> &centers)
+{
+    const int maxLeafSize = 4;
+    const int maxSAHLeafSize = 16;
+    const int numberOfBins = 12;
+
+    int nodeIndex = Nodes.size();
+    Nodes.append(Node());
+
+    Bounds box;
+    Bounds centerBox;
+    for(int i = start; i < end; i++) {
+        box.expand(primitiveBounds.at(Order.at(i)));
+        centerBox.expand(centers.at(Order.at(i)));
+    }
+    Nodes[nodeIndex].Box = box;
+
+    auto makeLeaf = [this, nodeIndex, start, end]() {
+        Nodes[nodeIndex].Start = start;
+        Nodes[nodeIndex].Count = end - start;
+        return nodeIndex;
+    };
+
+    int count = end - start;
+    int axis = centerBox.longestAxis();
+    float axisMin = centerBox.Min[axis];
+    float axisExtent = centerBox.Max[axis] - axisMin;
+
+    if(count <= maxLeafSize || axisExtent <= 0.0f) {
+        return makeLeaf();
+    }
+
+    auto binIndex = [axis, axisMin, axisExtent](const QVector3D& center) {
+        int bin = static_cast<int>(numberOfBins * ((center[axis] - axisMin) / axisExtent));
+        return qBound(0, bin, numberOfBins - 1);
+    };
+
+    Bounds binBounds[numberOfBins];
+    int binCounts[numberOfBins] = {};
+    for(int i = start; i < end; i++) {
+        int primitive = Order.at(i);
+        int bin = binIndex(centers.at(primitive));
+        binCounts[bin]++;
+        binBounds[bin].expand(primitiveBounds.at(primitive));
+    }
+
+    //Sweep from the right, to get the area and count of all splits
+    float rightAreas[numberOfBins];
+    int rightCounts[numberOfBins];
+    Bounds rightBox;
+    int rightCount = 0;
+    for(int bin = numberOfBins - 1; bin > 0; bin--) {
+        rightBox.expand(binBounds[bin]);
+        rightCount += binCounts[bin];
+        rightAreas[bin] = rightBox.surfaceArea();
+        rightCounts[bin] = rightCount;
+    }
+
+    //Sweep from the left, the split is after bin
+    int bestSplit = -1;
+    float bestCost = std::numeric_limits<float>::max();
+    Bounds leftBox;
+    int leftCount = 0;
+    for(int bin = 0; bin < numberOfBins - 1; bin++) {
+        leftBox.expand(binBounds[bin]);
+        leftCount += binCounts[bin];
+        if(leftCount == 0 || rightCounts[bin + 1] == 0) {
+            continue;
+        }
+
+        float cost = leftCount * leftBox.surfaceArea() + rightCounts[bin + 1] * rightAreas[bin + 1];
+        if(cost < bestCost) {
+            bestCost = cost;
+            bestSplit = bin;
+        }
+    }
+
+    //Cost of traversing the node and testing the children, relative to testing all the primitives
+    float area = box.surfaceArea();
+    float splitCost = area > 0.0f ? 1.0f + bestCost / area : count;
+    if(count <= maxSAHLeafSize && (bestSplit < 0 || splitCost >= count)) {
+        return makeLeaf();
+    }
+
+    int middle;
+    if(bestSplit >= 0) {
+        middle = std::partition(Order.begin() + start, Order.begin() + end,
+                                [&](int primitive) { return binIndex(centers.at(primitive)) <= bestSplit; })
+                - Order.begin();
+    } else {
+        //All the centers are in one bin, split in the middle
+        middle = start + count / 2;
+        std::nth_element(Order.begin() + start, Order.begin() + middle, Order.begin() + end,
+                         [&](int a, int b) { return centers.at(a)[axis] < centers.at(b)[axis]; });
+    }
+
+    buildNode(start, middle, primitiveBounds, centers);
+    int right = buildNode(middle, end, primitiveBounds, centers);
+    Nodes[nodeIndex].Right = right;
+
+    return nodeIndex;
+}
+
+int cwGeometryItersecter::ObjectData::indexesPerPrimitive() const
+{
+    return Object.type() == Lines ? 2 : 3;
+}
+
+int cwGeometryItersecter::ObjectData::primitiveCount() const
+{
+    return Object.indexes().size() / indexesPerPrimitive();
+}
+
+/**
+ * Returns the vertex of the primitive
+ */
+QVector3D cwGeometryItersecter::ObjectData::point(int primitive, int vertex) const
+{
+    return Object.points().at(Object.indexes().at(primitive * indexesPerPrimitive() + vertex));
 }
@@ -14,6 +14,9 @@
 #include <QRay3D>
 #include <QBox3D>
 
+//Std includes
+#include <limits>
+
 //Our includes
 class cwGLObject;
 
@@ -53,6 +56,25 @@ public:
         PrimitiveType Type;
     };
 
+    /**
+     * A primitive that's near a ray, see nearestNeighbors()
+     */
+    class Neighbor {
+    public:
+        Neighbor() {}
+        Neighbor(cwGLObject* parent, uint id, double t, double distance) :
+            Parent(parent),
+            Id(id),
+            T(t),
+            Distance(distance)
+        {}
+
+        cwGLObject* Parent = nullptr;
+        uint Id = 0;
+        double T = 0.0; //The closest point on the ray to the primitive
+        double Distance = 0.0; //The distance between the ray and the primitive
+    };
+
     cwGeometryItersecter();
 
     void addObject(const cwGeometryItersecter::Object& object);
@@ -60,34 +82,101 @@ public:
     void removeObject(cwGLObject* parentObject, uint id);
 
     double intersects(const QRay3D& ray) const;
+    QList<Neighbor> nearestNeighbors(const QRay3D& ray, int k) const;
 
+    int objectCount() const;
+    int primitiveCount() const;
 
 private:
 
-    class Node {
+    /**
+     * An axis aligned bounding box. This is faster than QBox3D, because it doesn't
+     * keep track of null or infinite boxes.
+     */
+    class Bounds {
     public:
-        Node();
-        Node(const cwGeometryItersecter::Object& object, int indexInIndexes);
+        QVector3D Min = QVector3D(std::numeric_limits<float>::max(),
+                                  std::numeric_limits<float>::max(),
+                                  std::numeric_limits<float>::max());
+        QVector3D Max = -Min;
+
+        bool isEmpty() const;
+        void expand(const QVector3D& point);
+        void expand(const Bounds& bounds);
+        QVector3D center() const;
+        float surfaceArea() const;
+        int longestAxis() const;
+
+        bool intersects(const QVector3D& origin, const QVector3D& inverseDirection, double maxT) const;
+        double lineDistance(const QVector3D& origin, const QVector3D& direction) const;
+    };
 
-        QBox3D BoundingBox;
-        cwGeometryItersecter::Object Object;
-        int IndexInIndexes; //Where in Object this Node point's to
+    /**
+     * A bounding volume hierarchy built with the surface area heuristic (SAH)
+     *
+     * Nodes are stored depth first. An inner node's left child is the next node and
+     * Right is the index of it's right child. A leaf node's primitives are
+     * Order[Start] to Order[Start + Count - 1].
+     */
+    class BoundingVolumeHierarchy {
+    public:
+        class Node {
+        public:
+            Bounds Box;
+            int Start = 0;
+            int Count = 0; //Zero for inner nodes
+            int Right = -1;
+        };
+
+        QVector<Node> Nodes;
+        QVector<int> Order;
+
+        void build(const QVector<Bounds>& primitiveBounds);
+        Bounds bounds() const;
 
     private:
-        QBox3D triangleToBoundingBox() const;
-        QBox3D lineToBoundingBox() const;
+        int buildNode(int start, int end, const QVector<Bounds>& primitiveBounds, const QVector<QVector3D>& centers);
+    };
+
+    /**
+     * An object added with addObject(), with a hierarchy over it's primitives
+     */
+    class ObjectData {
+    public:
+        cwGeometryItersecter::Object Object;
+        BoundingVolumeHierarchy Hierarchy;
 
+        int indexesPerPrimitive() const;
+        int primitiveCount() const;
+        QVector3D point(int primitive, int vertex) const;
     };
 
-    QList<Node> Nodes;
+    //Objects are only added and removed as a whole, so the hierarchy over the objects is rebuilt, and
+    //each object's hierarchy is only built once
+    QVector<ObjectData> Objects;
+    BoundingVolumeHierarchy ObjectHierarchy;
+
+    void addObjectData(const cwGeometryItersecter::Object& object, int indexesPerPrimitive);
+    void rebuildObjectHierarchy();
 
-    void addTriangles(const cwGeometryItersecter::Object& object);
-    void addLines(const cwGeometryItersecter::Object& object);
+    double closestIntersection(const QRay3D& ray) const;
 
-    double nearestNeighbor(const QRay3D& ray) const;
-//    double LineLineIntersect(QVector3D p1, QVector3D p2, QVector3D p3, QVector3D p4) const;
+    static bool rayTriangle(const QVector3D& origin, const QVector3D& direction,
+                            const QVector3D& p0, const QVector3D& p1, const QVector3D& p2,
+                            double* t);
+    static double raySegmentDistance(const QVector3D& origin, const QVector3D& direction,
+                                     const QVector3D& p0, const QVector3D& p1,
+                                     double* t);
 };
 
+/**
+ * Returns the number of objects in the intersecter
+ */
+inline int cwGeometryItersecter::objectCount() const
+{
+    return Objects.size();
+}
+
 inline uint qHash(const cwGeometryItersecter::Object& object) {
     return object.id();
 }
@@ -0,0 +1,111 @@
+//Our includes
+#include "cwGlyphAtlas.h"
+
+//Qt includes
+#include <QFontMetricsF>
+#include <QPainter>
+#include <QPainterPath>
+#include <QtMath>
+
+cwGlyphAtlas::cwGlyphAtlas(const QFont &font) :
+    Font(font)
+{
+    QFontMetricsF metrics(Font);
+    Ascent = metrics.ascent();
+    LineHeight = metrics.height();
+
+    Image = QImage(AtlasWidth, 64, QImage::Format_ARGB32_Premultiplied);
+    Image.fill(Qt::transparent);
+}
+
+/**
+ * Renders the characters in text that aren't in the atlas yet.
+ *
+ * Returns true if glyphs were added, and image() has changed
+ */
+bool cwGlyphAtlas::addText(const QString &text)
+{
+    bool added = false;
+    for(QChar character : text) {
+        if(!Glyphs.contains(character)) {
+            addGlyph(character);
+            added = true;
+        }
+    }
+    return added;
+}
+
+/**
+ * Returns the size of the text, if it's drawn with the glyphs in the atlas. This doesn't
+ * include the outline.
+ */
+QSizeF cwGlyphAtlas::textSize(const QString &text) const
+{
+    qreal width = 0.0;
+    for(QChar character : text) {
+        width += Glyphs.value(character).Advance;
+    }
+    return QSizeF(width, LineHeight);
+}
+
+/**
+ * Returns the font that matches Label3d.qml
+ */
+QFont cwGlyphAtlas::defaultFont()
+{
+    QFont font;
+    font.setPixelSize(16);
+    return font;
+}
+
+/**
+ * Draws character into the next free cell of the atlas. Rows of cells are all the same height,
+ * when the image is full it's height is doubled.
+ */
+void cwGlyphAtlas::addGlyph(QChar character)
+{
+    QFontMetricsF metrics(Font);
+    qreal advance = metrics.horizontalAdvance(character);
+
+    const int border = Outline + Padding;
+    QSize cellSize(qMin(qCeil(advance) + border * 2, AtlasWidth),
+                   qCeil(LineHeight) + border * 2);
+
+    if(NextPosition.x() + cellSize.width() > Image.width()) {
+        NextPosition = QPoint(0, NextPosition.y() + cellSize.height());
+    }
+
+    if(NextPosition.y() + cellSize.height() > Image.height()) {
+        int height = Image.height();
+        while(NextPosition.y() + cellSize.height() > height) {
+            height *= 2;
+        }
+
+        QImage grownImage(Image.width(), height, QImage::Format_ARGB32_Premultiplied);
+        grownImage.fill(Qt::transparent);
+        QPainter painter(&grownImage);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.drawImage(0, 0, Image);
+        painter.end();
+        Image = grownImage;
+    }
+
+    QPainterPath path;
+    path.addText(QPointF(NextPosition.x() + border, NextPosition.y() + border + Ascent),
+                 Font,
+                 QString(character));
+
+    QPainter painter(&Image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.strokePath(path, QPen(Qt::black, Outline * 2.0, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
+    painter.fillPath(path, Qt::white);
+    painter.end();
+
+    Glyph glyph;
+    glyph.AtlasRect = QRect(NextPosition, cellSize);
+    glyph.Rect = QRectF(-border, -border, cellSize.width(), cellSize.height());
+    glyph.Advance = advance;
+    Glyphs.insert(character, glyph);
+
+    NextPosition.rx() += cellSize.width();
+}
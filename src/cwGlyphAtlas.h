@@ -0,0 +1,101 @@
+#ifndef CWGLYPHATLAS_H
+#define CWGLYPHATLAS_H
+
+//Our includes
+#include "cwGlobals.h"
+
+//Qt includes
+#include <QFont>
+#include <QImage>
+#include <QHash>
+#include <QRect>
+#include <QRectF>
+#include <QSizeF>
+#include <QString>
+
+/**
+ * @brief The cwGlyphAtlas class renders the glyphs of label text into a single image
+ *
+ * Glyphs are drawn white with a black outline, the same style as Label3d.qml, so a label
+ * can be drawn as one textured quad per character out of one texture. Glyphs are added with
+ * addText(), the image grows as needed.
+ *
+ * cwGlyphAtlas is a value class. Copies are cheap, and a copy can be read from another thread,
+ * while the original adds more glyphs.
+ */
+class CAVEWHERE_LIB_EXPORT cwGlyphAtlas
+{
+public:
+    class Glyph {
+    public:
+        QRect AtlasRect; //Where the glyph is in image(), in pixels
+        QRectF Rect; //Where the glyph is drawn, relative to the top left of the text
+        qreal Advance = 0.0; //Distance to the next glyph
+    };
+
+    cwGlyphAtlas(const QFont& font = defaultFont());
+
+    QFont font() const;
+
+    bool addText(const QString& text);
+    bool contains(QChar character) const;
+    Glyph glyph(QChar character) const;
+
+    QSizeF textSize(const QString& text) const;
+
+    QImage image() const;
+
+    static QFont defaultFont();
+
+private:
+    QFont Font;
+    QImage Image;
+    QHash<QChar, Glyph> Glyphs;
+
+    qreal Ascent = 0.0;
+    qreal LineHeight = 0.0;
+
+    //Where the next glyph is added, glyphs are packed in rows
+    QPoint NextPosition;
+
+    void addGlyph(QChar character);
+
+    static const int Outline = 1;
+    static const int Padding = 1;
+    static const int AtlasWidth = 512;
+};
+
+/**
+ * Returns the font that the glyphs are rendered with
+ */
+inline QFont cwGlyphAtlas::font() const
+{
+    return Font;
+}
+
+/**
+ * Returns true if the character has been rendered into the atlas
+ */
+inline bool cwGlyphAtlas::contains(QChar character) const
+{
+    return Glyphs.contains(character);
+}
+
+/**
+ * Returns the glyph for character. If the character isn't in the atlas, the glyph
+ * is empty.
+ */
+inline cwGlyphAtlas::Glyph cwGlyphAtlas::glyph(QChar character) const
+{
+    return Glyphs.value(character);
+}
+
+/**
+ * Returns the image with all the glyphs. The image is premultiplied ARGB.
+ */
+inline QImage cwGlyphAtlas::image() const
+{
+    return Image;
+}
+
+#endif // CWGLYPHATLAS_H
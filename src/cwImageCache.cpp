@@ -0,0 +1,216 @@
+//Our includes
+#include "cwImageCache.h"
+
+//Qt includes
+#include <QMutexLocker>
+
+cwImageCache::cwImageCache(qint64 maxBytes) :
+    MaxBytes(maxBytes)
+{
+}
+
+/**
+ * Returns the process wide image cache
+ */
+cwImageCache *cwImageCache::instance()
+{
+    static cwImageCache cache;
+    return &cache;
+}
+
+/**
+ * Returns the image for key. If the image isn't in the cache, decode is called to create the
+ * image, and the result is cached.
+ *
+ * If another thread is already decoding key, this waits for that thread instead of calling decode.
+ * Null images aren't cached.
+ */
+QImage cwImageCache::image(const cwImageCache::Key &key, std::function<QImage ()> decode)
+{
+    QMutexLocker locker(&Mutex);
+
+    auto iter = Entries.find(key);
+    while(iter != Entries.end() && iter->Decoding) {
+        DecodeFinished.wait(&Mutex);
+        iter = Entries.find(key);
+    }
+
+    if(iter != Entries.end()) {
+        Stats.Hits++;
+        LeastRecentlyUsed.splice(LeastRecentlyUsed.begin(), LeastRecentlyUsed, iter->LeastRecentlyUsed);
+        return iter->Image;
+    }
+
+    Stats.Misses++;
+
+    //Reserve the entry, so other threads wait for this decode
+    LeastRecentlyUsed.push_front(key);
+    Entry decodingEntry;
+    decodingEntry.Decoding = true;
+    decodingEntry.LeastRecentlyUsed = LeastRecentlyUsed.begin();
+    Entries.insert(key, decodingEntry);
+
+    //Decode without the lock, so other images can be used while this one decodes
+    QImage image;
+    locker.unlock();
+    try {
+        image = decode();
+    } catch(...) {
+        locker.relock();
+        finishDecoding(key, QImage());
+        throw;
+    }
+    locker.relock();
+
+    finishDecoding(key, image);
+    return image;
+}
+
+/**
+ * Returns true if key has been decoded and is in the cache
+ */
+bool cwImageCache::contains(const cwImageCache::Key &key) const
+{
+    QMutexLocker locker(&Mutex);
+    auto iter = Entries.find(key);
+    return iter != Entries.end() && !iter->Decoding;
+}
+
+/**
+ * Removes all the levels of image id from the cache. This should be called when the image
+ * is removed or changed in the database.
+ */
+void cwImageCache::remove(const QString &filename, int id)
+{
+    QMutexLocker locker(&Mutex);
+    for(auto iter = Entries.begin(); iter != Entries.end();) {
+        if(iter.key().Id == id && iter.key().Filename == filename) {
+            iter = removeEntry(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+/**
+ * Removes all the images from the cache
+ */
+void cwImageCache::clear()
+{
+    QMutexLocker locker(&Mutex);
+    for(auto iter = Entries.begin(); iter != Entries.end();) {
+        iter = removeEntry(iter);
+    }
+}
+
+/**
+ * Returns the maximum number of bytes of decoded images that the cache holds
+ */
+qint64 cwImageCache::maxBytes() const
+{
+    QMutexLocker locker(&Mutex);
+    return MaxBytes;
+}
+
+/**
+ * Sets the maximum number of bytes of decoded images that the cache holds. If the cache holds
+ * more than maxBytes, the least recently used images are removed.
+ */
+void cwImageCache::setMaxBytes(qint64 maxBytes)
+{
+    QMutexLocker locker(&Mutex);
+    MaxBytes = qMax(0ll, maxBytes);
+    evict(MaxBytes);
+}
+
+/**
+ * Returns the hit, miss, and eviction counters, and the current size of the cache
+ */
+cwImageCache::Statistics cwImageCache::statistics() const
+{
+    QMutexLocker locker(&Mutex);
+    return Stats;
+}
+
+/**
+ * Resets the hit, miss, and eviction counters
+ */
+void cwImageCache::resetStatistics()
+{
+    QMutexLocker locker(&Mutex);
+    Stats.Hits = 0;
+    Stats.Misses = 0;
+    Stats.Evictions = 0;
+}
+
+/**
+ * Removes the least recently used images until the cache is smaller than maxBytes. Images that
+ * are being decoded aren't removed.
+ *
+ * Mutex must be locked
+ */
+void cwImageCache::evict(qint64 maxBytes)
+{
+    auto lruIter = LeastRecentlyUsed.end();
+    while(Stats.Bytes > maxBytes && lruIter != LeastRecentlyUsed.begin()) {
+        --lruIter;
+        auto iter = Entries.find(*lruIter);
+        Q_ASSERT(iter != Entries.end());
+        if(iter->Decoding) {
+            continue;
+        }
+
+        //removeEntry() erases lruIter, continue from the newer image after it
+        auto newer = std::next(lruIter);
+        removeEntry(iter);
+        Stats.Evictions++;
+        lruIter = newer;
+    }
+}
+
+/**
+ * Stores the decoded image in the entry reserved by image() and wakes the threads waiting for it
+ *
+ * Mutex must be locked
+ */
+void cwImageCache::finishDecoding(const cwImageCache::Key &key, const QImage &image)
+{
+    auto iter = Entries.find(key);
+    Q_ASSERT(iter != Entries.end());
+    Q_ASSERT(iter->Decoding);
+
+    qint64 bytes = image.sizeInBytes();
+    if(image.isNull() || bytes > MaxBytes || iter->Removed) {
+        LeastRecentlyUsed.erase(iter->LeastRecentlyUsed);
+        Entries.erase(iter);
+    } else {
+        iter->Image = image;
+        iter->Bytes = bytes;
+        iter->Decoding = false;
+        Stats.Bytes += bytes;
+        Stats.Count++;
+        evict(MaxBytes);
+    }
+
+    DecodeFinished.wakeAll();
+}
+
+/**
+ * Removes the entry. Entries that are being decoded are only marked as removed, the decoding
+ * thread removes them when it's finished.
+ *
+ * Mutex must be locked
+ */
+QHash<cwImageCache::Key, cwImageCache::Entry>::iterator cwImageCache::removeEntry(QHash<Key, Entry>::iterator iter)
+{
+    if(iter->Decoding) {
+        //The decoding thread owns the entry, it'll remove it when it's finished
+        iter->Removed = true;
+        return ++iter;
+    }
+
+    Stats.Bytes -= iter->Bytes;
+    Stats.Count--;
+    LeastRecentlyUsed.erase(iter->LeastRecentlyUsed);
+    return Entries.erase(iter);
+}
@@ -0,0 +1,105 @@
+#ifndef CWIMAGECACHE_H
+#define CWIMAGECACHE_H
+
+//Our includes
+#include "cwGlobals.h"
+
+//Qt includes
+#include <QImage>
+#include <QHash>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QString>
+
+//Std includes
+#include <functional>
+#include <list>
+
+/**
+ * @brief The cwImageCache class is a process wide, memory bounded, least recently used cache
+ * of decoded images
+ *
+ * Images are keyed by project file, image id, and level. Level 0 is the full resolution image,
+ * other levels are smaller versions of the same image.
+ *
+ * If multiple threads ask for the same image at the same time, the image is only decoded once. The
+ * other threads wait for the first thread to finish decoding.
+ *
+ * The size of the cache is set by cwJobSettings::imageCacheSize().
+ *
+ * This class is thread safe.
+ */
+class CAVEWHERE_LIB_EXPORT cwImageCache
+{
+public:
+    class Key {
+    public:
+        Key() {}
+        Key(const QString& filename, int id, int level = 0) :
+            Filename(filename),
+            Id(id),
+            Level(level)
+        {}
+
+        bool operator==(const Key& other) const {
+            return Id == other.Id && Level == other.Level && Filename == other.Filename;
+        }
+
+        QString Filename;
+        int Id = -1;
+        int Level = 0;
+    };
+
+    class Statistics {
+    public:
+        qint64 Hits = 0;
+        qint64 Misses = 0;
+        qint64 Evictions = 0;
+        qint64 Bytes = 0; //Bytes currently in the cache
+        int Count = 0; //Number of images currently in the cache
+    };
+
+    cwImageCache(qint64 maxBytes = 256 * 1024 * 1024);
+
+    static cwImageCache* instance();
+
+    QImage image(const Key& key, std::function<QImage ()> decode);
+    bool contains(const Key& key) const;
+
+    void remove(const QString& filename, int id);
+    void clear();
+
+    qint64 maxBytes() const;
+    void setMaxBytes(qint64 maxBytes);
+
+    Statistics statistics() const;
+    void resetStatistics();
+
+private:
+    class Entry {
+    public:
+        QImage Image;
+        qint64 Bytes = 0;
+        bool Decoding = false;
+        bool Removed = false; //Removed while decoding, the decoded image is stale
+        std::list<Key>::iterator LeastRecentlyUsed;
+    };
+
+    mutable QMutex Mutex;
+    QWaitCondition DecodeFinished;
+
+    QHash<Key, Entry> Entries;
+    std::list<Key> LeastRecentlyUsed; //Front is the most recently used image
+    qint64 MaxBytes;
+    Statistics Stats;
+
+    void finishDecoding(const Key& key, const QImage& image);
+    void evict(qint64 maxBytes);
+    QHash<Key, Entry>::iterator removeEntry(QHash<Key, Entry>::iterator iter);
+};
+
+inline uint qHash(const cwImageCache::Key& key, uint seed = 0) {
+    return qHash(key.Filename, seed) ^ qHash(key.Id, seed) ^ (static_cast<uint>(key.Level) << 24);
+}
+
+#endif // CWIMAGECACHE_H
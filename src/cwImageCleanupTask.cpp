@@ -23,7 +23,8 @@
 #include <QVariant>
 #include <QSet>
 
-cwImageCleanupTask::cwImageCleanupTask()
+cwImageCleanupTask::cwImageCleanupTask() :
+    Region(nullptr)
 {
 }
 
@@ -101,20 +102,38 @@ void cwImageCleanupTask::tryFetchAllImageIds()
  */
 QSet<int> cwImageCleanupTask::extractAllValidImageIds()
 {
+    if(Region == nullptr) {
+        return ValidImageIds;
+    }
+
     QSet<int> ids;
 
     foreach(cwCave* cave, Region->caves()) {
-        foreach(cwTrip* trip, cave->trips()) {
-            foreach(cwNote* note, trip->notes()->notes()) {
-                cwImage image = note->image();
-                QSet<int> imageIds = imageToSet(image);
-                ids = ids.unite(imageIds);
+        ids.unite(validImageIds(cave));
+    }
+
+    return ids;
+}
 
-                foreach(cwScrap* scrap, note->scraps()) {
-                    image = scrap->triangulationData().croppedImage();
-                    imageIds = imageToSet(image);
-                    ids = ids.unite(imageIds);
-                }
+/**
+ * @brief cwImageCleanupTask::validImageIds
+ * @param cave
+ * @return All the image ids used by the cave's notes and scraps
+ */
+QSet<int> cwImageCleanupTask::validImageIds(cwCave *cave)
+{
+    QSet<int> ids;
+
+    foreach(cwTrip* trip, cave->trips()) {
+        foreach(cwNote* note, trip->notes()->notes()) {
+            cwImage image = note->image();
+            QSet<int> imageIds = imageToSet(image);
+            ids = ids.unite(imageIds);
+
+            foreach(cwScrap* scrap, note->scraps()) {
+                image = scrap->triangulationData().croppedImage();
+                imageIds = imageToSet(image);
+                ids = ids.unite(imageIds);
             }
         }
     }
@@ -127,7 +146,7 @@ QSet<int> cwImageCleanupTask::extractAllValidImageIds()
  * @param image
  * @return The converted image into a set of ids
  */
-QSet<int> cwImageCleanupTask::imageToSet(cwImage image) const
+QSet<int> cwImageCleanupTask::imageToSet(cwImage image)
 {
     QSet<int> ids;
     ids.insert(image.icon());
@@ -12,6 +12,7 @@
 #include "cwImage.h"
 #include "cwProjectIOTask.h"
 class cwCavingRegion;
+class cwCave;
 
 //Qt includes
 #include <QSet>
@@ -29,17 +30,22 @@ public:
     void setRegion(cwCavingRegion* region);
     cwCavingRegion* region() const;
 
+    void setValidImageIds(const QSet<int>& ids);
+
+    static QSet<int> validImageIds(cwCave* cave);
+
 protected:
     void runTask();
 
 private:
     cwCavingRegion* Region;
+    QSet<int> ValidImageIds; //Used if Region is nullptr
     QList<cwImage> UnusedImages;
     QSet<int> DatabaseIds;
 
     void populateUnusedImages();
     QSet<int> extractAllValidImageIds();
-    QSet<int> imageToSet(cwImage image) const;
+    static QSet<int> imageToSet(cwImage image);
 
 
 private slots:
@@ -62,5 +68,18 @@ inline cwCavingRegion *cwImageCleanupTask::region() const
     return Region;
 }
 
+/**
+ * @brief cwImageCleanupTask::setValidImageIds
+ * @param ids - All the image ids that are used, see validImageIds()
+ *
+ * This is used instead of the region's images, if region() is nullptr. This is useful
+ * if the region's caves are no longer owned by the caller, like when they're loaded
+ * progressively.
+ */
+inline void cwImageCleanupTask::setValidImageIds(const QSet<int> &ids)
+{
+    ValidImageIds = ids;
+}
+
 
 #endif // CWIMAGECLEANUPTASK_H
@@ -3,12 +3,17 @@
 #include "cwProject.h"
 #include "cwSQLManager.h"
 #include "cwDebug.h"
+#include "cwImageCache.h"
+#include "cwTexturePack.h"
 
 //Qt includes
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QSqlRecord>
 
+//Std includes
+#include <memory>
+
 cwImageDatabase::cwImageDatabase(const QString& filename)
 {
     setFilename(filename);
@@ -43,8 +48,11 @@ void cwImageDatabase::setFilename(const QString& filename)
 
   This returns the id of the image in the database
   */
-int cwImageDatabase::addImage(const cwImageData& imageData) {
-    cwSQLManager::Transaction transaction(Database);
+int cwImageDatabase::addImage(const cwImageData& imageData, bool withTransaction) {
+    std::unique_ptr<cwSQLManager::Transaction> transaction;
+    if(withTransaction) {
+        transaction = std::make_unique<cwSQLManager::Transaction>(Database);
+    }
 
     QString SQL = "INSERT INTO Images (type, shouldDelete, width, height, dotsPerMeter, imageData) "
             "VALUES (?, ?, ?, ?, ?, ?)";
@@ -74,11 +82,16 @@ int cwImageDatabase::addImage(const cwImageData& imageData) {
  * @param database - The database where the image is going to be inserted into
  * @param imageData - The data that going to update the image
  * @param id - The id of the image that needs to be updated
+ * @param withTransaction - False if the caller has already started a transaction. The caller
+ * then needs to call removeFromCaches() after the transaction is committed.
  * @return True if image was update successfully and false, if unsuccessful
  */
-bool cwImageDatabase::updateImage(const cwImageData &imageData, int id)
+bool cwImageDatabase::updateImage(const cwImageData &imageData, int id, bool withTransaction)
 {
-    cwSQLManager::Transaction transaction(Database);
+    std::unique_ptr<cwSQLManager::Transaction> transaction;
+    if(withTransaction) {
+        transaction = std::make_unique<cwSQLManager::Transaction>(Database);
+    }
 
     QString SQL("UPDATE Images SET type=?, width=?, height=?, dotsPerMeter=?, imageData=? where id=?");
 
@@ -96,22 +109,69 @@ bool cwImageDatabase::updateImage(const cwImageData &imageData, int id)
     query.bindValue(3, imageData.dotsPerMeter());
     query.bindValue(4, imageData.data());
     query.bindValue(5, id);
-    return query.exec();
+
+    if(!query.exec()) {
+        qDebug() << "Couldn't update image: " << id << query.lastError() << LOCATION;
+        return false;
+    }
+
+    if(withTransaction) {
+        //Commit first, otherwise the old image could be cached again before the update is visible
+        transaction.reset();
+        removeFromCaches({id});
+    }
+
+    return true;
 }
 
-int cwImageDatabase::addOrUpdateImage(const cwImageData &imageData, int id)
+int cwImageDatabase::addOrUpdateImage(const cwImageData &imageData, int id, bool withTransaction)
 {
     if(id > 0 && imageExists(id)) {
-        bool okay = updateImage(imageData, id);
+        bool okay = updateImage(imageData, id, withTransaction);
         if(!okay) {
             return -1;
         }
     } else {
-        id = addImage(imageData);
+        id = addImage(imageData, withTransaction);
     }
     return id;
 }
 
+/**
+ * Adds or updates all the images in a single transaction. ids should be the same size as
+ * images, use -1 for images that should be added.
+ *
+ * Returns the database id for each image, or -1 if the image couldn't be updated
+ */
+QList<int> cwImageDatabase::addOrUpdateImages(const QList<cwImageData> &images, const QList<int> &ids)
+{
+    Q_ASSERT(images.size() == ids.size());
+
+    QList<int> newIds;
+    newIds.reserve(images.size());
+
+    if(images.isEmpty()) {
+        return newIds;
+    }
+
+    QList<int> updatedIds;
+
+    {
+        cwSQLManager::Transaction transaction(Database);
+        for(int i = 0; i < images.size(); i++) {
+            int id = addOrUpdateImage(images.at(i), ids.at(i), false);
+            if(id > 0 && id == ids.at(i)) {
+                updatedIds.append(id);
+            }
+            newIds.append(id);
+        }
+    }
+
+    removeFromCaches(updatedIds);
+
+    return newIds;
+}
+
 bool cwImageDatabase::imageExists(int id) const
 {
     QString SQL("SELECT count(*) as count from Images where id=?");
@@ -169,6 +229,10 @@ bool cwImageDatabase::removeImage(cwImage image, bool withTransaction)
     return removeImages(image.ids(), withTransaction);
 }
 
+/**
+ * Removes all the images in ids. If withTransaction is false, the caller needs to call
+ * removeFromCaches() after the transaction is committed.
+ */
 bool cwImageDatabase::removeImages(QList<int> ids, bool withTransaction)
 {
     if(ids.isEmpty()) {
@@ -206,7 +270,26 @@ bool cwImageDatabase::removeImages(QList<int> ids, bool withTransaction)
 
     if(withTransaction) {
         cwSQLManager::instance()->endTransaction(Database);
+        removeFromCaches(ids);
     }
 
     return okay;
 }
+
+/**
+ * Removes the decoded copies of ids from cwImageCache and drops the project's texture pack,
+ * so the images are read from the database again. This should be called after the transaction
+ * that updated or removed the images is committed, otherwise a reader could cache the old
+ * image again.
+ */
+void cwImageDatabase::removeFromCaches(const QList<int>& ids) const
+{
+    if(ids.isEmpty()) {
+        return;
+    }
+
+    cwTexturePack::invalidate(filename());
+    for(int id : ids) {
+        cwImageCache::instance()->remove(filename(), id);
+    }
+}
@@ -19,9 +19,10 @@ public:
     QString filename() const;
     void setFilename(const QString& filename);
 
-    int addImage(const cwImageData& imageData);
-    bool updateImage(const cwImageData& imageData, int id);
-    int addOrUpdateImage(const cwImageData& imageData, int id);
+    int addImage(const cwImageData& imageData, bool withTransaction = true);
+    bool updateImage(const cwImageData& imageData, int id, bool withTransaction = true);
+    int addOrUpdateImage(const cwImageData& imageData, int id, bool withTransaction = true);
+    QList<int> addOrUpdateImages(const QList<cwImageData>& images, const QList<int>& ids);
 
     bool removeImage(cwImage image, bool withTransaction = true);
     bool removeImages(QList<int> ids, bool withTransaction = true);
@@ -29,6 +30,8 @@ public:
     bool imageExists(int id) const;
     bool mipmapsValid(cwImage image, bool usingCompression) const;
 
+    void removeFromCaches(const QList<int>& ids) const;
+
 private:
     QSqlDatabase Database;
 };
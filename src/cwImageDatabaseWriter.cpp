@@ -0,0 +1,117 @@
+//Our includes
+#include "cwImageDatabaseWriter.h"
+#include "cwImageDatabase.h"
+
+//Qt includes
+#include <QThread>
+#include <QMutexLocker>
+
+//Std includes
+#include <algorithm>
+
+cwImageDatabaseWriter::cwImageDatabaseWriter(const QString &filename) :
+    Filename(filename),
+    Thread(QThread::create([this]() { run(); }))
+{
+    Thread->setObjectName("cwImageDatabaseWriter");
+    Thread->start();
+}
+
+/**
+ * Writes all the images that are waiting and then stops the writer thread
+ */
+cwImageDatabaseWriter::~cwImageDatabaseWriter()
+{
+    {
+        QMutexLocker locker(&Mutex);
+        Stop = true;
+    }
+    RequestAdded.wakeAll();
+
+    Thread->wait();
+    delete Thread;
+}
+
+/**
+ * Sets the maximum number of images that are written in a single transaction
+ */
+void cwImageDatabaseWriter::setMaxBatchSize(int maxBatchSize)
+{
+    QMutexLocker locker(&Mutex);
+    MaxBatchSize = std::max(1, maxBatchSize);
+}
+
+/**
+ * Returns the maximum number of images that are written in a single transaction
+ */
+int cwImageDatabaseWriter::maxBatchSize() const
+{
+    QMutexLocker locker(&Mutex);
+    return MaxBatchSize;
+}
+
+/**
+ * Queues imageData to be written to the database. If id exists in the database, that image is
+ * updated, otherwise a new image is added. The future's result is the id of the image,
+ * or -1 if the image couldn't be updated.
+ *
+ * This is thread safe.
+ */
+QFuture<int> cwImageDatabaseWriter::addOrUpdateImage(const cwImageData &imageData, int id)
+{
+    Request request {imageData, id, AsyncFuture::deferred<int>()};
+    auto future = request.Result.future();
+
+    {
+        QMutexLocker locker(&Mutex);
+        Q_ASSERT(!Stop);
+        Requests.append(request);
+    }
+    RequestAdded.wakeOne();
+
+    return future;
+}
+
+/**
+ * Runs on the writer thread. The database connection is created and used only by this thread.
+ */
+void cwImageDatabaseWriter::run()
+{
+    cwImageDatabase database(Filename);
+
+    while(true) {
+        QList<Request> batch;
+
+        {
+            QMutexLocker locker(&Mutex);
+            while(Requests.isEmpty() && !Stop) {
+                RequestAdded.wait(&Mutex);
+            }
+
+            if(Requests.isEmpty()) {
+                //Stopped and everything has been written
+                return;
+            }
+
+            int batchSize = std::min(MaxBatchSize, Requests.size());
+            batch = Requests.mid(0, batchSize);
+            Requests.erase(Requests.begin(), Requests.begin() + batchSize);
+        }
+
+        QList<cwImageData> images;
+        QList<int> ids;
+        images.reserve(batch.size());
+        ids.reserve(batch.size());
+        for(const auto& request : batch) {
+            images.append(request.ImageData);
+            ids.append(request.Id);
+        }
+
+        QList<int> newIds = database.addOrUpdateImages(images, ids);
+        Q_ASSERT(newIds.size() == batch.size());
+
+        for(int i = 0; i < batch.size(); i++) {
+            batch[i].Result.complete(newIds.at(i));
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef CWIMAGEDATABASEWRITER_H
+#define CWIMAGEDATABASEWRITER_H
+
+//Our includes
+#include "cwGlobals.h"
+#include "cwImageData.h"
+
+//Qt includes
+#include <QFuture>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QList>
+class QThread;
+
+//Async includes
+#include "asyncfuture.h"
+
+/**
+ * @brief The cwImageDatabaseWriter class writes images to the project's database from
+ * a single thread, with a single database connection
+ *
+ * Any thread can add images to the writer. The images are queued and the writer thread
+ * writes all the images that are waiting, up to maxBatchSize(), in one transaction. This is
+ * much faster than creating a cwImageDatabase (a new connection) and committing a transaction
+ * for each image, when many threads are adding images at the same time.
+ *
+ * The returned futures finish once the image has been committed. When the writer is
+ * destroyed, all the images that are waiting are written before the writer thread exits.
+ */
+class CAVEWHERE_LIB_EXPORT cwImageDatabaseWriter
+{
+public:
+    cwImageDatabaseWriter(const QString& filename);
+    cwImageDatabaseWriter(const cwImageDatabaseWriter&) = delete;
+    ~cwImageDatabaseWriter();
+
+    QString filename() const;
+
+    void setMaxBatchSize(int maxBatchSize);
+    int maxBatchSize() const;
+
+    QFuture<int> addImage(const cwImageData& imageData);
+    QFuture<int> addOrUpdateImage(const cwImageData& imageData, int id);
+
+private:
+    class Request {
+    public:
+        cwImageData ImageData;
+        int Id;
+        AsyncFuture::Deferred<int> Result;
+    };
+
+    const QString Filename;
+
+    mutable QMutex Mutex;
+    QWaitCondition RequestAdded;
+    QList<Request> Requests;
+    int MaxBatchSize = 64;
+    bool Stop = false;
+
+    QThread* Thread;
+
+    void run();
+};
+
+/**
+ * Returns the filename of the database that the images are written to
+ */
+inline QString cwImageDatabaseWriter::filename() const
+{
+    return Filename;
+}
+
+/**
+ * Adds a new image to the database. The future's result is the id of the new image.
+ */
+inline QFuture<int> cwImageDatabaseWriter::addImage(const cwImageData &imageData)
+{
+    return addOrUpdateImage(imageData, -1);
+}
+
+#endif // CWIMAGEDATABASEWRITER_H
@@ -9,6 +9,9 @@
 #include "cwImageProvider.h"
 #include "cwDebug.h"
 #include "cwSQLManager.h"
+#include "cwImageCache.h"
+#include "cwDXT1Encoder.h"
+#include "cwOpenGLUtils.h"
 
 //Qt includes
 #include <QSqlDatabase>
@@ -21,9 +24,21 @@
 #include <QDebug>
 #include <QSqlError>
 #include <QJsonDocument>
+#include <QThreadStorage>
+#include <QHash>
+#include <QSharedPointer>
+#include <QBuffer>
+#include <QImageReader>
+#include <QUrlQuery>
+#include <QStringList>
 
 //Std includes
 #include <stdexcept>
+#include <limits>
+#include <algorithm>
+
+//Stc3 decompression
+#include "s3tc.h"
 
 QAtomicInt cwImageProvider::ConnectionCounter;
 
@@ -38,42 +53,33 @@ cwImageProvider::cwImageProvider() :
 /**
   \brief This extracts a image from the database
 
+  id is either a database id or an id from imageId(). If requestedSize is valid, the image
+  is decoded from the cheapest source that's large enough, see image(const cwImage&, const QSize&).
+
   See Qt docs for details
   */
 QImage cwImageProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize) {
-    bool okay;
-    int sqlId = id.toInt(&okay);
+    cwImage request = fromImageId(id);
 
-    if(!okay) {
+    if(!request.isOriginalValid()) {
         qDebug() << "cwProjectImageProvider:: Couldn't convert id to a number where id=" << id;
         return QImage();
     }
 
-    //Extract the image data from the database
-    auto imageData = data(sqlId);
+    int maxSize = qMax(requestedSize.width(), requestedSize.height());
 
-    //Read the image in
-    QImage image = this->image(imageData);
+    //Read the image in, from the cache or the database
+    QImage image = maxSize > 0 ? this->image(request, QSize(maxSize, maxSize))
+                               : this->image(request.original());
 
     //Make sure the image is good
     if(image.isNull()) {
-        qDebug() << "cwProjectImageProvider:: Image isn't of format " << imageData.format();
+        qDebug() << "cwProjectImageProvider:: Couldn't load image, or image isn't of a readable format, id=" << id;
         return QImage();
     }
 
-    int maxSize = qMax(requestedSize.width(), requestedSize.height());
-    if(maxSize > 0) {
-
-        //Get the size of the image, scale it and return it.
-        QImage scaledImage = image.scaled(QSize(maxSize, maxSize), Qt::KeepAspectRatio, Qt::SmoothTransformation);
-        *size = scaledImage.size();
-
-        return scaledImage;
-    } else {
-        //Just return the image
-        *size = image.size();
-        return image;
-    }
+    *size = image.size();
+    return image;
 }
 
 /**
@@ -100,98 +106,331 @@ cwImageData cwImageProvider::originalMetadata(const cwImage &image) const {
 }
 
 /**
-  Gets the metadata of the image at id
-  */
-cwImageData cwImageProvider::data(int id, bool metaDataOnly) const {
+ * A read only connection to the project file, with it's prepared queries
+ *
+ * A QSqlDatabase can only be used by the thread that created it, so each thread has it's own
+ * connections. Connections stay open, so the queries don't have to be prepared for every request.
+ *
+ * Mutex is held while the connection is being used. closeReadConnections() takes it to retire
+ * the connection from another thread. Only the owning thread closes the connection, the next
+ * time it reads an image or when the thread exits.
+ */
+class cwImageProvider::ReadConnection {
+public:
+    ReadConnection(const QString& path) :
+        Path(path)
+    {
+        int connectionName = ConnectionCounter.fetchAndAddAcquire(1);
+        Database = QSqlDatabase::addDatabase("QSQLITE", QString("imageProviderRead/%1").arg(connectionName));
+        Database.setDatabaseName(path);
+        Database.setConnectOptions("QSQLITE_OPEN_READONLY");
+
+        if(!Database.open()) {
+            qDebug() << "cwProjectImageProvider:: Couldn't connect to database:" << path << Database.lastError().text() << LOCATION;
+            return;
+        }
 
-    //Needed to get around const correctness
-    int connectionName = ConnectionCounter.fetchAndAddAcquire(1);
+        ImageQuery = QSqlQuery(Database);
+        MetadataQuery = QSqlQuery(Database);
+        bool successful = ImageQuery.prepare(requestImageSQL()) &&
+                MetadataQuery.prepare(requestMetadataSQL());
+        if(!successful) {
+            qDebug() << "cwProjectImageProvider:: Couldn't prepare query " << requestImageSQL();
+            close();
+            return;
+        }
 
-    QString request = metaDataOnly ? "requestMetadata/%1" : "resquestImage/%1";
+        QMutexLocker locker(&ReadConnectionsMutex);
+        ReadConnections.append(this);
+    }
 
-    //Define the database
-    QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", request.arg(connectionName));
-    database.setDatabaseName(projectPath());
+    ~ReadConnection() {
+        QString connectionName = Database.connectionName();
+        close();
+        Database = QSqlDatabase();
+        QSqlDatabase::removeDatabase(connectionName);
 
-    //Create an sql connection
-    bool connected = database.open();
-    if(!connected) {
-        qDebug() << "cwProjectImageProvider:: Couldn't connect to database:" << ProjectPath << database.lastError().text() << LOCATION;
-        return cwImageData();
+        //The file is closed, so it can be removed
+        removeReadConnection(this);
     }
 
-    cwSQLManager::instance()->beginTransaction(database, cwSQLManager::ReadOnly);
+    bool isOpen() const { return Database.isOpen(); }
 
-    //Setup the query
-    QSqlQuery query(database);
-    bool successful;
-    if(metaDataOnly) {
-        successful = query.prepare(requestMetadataSQL());
-    } else {
-        successful = query.prepare(requestImageSQL());
+    void close() {
+        ImageQuery = QSqlQuery();
+        MetadataQuery = QSqlQuery();
+        Database.close();
     }
 
-    if(!successful) {
-        qDebug() << "cwProjectImageProvider:: Couldn't prepare query " << requestImageSQL();
-        cwSQLManager::instance()->endTransaction(database);
-        database.close();
-        return cwImageData();
+    const QString Path;
+    QMutex Mutex;
+    bool Retired = false;
+    QSqlDatabase Database;
+    QSqlQuery ImageQuery;
+    QSqlQuery MetadataQuery;
+};
+
+QMutex cwImageProvider::ReadConnectionsMutex;
+QList<cwImageProvider::ReadConnection*> cwImageProvider::ReadConnections;
+QMultiHash<QString, std::function<void ()>> cwImageProvider::ClosedCallbacks;
+
+/**
+ * The current thread's connections, by project path. The connections are deleted, in the thread
+ * that created them, when the thread exits.
+ */
+QHash<QString, QSharedPointer<cwImageProvider::ReadConnection>>& cwImageProvider::threadConnections()
+{
+    static QThreadStorage<QHash<QString, QSharedPointer<ReadConnection>>> connections;
+    return connections.localData();
+}
+
+/**
+ * Returns the current thread's connection to the project file. This returns nullptr if the
+ * project file couldn't be opened.
+ */
+cwImageProvider::ReadConnection* cwImageProvider::readConnection() const
+{
+    //Only keep a couple of project files open per thread, unit tests use many temporary project files
+    const int maxConnectionsPerThread = 2;
+
+    QString path = projectPath();
+    auto& connections = threadConnections();
+
+    auto connection = connections.value(path);
+    if(!connection.isNull()) {
+        QMutexLocker locker(&connection->Mutex);
+        if(connection->isOpen() && !connection->Retired) {
+            return connection.data();
+        }
     }
 
-    //Set the id that we're searching for
-    query.bindValue(0, id);
-    successful = query.exec();
+    //Remove connections that have been retired by closeReadConnections()
+    removeRetiredConnections();
+    for(auto iter = connections.begin(); iter != connections.end();) {
+        if(iter.key() == path || connections.size() >= maxConnectionsPerThread) {
+            iter = connections.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
 
-    if(!successful) {
-        qDebug() << "Couldn't exec query image id:" << id << LOCATION;
-        cwSQLManager::instance()->endTransaction(database);
-        database.close();
-        return cwImageData();
+    connection = QSharedPointer<ReadConnection>::create(path);
+    if(!connection->isOpen()) {
+        return nullptr;
     }
 
-    if(query.next()) {
-        QByteArray type = query.value(0).toByteArray();
-        int width = query.value(1).toInt();
-        int height = query.value(2).toInt();
-        QSize size = QSize(width, height);
-        int dotsPerMeter = query.value(3).toInt();
+    connections.insert(path, connection);
+    return connection.data();
+}
 
-        QByteArray imageData;
-        if(!metaDataOnly) {
-            imageData = query.value(4).toByteArray();
-            //Remove the zlib compression from the image
-            if(QString(type) == QString(cwImageProvider::dxt1GzExtension())) {
-                //Decompress the QByteArray
-                imageData = qUncompress(imageData);
+/**
+ * Closes and deletes the current thread's connections that are retired or closed
+ */
+void cwImageProvider::removeRetiredConnections()
+{
+    auto& connections = threadConnections();
+    for(auto iter = connections.begin(); iter != connections.end();) {
+        QMutexLocker locker(&iter.value()->Mutex);
+        bool retired = iter.value()->Retired || !iter.value()->isOpen();
+        locker.unlock();
+
+        if(retired) {
+            iter = connections.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+/**
+ * Called by the connection, once it's closed. If it was the last connection to it's project
+ * file, this runs the callbacks from whenReadConnectionsClosed().
+ */
+void cwImageProvider::removeReadConnection(ReadConnection *connection)
+{
+    QList<std::function<void ()>> callbacks;
+
+    {
+        QMutexLocker locker(&ReadConnectionsMutex);
+        ReadConnections.removeOne(connection);
+
+        auto samePath = [connection](const ReadConnection* other) {
+            return other->Path == connection->Path;
+        };
+
+        if(std::none_of(ReadConnections.begin(), ReadConnections.end(), samePath)) {
+            callbacks = ClosedCallbacks.values(connection->Path);
+            ClosedCallbacks.remove(connection->Path);
+        }
+    }
+
+    for(const auto& closed : callbacks) {
+        closed();
+    }
+}
+
+/**
+ * Retires all the pooled read connections, in every thread. A QSqlDatabase can only be closed
+ * by the thread that opened it, so the current thread's connections are closed now, and the other
+ * threads close theirs the next time they read an image or when they exit. New connections
+ * are opened the next time an image is read.
+ *
+ * This should be called before a project file is removed or replaced. Pooled connections keep
+ * the file open and it can't be removed on windows, use whenReadConnectionsClosed() to remove it.
+ */
+void cwImageProvider::closeReadConnections()
+{
+    {
+        QMutexLocker locker(&ReadConnectionsMutex);
+        for(ReadConnection* connection : ReadConnections) {
+            QMutexLocker connectionLocker(&connection->Mutex);
+            connection->Retired = true;
+        }
+    }
+
+    removeRetiredConnections();
+}
+
+/**
+ * Returns true if any thread has a read connection to projectPath open. This includes retired
+ * connections that haven't been closed by their thread yet.
+ */
+bool cwImageProvider::hasReadConnections(const QString &projectPath)
+{
+    QMutexLocker locker(&ReadConnectionsMutex);
+    return std::any_of(ReadConnections.begin(), ReadConnections.end(),
+                       [projectPath](const ReadConnection* connection)
+    {
+        return connection->Path == projectPath;
+    });
+}
+
+/**
+ * Calls closed once no thread has a read connection to projectPath. If there aren't any
+ * connections, closed is called right away, otherwise it's called by the thread that closes
+ * the last connection.
+ *
+ * Call closeReadConnections() first, or the connections might stay open until their threads exit.
+ */
+void cwImageProvider::whenReadConnectionsClosed(const QString &projectPath, std::function<void ()> closed)
+{
+    {
+        QMutexLocker locker(&ReadConnectionsMutex);
+        bool open = std::any_of(ReadConnections.begin(), ReadConnections.end(),
+                                [projectPath](const ReadConnection* connection)
+        {
+            return connection->Path == projectPath;
+        });
+
+        if(open) {
+            ClosedCallbacks.insert(projectPath, closed);
+            return;
+        }
+    }
+
+    closed();
+}
+
+/**
+  Gets the metadata of the image at id
+  */
+cwImageData cwImageProvider::data(int id, bool metaDataOnly) const {
+    return data(QList<int>({id}), metaDataOnly).first();
+}
+
+/**
+ * Gets the images at ids. This reads all the images in one transaction.
+ *
+ * The returned list is the same size as ids. If an image can't be found, it's cwImageData is empty.
+ */
+QList<cwImageData> cwImageProvider::data(const QList<int> &ids, bool metaDataOnly) const
+{
+    QList<cwImageData> images;
+    images.reserve(ids.size());
+
+    ReadConnection* connection = readConnection();
+    if(connection == nullptr) {
+        for(int i = 0; i < ids.size(); i++) {
+            images.append(cwImageData());
+        }
+        return images;
+    }
+
+    //Keeps closeReadConnections() from closing the connection while it's used
+    QMutexLocker connectionLocker(&connection->Mutex);
+    if(!connection->isOpen()) {
+        //The project file is being replaced
+        for(int i = 0; i < ids.size(); i++) {
+            images.append(cwImageData());
+        }
+        return images;
+    }
+
+    cwSQLManager::Transaction transaction(connection->Database, cwSQLManager::ReadOnly);
+
+    QSqlQuery& query = metaDataOnly ? connection->MetadataQuery : connection->ImageQuery;
+
+    for(int id : ids) {
+        //Set the id that we're searching for
+        query.bindValue(0, id);
+        bool successful = query.exec();
+
+        if(!successful) {
+            qDebug() << "Couldn't exec query image id:" << id << query.lastError() << LOCATION;
+            images.append(cwImageData());
+            continue;
+        }
+
+        if(query.next()) {
+            QByteArray type = query.value(0).toByteArray();
+            int width = query.value(1).toInt();
+            int height = query.value(2).toInt();
+            QSize size = QSize(width, height);
+            int dotsPerMeter = query.value(3).toInt();
+
+            QByteArray imageData;
+            if(!metaDataOnly) {
+                imageData = query.value(4).toByteArray();
+                //Remove the zlib compression from the image
+                if(type == cwImageProvider::dxt1GzExtension()) {
+                    //Decompress the QByteArray
+                    imageData = qUncompress(imageData);
+                }
             }
+
+            images.append(cwImageData(size, dotsPerMeter, type, imageData));
+        } else {
+            qDebug() << "Query has no data for id:" << id << LOCATION;
+            images.append(cwImageData());
         }
 
-        cwSQLManager::instance()->endTransaction(database);
-        database.close();
-        return cwImageData(size, dotsPerMeter, type, imageData);
+        //Release the statement, so the transaction can finish
+        query.finish();
     }
 
-    cwSQLManager::instance()->endTransaction(database);
-    database.close();
-    qDebug() << "Query has no data for id:" << id << LOCATION;
-    return cwImageData();
+    return images;
 }
 
 /**
   \brief Gets a QImage from the image provider.  If the image at id is null, then
   this will return a empty image
+
+  Decoded images are shared through cwImageCache, so the image is only read and decoded
+  from the database if it isn't already in the cache.
   */
 QImage cwImageProvider::image(int id) const
 {
-    cwImageData imageData = data(id);
-    return image(imageData);
-
+    cwImageCache::Key key(projectPath(), id);
+    return cwImageCache::instance()->image(key, [this, id]() {
+        cwImageData imageData = data(id);
+        return image(imageData);
+    });
 }
 
 QImage cwImageProvider::image(const cwImageData &imageData) const
 {
     if(imageData.format() == cwImageProvider::dxt1GzExtension()) {
-        return QImage();
+        return decompressDxt1(imageData);
     }
 
     if(imageData.format() == cwImageProvider::croppedReferenceExtension()) {
@@ -228,6 +467,122 @@ QImage cwImageProvider::image(const cwImageData &imageData) const
     return QImage::fromData(imageData.data(), imageData.format());
 }
 
+/**
+ * Returns image scaled to fit in maxSize. This is used for thumbnails, where decoding the full
+ * resolution original is wasteful.
+ *
+ * The image is scaled from the cheapest source that's at least as large as the result:
+ * 1. The original, if it's already in cwImageCache
+ * 2. The smallest of the icon and the mipmaps (decoded on the cpu)
+ * 3. The original, decoded at a reduced size with QImageReader
+ *
+ * Sources are shared through cwImageCache. Reduced versions of the original are cached at
+ * level n, where the original is reduced by 2^n.
+ */
+QImage cwImageProvider::image(const cwImage &image, const QSize &maxSize) const
+{
+    auto scaled = [maxSize](const QImage& source) {
+        if(source.isNull()) {
+            return source;
+        }
+        return source.scaled(maxSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    };
+
+    int originalId = image.original();
+    cwImageCache* cache = cwImageCache::instance();
+    QString path = projectPath();
+
+    if(cache->contains(cwImageCache::Key(path, originalId))) {
+        return scaled(this->image(originalId));
+    }
+
+    //The first mipmap is the same size as the original, so it's never cheaper
+    QList<int> ids = {originalId};
+    if(image.isIconValid()) {
+        ids.append(image.icon());
+    }
+    ids.append(image.mipmaps().mid(1));
+
+    QList<cwImageData> metadata = data(ids, true);
+    QSize originalSize = metadata.first().size();
+    if(originalSize.isEmpty()) {
+        return scaled(this->image(originalId));
+    }
+
+    QSize targetSize = originalSize.scaled(maxSize, Qt::KeepAspectRatio);
+
+    //Find the smallest stored source that's large enough
+    int sourceId = -1;
+    qint64 sourceArea = std::numeric_limits<qint64>::max();
+    for(int i = 1; i < ids.size(); i++) {
+        QSize size = metadata.at(i).size();
+        qint64 area = static_cast<qint64>(size.width()) * size.height();
+        if(size.width() >= targetSize.width()
+                && size.height() >= targetSize.height()
+                && area < sourceArea)
+        {
+            sourceId = ids.at(i);
+            sourceArea = area;
+        }
+    }
+
+    if(sourceId >= 0) {
+        QImage source = this->image(sourceId);
+        if(!source.isNull()) {
+            return scaled(source);
+        }
+    }
+
+    //Find the smallest power of 2 reduction of the original that's large enough
+    int level = 0;
+    auto reduce = [originalSize](int level) {
+        return QSize(qMax(1, originalSize.width() >> level),
+                     qMax(1, originalSize.height() >> level));
+    };
+
+    while(level < 16) {
+        QSize nextSize = reduce(level + 1);
+        if(nextSize.width() < targetSize.width() || nextSize.height() < targetSize.height()) {
+            break;
+        }
+        level++;
+    }
+
+    if(level == 0) {
+        return scaled(this->image(originalId));
+    }
+
+    QSize reducedSize = reduce(level);
+    QImage reduced = cache->image(cwImageCache::Key(path, originalId, level),
+                                  [this, originalId, reducedSize]()
+    {
+        return reducedImage(data(originalId), reducedSize);
+    });
+
+    return scaled(reduced);
+}
+
+/**
+ * Decodes imageData at size. Formats that QImageReader supports scaled decoding for, such as
+ * jpeg, are decoded without decoding the full resolution image.
+ */
+QImage cwImageProvider::reducedImage(const cwImageData &imageData, const QSize &size) const
+{
+    if(imageData.format() == cwImageProvider::dxt1GzExtension()
+            || imageData.format() == cwImageProvider::croppedReferenceExtension())
+    {
+        return image(imageData).scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+
+    QBuffer buffer;
+    buffer.setData(imageData.data());
+    buffer.open(QIODevice::ReadOnly);
+
+    QImageReader reader(&buffer, imageData.format());
+    reader.setScaledSize(size);
+    return reader.read();
+}
+
 /**
  * @brief cwProjectImageProvider::scaleTexCoords
  * @param id
@@ -253,3 +608,92 @@ cwImageData cwImageProvider::createDxt1(QSize size, const QByteArray &uncompress
     //Add the image to the database
     return cwImageData(size, 0, cwImageProvider::dxt1GzExtension(), outputData);
 }
+
+/**
+ * Decompresses dxt1Data, a mipmap read by data(), into an image. The mipmap is stored mirrored
+ * for OpenGL, the returned image is not mirrored.
+ *
+ * Returns a null image if the dxt1Data isn't the right size.
+ */
+QImage cwImageProvider::decompressDxt1(const cwImageData &dxt1Data)
+{
+    QSize size = dxt1Data.size();
+    if(size.isEmpty() || dxt1Data.data().size() < cwDXT1Encoder::storageSize(size)) {
+        return QImage();
+    }
+
+    //Blocks are 4 by 4, so the decompressed image is padded
+    int paddedWidth = (size.width() + 3) / 4 * 4;
+    int paddedHeight = (size.height() + 3) / 4 * 4;
+
+    QVector<unsigned int> pixels(paddedWidth * paddedHeight, 0);
+    s3tc::BlockDecompressImageDXT1(paddedWidth, paddedHeight,
+                                   reinterpret_cast<const unsigned char*>(dxt1Data.data().constData()),
+                                   pixels.data());
+
+    QImage image(size, QImage::Format_ARGB32);
+    for(int y = 0; y < size.height(); y++) {
+        const unsigned int* row = pixels.constData() + (size.height() - 1 - y) * paddedWidth;
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for(int x = 0; x < size.width(); x++) {
+            line[x] = cwOpenGLUtils::toQRgba(row[x]);
+        }
+    }
+
+    return image;
+}
+
+/**
+ * Returns an id for requestImage(), that has all the ids in image. This lets requestImage() find
+ * the cheapest source for the requested size. The id looks like "1?icon=2&mipmaps=3,4,5"
+ */
+QString cwImageProvider::imageId(const cwImage &image)
+{
+    QStringList mipmaps;
+    for(int id : image.mipmaps()) {
+        mipmaps.append(QString::number(id));
+    }
+
+    QUrlQuery query;
+    query.addQueryItem(QStringLiteral("icon"), QString::number(image.icon()));
+    query.addQueryItem(QStringLiteral("mipmaps"), mipmaps.join(','));
+    return QString::number(image.original()) + '?' + query.toString();
+}
+
+/**
+ * Parses an id from imageId(), or a plain database id. If the id isn't valid, the
+ * original of the returned image is invalid.
+ */
+cwImage cwImageProvider::fromImageId(const QString &id)
+{
+    cwImage image;
+
+    int queryIndex = id.indexOf('?');
+    bool okay;
+    int originalId = id.left(queryIndex).toInt(&okay);
+    if(!okay) {
+        return image;
+    }
+    image.setOriginal(originalId);
+
+    if(queryIndex >= 0) {
+        QUrlQuery query(id.mid(queryIndex + 1));
+
+        int iconId = query.queryItemValue(QStringLiteral("icon")).toInt(&okay);
+        if(okay) {
+            image.setIcon(iconId);
+        }
+
+        QList<int> mipmaps;
+        const auto mipmapIds = query.queryItemValue(QStringLiteral("mipmaps")).split(',', QString::SkipEmptyParts);
+        for(const QString& mipmapId : mipmapIds) {
+            int mipmap = mipmapId.toInt(&okay);
+            if(okay) {
+                mipmaps.append(mipmap);
+            }
+        }
+        image.setMipmaps(mipmaps);
+    }
+
+    return image;
+}
@@ -12,15 +12,22 @@
 #include <QObject>
 #include <QQuickImageProvider>
 #include <QMutex>
+#include <QList>
 #include <QDebug>
 #include <QVector2D>
 #include <QStringLiteral>
+#include <QMultiHash>
+#include <QHash>
+#include <QSharedPointer>
 
 //Our includes
 #include "cwImage.h"
 #include "cwImageData.h"
 #include "cwGlobals.h"
 
+//Std includes
+#include <functional>
+
 class CAVEWHERE_LIB_EXPORT cwImageProvider : public QObject, public QQuickImageProvider
 {
     Q_OBJECT
@@ -31,11 +38,17 @@ public:
 
     cwImageData originalMetadata(const cwImage& image) const;
     cwImageData data(int id, bool metaDataOnly = false) const;
+    QList<cwImageData> data(const QList<int>& ids, bool metaDataOnly = false) const;
     QImage image(int id) const;
     QImage image(const cwImageData& data) const;
+    QImage image(const cwImage& image, const QSize& maxSize) const;
     QVector2D scaleTexCoords(const cwImage &image) const;
 
     static cwImageData createDxt1(QSize size, const QByteArray& uncompressData);
+    static QImage decompressDxt1(const cwImageData& dxt1Data);
+
+    static QString imageId(const cwImage& image);
+    static cwImage fromImageId(const QString& id);
 
     static QString name() { return QLatin1String("sqlimagequery"); }
     static QByteArray dxt1GzExtension() { return QByteArrayLiteral("dxt1.gz"); }
@@ -47,6 +60,10 @@ public:
     static QByteArray cropHeightKey() { return QByteArrayLiteral("height"); }
     static QByteArray cropIdKey() { return QByteArrayLiteral("id"); }
 
+    static void closeReadConnections();
+    static bool hasReadConnections(const QString& projectPath);
+    static void whenReadConnectionsClosed(const QString& projectPath, std::function<void ()> closed);
+
 public slots:
     void setProjectPath(QString projectPath);
 
@@ -57,9 +74,23 @@ private:
     QString ProjectPath;
     QMutex ProjectPathMutex;
 
+    class ReadConnection;
+
     static QAtomicInt ConnectionCounter;
 
+    //All the pooled read connections, for closeReadConnections()
+    static QMutex ReadConnectionsMutex;
+    static QList<ReadConnection*> ReadConnections;
+    static QMultiHash<QString, std::function<void ()>> ClosedCallbacks;
+
     QString projectPath() const;
+    ReadConnection* readConnection() const;
+
+    static QHash<QString, QSharedPointer<ReadConnection>>& threadConnections();
+    static void removeRetiredConnections();
+    static void removeReadConnection(ReadConnection* connection);
+
+    QImage reducedImage(const cwImageData& imageData, const QSize& size) const;
 };
 
 #endif // CWPROJECTIMAGEPROVIDER_H
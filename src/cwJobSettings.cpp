@@ -1,6 +1,7 @@
 //Our inculdes
 #include "cwJobSettings.h"
 #include "cwTask.h"
+#include "cwImageCache.h"
 
 //Qt includes
 #include <QThreadPool>
@@ -17,6 +18,7 @@ cwJobSettings::cwJobSettings(QObject* parent) :
     int threadCount = settings.value(threadCountKey(), QThread::idealThreadCount()).toInt();
     setThreadCountPrivate(threadCount);
     AutomaticUpdate = settings.value(automaticUpdateKey(), AutomaticUpdate).toBool();
+    setImageCacheSizePrivate(settings.value(imageCacheSizeKey(), defaultImageCacheSize()).toInt());
 }
 
 void cwJobSettings::setThreadCountPrivate(int count)
@@ -68,3 +70,32 @@ void cwJobSettings::setAutomaticUpdate(bool automaticUpdate) {
         emit automaticUpdateChanged();
     }
 }
+
+/**
+ * Returns the maximum size of cwImageCache in megabytes. This is memory used by decoded note
+ * images that are shared across the app.
+ */
+int cwJobSettings::imageCacheSize() const
+{
+    return static_cast<int>(cwImageCache::instance()->maxBytes() / (1024 * 1024));
+}
+
+/**
+ * Sets the maximum size of cwImageCache in megabytes. 0 disables caching of decoded images.
+ */
+void cwJobSettings::setImageCacheSize(int megabytes)
+{
+    if(megabytes >= 0 && imageCacheSize() != megabytes) {
+        QSettings settings;
+        settings.setValue(imageCacheSizeKey(), megabytes);
+        setImageCacheSizePrivate(megabytes);
+        emit imageCacheSizeChanged();
+    }
+}
+
+void cwJobSettings::setImageCacheSizePrivate(int megabytes)
+{
+    if(megabytes >= 0) {
+        cwImageCache::instance()->setMaxBytes(static_cast<qint64>(megabytes) * 1024 * 1024);
+    }
+}
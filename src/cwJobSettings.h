@@ -14,6 +14,7 @@ class CAVEWHERE_LIB_EXPORT cwJobSettings : public QObject
     Q_PROPERTY(int threadCount READ threadCount WRITE setThreadCount NOTIFY threadCountChanged)
     Q_PROPERTY(int idleThreadCount READ idleThreadCount CONSTANT)
     Q_PROPERTY(bool automaticUpdate READ automaticUpdate WRITE setAutomaticUpdate NOTIFY automaticUpdateChanged)
+    Q_PROPERTY(int imageCacheSize READ imageCacheSize WRITE setImageCacheSize NOTIFY imageCacheSizeChanged)
 
 public:
     int threadCount() const;
@@ -24,18 +25,25 @@ public:
     bool automaticUpdate() const;
     void setAutomaticUpdate(bool automaticUpdate);
 
+    int imageCacheSize() const;
+    void setImageCacheSize(int megabytes);
+
+    static int defaultImageCacheSize() { return 256; }
+
     static cwJobSettings* instance();
     static void initialize();
 
 signals:
     void threadCountChanged();
     void automaticUpdateChanged();
+    void imageCacheSizeChanged();
 
 private:
     static cwJobSettings* Settings;
 
     static QString automaticUpdateKey() { return QLatin1String("automaticUpdate"); }
     static QString threadCountKey() { return QLatin1String("threadCount"); }
+    static QString imageCacheSizeKey() { return QLatin1String("imageCacheSize"); }
 
     bool AutomaticUpdate = true;
 
@@ -43,6 +51,7 @@ private:
 
     void setThreadCountPrivate(int count);
     bool isThreadCountValid(int count) const;
+    void setImageCacheSizePrivate(int megabytes);
 };
 
 inline bool cwJobSettings::isThreadCountValid(int count) const
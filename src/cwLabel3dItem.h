@@ -13,7 +13,10 @@
 #include <QString>
 #include <QFont>
 
-class cwLabel3dItem
+//Our includes
+#include "cwGlobals.h"
+
+class CAVEWHERE_LIB_EXPORT cwLabel3dItem
 {
 public:
     cwLabel3dItem();
@@ -25,10 +28,14 @@ public:
     void setPosition(QVector3D worldCoords);
     QVector3D position() const;
 
+    void setPriority(int priority);
+    int priority() const;
+
 private:
     QFont Font;
     QString Text;
     QVector3D Position;
+    int Priority = 0; //Higher priority labels are placed first, see cwLabelDeclutter
 
 };
 
@@ -52,6 +59,16 @@ inline QVector3D cwLabel3dItem::position() const
     return Position;
 }
 
+inline void cwLabel3dItem::setPriority(int priority)
+{
+    Priority = priority;
+}
+
+inline int cwLabel3dItem::priority() const
+{
+    return Priority;
+}
+
 
 
 #endif // CWLABEL3DITEM_H
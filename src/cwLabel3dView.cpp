@@ -16,18 +16,28 @@
 //Qt includes
 #include <QQmlContext>
 #include <QQmlEngine>
+#include <QQuickWindow>
 #include <QtConcurrent>
 
 cwLabel3dView::cwLabel3dView(QQuickItem *parent) :
     QQuickItem(parent),
     Component(nullptr),
-    Camera(nullptr)
+    Camera(nullptr),
+    Declutter(QSharedPointer<cwLabelDeclutter>::create())
 {
+    setFlag(ItemHasContents, true);
+
+    //Placement is on a worker thread, the budget only limits how long labels take to show up
+    Declutter->setTimeBudget(8000000); //8ms
+
     connect(this, &cwLabel3dView::visibleChanged, this, [this]() {
         if(isVisible()) {
             updatePositions();
         }
     });
+
+    connect(&PlacementWatcher, &QFutureWatcher<QVector<cwSGLabelsNode::Label>>::finished,
+            this, &cwLabel3dView::placementFinished);
 }
 
 /**
@@ -62,6 +72,11 @@ void cwLabel3dView::removeGroup(cwLabel3dGroup *group) {
     if(LabelGroups.contains(group)) {
         LabelGroups.remove(group);
         group->setParentView(nullptr);
+
+        if(Mode == Batched) {
+            LabelsChanged = true;
+            updatePositions();
+        }
     }
 }
 
@@ -70,9 +85,22 @@ void cwLabel3dView::removeGroup(cwLabel3dGroup *group) {
   * @param group
   *
   * Updates the group's QQuickItem's. This will remove old label, create new ones, as needed, and
-  * update the text and font properties.
+  * update the text and font properties. In Batched mode, this adds the group's characters to the
+  * glyph atlas.
   */
 void cwLabel3dView::updateGroup(cwLabel3dGroup* group) {
+    Q_ASSERT(LabelGroups.contains(group));
+
+    if(Mode == Batched) {
+        //Render any new characters, the labels are placed on a worker thread
+        for(const cwLabel3dItem& label : group->Labels) {
+            AtlasDirty = GlyphAtlas.addText(label.text()) || AtlasDirty;
+        }
+        LabelsChanged = true;
+        updatePositions();
+        return;
+    }
+
     if(Component == nullptr) {
         //Create the component that will generate all the labels
         QQmlEngine* engine = QQmlEngine::contextForObject(this)->engine();
@@ -87,8 +115,6 @@ void cwLabel3dView::updateGroup(cwLabel3dGroup* group) {
         }
     }
 
-    Q_ASSERT(LabelGroups.contains(group));
-
     //Remove extra
     int numberExtra = group->LabelItems.size() - group->Labels.size();
     for(int i = 0; i < numberExtra; i++) {
@@ -131,6 +157,32 @@ void cwLabel3dView::setCamera(cwCamera* camera) {
     }
 }
 
+/**
+Sets the render mode
+
+Switching modes creates or removes the Label3d.qml items for all the labels
+*/
+void cwLabel3dView::setRenderMode(RenderMode mode) {
+    if(Mode != mode) {
+        Mode = mode;
+        setFlag(ItemHasContents, Mode == Batched);
+        VisibleLabels.clear();
+
+        for(cwLabel3dGroup* group : LabelGroups) {
+            if(Mode == Batched) {
+                for(QQuickItem* item : group->LabelItems) {
+                    item->deleteLater();
+                }
+                group->LabelItems.clear();
+            }
+            updateGroup(group);
+        }
+
+        update();
+        emit renderModeChanged();
+    }
+}
+
 /**
  * @brief cwLabel3dView::updatePositions
  *
@@ -140,6 +192,7 @@ void cwLabel3dView::setCamera(cwCamera* camera) {
  */
 void cwLabel3dView::updateGroupPositions(cwLabel3dGroup* group)
 {
+    if(Camera == nullptr) { return; }
 
     Q_ASSERT(group->Labels.size() == group->LabelItems.size());
 
@@ -194,6 +247,11 @@ void cwLabel3dView::updatePositions()
     if(Camera == nullptr) { return; }
 
     if(isVisible()) {
+        if(Mode == Batched) {
+            startPlacement();
+            return;
+        }
+
         QSetIterator<cwLabel3dGroup*> iter(LabelGroups);
         while(iter.hasNext()) {
             cwLabel3dGroup* group = iter.next();
@@ -204,6 +262,137 @@ void cwLabel3dView::updatePositions()
     }
 }
 
+/**
+ * Projects and places the labels of all the groups, on a worker thread. Only one placement
+ * runs at a time. If the camera changes while placing, the labels are placed again, with the
+ * latest camera, once the current placement finishes.
+ */
+void cwLabel3dView::startPlacement()
+{
+    if(PlacementWatcher.isRunning()) {
+        PlacementPending = true;
+        return;
+    }
+
+    QList<QList<cwLabel3dItem>> groups;
+    groups.reserve(LabelGroups.size());
+    for(cwLabel3dGroup* group : LabelGroups) {
+        groups.append(group->Labels);
+    }
+
+    //Label ids are their index in groups, they change when the labels change
+    bool clearHistory = LabelsChanged;
+    LabelsChanged = false;
+
+    auto declutter = Declutter;
+    auto atlas = GlyphAtlas;
+    auto viewProjection = Camera->viewProjectionMatrix();
+    auto viewport = Camera->viewport();
+
+    PlacementWatcher.setFuture(QtConcurrent::run([=]() {
+        if(clearHistory) {
+            declutter->clearHistory();
+        }
+        return placeLabels(groups, atlas, viewProjection, viewport, declutter.data());
+    }));
+}
+
+/**
+ * Called when the worker thread has placed the labels
+ */
+void cwLabel3dView::placementFinished()
+{
+    VisibleLabels = PlacementWatcher.result();
+    update();
+
+    if(PlacementPending) {
+        PlacementPending = false;
+        updatePositions();
+    }
+}
+
+/**
+ * Projects the labels into the viewport and returns the labels that should be drawn. Labels
+ * that are clipped, or don't fit, aren't returned. declutter decides which labels fit, by
+ * their priority and which labels it placed last time.
+ *
+ * This is thread safe, it only uses it's arguments.
+ */
+QVector<cwSGLabelsNode::Label> cwLabel3dView::placeLabels(const QList<QList<cwLabel3dItem> > &groups,
+                                                          const cwGlyphAtlas &atlas,
+                                                          const QMatrix4x4 &viewProjection,
+                                                          const QRect &viewport,
+                                                          cwLabelDeclutter* declutter)
+{
+    TransformPoint transform(viewProjection, viewport);
+
+    QVector<cwSGLabelsNode::Label> candidates;
+    QVector<cwLabelDeclutter::Label> rects;
+
+    int id = 0;
+    for(const QList<cwLabel3dItem>& labels : groups) {
+        for(cwLabel3dItem label : labels) {
+            int labelId = id++;
+
+            transform(label);
+            QVector3D projectedStationPosition = label.position();
+
+            //Clip the stations to the rendering area
+            if(projectedStationPosition.z() > 1.0 ||
+                    projectedStationPosition.z() < 0.0 ||
+                    !viewport.contains(projectedStationPosition.x(), projectedStationPosition.y())) {
+                continue;
+            }
+
+            //The label's area, with a bit of space around it, the same way as the QuickItems
+            QSizeF textSize = atlas.textSize(label.text());
+            QPoint topLeftPoint = projectedStationPosition.toPoint();
+            QSize stationNameTextSize(textSize.width() * 1.1, textSize.height() * 1.1);
+            QRect stationRect(topLeftPoint, stationNameTextSize);
+            stationRect.moveTop(stationRect.top() - stationNameTextSize.height() / 1.1);
+
+            candidates.append(cwSGLabelsNode::Label(projectedStationPosition.toPointF(), label.text()));
+            rects.append(cwLabelDeclutter::Label(labelId, stationRect, label.priority()));
+        }
+    }
+
+    QVector<cwSGLabelsNode::Label> visibleLabels;
+    for(int index : declutter->declutter(rects, viewport)) {
+        visibleLabels.append(candidates.at(index));
+    }
+
+    return visibleLabels;
+}
+
+/**
+ * Draws the batched labels. In QuickItems mode, the view has no contents of it's own.
+ */
+QSGNode *cwLabel3dView::updatePaintNode(QSGNode *oldNode, QQuickItem::UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data);
+
+    if(Mode != Batched) {
+        delete oldNode;
+        return nullptr;
+    }
+
+    cwSGLabelsNode* labelsNode = static_cast<cwSGLabelsNode*>(oldNode);
+    if(labelsNode == nullptr) {
+        labelsNode = new cwSGLabelsNode();
+        AtlasDirty = true;
+    }
+
+    if(AtlasDirty) {
+        labelsNode->setTexture(window()->createTextureFromImage(GlyphAtlas.image(),
+                                                                QQuickWindow::TextureHasAlphaChannel));
+        AtlasDirty = false;
+    }
+
+    labelsNode->setLabels(VisibleLabels, GlyphAtlas);
+
+    return labelsNode;
+}
+
 /**
   \brief This is a helper for QtCurrentent function
 
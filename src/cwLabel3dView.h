@@ -12,22 +12,45 @@
 #include <QQuickItem>
 #include <QQmlComponent>
 #include <QMatrix4x4>
+#include <QFutureWatcher>
+#include <QSharedPointer>
 
 //Our includes
+#include "cwGlobals.h"
 #include "cwLabel3dItem.h"
 #include "cwCollisionRectKdTree.h"
+#include "cwGlyphAtlas.h"
+#include "cwSGLabelsNode.h"
+#include "cwLabelDeclutter.h"
 class cwCamera;
 class cwLabel3dGroup;
 
-class cwLabel3dView : public QQuickItem
+/**
+ * @brief The cwLabel3dView class draws text labels at 3d positions, on top of the 3d view
+ *
+ * By default, labels are Batched. All the visible labels are drawn by one cwSGLabelsNode, from
+ * a glyph atlas. When the camera moves, the labels are projected and decluttered on a worker
+ * thread, see placeLabels(). cwLabelDeclutter keeps the label placement stable between frames.
+ *
+ * QuickItems is the compatibility mode. Each label is a Label3d.qml item that's moved and
+ * hidden on the GUI thread.
+ */
+class CAVEWHERE_LIB_EXPORT cwLabel3dView : public QQuickItem
 {
     friend class cwLabel3dGroup;
 
     Q_OBJECT
 
     Q_PROPERTY(cwCamera* camera READ camera WRITE setCamera NOTIFY cameraChanged)
+    Q_PROPERTY(RenderMode renderMode READ renderMode WRITE setRenderMode NOTIFY renderModeChanged)
 
 public:
+    enum RenderMode {
+        Batched,
+        QuickItems
+    };
+    Q_ENUM(RenderMode)
+
     explicit cwLabel3dView(QQuickItem *parent = 0);
     ~cwLabel3dView();
     
@@ -37,9 +60,21 @@ public:
     cwCamera* camera() const;
     void setCamera(cwCamera* camera);
 
+    RenderMode renderMode() const;
+    void setRenderMode(RenderMode mode);
+
+    static QVector<cwSGLabelsNode::Label> placeLabels(const QList<QList<cwLabel3dItem>>& groups,
+                                                      const cwGlyphAtlas& atlas,
+                                                      const QMatrix4x4& viewProjection,
+                                                      const QRect& viewport,
+                                                      cwLabelDeclutter* declutter);
+
 signals:
     void cameraChanged();
+    void renderModeChanged();
 
+protected:
+    QSGNode* updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData* data) override;
 
 public slots:
     
@@ -74,11 +109,24 @@ private:
     QQmlComponent* Component;
     cwCamera* Camera; //!<
     cwCollisionRectKdTree LabelKdTree;
+    RenderMode Mode = Batched;
+
+    //For batched labels
+    cwGlyphAtlas GlyphAtlas;
+    bool AtlasDirty = true;
+    QVector<cwSGLabelsNode::Label> VisibleLabels;
+    QFutureWatcher<QVector<cwSGLabelsNode::Label>> PlacementWatcher;
+    bool PlacementPending = false;
+    QSharedPointer<cwLabelDeclutter> Declutter; //Only used by the placement thread
+    bool LabelsChanged = false;
 
     void updateGroup(cwLabel3dGroup* group);
     void updateGroupPositions(cwLabel3dGroup* group);
+    void startPlacement();
+
 private slots:
     void updatePositions();
+    void placementFinished();
 
 };
 
@@ -89,4 +137,11 @@ Gets camera
 inline cwCamera* cwLabel3dView::camera() const {
     return Camera;
 }
+
+/**
+Gets the render mode
+*/
+inline cwLabel3dView::RenderMode cwLabel3dView::renderMode() const {
+    return Mode;
+}
 #endif // CWLABEL3DVIEW_H
@@ -0,0 +1,117 @@
+//Our includes
+#include "cwLabelDeclutter.h"
+
+//Qt includes
+#include <QElapsedTimer>
+
+//Std includes
+#include <algorithm>
+#include <numeric>
+
+cwLabelDeclutter::cwLabelDeclutter()
+{
+}
+
+/**
+ * Places the labels that fit in viewport without overlapping, and returns their indexes into
+ * labels, in the order they were placed.
+ *
+ * The placed labels are remembered, see wasVisible(), so they're preferred in the next call.
+ */
+QVector<int> cwLabelDeclutter::declutter(const QVector<Label> &labels, const QRect &viewport)
+{
+    QElapsedTimer timer;
+    timer.start();
+    BudgetExceeded = false;
+
+    //Look up the history once, instead of in every comparison
+    QVector<char> previouslyVisible(labels.size());
+    for(int i = 0; i < labels.size(); i++) {
+        previouslyVisible[i] = VisibleIds.contains(labels.at(i).Id);
+    }
+
+    QVector<int> order(labels.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&labels, &previouslyVisible](int a, int b) {
+        const Label& labelA = labels.at(a);
+        const Label& labelB = labels.at(b);
+        if(labelA.Priority != labelB.Priority) {
+            return labelA.Priority > labelB.Priority;
+        }
+        if(previouslyVisible.at(a) != previouslyVisible.at(b)) {
+            return previouslyVisible.at(a) > previouslyVisible.at(b);
+        }
+        if(labelA.Id != labelB.Id) {
+            return labelA.Id < labelB.Id;
+        }
+        return a < b;
+    });
+
+    //Clear the grid, the cells keep their memory for the next frame
+    const int columns = qMax(1, (viewport.width() + CellSize - 1) / CellSize);
+    const int rows = qMax(1, (viewport.height() + CellSize - 1) / CellSize);
+    Cells.resize(columns * rows);
+    for(auto& cell : Cells) {
+        cell.resize(0);
+    }
+    PlacedRects.resize(0);
+    VisibleIds.clear();
+
+    auto cellRange = [&viewport, columns, rows, this](const QRect& rect) {
+        QRect gridRect = rect.translated(-viewport.topLeft());
+        return QRect(QPoint(qBound(0, gridRect.left() / CellSize, columns - 1),
+                            qBound(0, gridRect.top() / CellSize, rows - 1)),
+                     QPoint(qBound(0, gridRect.right() / CellSize, columns - 1),
+                            qBound(0, gridRect.bottom() / CellSize, rows - 1)));
+    };
+
+    QVector<int> placed;
+
+    //Checking the timer is slow compared to testing a label, only check it every so often. The
+    //most important labels are always tested, even if sorting used up the budget
+    const int budgetCheckInterval = 64;
+
+    for(int i = 0; i < order.size(); i++) {
+        if(TimeBudget > 0 && i > 0 && i % budgetCheckInterval == 0 && timer.nsecsElapsed() > TimeBudget) {
+            BudgetExceeded = true;
+            break;
+        }
+
+        const int labelIndex = order.at(i);
+        const Label& label = labels.at(labelIndex);
+        if(label.Rect.isEmpty()) {
+            continue;
+        }
+
+        QRect cells = cellRange(label.Rect);
+
+        bool overlaps = false;
+        for(int row = cells.top(); row <= cells.bottom() && !overlaps; row++) {
+            for(int column = cells.left(); column <= cells.right() && !overlaps; column++) {
+                for(int placedIndex : Cells.at(row * columns + column)) {
+                    if(PlacedRects.at(placedIndex).intersects(label.Rect)) {
+                        overlaps = true;
+                        break;
+                    }
+                }
+            }
+        }
+
+        if(overlaps) {
+            continue;
+        }
+
+        int placedIndex = PlacedRects.size();
+        PlacedRects.append(label.Rect);
+        for(int row = cells.top(); row <= cells.bottom(); row++) {
+            for(int column = cells.left(); column <= cells.right(); column++) {
+                Cells[row * columns + column].append(placedIndex);
+            }
+        }
+
+        placed.append(labelIndex);
+        VisibleIds.insert(label.Id);
+    }
+
+    return placed;
+}
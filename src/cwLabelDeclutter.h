@@ -0,0 +1,131 @@
+#ifndef CWLABELDECLUTTER_H
+#define CWLABELDECLUTTER_H
+
+//Our includes
+#include "cwGlobals.h"
+
+//Qt includes
+#include <QRect>
+#include <QVector>
+#include <QSet>
+
+/**
+ * @brief The cwLabelDeclutter class chooses which labels are drawn, so labels don't overlap
+ *
+ * Labels are placed in order:
+ * 1. Higher Priority first
+ * 2. Labels with the same priority, that were visible in the last declutter(), are placed
+ * before labels that weren't. So a label that still fits stays visible as the camera moves.
+ * 3. By Id, so the order is the same in every frame
+ *
+ * Placed labels are stored in a flat grid of cells. A new label is only tested against the
+ * labels in the cells it covers, so placing a label doesn't slow down as more labels are placed.
+ *
+ * If a time budget is set, declutter() stops placing labels once the budget is used up. Since
+ * labels are placed in order, only the least important labels are dropped.
+ *
+ * This doesn't need a GPU, or the GUI thread. It isn't thread safe, only one thread should
+ * use it at a time.
+ */
+class CAVEWHERE_LIB_EXPORT cwLabelDeclutter
+{
+public:
+    class Label {
+    public:
+        Label() {}
+        Label(int id, QRect rect, int priority) :
+            Id(id),
+            Rect(rect),
+            Priority(priority)
+        {}
+
+        int Id = -1; //Identifies the label between frames
+        QRect Rect; //In viewport coordinates
+        int Priority = 0;
+    };
+
+    cwLabelDeclutter();
+
+    QVector<int> declutter(const QVector<Label>& labels, const QRect& viewport);
+
+    bool wasVisible(int id) const;
+    void clearHistory();
+
+    int cellSize() const;
+    void setCellSize(int cellSize);
+
+    qint64 timeBudget() const;
+    void setTimeBudget(qint64 nanoseconds);
+    bool budgetExceeded() const;
+
+private:
+    QSet<int> VisibleIds;
+
+    //The grid, each cell has the indexes of the placed rects that overlap it
+    QVector<QVector<int>> Cells;
+    QVector<QRect> PlacedRects;
+    int CellSize = 64;
+
+    qint64 TimeBudget = 0;
+    bool BudgetExceeded = false;
+};
+
+/**
+ * Returns true if the label with id was placed by the last declutter()
+ */
+inline bool cwLabelDeclutter::wasVisible(int id) const
+{
+    return VisibleIds.contains(id);
+}
+
+/**
+ * Forgets which labels were visible. Ids should be cleared when they no longer identify the
+ * same labels.
+ */
+inline void cwLabelDeclutter::clearHistory()
+{
+    VisibleIds.clear();
+}
+
+/**
+ * Returns the width and height of a grid cell in pixels
+ */
+inline int cwLabelDeclutter::cellSize() const
+{
+    return CellSize;
+}
+
+/**
+ * Sets the width and height of a grid cell in pixels. Cells about the size of a label work best.
+ */
+inline void cwLabelDeclutter::setCellSize(int cellSize)
+{
+    CellSize = qMax(1, cellSize);
+}
+
+/**
+ * Returns the maximum time declutter() spends placing labels, in nanoseconds. Zero is unlimited,
+ * the default.
+ */
+inline qint64 cwLabelDeclutter::timeBudget() const
+{
+    return TimeBudget;
+}
+
+/**
+ * Sets the maximum time declutter() spends placing labels, see timeBudget()
+ */
+inline void cwLabelDeclutter::setTimeBudget(qint64 nanoseconds)
+{
+    TimeBudget = nanoseconds;
+}
+
+/**
+ * Returns true if the last declutter() ran out of time before all the labels were tested
+ */
+inline bool cwLabelDeclutter::budgetExceeded() const
+{
+    return BudgetExceeded;
+}
+
+#endif // CWLABELDECLUTTER_H
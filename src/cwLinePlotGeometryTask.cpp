@@ -63,16 +63,14 @@ void cwLinePlotGeometryTask::runTask() {
 void cwLinePlotGeometryTask::addStationPositions(int caveIndex) {
     cwCave* cave = Region->cave(caveIndex);
 
-    QMapIterator<QString, QVector3D> iter(cave->stationPositionLookup().positions());
+    cwStationPositionLookup stationLookup = cave->stationPositionLookup();
 
-    while(iter.hasNext()) {
-        iter.next();
-
-        QString fullName = fullStationName(caveIndex, cave->name(), iter.key());
+    for(int i = 0; i < stationLookup.stationCount(); i++) {
+        QString fullName = fullStationName(caveIndex, cave->name(), stationLookup.stationName(i));
 
         StationIndexLookup.insert(fullName, PointData.size());
 
-        PointData.append(iter.value());
+        PointData.append(stationLookup.position(i));
     }
 }
 
@@ -102,9 +100,9 @@ void cwLinePlotGeometryTask::addShotLines(int caveIndex) {
 
             if(chunk->stationCount() < 2) { continue; }
 
-            cwStation firstStation = chunk->station(0);
+            const cwSurveyChunkData& data = chunk->surveyData();
 
-            QString fullName = fullStationName(caveIndex, cave->name(), firstStation.name());
+            QString fullName = fullStationName(caveIndex, cave->name(), data.stationNames().at(0));
             if(!StationIndexLookup.contains(fullName)) {
                 qDebug() << "Warning! Couldn't find station position index (will result in rendering artifacts): " << fullName << LOCATION;
             }
@@ -116,18 +114,18 @@ void cwLinePlotGeometryTask::addShotLines(int caveIndex) {
             maxDepth = qMax(maxDepth, (double)previousPoint.z());
 
             //Go through all the the stations/shots in the chunk
-            for(int stationIndex = 1; stationIndex < chunk->stationCount(); stationIndex++) {
-                cwStation station = chunk->station(stationIndex);
-                cwShot shot = chunk->shot(stationIndex - 1);
+            for(int stationIndex = 1; stationIndex < data.stationCount(); stationIndex++) {
+                const int shotIndex = stationIndex - 1;
+                const bool distanceIncluded = shotIndex < data.shotCount() ? data.distancesIncluded().at(shotIndex) : true;
 
                 //Look up the index
-                fullName = fullStationName(caveIndex, cave->name(), station.name());
+                fullName = fullStationName(caveIndex, cave->name(), data.stationNames().at(stationIndex));
                 if(StationIndexLookup.contains(fullName)) {
-                    unsigned int stationIndex = StationIndexLookup.value(fullStationName(caveIndex, cave->name(), station.name()), 0);
+                    unsigned int stationIndex = StationIndexLookup.value(fullName, 0);
 
                     //Depth and length calculation
                     QVector3D currentPoint = PointData.at(stationIndex);
-                    if(shot.isDistanceIncluded()) {
+                    if(distanceIncluded) {
                         minDepth = qMin(minDepth, (double)currentPoint.z());
                         maxDepth = qMax(maxDepth, (double)currentPoint.z());
                         length += QVector3D(currentPoint - previousPoint).length();
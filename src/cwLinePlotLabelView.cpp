@@ -10,6 +10,11 @@
 #include "cwCavingRegion.h"
 #include "cwCave.h"
 #include "cwLabel3dGroup.h"
+#include "cwTrip.h"
+#include "cwSurveyChunk.h"
+
+//Std includes
+#include <limits>
 
 cwLinePlotLabelView::cwLinePlotLabelView(QQuickItem *parent) :
     cwLabel3dView(parent),
@@ -107,6 +112,7 @@ void cwLinePlotLabelView::updateCaveStations(cwCave *cave) {
  */
 void cwLinePlotLabelView::connectCave(cwCave *cave) {
     connect(cave, &cwCave::stationPositionPositionChanged, this, &cwLinePlotLabelView::updateStations);
+    connect(cave, &cwCave::surveyNetworkChanged, this, &cwLinePlotLabelView::updateStations);
 }
 
 /**
@@ -116,6 +122,7 @@ void cwLinePlotLabelView::connectCave(cwCave *cave) {
 void cwLinePlotLabelView::disconnectCave(cwCave *cave)
 {
     disconnect(cave, &cwCave::stationPositionPositionChanged, this, &cwLinePlotLabelView::updateStations);
+    disconnect(cave, &cwCave::surveyNetworkChanged, this, &cwLinePlotLabelView::updateStations);
 }
 
 /**
@@ -124,24 +131,54 @@ void cwLinePlotLabelView::disconnectCave(cwCave *cave)
  * @return
  *
  * Generates labels from the cave
+ *
+ * The fixed station has the highest priority, the rest of the stations are prioritized by
+ * the number of shots that connect to them. So junctions are labeled before stations in
+ * the middle of a passage, and dead ends are labeled last.
  */
 QList<cwLabel3dItem> cwLinePlotLabelView::labels(cwCave *cave) const
 {
     cwStationPositionLookup stations = cave->stationPositionLookup();
+    cwSurveyNetwork network = cave->network();
+    QString fixedStation = fixedStationName(cave);
 
     QList< cwLabel3dItem > uniqueStations;
-    uniqueStations.reserve(stations.positions().count());
+    uniqueStations.reserve(stations.stationCount());
 
     //Populate the vector of unique stations, this is so we can thread the transformation
-    QMapIterator<QString, QVector3D> mapIter(stations.positions());
-    while(mapIter.hasNext()) {
-        mapIter.next();
-        uniqueStations.append(cwLabel3dItem(mapIter.key(), mapIter.value()));
+    for(int i = 0; i < stations.stationCount(); i++) {
+        cwLabel3dItem label(stations.stationName(i), stations.position(i));
+
+        if(label.text().compare(fixedStation, Qt::CaseInsensitive) == 0) {
+            label.setPriority(std::numeric_limits<int>::max());
+        } else {
+            label.setPriority(network.neighborIds(network.stationId(label.text())).size());
+        }
+
+        uniqueStations.append(label);
     }
 
     return uniqueStations;
 }
 
+/**
+ * Returns the station that's fixed at the origin when the cave is processed, the first
+ * station of the cave, see cwSurvexExporterCaveTask::fixFirstStation()
+ */
+QString cwLinePlotLabelView::fixedStationName(cwCave *cave)
+{
+    if(!cave->trips().isEmpty()) {
+        cwTrip* firstTrip = cave->trips().first();
+        if(!firstTrip->chunks().isEmpty()) {
+            cwSurveyChunk* firstChunk = firstTrip->chunks().first();
+            if(firstChunk->stationCount() > 0) {
+                return firstChunk->station(0).name();
+            }
+        }
+    }
+    return QString();
+}
+
 /**
  * @brief cwLinePlotLabelView::clear
  *
@@ -39,6 +39,7 @@ private:
     void disconnectCave(cwCave* cave);
 
     QList<cwLabel3dItem> labels(cwCave* cave) const;
+    static QString fixedStationName(cwCave* cave);
 
     void clear();
     void updateCaveStations(cwCave* cave);
@@ -32,22 +32,24 @@ cwLinePlotManager::cwLinePlotManager(QObject *parent) :
 
     SurveySignaler = new cwSurveyChunkSignaler(this);
 
-    SurveySignaler->addConnectionToCaves(SIGNAL(insertedTrips(int,int)), this, SLOT(runSurvex()));
-    SurveySignaler->addConnectionToCaves(SIGNAL(removedTrips(int,int)), this, SLOT(runSurvex()));
-    SurveySignaler->addConnectionToCaves(SIGNAL(nameChanged()), this, SLOT(runSurvex()));
-
-    SurveySignaler->addConnectionToTrips(SIGNAL(chunksInserted(int,int)), this, SLOT(runSurvex()));
-    SurveySignaler->addConnectionToTrips(SIGNAL(chunksRemoved(int,int)), this, SLOT(runSurvex()));
-    SurveySignaler->addConnectionToTrips(SIGNAL(nameChanged()), this, SLOT(runSurvex()));
-    SurveySignaler->addConnectionToTripCalibrations(SIGNAL(calibrationsChanged()), this, SLOT(runSurvex()));
-
-    SurveySignaler->addConnectionToChunks(SIGNAL(shotsAdded(int,int)), this, SLOT(runSurvex()));
-    SurveySignaler->addConnectionToChunks(SIGNAL(shotsRemoved(int,int)), this, SLOT(runSurvex()));
-    SurveySignaler->addConnectionToChunks(SIGNAL(stationsAdded(int,int)), this, SLOT(runSurvex()));
-    SurveySignaler->addConnectionToChunks(SIGNAL(stationsRemoved(int,int)), this, SLOT(runSurvex()));
-    SurveySignaler->addConnectionToChunks(SIGNAL(dataChanged(cwSurveyChunk::DataRole,int)), this, SLOT(runSurvex()));
-    SurveySignaler->addConnectionToChunks(SIGNAL(calibrationsChanged()), this, SLOT(runSurvex()));
-    SurveySignaler->addConnectionToChunkCalibrations(SIGNAL(calibrationsChanged()), this, SLOT(runSurvex()));
+    SurveySignaler->addConnectionToCaves(SIGNAL(insertedTrips(int,int)), this, SLOT(surveyDataChanged()));
+    SurveySignaler->addConnectionToCaves(SIGNAL(removedTrips(int,int)), this, SLOT(surveyDataChanged()));
+    SurveySignaler->addConnectionToCaves(SIGNAL(nameChanged()), this, SLOT(surveyDataChanged()));
+    SurveySignaler->addConnectionToCaves(SIGNAL(resetTrips()), this, SLOT(surveyDataChanged()));
+
+    SurveySignaler->addConnectionToTrips(SIGNAL(chunksInserted(int,int)), this, SLOT(surveyDataChanged()));
+    SurveySignaler->addConnectionToTrips(SIGNAL(chunksRemoved(int,int)), this, SLOT(surveyDataChanged()));
+    SurveySignaler->addConnectionToTrips(SIGNAL(nameChanged()), this, SLOT(surveyDataChanged()));
+    SurveySignaler->addConnectionToTrips(SIGNAL(chunksReset()), this, SLOT(surveyDataChanged()));
+    SurveySignaler->addConnectionToTripCalibrations(SIGNAL(calibrationsChanged()), this, SLOT(surveyDataChanged()));
+
+    SurveySignaler->addConnectionToChunks(SIGNAL(shotsAdded(int,int)), this, SLOT(surveyDataChanged()));
+    SurveySignaler->addConnectionToChunks(SIGNAL(shotsRemoved(int,int)), this, SLOT(surveyDataChanged()));
+    SurveySignaler->addConnectionToChunks(SIGNAL(stationsAdded(int,int)), this, SLOT(surveyDataChanged()));
+    SurveySignaler->addConnectionToChunks(SIGNAL(stationsRemoved(int,int)), this, SLOT(surveyDataChanged()));
+    SurveySignaler->addConnectionToChunks(SIGNAL(dataChanged(cwSurveyChunk::DataRole,int)), this, SLOT(surveyDataChanged()));
+    SurveySignaler->addConnectionToChunks(SIGNAL(calibrationsChanged()), this, SLOT(surveyDataChanged()));
+    SurveySignaler->addConnectionToChunkCalibrations(SIGNAL(calibrationsChanged()), this, SLOT(surveyDataChanged()));
 
     LinePlotTask = new cwLinePlotTask();
     connect(LinePlotTask, SIGNAL(shouldRerun()), this, SLOT(rerunSurvex())); //So the task is rerun
@@ -66,11 +68,16 @@ cwLinePlotManager::~cwLinePlotManager() {
   */
 void cwLinePlotManager::setRegion(cwCavingRegion* region) {
     Region = region;
+    SolvedCaves.clear();
+    ChangedCaves.clear();
     if(Region == nullptr) { return; }
 
     //Connect all signal from the region
     connect(Region, SIGNAL(insertedCaves(int,int)), SLOT(runSurvex()));
     connect(Region, SIGNAL(removedCaves(int,int)), SLOT(runSurvex()));
+    connect(Region, &cwCavingRegion::beginRemoveCaves, this, &cwLinePlotManager::removeSolvedCaves);
+    connect(Region, &cwCavingRegion::beginResetCaves, this, &cwLinePlotManager::clearSolvedCaves);
+    connect(Region, SIGNAL(resetCaves()), SLOT(runSurvex()));
 
     SurveySignaler->setRegion(Region);
 
@@ -154,9 +161,14 @@ void cwLinePlotManager::validateResultsData(cwLinePlotTask::LinePlotResultData &
         }
     }
 
+    //Only keep the solved caves that still exist
+    QSet<cwCave*> validResolvedCaves = results.resolvedCaves();
+    validResolvedCaves.intersect(cw::toSet(Region->caves()));
+
     results.setCaveData(validCaves);
     results.setTrip(validTrips);
     results.setScraps(validScraps);
+    results.setResolvedCaves(validResolvedCaves);
 }
 
 /**
@@ -208,6 +220,47 @@ void cwLinePlotManager::clearUnconnectedChunkErrors()
     UnconnectedChunks.clear();
 }
 
+/**
+ * @brief cwLinePlotManager::updateSolverErrors
+ *
+ * Replaces the cave's solver warnings with messages. These are the shots that cwLoopClosureSolver
+ * couldn't reduce, and are left out of the station positions.
+ *
+ * The warnings are kept in their own error model, a child of the cave's error model, so only the
+ * warnings added here are replaced. This should only be called for caves that were solved again,
+ * caves that haven't changed keep their warnings from the last time they were solved.
+ */
+void cwLinePlotManager::updateSolverErrors(cwCave *cave, const QStringList &messages)
+{
+    QPointer<cwErrorModel> model = SolverErrors.value(cave);
+
+    if(messages.isEmpty()) {
+        if(model) {
+            model->setParentModel(nullptr);
+            model->deleteLater();
+        }
+        SolverErrors.remove(cave);
+        return;
+    }
+
+    QList<cwError> errors;
+    errors.reserve(messages.size());
+    foreach(QString message, messages) {
+        errors.append(cwError(message, cwError::Warning));
+    }
+
+    if(!model) {
+        model = new cwErrorModel(cave->errorModel());
+        model->setParentModel(cave->errorModel());
+        SolverErrors.insert(cave, model);
+    }
+
+    if(model->errors()->toList() != errors) {
+        model->errors()->clear();
+        model->errors()->append(errors);
+    }
+}
+
 /**
  * @brief cwLinePlotManager::rerunSurvex
  *
@@ -229,7 +282,13 @@ void cwLinePlotManager::runSurvex() {
 
     if(Region != nullptr) {
         if(LinePlotTask->isReady()) {
+            //Caves that have changed need to be solved again
+            SolvedCaves.subtract(ChangedCaves);
+            ChangedCaves.clear();
+
             setCaveStationLookupAsStale(true);
+            LinePlotTask->setSolver(Solver);
+            LinePlotTask->setUnchangedCaves(SolvedCaves);
             LinePlotTask->setData(*Region);
             LinePlotTask->start();
         } else {
@@ -284,6 +343,11 @@ void cwLinePlotManager::updateLinePlot() {
         }
     }
 
+    //Only caves that were solved again have new solver errors
+    foreach(cwCave* cave, resultData.resolvedCaves()) {
+        updateSolverErrors(cave, resultData.caveData().value(cave).solverErrors());
+    }
+
     //Update the 3D plot
     if(GLLinePlot != nullptr) {
         GLLinePlot->setPoints(resultData.stationPositions());
@@ -293,6 +357,10 @@ void cwLinePlotManager::updateLinePlot() {
     //Mark all caves as up todate
     setCaveStationLookupAsStale(false);
 
+    //Caves that changed while the task was running still need to be solved
+    SolvedCaves = resultData.solvedCaves();
+    SolvedCaves.subtract(ChangedCaves);
+
     emit stationPositionInCavesChanged(resultData.caveData().keys());
     emit stationPositionInTripsChanged(cw::toList(resultData.trips()));
     emit stationPositionInScrapsChanged(cw::toList(resultData.scraps()));
@@ -307,3 +375,89 @@ void cwLinePlotManager::setAutomaticUpdate(bool automaticUpdate) {
     }
 }
 
+/**
+ * Sets the solver that's used to find the station positions. This reruns the line plot if
+ * the solver has changed.
+ *
+ * cwLinePlotTask::NativeSolver is the default. cwLinePlotTask::CavernSolver runs survex's
+ * cavern, and is useful for checking the results of the native solver.
+ */
+void cwLinePlotManager::setSolver(cwLinePlotTask::Solver solver) {
+    if(Solver != solver) {
+        Solver = solver;
+        SolvedCaves.clear();
+        runSurvex();
+    }
+}
+
+/**
+ * @brief cwLinePlotManager::surveyDataChanged
+ *
+ * Called when the survey data in a cave, trip, calibration or survey chunk has changed. This
+ * marks the cave that owns the sender as changed, and reruns the line plot. Caves that haven't
+ * changed reuse their station positions from the previous run.
+ */
+void cwLinePlotManager::surveyDataChanged()
+{
+    cwCave* cave = caveForObject(sender());
+    if(cave != nullptr) {
+        ChangedCaves.insert(cave);
+    } else {
+        //Don't know which cave changed, solve everything
+        SolvedCaves.clear();
+    }
+
+    runSurvex();
+}
+
+/**
+ * @brief cwLinePlotManager::removeSolvedCaves
+ *
+ * Called before caves are removed from the region. This forgets the removed caves, so a new
+ * cave that's created at the same address is solved. The removed caves' solver warnings are
+ * removed too.
+ */
+void cwLinePlotManager::removeSolvedCaves(int begin, int end)
+{
+    for(int i = begin; i <= end; i++) {
+        cwCave* cave = Region->cave(i);
+        SolvedCaves.remove(cave);
+        ChangedCaves.remove(cave);
+        updateSolverErrors(cave, QStringList());
+    }
+}
+
+/**
+ * @brief cwLinePlotManager::clearSolvedCaves
+ *
+ * Called before the region is bulk edited. Any of the caves can change or be removed during the
+ * bulk edit, so all the caves are solved again.
+ */
+void cwLinePlotManager::clearSolvedCaves()
+{
+    SolvedCaves.clear();
+    ChangedCaves.clear();
+}
+
+/**
+ * @brief cwLinePlotManager::caveForObject
+ * @param object - A cave, trip, trip calibration or survey chunk
+ * @return The cave that owns object, or nullptr if the cave can't be found
+ */
+cwCave* cwLinePlotManager::caveForObject(QObject* object)
+{
+    for(QObject* current = object; current != nullptr; current = current->parent()) {
+        if(cwCave* cave = qobject_cast<cwCave*>(current)) {
+            return cave;
+        }
+
+        if(cwTrip* trip = qobject_cast<cwTrip*>(current)) {
+            return trip->parentCave();
+        }
+
+        if(cwSurveyChunk* chunk = qobject_cast<cwSurveyChunk*>(current)) {
+            return chunk->parentCave();
+        }
+    }
+    return nullptr;
+}
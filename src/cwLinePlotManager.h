@@ -19,12 +19,14 @@ class cwStationReference;
 class cwGLLinePlot;
 class cwSurveyChunkSignaler;
 class cwErrorListModel;
+class cwErrorModel;
 #include "cwLinePlotTask.h"
 #include "cwGlobals.h"
 
 //Qt includes
 #include <QObject>
 #include <QPointer>
+#include <QHash>
 
 class CAVEWHERE_LIB_EXPORT cwLinePlotManager : public QObject
 {
@@ -42,6 +44,9 @@ public:
     bool automaticUpdate() const;
     void setAutomaticUpdate(bool automaticUpdate);
 
+    cwLinePlotTask::Solver solver() const;
+    void setSolver(cwLinePlotTask::Solver solver);
+
     void waitToFinish();
 
 signals:
@@ -55,6 +60,7 @@ public slots:
 private:
     QPointer<cwCavingRegion> Region; //The main
     QList<QPointer<cwErrorListModel>> UnconnectedChunks; //Current unconnected chunks
+    QHash<cwCave*, QPointer<cwErrorModel>> SolverErrors; //Shots the solver couldn't reduce, a child of each cave's error model
 
     cwLinePlotTask* LinePlotTask;
 
@@ -63,6 +69,11 @@ private:
     cwSurveyChunkSignaler* SurveySignaler;
 
     bool AutomaticUpdate = true;
+    cwLinePlotTask::Solver Solver = cwLinePlotTask::NativeSolver;
+
+    //For only re-solving caves that have changed
+    QSet<cwCave*> SolvedCaves; //Caves that have up to date station positions
+    QSet<cwCave*> ChangedCaves; //Caves that have changed since the last run was started
 
     void connectCaves(cwCavingRegion* region);
 
@@ -71,10 +82,16 @@ private:
     void setCaveStationLookupAsStale(bool isStale);
     void updateUnconnectedChunkErrors(cwCave *cave, const cwLinePlotTask::LinePlotCaveData& caveData);
     void clearUnconnectedChunkErrors();
+    void updateSolverErrors(cwCave* cave, const QStringList& messages);
+
+    static cwCave* caveForObject(QObject* object);
 
 private slots:
     void rerunSurvex();
     void runSurvex();
+    void surveyDataChanged();
+    void removeSolvedCaves(int begin, int end);
+    void clearSolvedCaves();
 
     void updateLinePlot();
 };
@@ -83,4 +100,11 @@ inline bool cwLinePlotManager::automaticUpdate() const {
     return AutomaticUpdate;
 }
 
+/**
+ * Returns the solver that's used to find the station positions
+ */
+inline cwLinePlotTask::Solver cwLinePlotManager::solver() const {
+    return Solver;
+}
+
 #endif // CWLINEPLOTMANAGER_H
@@ -23,6 +23,7 @@
 #include "cwLength.h"
 #include "cwStationValidator.h"
 #include "cwErrorModel.h"
+#include "cwLoopClosureSolver.h"
 
 //Qt includes
 #include <QDebug>
@@ -51,7 +52,8 @@ bool cwLinePlotTask::LinePlotCaveData::hasNetworkChanged() const
 }
 
 cwLinePlotTask::cwLinePlotTask(QObject *parent) :
-    cwTask(parent)
+    cwTask(parent),
+    StationSolver(NativeSolver)
 {
     Region = new cwCavingRegion();
 
@@ -107,6 +109,41 @@ void cwLinePlotTask::setData(const cwCavingRegion& region) {
     RegionOriginalPointers = RegionDataPtrs(region);
 }
 
+/**
+ * @brief cwLinePlotTask::setSolver
+ * @param solver - The solver that's used to find the station positions
+ *
+ * NativeSolver finds the station positions in process with cwLoopClosureSolver. CavernSolver
+ * exports the region to survex and runs cavern. This shouldn't be called while the task is running.
+ */
+void cwLinePlotTask::setSolver(cwLinePlotTask::Solver solver)
+{
+    if(!isReady()) {
+        qWarning() << "Can't set the solver for LinePlotTask, while it's running";
+        return;
+    }
+
+    StationSolver = solver;
+}
+
+/**
+ * @brief cwLinePlotTask::setUnchangedCaves
+ * @param caves - The external caves that haven't changed since the last time they were solved
+ *
+ * Unchanged caves reuse their current station positions and survey network, and aren't checked
+ * for unconnected survey chunks. This should be called before setData() and shouldn't be called
+ * while the task is running.
+ */
+void cwLinePlotTask::setUnchangedCaves(QSet<cwCave *> caves)
+{
+    if(!isReady()) {
+        qWarning() << "Can't set the unchanged caves for LinePlotTask, while it's running";
+        return;
+    }
+
+    UnchangedCaves = caves;
+}
+
 /**
   \brief Called when plot task starts running
 
@@ -114,6 +151,8 @@ void cwLinePlotTask::setData(const cwCavingRegion& region) {
   2. Run the survex program
   3. Read the 3d file data
   4. Update the survey data
+
+  If the solver is NativeSolver, 1 through 3 are replaced by cwLoopClosureSolver
   */
 void cwLinePlotTask::runTask() {
     if(!isRunning()) {
@@ -133,13 +172,15 @@ void cwLinePlotTask::runTask() {
 
         Time.start();
 
-        exportData();
+        if(StationSolver == CavernSolver) {
+            exportData();
 
-        runCavern();
+            runCavern();
 
-        convertToXML();
+            convertToXML();
 
-        readXML();
+            readXML();
+        }
 
         generateCenterlineGeometry();
 
@@ -211,12 +252,22 @@ void cwLinePlotTask::generateCenterlineGeometry() {
         return;
     }
 
-    //Go through all the stations in the plot sauce parse and assign them
-    //to caves
-    updateStationPositionForCaves(PlotSauceParseTask->stationPositions());
+    QVector<cwStationPositionLookup> caveStationLookups;
+    switch(StationSolver) {
+    case NativeSolver:
+        caveStationLookups = solveCaveStations();
+        break;
+    case CavernSolver:
+        //Go through all the stations in the plot sauce parse and assign them
+        //to caves
+        caveStationLookups = splitLookupByCave(PlotSauceParseTask->stationPositions());
+
+        //Clear all the stations from the parser
+        PlotSauceParseTask->clearStationPositions();
+        break;
+    }
 
-    //Clear all the stations from the parser
-    PlotSauceParseTask->clearStationPositions();
+    updateStationPositionForCaves(caveStationLookups);
 
 //    qDebug() << "Generating centerline geometry" << status();
     CenterlineGeometryTask->setRegion(Region);
@@ -241,21 +292,31 @@ void cwLinePlotTask::linePlotTaskComplete() {
     //Update the networks for the caves
     updateCaveNetworks();
 
+    //All the caves in the region are now up to date
+    QSet<cwCave*> solvedCaves;
+    QSet<cwCave*> resolvedCaves;
+    for(int i = 0; i < RegionOriginalPointers.Caves.size(); i++) {
+        cwCave* cave = RegionOriginalPointers.Caves.at(i).Cave;
+        solvedCaves.insert(cave);
+        if(!isCaveUnchanged(i)) {
+            resolvedCaves.insert(cave);
+        }
+    }
+    Result.SolvedCaves = solvedCaves;
+    Result.ResolvedCaves = resolvedCaves;
+
 //    qDebug() << "Finished running linePlotTask:" << Time.elapsed() << "ms";
 }
 
 /**
  * @brief cwLinePlotTask::updateStationPositionForCaves
- * @param stationPostions
+ * @param caveStationLookups - The new station positions, one lookup per cave
  */
-void cwLinePlotTask::updateStationPositionForCaves(const cwStationPositionLookup& stationPostions) {
+void cwLinePlotTask::updateStationPositionForCaves(const QVector<cwStationPositionLookup>& caveStationLookups) {
 
     //Index all the stations for quick lookup
     indexStations();
 
-    //Splite up stationPostions for each indiviual cave
-    QVector<cwStationPositionLookup> caveStationLookups = splitLookupByCave(stationPostions);
-
     //Update all the lookups that are part of this class
     updateInteralCaveStationLookups(caveStationLookups);
 
@@ -276,6 +337,14 @@ void cwLinePlotTask::updateDepthLength()
         //Get the region's caves
         cwLinePlotGeometryTask::LengthAndDepth lengthAndDepth = caveLengthAndDepth.at(i);
 
+        //Only update caves where the length or depth has changed
+        cwCave* cave = Region->cave(i);
+        double length = cwUnits::convert(lengthAndDepth.length(), cwUnits::Meters, (cwUnits::LengthUnit)cave->length()->unit());
+        double depth = cwUnits::convert(lengthAndDepth.depth(), cwUnits::Meters, (cwUnits::LengthUnit)cave->depth()->unit());
+        if(length == cave->length()->value() && depth == cave->depth()->value()) {
+            continue;
+        }
+
         LinePlotCaveData& caveData = createLinePlotCaveDataAt(i);
         caveData.setLength(lengthAndDepth.length());
         caveData.setDepth(lengthAndDepth.depth());
@@ -288,6 +357,11 @@ void cwLinePlotTask::updateDepthLength()
 void cwLinePlotTask::checkForErrors()
 {
     for(int i = 0; i < Region->caveCount(); i++) {
+        if(isCaveUnchanged(i)) {
+            //Unchanged caves were checked the last time they were solved
+            continue;
+        }
+
         cwCave* cave = Region->cave(i);
         UnconnectedSurveyChunkTask->setCave(cave);
         UnconnectedSurveyChunkTask->start();
@@ -396,7 +470,12 @@ void cwLinePlotTask::indexStations()
     TripLookups.resize(Region->caveCount());
 
     for(int i = 0; i < Region->caveCount() && isRunning(); i++) {
-        TripLookups[i] = StationTripScrapLookup(Region->cave(i));
+        if(isCaveUnchanged(i)) {
+            //None of the stations in an unchanged cave move
+            TripLookups[i] = StationTripScrapLookup();
+        } else {
+            TripLookups[i] = StationTripScrapLookup(Region->cave(i));
+        }
     }
 }
 
@@ -435,12 +514,9 @@ QVector<cwStationPositionLookup> cwLinePlotTask::splitLookupByCave(const cwStati
     QVector<cwStationPositionLookup> caveStations;
     caveStations.resize(CaveStationLookups.size());
 
-    QMapIterator<QString, QVector3D> iter(stationPostions.positions());
-    while( iter.hasNext() ) {
-        iter.next();
-
-        QString name = iter.key();
-        QVector3D position = iter.value();
+    for(int stationId = 0; stationId < stationPostions.stationCount(); stationId++) {
+        QString name = stationPostions.stationName(stationId);
+        QVector3D position = stationPostions.position(stationId);
 
         //Cut off positions to 3 digits
         position.setX(qRound(position.x() * positionFactor) / positionFactor);
@@ -486,6 +562,51 @@ QVector<cwStationPositionLookup> cwLinePlotTask::splitLookupByCave(const cwStati
     return caveStations;
 }
 
+/**
+ * @brief cwLinePlotTask::solveCaveStations
+ * @return The station positions for each cave, found with cwLoopClosureSolver
+ *
+ * The positions are rounded to centimeters, the same precision as cavern's 3d file.
+ */
+QVector<cwStationPositionLookup> cwLinePlotTask::solveCaveStations()
+{
+    double positionPrecision = 2; //position to 2 digits
+    double positionFactor = pow(10.0, positionPrecision);
+
+    QVector<cwStationPositionLookup> caveStations;
+    caveStations.resize(Region->caveCount());
+
+    for(int i = 0; i < Region->caveCount() && isRunning(); i++) {
+        if(isCaveUnchanged(i)) {
+            //Reuse the positions from the last time the cave was solved
+            caveStations[i] = CaveStationLookups.at(i);
+            continue;
+        }
+
+        cwLoopClosureSolver solver;
+        solver.addCave(Region->cave(i));
+        cwStationPositionLookup solvedLookup = solver.solve();
+
+        if(!solver.errors().isEmpty()) {
+            LinePlotCaveData& caveData = createLinePlotCaveDataAt(i);
+            caveData.setSolverErrors(solver.errors());
+        }
+
+        cwStationPositionLookup& lookup = caveStations[i];
+        lookup.reserve(solvedLookup.stationCount());
+        for(int stationId = 0; stationId < solvedLookup.stationCount(); stationId++) {
+            QVector3D position = solvedLookup.position(stationId);
+            position.setX(qRound(position.x() * positionFactor) / positionFactor);
+            position.setY(qRound(position.y() * positionFactor) / positionFactor);
+            position.setZ(qRound(position.z() * positionFactor) / positionFactor);
+
+            lookup.setPosition(solvedLookup.stationName(stationId), position);
+        }
+    }
+
+    return caveStations;
+}
+
 /**
  * @brief cwLinePlotTask::updateInteralCaveStationLookups
  * @param caveStations
@@ -498,22 +619,21 @@ void cwLinePlotTask::updateInteralCaveStationLookups(QVector<cwStationPositionLo
     //Go through all the stations and compare the to there previous positions
     //If they have been updated then, this will add them to the station changed
     for(int i = 0; i < caveStations.size(); i++) {
-        cwStationPositionLookup& newLookup = caveStations[i];
-        cwStationPositionLookup& oldLookup = CaveStationLookups[i];
+        const cwStationPositionLookup& newLookup = caveStations.at(i);
+        const cwStationPositionLookup& oldLookup = CaveStationLookups.at(i);
 
-        if(newLookup.positions().size() != oldLookup.positions().size()) {
+        if(newLookup.stationCount() != oldLookup.stationCount()) {
             //This adds the station lookup as changed if the new lookup has delete or added stations
             addEmptyStationLookup(i);
         }
 
-        QMap<QString, QVector3D> newPositions = newLookup.positions();
-        QMap<QString, QVector3D> oldPositions = oldLookup.positions();
-
-        foreach(QString stationName, newPositions.keys()) {
-            if(oldPositions.contains(stationName)) {
+        for(int stationId = 0; stationId < newLookup.stationCount(); stationId++) {
+            QString stationName = newLookup.stationName(stationId);
+            int oldStationId = oldLookup.stationId(stationName);
+            if(oldStationId >= 0) {
                 //Compare new point with old point
-                QVector3D newPoint = newPositions.value(stationName);
-                QVector3D oldPoint = oldPositions.value(stationName);
+                QVector3D newPoint = newLookup.position(stationId);
+                QVector3D oldPoint = oldLookup.position(oldStationId);
                 if(newPoint != oldPoint) {
                     setStationAsChanged(i, stationName);
                 }
@@ -566,11 +686,9 @@ void cwLinePlotTask::updateCaveNetworks()
 
         foreach(cwTrip* trip, cave->trips()) {
             foreach(cwSurveyChunk* chunk, trip->chunks()) {
-                QList<cwStation> stations = chunk->stations();
-                for(int i = 0; i < stations.size() - 1; i++) {
-                    cwStation from = stations.at(i);
-                    cwStation to = stations.at(i + 1);
-                    network.addShot(from.name(), to.name());
+                const QVector<QString>& names = chunk->surveyData().stationNames();
+                for(int i = 0; i < names.size() - 1; i++) {
+                    network.addShot(names.at(i), names.at(i + 1));
                 }
             }
         }
@@ -580,6 +698,10 @@ void cwLinePlotTask::updateCaveNetworks()
 
     QList<cwCave*> caves = Region->caves();
     for(int i = 0; i < caves.size(); i++) {
+        if(isCaveUnchanged(i)) {
+            continue;
+        }
+
         cwCave* cave = caves.at(i);
         cwSurveyNetwork network = createNetwork(cave);
         cwCave* externalCave = RegionOriginalPointers.Caves.at(i).Cave;
@@ -616,6 +738,16 @@ void cwLinePlotTask::addEmptyStationLookup(int caveIndex)
     }
 }
 
+/**
+ * @brief cwLinePlotTask::isCaveUnchanged
+ * @param caveIndex
+ * @return True if the cave at caveIndex hasn't changed since the last time it was solved
+ */
+bool cwLinePlotTask::isCaveUnchanged(int caveIndex) const
+{
+    return UnchangedCaves.contains(RegionOriginalPointers.Caves.at(caveIndex).Cave);
+}
+
 /**
  * @brief cwLinePlotTask::TripDataPtrs::TripDataPtrs
  * @param trip
@@ -675,6 +807,8 @@ void cwLinePlotTask::LinePlotResultData::clear()
     Scraps.clear();
     StationPositions.clear();
     LinePlotIndexData.clear();
+    SolvedCaves.clear();
+    ResolvedCaves.clear();
 }
 
 /**
@@ -688,9 +822,9 @@ cwLinePlotTask::StationTripScrapLookup::StationTripScrapLookup(cwCave *cave)
     for(int tripIndex = 0; tripIndex < cave->tripCount(); tripIndex++) {
         cwTrip* trip = cave->trip(tripIndex);
         foreach(cwSurveyChunk* surveyChunk, trip->chunks()) {
-            foreach(cwStation station, surveyChunk->stations()) {
+            foreach(const QString& stationName, surveyChunk->surveyData().stationNames()) {
                 //Add trip to the multi hash
-                MapStationToTrip.insertMulti(station.name().toUpper(), tripIndex);
+                MapStationToTrip.insertMulti(stationName.toUpper(), tripIndex);
             }
         }
 
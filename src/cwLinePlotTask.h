@@ -30,12 +30,21 @@ class cwCave;
 #include <QElapsedTimer>
 #include <QVector>
 #include <QSet>
+#include <QStringList>
 
 class cwLinePlotTask : public cwTask
 {
     Q_OBJECT
 public:
 
+    /**
+     * How the station positions are found
+     */
+    enum Solver {
+        NativeSolver, //In-process least squares loop closure, see cwLoopClosureSolver
+        CavernSolver //Export to survex and run cavern
+    };
+
     class LinePlotCaveData {
     public:
         LinePlotCaveData();
@@ -44,12 +53,14 @@ public:
         void setLength(double length);
         void setStationPositions(cwStationPositionLookup positionLookup);
         void setUnconnectedChunkError(QList<cwFindUnconnectedSurveyChunksTask::Result> results);
+        void setSolverErrors(QStringList errors);
         void setNetwork(cwSurveyNetwork network);
 
         double depth() const;
         double length() const;
         cwStationPositionLookup stationPositions() const;
         QList<cwFindUnconnectedSurveyChunksTask::Result> unconnectedChunkError() const;
+        QStringList solverErrors() const;
         cwSurveyNetwork network() const;
 
         bool hasDepthLengthChanged() const;
@@ -61,6 +72,7 @@ public:
         double Depth;
         double Length;
         QList<cwFindUnconnectedSurveyChunksTask::Result> UnconnectedChunksErrors;
+        QStringList SolverErrors;
 
         bool StationPostionsChanged;
         bool NetworkChanged;
@@ -88,12 +100,16 @@ public:
         void setScraps(QSet<cwScrap*> scraps);
         void setPositions(QVector<QVector3D> positions);
         void setPlotIndexData(QVector<unsigned int> indexData);      
+        void setSolvedCaves(QSet<cwCave*> caves);
+        void setResolvedCaves(QSet<cwCave*> caves);
 
         QMap<cwCave*, LinePlotCaveData> caveData() const;
         QSet<cwTrip*> trips() const;
         QSet<cwScrap*> scraps() const;
         QVector<QVector3D> stationPositions() const;
         QVector<unsigned int> linePlotIndexData() const;
+        QSet<cwCave*> solvedCaves() const;
+        QSet<cwCave*> resolvedCaves() const;
 
     private:
         QMap<cwCave*, LinePlotCaveData> Caves;
@@ -101,6 +117,8 @@ public:
         QSet<cwScrap*> Scraps;
         QVector<QVector3D> StationPositions;
         QVector<unsigned int> LinePlotIndexData;
+        QSet<cwCave*> SolvedCaves;
+        QSet<cwCave*> ResolvedCaves;
 
         friend class cwLinePlotTask;
     };
@@ -110,6 +128,11 @@ public:
 
     LinePlotResultData linePlotData() const;
 
+    void setSolver(Solver solver);
+    Solver solver() const;
+
+    void setUnchangedCaves(QSet<cwCave*> caves);
+
 signals:
 
 protected:
@@ -127,7 +150,7 @@ private slots:
     void linePlotTaskComplete();
 
     //For setting up all the station positions
-    void updateStationPositionForCaves(const cwStationPositionLookup& stationPostions);
+    void updateStationPositionForCaves(const QVector<cwStationPositionLookup>& caveStationLookups);
 
     //Update the depth and length data
     void updateDepthLength();
@@ -209,6 +232,12 @@ private:
     //What's returned
     LinePlotResultData Result;
 
+    //How the station positions are found
+    Solver StationSolver;
+
+    //External caves that haven't changed since they were last solved, these reuse their positions
+    QSet<cwCave*> UnchangedCaves;
+
     //For performance testing
     QElapsedTimer Time;
 
@@ -220,6 +249,7 @@ private:
     LinePlotCaveData& createLinePlotCaveDataAt(int index);
 
     QVector<cwStationPositionLookup> splitLookupByCave(const cwStationPositionLookup& stationPostions);
+    QVector<cwStationPositionLookup> solveCaveStations();
     void updateInteralCaveStationLookups(QVector<cwStationPositionLookup> caveStations);
     void updateExteralCaveStationLookups();
 
@@ -229,6 +259,8 @@ private:
 
     void addEmptyStationLookup(int caveIndex);
 
+    bool isCaveUnchanged(int caveIndex) const;
+
 };
 
 /**
@@ -286,6 +318,31 @@ inline QVector<unsigned int> cwLinePlotTask::LinePlotResultData::linePlotIndexDa
     return LinePlotIndexData;
 }
 
+/**
+ * @brief cwLinePlotTask::LinePlotResultData::solvedCaves
+ * @return All the external caves that have up to date station positions after the task has
+ * finished. This is empty if the task was stopped or found errors.
+ *
+ *  This functions aren't thread safe!! You should only call these if the task isn't running
+ */
+inline QSet<cwCave *> cwLinePlotTask::LinePlotResultData::solvedCaves() const
+{
+    return SolvedCaves;
+}
+
+/**
+ * @brief cwLinePlotTask::LinePlotResultData::resolvedCaves
+ * @return The external caves that were solved by this run. The rest of solvedCaves() reused
+ * their results from the last time they were solved. This is empty if the task was stopped or
+ * found errors.
+ *
+ *  This functions aren't thread safe!! You should only call these if the task isn't running
+ */
+inline QSet<cwCave *> cwLinePlotTask::LinePlotResultData::resolvedCaves() const
+{
+    return ResolvedCaves;
+}
+
 /**
  * @brief cwLinePlotTask::LinePlotResultData::setCaveData
  * @param caveData
@@ -326,6 +383,22 @@ inline void cwLinePlotTask::LinePlotResultData::setPlotIndexData(QVector<unsigne
     LinePlotIndexData = indexData;
 }
 
+/**
+ * @brief cwLinePlotTask::LinePlotResultData::setSolvedCaves
+ * @param caves
+ */
+inline void cwLinePlotTask::LinePlotResultData::setSolvedCaves(QSet<cwCave*> caves) {
+    SolvedCaves = caves;
+}
+
+/**
+ * @brief cwLinePlotTask::LinePlotResultData::setResolvedCaves
+ * @param caves
+ */
+inline void cwLinePlotTask::LinePlotResultData::setResolvedCaves(QSet<cwCave*> caves) {
+    ResolvedCaves = caves;
+}
+
 /**
  * @brief cwLinePlotTask::linePlotData
  * @return The resulting line plot data from the task.
@@ -338,6 +411,16 @@ inline cwLinePlotTask::LinePlotResultData cwLinePlotTask::linePlotData() const
     return Result;
 }
 
+/**
+ * @brief cwLinePlotTask::solver
+ * @return The solver that's used to find the station positions. By default this is
+ * NativeSolver
+ */
+inline cwLinePlotTask::Solver cwLinePlotTask::solver() const
+{
+    return StationSolver;
+}
+
 /**
  * @brief cwLinePlotTask::StationTripScrapLookup::trips
  * @param stationName
@@ -394,6 +477,15 @@ inline void cwLinePlotTask::LinePlotCaveData::setUnconnectedChunkError(QList<cwF
     UnconnectedChunksErrors = results;
 }
 
+/**
+ * @brief cwLinePlotTask::LinePlotCaveData::setSolverErrors
+ * @param errors - Shots that cwLoopClosureSolver couldn't reduce, these shots aren't in the solution
+ */
+inline void cwLinePlotTask::LinePlotCaveData::setSolverErrors(QStringList errors)
+{
+    SolverErrors = errors;
+}
+
 /**
  * @brief cwLinePlotTask::LinePlotCaveData::setNetwork
  * @param network - Sets the survey network for the cave
@@ -441,6 +533,15 @@ inline QList<cwFindUnconnectedSurveyChunksTask::Result> cwLinePlotTask::LinePlot
     return UnconnectedChunksErrors;
 }
 
+/**
+ * @brief cwLinePlotTask::LinePlotCaveData::solverErrors
+ * @return Returns the errors from cwLoopClosureSolver. This is always empty for the CavernSolver
+ */
+inline QStringList cwLinePlotTask::LinePlotCaveData::solverErrors() const
+{
+    return SolverErrors;
+}
+
 /**
  * @brief cwLinePlotTask::LinePlotCaveData::network
  * @return The survey network. This is how the stations are connected to one another
@@ -0,0 +1,760 @@
+//Our includes
+#include "cwLoopClosureSolver.h"
+#include "cwCave.h"
+#include "cwTrip.h"
+#include "cwSurveyChunk.h"
+#include "cwShot.h"
+#include "cwStation.h"
+#include "cwTripCalibration.h"
+#include "cwUnits.h"
+#include "cwReadingStates.h"
+
+//Qt includes
+#include <QMap>
+#include <QtMath>
+
+//Std includes
+#include <cmath>
+#include <array>
+
+namespace {
+
+typedef std::array<double, 3> Vector;
+
+double square(double value) { return value * value; }
+double toRadians(double degrees) { return degrees * M_PI / 180.0; }
+
+//Default standard deviations, these are the same as cavern's defaults (BCRA grade 5)
+const double TapeVariance = square(0.05); //meters
+const double BearingVariance = square(toRadians(0.5));
+const double GradientVariance = square(toRadians(0.5));
+const double PlumbVariance = square(toRadians(0.25));
+const double LevelVariance = square(toRadians(0.25));
+
+//Prevents infinite weights, for zero length legs
+const double MinimumVariance = 1.0e-6;
+
+Vector toVector(const QVector3D& vector) {
+    return {{vector.x(), vector.y(), vector.z()}};
+}
+
+/**
+ * A leg that's being reduced. Delta is the position of B minus the position of A
+ */
+class Edge {
+public:
+    int A;
+    int B;
+    Vector Delta;
+    Vector Variance;
+    bool Alive;
+
+    int other(int node) const { return node == A ? B : A; }
+
+    //The delta from node, to the other node of the edge
+    Vector deltaFrom(int node) const {
+        if(node == A) {
+            return Delta;
+        }
+        return {{-Delta[0], -Delta[1], -Delta[2]}};
+    }
+};
+
+/**
+ * A station that was removed from the network before solving. Once the rest of the network
+ * is solved, the removed stations are positioned in the reverse order that they were removed.
+ */
+class Reduction {
+public:
+    enum Type {
+        Spur, //Node = A + DeltaAN
+        Series //Node is between A and B, misclosure is distributed by variance
+    };
+
+    Type ReductionType;
+    int Node;
+    int A;
+    int B;
+    Vector DeltaAN;
+    Vector DeltaNB;
+    Vector VarianceAN;
+    Vector VarianceNB;
+};
+
+/**
+ * Solves A x = b with a Jacobi preconditioned conjugate gradient. The matrix is a weighted
+ * graph laplacian, stored as a diagonal and a list of off diagonal neighbors per row.
+ * x should hold the initial guess.
+ */
+void conjugateGradient(const QVector<double>& diagonal,
+                       const QVector<int>& rowStart,
+                       const QVector<int>& columns,
+                       const QVector<double>& weights,
+                       const QVector<double>& b,
+                       QVector<double>& x)
+{
+    const int size = diagonal.size();
+    if(size == 0) {
+        return;
+    }
+
+    auto multiply = [&](const QVector<double>& vector, QVector<double>& result) {
+        for(int row = 0; row < size; row++) {
+            double sum = diagonal.at(row) * vector.at(row);
+            for(int i = rowStart.at(row); i < rowStart.at(row + 1); i++) {
+                sum -= weights.at(i) * vector.at(columns.at(i));
+            }
+            result[row] = sum;
+        }
+    };
+
+    auto dot = [size](const QVector<double>& left, const QVector<double>& right) {
+        double sum = 0.0;
+        for(int i = 0; i < size; i++) {
+            sum += left.at(i) * right.at(i);
+        }
+        return sum;
+    };
+
+    QVector<double> r(size);
+    QVector<double> z(size);
+    QVector<double> p(size);
+    QVector<double> ap(size);
+
+    multiply(x, ap);
+    for(int i = 0; i < size; i++) {
+        r[i] = b.at(i) - ap.at(i);
+        z[i] = r.at(i) / diagonal.at(i);
+    }
+    p = z;
+
+    double rz = dot(r, z);
+    double bNorm = std::sqrt(dot(b, b));
+    double tolerance = std::max(bNorm * 1.0e-12, 1.0e-12);
+    int maxIterations = std::max(100, size * 2);
+
+    for(int iteration = 0; iteration < maxIterations; iteration++) {
+        if(std::sqrt(dot(r, r)) <= tolerance) {
+            break;
+        }
+
+        multiply(p, ap);
+        double pAp = dot(p, ap);
+        if(pAp <= 0.0) {
+            break;
+        }
+
+        double alpha = rz / pAp;
+        for(int i = 0; i < size; i++) {
+            x[i] += alpha * p.at(i);
+            r[i] -= alpha * ap.at(i);
+            z[i] = r.at(i) / diagonal.at(i);
+        }
+
+        double rzNext = dot(r, z);
+        double beta = rzNext / rz;
+        rz = rzNext;
+
+        for(int i = 0; i < size; i++) {
+            p[i] = z.at(i) + beta * p.at(i);
+        }
+    }
+}
+
+}
+
+cwLoopClosureSolver::cwLoopClosureSolver()
+{
+
+}
+
+/**
+ * Removes all the stations, legs and fixed stations from the solver
+ */
+void cwLoopClosureSolver::clear()
+{
+    StationIds.clear();
+    StationNames.clear();
+    Legs.clear();
+    FixedStations.clear();
+    Errors.clear();
+}
+
+/**
+ * Adds all the shots in cave to the solver. The first station of the cave is fixed at
+ * (0, 0, 0), just like cwSurvexExporterCaveTask does.
+ *
+ * Calibrations are scoped to each trip. A survey chunk calibration replaces the current
+ * calibration, for the rest of the trip.
+ */
+void cwLoopClosureSolver::addCave(const cwCave *cave)
+{
+    if(cave == nullptr) {
+        return;
+    }
+
+    //Tie the cave down, the same way cwSurvexExporterCaveTask::fixFirstStation() does
+    if(!cave->trips().isEmpty()) {
+        cwTrip* firstTrip = cave->trips().first();
+        if(!firstTrip->chunks().isEmpty()) {
+            cwSurveyChunk* firstChunk = firstTrip->chunks().first();
+            if(firstChunk->stationCount() > 0) {
+                fixStation(firstChunk->station(0).name(), QVector3D(0.0, 0.0, 0.0));
+            }
+        }
+    }
+
+    for(cwTrip* trip : cave->trips()) {
+        const cwTripCalibration* calibration = trip->calibrations();
+
+        for(cwSurveyChunk* chunk : trip->chunks()) {
+            QMap<int, cwTripCalibration*> chunkCalibrations = chunk->calibrations();
+            const cwSurveyChunkData& data = chunk->surveyData();
+            const QVector<QString>& names = data.stationNames();
+
+            for(int i = 0; i < names.size() - 1 && i < chunk->shotCount(); i++) {
+                if(chunkCalibrations.contains(i)) {
+                    calibration = chunkCalibrations.value(i);
+                }
+
+                const QString& from = names.at(i);
+                const QString& to = names.at(i + 1);
+                if(from.isEmpty() || to.isEmpty()) {
+                    continue;
+                }
+
+                //Skip shots that are still being entered, like cwSurvexExporterTripTask
+                if(data.distanceStates().at(i) == cwDistanceStates::Empty) {
+                    continue;
+                }
+
+                QVector3D delta;
+                QVector3D variance;
+                if(reduceShot(chunk->shot(i), calibration, &delta, &variance)) {
+                    addLeg(from, to, delta, variance);
+                } else {
+                    Errors.append(QString("Error: Can't reduce shot %1 to %2 in %3")
+                                  .arg(from)
+                                  .arg(to)
+                                  .arg(trip->name()));
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Adds a leg between from and to. Delta is the position of to minus the position of
+ * from in meters. Variance is the variance of delta for each axis.
+ */
+void cwLoopClosureSolver::addLeg(const QString &from, const QString &to, const QVector3D &delta, const QVector3D &variance)
+{
+    Legs.append(Leg(stationId(from), stationId(to), delta, variance));
+}
+
+/**
+ * Fixes stationName at position. At least one station needs to be fixed for solve() to
+ * find any positions.
+ */
+void cwLoopClosureSolver::fixStation(const QString &stationName, const QVector3D &position)
+{
+    FixedStations.insert(stationId(stationName), position);
+}
+
+/**
+ * Solves the network and returns the positions of all the stations that are connected to
+ * a fixed station.
+ */
+cwStationPositionLookup cwLoopClosureSolver::solve() const
+{
+    const int numberOfStations = StationNames.size();
+
+    cwStationPositionLookup lookup;
+    if(numberOfStations == 0 || FixedStations.isEmpty()) {
+        return lookup;
+    }
+
+    QVector<bool> isFixed(numberOfStations, false);
+    for(auto iter = FixedStations.begin(); iter != FixedStations.end(); ++iter) {
+        isFixed[iter.key()] = true;
+    }
+
+    //Find all the stations that are connected to a fixed station
+    QVector<QVector<int>> legsAtStation(numberOfStations);
+    for(int i = 0; i < Legs.size(); i++) {
+        const Leg& leg = Legs.at(i);
+        if(leg.From == leg.To) {
+            continue;
+        }
+        legsAtStation[leg.From].append(i);
+        legsAtStation[leg.To].append(i);
+    }
+
+    QVector<bool> connected(numberOfStations, false);
+    QVector<int> queue;
+    queue.reserve(numberOfStations);
+    for(auto iter = FixedStations.begin(); iter != FixedStations.end(); ++iter) {
+        connected[iter.key()] = true;
+        queue.append(iter.key());
+    }
+
+    for(int i = 0; i < queue.size(); i++) {
+        int station = queue.at(i);
+        for(int legIndex : legsAtStation.at(station)) {
+            const Leg& leg = Legs.at(legIndex);
+            int other = leg.From == station ? leg.To : leg.From;
+            if(!connected.at(other)) {
+                connected[other] = true;
+                queue.append(other);
+            }
+        }
+    }
+
+    //Create the edges that are going to be reduced
+    QVector<Edge> edges;
+    edges.reserve(Legs.size() * 2);
+    QVector<QVector<int>> edgesAtStation(numberOfStations);
+    QVector<int> degree(numberOfStations, 0);
+
+    auto addEdge = [&edges, &edgesAtStation, &degree](int a, int b, const Vector& delta, const Vector& variance) {
+        int index = edges.size();
+        edges.append(Edge{a, b, delta, variance, true});
+        edgesAtStation[a].append(index);
+        edgesAtStation[b].append(index);
+        degree[a]++;
+        degree[b]++;
+    };
+
+    for(const Leg& leg : Legs) {
+        if(leg.From == leg.To || !connected.at(leg.From)) {
+            continue;
+        }
+
+        Vector variance = toVector(leg.Variance);
+        for(double& value : variance) {
+            value = std::max(value, MinimumVariance);
+        }
+
+        addEdge(leg.From, leg.To, toVector(leg.Delta), variance);
+    }
+
+    //Remove spurs and stations in the middle of chains
+    QVector<bool> removed(numberOfStations, false);
+    QVector<Reduction> reductions;
+    QVector<int> candidates;
+
+    auto isCandidate = [&](int station) {
+        return connected.at(station) && !isFixed.at(station) && !removed.at(station) && degree.at(station) <= 2;
+    };
+
+    for(int i = 0; i < numberOfStations; i++) {
+        if(isCandidate(i)) {
+            candidates.append(i);
+        }
+    }
+
+    QVector<int> aliveEdges;
+    while(!candidates.isEmpty()) {
+        int node = candidates.takeLast();
+        if(!isCandidate(node)) {
+            continue;
+        }
+
+        aliveEdges.clear();
+        for(int edgeIndex : edgesAtStation.at(node)) {
+            if(edges.at(edgeIndex).Alive) {
+                aliveEdges.append(edgeIndex);
+            }
+        }
+        Q_ASSERT(aliveEdges.size() == degree.at(node));
+
+        if(aliveEdges.size() == 1) {
+            Edge& edge = edges[aliveEdges.at(0)];
+            int other = edge.other(node);
+
+            Reduction reduction;
+            reduction.ReductionType = Reduction::Spur;
+            reduction.Node = node;
+            reduction.A = other;
+            reduction.B = -1;
+            reduction.DeltaAN = edge.deltaFrom(other);
+            reductions.append(reduction);
+
+            edge.Alive = false;
+            degree[node]--;
+            degree[other]--;
+            removed[node] = true;
+
+            if(isCandidate(other)) {
+                candidates.append(other);
+            }
+
+        } else if(aliveEdges.size() == 2) {
+            Edge& edgeA = edges[aliveEdges.at(0)];
+            Edge& edgeB = edges[aliveEdges.at(1)];
+            int a = edgeA.other(node);
+            int b = edgeB.other(node);
+
+            Reduction reduction;
+            reduction.ReductionType = Reduction::Series;
+            reduction.Node = node;
+            reduction.A = a;
+            reduction.B = b;
+            reduction.DeltaAN = edgeA.deltaFrom(a);
+            reduction.DeltaNB = edgeB.deltaFrom(node);
+            reduction.VarianceAN = edgeA.Variance;
+            reduction.VarianceNB = edgeB.Variance;
+            reductions.append(reduction);
+
+            edgeA.Alive = false;
+            edgeB.Alive = false;
+            degree[node] -= 2;
+            removed[node] = true;
+
+            if(a == b) {
+                //Both legs go to the same station, the loop doesn't constrain anything else
+                degree[a] -= 2;
+                if(isCandidate(a)) {
+                    candidates.append(a);
+                }
+            } else {
+                //Replace the chain with a single leg
+                Vector delta;
+                Vector variance;
+                for(int axis = 0; axis < 3; axis++) {
+                    delta[axis] = reduction.DeltaAN[axis] + reduction.DeltaNB[axis];
+                    variance[axis] = reduction.VarianceAN[axis] + reduction.VarianceNB[axis];
+                }
+                degree[a]--;
+                degree[b]--;
+                addEdge(a, b, delta, variance);
+            }
+        }
+    }
+
+    //Index all the stations that still need to be solved
+    QVector<int> unknownIndex(numberOfStations, -1);
+    QVector<int> unknowns;
+    for(int i = 0; i < numberOfStations; i++) {
+        if(connected.at(i) && !removed.at(i) && !isFixed.at(i)) {
+            unknownIndex[i] = unknowns.size();
+            unknowns.append(i);
+        }
+    }
+
+    //Initial guess, propagate positions out from the fixed stations over the remaining legs
+    QVector<Vector> positions(numberOfStations, Vector{{0.0, 0.0, 0.0}});
+    QVector<bool> positioned(numberOfStations, false);
+    queue.clear();
+    for(auto iter = FixedStations.begin(); iter != FixedStations.end(); ++iter) {
+        positions[iter.key()] = toVector(iter.value());
+        positioned[iter.key()] = true;
+        queue.append(iter.key());
+    }
+
+    for(int i = 0; i < queue.size(); i++) {
+        int station = queue.at(i);
+        for(int edgeIndex : edgesAtStation.at(station)) {
+            const Edge& edge = edges.at(edgeIndex);
+            if(!edge.Alive) {
+                continue;
+            }
+
+            int other = edge.other(station);
+            if(!positioned.at(other)) {
+                Vector delta = edge.deltaFrom(station);
+                for(int axis = 0; axis < 3; axis++) {
+                    positions[other][axis] = positions.at(station)[axis] + delta[axis];
+                }
+                positioned[other] = true;
+                queue.append(other);
+            }
+        }
+    }
+
+    //Solve the junction stations, for each axis
+    if(!unknowns.isEmpty()) {
+        QVector<int> rowStart(unknowns.size() + 1, 0);
+        for(const Edge& edge : edges) {
+            if(edge.Alive && unknownIndex.at(edge.A) >= 0 && unknownIndex.at(edge.B) >= 0) {
+                rowStart[unknownIndex.at(edge.A) + 1]++;
+                rowStart[unknownIndex.at(edge.B) + 1]++;
+            }
+        }
+
+        for(int i = 0; i < unknowns.size(); i++) {
+            rowStart[i + 1] += rowStart.at(i);
+        }
+
+        QVector<int> columns(rowStart.last());
+        QVector<int> edgeForEntry(rowStart.last());
+        QVector<int> fill = rowStart;
+        for(int i = 0; i < edges.size(); i++) {
+            const Edge& edge = edges.at(i);
+            int a = unknownIndex.at(edge.A);
+            int b = unknownIndex.at(edge.B);
+            if(edge.Alive && a >= 0 && b >= 0) {
+                columns[fill[a]] = b;
+                edgeForEntry[fill[a]++] = i;
+                columns[fill[b]] = a;
+                edgeForEntry[fill[b]++] = i;
+            }
+        }
+
+        QVector<double> diagonal(unknowns.size());
+        QVector<double> weights(columns.size());
+        QVector<double> rhs(unknowns.size());
+        QVector<double> x(unknowns.size());
+
+        for(int axis = 0; axis < 3; axis++) {
+            diagonal.fill(0.0);
+            rhs.fill(0.0);
+
+            for(const Edge& edge : edges) {
+                if(!edge.Alive) {
+                    continue;
+                }
+
+                double weight = 1.0 / edge.Variance[axis];
+                int a = unknownIndex.at(edge.A);
+                int b = unknownIndex.at(edge.B);
+
+                if(a >= 0) {
+                    diagonal[a] += weight;
+                    rhs[a] -= weight * edge.Delta[axis];
+                    if(b < 0) {
+                        rhs[a] += weight * positions.at(edge.B)[axis];
+                    }
+                }
+
+                if(b >= 0) {
+                    diagonal[b] += weight;
+                    rhs[b] += weight * edge.Delta[axis];
+                    if(a < 0) {
+                        rhs[b] += weight * positions.at(edge.A)[axis];
+                    }
+                }
+            }
+
+            for(int i = 0; i < weights.size(); i++) {
+                weights[i] = 1.0 / edges.at(edgeForEntry.at(i)).Variance[axis];
+            }
+
+            for(int i = 0; i < unknowns.size(); i++) {
+                x[i] = positions.at(unknowns.at(i))[axis];
+            }
+
+            conjugateGradient(diagonal, rowStart, columns, weights, rhs, x);
+
+            for(int i = 0; i < unknowns.size(); i++) {
+                positions[unknowns.at(i)][axis] = x.at(i);
+            }
+        }
+    }
+
+    //Position all the removed stations
+    for(int i = reductions.size() - 1; i >= 0; i--) {
+        const Reduction& reduction = reductions.at(i);
+        const Vector& a = positions.at(reduction.A);
+        Vector& node = positions[reduction.Node];
+
+        switch(reduction.ReductionType) {
+        case Reduction::Spur:
+            for(int axis = 0; axis < 3; axis++) {
+                node[axis] = a[axis] + reduction.DeltaAN[axis];
+            }
+            break;
+        case Reduction::Series: {
+            const Vector& b = positions.at(reduction.B);
+            for(int axis = 0; axis < 3; axis++) {
+                double totalVariance = reduction.VarianceAN[axis] + reduction.VarianceNB[axis];
+                double ratio = totalVariance > 0.0 ? reduction.VarianceAN[axis] / totalVariance : 0.5;
+                double misclosure = (b[axis] - a[axis]) - (reduction.DeltaAN[axis] + reduction.DeltaNB[axis]);
+                node[axis] = a[axis] + reduction.DeltaAN[axis] + ratio * misclosure;
+            }
+            break;
+        }
+        }
+    }
+
+    lookup.reserve(connected.count(true));
+    for(int i = 0; i < numberOfStations; i++) {
+        if(connected.at(i)) {
+            const Vector& position = positions.at(i);
+            lookup.setPosition(StationNames.at(i), QVector3D(position[0], position[1], position[2]));
+        }
+    }
+
+    return lookup;
+}
+
+/**
+ * Reduces the shot to a delta (east, north, up) in meters and the variance of the delta.
+ *
+ * The calibrations are applied the same way as cwSurvexExporterTripTask writes them to survex.
+ * Frontsights and backsights are averaged when both exist. This returns false if the shot
+ * can't be reduced, for example, if it doesn't have a distance, or if it doesn't have a compass
+ * reading and isn't vertical.
+ */
+bool cwLoopClosureSolver::reduceShot(const cwShot &shot,
+                                     const cwTripCalibration *calibration,
+                                     QVector3D *delta,
+                                     QVector3D *variance)
+{
+    Q_ASSERT(calibration != nullptr);
+    Q_ASSERT(delta != nullptr);
+    Q_ASSERT(variance != nullptr);
+
+    bool frontSights = calibration->hasFrontSights();
+    bool backSights = calibration->hasBackSights();
+
+    if(!frontSights && !backSights) {
+        return false;
+    }
+
+    if(shot.distanceState() != cwDistanceStates::Valid) {
+        return false;
+    }
+
+    double distance = cwUnits::convert(shot.distance() + calibration->tapeCalibration(),
+                                       calibration->distanceUnit(),
+                                       cwUnits::Meters);
+
+    //Clino
+    enum Vertical {
+        NotVertical = 0,
+        VerticalUp = 1,
+        VerticalDown = -1
+    };
+
+    Vertical vertical = NotVertical;
+    double clinoSum = 0.0;
+    int clinoCount = 0;
+
+    bool frontVertical = false;
+    if(frontSights) {
+        double scale = calibration->hasCorrectedClinoFrontsight() ? -1.0 : 1.0;
+        switch(shot.clinoState()) {
+        case cwClinoStates::Valid:
+            clinoSum += (shot.clino() + calibration->frontClinoCalibration()) * scale;
+            clinoCount++;
+            break;
+        case cwClinoStates::Up:
+            vertical = VerticalUp;
+            frontVertical = true;
+            break;
+        case cwClinoStates::Down:
+            vertical = VerticalDown;
+            frontVertical = true;
+            break;
+        case cwClinoStates::Empty:
+            break;
+        }
+    }
+
+    if(backSights) {
+        bool corrected = calibration->hasCorrectedClinoBacksight();
+        double scale = corrected ? -1.0 : 1.0;
+        switch(shot.backClinoState()) {
+        case cwClinoStates::Valid:
+            clinoSum += -(shot.backClino() + calibration->backClinoCalibration()) * scale;
+            clinoCount++;
+            break;
+        case cwClinoStates::Up:
+            if(!frontVertical) {
+                vertical = corrected ? VerticalUp : VerticalDown;
+            }
+            break;
+        case cwClinoStates::Down:
+            if(!frontVertical) {
+                vertical = corrected ? VerticalDown : VerticalUp;
+            }
+            break;
+        case cwClinoStates::Empty:
+            break;
+        }
+    }
+
+    if(vertical != NotVertical) {
+        *delta = QVector3D(0.0, 0.0, vertical * distance);
+        double horizontalVariance = square(distance) * PlumbVariance;
+        *variance = QVector3D(horizontalVariance, horizontalVariance, TapeVariance);
+        return true;
+    }
+
+    //Compass
+    double sinSum = 0.0;
+    double cosSum = 0.0;
+    int compassCount = 0;
+
+    if(frontSights && shot.compassState() == cwCompassStates::Valid) {
+        double correction = calibration->hasCorrectedCompassFrontsight() ? -180.0 : 0.0;
+        double bearing = toRadians(shot.compass() + calibration->frontCompassCalibration() + correction);
+        sinSum += std::sin(bearing);
+        cosSum += std::cos(bearing);
+        compassCount++;
+    }
+
+    if(backSights && shot.backCompassState() == cwCompassStates::Valid) {
+        double correction = calibration->hasCorrectedCompassBacksight() ? -180.0 : 0.0;
+        double bearing = toRadians(shot.backCompass() + calibration->backCompassCalibration() + correction + 180.0);
+        sinSum += std::sin(bearing);
+        cosSum += std::cos(bearing);
+        compassCount++;
+    }
+
+    if(compassCount == 0) {
+        return false;
+    }
+
+    double bearing = std::atan2(sinSum, cosSum) + toRadians(calibration->declination());
+    double bearingVariance = BearingVariance / compassCount;
+
+    //Level legs, if there's no clino reading
+    double clino = 0.0;
+    double clinoVariance = LevelVariance;
+    if(clinoCount > 0) {
+        clino = toRadians(clinoSum / clinoCount);
+        clinoVariance = GradientVariance / clinoCount;
+    }
+
+    double sinBearing = std::sin(bearing);
+    double cosBearing = std::cos(bearing);
+    double sinClino = std::sin(clino);
+    double cosClino = std::cos(clino);
+    double horizontal = distance * cosClino;
+
+    *delta = QVector3D(horizontal * sinBearing,
+                       horizontal * cosBearing,
+                       distance * sinClino);
+
+    //Propagate the reading variances to each axis
+    double varianceX = square(cosClino * sinBearing) * TapeVariance
+            + square(horizontal * cosBearing) * bearingVariance
+            + square(distance * sinClino * sinBearing) * clinoVariance;
+    double varianceY = square(cosClino * cosBearing) * TapeVariance
+            + square(horizontal * sinBearing) * bearingVariance
+            + square(distance * sinClino * cosBearing) * clinoVariance;
+    double varianceZ = square(sinClino) * TapeVariance
+            + square(horizontal) * clinoVariance;
+
+    *variance = QVector3D(varianceX, varianceY, varianceZ);
+    return true;
+}
+
+/**
+ * Returns the id for the station with name, creates a new id if the station doesn't exist
+ */
+int cwLoopClosureSolver::stationId(const QString &name)
+{
+    QString key = name.toLower();
+    auto iter = StationIds.find(key);
+    if(iter != StationIds.end()) {
+        return iter.value();
+    }
+
+    int id = StationNames.size();
+    StationIds.insert(key, id);
+    StationNames.append(name);
+    return id;
+}
@@ -0,0 +1,108 @@
+#ifndef CWLOOPCLOSURESOLVER_H
+#define CWLOOPCLOSURESOLVER_H
+
+//Our includes
+#include "cwGlobals.h"
+#include "cwStationPositionLookup.h"
+class cwCave;
+class cwShot;
+class cwTripCalibration;
+
+//Qt includes
+#include <QVector>
+#include <QVector3D>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief The cwLoopClosureSolver class finds station positions with a weighted least squares
+ * adjustment of the survey network
+ *
+ * This is the in-process replacement for exporting to survex and running cavern. Shots are
+ * reduced to legs (a delta in x (east), y (north), z (up) with a per axis variance), using the
+ * same calibration rules as cwSurvexExporterTripTask and the same default standard deviations
+ * that cavern uses.
+ *
+ * Solving the network:
+ * 1. Only stations that are connected to a fixed station are solved
+ * 2. Dangling legs (spurs) are removed and are positioned after the solve
+ * 3. Chains of legs through stations with only two legs are merged into a single leg. After
+ * the solve, the misclosure of the chain is distributed to the stations in proportion to the
+ * variance of the legs.
+ * 4. The remaining junction stations are solved with a preconditioned conjugate gradient, one
+ * axis at a time.
+ *
+ * Station names are case insensitive.
+ */
+class CAVEWHERE_LIB_EXPORT cwLoopClosureSolver
+{
+public:
+    class Leg {
+    public:
+        Leg() {}
+        Leg(int from, int to, QVector3D delta, QVector3D variance) :
+            From(from),
+            To(to),
+            Delta(delta),
+            Variance(variance)
+        {}
+
+        int From = -1;
+        int To = -1;
+        QVector3D Delta; //Position of To minus the position of From, in meters
+        QVector3D Variance; //Variance of Delta, for each axis, in meters squared
+    };
+
+    cwLoopClosureSolver();
+
+    void clear();
+
+    void addCave(const cwCave* cave);
+    void addLeg(const QString& from, const QString& to, const QVector3D& delta, const QVector3D& variance);
+    void fixStation(const QString& stationName, const QVector3D& position);
+
+    int stationCount() const;
+    int legCount() const;
+    QStringList errors() const;
+
+    cwStationPositionLookup solve() const;
+
+    static bool reduceShot(const cwShot& shot, const cwTripCalibration* calibration, QVector3D* delta, QVector3D* variance);
+
+private:
+    QHash<QString, int> StationIds; //Lower case name to id
+    QVector<QString> StationNames;
+    QVector<Leg> Legs;
+    QHash<int, QVector3D> FixedStations;
+    QStringList Errors;
+
+    int stationId(const QString& name);
+};
+
+/**
+ * Returns the number of unique stations that have been added to the solver
+ */
+inline int cwLoopClosureSolver::stationCount() const
+{
+    return StationNames.size();
+}
+
+/**
+ * Returns the number of legs that have been added to the solver
+ */
+inline int cwLoopClosureSolver::legCount() const
+{
+    return Legs.size();
+}
+
+/**
+ * Returns the errors from reducing shots in addCave(). Shots with errors aren't added
+ * to the network.
+ */
+inline QStringList cwLoopClosureSolver::errors() const
+{
+    return Errors;
+}
+
+#endif // CWLOOPCLOSURESOLVER_H
@@ -0,0 +1,175 @@
+//Our includes
+#include "cwMipmapPyramid.h"
+
+//Std includes
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+/**
+ * Returns true if the four 8 bit channels of format can be averaged directly. Straight
+ * (not premultiplied) alpha formats can't be, because the color needs to be weighted by alpha.
+ */
+bool canAverageDirectly(QImage::Format format)
+{
+    switch(format) {
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+    case QImage::Format_RGBX8888:
+    case QImage::Format_RGBA8888_Premultiplied:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * Spreads the four 8 bit channels of pixel into four 16 bit lanes, so channels can be summed
+ * without overflowing into each other
+ */
+inline quint64 spread(quint32 pixel)
+{
+    return (pixel & Q_UINT64_C(0x00ff00ff)) | (static_cast<quint64>(pixel & 0xff00ff00u) << 24);
+}
+
+/**
+ * Inverse of spread()
+ */
+inline quint32 pack(quint64 lanes)
+{
+    return static_cast<quint32>((lanes & Q_UINT64_C(0x00ff00ff)) | ((lanes >> 24) & Q_UINT64_C(0xff00ff00)));
+}
+
+/**
+ * Rounded average of four pixels, all channels at once (SIMD within a register)
+ */
+inline quint32 average(quint32 p0, quint32 p1, quint32 p2, quint32 p3)
+{
+    quint64 sum = spread(p0) + spread(p1) + spread(p2) + spread(p3) + Q_UINT64_C(0x0002000200020002);
+    return pack((sum >> 2) & Q_UINT64_C(0x00ff00ff00ff00ff));
+}
+
+/**
+ * Averages 2x2 pixels from row0 and row1 into output. The last column is repeated
+ * for output pixels past sourceWidth, like when sourceWidth is 1 or the source is padded.
+ */
+void averageRows(const quint32* row0, const quint32* row1, int sourceWidth,
+                 quint32* output, int outputWidth)
+{
+    //No branches in the inner loop, so the compiler can vectorize it
+    const int pairs = std::min(outputWidth, sourceWidth / 2);
+    for(int x = 0; x < pairs; x++) {
+        output[x] = average(row0[2 * x], row0[2 * x + 1], row1[2 * x], row1[2 * x + 1]);
+    }
+
+    for(int x = pairs; x < outputWidth; x++) {
+        int x0 = std::min(2 * x, sourceWidth - 1);
+        int x1 = std::min(2 * x + 1, sourceWidth - 1);
+        output[x] = average(row0[x0], row0[x1], row1[x0], row1[x1]);
+    }
+}
+
+}
+
+cwMipmapPyramid::cwMipmapPyramid(const QImage &image)
+{
+    setImage(image);
+}
+
+/**
+ * Sets level 0 of the pyramid. The image isn't copied.
+ *
+ * If paddedSize is larger than the image, level 0 is padded to paddedSize at the top and right,
+ * like cwAddImageTask::sizeDivisibleBy4(). The number of levels, and the size of each level,
+ * come from the padded size.
+ */
+void cwMipmapPyramid::setImage(const QImage &image, QSize paddedSize)
+{
+    Level = image;
+    LevelSize = image.isNull() ? QSize() : paddedSize.expandedTo(image.size());
+    LevelIndex = 0;
+    NumberOfLevels = image.isNull() ? 0 : numberOfLevels(LevelSize);
+}
+
+/**
+ * Replaces level() with the next smaller level
+ */
+void cwMipmapPyramid::nextLevel()
+{
+    Q_ASSERT(hasNextLevel());
+    Level = halfImage(Level, LevelSize);
+    LevelSize = Level.size();
+    LevelIndex++;
+}
+
+/**
+ * This takes the largest dimension and takes the log2 of it.
+ *
+ * OPENGL IS EXTREMELY SENSITVE WITH THE NUMBER OF MIPMAPS NEEDED, don't modify
+ */
+int cwMipmapPyramid::numberOfLevels(QSize imageSize)
+{
+    double largestDimension = static_cast<double>(std::max(imageSize.width(), imageSize.height()));
+    return std::max(1, static_cast<int>(log2(largestDimension)) + 1);
+}
+
+/**
+ * Halves the size. Dimensions are never less than 1.
+ */
+QSize cwMipmapPyramid::halfSize(QSize size)
+{
+    return QSize(std::max(1, size.width() / 2),
+                 std::max(1, size.height() / 2));
+}
+
+/**
+ * Downsamples image to halfSize() with a 2x2 box filter. If a dimension is odd, the last row
+ * or column is dropped, if a dimension is 1, it's repeated.
+ *
+ * If paddedSize is larger than image, the image is downsampled as if it was padded to paddedSize
+ * at the top and right, by repeating the top row and last column. The result is halfSize() of
+ * paddedSize, and a padded copy of image is never made.
+ *
+ * RGB32 and premultiplied 32 bit images keep their format. Other formats are converted to
+ * ARGB32_Premultiplied, two rows at a time, so a full size copy is never made.
+ */
+QImage cwMipmapPyramid::halfImage(const QImage &image, QSize paddedSize)
+{
+    if(image.isNull()) {
+        return QImage();
+    }
+
+    const bool direct = canAverageDirectly(image.format());
+    const QSize sourceSize = paddedSize.expandedTo(image.size());
+    const QSize size = halfSize(sourceSize);
+    const int sourceWidth = image.width();
+    const int sourceHeight = image.height();
+    const int topPadding = sourceSize.height() - sourceHeight;
+
+    QImage half(size, direct ? image.format() : QImage::Format_ARGB32_Premultiplied);
+
+    for(int y = 0; y < size.height(); y++) {
+        int y0 = std::max(0, std::min(2 * y - topPadding, sourceHeight - 1));
+        int y1 = std::max(0, std::min(2 * y + 1 - topPadding, sourceHeight - 1));
+
+        const quint32* row0;
+        const quint32* row1;
+        QImage convertedRows;
+
+        if(direct) {
+            row0 = reinterpret_cast<const quint32*>(image.constScanLine(y0));
+            row1 = reinterpret_cast<const quint32*>(image.constScanLine(y1));
+        } else {
+            convertedRows = image.copy(0, y0, sourceWidth, y1 - y0 + 1)
+                    .convertToFormat(QImage::Format_ARGB32_Premultiplied);
+            row0 = reinterpret_cast<const quint32*>(convertedRows.constScanLine(0));
+            row1 = reinterpret_cast<const quint32*>(convertedRows.constScanLine(y1 - y0));
+        }
+
+        averageRows(row0, row1, sourceWidth,
+                    reinterpret_cast<quint32*>(half.scanLine(y)), size.width());
+    }
+
+    return half;
+}
@@ -0,0 +1,93 @@
+#ifndef CWMIPMAPPYRAMID_H
+#define CWMIPMAPPYRAMID_H
+
+//Our includes
+#include "cwGlobals.h"
+
+//Qt includes
+#include <QImage>
+
+/**
+ * @brief The cwMipmapPyramid class generates mipmap levels one at a time
+ *
+ * Only the current level is kept. nextLevel() downsamples the current level by 2x with a box
+ * filter and then releases it. The pyramid itself holds at most 1.25x the size of level 0, the
+ * current level and the next one while it's being created, instead of the whole pyramid.
+ *
+ * The pyramid only releases it's references. Levels that have been copied out with level(), or
+ * the image passed to setImage(), stay in memory until their users release them.
+ *
+ * Level 0 can be padded to a larger size, see setImage(). The padding isn't copied, level()
+ * returns the image without padding and levelSize() returns the padded size. The first nextLevel()
+ * reads the padding by repeating the edge pixels, so the smaller levels include it.
+ *
+ * The pyramid isn't thread safe, but it can be passed between threads, as long as only one thread
+ * uses it at a time.
+ */
+class CAVEWHERE_LIB_EXPORT cwMipmapPyramid
+{
+public:
+    cwMipmapPyramid(const QImage& image = QImage());
+
+    void setImage(const QImage& image, QSize paddedSize = QSize());
+
+    QImage level() const;
+    QSize levelSize() const;
+    int levelIndex() const;
+    int numberOfLevels() const;
+
+    bool hasNextLevel() const;
+    void nextLevel();
+
+    static int numberOfLevels(QSize imageSize);
+    static QSize halfSize(QSize size);
+    static QImage halfImage(const QImage& image, QSize paddedSize = QSize());
+
+private:
+    QImage Level;
+    QSize LevelSize;
+    int LevelIndex = 0;
+    int NumberOfLevels = 0;
+};
+
+/**
+ * Returns the current mipmap level. Level 0 is the image passed to setImage().
+ */
+inline QImage cwMipmapPyramid::level() const
+{
+    return Level;
+}
+
+/**
+ * Returns the size of level(), with it's padding. Only level 0 can be padded.
+ */
+inline QSize cwMipmapPyramid::levelSize() const
+{
+    return LevelSize;
+}
+
+/**
+ * Returns the index of level()
+ */
+inline int cwMipmapPyramid::levelIndex() const
+{
+    return LevelIndex;
+}
+
+/**
+ * Returns the total number of levels in the pyramid, including level 0
+ */
+inline int cwMipmapPyramid::numberOfLevels() const
+{
+    return NumberOfLevels;
+}
+
+/**
+ * Returns true if level() isn't the smallest level
+ */
+inline bool cwMipmapPyramid::hasNextLevel() const
+{
+    return LevelIndex + 1 < NumberOfLevels;
+}
+
+#endif // CWMIPMAPPYRAMID_H
@@ -204,6 +204,12 @@ void cwOpenGLSettings::initialize()
                             &cwOpenGLSettings::keyWithDevice,
                             toInt);      
 
+            Singleton->load(Singleton->mDXT1Quality,
+                            defaultSettings.mDXT1Quality,
+                            dXT1QualityKey(),
+                            &cwOpenGLSettings::keyWithDevice,
+                            toInt);
+
         } else {
             Singleton->Version = "Unknown, couldn't create context";
         }
@@ -246,6 +252,7 @@ void cwOpenGLSettings::setToDefault()
     setMinFilter(defaultSettings.minFilter());
     setRendererType(defaultSettings.rendererType());
     setDXT1Algorithm(defaultSettings.dxt1Algorithm());
+    setDXT1Quality(defaultSettings.dxt1Quality());
     setUseAnisotropy(defaultSettings.useAnisotropy());
     setUseDXT1Compression(defaultSettings.useDXT1Compression());
     setNativeTextRendering(defaultSettings.useNativeTextRendering());
@@ -374,6 +381,15 @@ void cwOpenGLSettings::setDXT1Algorithm(DXT1Algorithm dxt1Algorithm) {
     }
 }
 
+void cwOpenGLSettings::setDXT1Quality(DXT1Quality dxt1Quality) {
+    if(mDXT1Quality != dxt1Quality) {
+        Q_ASSERT(thread() == QThread::currentThread());
+        mDXT1Quality = dxt1Quality;
+        updateSettingsWithDevice(dXT1QualityKey(), mDXT1Quality);
+        emit dxt1QualityChanged();
+    }
+}
+
 cwOpenGLSettings::Renderer cwOpenGLSettings::rendererType() const {
     return RendererType;
 }
@@ -393,6 +409,14 @@ QStringList cwOpenGLSettings::minFilterModel() const {
     };
 }
 
+QStringList cwOpenGLSettings::dxt1QualityModel() const {
+    return {
+        "Best",
+        "Balanced",
+        "Fast"
+    };
+}
+
 QStringList cwOpenGLSettings::rendererModel() const {
     auto toString = [](Renderer type)->QString {
         switch(type) {
@@ -25,6 +25,7 @@ class CAVEWHERE_LIB_EXPORT cwOpenGLSettings : public QObject
     //Texture generation
     Q_PROPERTY(bool gpuGeneratedDXT1Supported READ gpuGeneratedDXT1Supported CONSTANT)
     Q_PROPERTY(DXT1Algorithm dxt1Algorithm READ dxt1Algorithm WRITE setDXT1Algorithm NOTIFY dxt1AlgorithmChanged)
+    Q_PROPERTY(DXT1Quality dxt1Quality READ dxt1Quality WRITE setDXT1Quality NOTIFY dxt1QualityChanged)
 
     //For text rendering in qml
     Q_PROPERTY(bool useNativeTextRendering READ useNativeTextRendering WRITE setNativeTextRendering NOTIFY useNativeTextRenderingChanged)
@@ -33,6 +34,7 @@ class CAVEWHERE_LIB_EXPORT cwOpenGLSettings : public QObject
     //For QML
     Q_PROPERTY(QStringList magFilterModel READ magFilterModel CONSTANT)
     Q_PROPERTY(QStringList minFilterModel READ minFilterModel CONSTANT)
+    Q_PROPERTY(QStringList dxt1QualityModel READ dxt1QualityModel CONSTANT)
     Q_PROPERTY(QStringList rendererModel READ rendererModel CONSTANT)
     Q_PROPERTY(int currentSupportedRenderer READ currentSupportedRenderer WRITE setCurrentSupportedRender NOTIFY currentSupportedRendererChanged)
 
@@ -74,10 +76,19 @@ public:
         DXT1_Squish
     };
 
+    //Don't change order because this will mess-up QSettings
+    //Only used when compressing on the CPU (DXT1_Squish)
+    enum DXT1Quality {
+        DXT1_IterativeClusterFit, //squish, best quality, slowest
+        DXT1_Balanced, //cwDXT1Encoder::RangeFit
+        DXT1_Fast //cwDXT1Encoder::BoundingBox
+    };
+
     Q_ENUM(Renderer)
     Q_ENUM(MagFilter)
     Q_ENUM(MinFilter)
     Q_ENUM(DXT1Algorithm)
+    Q_ENUM(DXT1Quality)
 
     cwOpenGLSettings(const cwOpenGLSettings& other) = delete;
 
@@ -104,6 +115,9 @@ public:
     DXT1Algorithm dxt1Algorithm() const;
     void setDXT1Algorithm(DXT1Algorithm dxt1Algorithm);
 
+    DXT1Quality dxt1Quality() const;
+    void setDXT1Quality(DXT1Quality dxt1Quality);
+
     bool useNativeTextRendering() const;
     void setNativeTextRendering(bool useNativeTextRendering);
 
@@ -117,6 +131,7 @@ public:
 
     QStringList magFilterModel() const;
     QStringList minFilterModel() const;
+    QStringList dxt1QualityModel() const;
     QStringList rendererModel() const;
 
     QString vendor() const;
@@ -154,6 +169,7 @@ signals:
     void magFilterChanged();
     void minFilterChanged();
     void dxt1AlgorithmChanged();
+    void dxt1QualityChanged();
 
 private:
     class TesterSettings {
@@ -188,6 +204,7 @@ private:
     bool Mipmaps = true; //!<
     bool GPUGeneratedDXT1Supported = true; //!<
     DXT1Algorithm mDXT1Algorithm = DXT1_Squish; //!<
+    DXT1Quality mDXT1Quality = DXT1_IterativeClusterFit; //!<
     MagFilter mMagFilter = MagNearest; //!<
     MinFilter mMinFilter = MinNearest_Mipmap_Linear; //!<
 
@@ -214,6 +231,7 @@ private:
     static QString magFilterKey() { return QLatin1String("scrapMagFilter"); }
     static QString minFilterKey() { return QLatin1String("scrapMinFilter"); }
     static QString dXT1GenerateAlgroKey() { return QLatin1String("dxt1GenerateAlgroKey"); }
+    static QString dXT1QualityKey() { return QLatin1String("dxt1Quality"); }
 
     static cwOpenGLSettings* Singleton; //This singlton isn't threadsafe
 
@@ -299,4 +317,8 @@ inline cwOpenGLSettings::DXT1Algorithm cwOpenGLSettings::dxt1Algorithm() const {
     return mDXT1Algorithm;
 }
 
+inline cwOpenGLSettings::DXT1Quality cwOpenGLSettings::dxt1Quality() const {
+    return mDXT1Quality;
+}
+
 #endif // CWOPENGLSETTINGS_H
@@ -7,6 +7,8 @@
 
 //Our includes
 #include "cwProject.h"
+#include "cwTriangulatedDataCache.h"
+#include "cwImageProvider.h"
 #include "cwCave.h"
 #include "cwTrip.h"
 #include "cwAddImageTask.h"
@@ -21,6 +23,7 @@
 #include "cwTaskManagerModel.h"
 #include "cwAsyncFuture.h"
 #include "cwErrorListModel.h"
+#include "cwTexturePack.h"
 
 //Qt includes
 #include <QDir>
@@ -58,6 +61,8 @@ cwProject::cwProject(QObject* parent) :
 
 cwProject::~cwProject()
 {
+    //Nothing can open the temporary project once it's gone
+    removeTemporaryProjectFile();
 }
 
 /**
@@ -65,12 +70,8 @@ cwProject::~cwProject()
   */
 void cwProject::createTempProjectFile() {
 
-    if(isTemporaryProject()) {
-        //Remove the old temp project file
-        if(QFileInfo(filename()).exists()) {
-            QFile::remove(filename());
-        }
-    }
+    //Remove the old temp project file
+    removeTemporaryProjectFile();
 
     //Create the with a hex number
     QString projectFile = createTemporaryFilename();
@@ -94,6 +95,29 @@ void cwProject::createTempProjectFile() {
     emit canSaveDirectlyChanged();
 }
 
+/**
+  Removes the project file and it's texture pack, if this is a temporary project. The project's
+  connections are closed first, open files can't be removed on windows. The image provider's
+  pooled connections are closed by the threads that own them, so the file is removed once the
+  last one is closed.
+  */
+void cwProject::removeTemporaryProjectFile() {
+    if(!isTemporaryProject()) {
+        return;
+    }
+
+    ProjectDatabase.close();
+    cwImageProvider::closeReadConnections();
+    cwTexturePack::invalidate(filename());
+
+    QString projectFilename = filename();
+    cwImageProvider::whenReadConnectionsClosed(projectFilename, [projectFilename]() {
+        if(QFileInfo(projectFilename).exists()) {
+            QFile::remove(projectFilename);
+        }
+    });
+}
+
 /**
   \brief This creates the default empty schema for the project
 
@@ -219,7 +243,14 @@ void cwProject::privateSave() {
     auto future = QtConcurrent::run([region, filename]() {
         cwRegionSaveTask saveTask;
         saveTask.setDatabaseFilename(filename);
-        return saveTask.save(region.get());
+        auto errors = saveTask.save(region.get());
+
+        if(!cwError::containsFatal(errors)) {
+            //Pack the mipmaps that have been added since the last save
+            cwTexturePack::update(filename);
+        }
+
+        return errors;
     });
 
     FutureToken.addJob({future, "Saving"});
@@ -268,6 +299,13 @@ void cwProject::saveAs(QString newFilename){
         return;
     }
 
+    //Pooled image connections keep the files open
+    cwImageProvider::closeReadConnections();
+    if(cwImageProvider::hasReadConnections(newFilename)) {
+        errorModel()->append(cwError(QString("Couldn't replace %1 because it's still being read, try again").arg(newFilename), cwError::Fatal));
+        return;
+    }
+
     //Try to remove the existing file
     if(QFileInfo(newFilename).exists()) {
         bool couldRemove = QFile::remove(newFilename);
@@ -277,6 +315,9 @@ void cwProject::saveAs(QString newFilename){
         }
     }
 
+    //The texture pack belongs to the file that was replaced
+    cwTexturePack::invalidate(newFilename);
+
     //Copy the old file to the new location
     bool couldCopy = QFile::copy(filename(), newFilename);
     if(!couldCopy) {
@@ -284,9 +325,7 @@ void cwProject::saveAs(QString newFilename){
         return;
     }
 
-    if(isTemporaryProject()) {
-        QFile::remove(filename());
-    }
+    removeTemporaryProjectFile();
 
     //Update the project filename
     setFilename(newFilename);
@@ -341,10 +380,23 @@ void cwProject::loadFile(QString filename) {
 
     filename = cwGlobals::convertFromURL(filename);
 
+    //Caves are added to Region as they're loaded, so they can be seen before the
+    //whole file is loaded
+    int loadGeneration = ++LoadGeneration;
+    LoadedCaveCount = 0;
+
     //Run the load task async
-    auto loadFuture = QtConcurrent::run([filename](){
+    auto loadFuture = QtConcurrent::run([filename, loadGeneration, this](){
         cwRegionLoadTask loadTask;
         loadTask.setDatabaseFilename(filename);
+        loadTask.setProgressive(true);
+
+        connect(&loadTask, &cwRegionLoadTask::caveLoaded, &loadTask, [loadGeneration, this](int index, cwCave* cave) {
+            QMetaObject::invokeMethod(this, [loadGeneration, index, cave, this]() {
+                addLoadedCave(loadGeneration, index, cave);
+            }, Qt::QueuedConnection);
+        }, Qt::DirectConnection);
+
         return loadTask.load();
     });
 
@@ -353,7 +405,10 @@ void cwProject::loadFile(QString filename) {
     auto updateRegion = [this, filename](const cwRegionLoadResult& result) {
         setFilename(result.filename());
         setTemporaryProject(result.isTempFile());
-        *Region = *(result.cavingRegion().data());
+        if(LoadedCaveCount == 0) {
+            //The file doesn't have any caves
+            *Region = *(result.cavingRegion().data());
+        }
         FileVersion = result.fileVersion();
         emit canSaveDirectly();
     };
@@ -374,6 +429,29 @@ void cwProject::loadFile(QString filename) {
     }).future();
 }
 
+/**
+ * Adds a cave from cwRegionLoadTask::caveLoaded() to the region. The first cave replaces
+ * the caves of the previous project.
+ *
+ * If loadFile() has been called again, the cave is from an old file and is deleted.
+ */
+void cwProject::addLoadedCave(int loadGeneration, int index, cwCave *cave)
+{
+    if(loadGeneration != LoadGeneration) {
+        delete cave;
+        return;
+    }
+
+    cave->moveToThread(thread());
+
+    if(index == 0) {
+        Region->clearCaves();
+    }
+
+    Region->addCave(cave);
+    LoadedCaveCount++;
+}
+
 /**
   \brief Sets the current project file
 
@@ -410,6 +488,14 @@ void cwProject::createDefaultSchema(const QSqlDatabase &database)
     //Create ObjectData
     createTable(database, objectDataQuery);
 
+    //Caves and trips, found by the hash of their proto buffer, see cwRegionSaveTask
+    QString objectRecordsQuery =
+            QString("CREATE TABLE IF NOT EXISTS ObjectRecords (") +
+            QString("hash BLOB PRIMARY KEY,") + //Sha1 of the protoBuffer
+            QString("protoBuffer BLOB") +
+            QString(")");
+    createTable(database, objectRecordsQuery);
+
     QString documentationTableQuery =
             QString("CREATE TABLE IF NOT EXISTS FileFormatDocumenation (") +
             QString("id INTEGER PRIMARY KEY AUTOINCREMENT,") + //First index
@@ -434,6 +520,9 @@ void cwProject::createDefaultSchema(const QSqlDatabase &database)
             QString("dotsPerMeter INTEGER,") + //The resolution of the image
             QString("imageData BLOB)"); //The blob that stores the image data
     createTable(database, imageTableQuery);
+
+    //Create the triangulated scrap cache
+    cwTriangulatedDataCache::createTable(database);
 }
 
 QString cwProject::createTemporaryFilename()
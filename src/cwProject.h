@@ -113,6 +113,10 @@ private:
     QFuture<void> LoadFuture;
     QFuture<void> SaveFuture;
 
+    //Caves from older loads are ignored, see addLoadedCave()
+    int LoadGeneration = 0;
+    int LoadedCaveCount = 0;
+
     //The undo stack
     QUndoStack* UndoStack;
 
@@ -126,6 +130,7 @@ private:
     static QAtomicInt ConnectionCounter;
 
     void createTempProjectFile();
+    void removeTemporaryProjectFile();
     void createDefaultSchema();
 
     static void createTable(const QSqlDatabase& database, QString sql); //Helpers to createDefaultSchema
@@ -135,6 +140,8 @@ private:
 
     void privateSave();
 
+    void addLoadedCave(int loadGeneration, int index, cwCave* cave);
+
     bool saveWillCauseDataLoss() const;
     void setTemporaryProject(bool isTemp);
 };
@@ -32,6 +32,7 @@ cwProjectIOTask::cwProjectIOTask(QObject* parent) :
 
 QList<cwError> cwProjectIOTask::errors() const
 {
+    QMutexLocker locker(&ErrorsMutex);
     return Errors;
 }
 
@@ -88,10 +89,12 @@ void cwProjectIOTask::endTransation() {
 
 void cwProjectIOTask::addError(const cwError &error)
 {
+    QMutexLocker locker(&ErrorsMutex);
     Errors.append(error);
 }
 
 void cwProjectIOTask::clearErrors()
 {
+    QMutexLocker locker(&ErrorsMutex);
     Errors.clear();
 }
@@ -17,6 +17,7 @@ class cwCavingRegion;
 #include <QSqlDatabase>
 #include <QAtomicInt>
 #include <QList>
+#include <QMutex>
 
 /**
   cXMLProjectLoadTask
@@ -48,6 +49,7 @@ protected:
     void clearErrors();
 
 private:
+    mutable QMutex ErrorsMutex; //Errors can be added from other threads, see cwRegionLoadTask
     QList<cwError> Errors;
 
     //For database access
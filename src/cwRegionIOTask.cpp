@@ -54,7 +54,7 @@ void cwRegionIOTask::copyRegionTo(cwCavingRegion &region)
  */
 int cwRegionIOTask::protoVersion()
 {
-    return 3;
+    return 4;
 }
 
 /**
@@ -68,7 +68,8 @@ QString cwRegionIOTask::toVersion(int protoVersion)
         {0, "0.07"},
         {1, "0.08"},
         {2, "0.09-beta1"},
-        {3, "0.09-beta2"}
+        {3, "0.09-beta2"},
+        {4, "0.09-beta3"}
     };
 
     return protoToVersionString.value(protoVersion, "Unknown Version");
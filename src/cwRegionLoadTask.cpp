@@ -25,15 +25,18 @@
 #include "cwSurveyNetwork.h"
 #include "cavewhereVersion.h"
 #include "cwProject.h"
+#include "cwBulkEdit.h"
 
 //Qt includes
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QSqlRecord>
 #include <QThread>
+#include <QtConcurrent>
 
 //Std includes
 #include <sstream>
+#include <vector>
 
 //Protobuf
 #include "cavewhere.pb.h"
@@ -63,6 +66,21 @@ void cwRegionLoadTask::setDeleteOldImages(bool deleteImages)
     DeleteOldImages = deleteImages;
 }
 
+/**
+ * If progressive is true, load() gives each cave to caveLoaded() as soon as it's loaded,
+ * instead of adding it to the loaded region. This lets the caves be shown before the whole
+ * file has been loaded.
+ *
+ * caveLoaded() is emitted in the thread that called load(), in the order the caves are in
+ * the file. The cave has no thread affinity, and is owned by the receiver. Call
+ * cwCave::moveToThread() to pull it into the receiver's thread. If there's a fatal error,
+ * caveLoaded() isn't emitted.
+ */
+void cwRegionLoadTask::setProgressive(bool progressive)
+{
+    Progressive = progressive;
+}
+
 cwRegionLoadResult cwRegionLoadTask::load()
 {
     cwRegionLoadResult results;
@@ -135,22 +153,44 @@ cwRegionLoadTask::LoadData cwRegionLoadTask::loadFromProtoBuffer()
         return {};
     }
 
+    //The caves are parsed separately, so they can be parsed in parallel
+    QByteArray headerData;
+    QList<QByteArray> caveData;
+    bool couldSplit = splitCavingRegion(protoBufferData, &headerData, &caveData);
+
     CavewhereProto::CavingRegion regionProto;
-    bool couldParse = regionProto.ParseFromArray(protoBufferData.data(), protoBufferData.size());
+    bool couldParse = couldSplit && regionProto.ParseFromArray(headerData.data(), headerData.size());
 
     if(!couldParse) {
         addError(cwError("Couldn't read proto buffer. Corrupted?!", cwError::Fatal));
         return {};
     }
 
-    auto data = loadCavingRegion(regionProto);
+    //Since version 4, caves are stored as records
+    if(regionProto.caverecords_size() > 0) {
+        caveData = readCaveRecords(regionProto, &okay);
+        if(!okay) {
+            return {};
+        }
+    }
+
+    QSet<int> validImageIds;
+    auto data = loadCavingRegion(regionProto, caveData, &validImageIds);
+    if(data.region.isNull()) {
+        return {};
+    }
 
     //Clean up old images
     if(DeleteOldImages) {
         cwImageCleanupTask imageCleanupTask;
         imageCleanupTask.setUsingThreadPool(false);
         imageCleanupTask.setDatabaseFilename(databaseFilename());
-        imageCleanupTask.setRegion(data.region.data());
+        if(Progressive) {
+            //The caves have been given away
+            imageCleanupTask.setValidImageIds(validImageIds);
+        } else {
+            imageCleanupTask.setRegion(data.region.data());
+        }
         imageCleanupTask.start();
     }
 
@@ -158,6 +198,163 @@ cwRegionLoadTask::LoadData cwRegionLoadTask::loadFromProtoBuffer()
     return data;
 }
 
+/**
+ * @brief cwRegionLoadTask::splitCavingRegion
+ * @param regionData - A serialized CavewhereProto::CavingRegion
+ * @param header - All the fields of the region, except the caves
+ * @param caves - Each serialized CavewhereProto::Cave. These reference regionData, so regionData
+ * must outlive them.
+ * @return False if regionData isn't a valid proto buffer
+ *
+ * This only walks the proto buffer wire format, nothing is parsed.
+ */
+bool cwRegionLoadTask::splitCavingRegion(const QByteArray &regionData, QByteArray *header, QList<QByteArray> *caves)
+{
+    const int cavesFieldNumber = 1;
+
+    enum WireType {
+        Varint = 0,
+        Fixed64 = 1,
+        LengthDelimited = 2,
+        Fixed32 = 5
+    };
+
+    const char* begin = regionData.constData();
+    const char* end = begin + regionData.size();
+    const char* current = begin;
+
+    auto readVarint = [&current, end](quint64* value) {
+        *value = 0;
+        for(int shift = 0; shift < 64; shift += 7) {
+            if(current >= end) {
+                return false;
+            }
+            quint8 byte = static_cast<quint8>(*current++);
+            *value |= static_cast<quint64>(byte & 0x7F) << shift;
+            if((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    header->clear();
+    caves->clear();
+
+    while(current < end) {
+        const char* fieldBegin = current;
+
+        quint64 tag;
+        if(!readVarint(&tag)) {
+            return false;
+        }
+
+        const int fieldNumber = static_cast<int>(tag >> 3);
+        const int wireType = static_cast<int>(tag & 0x7);
+
+        quint64 length = 0;
+        switch(wireType) {
+        case Varint: {
+            quint64 value;
+            if(!readVarint(&value)) {
+                return false;
+            }
+            break;
+        }
+        case Fixed64:
+            length = 8;
+            break;
+        case Fixed32:
+            length = 4;
+            break;
+        case LengthDelimited:
+            if(!readVarint(&length)) {
+                return false;
+            }
+            break;
+        default:
+            //Groups aren't used by cavewhere.proto
+            return false;
+        }
+
+        if(length > static_cast<quint64>(end - current)) {
+            return false;
+        }
+
+        if(fieldNumber == cavesFieldNumber && wireType == LengthDelimited) {
+            caves->append(QByteArray::fromRawData(current, static_cast<int>(length)));
+        } else {
+            header->append(fieldBegin, static_cast<int>(current + length - fieldBegin));
+        }
+
+        current += length;
+    }
+
+    return true;
+}
+
+/**
+ * @brief cwRegionLoadTask::readCaveRecords
+ * @param protoRegion - A region with caveRecords
+ * @param okay - Set to false if a record couldn't be read
+ * @return Each serialized CavewhereProto::Cave, put back together from ObjectRecords
+ *
+ * See cwRegionSaveTask::saveToProtoBuffer()
+ */
+QList<QByteArray> cwRegionLoadTask::readCaveRecords(const CavewhereProto::CavingRegion &protoRegion, bool *okay)
+{
+    const int tripsFieldNumber = 2;
+    const int lengthDelimited = 2;
+
+    auto appendVarint = [](QByteArray* data, quint64 value) {
+        while(value >= 0x80) {
+            data->append(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        data->append(static_cast<char>(value));
+    };
+
+    cwSQLManager::Transaction transaction(database(), cwSQLManager::ReadOnly);
+
+    QSqlQuery selectRecord(database());
+    QString queryStr("SELECT protoBuffer FROM ObjectRecords WHERE hash = ?");
+    if(!selectRecord.prepare(queryStr)) {
+        addError({QString("Couldn't prepare select record:'%1' sql:'%2'").arg(selectRecord.lastError().databaseText()).arg(queryStr), cwError::Fatal});
+        *okay = false;
+        return {};
+    }
+
+    auto readRecord = [this, &selectRecord, okay](const std::string& hash) {
+        selectRecord.bindValue(0, QByteArray(hash.data(), static_cast<int>(hash.size())));
+        if(!selectRecord.exec() || !selectRecord.next()) {
+            addError(cwError("Couldn't find a cave or trip record. Corrupted?!", cwError::Fatal));
+            *okay = false;
+            return QByteArray();
+        }
+        return selectRecord.value(0).toByteArray();
+    };
+
+    *okay = true;
+
+    QList<QByteArray> caves;
+    caves.reserve(protoRegion.caverecords_size());
+    for(int i = 0; i < protoRegion.caverecords_size() && *okay; i++) {
+        const CavewhereProto::CaveRecord& caveRecord = protoRegion.caverecords(i);
+
+        //Concatenated proto buffers are merged, so the trips are appended to the cave
+        QByteArray cave = readRecord(caveRecord.cave());
+        for(int t = 0; t < caveRecord.trips_size() && *okay; t++) {
+            QByteArray trip = readRecord(caveRecord.trips(t));
+            appendVarint(&cave, (tripsFieldNumber << 3) | lengthDelimited);
+            appendVarint(&cave, static_cast<quint64>(trip.size()));
+            cave.append(trip);
+        }
+        caves.append(cave);
+    }
+
+    return caves;
+}
+
 /**
  * @brief cwRegionLoadTask::readProtoBufferFromDatabase
  * @return This reads the proto buffer from the database
@@ -198,7 +395,9 @@ QByteArray cwRegionLoadTask::readProtoBufferFromDatabase(bool* okay)
  * @brief cwRegionLoadTask::loadCavingRegion
  * @param region
  */
-cwRegionLoadTask::LoadData cwRegionLoadTask::loadCavingRegion(const CavewhereProto::CavingRegion &protoRegion)
+cwRegionLoadTask::LoadData cwRegionLoadTask::loadCavingRegion(const CavewhereProto::CavingRegion &protoRegion,
+                                                              const QList<QByteArray>& caveData,
+                                                              QSet<int>* validImageIds)
 {
     LoadData data(new cwCavingRegion(), loadFileVersion(protoRegion));
 
@@ -216,15 +415,54 @@ cwRegionLoadTask::LoadData cwRegionLoadTask::loadCavingRegion(const CavewherePro
                          .arg(protoVersion())));
     }
 
+    //Parse all the caves before any are loaded, so a corrupted cave is found before
+    //caves are given to caveLoaded()
+    std::vector<CavewhereProto::Cave> protoCaves(caveData.size());
+    QList<QFuture<bool>> parsing;
+    parsing.reserve(caveData.size());
+    for(int i = 0; i < caveData.size(); i++) {
+        parsing.append(QtConcurrent::run(cwTask::threadPool(), [&protoCaves, &caveData, i]() {
+            const QByteArray& cave = caveData.at(i);
+            return protoCaves[i].ParseFromArray(cave.constData(), cave.size());
+        }));
+    }
+
+    bool couldParse = true;
+    for(auto future : parsing) {
+        couldParse = future.result() && couldParse;
+    }
+
+    if(!couldParse) {
+        addError(cwError("Couldn't read proto buffer. Corrupted?!", cwError::Fatal));
+        return {};
+    }
+
+    //Each cave is loaded in a thread, and then moved to this thread
+    QThread* loadThread = QThread::currentThread();
+    QList<QFuture<cwCave*>> loading;
+    loading.reserve(caveData.size());
+    for(int i = 0; i < caveData.size(); i++) {
+        loading.append(QtConcurrent::run(cwTask::threadPool(), [this, &protoCaves, i, loadThread]() {
+            cwCave* cave = new cwCave();
+            loadCave(protoCaves[i], cave);
+            cave->moveToThread(loadThread);
+            return cave;
+        }));
+    }
+
     QList<cwCave*> caves;
-    caves.reserve(protoRegion.caves_size());
+    caves.reserve(loading.size());
 
-    for(int i = 0; i < protoRegion.caves_size(); i++) {
-        const CavewhereProto::Cave& protoCave = protoRegion.caves(i);
-        cwCave* cave = new cwCave();
-        loadCave(protoCave, cave);
+    for(int i = 0; i < loading.size(); i++) {
+        cwCave* cave = loading[i].result();
 
-        caves.append(cave);
+        if(Progressive) {
+            validImageIds->unite(cwImageCleanupTask::validImageIds(cave));
+            cave->moveToThread(nullptr);
+            emit caveLoaded(i, cave);
+        } else {
+            caves.append(cave);
+        }
     }
 
     data.region->addCaves(caves);
@@ -246,14 +484,27 @@ void cwRegionLoadTask::loadCave(const CavewhereProto::Cave& protoCave, cwCave *c
     QList<cwTrip*> trips;
     trips.reserve(protoCave.trips_size());
 
+    cwBulkEdit<cwCave> edit(cave);
+
     cave->setName(name);
     cave->length()->setUnit(lengthUnit);
     cave->depth()->setUnit(depthUnit);
 
+    //Each trip is loaded in a thread, and then moved to the cave's thread
+    QThread* caveThread = QThread::currentThread();
+    QList<QFuture<cwTrip*>> loading;
+    loading.reserve(protoCave.trips_size());
     for(int i = 0; i < protoCave.trips_size(); i++) {
-        cwTrip* trip = new cwTrip();
-        loadTrip(protoCave.trips(i), trip);
-        cave->addTrip(trip);
+        loading.append(QtConcurrent::run(cwTask::threadPool(), [this, &protoCave, i, caveThread]() {
+            cwTrip* trip = new cwTrip();
+            loadTrip(protoCave.trips(i), trip);
+            trip->moveToThread(caveThread);
+            return trip;
+        }));
+    }
+
+    for(auto future : loading) {
+        cave->addTrip(future.result());
     }
 
     cwStationPositionLookup stationLookup = loadStationPositionLookup(protoCave.stationpositionlookup());
@@ -292,6 +543,8 @@ void cwRegionLoadTask::loadTrip(const CavewhereProto::Trip& protoTrip, cwTrip *t
     QString tripName = loadString(protoTrip.name());
     QDate tripDate = loadDate(protoTrip.date());
 
+    cwBulkEdit<cwTrip> edit(trip);
+
     trip->setName(tripName);
     trip->setDate(QDateTime(tripDate));
 
@@ -653,6 +906,7 @@ cwShot cwRegionLoadTask::loadShot(const CavewhereProto::Shot& protoShot)
 cwStationPositionLookup cwRegionLoadTask::loadStationPositionLookup(const CavewhereProto::StationPositionLookup &protoStationLookup)
 {
     cwStationPositionLookup stationLookup;
+    stationLookup.reserve(protoStationLookup.stationpositions_size());
     for(int i = 0; i < protoStationLookup.stationpositions_size(); i++) {
         const CavewhereProto::StationPositionLookup_NamePosition& namePosition = protoStationLookup.stationpositions(i);
         QString name = loadString(namePosition.stationname());
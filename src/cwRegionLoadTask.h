@@ -11,7 +11,6 @@
 //Our includes
 #include "cwRegionIOTask.h"
 class cwCavingRegion;
-class cwCave;
 class cwTrip;
 class cwSurveyNoteModel;
 class cwTripCalibration;
@@ -23,6 +22,7 @@ class cwImageResolution;
 class cwNoteStation;
 class cwNoteTranformation;
 class cwLength;
+#include "cwCave.h"
 #include "cwTeamMember.h"
 #include "cwStation.h"
 #include "cwShot.h"
@@ -32,6 +32,9 @@ class cwLength;
 #include "cwLead.h"
 #include "cwRegionLoadResult.h"
 
+//Qt includes
+#include <QSet>
+
 //Google protobuffer
 namespace CavewhereProto {
     class CavingRegion;
@@ -77,10 +80,14 @@ public:
 
     void setDeleteOldImages(bool deleteImages);
 
+    void setProgressive(bool progressive);
+    bool isProgressive() const;
+
     cwRegionLoadResult load();
 
 signals:
     void finishedLoading();
+    void caveLoaded(int index, cwCave* cave);
 
 public slots:
 
@@ -100,11 +107,17 @@ private:
     };
 
     bool DeleteOldImages = true;
+    bool Progressive = false;
 
     LoadData loadFromProtoBuffer();
     QByteArray readProtoBufferFromDatabase(bool* okay);
 
-    LoadData loadCavingRegion(const CavewhereProto::CavingRegion& protoRegion);
+    static bool splitCavingRegion(const QByteArray& regionData, QByteArray* header, QList<QByteArray>* caves);
+    QList<QByteArray> readCaveRecords(const CavewhereProto::CavingRegion& protoRegion, bool* okay);
+
+    LoadData loadCavingRegion(const CavewhereProto::CavingRegion& protoRegion,
+                              const QList<QByteArray>& caveData,
+                              QSet<int>* validImageIds);
     void loadCave(const CavewhereProto::Cave& protoCave, cwCave* cave);
     void loadTrip(const CavewhereProto::Trip& protoTrip, cwTrip* trip);
     void loadSurveyNoteModel(const CavewhereProto::SurveyNoteModel& protoNoteModel,
@@ -163,4 +176,12 @@ private:
 
 };
 
+/**
+ * Returns true if caves are given to caveLoaded() as they're loaded, see setProgressive()
+ */
+inline bool cwRegionLoadTask::isProgressive() const
+{
+    return Progressive;
+}
+
 #endif // CWREGIONLOADTASK_H
@@ -40,6 +40,9 @@
 //Qt includes
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QCryptographicHash>
+#include <QSet>
+#include <QtConcurrent>
 
 //Std includes
 #include <sstream>
@@ -85,16 +88,89 @@ void cwRegionSaveTask::runTask() {
     done();
 }
 
+namespace {
+
+QByteArray toByteArray(const std::string& string)
+{
+    return QByteArray(string.data(), static_cast<int>(string.size()));
+}
+
+}
+
 /**
  * @brief cwRegionSaveTask::saveToProtoBuffer
  *
  * Save cavewhere object data usingo google protobuffer
+ *
+ * Each cave and trip is stored as a record in ObjectRecords, found by the hash of it's data. The
+ * region in ObjectData only has the hashes. Records that are already in the database aren't
+ * written again, so saving a small change only writes the trip and cave that changed.
  */
 void cwRegionSaveTask::saveToProtoBuffer(cwCavingRegion* region)
 {
+    //Serialize before the transaction, so the database is only locked while writing
+    QHash<QByteArray, QByteArray> records;
+    QByteArray regionByteArray = serializedRecords(region, &records);
+
     cwSQLManager::Transaction transaction(database());
 
-    QByteArray regionByteArray = serializedData(region);
+    QSqlQuery selectHashes(database());
+    QString selectHashesStr("SELECT hash FROM ObjectRecords");
+    if(!selectHashes.exec(selectHashesStr)) {
+        addError(cwError(QString("Couldn't execute query:") + selectHashes.lastError().databaseText() + " " + selectHashesStr + " " + LOCATION_STR, cwError::Fatal));
+        transaction.rollBack();
+        return;
+    }
+
+    QSet<QByteArray> savedHashes;
+    while(selectHashes.next()) {
+        savedHashes.insert(selectHashes.value(0).toByteArray());
+    }
+
+    //Add the new records
+    QSqlQuery insertRecord(database());
+    QString insertRecordStr("INSERT INTO ObjectRecords (hash, protoBuffer) VALUES (?, ?)");
+    if(!insertRecord.prepare(insertRecordStr)) {
+        addError(cwError(QString("Couldn't create query to insert record proto buffer data:") + insertRecord.lastError().text(), cwError::Fatal));
+        transaction.rollBack();
+        return;
+    }
+
+    for(auto iter = records.constBegin(); iter != records.constEnd(); ++iter) {
+        if(savedHashes.contains(iter.key())) {
+            continue;
+        }
+
+        insertRecord.bindValue(0, iter.key());
+        insertRecord.bindValue(1, iter.value());
+        if(!insertRecord.exec()) {
+            addError(cwError(QString("Couldn't execute query:") + insertRecord.lastError().databaseText() + " " + insertRecordStr + " " + LOCATION_STR, cwError::Fatal));
+            transaction.rollBack();
+            return;
+        }
+    }
+
+    //Remove the records that are no longer used
+    QSqlQuery deleteRecord(database());
+    QString deleteRecordStr("DELETE FROM ObjectRecords WHERE hash = ?");
+    if(!deleteRecord.prepare(deleteRecordStr)) {
+        addError(cwError(QString("Couldn't create query to delete record proto buffer data:") + deleteRecord.lastError().text(), cwError::Fatal));
+        transaction.rollBack();
+        return;
+    }
+
+    for(const QByteArray& hash : savedHashes) {
+        if(records.contains(hash)) {
+            continue;
+        }
+
+        deleteRecord.bindValue(0, hash);
+        if(!deleteRecord.exec()) {
+            addError(cwError(QString("Couldn't execute query:") + deleteRecord.lastError().databaseText() + " " + deleteRecordStr + " " + LOCATION_STR, cwError::Fatal));
+            transaction.rollBack();
+            return;
+        }
+    }
 
     QSqlQuery insertCavingRegion(database());
     QString queryStr =
@@ -116,6 +192,53 @@ void cwRegionSaveTask::saveToProtoBuffer(cwCavingRegion* region)
     }
 }
 
+/**
+ * @brief cwRegionSaveTask::serializedRecords
+ * @param region
+ * @param records - The serialized caves and trips, by their hash, are added to this
+ * @return The serialized region, with the hashes of it's caves and trips
+ *
+ * Trips are serialized in parallel.
+ */
+QByteArray cwRegionSaveTask::serializedRecords(cwCavingRegion *region, QHash<QByteArray, QByteArray> *records)
+{
+    auto addRecord = [records](const QByteArray& data) {
+        QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+        records->insert(hash, data);
+        return hash;
+    };
+
+    CavewhereProto::CavingRegion protoRegion;
+
+    foreach(cwCave* cave, region->caves()) {
+        QList<QFuture<QByteArray>> trips;
+        foreach(cwTrip* trip, cave->trips()) {
+            trips.append(QtConcurrent::run(cwTask::threadPool(), [this, trip]() {
+                CavewhereProto::Trip protoTrip;
+                saveTrip(&protoTrip, trip);
+                return toByteArray(protoTrip.SerializeAsString());
+            }));
+        }
+
+        CavewhereProto::Cave protoCave;
+        saveCaveWithoutTrips(&protoCave, cave);
+
+        CavewhereProto::CaveRecord* caveRecord = protoRegion.add_caverecords();
+        QByteArray caveHash = addRecord(toByteArray(protoCave.SerializeAsString()));
+        caveRecord->set_cave(caveHash.constData(), caveHash.size());
+
+        for(auto future : trips) {
+            QByteArray tripHash = addRecord(future.result());
+            caveRecord->add_trips(tripHash.constData(), tripHash.size());
+        }
+    }
+
+    protoRegion.set_version(protoVersion());
+    saveString(protoRegion.mutable_cavewhereversion(), CavewhereVersion);
+
+    return toByteArray(protoRegion.SerializeAsString());
+}
+
 /**
  * @brief cwRegionSaveTask::saveCave
  * @param protoCave
@@ -123,14 +246,26 @@ void cwRegionSaveTask::saveToProtoBuffer(cwCavingRegion* region)
  */
 void cwRegionSaveTask::saveCave(CavewhereProto::Cave *protoCave, cwCave *cave)
 {
-    saveString(protoCave->mutable_name(), cave->name());
-    protoCave->set_lengthunit((CavewhereProto::Units_LengthUnit)cave->length()->unit());
-    protoCave->set_depthunit((CavewhereProto::Units_LengthUnit)cave->depth()->unit());
+    saveCaveWithoutTrips(protoCave, cave);
 
     foreach(cwTrip* trip, cave->trips()) {
         CavewhereProto::Trip* protoTrip = protoCave->add_trips();
         saveTrip(protoTrip, trip);
     }
+}
+
+/**
+ * @brief cwRegionSaveTask::saveCaveWithoutTrips
+ * @param protoCave
+ * @param cave
+ *
+ * Saves everything in the cave, except the trips
+ */
+void cwRegionSaveTask::saveCaveWithoutTrips(CavewhereProto::Cave *protoCave, cwCave *cave)
+{
+    saveString(protoCave->mutable_name(), cave->name());
+    protoCave->set_lengthunit((CavewhereProto::Units_LengthUnit)cave->length()->unit());
+    protoCave->set_depthunit((CavewhereProto::Units_LengthUnit)cave->depth()->unit());
 
     saveStationLookup(protoCave->mutable_stationpositionlookup(), cave->stationPositionLookup());
     protoCave->set_stationpositionlookupstale(cave->isStationPositionLookupStale());
@@ -198,14 +333,18 @@ void cwRegionSaveTask::saveTripCalibration(CavewhereProto::TripCalibration *prot
  */
 void cwRegionSaveTask::saveSurveyChunk(CavewhereProto::SurveyChunk *protoChunk, cwSurveyChunk *chunk)
 {
-    foreach(cwStation station, chunk->stations()) {
+    const cwSurveyChunkData& data = chunk->surveyData();
+
+    protoChunk->mutable_stations()->Reserve(data.stationCount());
+    for(int i = 0; i < data.stationCount(); i++) {
         CavewhereProto::Station* protoStation = protoChunk->add_stations();
-        saveStation(protoStation, station);
+        saveStation(protoStation, data, i);
     }
 
-    foreach(cwShot shot, chunk->shots()) {
+    protoChunk->mutable_shots()->Reserve(data.shotCount());
+    for(int i = 0; i < data.shotCount(); i++) {
         CavewhereProto::Shot* protoShot = protoChunk->add_shots();
-        saveShot(protoShot, shot);
+        saveShot(protoShot, data, i);
     }
 
     auto calibrations = chunk->calibrations();
@@ -469,39 +608,41 @@ void cwRegionSaveTask::saveTeamMember(CavewhereProto::TeamMember *protoTeamMembe
 /**
  * @brief cwRegionSaveTask::saveStation
  * @param protoStation
- * @param station
+ * @param data
+ * @param index - The index of the station in data
  */
-void cwRegionSaveTask::saveStation(CavewhereProto::Station *protoStation, const cwStation &station)
+void cwRegionSaveTask::saveStation(CavewhereProto::Station *protoStation, const cwSurveyChunkData &data, int index)
 {
-    saveString(protoStation->mutable_name(), station.name());
-    protoStation->set_left(station.left());
-    protoStation->set_right(station.right());
-    protoStation->set_up(station.up());
-    protoStation->set_down(station.down());
-    protoStation->set_leftstate((CavewhereProto::DistanceStates_State)station.leftInputState());
-    protoStation->set_rightstate((CavewhereProto::DistanceStates_State)station.rightInputState());
-    protoStation->set_upstate((CavewhereProto::DistanceStates_State)station.upInputState());
-    protoStation->set_downstate((CavewhereProto::DistanceStates_State)station.downInputState());
+    saveString(protoStation->mutable_name(), data.stationNames().at(index));
+    protoStation->set_left(data.lefts().at(index));
+    protoStation->set_right(data.rights().at(index));
+    protoStation->set_up(data.ups().at(index));
+    protoStation->set_down(data.downs().at(index));
+    protoStation->set_leftstate((CavewhereProto::DistanceStates_State)data.leftStates().at(index));
+    protoStation->set_rightstate((CavewhereProto::DistanceStates_State)data.rightStates().at(index));
+    protoStation->set_upstate((CavewhereProto::DistanceStates_State)data.upStates().at(index));
+    protoStation->set_downstate((CavewhereProto::DistanceStates_State)data.downStates().at(index));
 }
 
 /**
  * @brief cwRegionSaveTask::saveShot
- * @param shot
- * @param shot
+ * @param protoShot
+ * @param data
+ * @param index - The index of the shot in data
  */
-void cwRegionSaveTask::saveShot(CavewhereProto::Shot *protoShot, const cwShot &shot)
+void cwRegionSaveTask::saveShot(CavewhereProto::Shot *protoShot, const cwSurveyChunkData &data, int index)
 {
-    protoShot->set_distance(shot.distance());
-    protoShot->set_compass(shot.compass());
-    protoShot->set_backcompass(shot.backCompass());
-    protoShot->set_clino(shot.clino());
-    protoShot->set_backclino(shot.backClino());
-    protoShot->set_distancestate((CavewhereProto::DistanceStates_State)shot.distanceState());
-    protoShot->set_compassstate((CavewhereProto::CompassStates_State)shot.compassState());
-    protoShot->set_backcompassstate((CavewhereProto::CompassStates_State)shot.backCompassState());
-    protoShot->set_clinostate((CavewhereProto::ClinoStates_State)shot.clinoState());
-    protoShot->set_backclinostate((CavewhereProto::ClinoStates_State)shot.backClinoState());
-    protoShot->set_includedistance(shot.isDistanceIncluded());
+    protoShot->set_distance(data.distances().at(index));
+    protoShot->set_compass(data.compasses().at(index));
+    protoShot->set_backcompass(data.backCompasses().at(index));
+    protoShot->set_clino(data.clinos().at(index));
+    protoShot->set_backclino(data.backClinos().at(index));
+    protoShot->set_distancestate((CavewhereProto::DistanceStates_State)data.distanceStates().at(index));
+    protoShot->set_compassstate((CavewhereProto::CompassStates_State)data.compassStates().at(index));
+    protoShot->set_backcompassstate((CavewhereProto::CompassStates_State)data.backCompassStates().at(index));
+    protoShot->set_clinostate((CavewhereProto::ClinoStates_State)data.clinoStates().at(index));
+    protoShot->set_backclinostate((CavewhereProto::ClinoStates_State)data.backClinoStates().at(index));
+    protoShot->set_includedistance(data.distancesIncluded().at(index));
 }
 
 /**
@@ -529,14 +670,11 @@ void cwRegionSaveTask::saveCavingRegion(CavewhereProto::CavingRegion &protoRegio
 void cwRegionSaveTask::saveStationLookup(CavewhereProto::StationPositionLookup *positionLookup,
                                          const cwStationPositionLookup &stationLookup)
 {
-    QMap<QString, QVector3D> positions = stationLookup.positions();
-    QMapIterator<QString, QVector3D> iter(positions);
-    while(iter.hasNext()) {
-        iter.next();
-
+    positionLookup->mutable_stationpositions()->Reserve(stationLookup.stationCount());
+    for(int i = 0; i < stationLookup.stationCount(); i++) {
         CavewhereProto::StationPositionLookup_NamePosition* namePosition = positionLookup->add_stationpositions();
-        saveString(namePosition->mutable_stationname(), iter.key());
-        saveVector3D(namePosition->mutable_position(), iter.value());
+        saveString(namePosition->mutable_stationname(), stationLookup.stationName(i));
+        saveVector3D(namePosition->mutable_position(), stationLookup.position(i));
     }
 }
 
@@ -10,6 +10,11 @@
 
 //Our includes
 #include "cwRegionIOTask.h"
+
+//Qt includes
+#include <QHash>
+#include <QByteArray>
+
 class cwCave;
 class cwTrip;
 class cwSurveyNoteModel;
@@ -25,8 +30,7 @@ class cwNoteTranformation;
 class cwTriangulatedData;
 class cwLength;
 class cwTeamMember;
-class cwStation;
-class cwShot;
+class cwSurveyChunkData;
 class cwStationPositionLookup;
 class cwLead;
 class cwSurveyNetwork;
@@ -86,7 +90,9 @@ protected:
 private:
 
     void saveToProtoBuffer(cwCavingRegion* region);
+    QByteArray serializedRecords(cwCavingRegion* region, QHash<QByteArray, QByteArray>* records);
     void saveCave(CavewhereProto::Cave* protoCave, cwCave* cave);
+    void saveCaveWithoutTrips(CavewhereProto::Cave* protoCave, cwCave* cave);
     void saveTrip(CavewhereProto::Trip* protoTrip, cwTrip* trip);
     void saveSurveyNoteModel(CavewhereProto::SurveyNoteModel* protoNoteModel,
                              cwSurveyNoteModel* noteModel);
@@ -115,9 +121,9 @@ private:
     void saveTeamMember(CavewhereProto::TeamMember* protoTeamMember,
                         const cwTeamMember& teamMember);
     void saveStation(CavewhereProto::Station* protoStation,
-                     const cwStation& station);
+                     const cwSurveyChunkData& data, int index);
     void saveShot(CavewhereProto::Shot* protoShot,
-                  const cwShot& shot);
+                  const cwSurveyChunkData& data, int index);
     void saveCavingRegion(CavewhereProto::CavingRegion& protoRegion, cwCavingRegion* region);
     void saveStationLookup(CavewhereProto::StationPositionLookup* positionLookup,
                            const cwStationPositionLookup& stationLookup);
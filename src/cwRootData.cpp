@@ -76,6 +76,7 @@ cwRootData::cwRootData(QObject *parent) :
     SurveyImportManager->setCavingRegion(Region);
     SurveyImportManager->setUndoStack(undoStack());
     SurveyImportManager->setErrorModel(Project->errorModel());
+    SurveyImportManager->setTaskManager(TaskManagerModel);
 
     QuickView = nullptr;
 
@@ -0,0 +1,99 @@
+//Our includes
+#include "cwSGLabelsNode.h"
+#include "cwGlyphAtlas.h"
+
+//Qt includes
+#include <QSGGeometry>
+#include <QSGTextureMaterial>
+#include <QSGTexture>
+#include <qgl.h>
+
+cwSGLabelsNode::cwSGLabelsNode()
+{
+    QSGTextureMaterial* material = new QSGTextureMaterial();
+    material->setFiltering(QSGTexture::Nearest);
+    setMaterial(material);
+    setFlags(QSGNode::OwnsMaterial | QSGNode::OwnsGeometry);
+
+    QSGGeometry* geometry = new QSGGeometry(QSGGeometry::defaultAttributes_TexturedPoint2D(), 0);
+    geometry->setDrawingMode(GL_TRIANGLES);
+    setGeometry(geometry);
+}
+
+cwSGLabelsNode::~cwSGLabelsNode()
+{
+}
+
+/**
+ * Sets the texture that has the glyph atlas's image. The node takes ownership of the texture,
+ * and deletes the old one.
+ */
+void cwSGLabelsNode::setTexture(QSGTexture *texture)
+{
+    static_cast<QSGTextureMaterial*>(material())->setTexture(texture);
+    Texture.reset(texture);
+    markDirty(DirtyMaterial);
+}
+
+/**
+ * Rebuilds the vertex buffer with a quad for every character in labels. Characters that
+ * aren't in the atlas are skipped.
+ *
+ * Labels are snapped to whole pixels, so the glyphs are drawn without filtering.
+ */
+void cwSGLabelsNode::setLabels(const QVector<Label> &labels, const cwGlyphAtlas &atlas)
+{
+    QSGGeometry* labelGeometry = geometry();
+    labelGeometry->allocate(vertexCount(labels, atlas));
+
+    QSizeF atlasSize = atlas.image().size();
+    QSGGeometry::TexturedPoint2D* vertex = labelGeometry->vertexDataAsTexturedPoint2D();
+
+    for(const Label& label : labels) {
+        qreal advance = 0.0;
+
+        for(QChar character : label.Text) {
+            if(!atlas.contains(character)) {
+                continue;
+            }
+
+            cwGlyphAtlas::Glyph glyph = atlas.glyph(character);
+            QPointF penPosition(qRound(label.Position.x() + advance), qRound(label.Position.y()));
+            QRectF rect = glyph.Rect.translated(penPosition);
+            QRectF texCoords(glyph.AtlasRect.x() / atlasSize.width(),
+                             glyph.AtlasRect.y() / atlasSize.height(),
+                             glyph.AtlasRect.width() / atlasSize.width(),
+                             glyph.AtlasRect.height() / atlasSize.height());
+
+            //Two triangles for the quad
+            vertex[0].set(rect.left(), rect.top(), texCoords.left(), texCoords.top());
+            vertex[1].set(rect.right(), rect.top(), texCoords.right(), texCoords.top());
+            vertex[2].set(rect.left(), rect.bottom(), texCoords.left(), texCoords.bottom());
+            vertex[3].set(rect.right(), rect.top(), texCoords.right(), texCoords.top());
+            vertex[4].set(rect.right(), rect.bottom(), texCoords.right(), texCoords.bottom());
+            vertex[5].set(rect.left(), rect.bottom(), texCoords.left(), texCoords.bottom());
+            vertex += 6;
+
+            advance += glyph.Advance;
+        }
+    }
+
+    markDirty(DirtyGeometry);
+}
+
+/**
+ * Returns the number of vertices that are needed to draw the labels, six for each character
+ * that's in the atlas
+ */
+int cwSGLabelsNode::vertexCount(const QVector<Label> &labels, const cwGlyphAtlas &atlas)
+{
+    int count = 0;
+    for(const Label& label : labels) {
+        for(QChar character : label.Text) {
+            if(atlas.contains(character)) {
+                count += 6;
+            }
+        }
+    }
+    return count;
+}
@@ -0,0 +1,49 @@
+#ifndef CWSGLABELSNODE_H
+#define CWSGLABELSNODE_H
+
+//Our includes
+#include "cwGlobals.h"
+class cwGlyphAtlas;
+
+//Qt includes
+#include <QSGGeometryNode>
+#include <QScopedPointer>
+#include <QPointF>
+#include <QString>
+#include <QVector>
+class QSGTexture;
+
+/**
+ * @brief The cwSGLabelsNode class draws many text labels with one draw call
+ *
+ * Each character is a textured quad from a cwGlyphAtlas. All the quads are in one vertex
+ * buffer, so the labels are drawn together, no matter how many there are.
+ */
+class CAVEWHERE_LIB_EXPORT cwSGLabelsNode : public QSGGeometryNode
+{
+public:
+    class Label {
+    public:
+        Label() {}
+        Label(QPointF position, QString text) :
+            Position(position),
+            Text(text)
+        {}
+
+        QPointF Position; //Top left of the text, in item coordinates
+        QString Text;
+    };
+
+    cwSGLabelsNode();
+    ~cwSGLabelsNode();
+
+    void setTexture(QSGTexture* texture);
+    void setLabels(const QVector<Label>& labels, const cwGlyphAtlas& atlas);
+
+    static int vertexCount(const QVector<Label>& labels, const cwGlyphAtlas& atlas);
+
+private:
+    QScopedPointer<QSGTexture> Texture;
+};
+
+#endif // CWSGLABELSNODE_H
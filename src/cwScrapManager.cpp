@@ -24,6 +24,7 @@
 #include "cwRegionTreeModel.h"
 #include "cwOpenGLSettings.h"
 #include "cwImageDatabase.h"
+#include "cwTriangulatedDataCache.h"
 #include "cwAsyncFuture.h"
 
 //Async future
@@ -731,12 +732,26 @@ void cwScrapManager::taskFinished(const QList<cwScrap*>& scrapsToUpdate,
         imagesToRemove.append(image);
     }
 
+    //Cropped images that were loaded from the triangulation cache are still in use
+    QSet<int> croppedImagesInUse;
+    for(const cwTriangulatedData& triangleData : validScrapTriangleDataset) {
+        croppedImagesInUse.insert(triangleData.croppedImage().original());
+    }
+
+    imagesToRemove.erase(std::remove_if(imagesToRemove.begin(), imagesToRemove.end(),
+                                        [croppedImagesInUse](const cwImage& image)
+    {
+        return croppedImagesInUse.contains(image.original());
+    }), imagesToRemove.end());
+
     auto filename = Project->filename();
     auto removeFuture = QtConcurrent::run([filename, imagesToRemove](){
         cwImageDatabase imageDatabase(filename);
         for(auto image : imagesToRemove) {
             imageDatabase.removeImages(image.ids());
         }
+
+        cwTriangulatedDataCache(filename).removeCroppedImages(imagesToRemove);
     });
 
     FutureManagerToken.addJob(cwFuture(removeFuture, "Removing Old Images"));
@@ -69,6 +69,8 @@ public:
     bool sameIntervalPointer(const cwShot& other) const;
 
 private:
+    friend class cwSurveyChunkData;
+
     enum ValidState {
         Invalid,
         ValidEmpty,
@@ -76,6 +76,8 @@ public:
     static bool nameIsValid(QString stationName);
 
 private:
+    friend class cwSurveyChunkData;
+
     class PrivateData : public QSharedData {
     public:
         PrivateData();
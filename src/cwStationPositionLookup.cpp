@@ -5,9 +5,218 @@
 **
 **************************************************************************/
 
+//Our includes
 #include "cwStationPositionLookup.h"
 
-cwStationPositionLookup::cwStationPositionLookup()
+//Qt includes
+#include <QHash>
+#include <QVector>
+
+namespace {
+
+/**
+ * Hash key for a station name, hashes and compares without case and without allocating
+ * a lower case copy of the name.
+ */
+class StationKey {
+public:
+    StationKey() {}
+    explicit StationKey(const QString& name) : Name(name) {}
+
+    QString Name;
+
+    bool operator==(const StationKey& other) const {
+        return Name.compare(other.Name, Qt::CaseInsensitive) == 0;
+    }
+};
+
+uint qHash(const StationKey& key, uint seed = 0) {
+    uint hash = seed;
+    for(const QChar& character : key.Name) {
+        hash = 31 * hash + character.toCaseFolded().unicode();
+    }
+    return hash;
+}
+
+}
+
+class cwStationPositionLookupData : public QSharedData
+{
+public:
+    QHash<StationKey, int> StationIds;
+
+    //Indexed by station id
+    QVector<QString> Names; //Lower case
+    QVector<float> X;
+    QVector<float> Y;
+    QVector<float> Z;
+};
+
+cwStationPositionLookup::cwStationPositionLookup() :
+    Data(new cwStationPositionLookupData)
+{
+}
+
+cwStationPositionLookup::cwStationPositionLookup(const cwStationPositionLookup &other) :
+    Data(other.Data)
+{
+}
+
+cwStationPositionLookup &cwStationPositionLookup::operator=(const cwStationPositionLookup &other)
+{
+    if(this != &other) {
+        Data.operator=(other.Data);
+    }
+    return *this;
+}
+
+cwStationPositionLookup::~cwStationPositionLookup()
+{
+}
+
+/**
+  Clears all the station of there data
+  */
+void cwStationPositionLookup::clearStations()
+{
+    Data->StationIds.clear();
+    Data->Names.clear();
+    Data->X.clear();
+    Data->Y.clear();
+    Data->Z.clear();
+}
+
+/**
+  Reserves space for numberOfStations. This is useful before adding many stations
+  */
+void cwStationPositionLookup::reserve(int numberOfStations)
+{
+    Data->StationIds.reserve(numberOfStations);
+    Data->Names.reserve(numberOfStations);
+    Data->X.reserve(numberOfStations);
+    Data->Y.reserve(numberOfStations);
+    Data->Z.reserve(numberOfStations);
+}
+
+/**
+  Sets the position of the station.  If the station already exists, this will
+  overwrite the position of the existing station
+  */
+void cwStationPositionLookup::setPosition(const QString& stationName, const QVector3D& stationPosition)
 {
+    int id = stationId(stationName);
+    if(id < 0) {
+        id = Data->Names.size();
+        Data->StationIds.insert(StationKey(stationName), id);
+        Data->Names.append(stationName.toLower());
+        Data->X.append(stationPosition.x());
+        Data->Y.append(stationPosition.y());
+        Data->Z.append(stationPosition.z());
+    } else {
+        Data->X[id] = stationPosition.x();
+        Data->Y[id] = stationPosition.y();
+        Data->Z[id] = stationPosition.z();
+    }
 }
 
+/**
+  Get's the station position with stationName.  If stationName doesn't exist, this
+  will return QVector3D()
+  */
+QVector3D cwStationPositionLookup::position(const QString& stationName) const
+{
+    int id = stationId(stationName);
+    if(id < 0) {
+        return QVector3D();
+    }
+    return position(id);
+}
+
+/**
+  Checks if the station position model has the position
+  */
+bool cwStationPositionLookup::hasPosition(const QString& stationName) const
+{
+    return stationId(stationName) >= 0;
+}
+
+/**
+  Returns the number of stations in the lookup. Station ids go from 0 to stationCount() - 1
+  */
+int cwStationPositionLookup::stationCount() const
+{
+    return Data->Names.size();
+}
+
+/**
+  Returns true if the lookup doesn't have any stations
+  */
+bool cwStationPositionLookup::isEmpty() const
+{
+    return Data->Names.isEmpty();
+}
+
+/**
+  Returns the id of the station, or -1 if the station doesn't exist. Ids are only valid
+  until the lookup is cleared
+  */
+int cwStationPositionLookup::stationId(const QString &stationName) const
+{
+    return Data->StationIds.value(StationKey(stationName), -1);
+}
+
+/**
+  Returns the lower case name of the station with stationId
+  */
+QString cwStationPositionLookup::stationName(int stationId) const
+{
+    return Data->Names.at(stationId);
+}
+
+/**
+  Returns the position of the station with stationId
+  */
+QVector3D cwStationPositionLookup::position(int stationId) const
+{
+    return QVector3D(Data->X.at(stationId),
+                     Data->Y.at(stationId),
+                     Data->Z.at(stationId));
+}
+
+/**
+  Gets all the positions in the model, keyed by the lower case station name
+
+  This builds a new map. Prefer iterating over the station ids
+  */
+QMap<QString, QVector3D> cwStationPositionLookup::positions() const
+{
+    QMap<QString, QVector3D> positions;
+    for(int i = 0; i < stationCount(); i++) {
+        positions.insert(stationName(i), position(i));
+    }
+    return positions;
+}
+
+/**
+  Returns true if both lookups have the same stations at the same positions. The order that
+  the stations were added doesn't matter
+  */
+bool cwStationPositionLookup::operator==(const cwStationPositionLookup &other) const
+{
+    if(Data == other.Data) {
+        return true;
+    }
+
+    if(stationCount() != other.stationCount()) {
+        return false;
+    }
+
+    for(int i = 0; i < stationCount(); i++) {
+        int otherId = other.stationId(stationName(i));
+        if(otherId < 0 || position(i) != other.position(otherId)) {
+            return false;
+        }
+    }
+
+    return true;
+}
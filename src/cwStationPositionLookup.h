@@ -12,66 +12,49 @@
 #include <QVector3D>
 #include <QString>
 #include <QMap>
+#include <QSharedDataPointer>
 
 //Our includes
 #include "cwGlobals.h"
+class cwStationPositionLookupData;
 
 /**
   The station position model holds the position of all the stations
   in a cave.
+
+  Station names are interned. Each station gets a dense integer id, in the order that it was
+  added, and the positions are stored in flat arrays indexed by that id. Looking up a station
+  by name is case insensitive and doesn't allocate. When iterating over all the stations, use
+  stationCount(), stationName(int) and position(int) instead of positions(), which builds a map.
+
+  The lookup is implicitly shared, copies are cheap until one is modified.
   */
 class CAVEWHERE_LIB_EXPORT cwStationPositionLookup {
 public:
     cwStationPositionLookup();
+    cwStationPositionLookup(const cwStationPositionLookup& other);
+    cwStationPositionLookup& operator=(const cwStationPositionLookup& other);
+    ~cwStationPositionLookup();
 
     void clearStations();
+    void reserve(int numberOfStations);
     void setPosition(const QString& stationName, const QVector3D& stationPosition);
     QVector3D position(const QString& stationName) const;
-    bool hasPosition(QString stationName) const;
+    bool hasPosition(const QString& stationName) const;
+
+    int stationCount() const;
+    bool isEmpty() const;
+    int stationId(const QString& stationName) const;
+    QString stationName(int stationId) const;
+    QVector3D position(int stationId) const;
 
     QMap<QString, QVector3D> positions() const;
 
+    bool operator==(const cwStationPositionLookup& other) const;
+    bool operator!=(const cwStationPositionLookup& other) const { return !operator==(other); }
+
 private:
-    QMap<QString, QVector3D> StationPositions;
+    QSharedDataPointer<cwStationPositionLookupData> Data;
 };
 
-/**
-  Clears all the station of there data
-  */
-inline void cwStationPositionLookup::clearStations() {
-    StationPositions.clear();
-}
-
-/**
-  Sets the position of the station.  If the station already exists, this will
-  overwrite the position of the existing station
-  */
-inline void cwStationPositionLookup::setPosition(const QString& stationName, const QVector3D& stationPosition) {
-    StationPositions[stationName.toLower()] = stationPosition;
-}
-
-/**
-  Get's the station position with stationName.  If stationName doesn't exist, this
-  will return QVector3D()
-  */
-inline QVector3D cwStationPositionLookup::position(const QString& stationName) const {
-    return StationPositions.value(stationName.toLower(), QVector3D());
-}
-
-/**
-  Checks if the station position model has the position
-  */
-inline bool cwStationPositionLookup::hasPosition(QString stationName) const {
-    return StationPositions.contains(stationName.toLower());
-}
-
-/**
-  Gets all the positions in the model
-  */
-inline QMap<QString, QVector3D> cwStationPositionLookup::positions() const {
-    return StationPositions;
-}
-
-
-
 #endif // CWSTATIONPOSITIONMODEL_H
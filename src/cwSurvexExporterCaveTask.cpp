@@ -74,10 +74,10 @@ void cwSurvexExporterCaveTask::fixFirstStation(QTextStream &stream, cwCave *cave
             cwTrip* firstTrip = cave->trips().first();
             if(!firstTrip->chunks().isEmpty()) {
                 cwSurveyChunk* firstChunk = firstTrip->chunks().first();
-                if(!firstChunk->stations().isEmpty()) {
-                    cwStation station = firstChunk->stations().first();
+                if(firstChunk->stationCount() > 0) {
+                    const QString& name = firstChunk->surveyData().stationNames().first();
 
-                    stream << "*fix " << station.name() << " " << 0 << " " << 0 << " " << 0 << endl;
+                    stream << "*fix " << name << " " << 0 << " " << 0 << " " << 0 << endl;
                 }
             }
         }
@@ -195,14 +195,16 @@ void cwSurvexExporterTripTask::writeLRUDData(QTextStream& stream, cwTrip* trip)
     foreach(cwSurveyChunk* chunk, trip->chunks()) {
         stream << "*data passage station left right up down ignoreall" << endl;
 
-        foreach(cwStation station, chunk->stations()) {
-            if(station.isValid()) {
+        const cwSurveyChunkData& data = chunk->surveyData();
+        for(int i = 0; i < data.stationCount(); i++) {
+            const QString& name = data.stationNames().at(i);
+            if(!name.isEmpty()) {
                 QString dataLine = dataLineTemplate
-                        .arg(station.name(), TextPadding)
-                        .arg(toSupportedLength(station.left(), station.leftInputState()), TextPadding)
-                        .arg(toSupportedLength(station.right(), station.rightInputState()), TextPadding)
-                        .arg(toSupportedLength(station.up(), station.upInputState()), TextPadding)
-                        .arg(toSupportedLength(station.down(), station.downInputState()), TextPadding);
+                        .arg(name, TextPadding)
+                        .arg(toSupportedLength(data.lefts().at(i), data.leftStates().at(i)), TextPadding)
+                        .arg(toSupportedLength(data.rights().at(i), data.rightStates().at(i)), TextPadding)
+                        .arg(toSupportedLength(data.ups().at(i), data.upStates().at(i)), TextPadding)
+                        .arg(toSupportedLength(data.downs().at(i), data.downStates().at(i)), TextPadding);
 
                 stream << dataLine << endl;
             }
@@ -315,23 +317,29 @@ void cwSurvexExporterTripTask::writeChunk(QTextStream& stream,
         dataLineTemplate = QString("%1 %2 %3 %4 %5");
     }
 
+    const cwSurveyChunkData& data = chunk->surveyData();
+    const QMap<int, cwTripCalibration*> calibrations = chunk->calibrations();
+
     //Iterate over all the shots
-    for(int i = 0; i < chunk->stationCount() - 1; i++) {
+    for(int i = 0; i < data.stationCount() - 1 && i < data.shotCount(); i++) {
 
         //Make sure we can still be run
         if(!parentIsRunning() && !isRunning()) { return; }
 
-        cwStation fromStation = chunk->station(i);
-        cwStation toStation = chunk->station(i + 1);
-        cwShot shot = chunk->shot(i);
+        const QString& fromStation = data.stationNames().at(i);
+        const QString& toStation = data.stationNames().at(i + 1);
+
+        if(fromStation.isEmpty() || toStation.isEmpty()) { continue; }
 
-        if(!fromStation.isValid() || !toStation.isValid()) { continue; }
+        //Skip shots that are still being entered
+        if(data.distanceStates().at(i) == cwDistanceStates::Empty) { continue; }
 
-        QString distance = toSupportedLength(shot.distance(), cwDistanceStates::Valid);
-        QString compass = compassToString(shot.compass(), shot.compassState());
-        QString backCompass = compassToString(shot.backCompass(), shot.backCompassState());
-        QString clino = clinoToString(shot.clino(), shot.clinoState());
-        QString backClino = clinoToString(shot.backClino(), shot.backClinoState());
+        QString distance = toSupportedLength(data.distances().at(i), cwDistanceStates::Valid);
+        QString compass = compassToString(data.compasses().at(i), data.compassStates().at(i));
+        QString backCompass = compassToString(data.backCompasses().at(i), data.backCompassStates().at(i));
+        QString clino = clinoToString(data.clinos().at(i), data.clinoStates().at(i));
+        QString backClino = clinoToString(data.backClinos().at(i), data.backClinoStates().at(i));
+        const bool distanceIncluded = data.distancesIncluded().at(i);
 
         //Make sure the model is good
         if(distance.isEmpty()) { continue; }
@@ -341,15 +349,15 @@ void cwSurvexExporterTripTask::writeChunk(QTextStream& stream,
                     backClino.compare("up", Qt::CaseInsensitive) != 0 &&
                     backClino.compare("down", Qt::CaseInsensitive) != 0) {
                Errors.append(QString("Error: No compass reading for %1 to %2")
-                             .arg(fromStation.name())
-                             .arg(toStation.name()));
+                             .arg(fromStation)
+                             .arg(toStation));
            }
         }
 
         if(clino.isEmpty() && backClino.isEmpty()) {
             Errors.append(QString("Error: No Clino reading for %1 to %2")
-                          .arg(fromStation.name())
-                          .arg(toStation.name()));
+                          .arg(fromStation)
+                          .arg(toStation));
         }
 
         if(compass.isEmpty()) { compass = "-"; }
@@ -369,8 +377,8 @@ void cwSurvexExporterTripTask::writeChunk(QTextStream& stream,
         QString line;
         if(hasFrontSights && hasBackSights) {
              line = dataLineTemplate
-                    .arg(fromStation.name(), TextPadding)
-                    .arg(toStation.name(), TextPadding)
+                    .arg(fromStation, TextPadding)
+                    .arg(toStation, TextPadding)
                     .arg(distance, TextPadding)
                     .arg(compass, TextPadding)
                     .arg(backCompass, TextPadding)
@@ -378,35 +386,35 @@ void cwSurvexExporterTripTask::writeChunk(QTextStream& stream,
                     .arg(backClino, TextPadding);
         } else if(hasFrontSights) {
             line = dataLineTemplate
-                   .arg(fromStation.name(), TextPadding)
-                   .arg(toStation.name(), TextPadding)
+                   .arg(fromStation, TextPadding)
+                   .arg(toStation, TextPadding)
                    .arg(distance, TextPadding)
                    .arg(compass, TextPadding)
                    .arg(clino, TextPadding);
         } else if(hasBackSights) {
             line = dataLineTemplate
-                   .arg(fromStation.name(), TextPadding)
-                   .arg(toStation.name(), TextPadding)
+                   .arg(fromStation, TextPadding)
+                   .arg(toStation, TextPadding)
                    .arg(distance, TextPadding)
                    .arg(backCompass, TextPadding)
                    .arg(backClino, TextPadding);
         }
 
         //Add chunk calibrations
-        cwTripCalibration* calibration = chunk->calibrations().value(i, nullptr);
+        cwTripCalibration* calibration = calibrations.value(i, nullptr);
         if(calibration != nullptr) {
             writeCalibrations(stream, calibration);
         }
 
         //Distance should be excluded, mark as duplicate
-        if(!shot.isDistanceIncluded()) {
+        if(!distanceIncluded) {
             stream << "*flags duplicate" << endl;
         }
 
         stream << line << endl;
 
         //Turn duplication off
-        if(!shot.isDistanceIncluded()) {
+        if(!distanceIncluded) {
             stream << "*flags not duplicate" << endl;
         }
 
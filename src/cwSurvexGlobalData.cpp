@@ -255,12 +255,11 @@ void cwSurvexGlobalData::fixStationNames(cwSurveyChunk *chunk, cwTreeImportDataN
  */
 void cwSurvexGlobalData::fixDuplicatedStationInShot(cwSurveyChunk *chunk, cwTreeImportDataNode* caveSurvexBlock)
 {
-    for(int i = 0; i < chunk->stationCount(); i+=2) {
-        cwStation station1 = chunk->station(i);
-        cwStation station2 = chunk->station(i + 1);
-
-        if(station1.name() == station2.name()) {
+    for(int i = 0; i + 1 < chunk->stationCount(); i+=2) {
+        const QVector<QString>& names = chunk->surveyData().stationNames();
+        if(names.at(i) == names.at(i + 1)) {
             //Rename one of the stations
+            cwStation station1 = chunk->station(i);
             station1.setName(generateUniqueStationName(station1.name(), caveSurvexBlock));
             chunk->setStation(station1, i);
         }
@@ -24,9 +24,11 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QThread>
+#include <QtConcurrent>
 
 //Std include
 #include "math.h"
+#include <algorithm>
 
 cwSurvexImporter::cwSurvexImporter(QObject* parent) :
     cwTreeDataImporter(parent),
@@ -76,13 +78,10 @@ void cwSurvexImporter::runTask() {
 void cwSurvexImporter::importSurvex(QString filename) {
     clear();
 
-    //Initilizing the importer
-    runStats(filename);
+    //Lex the file, and all the files it includes
+    lexFiles(filename);
     setNumberOfSteps(TotalNumberOfLines);
 
-    //Clear again because RunStats messes things up
-    clear();
-
     //Setup inital state data
     BeginEndState rootBlock; //Should never be poped off
     BeginEndStateStack.append(rootBlock);
@@ -98,6 +97,9 @@ void cwSurvexImporter::importSurvex(QString filename) {
     //Add the rootBlocks to GlobalData
     GlobalData->setNodes(RootBlock->childNodes());
 
+    //All the strings have been copied out of the files, so they can be unmapped
+    SourceFiles.clear();
+
     saveLastImport(filename);
 
 }
@@ -150,198 +152,162 @@ void cwSurvexImporter::clear() {
     Errors.clear();
     IncludeStack.clear();
     IncludeFiles.clear();
+    SourceFiles.clear();
     BeginEndStateStack.clear();
     TotalNumberOfLines = 0;
     CurrentTotalNumberOfLines = 0;
 }
 
 /**
-  \brief Loads the file
-  */
-void cwSurvexImporter::loadFile(QString filename) {
-    //Open the survex file
-    QFile file;
-    bool fileIsOpen = openFile(file, filename);
-    if(!fileIsOpen) {
-        return;
-    }
+  \brief Lexes filename and all the files that it includes
 
-    //Add the file to the include stack
-    IncludeStack.append(Include(file.fileName()));
+  Files don't depend on each other until they're parsed, so all the files that are
+  included by the last group of files are lexed in parallel. The lines are counted
+  here for the progress.
+  */
+void cwSurvexImporter::lexFiles(QString filename) {
+    emit statusMessage("Gathering sauce for " + filename);
 
-    //Update the status
-    emit statusMessage("Importing " + file.fileName() );
+    auto rootFile = QSharedPointer<SourceFile>::create();
+    rootFile->Filename = filename;
+    SourceFiles.insert(filename, rootFile);
+
+    QList<QSharedPointer<SourceFile>> filesToLex({rootFile});
+    while(!filesToLex.isEmpty() && isRunning()) {
+        QList<QFuture<void>> futures;
+        futures.reserve(filesToLex.size());
+        for(const auto& source : filesToLex) {
+            SourceFile* sourcePtr = source.data();
+            futures.append(QtConcurrent::run(cwTask::threadPool(), [sourcePtr]() {
+                lexFile(sourcePtr);
+            }));
+        }
 
-    while(!file.atEnd() && isRunning()) {
-        QString line = file.readLine();
+        for(auto& future : futures) {
+            future.waitForFinished();
+        }
 
-        //The last includ file
-        increamentLineNumber();
+        //Find the files that haven't been lexed yet
+        QList<QSharedPointer<SourceFile>> includedFiles;
+        for(const auto& source : filesToLex) {
+            TotalNumberOfLines += source->Lexer.numberOfLines();
+
+            for(const QString& includeFilename : source->Includes) {
+                if(!SourceFiles.contains(includeFilename)) {
+                    auto includedFile = QSharedPointer<SourceFile>::create();
+                    includedFile->Filename = includeFilename;
+                    SourceFiles.insert(includeFilename, includedFile);
+                    includedFiles.append(includedFile);
+                }
+            }
+        }
 
-        //Get the line's data
-        parseLine(line);
+        filesToLex = includedFiles;
+    }
+}
 
+/**
+  \brief Opens and lexes the source's file, and fixes up the filenames of it's *include's
 
+  This is thread safe, as long as source isn't used anywhere else
+  */
+void cwSurvexImporter::lexFile(SourceFile *source) {
+    source->IsOpen = source->Lexer.open(source->Filename);
+
+    const cwSurvexLexer& lexer = source->Lexer;
+    for(int i = 0; i < lexer.lineCount(); i++) {
+        cwSurvexLexer::Line line = lexer.line(i);
+        if(cwSurvexLexer::directive(line) == cwSurvexLexer::IncludeDirective) {
+            source->Includes.append(fixUpFilename(source->Filename, line.span(1).toString()));
+        }
     }
-    //Emit the current line number
-//    emit progressed(CurrentTotalNumberOfLines);
-
-    IncludeStack.removeLast();
 }
 
 /**
-  \brief This does the checking to open a survex file
+  \brief This fixes up the filename of an *include, so it can be opened
 
-  It will also fix up the filename if need to try to load it
-
-  Adds an error to the error stack if it can open a file
+  If the file doesn't exist, it's probably a relative path to includedFrom. Survex filenames
+  are case insensitive, and the .svx extension is optional.
   */
-bool cwSurvexImporter::openFile(QFile& file, QString filename) {
+QString cwSurvexImporter::fixUpFilename(QString includedFrom, QString filename) {
     QFileInfo fileInfo(filename);
-    if(!fileInfo.exists() && !IncludeStack.isEmpty()) {
-        //This maybe a relative path to the rootFile
-        QFileInfo rootFileInfo(currentFile());
-        QDir rootFileDir = rootFileInfo.absoluteDir().path();
-
-        rootFileDir.setNameFilters(QStringList("*.svx"));
-        QStringList entries = rootFileDir.entryList();
-
-        //Find the filename, this is needed because, filename case insensitive
-        foreach(QString entry, entries) {
-            QRegExp regExp(".+/" + entry + "(\\.svx)?$");
-            regExp.setCaseSensitivity(Qt::CaseInsensitive);
-            if(regExp.exactMatch(filename)) {
-                filename = entry;
-                break;
-            }
-        }
-
-        QString fixedUpFile = rootFileDir.path() + "/" + filename;
-        if(!QFileInfo(fixedUpFile).exists()) {
-            //Try to add the .svx extension
-            fixedUpFile += ".svx";
-        }
-        filename = fixedUpFile;
+    if(fileInfo.exists()) {
+        return filename;
     }
 
-    file.setFileName(filename);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        Errors.append(QString("Error: Couldn't open ") + filename);
-        return false;
-    }
+    //This maybe a relative path to the includedFrom
+    QFileInfo rootFileInfo(includedFrom);
+    QDir rootFileDir = rootFileInfo.absoluteDir().path();
 
-    //Make sure we don't reopen the same file twice
-    if(std::find(IncludeFiles.begin(), IncludeFiles.end(), filename) != IncludeFiles.end() && !IncludeFiles.empty()) {
-        //File has already been included... Do nothing
-        return false;
+    rootFileDir.setNameFilters(QStringList("*.svx"));
+    QStringList entries = rootFileDir.entryList();
+
+    auto endsWith = [&filename](const QString& ending) {
+        return filename.size() > ending.size() && filename.endsWith(ending, Qt::CaseInsensitive);
+    };
+
+    //Find the filename, this is needed because, filename case insensitive
+    foreach(QString entry, entries) {
+        if(endsWith("/" + entry) || endsWith("/" + entry + ".svx")) {
+            filename = entry;
+            break;
+        }
     }
 
-    QStringList::iterator iter = std::lower_bound(IncludeFiles.begin(), IncludeFiles.end(), filename);
-    IncludeFiles.insert(iter, filename);
-    return true;
+    QString fixedUpFile = rootFileDir.path() + "/" + filename;
+    if(!QFileInfo(fixedUpFile).exists()) {
+        //Try to add the .svx extension
+        fixedUpFile += ".svx";
+    }
+    return fixedUpFile;
 }
 
 /**
-  \brief Parses a survex line
+  \brief Parses the file that was lexed by lexFiles()
   */
-void cwSurvexImporter::parseLine(QString line) {
-    //Remove comments
-    line = removeComment(line);
-
-    //Skip empty lines
-    if(line.isEmpty()) { return; }
-
-    QRegExp exp("^\\s*\\*begin\\s*((?:\\w|-|_)*)");
-    exp.setCaseSensitivity(Qt::CaseInsensitive);
-    if(line.contains(exp)) {
-       // qDebug() << "Has begin" << line;
-        CurrentState = InsideBegin;
-        //BeginNames.append(exp.cap(1));
-
-        //Create a new block
-        cwTreeImportDataNode* newBlock = new cwTreeImportDataNode();
-        QString blockName = exp.cap(1).trimmed();
-        newBlock->setName(blockName);
-
-        //Add the block to the structure
-        CurrentBlock->addChildNode(newBlock);
-
-        //Copy the calibrations
-        *(newBlock->calibration()) = *(CurrentBlock->calibration());
-
-        //Make the newBlock the current block
-        CurrentBlock = newBlock;
-
-        //Copy the last state variables
-        BeginEndState lastState;
-        if(!BeginEndStateStack.isEmpty()) {
-            lastState = BeginEndStateStack.last();
-        }
-
-        BeginEndState currentState;
-        currentState.Filename = currentFile();
-        if(lastState.Filename == currentFile()) {
-            currentState = lastState;
-        }
-        BeginEndStateStack.append(currentState);
-
+void cwSurvexImporter::loadFile(QString filename) {
+    const SourceFile* source = SourceFiles.value(filename).data();
+    if(source == nullptr || !source->IsOpen) {
+        Errors.append(QString("Error: Couldn't open ") + filename);
         return;
     }
 
-    if(InsideBegin) {
-
-        //Parse command
-        exp = QRegExp("^\\s*\\*(\\w+)\\s*(.*)");
-        if(line.contains(exp)) {
-            QString command = exp.cap(1);
-            QString arg = exp.cap(2).trimmed();
+    //Make sure we don't reopen the same file twice
+    if(IncludeFiles.contains(filename)) {
+        //File has already been included... Do nothing
+        return;
+    }
+    IncludeFiles.insert(filename);
 
-            if(compare(command, "end")) {
+    //Add the file to the include stack
+    IncludeStack.append(Include(source));
 
-                //Update the LRUD before getting out of this block
-                updateLRUDForCurrentBlock();
+    //Update the status
+    emit statusMessage("Importing " + filename);
 
-                cwTreeImportDataNode* parentBlock = CurrentBlock->parentNode();
-                if(parentBlock != nullptr) {
-                    CurrentBlock = parentBlock;
-                }
+    const cwSurvexLexer& lexer = source->Lexer;
+    for(int i = 0; i < lexer.lineCount() && isRunning(); i++) {
+        cwSurvexLexer::Line line = lexer.line(i);
 
-                //Remove the current state valiable
-                if(BeginEndStateStack.size() > 1) {
-                    BeginEndStateStack.removeLast();
-                } else {
-                    addError("Too many *end");
-                }
+        //Empty lines aren't lexed, so use the line's number
+        IncludeStack.last().CurrentLine = line.number();
 
-            } else if(compare(command, "data")) {
-                parseDataFormat(line);
-            } else if(compare(command, "include")) {
-                loadFile(arg);
-            } else if(compare(command, "date")) {
-                parseDate(arg);
-            } else if(compare(command, "team")) {
-                parseTeamMember(arg);
-            } else if(compare(command, "calibrate")) {
-                parseCalibrate(arg);
-            } else if(compare(command, "units")) {
-                parseUnits(arg);
-            } else if(compare(command, "export")) {
-                parseExport(arg);
-            } else if(compare(command, "equate")) {
-                parseEquate(arg);
-            } else if(compare(command, "flags")) {
-                parseFlags(arg);
-            } else {
-                addWarning(QString("Unknown survex keyword:") + command);
-            }
+        //Get the line's data
+        parseLine(line);
+    }
 
-            if(CurrentBlock == RootBlock) {
-                CurrentState = FirstBegin;
-            }
+    CurrentTotalNumberOfLines += lexer.numberOfLines();
+    setProgress(CurrentTotalNumberOfLines);
 
-            return;
-        }
+    IncludeStack.removeLast();
+}
 
+/**
+  \brief Parses a survex line
+  */
+void cwSurvexImporter::parseLine(const cwSurvexLexer::Line& line) {
+    switch(cwSurvexLexer::directive(line)) {
+    case cwSurvexLexer::NoDirective:
         //Parse normal survey data
         switch(currentDataEntryType()) {
         case Normal:
@@ -354,10 +320,114 @@ void cwSurvexImporter::parseLine(QString line) {
             //Just ignore!
             break;
         }
+        return;
+    case cwSurvexLexer::BeginDirective:
+        parseBegin(line);
+        return;
+    case cwSurvexLexer::EndDirective:
+        parseEnd();
+        break;
+    case cwSurvexLexer::DataDirective:
+        parseDataFormat(line);
+        break;
+    case cwSurvexLexer::IncludeDirective:
+        parseInclude();
+        break;
+    case cwSurvexLexer::DateDirective:
+        parseDate(line);
+        break;
+    case cwSurvexLexer::TeamDirective:
+        parseTeamMember(line);
+        break;
+    case cwSurvexLexer::CalibrateDirective:
+        parseCalibrate(line);
+        break;
+    case cwSurvexLexer::UnitsDirective:
+        parseUnits(line);
+        break;
+    case cwSurvexLexer::ExportDirective:
+        parseExport(line);
+        break;
+    case cwSurvexLexer::EquateDirective:
+        parseEquate(line);
+        break;
+    case cwSurvexLexer::FlagsDirective:
+        parseFlags(line);
+        break;
+    case cwSurvexLexer::UnknownDirective:
+        addWarning(QString("Unknown survex keyword:") + line.at(0).mid(1).toString());
+        break;
+    }
+
+    if(CurrentBlock == RootBlock) {
+        CurrentState = FirstBegin;
+    }
+}
+
+/**
+  \brief Starts a new block
+
+  *begin blockName
+  */
+void cwSurvexImporter::parseBegin(const cwSurvexLexer::Line& line) {
+    CurrentState = InsideBegin;
+
+    //Create a new block
+    cwTreeImportDataNode* newBlock = new cwTreeImportDataNode();
+    QString blockName = line.size() > 1 ? line.at(1).toString() : QString();
+    newBlock->setName(blockName);
+
+    //Add the block to the structure
+    CurrentBlock->addChildNode(newBlock);
+
+    //Copy the calibrations
+    *(newBlock->calibration()) = *(CurrentBlock->calibration());
+
+    //Make the newBlock the current block
+    CurrentBlock = newBlock;
+
+    //Copy the last state variables
+    BeginEndState lastState;
+    if(!BeginEndStateStack.isEmpty()) {
+        lastState = BeginEndStateStack.last();
+    }
+
+    BeginEndState currentState;
+    currentState.Filename = currentFile();
+    if(lastState.Filename == currentFile()) {
+        currentState = lastState;
     }
+    BeginEndStateStack.append(currentState);
+}
 
+/**
+  \brief Ends the current block
+  */
+void cwSurvexImporter::parseEnd() {
+    //Update the LRUD before getting out of this block
+    updateLRUDForCurrentBlock();
+
+    cwTreeImportDataNode* parentBlock = CurrentBlock->parentNode();
+    if(parentBlock != nullptr) {
+        CurrentBlock = parentBlock;
+    }
+
+    //Remove the current state valiable
+    if(BeginEndStateStack.size() > 1) {
+        BeginEndStateStack.removeLast();
+    } else {
+        addError("Too many *end");
+    }
+}
 
-   // qDebug() << "Line: " << CurrentLine << " :" << line;
+/**
+  \brief Parses the next included file, it's filename was fixed up by lexFiles()
+  */
+void cwSurvexImporter::parseInclude() {
+    Include& current = IncludeStack.last();
+    QString filename = current.Source->Includes.value(current.NextInclude);
+    current.NextInclude++;
+    loadFile(filename);
 }
 
 /**
@@ -379,47 +449,51 @@ QString cwSurvexImporter::lastImport() {
     return filename.toString();
 }
 
-/**
-  \brief Remove comments from the line
-  */
-QString cwSurvexImporter::removeComment(QString& line) {
-    QString removeCommentLine;
-    removeCommentLine = line.trimmed();
-
-    int index = removeCommentLine.indexOf(';');
-    if(index >= 0) {
-        removeCommentLine = removeCommentLine.left(index);
-    }
-    return removeCommentLine;
-}
-
 /**
   \brief Tries to load the data formate
   */
-void cwSurvexImporter::parseDataFormat(QString line) {
-    //Remove *data from the line
-    QRegExp regExp("^\\s*\\*data\\s*(.*)");
-    regExp.setCaseSensitivity(Qt::CaseInsensitive);
-    if(line.contains(regExp)) {
-        line = regExp.cap(1);
-    }
-
-    QStringList dataFormatList = line.split(QRegExp("\\s+"), QString::SkipEmptyParts);
+void cwSurvexImporter::parseDataFormat(const cwSurvexLexer::Line& line) {
+    class FormatKeyword {
+    public:
+        const char* Name;
+        DataFormatType Type;
+    };
 
-    //Remove all empty data
-    dataFormatList.removeAll("");
+    static const FormatKeyword formatKeywords[] = {
+        {"to", To},
+        {"from", From},
+        {"tape", Distance},
+        {"length", Distance},
+        {"compass", Compass},
+        {"bearing", Compass},
+        {"backcompass", BackCompass},
+        {"clino", Clino},
+        {"gradient", Clino},
+        {"backclino", BackClino},
+        {"ignore", Ignore},
+        {"ignoreall", IgnoreAll},
+        {"station", Station},
+        {"left", Left},
+        {"right", Right},
+        {"up", Up},
+        {"down", Down}
+    };
 
-    if(dataFormatList.empty()) {
+    //The first token is *data
+    if(line.size() < 2) {
         addWarning("Data format is empty, using default format");
+        setCurrentDataEntryType(Normal);
+        setCurrentDataFormat(BeginEndState::defaultDataFormat());
+        return;
     }
 
-    QString dataFormatType = dataFormatList.front();
-    if(compare(dataFormatType, "normal")) {
+    const cwSurvexLexer::Token& dataFormatType = line.at(1);
+    if(dataFormatType.equals("normal")) {
         setCurrentDataEntryType(Normal);
-    } else if(compare(dataFormatType, "passage")) {
+    } else if(dataFormatType.equals("passage")) {
         setCurrentDataEntryType(Passage);
         nodeData(CurrentBlock)->addLRUDChunk();
-    } else if(compare(dataFormatType, "nosurvey")) {
+    } else if(dataFormatType.equals("nosurvey")) {
         setCurrentDataEntryType(NoSurvey);
     } else {
         addError("Normal, passage data, nosurvey are supported, using default format");
@@ -428,47 +502,23 @@ void cwSurvexImporter::parseDataFormat(QString line) {
     }
 
     QMap<DataFormatType, int> dataFormat;
-    dataFormat.clear();
-
-    for(int i = 1; i < dataFormatList.size(); i++) {
-        QString format = dataFormatList.at(i);
-
-        int index = i - 1;
-        //qDebug() << format << index;
-
-        if(compare(format, "to")) {
-            dataFormat[To] = index;
-        } else if(compare(format, "from")) {
-            dataFormat[From] = index;
-        } else if(compare(format, "tape") || compare(format, "length")) {
-            dataFormat[Distance] = index;
-        } else if(compare(format, "compass") || compare(format, "bearing")) {
-            dataFormat[Compass] = index;
-        } else if(compare(format, "backcompass")) {
-            dataFormat[BackCompass] = index;
-        } else if(compare(format, "clino") || compare(format, "gradient")) {
-            dataFormat[Clino] = index;
-        } else if(compare(format, "backclino")) {
-            dataFormat[BackClino] = index;
-        } else if(compare(format, "ignore")) {
-            dataFormat[Ignore] = index;
-        } else if(compare(format, "ignoreall")) {
-            dataFormat[IgnoreAll] = index;
-        } else if(compare(format, "station")) {
-            dataFormat[Station] = index;
-        } else if(compare(format, "left")) {
-            dataFormat[Left] = index;
-        } else if(compare(format, "right")) {
-            dataFormat[Right] = index;
-        } else if(compare(format, "up")) {
-            dataFormat[Up] = index;
-        } else if(compare(format, "down")) {
-            dataFormat[Down] = index;
-        } else {
-            addError(QString("Unknown *data keyword: ") + format + " Using default format");
+
+    for(int i = 2; i < line.size(); i++) {
+        const cwSurvexLexer::Token& format = line.at(i);
+        int index = i - 2;
+
+        auto keyword = std::find_if(std::begin(formatKeywords), std::end(formatKeywords),
+                                    [&format](const FormatKeyword& keyword) {
+            return format.equals(keyword.Name);
+        });
+
+        if(keyword == std::end(formatKeywords)) {
+            addError(QString("Unknown *data keyword: ") + format.toString() + " Using default format");
             dataFormat = BeginEndState::defaultDataFormat();
             break;
         }
+
+        dataFormat[keyword->Type] = index;
     }
 
     setCurrentDataFormat(dataFormat);
@@ -495,40 +545,37 @@ Helper to parseNormalData and parsePassageData
 
 This makes the line has enough elements for the current data format
 
-It will return all the data in the line.  If there's an error, the error is added to the error
-list and this returns empty data
+If there's an error, the error is added to the error list and this returns false
 
   */
-QStringList cwSurvexImporter::parseData(QString line) {
-    QStringList data = line.split(QRegExp("\\s+"), QString::SkipEmptyParts);
-    data.removeAll(""); //Remove all empty ones
-
-    QMap<DataFormatType, int> dataFormat = currentDataFormat();
+bool cwSurvexImporter::parseData(const cwSurvexLexer::Line& line) {
+    const QMap<DataFormatType, int> dataFormat = currentDataFormat();
 
     //Make sure the there's the same number of columns as needed
-    if(dataFormat.size() != data.size() && !dataFormat.contains(IgnoreAll)) {
+    if(dataFormat.size() != line.size() && !dataFormat.contains(IgnoreAll)) {
         addError("Can't extract data. To many or not enough data columns, skipping data");
-        return QStringList();
+        return false;
     }
 
     //Make sure there's enough columns
-    if(dataFormat.contains(IgnoreAll) && dataFormat[IgnoreAll] > data.size()) {
+    if(dataFormat.contains(IgnoreAll) && dataFormat[IgnoreAll] > line.size()) {
         addError("Can't extract data. Not enough data columns, skipping data");
-        return QStringList();
+        return false;
     }
 
-    return data;
+    return true;
 }
 
 /**
   \brief Imports a line of survey data
   */
-void cwSurvexImporter::parseNormalData(QString line) {
-    QStringList data = parseData(line);
-    if(data.isEmpty()) { return; } //Error, check the error messages
+void cwSurvexImporter::parseNormalData(const cwSurvexLexer::Line& line) {
+    if(!parseData(line)) { return; } //Error, check the error messages
+
+    const QMap<DataFormatType, int> dataFormat = currentDataFormat();
 
-    QString fromStationName = extractData(data, From);
-    QString toStationName= extractData(data, To);
+    QString fromStationName = extractData(line, dataFormat, From);
+    QString toStationName= extractData(line, dataFormat, To);
 
     //Make sure the to and from stations exist
     if(fromStationName.isEmpty() || toStationName.isEmpty()) {
@@ -541,27 +588,30 @@ void cwSurvexImporter::parseNormalData(QString line) {
     cwStation toStation(toStationName);
 
     cwShot shot;
-    shot.setDistance(extractData(data, Distance));
-    shot.setCompass(extractData(data, Compass));
-    shot.setBackCompass(extractData(data, BackCompass));
-    shot.setClino(extractData(data, Clino));
-    shot.setBackClino(extractData(data, BackClino));
+    shot.setDistance(extractData(line, dataFormat, Distance));
+    shot.setCompass(extractData(line, dataFormat, Compass));
+    shot.setBackCompass(extractData(line, dataFormat, BackCompass));
+    shot.setClino(extractData(line, dataFormat, Clino));
+    shot.setBackClino(extractData(line, dataFormat, BackClino));
     shot.setDistanceIncluded(CurrentBlock->isDistanceInclude());
 
     addShotToCurrentChunk(fromStation, toStation, shot);
 }
 
 /**
-  \brief Extracts the data from data with type
-  \param data - The line data
+  \brief Extracts the data from the line with type
+  \param line - The line data
+  \param dataFormat - The current data format
   \param type - The which piece of the line data that needs to be extracted
   */
-QString cwSurvexImporter::extractData(const QStringList data, DataFormatType type) {
-    QMap<DataFormatType, int> dataFormat = currentDataFormat();
-    if(dataFormat.contains(type)) {
-        int index = dataFormat[type];
-        if(index >= 0 && index < data.size()) {
-            return data[index];
+QString cwSurvexImporter::extractData(const cwSurvexLexer::Line& line,
+                                      const QMap<DataFormatType, int>& dataFormat,
+                                      DataFormatType type) const {
+    auto iter = dataFormat.constFind(type);
+    if(iter != dataFormat.constEnd()) {
+        int index = iter.value();
+        if(index >= 0 && index < line.size()) {
+            return line.at(index).toString();
         }
     }
     return QString();
@@ -639,11 +689,12 @@ void cwSurvexImporter::addCalibrationToCurrentChunk(cwTripCalibration *calibrati
   *data passage station left right up down
   a1 2.0 .3 2.1 4
   */
-void cwSurvexImporter::parsePassageData(QString line) {
-    QStringList data = parseData(line);
-    if(data.isEmpty()) { return; } //Error, check the error messages
+void cwSurvexImporter::parsePassageData(const cwSurvexLexer::Line& line) {
+    if(!parseData(line)) { return; } //Error, check the error messages
 
-    QString stationName = extractData(data, Station);
+    const QMap<DataFormatType, int> dataFormat = currentDataFormat();
+
+    QString stationName = extractData(line, dataFormat, Station);
 
     //Make sure the station exists
     if(stationName.isEmpty()) {
@@ -653,10 +704,10 @@ void cwSurvexImporter::parsePassageData(QString line) {
 
     //Create or find a station from the name
     cwStation station(stationName);
-    station.setLeft(extractData(data, Left));
-    station.setRight(extractData(data, Right));
-    station.setUp(extractData(data, Up));
-    station.setDown(extractData(data, Down));
+    station.setLeft(extractData(line, dataFormat, Left));
+    station.setRight(extractData(line, dataFormat, Right));
+    station.setUp(extractData(line, dataFormat, Up));
+    station.setDown(extractData(line, dataFormat, Down));
 
     //Add the station to the current LRUD chunk
     nodeData(CurrentBlock)->LRUDChunks.last().Stations.append(station);
@@ -737,19 +788,14 @@ int cwSurvexImporter::currentLineNumber() const {
     if(IncludeStack.isEmpty()) { return -1; }
     return IncludeStack.last().CurrentLine;
 }
-void cwSurvexImporter::increamentLineNumber() {
-    Q_ASSERT(!IncludeStack.isEmpty());
-    IncludeStack.last().CurrentLine++;
-    CurrentTotalNumberOfLines++; //All the lines combine
-}
 
 /**
   \brief Tries to extract the date from the date line
 
   If it can't this function return a date of 2000 01 01
   */
-void cwSurvexImporter::parseDate(QString dateString) {
-    QDate date = QDate::fromString(dateString, "yyyy.MM.dd");
+void cwSurvexImporter::parseDate(const cwSurvexLexer::Line& line) {
+    QDate date = QDate::fromString(line.span(1).toString(), "yyyy.MM.dd");
 
     if(!date.isValid()) {
         date = QDate(2000, 01, 01);
@@ -760,20 +806,12 @@ void cwSurvexImporter::parseDate(QString dateString) {
 
 /**
   \brief Extracts the team member from the survey line
+
+  *team "First Last" job1 job2
   */
-void cwSurvexImporter::parseTeamMember(QString line) {
-
-    QStringList jobAndNameList;
-
-    QRegExp splitReg("\"(\\w+\\s*)+\"|\\w+");
-    int pos = 0;
-    while ((pos = splitReg.indexIn(line, pos)) != -1) {
-        QString nameOrJob = line.mid(pos, splitReg.matchedLength());
-        nameOrJob = nameOrJob.remove('"');
-        nameOrJob = nameOrJob.trimmed();
-        jobAndNameList.append(nameOrJob);
-        pos += splitReg.matchedLength();
-    }
+void cwSurvexImporter::parseTeamMember(const cwSurvexLexer::Line& line) {
+
+    QStringList jobAndNameList = toStringList(line, 1);
 
     if(!jobAndNameList.isEmpty()) {
         cwTeam* currentTeam = CurrentBlock->team();
@@ -791,153 +829,158 @@ void cwSurvexImporter::parseTeamMember(QString line) {
 /**
   \brief This extracts the calibration data from the survex file
 
+  *calibrate type value [scale]
+
   This will set the TripCalibration object's data
   */
-void cwSurvexImporter::parseCalibrate(QString line) {
+void cwSurvexImporter::parseCalibrate(const cwSurvexLexer::Line& line) {
 
-    QRegExp reg("(TAPE|COMPASS|BACKCOMPASS|BACKCLINO|CLINO|COUNTER|DEPTH|DECLINATION|X|Y|Z)\\s+(\\S+)(?:\\s*(\\S+)\\s*)?");
-    reg.setCaseSensitivity(Qt::CaseInsensitive);
+    //The first token is *calibrate
+    if(line.size() < 3 || line.size() > 4) {
+        addError("Couldn't read calibration");
+        return;
+    }
 
-    if(reg.exactMatch(line)) {
-        QString type = reg.cap(1).toLower();
-        QString calibrationString = reg.cap(2);
-        QString scaling = reg.cap(3);
+    const cwSurvexLexer::Token& type = line.at(1);
+    QString calibrationString = line.at(2).toString();
+    QString scaling = line.size() > 3 ? line.at(3).toString() : QString();
 
-        //Parse the calibration value
-        bool okay;
-        double calibrationValue = calibrationString.toDouble(&okay);
+    //Parse the calibration value
+    bool okay;
+    double calibrationValue = calibrationString.toDouble(&okay);
+    if(!okay) {
+        addError("Calibration value isn't a number");
+        return;
+    }
+
+    float scaleValue = -1;
+    if(!scaling.isEmpty()) {
+        scaleValue = scaling.toFloat(&okay);
         if(!okay) {
-            addError("Calibration value isn't a number");
+            addError("Scaling value isn't a number");
             return;
         }
+    }
 
-        float scaleValue = -1;
-        if(!scaling.isEmpty()) {
-            scaleValue = scaling.toFloat(&okay);
-            if(!okay) {
-                addError("Scaling value isn't a number");
-                return;
-            }
-        }
-
-        //Flip the calibration value because survex is written by strange british people
-        calibrationValue = -calibrationValue;
-
-        //Create a new calibration
-        cwTripCalibration* calibration = new cwTripCalibration();
+    //Flip the calibration value because survex is written by strange british people
+    calibrationValue = -calibrationValue;
 
-        if(type == "tape") {
-            calibration->setTapeCalibration(calibrationValue);
+    //Create a new calibration
+    cwTripCalibration* calibration = new cwTripCalibration();
 
-        } else if (type == "compass") {
-            calibration->setFrontCompassCalibration(calibrationValue);
+    if(type.equals("tape")) {
+        calibration->setTapeCalibration(calibrationValue);
 
-        } else if (type == "backcompass") {
-            //Check to see if this is a correct compasss calibration
-            const float correctCalibrationThreshold = 45.0;
-            if(fmod(calibrationValue + 180.0, 360.0) < correctCalibrationThreshold) {
-                //This is probably a correct back compass
-                calibrationValue = fmod(calibrationValue + 180.0, 360.0);
-                calibration->setCorrectedCompassBacksight(true);
-            }
-            calibration->setBackCompassCalibration(calibrationValue);
-        } else if (type == "clino") {
-            calibration->setFrontClinoCalibration(calibrationValue);
+    } else if (type.equals("compass")) {
+        calibration->setFrontCompassCalibration(calibrationValue);
 
-        } else if (type == "backclino") {
-            if(scaleValue == -1.0f) {
-                calibration->setCorrectedClinoBacksight(true);
-            }
-            calibration->setBackClinoCalibration(calibrationValue);
+    } else if (type.equals("backcompass")) {
+        //Check to see if this is a correct compasss calibration
+        const float correctCalibrationThreshold = 45.0;
+        if(fmod(calibrationValue + 180.0, 360.0) < correctCalibrationThreshold) {
+            //This is probably a correct back compass
+            calibrationValue = fmod(calibrationValue + 180.0, 360.0);
+            calibration->setCorrectedCompassBacksight(true);
+        }
+        calibration->setBackCompassCalibration(calibrationValue);
+    } else if (type.equals("clino")) {
+        calibration->setFrontClinoCalibration(calibrationValue);
 
-        } else if (type == "declination") {
-            calibration->setDeclination(calibrationValue);
+    } else if (type.equals("backclino")) {
+        if(scaleValue == -1.0f) {
+            calibration->setCorrectedClinoBacksight(true);
+        }
+        calibration->setBackClinoCalibration(calibrationValue);
 
-        } else if (type == "counter") {
-            addWarning("cavewhere cannot handle 'COUNTER' calibration");
+    } else if (type.equals("declination")) {
+        calibration->setDeclination(calibrationValue);
 
-        } else if (type == "depth") {
-            addWarning("cavewhere cannot handle 'DEPTH' calibration");
+    } else if (type.equals("counter")) {
+        addWarning("cavewhere cannot handle 'COUNTER' calibration");
 
-        } else if (type == "x") {
-            addWarning("cavewhere cannot handle 'X' calibration");
+    } else if (type.equals("depth")) {
+        addWarning("cavewhere cannot handle 'DEPTH' calibration");
 
-        } else if (type == "y") {
-            addWarning("cavewhere cannot handle 'Y' calibration");
+    } else if (type.equals("x")) {
+        addWarning("cavewhere cannot handle 'X' calibration");
 
-        } else if (type == "z") {
-            addWarning("cavewhere cannot handle 'Z' calibration");
-        }
+    } else if (type.equals("y")) {
+        addWarning("cavewhere cannot handle 'Y' calibration");
 
-        addCalibrationToCurrentChunk(calibration);
+    } else if (type.equals("z")) {
+        addWarning("cavewhere cannot handle 'Z' calibration");
 
     } else {
+        delete calibration;
         addError("Couldn't read calibration");
+        return;
     }
+
+    addCalibrationToCurrentChunk(calibration);
 }
 
 /**
   This parses the units out of the survex importer
+
+  *units type unit
   */
-void cwSurvexImporter::parseUnits(QString line) {
-    QRegExp reg("(TAPE|LENGTH|COMPASS|BEARING|CLINO|GRADIENT|COUNTER|DEPTH|DECLINATION|X|Y|Z)\\s+(\\S+)\\s*");
-    reg.setCaseSensitivity(Qt::CaseInsensitive);
+void cwSurvexImporter::parseUnits(const cwSurvexLexer::Line& line) {
 
-    if(reg.exactMatch(line)) {
-        QString type = reg.cap(1).toLower();
-        QString unitString = reg.cap(2);
+    //The first token is *units
+    if(line.size() != 3) {
+        addError("Couldn't read units");
+        return;
+    }
 
-        //Get the current calibration
-        cwTripCalibration* calibration = CurrentBlock->calibration();
+    const cwSurvexLexer::Token& type = line.at(1);
+    QString unitString = line.at(2).toString();
 
-        if(type == "tape" || type == "length") {
-            cwUnits::LengthUnit unit = cwUnits::toLengthUnit(unitString);
+    //Get the current calibration
+    cwTripCalibration* calibration = CurrentBlock->calibration();
 
-            //Make sure the units are good
-            if(unit == cwUnits::LengthUnitless) {
-                addError(QString("Bad unit %1, good units are YARDS, FEET, METRIC, METRES, or METERS. Using meters instead.").arg(unitString));
-                calibration->setDistanceUnit(cwUnits::Meters);
-                return;
-            }
+    if(type.equals("tape") || type.equals("length")) {
+        cwUnits::LengthUnit unit = cwUnits::toLengthUnit(unitString);
 
-            calibration->setDistanceUnit(unit);
-        } else if(type == "compass") {
-           addWarning("cavewhere cannot handle 'compass' units");
-        } else if(type == "bearing") {
-           addWarning("cavewhere cannot handle 'bearing' units");
-        } else if(type == "clino") {
-           addWarning("cavewhere cannot handle 'clino' units");
-        } else if(type == "gradient") {
-            addWarning("cavewhere cannot handle 'gradient' units");
-        } else if(type == "counter") {
-            addWarning("cavewhere cannot handle 'counter' units");
-        } else if(type == "depth") {
-            addWarning("cavewhere cannot handle 'depth' units");
-        } else if(type == "declination") {
-            addWarning("cavewhere cannot handle 'declination' units");
-        } else if(type == "x") {
-            addWarning("cavewhere cannot handle 'x' units");
-        } else if(type == "y") {
-            addWarning("cavewhere cannot handle 'y' units");
-        } else if(type == "z") {
-            addWarning("cavewhere cannot handle 'z' units");
+        //Make sure the units are good
+        if(unit == cwUnits::LengthUnitless) {
+            addError(QString("Bad unit %1, good units are YARDS, FEET, METRIC, METRES, or METERS. Using meters instead.").arg(unitString));
+            calibration->setDistanceUnit(cwUnits::Meters);
+            return;
         }
 
-
+        calibration->setDistanceUnit(unit);
+    } else if(type.equals("compass")) {
+       addWarning("cavewhere cannot handle 'compass' units");
+    } else if(type.equals("bearing")) {
+       addWarning("cavewhere cannot handle 'bearing' units");
+    } else if(type.equals("clino")) {
+       addWarning("cavewhere cannot handle 'clino' units");
+    } else if(type.equals("gradient")) {
+        addWarning("cavewhere cannot handle 'gradient' units");
+    } else if(type.equals("counter")) {
+        addWarning("cavewhere cannot handle 'counter' units");
+    } else if(type.equals("depth")) {
+        addWarning("cavewhere cannot handle 'depth' units");
+    } else if(type.equals("declination")) {
+        addWarning("cavewhere cannot handle 'declination' units");
+    } else if(type.equals("x")) {
+        addWarning("cavewhere cannot handle 'x' units");
+    } else if(type.equals("y")) {
+        addWarning("cavewhere cannot handle 'y' units");
+    } else if(type.equals("z")) {
+        addWarning("cavewhere cannot handle 'z' units");
     } else {
         addError("Couldn't read units");
     }
-
 }
 
 /**
  * @brief cwSurvexImporter::parseEquate
  * @param line - The line of all the station's that are equal
  */
-void cwSurvexImporter::parseEquate(QString line)
+void cwSurvexImporter::parseEquate(const cwSurvexLexer::Line& line)
 {
-    QRegExp splitRegex("\\s+");
-    QStringList equalStations = line.split(splitRegex);
+    QStringList equalStations = toStringList(line, 1);
 
     if(equalStations.size() <= 1) {
         Errors.append(QString("Error: *equate on %1 has only one station").arg(currentLineNumber()));
@@ -953,9 +996,9 @@ void cwSurvexImporter::parseEquate(QString line)
  *
  * This parses the export stations
  */
-void cwSurvexImporter::parseExport(QString line)
+void cwSurvexImporter::parseExport(const cwSurvexLexer::Line& line)
 {
-    QStringList stations = line.split(QRegExp("\\s+"));
+    QStringList stations = toStringList(line, 1);
     nodeData(CurrentBlock)->addExportStations(stations);
 }
 
@@ -967,74 +1010,47 @@ void cwSurvexImporter::parseExport(QString line)
  *
  * Currently, surface isn't support.
  */
-void cwSurvexImporter::parseFlags(QString line)
+void cwSurvexImporter::parseFlags(const cwSurvexLexer::Line& line)
 {
-    QStringList flags = line.split(QRegExp("\\s+"));
-
     bool flagOperator = true;
     bool excludeLength = false;
-    foreach(QString flag, flags) {
-        if(flag.compare("duplicate", Qt::CaseInsensitive) == 0) {
+    for(int i = 1; i < line.size(); i++) {
+        const cwSurvexLexer::Token& flag = line.at(i);
+        if(flag.equals("duplicate")) {
             excludeLength = flagOperator;
             flagOperator = true;
 
             //Flip, becuause we're including
             CurrentBlock->setIncludeDistance(!excludeLength);
-        } else if(flag.compare("splay", Qt::CaseInsensitive) == 0) {
+        } else if(flag.equals("splay")) {
             excludeLength = flagOperator;
             flagOperator = true;
 
             //Flip, becuause we're including
             CurrentBlock->setIncludeDistance(!excludeLength);
-        } else if(flag.compare("surface", Qt::CaseInsensitive) == 0) {
+        } else if(flag.equals("surface")) {
             Errors.append(QString("Warning: *flags surface isn't support at this time, excluding shot lengths"));
             excludeLength = flagOperator;
             flagOperator = true;
 
             //Flip, becuause we're including
             CurrentBlock->setIncludeDistance(!excludeLength);
-        } else if(flag.compare("not", Qt::CaseInsensitive) == 0) {
+        } else if(flag.equals("not")) {
             flagOperator = false;
         }
     }
 }
 
 /**
-  \brief Runs the stats on the survex files
-
-  This will go through all the survex file and
+  \brief Returns the line's tokens, starting at first, as strings
   */
-void cwSurvexImporter::runStats(QString filename) {
-    emit statusMessage("Gathering sauce for " + filename);
-
-    QFile file;
-    bool canOpenFile = openFile(file, filename);
-
-    if(!canOpenFile) { return; } //Can't open the file
-
-    //Add the file to the include stack
-    IncludeStack.append(Include(file.fileName()));
-
-    QRegExp exp;
-    while(!file.atEnd() && isRunning()) {
-        QString line = file.readLine();
-
-        //Find the include files
-        exp = QRegExp("^\\s*\\*(\\w+)\\s*(.*)");
-        if(line.contains(exp)) {
-            QString command = exp.cap(1);
-            QString args = exp.cap(2).trimmed();
-
-            if(compare(command, "include")) {
-                runStats(args);
-            }
-        }
-
-        //Add all the lines up
-        TotalNumberOfLines++;
+QStringList cwSurvexImporter::toStringList(const cwSurvexLexer::Line& line, int first) {
+    QStringList strings;
+    strings.reserve(qMax(0, line.size() - first));
+    for(int i = first; i < line.size(); i++) {
+        strings.append(line.at(i).toString());
     }
-
-    IncludeStack.removeLast();
+    return strings;
 }
 
 /**
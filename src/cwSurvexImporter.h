@@ -14,12 +14,15 @@
 #include <QList>
 #include <QStringList>
 #include <QMap>
+#include <QHash>
+#include <QSet>
+#include <QSharedPointer>
 #include "cwTreeDataImporter.h"
-#include <QFile>
 
 //Our includes
 #include "cwStation.h"
 #include "cwSurvexGlobalData.h"
+#include "cwSurvexLexer.h"
 #include "cwGlobals.h"
 class cwSurveyChunk;
 class cwShot;
@@ -79,16 +82,31 @@ private:
         NoSurvey
     };
 
+    /**
+      A survex file that's been lexed, and the files that it includes
+      */
+    class SourceFile {
+    public:
+        QString Filename;
+        bool IsOpen = false;
+        cwSurvexLexer Lexer;
+        QStringList Includes; //The fixed up filename of each *include, in order
+    };
+
     class Include {
     public:
-        Include(QString file) :
-            File(file),
-            CurrentLine(0)
+        Include(const SourceFile* source) :
+            File(source->Filename),
+            Source(source),
+            CurrentLine(0),
+            NextInclude(0)
         {
         }
 
         QString File;
+        const SourceFile* Source;
         int CurrentLine;
+        int NextInclude; //Index into Source->Includes
     };
 
     class BeginEndState {
@@ -109,7 +127,10 @@ private:
     QList<Include> IncludeStack;
 
     //Already included files
-    QStringList IncludeFiles;
+    QSet<QString> IncludeFiles;
+
+    //All the files that have been lexed, by filename
+    QHash<QString, QSharedPointer<SourceFile>> SourceFiles;
 
     //Handles block state
     QList<BeginEndState> BeginEndStateStack;
@@ -137,28 +158,28 @@ private:
 
     void clear();
 
+    void lexFiles(QString filename);
+    static void lexFile(SourceFile* source);
+    static QString fixUpFilename(QString includedFrom, QString filename);
+
     void loadFile(QString filename);
-    bool openFile(QFile& file, QString filename);
-    void parseLine(QString line);
+    void parseLine(const cwSurvexLexer::Line& line);
     void saveLastImport(QString filename);
 
-    //Parser helper
-    QString removeComment(QString& line);
-
     //Parsing the data format
-    void parseDataFormat(QString line);
+    void parseDataFormat(const cwSurvexLexer::Line& line);
 
     //Helper to parseNormalData and parsePassageData
-    QStringList parseData(QString line);
+    bool parseData(const cwSurvexLexer::Line& line);
 
-    void parseNormalData(QString line);
-    QString extractData(const QStringList data, DataFormatType type);
+    void parseNormalData(const cwSurvexLexer::Line& line);
+    QString extractData(const cwSurvexLexer::Line& line, const QMap<DataFormatType, int>& dataFormat, DataFormatType type) const;
     void addShotToCurrentChunk(cwStation fromStation,
                                cwStation toStation,
                                cwShot shot);
     void addCalibrationToCurrentChunk(cwTripCalibration* calibration);
 
-    void parsePassageData(QString line);
+    void parsePassageData(const cwSurvexLexer::Line& line);
 
     //Error Messages
     void addError(QString error);
@@ -174,19 +195,19 @@ private:
 
     QString currentFile() const;
     int currentLineNumber() const;
-    void increamentLineNumber();
 
-    bool compare(QString s1, QString s2) const;
+    void parseBegin(const cwSurvexLexer::Line& line);
+    void parseEnd();
+    void parseInclude();
+    void parseDate(const cwSurvexLexer::Line& line);
+    void parseTeamMember(const cwSurvexLexer::Line& line);
+    void parseCalibrate(const cwSurvexLexer::Line& line);
+    void parseUnits(const cwSurvexLexer::Line& line);
+    void parseEquate(const cwSurvexLexer::Line& line);
+    void parseExport(const cwSurvexLexer::Line& line);
+    void parseFlags(const cwSurvexLexer::Line& line);
 
-    void parseDate(QString args);
-    void parseTeamMember(QString line);
-    void parseCalibrate(QString line);
-    void parseUnits(QString line);
-    void parseEquate(QString line);
-    void parseExport(QString line);
-    void parseFlags(QString line);
-
-    void runStats(QString filename);
+    static QStringList toStringList(const cwSurvexLexer::Line& line, int first);
 
     void updateLRUDForCurrentBlock();
     void updateStationLRUD(cwStation before, cwStation station, cwStation after);
@@ -199,13 +220,6 @@ inline cwTreeImportData* cwSurvexImporter::data() {
     return static_cast<cwTreeImportData*>(GlobalData);
 }
 
-/**
-  \brief compares the to strings with case insensitive
-  */
-inline bool cwSurvexImporter::compare(QString s1, QString s2) const {
-    return s1.compare(s2, Qt::CaseInsensitive) == 0;
-}
-
 /**
   \brief Sets the root file for the survex
   */
@@ -0,0 +1,204 @@
+//Our includes
+#include "cwSurvexLexer.h"
+
+//Std includes
+#include <cstring>
+
+namespace {
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+}
+
+cwSurvexLexer::cwSurvexLexer()
+{
+}
+
+/**
+ * Returns true if the token is text, ignoring the case. Text should be ASCII
+ */
+bool cwSurvexLexer::Token::equals(const char *text) const
+{
+    return static_cast<int>(std::strlen(text)) == Size
+            && qstrnicmp(Data, text, static_cast<uint>(Size)) == 0;
+}
+
+/**
+ * Returns the token without the first position bytes
+ */
+cwSurvexLexer::Token cwSurvexLexer::Token::mid(int position) const
+{
+    position = qBound(0, position, Size);
+    return Token(Data + position, Size - position, Quoted);
+}
+
+/**
+ * Converts the token from UTF-8. This is the only place that allocates
+ */
+QString cwSurvexLexer::Token::toString() const
+{
+    return QString::fromUtf8(Data, Size);
+}
+
+/**
+ * Returns the text from the first token to the end of the line, without the comment
+ */
+cwSurvexLexer::Token cwSurvexLexer::Line::span(int first) const
+{
+    if(first >= Size) {
+        return Token();
+    }
+
+    const Token& last = Tokens[Size - 1];
+    const char* begin = Tokens[first].data();
+    return Token(begin, static_cast<int>(last.data() + last.size() - begin), first == Size - 1 && last.isQuoted());
+}
+
+/**
+ * Memory maps filename and lexes it. Returns false if the file couldn't be opened.
+ *
+ * If the file can't be mapped, for example a compressed resource, it's read instead.
+ */
+bool cwSurvexLexer::open(const QString &filename)
+{
+    File.close();
+    File.setFileName(filename);
+    Buffer.clear();
+    ErrorString.clear();
+
+    if(!File.open(QIODevice::ReadOnly)) {
+        ErrorString = File.errorString();
+        lex(nullptr, 0);
+        return false;
+    }
+
+    const qint64 fileSize = File.size();
+    const uchar* mapped = fileSize > 0 ? File.map(0, fileSize) : nullptr;
+    if(mapped != nullptr) {
+        lex(reinterpret_cast<const char*>(mapped), fileSize);
+    } else {
+        Buffer = File.readAll();
+        lex(Buffer.constData(), Buffer.size());
+    }
+    return true;
+}
+
+/**
+ * Lexes data, the lexer keeps a reference to data
+ */
+void cwSurvexLexer::lex(const QByteArray &data)
+{
+    File.close();
+    Buffer = data;
+    lex(Buffer.constData(), Buffer.size());
+}
+
+/**
+ * Returns the line's directive, from the keyword table
+ */
+cwSurvexLexer::Directive cwSurvexLexer::directive(const cwSurvexLexer::Line &line)
+{
+    class Keyword {
+    public:
+        const char* Name;
+        Directive Value;
+    };
+
+    static const Keyword keywords[] = {
+        {"begin", BeginDirective},
+        {"end", EndDirective},
+        {"data", DataDirective},
+        {"include", IncludeDirective},
+        {"date", DateDirective},
+        {"team", TeamDirective},
+        {"calibrate", CalibrateDirective},
+        {"units", UnitsDirective},
+        {"export", ExportDirective},
+        {"equate", EquateDirective},
+        {"flags", FlagsDirective}
+    };
+
+    if(line.size() == 0) {
+        return NoDirective;
+    }
+
+    const Token& first = line.at(0);
+    if(first.isQuoted() || first.size() < 2 || first.data()[0] != '*') {
+        return NoDirective;
+    }
+
+    const Token command = first.mid(1);
+    for(const Keyword& keyword : keywords) {
+        if(command.equals(keyword.Name)) {
+            return keyword.Value;
+        }
+    }
+
+    return UnknownDirective;
+}
+
+void cwSurvexLexer::lex(const char *data, qint64 size)
+{
+    Tokens.clear();
+    Lines.clear();
+    NumberOfLines = 0;
+    Size = size;
+
+    if(data == nullptr) {
+        return;
+    }
+
+    const char* current = data;
+    const char* end = data + size;
+
+    //Skip the UTF-8 byte order mark
+    if(size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0) {
+        current += 3;
+    }
+
+    //A guess, so the vectors don't grow too often
+    Tokens.reserve(static_cast<int>(size / 6));
+    Lines.reserve(static_cast<int>(size / 30));
+
+    while(current < end) {
+        NumberOfLines++;
+        const int firstToken = Tokens.size();
+
+        while(current < end && *current != '\n') {
+            const char c = *current;
+            if(isSpace(c)) {
+                current++;
+            } else if(c == ';') {
+                //Comment, skip the rest of the line
+                const void* newLine = std::memchr(current, '\n', static_cast<size_t>(end - current));
+                current = newLine != nullptr ? static_cast<const char*>(newLine) : end;
+            } else if(c == '"') {
+                const char* begin = ++current;
+                while(current < end && *current != '"' && *current != '\n') {
+                    current++;
+                }
+                Tokens.append(Token(begin, static_cast<int>(current - begin), true));
+                if(current < end && *current == '"') {
+                    current++;
+                }
+            } else {
+                const char* begin = current;
+                while(current < end && !isSpace(*current) && *current != '\n' && *current != ';') {
+                    current++;
+                }
+                Tokens.append(Token(begin, static_cast<int>(current - begin)));
+            }
+        }
+
+        if(Tokens.size() > firstToken) {
+            Lines.append({firstToken, Tokens.size() - firstToken, NumberOfLines});
+        }
+
+        //Skip the new line
+        if(current < end) {
+            current++;
+        }
+    }
+}
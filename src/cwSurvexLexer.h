@@ -0,0 +1,172 @@
+#ifndef CWSURVEXLEXER_H
+#define CWSURVEXLEXER_H
+
+//Our includes
+#include "cwGlobals.h"
+
+//Qt includes
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief The cwSurvexLexer class splits a survex file into lines of tokens
+ *
+ * The file is memory mapped, and the tokens are views into the file's UTF-8 bytes, so
+ * lexing doesn't allocate anything for each token. All the tokens are stored in one
+ * vector. Empty lines and comments are skipped, but each line keeps it's line number for
+ * error messages.
+ *
+ * Tokens are split by whitespace. A token that starts with a quote runs to the next
+ * quote, and the quotes aren't part of the token. Everything after a ';' is a comment.
+ *
+ * The tokens are only valid while the lexer is alive, and the lexer can't be copied.
+ */
+class CAVEWHERE_LIB_EXPORT cwSurvexLexer
+{
+public:
+    /**
+     * A survex command, the first token of a line, that starts with a '*'
+     */
+    enum Directive {
+        NoDirective, //The line is data
+        UnknownDirective,
+        BeginDirective,
+        EndDirective,
+        DataDirective,
+        IncludeDirective,
+        DateDirective,
+        TeamDirective,
+        CalibrateDirective,
+        UnitsDirective,
+        ExportDirective,
+        EquateDirective,
+        FlagsDirective
+    };
+
+    class Token {
+    public:
+        Token() {}
+        Token(const char* data, int size, bool quoted = false) :
+            Data(data),
+            Size(size),
+            Quoted(quoted)
+        {}
+
+        const char* data() const { return Data; }
+        int size() const { return Size; }
+        bool isEmpty() const { return Size == 0; }
+        bool isQuoted() const { return Quoted; }
+
+        bool equals(const char* text) const;
+        Token mid(int position) const;
+        QString toString() const;
+
+    private:
+        const char* Data = nullptr;
+        int Size = 0;
+        bool Quoted = false;
+    };
+
+    class Line {
+    public:
+        Line(const Token* tokens, int size, int number) :
+            Tokens(tokens),
+            Size(size),
+            Number(number)
+        {}
+
+        int number() const { return Number; }
+        int size() const { return Size; }
+        const Token& at(int index) const { return Tokens[index]; }
+        const Token* begin() const { return Tokens; }
+        const Token* end() const { return Tokens + Size; }
+
+        Token span(int first) const;
+
+    private:
+        const Token* Tokens;
+        int Size;
+        int Number;
+    };
+
+    cwSurvexLexer();
+
+    bool open(const QString& filename);
+    void lex(const QByteArray& data);
+
+    QString errorString() const;
+
+    int lineCount() const;
+    Line line(int index) const;
+
+    int numberOfLines() const;
+    qint64 size() const;
+
+    static Directive directive(const Line& line);
+
+private:
+    Q_DISABLE_COPY(cwSurvexLexer)
+
+    class LineRange {
+    public:
+        int FirstToken;
+        int Size;
+        int Number;
+    };
+
+    QFile File; //Kept open for the memory map
+    QByteArray Buffer; //The data if the file couldn't be mapped
+    QString ErrorString;
+
+    QVector<Token> Tokens;
+    QVector<LineRange> Lines;
+    int NumberOfLines = 0;
+    qint64 Size = 0;
+
+    void lex(const char* data, qint64 size);
+};
+
+/**
+ * Returns the number of lines that have tokens
+ */
+inline int cwSurvexLexer::lineCount() const
+{
+    return Lines.size();
+}
+
+/**
+ * Returns the line at index. The index isn't the line number, empty lines are skipped
+ */
+inline cwSurvexLexer::Line cwSurvexLexer::line(int index) const
+{
+    const LineRange& range = Lines.at(index);
+    return Line(Tokens.constData() + range.FirstToken, range.Size, range.Number);
+}
+
+/**
+ * Returns the number of lines in the file, including empty lines and comments
+ */
+inline int cwSurvexLexer::numberOfLines() const
+{
+    return NumberOfLines;
+}
+
+/**
+ * Returns the number of bytes that were lexed
+ */
+inline qint64 cwSurvexLexer::size() const
+{
+    return Size;
+}
+
+/**
+ * Returns why open() failed
+ */
+inline QString cwSurvexLexer::errorString() const
+{
+    return ErrorString;
+}
+
+#endif // CWSURVEXLEXER_H
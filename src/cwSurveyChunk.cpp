@@ -34,13 +34,6 @@ cwSurveyChunk::cwSurveyChunk(QObject * parent) :
     ErrorModel(new cwErrorModel(this)),
     ParentTrip(nullptr)
 {
-
-    //Handle updating chunk calibration indexing when stations are added
-    connect(this, &cwSurveyChunk::shotsAdded, this, &cwSurveyChunk::updateCalibrationsNewShots);
-
-    //Handle updating chunk calibration indexing when stations are removde
-    connect(this, &cwSurveyChunk::shotsRemoved, this, &cwSurveyChunk::updateCalibrationsRemoveShots);
-
 }
 
 /**
@@ -54,11 +47,8 @@ cwSurveyChunk::cwSurveyChunk(const cwSurveyChunk& chunk) :
     ParentTrip(nullptr)
 {
 
-    //Copy all the stations
-    Stations = chunk.Stations;
-
-    //Copy all the shots
-    Shots = chunk.Shots;
+    //Copy all the stations and shots, the columns are implicitly shared
+    SurveyData = chunk.SurveyData;
 
     //Copy all the Calibration
     for(auto iter = chunk.Calibrations.begin(); iter != chunk.Calibrations.end(); iter++) {
@@ -75,7 +65,7 @@ cwSurveyChunk::~cwSurveyChunk()
   \brief Checks if the survey Chunk is valid
   */
 bool cwSurveyChunk::isValid() const {
-    return (Stations.size() - 1) == Shots.size() && !Stations.empty() && !Shots.empty();
+    return (SurveyData.stationCount() - 1) == SurveyData.shotCount() && SurveyData.stationCount() > 0 && SurveyData.shotCount() > 0;
 }
 
 /**
@@ -176,7 +166,7 @@ cwTripCalibration *cwSurveyChunk::lastCalibration() const
  * @return Returns the number of stations in the survey chunk
  */
 int cwSurveyChunk::stationCount() const {
-    return Stations.count();
+    return SurveyData.stationCount();
 }
 
 /**
@@ -242,18 +232,18 @@ void cwSurveyChunk::setParentTrip(cwTrip* trip) {
 
 cwStation cwSurveyChunk::station(int index) const {
     if(stationIndexCheck(index)) {
-        return Stations[index];
+        return SurveyData.station(index);
     }
     return cwStation();
 }
 
 int cwSurveyChunk::shotCount() const {
-    return Shots.size();
+    return SurveyData.shotCount();
 }
 
 cwShot cwSurveyChunk::shot(int index) const {
     if(shotIndexCheck(index)) {
-        return Shots[index];
+        return SurveyData.shot(index);
     }
     return cwShot();
 }
@@ -266,29 +256,30 @@ cwShot cwSurveyChunk::shot(int index) const {
   */
 void cwSurveyChunk::appendNewShot() {
     //Check for special case
-    if(!isValid() && Stations.size() <= 2 && Shots.size() <= 1) {
+    if(!isValid() && SurveyData.stationCount() <= 2 && SurveyData.shotCount() <= 1) {
         //Make valid
-        for(int i = Stations.size(); i < 2; i++) {
-            Stations.append(cwStation());
+        for(int i = SurveyData.stationCount(); i < 2; i++) {
+            SurveyData.appendStation(cwStation());
             emit stationsAdded(i, i);
         }
 
-        if(Shots.size() != 1) {
-            Shots.append(cwShot());
+        if(SurveyData.shotCount() != 1) {
+            SurveyData.appendShot(cwShot());
+            updateCalibrationsNewShots(0, 0);
             emit shotsAdded(0, 0);
         }
 
-        checkForStationError(Stations.size() - 2);
-        checkForStationError(Stations.size() - 1);
-        checkForShotError(Shots.size() - 1);
+        checkForStationError(SurveyData.stationCount() - 2);
+        checkForStationError(SurveyData.stationCount() - 1);
+        checkForShotError(SurveyData.shotCount() - 1);
 
         return;
     }
 
 
     cwStation fromStation;
-    if(!Stations.isEmpty()) {
-        fromStation = Stations.last();
+    if(SurveyData.stationCount() > 0) {
+        fromStation = SurveyData.station(SurveyData.stationCount() - 1);
         if(!fromStation.isValid()) {
             return;
         }
@@ -315,22 +306,23 @@ void cwSurveyChunk::appendShot(cwStation fromStation, cwStation toStation, cwSho
     if(!canAddShot(fromStation, toStation)) { return; }
 
     int index;
-    int firstIndex = Stations.size();
-    if(Stations.empty()) {
-        Stations.append(fromStation);
-        checkForStationError(Stations.size() - 1);
+    int firstIndex = SurveyData.stationCount();
+    if(SurveyData.stationCount() == 0) {
+        SurveyData.appendStation(fromStation);
+        checkForStationError(SurveyData.stationCount() - 1);
     }
 
-    index = Shots.size();
-    Shots.append(shot);
+    index = SurveyData.shotCount();
+    SurveyData.appendShot(shot);
+    updateCalibrationsNewShots(index, index);
     emit shotsAdded(index, index);
 
-    index = Stations.size();
-    Stations.append(toStation);
+    index = SurveyData.stationCount();
+    SurveyData.appendStation(toStation);
     emit stationsAdded(firstIndex, index);
 
-    checkForStationError(Stations.size() - 1);
-    checkForShotError(Shots.size() - 1);
+    checkForStationError(SurveyData.stationCount() - 1);
+    checkForShotError(SurveyData.shotCount() - 1);
 }
 
 /**
@@ -342,36 +334,36 @@ void cwSurveyChunk::appendShot(cwStation fromStation, cwStation toStation, cwSho
   This will create a new chunk, that the caller is responsible for deleting
   */
 cwSurveyChunk* cwSurveyChunk::splitAtStation(int stationIndex) {
-    if(stationIndex < 1 || stationIndex >= Stations.size()) { return nullptr; }
+    if(stationIndex < 1 || stationIndex >= SurveyData.stationCount()) { return nullptr; }
 
     cwSurveyChunk* newChunk = new cwSurveyChunk(this);
-    newChunk->Stations.append(cwStation()); //Add an empty station to the front
+    newChunk->SurveyData.reserve(SurveyData.stationCount() - stationIndex + 1);
+    newChunk->SurveyData.appendStation(cwStation()); //Add an empty station to the front
 
     //Copy the points from one chunk to another
-    for(int i = stationIndex; i < Stations.size(); i++) {
+    for(int i = stationIndex; i < SurveyData.stationCount(); i++) {
 
         //Get the current stations and shots
-        cwStation station = Stations[i];
+        cwStation station = SurveyData.station(i);
         cwShot currentShot = shot(i - 1);
 
-        newChunk->Stations.append(station);
+        newChunk->SurveyData.appendStation(station);
         if(currentShot.isValid()) {
-            newChunk->Shots.append(currentShot);
+            newChunk->SurveyData.appendShot(currentShot);
         }
     }
 
-    int stationEnd = Stations.size() - 1;
-    int shotEnd = Shots.size() - 1;
+    int stationEnd = SurveyData.stationCount() - 1;
+    int shotEnd = SurveyData.shotCount() - 1;
 
 
     //Remove the stations and shots from the list
     int shotIndex = stationIndex - 1;
-    QList<cwStation>::iterator stationIter = Stations.begin() + stationIndex;
-    QList<cwShot>::iterator shotIter = Shots.begin() + shotIndex;
-    Stations.erase(stationIter, Stations.end());
-    Shots.erase(shotIter, Shots.end());
+    SurveyData.removeStations(stationIndex, SurveyData.stationCount() - stationIndex);
+    SurveyData.removeShots(shotIndex, SurveyData.shotCount() - shotIndex);
 
     emit stationsRemoved(stationIndex, stationEnd);
+    updateCalibrationsRemoveShots(shotIndex, shotEnd);
     emit shotsRemoved(shotIndex, shotEnd);
 
     //Check for errors
@@ -396,8 +388,8 @@ cwSurveyChunk* cwSurveyChunk::splitAtStation(int stationIndex) {
 
   */
 void cwSurveyChunk::insertStation(int stationIndex, Direction direction) {
-    if(Stations.empty()) { appendNewShot(); return; }
-    if(stationIndex < 0 || stationIndex >= Stations.size()) { return; }
+    if(SurveyData.stationCount() == 0) { appendNewShot(); return; }
+    if(stationIndex < 0 || stationIndex >= SurveyData.stationCount()) { return; }
 
     int shotIndex = stationIndex;
 
@@ -407,10 +399,11 @@ void cwSurveyChunk::insertStation(int stationIndex, Direction direction) {
 
     cwStation station;
 
-    Stations.insert(stationIndex, station);
-    Shots.insert(shotIndex, cwShot());
+    SurveyData.insertStation(stationIndex, station);
+    SurveyData.insertShot(shotIndex, cwShot());
 
     emit stationsAdded(stationIndex, stationIndex);
+    updateCalibrationsNewShots(shotIndex, shotIndex);
     emit shotsAdded(shotIndex, shotIndex);
 
     updateErrors();
@@ -423,8 +416,8 @@ void cwSurveyChunk::insertStation(int stationIndex, Direction direction) {
   at index + 1.  A station will also be added as well
   */
 void cwSurveyChunk::insertShot(int shotIndex, Direction direction) {
-    if(Stations.empty()) { appendNewShot(); return; }
-    if(shotIndex < 0 || shotIndex >= Stations.size()) { return; }
+    if(SurveyData.stationCount() == 0) { appendNewShot(); return; }
+    if(shotIndex < 0 || shotIndex >= SurveyData.stationCount()) { return; }
 
     int stationIndex = shotIndex + 1;
 
@@ -434,10 +427,11 @@ void cwSurveyChunk::insertShot(int shotIndex, Direction direction) {
 
     cwStation station;
 
-    Stations.insert(stationIndex, station);
+    SurveyData.insertStation(stationIndex, station);
     emit stationsAdded(stationIndex, stationIndex);
 
-    Shots.insert(shotIndex, cwShot());
+    SurveyData.insertShot(shotIndex, cwShot());
+    updateCalibrationsNewShots(shotIndex, shotIndex);
     emit shotsAdded(shotIndex, shotIndex);
 
     updateErrors();
@@ -451,7 +445,8 @@ void cwSurveyChunk::insertShot(int shotIndex, Direction direction) {
   */
 bool cwSurveyChunk::canAddShot(const cwStation& fromStation, const cwStation& toStation) {
     Q_UNUSED(toStation);
-    return Stations.empty() || Stations.last().name().compare(fromStation.name(), Qt::CaseInsensitive) == 0;
+    return SurveyData.stationCount() == 0
+            || SurveyData.stationNames().last().compare(fromStation.name(), Qt::CaseInsensitive) == 0;
 }
 
 ///**
@@ -603,27 +598,29 @@ bool cwSurveyChunk::isShotRole(cwSurveyChunk::DataRole role) const {
     this function will return an empty string.
   */
 QString cwSurveyChunk::guessLastStationName() const {
+    const QVector<QString>& names = SurveyData.stationNames();
+
     //Need a least two stations for this to work.
-    if(stations().size() < 2) {
+    if(names.size() < 2) {
         return QString();
     }
 
-    if(stations().last().name().isEmpty()) {
+    if(names.last().isEmpty()) {
         QString stationName;
 
-        if(stations().size() == 2) {
+        if(names.size() == 2) {
             //Try to get the station name from the previous chunk
             QList<cwSurveyChunk*> chunks = parentTrip()->chunks();
             int index = chunks.indexOf(const_cast<cwSurveyChunk*>(this)) - 1;
             cwSurveyChunk* previousChunk = parentTrip()->chunk(index);
-            if(previousChunk != nullptr) {
-                stationName = previousChunk->stations().last().name();
+            if(previousChunk != nullptr && previousChunk->stationCount() > 0) {
+                stationName = previousChunk->surveyData().stationNames().last();
             }
         }
 
         if(stationName.isEmpty()) {
-            int secondToLastStation = stations().size() - 2;
-            stationName = stations().at(secondToLastStation).name();
+            int secondToLastStation = names.size() - 2;
+            stationName = names.at(secondToLastStation);
         }
 
         QString nextStation = guessNextStation(stationName);
@@ -662,8 +659,8 @@ QString cwSurveyChunk::guessNextStation(QString stationName) const {
  * If the index is out of range, this function will do nothing
  */
 void cwSurveyChunk::setStation(cwStation station, int index){
-    if(index < 0 || index >= Stations.size()) { return; }
-    Stations[index] = station;
+    if(index < 0 || index >= SurveyData.stationCount()) { return; }
+    SurveyData.setStation(index, station);
     dataChanged(StationNameRole, index);
     dataChanged(StationLeftRole, index);
     dataChanged(StationRightRole, index);
@@ -687,23 +684,23 @@ bool cwSurveyChunk::isStationAndShotsEmpty() const
         return true;
     }
 
-    foreach(cwStation station, Stations) {
-        if(!station.name().isEmpty() ||
-                station.leftInputState() != cwDistanceStates::Empty ||
-                station.rightInputState() != cwDistanceStates::Empty ||
-                station.upInputState() != cwDistanceStates::Empty ||
-                station.downInputState() != cwDistanceStates::Empty)
+    for(int i = 0; i < SurveyData.stationCount(); i++) {
+        if(!SurveyData.stationNames().at(i).isEmpty() ||
+                SurveyData.leftStates().at(i) != cwDistanceStates::Empty ||
+                SurveyData.rightStates().at(i) != cwDistanceStates::Empty ||
+                SurveyData.upStates().at(i) != cwDistanceStates::Empty ||
+                SurveyData.downStates().at(i) != cwDistanceStates::Empty)
         {
             return false;
         }
     }
 
-    foreach(cwShot shot, Shots) {
-        if(shot.distanceState() != cwDistanceStates::Empty ||
-                shot.backCompassState() != cwCompassStates::Empty ||
-                shot.compassState() != cwCompassStates::Empty ||
-                shot.clinoState() != cwClinoStates::Empty ||
-                shot.backClinoState() != cwClinoStates::Empty)
+    for(int i = 0; i < SurveyData.shotCount(); i++) {
+        if(SurveyData.distanceStates().at(i) != cwDistanceStates::Empty ||
+                SurveyData.backCompassStates().at(i) != cwCompassStates::Empty ||
+                SurveyData.compassStates().at(i) != cwCompassStates::Empty ||
+                SurveyData.clinoStates().at(i) != cwClinoStates::Empty ||
+                SurveyData.backClinoStates().at(i) != cwClinoStates::Empty)
         {
             return false;
         }
@@ -729,31 +726,29 @@ QVariant cwSurveyChunk::data(DataRole role, int index) const {
   \brief Helper function to data
   */
 QVariant cwSurveyChunk::stationData(DataRole role, int index) const {
-    if(index < 0 || index >= Stations.size()) { return QVariant(); }
-
-    const cwStation& station = Stations[index];
+    if(index < 0 || index >= SurveyData.stationCount()) { return QVariant(); }
 
     switch (role) {
     case StationNameRole:
-        return station.name();
+        return SurveyData.stationNames().at(index);
     case StationLeftRole:
-        if(station.leftInputState() == cwDistanceStates::Valid) {
-            return QString::number(station.left(), 'g', -1);
+        if(SurveyData.leftStates().at(index) == cwDistanceStates::Valid) {
+            return QString::number(SurveyData.lefts().at(index), 'g', -1);
         }
         break;
     case StationRightRole:
-        if(station.rightInputState() == cwDistanceStates::Valid) {
-            return QString::number(station.right(), 'g', -1);
+        if(SurveyData.rightStates().at(index) == cwDistanceStates::Valid) {
+            return QString::number(SurveyData.rights().at(index), 'g', -1);
         }
         break;
     case StationUpRole:
-        if(station.upInputState() == cwDistanceStates::Valid) {
-            return QString::number(station.up(), 'g', -1);
+        if(SurveyData.upStates().at(index) == cwDistanceStates::Valid) {
+            return QString::number(SurveyData.ups().at(index), 'g', -1);
         }
         break;
     case StationDownRole:
-        if(station.downInputState() == cwDistanceStates::Valid) {
-            return QString::number(station.down(), 'g', -1);
+        if(SurveyData.downStates().at(index) == cwDistanceStates::Valid) {
+            return QString::number(SurveyData.downs().at(index), 'g', -1);
         }
         break;
     default:
@@ -766,32 +761,30 @@ QVariant cwSurveyChunk::stationData(DataRole role, int index) const {
   \brief Helper function to data
   */
 QVariant cwSurveyChunk::shotData(DataRole role, int index) const {
-    if(index < 0 || index >= Shots.size()) { return QVariant(); }
-
-    const cwShot& shot = Shots[index];
+    if(index < 0 || index >= SurveyData.shotCount()) { return QVariant(); }
 
     switch(role) {
     case ShotDistanceRole:
-        if(shot.distanceState() == cwDistanceStates::Valid) {
-            return QString::number(shot.distance(), 'g', -1);
+        if(SurveyData.distanceStates().at(index) == cwDistanceStates::Valid) {
+            return QString::number(SurveyData.distances().at(index), 'g', -1);
         }
         break;
     case ShotDistanceIncludedRole:
-        return shot.isDistanceIncluded();
+        return SurveyData.distancesIncluded().at(index);
     case ShotCompassRole:
-        if(shot.compassState() == cwCompassStates::Valid) {
-            return QString::number(shot.compass(), 'g', -1);
+        if(SurveyData.compassStates().at(index) == cwCompassStates::Valid) {
+            return QString::number(SurveyData.compasses().at(index), 'g', -1);
         }
         break;
     case ShotBackCompassRole:
-        if(shot.backCompassState() == cwCompassStates::Valid) {
-            return QString::number(shot.backCompass(), 'g', -1);
+        if(SurveyData.backCompassStates().at(index) == cwCompassStates::Valid) {
+            return QString::number(SurveyData.backCompasses().at(index), 'g', -1);
         }
         break;
     case ShotClinoRole: {
-        switch(shot.clinoState()) {
+        switch(SurveyData.clinoStates().at(index)) {
         case cwClinoStates::Valid:
-            return QString::number(shot.clino(), 'g', -1);
+            return QString::number(SurveyData.clinos().at(index), 'g', -1);
         case cwClinoStates::Empty:
             return QVariant();
         case cwClinoStates::Down:
@@ -802,9 +795,9 @@ QVariant cwSurveyChunk::shotData(DataRole role, int index) const {
         break;
     }
     case ShotBackClinoRole:
-        switch(shot.backClinoState()) {
+        switch(SurveyData.backClinoStates().at(index)) {
         case cwClinoStates::Valid:
-            return QString::number(shot.backClino(), 'g', -1);
+            return QString::number(SurveyData.backClinos().at(index), 'g', -1);
         case cwClinoStates::Empty:
             return QVariant();
         case cwClinoStates::Down:
@@ -823,7 +816,7 @@ QVariant cwSurveyChunk::shotData(DataRole role, int index) const {
   \brief Sets the station's data for role, index, and data
   */
 void cwSurveyChunk::setStationData(cwSurveyChunk::DataRole role, int index, const QVariant& data) {
-    if(index < 0 || index >= Stations.size()) {
+    if(index < 0 || index >= SurveyData.stationCount()) {
         qDebug() << QString("Can't set station data for role \"%1\" at index: \"%2\" with data: \"%3\"")
                     .arg(role).arg(index).arg(data.toString()) << LOCATION;
         return;
@@ -835,33 +828,32 @@ void cwSurveyChunk::setStationData(cwSurveyChunk::DataRole role, int index, cons
     }
 
     QString dataString = data.toString();
-    cwStation& station = Stations[index];
+    cwStation station = SurveyData.station(index);
 
     switch (role) {
     case StationNameRole:
         station.setName(dataString);
-        emit dataChanged(role, index);
         break;
     case StationLeftRole:
         station.setLeft(dataString);
-        emit dataChanged(role, index);
         break;
     case StationRightRole:
         station.setRight(dataString);
-        emit dataChanged(role, index);
         break;
     case StationUpRole:
         station.setUp(dataString);
-        emit dataChanged(role, index);
         break;
     case StationDownRole:
         station.setDown(dataString);
-        emit dataChanged(role, index);
         break;
     default:
         qDebug() << "Can't find role:" << role << LOCATION;
+        return;
     }
 
+    SurveyData.setStation(index, station);
+    emit dataChanged(role, index);
+
     checkForErrorOnDataChanged(role, index);
 
 }
@@ -870,7 +862,7 @@ void cwSurveyChunk::setStationData(cwSurveyChunk::DataRole role, int index, cons
   \brief Sets the shot's data for role, index, and data
   */
 void cwSurveyChunk::setShotData(cwSurveyChunk::DataRole role, int index, const QVariant& data) {
-    if(index < 0 || index >= Shots.size()) {
+    if(index < 0 || index >= SurveyData.shotCount()) {
         qDebug() << QString("Can't set shot data for role \"%1\" at index: \"%2\" with data: \"%3\"")
                     .arg(role).arg(index).arg(data.toString()) << LOCATION;
         return;
@@ -881,37 +873,35 @@ void cwSurveyChunk::setShotData(cwSurveyChunk::DataRole role, int index, const Q
         return;
     }
 
-    cwShot& shot = Shots[index];
+    cwShot shot = SurveyData.shot(index);
 
     switch(role) {
     case ShotDistanceRole:
         shot.setDistance(data.toString());
-        emit dataChanged(role, index);
         break;
     case ShotDistanceIncludedRole:
         shot.setDistanceIncluded(data.toBool());
-        emit dataChanged(role, index);
         break;
     case ShotCompassRole:
         shot.setCompass(data.toString());
-        emit dataChanged(role, index);
         break;
     case ShotBackCompassRole:
         shot.setBackCompass(data.toString());
-        emit dataChanged(role, index);
         break;
     case ShotClinoRole:
         shot.setClino(data.toString());
-        emit dataChanged(role, index);
         break;
     case ShotBackClinoRole:
         shot.setBackClino(data.toString());
-        emit  dataChanged(role, index);
         break;
     default:
         qDebug() << "Can't find role:" << role << LOCATION;
+        return;
     }
 
+    SurveyData.setShot(index, shot);
+    emit dataChanged(role, index);
+
     checkForErrorOnDataChanged(role, index);
 }
 
@@ -1074,7 +1064,7 @@ void cwSurveyChunk::checkForError(cwSurveyChunk::DataRole role, int index)
 void cwSurveyChunk::checkForStationError(int index)
 {
     Q_ASSERT(index >= 0);
-    Q_ASSERT(index < Stations.size());
+    Q_ASSERT(index < SurveyData.stationCount());
     checkForError(StationNameRole, index);
     checkForError(StationLeftRole, index);
     checkForError(StationRightRole, index);
@@ -1089,7 +1079,7 @@ void cwSurveyChunk::checkForStationError(int index)
 void cwSurveyChunk::checkForShotError(int index)
 {
     Q_ASSERT(index >= 0);
-    Q_ASSERT(index < Shots.size());
+    Q_ASSERT(index < SurveyData.shotCount());
     checkForError(ShotDistanceRole, index);
     checkForError(ShotDistanceIncludedRole, index);
     checkForError(ShotCompassRole, index);
@@ -1426,11 +1416,11 @@ void cwSurveyChunk::updateErrors()
 {
     clearErrors();
 
-    for(int i = 0; i < Shots.size(); i++) {
+    for(int i = 0; i < SurveyData.shotCount(); i++) {
         checkForShotError(i);
     }
 
-    for(int i = 0; i < Stations.size(); i++) {
+    for(int i = 0; i < SurveyData.stationCount(); i++) {
         checkForStationError(i);
     }
 }
@@ -1517,6 +1507,9 @@ void cwSurveyChunk::updateCompassClinoErrors()
  *
  * Called when ever shots are added to the chunk. This updates the indexes in the
  * Calibrations in the chunk. Usually there's no calibrations to update.
+ *
+ * This is called directly, instead of from shotsAdded(), so it still runs when the chunk's
+ * signals are blocked by a bulk edit, see cwTrip::beginBulkEdit().
  */
 void cwSurveyChunk::updateCalibrationsNewShots(int beginIndex, int endIndex)
 {
@@ -1527,7 +1520,7 @@ void cwSurveyChunk::updateCalibrationsNewShots(int beginIndex, int endIndex)
         for(auto iter = Calibrations.begin(); iter != Calibrations.end(); iter++) {
             //if the calibration at shot x is greater than or equal to the first
             //index that was added and the beginIndex isn't the last shot in shots
-            if(beginIndex <= iter.key() && beginIndex != Shots.size() - distance) {
+            if(beginIndex <= iter.key() && beginIndex != SurveyData.shotCount() - distance) {
                 //Update the key and shift the calibration down
                 Q_ASSERT(iter.value() != nullptr);
                 newCalibration.insert(iter.key() + distance, iter.value());
@@ -1574,7 +1567,7 @@ void cwSurveyChunk::updateCalibrationsRemoveShots(int beginIndex, int endIndex)
                 }
             } else if(beginIndex <= iter.key() && endIndex >= iter.key()) {
                 //Deleting the index
-                if(beginIndex < Shots.size()) {
+                if(beginIndex < SurveyData.shotCount()) {
                     //There's a valid shot at beginIndex
                     if(!newCalibration.contains(beginIndex)) {
                         newCalibration.insert(beginIndex, iter.value());
@@ -1691,10 +1684,11 @@ cwErrorModel* cwSurveyChunk::errorsAt(int index, cwSurveyChunk::DataRole role) c
   This does no bounds checking!!!
   */
 void cwSurveyChunk::remove(int stationIndex, int shotIndex) {
-    Stations.removeAt(stationIndex);
+    SurveyData.removeStations(stationIndex);
     emit stationsRemoved(stationIndex, stationIndex);
 
-    Shots.removeAt(shotIndex);
+    SurveyData.removeShots(shotIndex);
+    updateCalibrationsRemoveShots(shotIndex, shotIndex);
     emit shotsRemoved(shotIndex, shotIndex);
 }
 
@@ -1746,8 +1740,8 @@ int cwSurveyChunk::index(int index, Direction direction) {
 bool cwSurveyChunk::hasStation(QString stationName) const {
 
     //Linear search...
-    foreach(cwStation station, Stations) {
-        if(station.name().compare(stationName, Qt::CaseInsensitive) == 0) {
+    foreach(const QString& name, SurveyData.stationNames()) {
+        if(name.compare(stationName, Qt::CaseInsensitive) == 0) {
             return true;
         }
     }
@@ -1790,8 +1784,9 @@ QSet<cwStation> cwSurveyChunk::neighboringStations(QString stationName) const {
   */
 QList<int> cwSurveyChunk::indicesOfStation(QString stationName) const {
     QList<int> indices;
-    for(int i = 0; i < Stations.size(); i++) {
-        if(Stations[i].name().compare(stationName, Qt::CaseInsensitive) == 0) {
+    const QVector<QString>& names = SurveyData.stationNames();
+    for(int i = 0; i < names.size(); i++) {
+        if(names.at(i).compare(stationName, Qt::CaseInsensitive) == 0) {
             indices.append(i);
         }
     }
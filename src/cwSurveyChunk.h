@@ -12,6 +12,7 @@
 //#include "cwStationReference.h"
 #include "cwStation.h"
 #include "cwShot.h"
+#include "cwSurveyChunkData.h"
 #include "cwError.h"
 #include "cwGlobals.h"
 class cwErrorModel;
@@ -75,6 +76,7 @@ public:
 
     QList<cwStation> stations() const;
     QList<cwShot> shots() const;
+    const cwSurveyChunkData& surveyData() const;
 
     void addCalibration(int shotIndex, cwTripCalibration *calibration = nullptr);
     void removeCalibration(int shotIndex);
@@ -171,8 +173,7 @@ private:
         int Role;
     };
 
-    QList<cwStation> Stations;
-    QList<cwShot> Shots;
+    cwSurveyChunkData SurveyData;
     QMap<int, cwTripCalibration*> Calibrations;
 
     cwErrorModel* ErrorModel;
@@ -183,8 +184,8 @@ private:
     bool Editting; //!< Puts the survey chunk in a edditing state, this will try to keep a empty shot at the end of the chunk
     ConnectedState IsConnectedState; //!<
 
-    bool shotIndexCheck(int index) const { return index >= 0 && index < Shots.count();  }
-    bool stationIndexCheck(int index) const { return index >= 0 && index < Stations.count(); }
+    bool shotIndexCheck(int index) const { return index >= 0 && index < SurveyData.shotCount();  }
+    bool stationIndexCheck(int index) const { return index >= 0 && index < SurveyData.stationCount(); }
 
     void remove(int stationIndex, int shotIndex);
     int index(int index, Direction direction);
@@ -214,14 +215,14 @@ private:
     bool isClinoDownOrUp(cwSurveyChunk::DataRole role, int index) const;
     bool isClinoDownOrUpHelper(cwSurveyChunk::DataRole role, int index) const;
 
+    void updateCalibrationsNewShots(int beginIndex, int endIndex);
+    void updateCalibrationsRemoveShots(int beginIndex, int endIndex);
+
 private slots:
     void updateCompassErrors();
     void updateClinoErrors();
     void updateCompassClinoErrors();
 
-    void updateCalibrationsNewShots(int beginIndex, int endIndex);
-    void updateCalibrationsRemoveShots(int beginIndex, int endIndex);
-
 //    int errorCount(cwSurveyChunkError::ErrorType type) const;
 
 };
@@ -238,19 +239,28 @@ inline cwTrip* cwSurveyChunk::parentTrip() const {
 /**
   \brief Gets all the stations
 
-  You shouldn't modify the station data from this list
+  This builds the stations from the survey data, use surveyData() to read large chunks
   */
 inline QList<cwStation> cwSurveyChunk::stations() const {
-    return Stations;
+    return SurveyData.stations();
 }
 
 /**
   \brief Gets all the shot date
 
-  You shouldn't modify the shot data from this list
+  This builds the shots from the survey data, use surveyData() to read large chunks
   */
 inline QList<cwShot> cwSurveyChunk::shots() const {
-    return Shots;
+    return SurveyData.shots();
+}
+
+/**
+  \brief Gets the stations and shots as columns of readings
+
+  This is the fastest way to read the chunk, it doesn't copy any stations or shots
+  */
+inline const cwSurveyChunkData& cwSurveyChunk::surveyData() const {
+    return SurveyData;
 }
 
 
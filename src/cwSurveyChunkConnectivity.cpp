@@ -0,0 +1,202 @@
+//Our includes
+#include "cwSurveyChunkConnectivity.h"
+#include "cwSurveyChunk.h"
+
+//Std includes
+#include <utility>
+
+cwSurveyChunkConnectivity::cwSurveyChunkConnectivity()
+{
+}
+
+/**
+ * Adds the chunk, and connects it to the chunks that share it's stations. If the chunk has
+ * already been added, this is the same as updateChunk().
+ */
+void cwSurveyChunkConnectivity::addChunk(const cwSurveyChunk *chunk)
+{
+    if(ChunkStations.contains(chunk)) {
+        updateChunk(chunk);
+        return;
+    }
+
+    QVector<int> stations = stationIds(chunk);
+    ChunkStations.insert(chunk, stations);
+
+    if(!NeedsRebuild) {
+        unite(stations);
+    }
+}
+
+/**
+ * Updates the chunk's stations, after it's been edited
+ */
+void cwSurveyChunkConnectivity::updateChunk(const cwSurveyChunk *chunk)
+{
+    QVector<int> stations = stationIds(chunk);
+    auto iter = ChunkStations.find(chunk);
+    if(iter == ChunkStations.end()) {
+        ChunkStations.insert(chunk, stations);
+        if(!NeedsRebuild) {
+            unite(stations);
+        }
+        return;
+    }
+
+    if(*iter == stations) {
+        return;
+    }
+
+    *iter = stations;
+    NeedsRebuild = true;
+}
+
+/**
+ * Removes the chunk, chunks that were only connected through it are no longer connected
+ */
+void cwSurveyChunkConnectivity::removeChunk(const cwSurveyChunk *chunk)
+{
+    if(ChunkStations.remove(chunk) > 0) {
+        NeedsRebuild = true;
+    }
+}
+
+/**
+ * Removes all the chunks and station names
+ */
+void cwSurveyChunkConnectivity::clear()
+{
+    StationIds.clear();
+    ChunkStations.clear();
+    Parent.clear();
+    Rank.clear();
+    NeedsRebuild = false;
+}
+
+/**
+ * Returns true if chunk1 and chunk2 share a station, or are connected through other chunks.
+ *
+ * A chunk is connected to itself, if it has a station. Chunks that haven't been added aren't
+ * connected to anything.
+ */
+bool cwSurveyChunkConnectivity::isConnected(const cwSurveyChunk *chunk1, const cwSurveyChunk *chunk2)
+{
+    auto iter1 = ChunkStations.constFind(chunk1);
+    auto iter2 = ChunkStations.constFind(chunk2);
+    if(iter1 == ChunkStations.constEnd() || iter2 == ChunkStations.constEnd()) {
+        return false;
+    }
+
+    if(iter1->isEmpty() || iter2->isEmpty()) {
+        return false;
+    }
+
+    if(NeedsRebuild) {
+        rebuild();
+    }
+
+    return find(iter1->first()) == find(iter2->first());
+}
+
+/**
+ * Returns the ids of the chunk's stations, interning new station names. Stations without a
+ * name are skipped.
+ */
+QVector<int> cwSurveyChunkConnectivity::stationIds(const cwSurveyChunk *chunk)
+{
+    const QVector<QString>& names = chunk->surveyData().stationNames();
+
+    QVector<int> ids;
+    ids.reserve(names.size());
+
+    for(const QString& stationName : names) {
+        if(stationName.isEmpty()) {
+            continue;
+        }
+
+        QString name = stationName.toUpper();
+
+        auto iter = StationIds.constFind(name);
+        int id;
+        if(iter == StationIds.constEnd()) {
+            id = StationIds.size();
+            StationIds.insert(name, id);
+        } else {
+            id = iter.value();
+        }
+
+        ids.append(id);
+    }
+
+    //The disjoint set has a entry for every interned station
+    while(Parent.size() < StationIds.size()) {
+        Parent.append(Parent.size());
+        Rank.append(0);
+    }
+
+    return ids;
+}
+
+/**
+ * Joins all the stations into one set
+ */
+void cwSurveyChunkConnectivity::unite(const QVector<int> &stations)
+{
+    if(stations.isEmpty()) {
+        return;
+    }
+
+    int root = find(stations.first());
+    for(int i = 1; i < stations.size(); i++) {
+        int other = find(stations.at(i));
+        if(other == root) {
+            continue;
+        }
+
+        //Union by rank, keeps the trees shallow
+        if(Rank.at(root) < Rank.at(other)) {
+            std::swap(root, other);
+        }
+        Parent[other] = root;
+        if(Rank.at(root) == Rank.at(other)) {
+            Rank[root]++;
+        }
+    }
+}
+
+/**
+ * Returns the id of the station that represents station's set
+ */
+int cwSurveyChunkConnectivity::find(int station)
+{
+    int root = station;
+    while(Parent.at(root) != root) {
+        root = Parent.at(root);
+    }
+
+    //Path compression, so the next find is faster
+    while(Parent.at(station) != root) {
+        int next = Parent.at(station);
+        Parent[station] = root;
+        station = next;
+    }
+
+    return root;
+}
+
+/**
+ * Rebuilds the disjoint set from every chunk's station ids
+ */
+void cwSurveyChunkConnectivity::rebuild()
+{
+    for(int i = 0; i < Parent.size(); i++) {
+        Parent[i] = i;
+        Rank[i] = 0;
+    }
+
+    for(const QVector<int>& stations : ChunkStations) {
+        unite(stations);
+    }
+
+    NeedsRebuild = false;
+}
@@ -0,0 +1,85 @@
+#ifndef CWSURVEYCHUNKCONNECTIVITY_H
+#define CWSURVEYCHUNKCONNECTIVITY_H
+
+//Our includes
+#include "cwGlobals.h"
+class cwSurveyChunk;
+
+//Qt includes
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief The cwSurveyChunkConnectivity class finds which survey chunks are connected by stations
+ *
+ * Two chunks are connected if they share a station, or are both connected to another chunk.
+ * Station names aren't case sensitive.
+ *
+ * Station names are interned into ids, and stations that are in the same chunk are joined
+ * in a disjoint set (union-find). Adding a chunk only visits it's stations once, and finding
+ * if two chunks are connected is almost constant time, no matter how many chunks there are.
+ *
+ * Chunks can be added, updated and removed one at a time. Adding a chunk joins it's stations
+ * into the existing sets. A disjoint set can't be split, so updating or removing a chunk
+ * rebuilds the sets from the interned station ids, the next time they're needed. This
+ * doesn't look at any station names.
+ *
+ * This doesn't keep a reference to the chunks, the chunk pointers are only used as keys.
+ */
+class CAVEWHERE_LIB_EXPORT cwSurveyChunkConnectivity
+{
+public:
+    cwSurveyChunkConnectivity();
+
+    void addChunk(const cwSurveyChunk* chunk);
+    void updateChunk(const cwSurveyChunk* chunk);
+    void removeChunk(const cwSurveyChunk* chunk);
+    void clear();
+
+    bool contains(const cwSurveyChunk* chunk) const;
+    int chunkCount() const;
+    int stationCount() const;
+
+    bool isConnected(const cwSurveyChunk* chunk1, const cwSurveyChunk* chunk2);
+
+private:
+    QHash<QString, int> StationIds; //Upper case station name to id
+    QHash<const cwSurveyChunk*, QVector<int>> ChunkStations; //The ids of the chunk's stations
+
+    //The disjoint set, indexed by station id
+    QVector<int> Parent;
+    QVector<int> Rank;
+    bool NeedsRebuild = false;
+
+    QVector<int> stationIds(const cwSurveyChunk* chunk);
+    void unite(const QVector<int>& stations);
+    int find(int station);
+    void rebuild();
+};
+
+/**
+ * Returns true if the chunk has been added
+ */
+inline bool cwSurveyChunkConnectivity::contains(const cwSurveyChunk *chunk) const
+{
+    return ChunkStations.contains(chunk);
+}
+
+/**
+ * Returns the number of chunks that have been added
+ */
+inline int cwSurveyChunkConnectivity::chunkCount() const
+{
+    return ChunkStations.size();
+}
+
+/**
+ * Returns the number of station names that have been interned
+ */
+inline int cwSurveyChunkConnectivity::stationCount() const
+{
+    return StationIds.size();
+}
+
+#endif // CWSURVEYCHUNKCONNECTIVITY_H
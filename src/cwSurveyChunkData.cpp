@@ -0,0 +1,224 @@
+//Our includes
+#include "cwSurveyChunkData.h"
+
+cwSurveyChunkData::cwSurveyChunkData()
+{
+}
+
+template<typename Function>
+void cwSurveyChunkData::forEachStationColumn(Function function)
+{
+    function(StationNames);
+    function(Lefts);
+    function(Rights);
+    function(Ups);
+    function(Downs);
+    function(LeftStates);
+    function(RightStates);
+    function(UpStates);
+    function(DownStates);
+}
+
+template<typename Function>
+void cwSurveyChunkData::forEachShotColumn(Function function)
+{
+    function(Distances);
+    function(Compasses);
+    function(BackCompasses);
+    function(Clinos);
+    function(BackClinos);
+    function(DistanceStates);
+    function(CompassStates);
+    function(BackCompassStates);
+    function(ClinoStates);
+    function(BackClinoStates);
+    function(DistancesIncluded);
+}
+
+/**
+ * Builds the station at index from the station columns
+ */
+cwStation cwSurveyChunkData::station(int index) const
+{
+    cwStation station;
+    cwStation::PrivateData* data = station.Data.data();
+    data->Name = StationNames.at(index);
+    data->Left = Lefts.at(index);
+    data->Right = Rights.at(index);
+    data->Up = Ups.at(index);
+    data->Down = Downs.at(index);
+    data->LeftState = LeftStates.at(index);
+    data->RightState = RightStates.at(index);
+    data->UpState = UpStates.at(index);
+    data->DownState = DownStates.at(index);
+    return station;
+}
+
+/**
+ * Replaces the station at index
+ */
+void cwSurveyChunkData::setStation(int index, const cwStation &station)
+{
+    const cwStation::PrivateData* data = station.Data.constData();
+    StationNames[index] = data->Name;
+    Lefts[index] = data->Left;
+    Rights[index] = data->Right;
+    Ups[index] = data->Up;
+    Downs[index] = data->Down;
+    LeftStates[index] = data->LeftState;
+    RightStates[index] = data->RightState;
+    UpStates[index] = data->UpState;
+    DownStates[index] = data->DownState;
+}
+
+void cwSurveyChunkData::appendStation(const cwStation &station)
+{
+    insertStation(stationCount(), station);
+}
+
+void cwSurveyChunkData::insertStation(int index, const cwStation &station)
+{
+    const cwStation::PrivateData* data = station.Data.constData();
+    StationNames.insert(index, data->Name);
+    Lefts.insert(index, data->Left);
+    Rights.insert(index, data->Right);
+    Ups.insert(index, data->Up);
+    Downs.insert(index, data->Down);
+    LeftStates.insert(index, data->LeftState);
+    RightStates.insert(index, data->RightState);
+    UpStates.insert(index, data->UpState);
+    DownStates.insert(index, data->DownState);
+}
+
+/**
+ * Removes count stations starting at index
+ */
+void cwSurveyChunkData::removeStations(int index, int count)
+{
+    forEachStationColumn([index, count](auto& column) {
+        column.remove(index, count);
+    });
+}
+
+/**
+ * Builds the shot at index from the shot columns
+ */
+cwShot cwSurveyChunkData::shot(int index) const
+{
+    cwShot shot;
+    cwShot::PrivateData* data = shot.Data.data();
+    data->Distance = Distances.at(index);
+    data->Compass = Compasses.at(index);
+    data->BackCompass = BackCompasses.at(index);
+    data->Clino = Clinos.at(index);
+    data->BackClino = BackClinos.at(index);
+    data->DistanceState = DistanceStates.at(index);
+    data->CompassState = CompassStates.at(index);
+    data->BackCompassState = BackCompassStates.at(index);
+    data->ClinoState = ClinoStates.at(index);
+    data->BackClinoState = BackClinoStates.at(index);
+    data->IncludeDistance = DistancesIncluded.at(index);
+    return shot;
+}
+
+/**
+ * Replaces the shot at index
+ */
+void cwSurveyChunkData::setShot(int index, const cwShot &shot)
+{
+    const cwShot::PrivateData* data = shot.Data.constData();
+    Distances[index] = data->Distance;
+    Compasses[index] = data->Compass;
+    BackCompasses[index] = data->BackCompass;
+    Clinos[index] = data->Clino;
+    BackClinos[index] = data->BackClino;
+    DistanceStates[index] = data->DistanceState;
+    CompassStates[index] = data->CompassState;
+    BackCompassStates[index] = data->BackCompassState;
+    ClinoStates[index] = data->ClinoState;
+    BackClinoStates[index] = data->BackClinoState;
+    DistancesIncluded[index] = data->IncludeDistance;
+}
+
+void cwSurveyChunkData::appendShot(const cwShot &shot)
+{
+    insertShot(shotCount(), shot);
+}
+
+void cwSurveyChunkData::insertShot(int index, const cwShot &shot)
+{
+    const cwShot::PrivateData* data = shot.Data.constData();
+    Distances.insert(index, data->Distance);
+    Compasses.insert(index, data->Compass);
+    BackCompasses.insert(index, data->BackCompass);
+    Clinos.insert(index, data->Clino);
+    BackClinos.insert(index, data->BackClino);
+    DistanceStates.insert(index, data->DistanceState);
+    CompassStates.insert(index, data->CompassState);
+    BackCompassStates.insert(index, data->BackCompassState);
+    ClinoStates.insert(index, data->ClinoState);
+    BackClinoStates.insert(index, data->BackClinoState);
+    DistancesIncluded.insert(index, data->IncludeDistance);
+}
+
+/**
+ * Removes count shots starting at index
+ */
+void cwSurveyChunkData::removeShots(int index, int count)
+{
+    forEachShotColumn([index, count](auto& column) {
+        column.remove(index, count);
+    });
+}
+
+/**
+ * Reserves space for stationCount stations and the shots between them
+ */
+void cwSurveyChunkData::reserve(int stationCount)
+{
+    forEachStationColumn([stationCount](auto& column) {
+        column.reserve(stationCount);
+    });
+
+    const int shotCount = qMax(0, stationCount - 1);
+    forEachShotColumn([shotCount](auto& column) {
+        column.reserve(shotCount);
+    });
+}
+
+void cwSurveyChunkData::clear()
+{
+    forEachStationColumn([](auto& column) {
+        column.clear();
+    });
+
+    forEachShotColumn([](auto& column) {
+        column.clear();
+    });
+}
+
+/**
+ * Builds all the stations. This is slow for large chunks, prefer reading the columns
+ */
+QList<cwStation> cwSurveyChunkData::stations() const
+{
+    QList<cwStation> stations;
+    stations.reserve(stationCount());
+    for(int i = 0; i < stationCount(); i++) {
+        stations.append(station(i));
+    }
+    return stations;
+}
+
+/**
+ * Builds all the shots. This is slow for large chunks, prefer reading the columns
+ */
+QList<cwShot> cwSurveyChunkData::shots() const
+{
+    QList<cwShot> shots;
+    shots.reserve(shotCount());
+    for(int i = 0; i < shotCount(); i++) {
+        shots.append(shot(i));
+    }
+    return shots;
+}
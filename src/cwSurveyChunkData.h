@@ -0,0 +1,205 @@
+#ifndef CWSURVEYCHUNKDATA_H
+#define CWSURVEYCHUNKDATA_H
+
+//Our includes
+#include "cwStation.h"
+#include "cwShot.h"
+#include "cwReadingStates.h"
+#include "cwGlobals.h"
+
+//Qt includes
+#include <QVector>
+#include <QString>
+#include <QList>
+
+/**
+ * @brief The cwSurveyChunkData class stores a survey chunk's stations and shots in columns
+ *
+ * Every reading, like the shot distances or the station's left walls, is stored in it's own
+ * contiguous array, with a matching array of reading states. Exporters and solvers should read
+ * the columns directly, instead of copying cwStation and cwShot for every shot.
+ *
+ * \code
+ * const cwSurveyChunkData& data = chunk->surveyData();
+ * for(int i = 0; i < data.shotCount(); i++) {
+ *     if(data.distanceStates().at(i) == cwDistanceStates::Valid) {
+ *         length += data.distances().at(i);
+ *     }
+ * }
+ * \endcode
+ *
+ * cwStation and cwShot are still used to add and change the data, because they validate the
+ * readings. station() and shot() build them from the columns.
+ *
+ * Station names are implicitly shared QStrings, so the same name in several chunks, isn't copied.
+ * The columns are implicitly shared too, so copying cwSurveyChunkData is cheap.
+ */
+class CAVEWHERE_LIB_EXPORT cwSurveyChunkData
+{
+public:
+    cwSurveyChunkData();
+
+    int stationCount() const;
+    int shotCount() const;
+
+    cwStation station(int index) const;
+    void setStation(int index, const cwStation& station);
+    void appendStation(const cwStation& station);
+    void insertStation(int index, const cwStation& station);
+    void removeStations(int index, int count = 1);
+
+    cwShot shot(int index) const;
+    void setShot(int index, const cwShot& shot);
+    void appendShot(const cwShot& shot);
+    void insertShot(int index, const cwShot& shot);
+    void removeShots(int index, int count = 1);
+
+    void reserve(int stationCount);
+    void clear();
+
+    QList<cwStation> stations() const;
+    QList<cwShot> shots() const;
+
+    //Station columns
+    const QVector<QString>& stationNames() const;
+    const QVector<double>& lefts() const;
+    const QVector<double>& rights() const;
+    const QVector<double>& ups() const;
+    const QVector<double>& downs() const;
+    const QVector<cwDistanceStates::State>& leftStates() const;
+    const QVector<cwDistanceStates::State>& rightStates() const;
+    const QVector<cwDistanceStates::State>& upStates() const;
+    const QVector<cwDistanceStates::State>& downStates() const;
+
+    //Shot columns
+    const QVector<double>& distances() const;
+    const QVector<double>& compasses() const;
+    const QVector<double>& backCompasses() const;
+    const QVector<double>& clinos() const;
+    const QVector<double>& backClinos() const;
+    const QVector<cwDistanceStates::State>& distanceStates() const;
+    const QVector<cwCompassStates::State>& compassStates() const;
+    const QVector<cwCompassStates::State>& backCompassStates() const;
+    const QVector<cwClinoStates::State>& clinoStates() const;
+    const QVector<cwClinoStates::State>& backClinoStates() const;
+    const QVector<bool>& distancesIncluded() const;
+
+private:
+    QVector<QString> StationNames;
+    QVector<double> Lefts;
+    QVector<double> Rights;
+    QVector<double> Ups;
+    QVector<double> Downs;
+    QVector<cwDistanceStates::State> LeftStates;
+    QVector<cwDistanceStates::State> RightStates;
+    QVector<cwDistanceStates::State> UpStates;
+    QVector<cwDistanceStates::State> DownStates;
+
+    QVector<double> Distances;
+    QVector<double> Compasses;
+    QVector<double> BackCompasses;
+    QVector<double> Clinos;
+    QVector<double> BackClinos;
+    QVector<cwDistanceStates::State> DistanceStates;
+    QVector<cwCompassStates::State> CompassStates;
+    QVector<cwCompassStates::State> BackCompassStates;
+    QVector<cwClinoStates::State> ClinoStates;
+    QVector<cwClinoStates::State> BackClinoStates;
+    QVector<bool> DistancesIncluded;
+
+    template<typename Function>
+    void forEachStationColumn(Function function);
+
+    template<typename Function>
+    void forEachShotColumn(Function function);
+};
+
+inline int cwSurveyChunkData::stationCount() const {
+    return StationNames.size();
+}
+
+inline int cwSurveyChunkData::shotCount() const {
+    return Distances.size();
+}
+
+inline const QVector<QString>& cwSurveyChunkData::stationNames() const {
+    return StationNames;
+}
+
+inline const QVector<double>& cwSurveyChunkData::lefts() const {
+    return Lefts;
+}
+
+inline const QVector<double>& cwSurveyChunkData::rights() const {
+    return Rights;
+}
+
+inline const QVector<double>& cwSurveyChunkData::ups() const {
+    return Ups;
+}
+
+inline const QVector<double>& cwSurveyChunkData::downs() const {
+    return Downs;
+}
+
+inline const QVector<cwDistanceStates::State>& cwSurveyChunkData::leftStates() const {
+    return LeftStates;
+}
+
+inline const QVector<cwDistanceStates::State>& cwSurveyChunkData::rightStates() const {
+    return RightStates;
+}
+
+inline const QVector<cwDistanceStates::State>& cwSurveyChunkData::upStates() const {
+    return UpStates;
+}
+
+inline const QVector<cwDistanceStates::State>& cwSurveyChunkData::downStates() const {
+    return DownStates;
+}
+
+inline const QVector<double>& cwSurveyChunkData::distances() const {
+    return Distances;
+}
+
+inline const QVector<double>& cwSurveyChunkData::compasses() const {
+    return Compasses;
+}
+
+inline const QVector<double>& cwSurveyChunkData::backCompasses() const {
+    return BackCompasses;
+}
+
+inline const QVector<double>& cwSurveyChunkData::clinos() const {
+    return Clinos;
+}
+
+inline const QVector<double>& cwSurveyChunkData::backClinos() const {
+    return BackClinos;
+}
+
+inline const QVector<cwDistanceStates::State>& cwSurveyChunkData::distanceStates() const {
+    return DistanceStates;
+}
+
+inline const QVector<cwCompassStates::State>& cwSurveyChunkData::compassStates() const {
+    return CompassStates;
+}
+
+inline const QVector<cwCompassStates::State>& cwSurveyChunkData::backCompassStates() const {
+    return BackCompassStates;
+}
+
+inline const QVector<cwClinoStates::State>& cwSurveyChunkData::clinoStates() const {
+    return ClinoStates;
+}
+
+inline const QVector<cwClinoStates::State>& cwSurveyChunkData::backClinoStates() const {
+    return BackClinoStates;
+}
+
+inline const QVector<bool>& cwSurveyChunkData::distancesIncluded() const {
+    return DistancesIncluded;
+}
+
+#endif // CWSURVEYCHUNKDATA_H
@@ -37,6 +37,8 @@ void cwSurveyChunkSignaler::setRegion(cwCavingRegion* region) {
         //Connect all signal from the region
         connect(Region.data(), &cwCavingRegion::insertedCaves, this, &cwSurveyChunkSignaler::connectAddedCaves);
         connect(Region.data(), &cwCavingRegion::beginRemoveCaves, this, &cwSurveyChunkSignaler::disconnectRemovedCaves);
+        connect(Region.data(), &cwCavingRegion::beginResetCaves, this, &cwSurveyChunkSignaler::disconnectResettingCaves);
+        connect(Region.data(), &cwCavingRegion::resetCaves, this, &cwSurveyChunkSignaler::connectResetCaves);
 
         //Connect all sub data
         connectCaves(Region);
@@ -192,6 +194,8 @@ void cwSurveyChunkSignaler::connectCaves(cwCavingRegion *region)
 void cwSurveyChunkSignaler::connectCave(cwCave* cave) {
     connect(cave, &cwCave::insertedTrips, this, &cwSurveyChunkSignaler::connectAddedTrips);
     connect(cave, &cwCave::beginRemoveTrips, this, &cwSurveyChunkSignaler::disconnectRemovedTrips);
+    connect(cave, &cwCave::beginResetTrips, this, &cwSurveyChunkSignaler::disconnectResettingTrips);
+    connect(cave, &cwCave::resetTrips, this, &cwSurveyChunkSignaler::connectResetTrips);
     connectAll(cave, CaveConnections); //Connect to all user added connections
     connectTrips(cave);
 }
@@ -212,6 +216,8 @@ void cwSurveyChunkSignaler::connectTrips(cwCave* cave) {
 void cwSurveyChunkSignaler::connectTrip(cwTrip* trip) {
     connect(trip, &cwTrip::chunksInserted, this, &cwSurveyChunkSignaler::connectAddedChunks);
     connect(trip, &cwTrip::chunksAboutToBeRemoved, this, &cwSurveyChunkSignaler::disconnectRemovedChunks);
+    connect(trip, &cwTrip::chunksAboutToBeReset, this, &cwSurveyChunkSignaler::disconnectResettingChunks);
+    connect(trip, &cwTrip::chunksReset, this, &cwSurveyChunkSignaler::connectResetChunks);
     connectAll(trip, TripConnections); //Connect to all user added connections
     connectAll(trip->calibrations(), TripCalibrationConnections);
     connectChunks(trip);
@@ -254,6 +260,8 @@ void cwSurveyChunkSignaler::disconnectCave(cwCave *cave)
     if(cave->hasTrips()) {
         disconnectTrips(cave, 0, cave->tripCount() - 1);
     }
+
+    disconnect(cave, nullptr, this, nullptr);
 }
 
 /**
@@ -277,10 +285,13 @@ void cwSurveyChunkSignaler::disconnectTrips(cwCave *cave, int beginIndex, int en
 void cwSurveyChunkSignaler::disconnectTrip(cwTrip *trip)
 {
     disconnectAll(trip, TripConnections);
+    disconnectAll(trip->calibrations(), TripCalibrationConnections);
 
     if(!trip->chunks().isEmpty()) {
         disconnectSurveyChunks(trip, 0, trip->chunks().size() - 1);
     }
+
+    disconnect(trip, nullptr, this, nullptr);
 }
 
 /**
@@ -418,6 +429,80 @@ void cwSurveyChunkSignaler::disconnectRemovedChunks(int beginIndex, int endIndex
     disconnectSurveyChunks(trip, beginIndex, endIndex);
 }
 
+/**
+ * @brief cwSurveyChunkSignaler::connectResetCaves
+ *
+ * Called after the region's bulk edit, this connects all the caves in the region
+ */
+void cwSurveyChunkSignaler::connectResetCaves()
+{
+    connectCaves(Region);
+}
+
+/**
+ * @brief cwSurveyChunkSignaler::connectResetTrips
+ *
+ * Called after the cave's bulk edit, this connects all the trips in the cave
+ */
+void cwSurveyChunkSignaler::connectResetTrips()
+{
+    Q_ASSERT(dynamic_cast<cwCave*>(sender()) != nullptr);
+    cwCave* cave = static_cast<cwCave*>(sender());
+    connectTrips(cave);
+}
+
+/**
+ * @brief cwSurveyChunkSignaler::connectResetChunks
+ *
+ * Called after the trip's bulk edit, this connects all the chunks in the trip
+ */
+void cwSurveyChunkSignaler::connectResetChunks()
+{
+    Q_ASSERT(dynamic_cast<cwTrip*>(sender()) != nullptr);
+    cwTrip* trip = static_cast<cwTrip*>(sender());
+    connectChunks(trip);
+}
+
+/**
+ * @brief cwSurveyChunkSignaler::disconnectResettingCaves
+ *
+ * Called before the region's bulk edit, this disconnects all the caves in the region. Caves
+ * may be removed during the bulk edit.
+ */
+void cwSurveyChunkSignaler::disconnectResettingCaves()
+{
+    foreach(cwCave* cave, Region->caves()) {
+        disconnectCave(cave);
+    }
+}
+
+/**
+ * @brief cwSurveyChunkSignaler::disconnectResettingTrips
+ *
+ * Called before the cave's bulk edit, this disconnects all the trips in the cave
+ */
+void cwSurveyChunkSignaler::disconnectResettingTrips()
+{
+    Q_ASSERT(dynamic_cast<cwCave*>(sender()) != nullptr);
+    cwCave* cave = static_cast<cwCave*>(sender());
+    if(cave->hasTrips()) {
+        disconnectTrips(cave, 0, cave->tripCount() - 1);
+    }
+}
+
+/**
+ * @brief cwSurveyChunkSignaler::disconnectResettingChunks
+ *
+ * Called before the trip's bulk edit, this disconnects all the chunks in the trip
+ */
+void cwSurveyChunkSignaler::disconnectResettingChunks()
+{
+    Q_ASSERT(dynamic_cast<cwTrip*>(sender()) != nullptr);
+    cwTrip* trip = static_cast<cwTrip*>(sender());
+    if(trip->chunkCount() > 0) {
+        disconnectSurveyChunks(trip, 0, trip->chunkCount() - 1);
+    }
+}
 
 void cwSurveyChunkSignaler::Connection::connect(QObject *sender) const
 {
@@ -28,6 +28,11 @@ class cwSurveyChunk;
  * the cwLinePlotManager class re-runs the line plot when survey data changes. Calling addConnectionTo*()
  * will setup a signal slot connection between caves, trips, or chunks in the caving region. Recieving
  * slot can use QObject::sender() to figure out what object emited the signal.
+ *
+ * After a bulk edit, see cwTrip::beginBulkEdit(), the region, caves, and trips emit a reset signal
+ * instead of a signal for each change. The connections are recreated for all the children before
+ * the reset signal reaches the recievers, so a reciever only needs to connect to the reset signal
+ * and recompute once.
  */
 class CAVEWHERE_LIB_EXPORT cwSurveyChunkSignaler : public QObject
 {
@@ -107,6 +112,14 @@ private slots:
    void disconnectRemovedTrips(int beginIndex, int endIndex);
    void disconnectRemovedChunks(int beginIndex, int endIndex);
 
+   void connectResetCaves();
+   void connectResetTrips();
+   void connectResetChunks();
+
+   void disconnectResettingCaves();
+   void disconnectResettingTrips();
+   void disconnectResettingChunks();
+
 };
 
 #endif // CWSURVEYCHUNKSIGNALER_H
@@ -18,6 +18,7 @@
 #include "cwShot.h"
 #include "cwSurveyImportManager.h"
 #include "cwErrorListModel.h"
+#include "cwTaskManagerModel.h"
 
 //Qt includes
 #include <QFileDialog>
@@ -102,13 +103,16 @@ void cwSurveyImportManager::compassImporterFinished()
 {
     Q_ASSERT(CompassImporter->isReady());
 
+    //The caves were built on the importer's threads
+    QList<cwCave*> caves = CompassImporter->takeCaves();
+    for(cwCave* cave : caves) {
+        cave->moveToThread(thread());
+    }
+
     UndoStack->beginMacro("Compass Import");
 
-    //Add new caves
-    foreach(cwCave cave, CompassImporter->caves()) {
-        cwCave* newCave = new cwCave(cave); //Copy the caves
-        CavingRegion->addCave(newCave);
-    }
+    //Add new caves, all at once, so the region only updates once
+    CavingRegion->addCaves(caves);
 
     UndoStack->endMacro();
 
@@ -243,3 +247,32 @@ void cwSurveyImportManager::setErrorModel(cwErrorListModel* errorModel) {
 cwErrorListModel* cwSurveyImportManager::errorModel() const {
     return ErrorModel;
 }
+
+/**
+ * @brief cwSurveyImportManager::setTaskManager
+ * @param taskManager
+ *
+ * The task manager shows the progress of each import stage, and allows the user to stop
+ * the import
+ */
+void cwSurveyImportManager::setTaskManager(cwTaskManagerModel* taskManager) {
+    if(TaskManager != taskManager) {
+        if(TaskManager) {
+            TaskManager->removeTask(CompassImporter);
+        }
+
+        TaskManager = taskManager;
+
+        if(TaskManager) {
+            TaskManager->addTask(CompassImporter);
+        }
+    }
+}
+
+/**
+ * @brief cwSurveyImportManager::taskManager
+ * @return The task manager that shows the import's progress
+ */
+cwTaskManagerModel* cwSurveyImportManager::taskManager() const {
+    return TaskManager;
+}
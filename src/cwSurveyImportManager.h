@@ -24,6 +24,7 @@ class cwCompassImporter;
 class cwWallsImporter;
 class cwCSVImporterTask;
 class cwErrorListModel;
+class cwTaskManagerModel;
 #include "cwGlobals.h"
 
 /**
@@ -51,6 +52,9 @@ public:
     cwErrorListModel* errorModel() const;
     void setErrorModel(cwErrorListModel* errorModel);
 
+    cwTaskManagerModel* taskManager() const;
+    void setTaskManager(cwTaskManagerModel* taskManager);
+
     Q_INVOKABLE void importSurvex();
     Q_INVOKABLE void importWalls();
     Q_INVOKABLE void importWallsSrv();
@@ -81,6 +85,7 @@ private:
     QPointer<cwCavingRegion> CavingRegion;
     QPointer<QUndoStack> UndoStack;
     QPointer<cwErrorListModel> ErrorModel; //!<
+    QPointer<cwTaskManagerModel> TaskManager; //!< Shows the import's progress
 
     QStringList QueuedCompassFile;
     cwCompassImporter* CompassImporter;
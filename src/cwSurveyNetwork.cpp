@@ -11,14 +11,138 @@
 //Qt includes
 #include <QHash>
 #include <QSet>
+#include <QStringList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QAtomicInt>
 
+//Std includes
+#include <algorithm>
+
+/**
+ * Stations are interned to dense ids, in the order that they're added. Shots are stored once
+ * as an id pair, and the adjacency (compressed sparse rows) is built lazily from the shots
+ * the first time it's needed after a modification.
+ */
 class cwSurveyNetworkData : public QSharedData
 {
 public:
+    cwSurveyNetworkData() {}
+    cwSurveyNetworkData(const cwSurveyNetworkData& other) :
+        QSharedData(other),
+        StationIds(other.StationIds),
+        Names(other.Names),
+        NameHashes(other.NameHashes),
+        Shots(other.Shots),
+        ShotKeys(other.ShotKeys)
+    {
+        //The graph is rebuilt on demand, the detached copy is about to be modified
+    }
+
+    QHash<QString, int> StationIds; //Upper case name to id
+    QVector<QString> Names; //Upper case names
+    QVector<quint64> NameHashes;
+    QVector<QPair<int, int>> Shots;
+    QSet<quint64> ShotKeys;
+
+    //Lazily built adjacency, guarded by GraphMutex
+    mutable QAtomicInt GraphValid;
+    mutable QMutex GraphMutex;
+    mutable QVector<int> NeighborOffsets; //stationCount() + 1 entries
+    mutable QVector<int> NeighborIds;
+    mutable QVector<quint64> Signatures; //Order independent hash of each station's neighbors
+
+    int addStation(const QString& name);
+    void invalidateGraph() { GraphValid.storeRelease(0); }
+    void buildGraph() const;
 
-    QHash<QString, QStringList> Network;
+    static quint64 shotKey(int from, int to);
+    static quint64 mix(quint64 hash);
 };
 
+/**
+ * Returns the id of name, adding it to the network if it doesn't exist yet
+ */
+int cwSurveyNetworkData::addStation(const QString &name)
+{
+    auto iter = StationIds.constFind(name);
+    if(iter != StationIds.constEnd()) {
+        return iter.value();
+    }
+
+    int id = Names.size();
+    StationIds.insert(name, id);
+    Names.append(name);
+    NameHashes.append((static_cast<quint64>(qHash(name, 0x5bd1e995)) << 32) | qHash(name, 0x1b873593));
+    return id;
+}
+
+/**
+ * Builds the adjacency arrays from the shots. Neighbors are kept in the order that
+ * their shots were added.
+ */
+void cwSurveyNetworkData::buildGraph() const
+{
+    if(GraphValid.loadAcquire()) {
+        return;
+    }
+
+    QMutexLocker locker(&GraphMutex);
+    if(GraphValid.loadAcquire()) {
+        return;
+    }
+
+    const int numberOfStations = Names.size();
+
+    NeighborOffsets.fill(0, numberOfStations + 1);
+    for(const auto& shot : Shots) {
+        NeighborOffsets[shot.first + 1]++;
+        if(shot.first != shot.second) {
+            NeighborOffsets[shot.second + 1]++;
+        }
+    }
+
+    for(int i = 0; i < numberOfStations; i++) {
+        NeighborOffsets[i + 1] += NeighborOffsets[i];
+    }
+
+    NeighborIds.resize(NeighborOffsets.last());
+    Signatures.fill(0, numberOfStations);
+
+    QVector<int> next = NeighborOffsets;
+    for(const auto& shot : Shots) {
+        NeighborIds[next[shot.first]++] = shot.second;
+        Signatures[shot.first] += mix(NameHashes.at(shot.second));
+        if(shot.first != shot.second) {
+            NeighborIds[next[shot.second]++] = shot.first;
+            Signatures[shot.second] += mix(NameHashes.at(shot.first));
+        }
+    }
+
+    GraphValid.storeRelease(1);
+}
+
+/**
+ * Returns a key for the undirected shot between from and to
+ */
+quint64 cwSurveyNetworkData::shotKey(int from, int to)
+{
+    return (static_cast<quint64>(qMin(from, to)) << 32) | static_cast<quint32>(qMax(from, to));
+}
+
+/**
+ * Scrambles hash so the sum of neighbor hashes doesn't cancel out (splitmix64 finalizer)
+ */
+quint64 cwSurveyNetworkData::mix(quint64 hash)
+{
+    hash ^= hash >> 30;
+    hash *= Q_UINT64_C(0xbf58476d1ce4e5b9);
+    hash ^= hash >> 27;
+    hash *= Q_UINT64_C(0x94d049bb133111eb);
+    hash ^= hash >> 31;
+    return hash;
+}
+
 cwSurveyNetwork::cwSurveyNetwork() : data(new cwSurveyNetworkData)
 {
 
@@ -46,7 +170,12 @@ cwSurveyNetwork::~cwSurveyNetwork()
  */
 void cwSurveyNetwork::clear()
 {
-    data->Network.clear();
+    data->StationIds.clear();
+    data->Names.clear();
+    data->NameHashes.clear();
+    data->Shots.clear();
+    data->ShotKeys.clear();
+    data->invalidateGraph();
 }
 
 /**
@@ -60,23 +189,14 @@ void cwSurveyNetwork::addShot(QString from, QString to) {
 
     if(from.isEmpty() || to.isEmpty()) { return; }
 
-    if(!data->Network.contains(from)) {
-        data->Network.insert(from, QStringList());
-    }
+    int fromId = data->addStation(from);
+    int toId = data->addStation(to);
 
-    if(!data->Network.contains(to)) {
-        data->Network.insert(to, QStringList());
-    }
-
-    QStringList& fromNeighbors = data->Network[from];
-    QStringList& toNeighbors = data->Network[to];
-
-    if(!fromNeighbors.contains(to)) {
-        fromNeighbors.append(to);
-    }
-
-    if(!toNeighbors.contains(from)) {
-        toNeighbors.append(from);
+    quint64 key = cwSurveyNetworkData::shotKey(fromId, toId);
+    if(!data->ShotKeys.contains(key)) {
+        data->ShotKeys.insert(key);
+        data->Shots.append(qMakePair(fromId, toId));
+        data->invalidateGraph();
     }
 }
 
@@ -87,18 +207,115 @@ void cwSurveyNetwork::addShot(QString from, QString to) {
  */
 QStringList cwSurveyNetwork::neighbors(QString stationName) const
 {
-    stationName = stationName.toUpper();
-    return data->Network.value(stationName);
+    QStringList neighborNames;
+    const auto ids = neighborIds(stationId(stationName));
+    neighborNames.reserve(ids.size());
+    for(int id : ids) {
+        neighborNames.append(data->Names.at(id));
+    }
+    return neighborNames;
 }
 
+/**
+ * Returns all the station names in the network, ordered by station id
+ */
 QStringList cwSurveyNetwork::stations() const
 {
-    return data->Network.keys();
+    return QStringList(data->Names.toList());
 }
 
 bool cwSurveyNetwork::isEmpty() const
 {
-    return data->Network.isEmpty();
+    return data->Names.isEmpty();
+}
+
+/**
+ * Returns the number of unique stations in the network
+ */
+int cwSurveyNetwork::stationCount() const
+{
+    return data->Names.size();
+}
+
+/**
+ * Returns the number of unique shots in the network
+ */
+int cwSurveyNetwork::shotCount() const
+{
+    return data->Shots.size();
+}
+
+/**
+ * Returns the id of stationName or -1 if the station isn't in the network. Ids are dense,
+ * from 0 to stationCount() - 1, in the order that the stations were added.
+ */
+int cwSurveyNetwork::stationId(const QString &stationName) const
+{
+    return data->StationIds.value(stationName.toUpper(), -1);
+}
+
+/**
+ * Returns the upper case name of stationId
+ */
+QString cwSurveyNetwork::stationName(int stationId) const
+{
+    return data->Names.value(stationId);
+}
+
+/**
+ * Returns the ids of the neighboring stations of stationId. This doesn't allocate.
+ * If stationId is invalid, this returns an empty range.
+ */
+cwSurveyNetwork::NeighborRange cwSurveyNetwork::neighborIds(int stationId) const
+{
+    if(stationId < 0 || stationId >= data->Names.size()) {
+        return NeighborRange();
+    }
+
+    data->buildGraph();
+    const int* ids = data->NeighborIds.constData();
+    return NeighborRange(ids + data->NeighborOffsets.at(stationId),
+                         ids + data->NeighborOffsets.at(stationId + 1));
+}
+
+/**
+ * Labels the connected parts of the network. The returned vector has the component label
+ * for each station id. Labels start at 0 and are numbered in order of the lowest station id
+ * in each component. If numberOfComponents isn't null, it's set to the number of components.
+ */
+QVector<int> cwSurveyNetwork::connectedComponents(int *numberOfComponents) const
+{
+    data->buildGraph();
+
+    const int numberOfStations = stationCount();
+    QVector<int> labels(numberOfStations, -1);
+    QVector<int> stack;
+    int currentLabel = 0;
+
+    for(int start = 0; start < numberOfStations; start++) {
+        if(labels.at(start) != -1) {
+            continue;
+        }
+
+        labels[start] = currentLabel;
+        stack.append(start);
+        while(!stack.isEmpty()) {
+            int id = stack.takeLast();
+            for(int neighbor : neighborIds(id)) {
+                if(labels.at(neighbor) == -1) {
+                    labels[neighbor] = currentLabel;
+                    stack.append(neighbor);
+                }
+            }
+        }
+        currentLabel++;
+    }
+
+    if(numberOfComponents != nullptr) {
+        *numberOfComponents = currentLabel;
+    }
+
+    return labels;
 }
 
 /**
@@ -107,6 +324,12 @@ bool cwSurveyNetwork::isEmpty() const
  * A station is consider changed if it only exists in one of the networks or
  * if the stations neighbors don't match.
  *
+ * Stations that are only in n1 are returned first, then stations only in n2, then
+ * the stations in both whose neighbors have changed.
+ *
+ * Neighbors are compared with a per station hash of the neighbor names, only stations
+ * with matching hashes are compared name by name.
+ *
  * Passing two of the same networks will return an emtpy list of stations
  */
 QStringList cwSurveyNetwork::changedStations(const cwSurveyNetwork &n1, const cwSurveyNetwork &n2)
@@ -115,24 +338,69 @@ QStringList cwSurveyNetwork::changedStations(const cwSurveyNetwork &n1, const cw
         return QStringList();
     }
 
-    auto stations1 = cw::toSet(n1.stations());
-    auto stations2 = cw::toSet(n2.stations());
+    const cwSurveyNetworkData* d1 = n1.data.constData();
+    const cwSurveyNetworkData* d2 = n2.data.constData();
+    d1->buildGraph();
+    d2->buildGraph();
 
-    auto newStations1 = stations1 - stations2;
-    auto newStations2 = stations2 - stations1;
-    auto sameStations = stations1 & stations2;
+    //Map the n1 station ids to n2 station ids
+    QVector<int> toN2(d1->Names.size(), -1);
+    QVector<bool> inN1(d2->Names.size(), false);
+    for(int id1 = 0; id1 < d1->Names.size(); id1++) {
+        int id2 = d2->StationIds.value(d1->Names.at(id1), -1);
+        toN2[id1] = id2;
+        if(id2 != -1) {
+            inN1[id2] = true;
+        }
+    }
+
+    QStringList onlyIn1;
+    QStringList onlyIn2;
+    QStringList changed;
+
+    QVector<int> mappedNeighbors;
+    QVector<int> neighbors2;
+
+    for(int id1 = 0; id1 < d1->Names.size(); id1++) {
+        int id2 = toN2.at(id1);
+        if(id2 == -1) {
+            onlyIn1.append(d1->Names.at(id1));
+            continue;
+        }
+
+        const auto range1 = n1.neighborIds(id1);
+        const auto range2 = n2.neighborIds(id2);
 
-    QStringList changedStations = cw::toList(newStations1) + cw::toList(newStations2);
+        bool same = range1.size() == range2.size()
+                && d1->Signatures.at(id1) == d2->Signatures.at(id2);
 
-    for(auto station : sameStations) {
-        auto neighbors1 = cw::toSet(n1.neighbors(station));
-        auto neighbors2 = cw::toSet(n2.neighbors(station));
-        if(neighbors1 != neighbors2) {
-            changedStations.append(station);
+        if(same) {
+            //Hashes match, make sure the neighbors are really the same
+            mappedNeighbors.clear();
+            for(int neighbor : range1) {
+                mappedNeighbors.append(toN2.at(neighbor));
+            }
+            neighbors2.clear();
+            for(int neighbor : range2) {
+                neighbors2.append(neighbor);
+            }
+            std::sort(mappedNeighbors.begin(), mappedNeighbors.end());
+            std::sort(neighbors2.begin(), neighbors2.end());
+            same = mappedNeighbors == neighbors2;
+        }
+
+        if(!same) {
+            changed.append(d1->Names.at(id1));
+        }
+    }
+
+    for(int id2 = 0; id2 < d2->Names.size(); id2++) {
+        if(!inN1.at(id2)) {
+            onlyIn2.append(d2->Names.at(id2));
         }
     }
 
-    return changedStations;
+    return onlyIn1 + onlyIn2 + changed;
 }
 
 /**
@@ -140,6 +408,8 @@ QStringList cwSurveyNetwork::changedStations(const cwSurveyNetwork &n1, const cw
  */
 bool cwSurveyNetwork::operator==(const cwSurveyNetwork &other) const
 {
-    return data == other.data || data->Network == other.data->Network || changedStations(*this, other).isEmpty();
+    return data == other.data ||
+            (stationCount() == other.stationCount()
+             && shotCount() == other.shotCount()
+             && changedStations(*this, other).isEmpty());
 }
-
@@ -11,6 +11,7 @@
 
 //Qt includes
 #include <QSharedDataPointer>
+#include <QVector>
 
 //Our includes
 #include "cwGlobals.h"
@@ -20,6 +21,25 @@ class cwSurveyNetworkData;
 class CAVEWHERE_LIB_EXPORT cwSurveyNetwork
 {
 public:
+    /**
+     * The neighbors of a station, as station ids. This points into the network's
+     * adjacency array, and is only valid until the network is modified.
+     */
+    class NeighborRange {
+    public:
+        NeighborRange() {}
+        NeighborRange(const int* begin, const int* end) : Begin(begin), End(end) {}
+
+        const int* begin() const { return Begin; }
+        const int* end() const { return End; }
+        int size() const { return static_cast<int>(End - Begin); }
+        bool isEmpty() const { return Begin == End; }
+
+    private:
+        const int* Begin = nullptr;
+        const int* End = nullptr;
+    };
+
     cwSurveyNetwork();
     cwSurveyNetwork(const cwSurveyNetwork &);
     cwSurveyNetwork &operator=(const cwSurveyNetwork &);
@@ -31,6 +51,14 @@ public:
     QStringList stations() const;
     bool isEmpty() const;
 
+    int stationCount() const;
+    int shotCount() const;
+    int stationId(const QString& stationName) const;
+    QString stationName(int stationId) const;
+    NeighborRange neighborIds(int stationId) const;
+
+    QVector<int> connectedComponents(int* numberOfComponents = nullptr) const;
+
     static QStringList changedStations(const cwSurveyNetwork& n1, const cwSurveyNetwork& n2);
 
     bool operator==(const cwSurveyNetwork& other) const ;
@@ -110,9 +110,10 @@ QVariant cwSurveyNoteModel::data(const QModelIndex &index, int role) const {
 
     switch(role) {
     case ImageOriginalPathRole: {
-        //Get's the full blown note
+        //Get's the full blown note, with the icon and mipmaps, so the image provider
+        //can use a smaller source if the image is requested at a smaller size
         cwImage imagePath = Notes[row]->image();
-        return imagePathString().arg(imagePath.original());
+        return imagePathString().arg(cwImageProvider::imageId(imagePath));
     }
     case ImageIconPathRole: {
         //Get's the icon for the note
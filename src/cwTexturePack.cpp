@@ -0,0 +1,596 @@
+//Our includes
+#include "cwTexturePack.h"
+#include "cwProject.h"
+#include "cwImageProvider.h"
+#include "cwSQLManager.h"
+#include "cwDebug.h"
+
+//Qt includes
+#include <QSaveFile>
+#include <QDataStream>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QVector>
+#include <QtEndian>
+#include <QDebug>
+#include <QMutexLocker>
+
+//Std includes
+#include <algorithm>
+
+QMutex cwTexturePack::SharedPacksMutex;
+QHash<QString, QSharedPointer<const cwTexturePack>> cwTexturePack::SharedPacks;
+QMutex cwTexturePack::WriteMutex;
+QMutex cwTexturePack::GenerationMutex;
+QHash<QString, quint64> cwTexturePack::Generations;
+
+/**
+ * Maps the texture pack of projectFilename. If the pack doesn't exist, isn't valid, or doesn't
+ * match the mipmaps in the project, isOpen() returns false.
+ */
+cwTexturePack::cwTexturePack(const QString &projectFilename) :
+    File(packFilename(projectFilename))
+{
+    if(File.fileName().isEmpty() || !File.exists()) {
+        return;
+    }
+
+    if(!File.open(QIODevice::ReadOnly)) {
+        qDebug() << "Couldn't open texture pack:" << File.fileName() << File.errorString() << LOCATION;
+        return;
+    }
+
+    Memory = File.map(0, File.size());
+    if(Memory == nullptr) {
+        qDebug() << "Couldn't map texture pack:" << File.fileName() << File.errorString() << LOCATION;
+        return;
+    }
+
+    bool okay = readIndex();
+    if(!okay) {
+        qDebug() << "Texture pack is invalid:" << File.fileName() << LOCATION;
+    } else {
+        QHash<int, Entry> levels = projectLevels(projectFilename, &okay);
+        if(!okay || !matchesProject(levels)) {
+            qDebug() << "Texture pack doesn't match the project:" << File.fileName() << LOCATION;
+            okay = false;
+        }
+    }
+
+    if(!okay) {
+        File.unmap(Memory);
+        Memory = nullptr;
+        Entries.clear();
+    }
+}
+
+cwTexturePack::~cwTexturePack()
+{
+    if(Memory != nullptr) {
+        File.unmap(Memory);
+    }
+}
+
+/**
+ * Returns the DXT1 data and size of the mipmap with the database id. The data points
+ * directly into the mapped file, so it's only valid while this pack exists.
+ *
+ * Returns an empty QByteArray if the pack doesn't have the mipmap.
+ */
+QPair<QByteArray, QSize> cwTexturePack::level(int id) const
+{
+    auto iter = Entries.constFind(id);
+    if(!isOpen() || iter == Entries.constEnd()) {
+        return QPair<QByteArray, QSize>();
+    }
+
+    const char* data = reinterpret_cast<const char*>(Memory + iter->Offset);
+    return QPair<QByteArray, QSize>(QByteArray::fromRawData(data, static_cast<int>(iter->Bytes)),
+                                    iter->Size);
+}
+
+/**
+ * Returns the texture pack of projectFilename. The pack is only mapped once, every caller shares
+ * it until convert() or invalidate() replaces it. Check isOpen(), the project may not have a pack.
+ *
+ * This is thread safe.
+ */
+QSharedPointer<const cwTexturePack> cwTexturePack::shared(const QString &projectFilename)
+{
+    QMutexLocker locker(&SharedPacksMutex);
+    auto pack = SharedPacks.value(projectFilename);
+    if(pack.isNull()) {
+        pack = QSharedPointer<const cwTexturePack>::create(projectFilename);
+        SharedPacks.insert(projectFilename, pack);
+    }
+    return pack;
+}
+
+/**
+ * Stops sharing the pack of projectFilename. Readers that still have the pack keep it mapped.
+ */
+void cwTexturePack::removeShared(const QString &projectFilename)
+{
+    QMutexLocker locker(&SharedPacksMutex);
+    SharedPacks.remove(projectFilename);
+}
+
+/**
+ * Returns the filename of the texture pack, for the project. cave.cw's pack is cave.cwtex
+ */
+QString cwTexturePack::packFilename(const QString &projectFilename)
+{
+    if(projectFilename.isEmpty()) {
+        return QString();
+    }
+    return projectFilename + QStringLiteral("tex");
+}
+
+/**
+ * Writes the texture pack for projectFilename, with all the DXT1 mipmaps in the Images table.
+ * An existing pack is replaced. The pack is written to a temporary file first, so readers never
+ * see a partial pack. If invalidate() is called while the pack is written, the pack isn't
+ * committed, because it might have the old images.
+ *
+ * Returns true if the pack was written
+ */
+bool cwTexturePack::convert(const QString &projectFilename)
+{
+    QMutexLocker writeLocker(&WriteMutex);
+    const quint64 startGeneration = generation(projectFilename);
+
+    bool okay = false;
+    QHash<int, Entry> levels = projectLevels(projectFilename, &okay);
+    if(!okay) {
+        return false;
+    }
+
+    QSaveFile file(packFilename(projectFilename));
+    if(file.fileName().isEmpty() || !file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Couldn't create texture pack:" << file.fileName() << file.errorString() << LOCATION;
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    //Header is filled in once the index is written
+    stream.writeRawData(QByteArray(HeaderSize, 0).constData(), HeaderSize);
+
+    QList<int> ids = levels.keys();
+    std::sort(ids.begin(), ids.end());
+
+    QVector<QPair<int, Entry>> index;
+    if(!writeLevels(&file, projectFilename, levels, ids, &index)) {
+        file.cancelWriting();
+        return false;
+    }
+
+    quint64 indexOffset = static_cast<quint64>(file.pos());
+    writeIndex(stream, index);
+
+    file.seek(0);
+    stream.writeRawData(magic().constData(), magic().size());
+    stream << static_cast<quint32>(Version)
+           << static_cast<quint32>(index.size())
+           << indexOffset;
+
+    if(stream.status() != QDataStream::Ok) {
+        qDebug() << "Couldn't write texture pack:" << file.fileName() << file.errorString() << LOCATION;
+        file.cancelWriting();
+        return false;
+    }
+
+    //Holding the lock keeps invalidate() from running between the check and the commit
+    QMutexLocker generationLocker(&GenerationMutex);
+    if(Generations.value(projectFilename) != startGeneration) {
+        file.cancelWriting();
+        return false;
+    }
+
+    //The old pack needs to be unmapped before it's replaced on windows. Packs that were
+    //shared while committing are of the old file.
+    removeShared(projectFilename);
+    bool committed = file.commit();
+    removeShared(projectFilename);
+    return committed;
+}
+
+/**
+ * Adds the mipmaps of the project that are missing from the pack of projectFilename. If the pack
+ * is missing or isn't valid, it's converted. Checking the pack only reads the metadata of the
+ * mipmaps, and only the missing mipmaps are read and written.
+ *
+ * Returns true if the pack is up to date
+ */
+bool cwTexturePack::update(const QString &projectFilename)
+{
+    if(packFilename(projectFilename).isEmpty()) {
+        return false;
+    }
+
+    auto pack = shared(projectFilename);
+    if(pack->isOpen()) {
+        bool okay = false;
+        QHash<int, Entry> levels = projectLevels(projectFilename, &okay);
+        if(!okay) {
+            return false;
+        }
+
+        QList<int> missingIds;
+        for(auto iter = levels.constBegin(); iter != levels.constEnd(); ++iter) {
+            if(!pack->contains(iter.key())) {
+                missingIds.append(iter.key());
+            }
+        }
+
+        if(missingIds.isEmpty()) {
+            return true;
+        }
+
+        std::sort(missingIds.begin(), missingIds.end());
+
+        pack.clear();
+        if(append(projectFilename, levels, missingIds)) {
+            return true;
+        }
+    }
+
+    pack.clear();
+    return convert(projectFilename);
+}
+
+/**
+ * Removes the texture pack of projectFilename, because the images in the project have changed.
+ * Packs that are being written by convert() or update() aren't committed.
+ *
+ * Returns true if there's no longer a valid pack
+ */
+bool cwTexturePack::invalidate(const QString &projectFilename)
+{
+    QMutexLocker generationLocker(&GenerationMutex);
+    Generations[projectFilename]++;
+
+    removeShared(projectFilename);
+
+    QString filename = packFilename(projectFilename);
+    if(filename.isEmpty() || !QFile::exists(filename)) {
+        return true;
+    }
+
+    if(QFile::remove(filename)) {
+        return true;
+    }
+
+    //Mapped files can't be removed on windows, clear the magic so the pack isn't opened again
+    QFile file(filename);
+    if(file.open(QIODevice::ReadWrite)
+            && file.write(QByteArray(magic().size(), 0)) == magic().size())
+    {
+        return true;
+    }
+
+    qDebug() << "Couldn't invalidate texture pack:" << filename << file.errorString() << LOCATION;
+    return false;
+}
+
+/**
+ * Appends the levels with ids to the existing pack of projectFilename. The levels and the new
+ * index are written after the old index, then the header is updated to point at the new index.
+ * The levels that were already in the pack aren't touched, so readers that have the pack mapped
+ * can keep using it.
+ *
+ * Returns false if the pack couldn't be appended to, the caller should convert() it instead.
+ */
+bool cwTexturePack::append(const QString &projectFilename, const QHash<int, Entry>& levels, const QList<int> &ids)
+{
+    QMutexLocker writeLocker(&WriteMutex);
+    const quint64 startGeneration = generation(projectFilename);
+
+    QFile file(packFilename(projectFilename));
+    if(file.fileName().isEmpty() || !file.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    //Check the header, the pack may have been invalidated since it was shared
+    QByteArray packMagic(magic().size(), 0);
+    quint32 version = 0;
+    quint32 entryCount = 0;
+    quint64 indexOffset = 0;
+    stream.readRawData(packMagic.data(), packMagic.size());
+    stream >> version >> entryCount >> indexOffset;
+
+    const quint64 oldIndexSize = static_cast<quint64>(entryCount) * EntrySize;
+    if(stream.status() != QDataStream::Ok
+            || packMagic != magic()
+            || version != static_cast<quint32>(Version)
+            || indexOffset > static_cast<quint64>(file.size())
+            || oldIndexSize > static_cast<quint64>(file.size()) - indexOffset)
+    {
+        return false;
+    }
+
+    //The old index is copied in front of the new entries
+    file.seek(static_cast<qint64>(indexOffset));
+    QByteArray oldIndex = file.read(static_cast<qint64>(oldIndexSize));
+    if(static_cast<quint64>(oldIndex.size()) != oldIndexSize) {
+        return false;
+    }
+
+    const qint64 oldSize = file.size();
+    file.seek(oldSize);
+
+    QVector<QPair<int, Entry>> index;
+    if(!writeLevels(&file, projectFilename, levels, ids, &index)) {
+        return false;
+    }
+
+    //All the levels were skipped, leave the pack as it was
+    if(index.isEmpty()) {
+        return file.resize(oldSize);
+    }
+
+    quint64 newIndexOffset = static_cast<quint64>(file.pos());
+    stream.writeRawData(oldIndex.constData(), oldIndex.size());
+    writeIndex(stream, index);
+
+    if(stream.status() != QDataStream::Ok || !file.flush()) {
+        qDebug() << "Couldn't append to texture pack:" << file.fileName() << file.errorString() << LOCATION;
+        return false;
+    }
+
+    //Holding the lock keeps invalidate() from running between the check and the header update.
+    //An invalidated pack has been removed, or it's magic cleared, so the header isn't updated.
+    QMutexLocker generationLocker(&GenerationMutex);
+    if(Generations.value(projectFilename) != startGeneration) {
+        return false;
+    }
+
+    file.seek(magic().size());
+    stream << version
+           << static_cast<quint32>(entryCount + static_cast<quint32>(index.size()))
+           << newIndexOffset;
+
+    bool okay = stream.status() == QDataStream::Ok && file.flush();
+    removeShared(projectFilename);
+    return okay;
+}
+
+/**
+ * Reads the levels with ids out of the project and writes them to the end of file. Each level
+ * starts on a page boundary. The entries of the levels that were written are added to index.
+ * Levels that don't have valid DXT1 data are skipped.
+ *
+ * Returns false if the project couldn't be read.
+ */
+bool cwTexturePack::writeLevels(QFileDevice* file,
+                                const QString &projectFilename,
+                                const QHash<int, Entry> &levels,
+                                const QList<int> &ids,
+                                QVector<QPair<int, Entry>> *index)
+{
+    bool okay = true;
+    QString connectionName;
+
+    {
+        QSqlDatabase database = cwProject::createDatabaseConnection("cwTexturePack", projectFilename);
+        connectionName = database.connectionName();
+
+        {
+            cwSQLManager::Transaction transaction(database, cwSQLManager::ReadOnly);
+
+            QSqlQuery dataQuery(database);
+            okay = dataQuery.prepare("SELECT imageData FROM Images WHERE id = ?");
+
+            for(int id : ids) {
+                if(!okay) {
+                    break;
+                }
+
+                dataQuery.bindValue(0, id);
+                if(!dataQuery.exec() || !dataQuery.next()) {
+                    qDebug() << "Couldn't read mipmap:" << id << dataQuery.lastError() << LOCATION;
+                    okay = false;
+                    break;
+                }
+
+                QByteArray compressed = dataQuery.value(0).toByteArray();
+                dataQuery.finish();
+
+                QByteArray data = qUncompress(compressed);
+                const Entry& level = levels.value(id);
+                if(data.isEmpty() || static_cast<quint64>(data.size()) != dxt1Bytes(level.Size)) {
+                    qDebug() << "Skipping mipmap with bad DXT1 data:" << id << LOCATION;
+                    continue;
+                }
+
+                //Pad to the next page, so each level can be mapped on it's own
+                qint64 padding = (PageSize - file->pos() % PageSize) % PageSize;
+                if(file->write(QByteArray(static_cast<int>(padding), 0)) != padding) {
+                    okay = false;
+                    break;
+                }
+
+                Entry entry;
+                entry.Size = level.Size;
+                entry.Bytes = static_cast<quint32>(data.size());
+                entry.Offset = static_cast<quint64>(file->pos());
+                entry.CompressedBytes = static_cast<quint32>(compressed.size());
+                index->append(QPair<int, Entry>(id, entry));
+
+                if(file->write(data) != data.size()) {
+                    okay = false;
+                    break;
+                }
+            }
+        }
+        database.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    if(!okay) {
+        qDebug() << "Couldn't write texture pack levels:" << file->fileName() << file->errorString() << LOCATION;
+    }
+
+    return okay;
+}
+
+/**
+ * Writes the index entries, see the file layout in the class documentation
+ */
+void cwTexturePack::writeIndex(QDataStream &stream, const QVector<QPair<int, Entry>> &index)
+{
+    for(const auto& item : index) {
+        const Entry& entry = item.second;
+        stream << static_cast<qint32>(item.first)
+               << static_cast<qint32>(entry.Size.width())
+               << static_cast<qint32>(entry.Size.height())
+               << entry.Bytes
+               << entry.Offset
+               << entry.CompressedBytes;
+    }
+}
+
+/**
+ * Returns the DXT1 mipmaps in the project, by id. Only the Size and CompressedBytes of the
+ * entries are set. This only reads the metadata, not the blobs. okay is set to false if the
+ * project couldn't be read.
+ */
+QHash<int, cwTexturePack::Entry> cwTexturePack::projectLevels(const QString &projectFilename, bool *okay)
+{
+    QHash<int, Entry> levels;
+    *okay = false;
+
+    //Don't create an empty project, for a pack that was left behind
+    if(!QFile::exists(projectFilename)) {
+        return levels;
+    }
+
+    QString connectionName;
+
+    {
+        QSqlDatabase database = cwProject::createDatabaseConnection("cwTexturePack", projectFilename);
+        connectionName = database.connectionName();
+
+        {
+            cwSQLManager::Transaction transaction(database, cwSQLManager::ReadOnly);
+
+            QSqlQuery query(database);
+            query.setForwardOnly(true);
+            query.prepare("SELECT id, width, height, length(imageData) FROM Images WHERE type = ?");
+            query.bindValue(0, cwImageProvider::dxt1GzExtension());
+            *okay = query.exec();
+            if(!*okay) {
+                qDebug() << "Couldn't query images for texture pack:" << query.lastError() << LOCATION;
+            }
+
+            while(*okay && query.next()) {
+                Entry level;
+                level.Size = QSize(query.value(1).toInt(), query.value(2).toInt());
+                level.CompressedBytes = query.value(3).toUInt();
+                levels.insert(query.value(0).toInt(), level);
+            }
+        }
+        database.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    return levels;
+}
+
+/**
+ * Returns true if every level in the pack is in projectLevels, with the same size and compressed
+ * size. The project may have levels that aren't in the pack, they were added since the pack was
+ * written.
+ */
+bool cwTexturePack::matchesProject(const QHash<int, Entry> &projectLevels) const
+{
+    for(auto iter = Entries.constBegin(); iter != Entries.constEnd(); ++iter) {
+        auto projectLevel = projectLevels.constFind(iter.key());
+        if(projectLevel == projectLevels.constEnd()
+                || projectLevel->Size != iter->Size
+                || projectLevel->CompressedBytes != iter->CompressedBytes)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Returns the number of times the pack of projectFilename has been invalidated
+ */
+quint64 cwTexturePack::generation(const QString &projectFilename)
+{
+    QMutexLocker locker(&GenerationMutex);
+    return Generations.value(projectFilename);
+}
+
+/**
+ * Reads and checks the header and index in the mapped file. Every level must be inside of
+ * the file and have the size of a DXT1 image, so the levels can be passed to OpenGL safely.
+ */
+bool cwTexturePack::readIndex()
+{
+    const quint64 fileSize = static_cast<quint64>(File.size());
+    if(fileSize < static_cast<quint64>(HeaderSize)) {
+        return false;
+    }
+
+    const QByteArray packMagic = magic();
+    if(QByteArray::fromRawData(reinterpret_cast<const char*>(Memory), packMagic.size()) != packMagic) {
+        return false;
+    }
+
+    const uchar* header = Memory + packMagic.size();
+    quint32 version = qFromLittleEndian<quint32>(header);
+    quint64 entryCount = qFromLittleEndian<quint32>(header + 4);
+    quint64 indexOffset = qFromLittleEndian<quint64>(header + 8);
+
+    if(version != static_cast<quint32>(Version)
+            || indexOffset > fileSize
+            || entryCount * EntrySize > fileSize - indexOffset)
+    {
+        return false;
+    }
+
+    Entries.reserve(static_cast<int>(entryCount));
+    for(quint64 i = 0; i < entryCount; i++) {
+        const uchar* entryData = Memory + indexOffset + i * EntrySize;
+
+        int id = qFromLittleEndian<qint32>(entryData);
+        Entry entry;
+        entry.Size = QSize(qFromLittleEndian<qint32>(entryData + 4),
+                           qFromLittleEndian<qint32>(entryData + 8));
+        entry.Bytes = qFromLittleEndian<quint32>(entryData + 12);
+        entry.Offset = qFromLittleEndian<quint64>(entryData + 16);
+        entry.CompressedBytes = qFromLittleEndian<quint32>(entryData + 24);
+
+        if(entry.Size.width() <= 0 || entry.Size.height() <= 0
+                || entry.Offset % PageSize != 0
+                || entry.Offset > indexOffset
+                || entry.Bytes > indexOffset - entry.Offset
+                || entry.Bytes != dxt1Bytes(entry.Size))
+        {
+            return false;
+        }
+
+        Entries.insert(id, entry);
+    }
+
+    return true;
+}
+
+/**
+ * Returns the number of bytes in a DXT1 image of size. Each 4x4 block is 8 bytes.
+ */
+quint64 cwTexturePack::dxt1Bytes(QSize size)
+{
+    quint64 blocksWide = static_cast<quint64>(qMax(1, (size.width() + 3) / 4));
+    quint64 blocksHigh = static_cast<quint64>(qMax(1, (size.height() + 3) / 4));
+    return blocksWide * blocksHigh * 8;
+}
@@ -0,0 +1,139 @@
+#ifndef CWTEXTUREPACK_H
+#define CWTEXTUREPACK_H
+
+//Our includes
+#include "cwGlobals.h"
+
+//Qt includes
+#include <QString>
+#include <QByteArray>
+#include <QSize>
+#include <QPair>
+#include <QHash>
+#include <QFile>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QVector>
+#include <QList>
+#include <QDataStream>
+
+/**
+ * @brief The cwTexturePack class is a memory mapped sidecar file that holds the DXT1 mipmaps
+ * of a project
+ *
+ * Mipmaps in the project file are zlib compressed blobs, that need to be read out of sqlite
+ * and qUncompress'ed before they can be uploaded. The texture pack stores the same mipmaps
+ * uncompressed, so level() can return the mapped memory directly, without reading or copying.
+ *
+ * The pack lives next to the project file, see packFilename(). It's optional, cwProject calls
+ * update() after the project is saved, which appends the mipmaps that are missing from the pack.
+ * cwImageDatabase calls invalidate() when images are updated or removed, so a pack never holds
+ * stale mipmaps. Images added since the last save aren't in the pack, and are loaded from the
+ * project.
+ *
+ * The index holds each level's size and the size of it's compressed blob in the project. A pack
+ * is only opened if every level still matches the project, so a pack left behind by another
+ * project, or a project changed without invalidate(), isn't used.
+ *
+ * Readers should use shared(), so the pack is only mapped once per project.
+ *
+ * File layout, all integers are little endian:
+ * - Header: magic "CWTEXPCK", version (uint32), entry count (uint32), index offset (uint64)
+ * - Level data, each level starts on a page boundary (PageSize)
+ * - Index: for each level, id (int32), width (int32), height (int32), size (uint32), offset (uint64),
+ *   compressed size in the project (uint32)
+ *
+ * Appended levels and their new index are written after the old index, and the header is updated
+ * last. Levels that are already in the pack never move, so mapped packs stay valid.
+ */
+class CAVEWHERE_LIB_EXPORT cwTexturePack
+{
+public:
+    cwTexturePack(const QString& projectFilename);
+    cwTexturePack(const cwTexturePack&) = delete;
+    cwTexturePack& operator=(const cwTexturePack&) = delete;
+    ~cwTexturePack();
+
+    bool isOpen() const;
+    int count() const;
+    bool contains(int id) const;
+    QPair<QByteArray, QSize> level(int id) const;
+
+    static QSharedPointer<const cwTexturePack> shared(const QString& projectFilename);
+
+    static QString packFilename(const QString& projectFilename);
+    static bool convert(const QString& projectFilename);
+    static bool update(const QString& projectFilename);
+    static bool invalidate(const QString& projectFilename);
+
+    static const int PageSize = 4096;
+
+private:
+    class Entry {
+    public:
+        QSize Size;
+        quint32 Bytes = 0;
+        quint64 Offset = 0;
+        quint32 CompressedBytes = 0;
+    };
+
+    QFile File;
+    uchar* Memory = nullptr;
+    QHash<int, Entry> Entries;
+
+    //Packs that have been opened by shared(), by project filename
+    static QMutex SharedPacksMutex;
+    static QHash<QString, QSharedPointer<const cwTexturePack>> SharedPacks;
+
+    //Only one pack is written at a time
+    static QMutex WriteMutex;
+
+    //Incremented by invalidate(), so packs that were written from stale images aren't committed
+    static QMutex GenerationMutex;
+    static QHash<QString, quint64> Generations;
+
+    bool readIndex();
+    bool matchesProject(const QHash<int, Entry>& projectLevels) const;
+
+    static bool append(const QString& projectFilename, const QHash<int, Entry>& levels, const QList<int>& ids);
+    static bool writeLevels(QFileDevice* file, const QString& projectFilename,
+                            const QHash<int, Entry>& levels, const QList<int>& ids,
+                            QVector<QPair<int, Entry>>* index);
+    static void writeIndex(QDataStream& stream, const QVector<QPair<int, Entry>>& index);
+    static QHash<int, Entry> projectLevels(const QString& projectFilename, bool* okay);
+    static quint64 generation(const QString& projectFilename);
+
+    static void removeShared(const QString& projectFilename);
+    static quint64 dxt1Bytes(QSize size);
+
+    static const int Version = 2;
+    static const int HeaderSize = 24;
+    static const int EntrySize = 28;
+    static QByteArray magic() { return QByteArrayLiteral("CWTEXPCK"); }
+};
+
+/**
+ * Returns true if the pack is mapped and it's index is valid
+ */
+inline bool cwTexturePack::isOpen() const
+{
+    return Memory != nullptr;
+}
+
+/**
+ * Returns the number of mipmap levels in the pack
+ */
+inline int cwTexturePack::count() const
+{
+    return Entries.size();
+}
+
+/**
+ * Returns true if the pack has the mipmap with the database id
+ */
+inline bool cwTexturePack::contains(int id) const
+{
+    return Entries.contains(id);
+}
+
+#endif // CWTEXTUREPACK_H
@@ -14,6 +14,7 @@
 #include "cwOpenGLUtils.h"
 #include "cwOpenGLSettings.h"
 #include "cwImageDatabase.h"
+#include "cwTexturePack.h"
 
 //Qt includes
 #include <QDebug>
@@ -49,15 +50,34 @@ QFuture<cwTextureUploadTask::UploadResult> cwTextureUploadTask::mipmaps() const
 
         auto loadDXT1Mipmap = [&imageProvidor, image]() {
             QList< QPair< QByteArray, QSize > > mipmaps;
-            //Load all the mipmaps
-            foreach(int imageId, image->mipmaps()) {
-                auto imageData = imageProvidor.data(imageId);
-                imageProvidor.data(imageId, true);
+            //Load all the mipmaps, in one transaction
+            for(const cwImageData& imageData : imageProvidor.data(image->mipmaps())) {
                 mipmaps.append(QPair< QByteArray, QSize >(imageData.data(), imageData.size()));
             }
             return mipmaps;
         };
 
+        //Mipmaps in the texture pack don't need to be read or uncompressed, they're uploaded
+        //straight from the mapped file
+        auto loadPackedDXT1Mipmap = [projectFile, image, &results]() {
+            auto pack = cwTexturePack::shared(projectFile);
+            if(!pack->isOpen()) {
+                return false;
+            }
+
+            QList< QPair< QByteArray, QSize > > mipmaps;
+            for(int id : image->mipmaps()) {
+                if(!pack->contains(id)) {
+                    return false;
+                }
+                mipmaps.append(pack->level(id));
+            }
+
+            results.mipmaps = mipmaps;
+            results.pack = pack;
+            return true;
+        };
+
         auto loadRGB = [&imageProvidor, image]()->QList< QPair< QByteArray, QSize > > {
             auto imageData = imageProvidor.data(image->original());
 
@@ -83,7 +103,9 @@ QFuture<cwTextureUploadTask::UploadResult> cwTextureUploadTask::mipmaps() const
             break;
         case DXT1Mipmaps:
             results.scaleTexCoords = imageProvidor.scaleTexCoords(*image);
-            results.mipmaps = loadDXT1Mipmap();
+            if(!loadPackedDXT1Mipmap()) {
+                results.mipmaps = loadDXT1Mipmap();
+            }
             break;
         default:
             Q_ASSERT(false);
@@ -11,12 +11,14 @@
 //Our includes
 #include "cwImage.h"
 #include "cwGlobals.h"
+class cwTexturePack;
 
 //Qt includes
 #include <QOpenGLFunctions>
 #include <QOpenGLBuffer>
 #include <QVector2D>
 #include <QFuture>
+#include <QSharedPointer>
 class QOpenGLContext;
 class QSurface;
 
@@ -35,6 +37,9 @@ public:
         QList< QPair< QByteArray, QSize > > mipmaps;
         QVector2D scaleTexCoords;
         Format type = Unknown;
+
+        //Keeps the texture pack mapped, when mipmaps point into it
+        QSharedPointer<const cwTexturePack> pack;
     };
 
     explicit cwTextureUploadTask();
@@ -5,13 +5,55 @@
 **
 **************************************************************************/
 
+//Our includes
 #include "cwTriangulateInData.h"
 
+//Qt includes
+#include <QDataStream>
+#include <QCryptographicHash>
+
 cwTriangulateInData::cwTriangulateInData() :
     Data(new PrivateData())
 {
 }
 
+/**
+ * Returns a hash of everything that's used to triangulate the scrap: the note image's ids,
+ * the resolution, the outline, the stations (with their resolved positions), the note transform,
+ * the type, and the leads.
+ *
+ * The hash is stable between runs, so it can be stored in the project file. If two
+ * cwTriangulateInData have the same hash, triangulating them gives the same cwTriangulatedData.
+ */
+QByteArray cwTriangulateInData::hash() const
+{
+    QByteArray buffer;
+    QDataStream stream(&buffer, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    //Bumped when the triangulation changes, so cached geometry from older versions isn't used
+    const int triangulationVersion = 2;
+    stream << triangulationVersion;
+
+    const cwImage& image = Data->NoteImage;
+    stream << image.original() << image.icon() << image.mipmaps()
+           << image.originalSize() << image.originalDotsPerMeter();
 
+    stream << Data->DotPerMeter;
+    stream << Data->Outline;
 
+    stream << Data->Stations.size();
+    for(const cwTriangulateStation& station : Data->Stations) {
+        stream << station.name() << station.notePosition() << station.position();
+    }
 
+    stream << Data->NoteTransform.scale() << Data->NoteTransform.northUp();
+    stream << static_cast<int>(Data->Type);
+
+    stream << Data->Leads.size();
+    for(const cwLead& lead : Data->Leads) {
+        stream << lead.positionOnNote();
+    }
+
+    return QCryptographicHash::hash(buffer, QCryptographicHash::Sha1);
+}
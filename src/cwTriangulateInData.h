@@ -11,6 +11,7 @@
 //Qt includes
 #include <QSharedData>
 #include <QPolygonF>
+#include <QByteArray>
 
 //Our includes
 #include "cwImage.h"
@@ -45,10 +46,12 @@ public:
     QList<cwLead> leads() const;
     void setLeads(QList<cwLead> leads);
 
+    QByteArray hash() const;
+
 private:
     class PrivateData : public QSharedData {
     public:
-        PrivateData() : Type(cwScrap::Plan) {}
+        PrivateData() : DotPerMeter(0.0), Type(cwScrap::Plan) {}
 
         cwImage NoteImage;
         double DotPerMeter;
@@ -11,6 +11,7 @@
 #include "cwDebug.h"
 #include "utils/cwTriangulate.h"
 #include "cwAsyncFuture.h"
+#include "cwTriangulatedDataCache.h"
 
 //Utils includes
 #include "utils/Forsyth.h"
@@ -45,15 +46,32 @@ QList<QFuture<cwTriangulatedData>> cwTriangulateTask::triangulate() const
     std::function<QFuture<cwTriangulatedData> (const cwTriangulateInData&)> triangulateScrap
             = [projectFilename, format](const cwTriangulateInData& scrap)->QFuture<cwTriangulatedData>
     {
-        auto cropFuture = cropScrap(scrap, projectFilename, format);
+        //Unchanged scraps load their geometry from the project, instead of recalculating it
+        auto cacheFuture = QtConcurrent::run([scrap, projectFilename, format]()
+        {
+            return cwTriangulatedDataCache(projectFilename).find(scrap.hash(), format);
+        });
 
-        return AsyncFuture::observe(cropFuture)
-                .subscribe([cropFuture, scrap]()
+        return AsyncFuture::observe(cacheFuture)
+                .subscribe([cacheFuture, scrap, projectFilename, format]()->QFuture<cwTriangulatedData>
         {
-            return QtConcurrent::run([scrap, cropFuture]()
+            cwTriangulatedData cachedData = cacheFuture.result();
+            if(!cachedData.isNull()) {
+                return AsyncFuture::completed(cachedData);
+            }
+
+            auto cropFuture = cropScrap(scrap, projectFilename, format);
+
+            return AsyncFuture::observe(cropFuture)
+                    .subscribe([cropFuture, scrap, projectFilename, format]()
             {
-                return triangulateGeometry(scrap, cropFuture.result());
-            });
+                return QtConcurrent::run([scrap, cropFuture, projectFilename, format]()
+                {
+                    cwTriangulatedData data = triangulateGeometry(scrap, cropFuture.result(), format);
+                    cwTriangulatedDataCache(projectFilename).insert(scrap.hash(), format, data);
+                    return data;
+                });
+            }).future();
         }).future();
     };
 
@@ -76,7 +94,8 @@ QFuture<cwTrackedImagePtr> cwTriangulateTask::cropScrap(const cwTriangulateInDat
 }
 
 cwTriangulatedData cwTriangulateTask::triangulateGeometry(const cwTriangulateInData &scrap,
-                                                                   cwTrackedImagePtr croppedImage)
+                                                                   cwTrackedImagePtr croppedImage,
+                                                                   cwTextureUploadTask::Format format)
 {
     QRectF bounds = scrap.outline().boundingRect();
 
@@ -92,8 +111,10 @@ cwTriangulatedData cwTriangulateTask::triangulateGeometry(const cwTriangulateInD
     //Triangulate the quads (this will update the outputs data)
     cwTriangulatedData triangleData = createTriangles(pointGrid, gridPointsInScrap, quads, scrap);
 
-    //Create the matrix that converts the normalized note coords to normalized scrap coords
-    QMatrix4x4 toLocal = mapToScrapCoordinates(bounds);
+    //Create the matrix that converts the normalized note coords to normalized scrap coords.
+    //The cropped image is rounded to dxt1 blocks, so this uses the area that was actually cropped
+    QRectF croppedBounds = cwCropImageTask::normalizedCropArea(bounds, scrap.noteImage(), format);
+    QMatrix4x4 toLocal = mapToScrapCoordinates(croppedBounds);
 
     //Convert the normalized points to local note points
     QVector<QVector3D> localNotePoints = mapToLocalNoteCoordinates(toLocal, triangleData.points());
@@ -101,14 +122,15 @@ cwTriangulatedData cwTriangulateTask::triangulateGeometry(const cwTriangulateInD
     //Create the texture coordinates
     QVector<QVector2D> texCoords = mapTexCoordinates(localNotePoints);
 
+    //Calculate the morphing data once, it's shared between the points and the leads
+    MorphContext morphContext = createMorphContext(scrap, toLocal, *croppedImage);
+
     //Morph the points for the scrap
-    QVector<QVector3D> points = morphPoints(triangleData.points(), scrap, toLocal, *croppedImage);
+    QVector<QVector3D> points = morphPoints(triangleData.points(), morphContext);
 
     //Morph the lead points for the scrap
     QVector<QVector3D> leadPoints = morphPoints(leadPositionToVector3D(scrap.leads()),
-                                                scrap,
-                                                toLocal,
-                                                *croppedImage);
+                                                morphContext);
 
 
     cwTriangulatedData outputData;
@@ -628,107 +650,66 @@ QVector<QVector2D> cwTriangulateTask::mapTexCoordinates(const QVector<QVector3D>
 }
 
 /**
-  \brief This function morphs the points so the texture image aligns with the lineplot
-  */
-QVector<QVector3D> cwTriangulateTask::morphPoints(const QVector<QVector3D>& notePoints,
-                                                  const cwTriangulateInData& scrapData,
-                                                  const QMatrix4x4& toLocal,
-                                                  const cwImage& croppedImage) {
-
-    /**
-      This sorts scrapData stations if the scrap is in running profile mode.
-
-      This returns a list of sorted stations base on stations position in the x-axis
-      */
-    auto sortScrapStations = [&scrapData]() {
-        QList<cwTriangulateStation> stations = scrapData.stations();
-        if(scrapData.type() == cwScrap::RunningProfile) {
-            //This assumes that up on the page is up for the scrap
-            auto profileCompare = [&scrapData](const cwTriangulateStation& left, const cwTriangulateStation& right)->bool {
-                QMatrix4x4 rotation = scrapData.noteTransform().matrix();
-
-                QPointF leftPoint = rotation.map(left.notePosition());
-                QPointF rightPoint = rotation.map(right.notePosition());
-
-                return leftPoint.x() < rightPoint.x();
-            };
+  \brief Creates the morph context for a scrap
 
-            //Sort the stations by note position
-            std::sort(stations.begin(), stations.end(), profileCompare);
-        }
-        return stations;
-    };
+  This sorts the scrap's stations, if the scrap is in running profile mode, and calculates
+  everything that's constant for the scrap, such that morphPoints() only needs to do per
+  point work. The context is shared between the grid points and the lead points.
+  */
+cwTriangulateTask::MorphContext cwTriangulateTask::createMorphContext(const cwTriangulateInData &scrapData,
+                                                                      const QMatrix4x4 &toLocal,
+                                                                      const cwImage &croppedImage)
+{
+    MorphContext context;
+    context.Type = scrapData.type();
 
-    /**
-     * Given a list of stations this finds the stations to use as control points in the morphing.
-     *
-     * If scrapData is running profile this will use two stations that notePoint.x() falls between.
-     * Those two stations are returned. The notePoint.x() will be rotated to the northUp().
-     *
-     * If scrapData is plan this will simply return stations.
-     */
-    auto findStationsToUseForMorphing = [&scrapData](QList<cwTriangulateStation> stations, QVector3D notePoint)->QList<cwTriangulateStation>
-    {
-        if(scrapData.type() == cwScrap::RunningProfile) {
+    QSize imageSize = croppedImage.originalSize();
+    double metersPerDot = 1.0 / (double)scrapData.noteImageResolution();
 
-            //Need to have a least two stations
-            if(stations.size() < 2) {
-                return QList<cwTriangulateStation>();
-            }
+    //For right now try to map
+    QMatrix4x4 toPixels;
+    toPixels.scale(imageSize.width(), imageSize.height(), 1.0);
 
-            //Look for the section for the notePoint, returns the stations we want to warp between
-            auto compare = [&scrapData](const cwTriangulateStation& station, const QVector3D& point)->bool {
-                QMatrix4x4 rotation = scrapData.noteTransform().matrix();
+    QMatrix4x4 toMetersOnPaper;
+    toMetersOnPaper.scale(metersPerDot, metersPerDot, 1.0);
 
-                QPointF left = rotation.map(station.notePosition());
-                QVector3D right = rotation.map(point);
+    QMatrix4x4 toMetersInCave = scrapData.noteTransform().matrix();
 
-                return left.x() < right.x();
-            };
+    context.ToWorldCoords = toMetersInCave * toMetersOnPaper * toPixels * toLocal;
 
-            auto foundStation = std::lower_bound(stations.begin(), stations.end(), notePoint, compare);
+    QList<cwTriangulateStation> stations = scrapData.stations();
 
-            if(stations.size() >= 2) {
-                if(foundStation == stations.end()) {
-                    foundStation = foundStation - 1; //To from the end
-                } else if(foundStation == stations.begin()) {
-                    foundStation = foundStation + 1;
-                }
-            } else {
-                foundStation = stations.begin();
-            }
+    if(context.Type == cwScrap::RunningProfile) {
+        //This assumes that up on the page is up for the scrap
+        context.NoteRotation = scrapData.noteTransform().matrix();
 
-            QList<cwTriangulateStation> profileStations;
-            profileStations.append(*(foundStation - 1));
-            profileStations.append(*(foundStation));
-            return profileStations;
+        //Sort the stations by note position, the rotated x is only calculated once per station
+        QVector<QPair<double, cwTriangulateStation>> sortedStations;
+        sortedStations.reserve(stations.size());
+        for(const cwTriangulateStation& station : stations) {
+            double x = context.NoteRotation.map(station.notePosition()).x();
+            sortedStations.append(QPair<double, cwTriangulateStation>(x, station));
         }
 
-//        //Figure out which stations are visible to this point
-//        stations = stationsVisibleToPoint(notePoints[i],
-//                                          scrapData.stations(),
-//                                          scrapData.outline());
-
-
-        return stations;
-    };
-
-    /**
-      When the scrapData is a plan type, this function returns a identity matrix
-
-      When in running profile mode, this returns a view matrix of the shot between the first
-      and last station in stations. This view matrix is in a profile view, where the shot
-      is aligned with the x-axis.
-     */
-    auto calculateViewMatrix = [&scrapData](const QList<cwTriangulateStation>& stations) {
-        if(scrapData.type() == cwScrap::RunningProfile) {
-            //Calculate the rotation matrix for the profile for this point (could be looked up)
-            if(stations.size() < 2) {
-                return QMatrix4x4();
-            }
+        std::sort(sortedStations.begin(), sortedStations.end(),
+                  [](const QPair<double, cwTriangulateStation>& left,
+                  const QPair<double, cwTriangulateStation>& right)
+        {
+            return left.first < right.first;
+        });
+
+        context.ProfileX.reserve(sortedStations.size());
+        context.Stations.reserve(sortedStations.size());
+        for(const auto& sortedStation : sortedStations) {
+            context.ProfileX.append(sortedStation.first);
+            context.Stations.append(sortedStation.second);
+        }
 
-            QVector3D fromPostion = stations.first().position();
-            QVector3D toPosition = stations.last().position();
+        //Calculate the view matrix for each shot between two neighboring stations
+        context.ProfileViews.resize(context.Stations.size());
+        for(int i = 1; i < context.Stations.size(); i++) {
+            QVector3D fromPostion = context.Stations.at(i - 1).position();
+            QVector3D toPosition = context.Stations.at(i).position();
 
             //These are rotation offset, so we do the rotation around the from station's position
             QMatrix4x4 translateForward;
@@ -739,157 +720,81 @@ QVector<QVector3D> cwTriangulateTask::morphPoints(const QVector<QVector3D>& note
 
             QMatrix4x4 viewRotationMatrix = cwScrap::toProfileRotation(fromPostion, toPosition);
 
-            QMatrix4x4 viewMatrix = translateForward * viewRotationMatrix * translateBackward;
-
-            return viewMatrix;
+            context.ProfileViews[i] = translateForward * viewRotationMatrix * translateBackward;
         }
-        return QMatrix4x4();
-    };
-
-
-    QSize imageSize = croppedImage.originalSize();
-    double metersPerDot = 1.0 / (double)scrapData.noteImageResolution();
-
-    //For right now try to map
-    QMatrix4x4 toPixels;
-    toPixels.scale(imageSize.width(), imageSize.height(), 1.0);
-
-    QMatrix4x4 toMetersOnPaper;
-    toMetersOnPaper.scale(metersPerDot, metersPerDot, 1.0);
-
-    QMatrix4x4 toMetersInCave = scrapData.noteTransform().matrix();
-
-    QMatrix4x4 toWorldCoords = toMetersInCave * toMetersOnPaper * toPixels * toLocal;
-
-    QList<cwTriangulateStation> stations = sortScrapStations();
-
-    QVector<QVector3D> points;
-    points.reserve(notePoints.size());
-    points.resize(notePoints.size());
-    for(int i = 0; i < notePoints.size(); i++) {
-
-        //Find the stations we want to use the morph the current note point
-        QList<cwTriangulateStation> stationsUsedToMorph = findStationsToUseForMorphing(stations, notePoints[i]);
-
-        //Find the view that we want to use for the morphing
-        QMatrix4x4 viewMatrix = calculateViewMatrix(stationsUsedToMorph);
-
-        //Based on the visible stations morph point into the scene coords
-        points[i] = morphPoint(stationsUsedToMorph, toWorldCoords, viewMatrix, notePoints[i]);
+    } else {
+        context.Stations = stations;
     }
 
-    return points;
+    return context;
 }
 
 /**
-  \brief Get's a list of station that are visible to the point.
-
-  This shot a ray between point and each station.  If the ray interects any of the
-  polygon's lines, then the station isn't added to the list visble points
-
-  The point should be in normalize note cooridanets.  This isn't local note coordinates
+  \brief This function morphs the points so the texture image aligns with the lineplot
   */
-QList<cwTriangulateStation> cwTriangulateTask::stationsVisibleToPoint(const QVector3D &point,
-                                                                      const QList<cwTriangulateStation> &stations,
-                                                                      const QPolygonF &scrapOutline){
-
-    QList<QLineF> polygonLines;
-    //For all the lines it the polygon
-    int isClosed = (int)(!scrapOutline.isClosed());
-    int numPoints = scrapOutline.size() + isClosed;
-    for(int i = 0; i < numPoints - 1; i++) {
-        int p1Index = i % scrapOutline.size();
-        int p2Index = (i + 1) % scrapOutline.size();
-
-        QLineF line(scrapOutline[p1Index], scrapOutline[p2Index]);
-        polygonLines.append(line);
-    }
-
-    QList<cwTriangulateStation> visibleStations;
-
-    QPointF point2D = point.toPointF();
-    double errorTolerance = 1.0e-6;
-
-    //For each station
-    foreach(cwTriangulateStation station, stations) {
-
-        //Create a line between the point and the station
-        QLineF ray(point2D,station.notePosition());
-
-        //The flag if the station should be added
-        bool shouldAdd = true;
-
-        //Do all the intersections
-        QPointF intersectionPoint;
-        foreach(QLineF line, polygonLines) {
-            if(ray.intersects(line, &intersectionPoint) == QLineF::BoundedIntersection) {
-                double percentX = fabs(intersectionPoint.x() - point2D.x()) / point2D.x();
-                double percentY = fabs(intersectionPoint.y() - point2D.y()) / point2D.y();
+QVector<QVector3D> cwTriangulateTask::morphPoints(const QVector<QVector3D>& notePoints,
+                                                  const MorphContext& context) {
 
-                if(percentX >= errorTolerance || percentY >= errorTolerance) {
-                    shouldAdd = false;
-                    break;
-                }
-            }
-        }
+    const QList<cwTriangulateStation>& stations = context.Stations;
 
-        if(shouldAdd) {
-            visibleStations.append(station);
+    /**
+     * Finds the stations to use as control points in the morphing.
+     *
+     * If the scrap is running profile this will use two stations that notePoint.x() falls between.
+     * The index of second station is returned. The notePoint.x() will be rotated to the northUp().
+     *
+     * If the scrap is plan this will return -1, and all the stations are used.
+     */
+    auto findProfileStation = [&context, &stations](const QVector3D& notePoint)->int
+    {
+        //Look for the section for the notePoint, returns the stations we want to warp between
+        double pointX = context.NoteRotation.map(notePoint).x();
+        auto foundX = std::lower_bound(context.ProfileX.begin(), context.ProfileX.end(), pointX);
+        int found = static_cast<int>(foundX - context.ProfileX.begin());
+
+        if(found == stations.size()) {
+            found = found - 1; //To from the end
+        } else if(found == 0) {
+            found = found + 1;
         }
-    }
-
-    //If the point has no visibleStation, we need to figure out which station are
-    //closest and uses those,  Uses the shot intersection?
-    if(visibleStations.size() < 2 && !stations.isEmpty()) {
-
-        //For debugging for now, this should be really obvious that this code is
-        //wrong
-
-        visibleStations.clear();
 
-        //The two closest stations
-        cwTriangulateStation station1;
-        cwTriangulateStation station2;
-        double distance1 = std::numeric_limits<double>::max();
-        double distance2 = distance1;
+        return found;
+    };
 
-        foreach(cwTriangulateStation station, stations) {
-            double length = QLineF(point2D, station1.notePosition()).length();
+    QVector<QVector3D> points;
+    points.reserve(notePoints.size());
+    points.resize(notePoints.size());
 
-            //Heristic
-            if(station1.name().isEmpty()) {
-                distance1 = length;
-                station1 = station;
-                continue;
+    if(context.Type == cwScrap::RunningProfile) {
+        //Need to have a least two stations
+        if(stations.size() < 2) {
+            for(int i = 0; i < notePoints.size(); i++) {
+                points[i] = morphPoint(QList<cwTriangulateStation>(), context.ToWorldCoords, QMatrix4x4(), notePoints[i]);
             }
+            return points;
+        }
 
-            if(length < distance1) {
-                //Push distance1 to distance2
-                distance2 = distance1;
-                station2 = station1;
-
-                distance1 = length;
-                station1 = station;
-                continue;
-            }
+        QList<cwTriangulateStation> profileStations;
+        profileStations.reserve(2);
+        for(int i = 0; i < notePoints.size(); i++) {
+            int found = findProfileStation(notePoints[i]);
 
-            if(station2.name().isEmpty()) {
-                distance2 = length;
-                station2 = station;
-                continue;
-            }
+            //Find the stations we want to use the morph the current note point
+            profileStations.clear();
+            profileStations.append(stations.at(found - 1));
+            profileStations.append(stations.at(found));
 
-            if(length < distance2) {
-                distance2 = length;
-                station2 = station;
-            }
+            //Based on the stations morph point into the scene coords
+            points[i] = morphPoint(profileStations, context.ToWorldCoords, context.ProfileViews.at(found), notePoints[i]);
+        }
+    } else {
+        QMatrix4x4 identity;
+        for(int i = 0; i < notePoints.size(); i++) {
+            points[i] = morphPoint(stations, context.ToWorldCoords, identity, notePoints[i]);
         }
-
-        visibleStations.append(station1);
-        visibleStations.append(station1);
     }
 
-    return visibleStations;
+    return points;
 }
 
 /**
@@ -118,6 +118,27 @@ private:
         QList<Quad> PartialQuads;
     };
 
+    /**
+      Per scrap data that's shared by all the morphing passes (grid points and leads)
+
+      This is calculated once per scrap, instead of once per morphed point.
+      */
+    class MorphContext {
+    public:
+        cwScrap::ScrapType Type;
+        QMatrix4x4 ToWorldCoords;
+
+        //Sorted by ProfileX, if the scrap is a running profile
+        QList<cwTriangulateStation> Stations;
+
+        //Running profile only, the station's x in north up note coordinates
+        QMatrix4x4 NoteRotation;
+        QVector<double> ProfileX;
+
+        //Running profile only, ProfileViews[i] is the view for the shot between Stations[i-1] and Stations[i]
+        QVector<QMatrix4x4> ProfileViews;
+    };
+
     //Inputs
     QList<cwTriangulateInData> Scraps;
     QString ProjectFilename;
@@ -132,7 +153,8 @@ private:
                                                 cwTextureUploadTask::Format format);
 
     static cwTriangulatedData triangulateGeometry(const cwTriangulateInData& scrap,
-                                                            cwTrackedImagePtr croppedImage);
+                                                            cwTrackedImagePtr croppedImage,
+                                                            cwTextureUploadTask::Format format);
 
     static PointGrid createPointGrid(QRectF bounds, const cwTriangulateInData& scrapData);
     static QSet<int> pointsInPolygon(const PointGrid& grid, const QPolygonF& polygon);
@@ -153,13 +175,11 @@ private:
     static QVector<QVector2D> scaleTexCoordinates(const cwImage& image, QVector<QVector2D> texCoords);
 
     //For morphing
+    static MorphContext createMorphContext(const cwTriangulateInData &scrapData,
+                                           const QMatrix4x4& toLocal,
+                                           const cwImage& croppedImage);
     static QVector<QVector3D> morphPoints(const QVector<QVector3D> &notePoints,
-                                          const cwTriangulateInData &scrapData,
-                                          const QMatrix4x4& toLocal,
-                                          const cwImage& croppedImage);
-    static QList<cwTriangulateStation> stationsVisibleToPoint(const QVector3D& point,
-                                                              const QList<cwTriangulateStation>& stations,
-                                                              const QPolygonF& scrapOutline);
+                                          const MorphContext& context);
     static QVector3D morphPoint(const QList<cwTriangulateStation>& visibleStations,
                                 const QMatrix4x4 &toWorldCoords,
                                 const QMatrix4x4 &viewMatrix,
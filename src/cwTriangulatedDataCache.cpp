@@ -0,0 +1,191 @@
+//Our includes
+#include "cwTriangulatedDataCache.h"
+#include "cwProject.h"
+#include "cwSQLManager.h"
+#include "cwImageDatabase.h"
+#include "cwDebug.h"
+
+//Qt includes
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDataStream>
+
+cwTriangulatedDataCache::cwTriangulatedDataCache(const QString &filename)
+{
+    Database = cwProject::createDatabaseConnection("cwTriangulatedDataCache", filename);
+}
+
+cwTriangulatedDataCache::~cwTriangulatedDataCache()
+{
+    if(Database.isOpen()) {
+        Database.close();
+    }
+}
+
+/**
+ * Returns the cached triangulated data for hash. If there's no data for hash, or if the
+ * cached data's cropped image is missing from the project, this returns a null cwTriangulatedData.
+ *
+ * The returned cropped image has no ownership, it isn't deleted when the data is destroyed.
+ */
+cwTriangulatedData cwTriangulatedDataCache::find(const QByteArray &hash, cwTextureUploadTask::Format format) const
+{
+    QByteArray blob;
+
+    {
+        cwSQLManager::Transaction transaction(Database, cwSQLManager::ReadOnly);
+
+        QSqlQuery query(Database);
+        query.prepare("SELECT data FROM TriangulatedScraps WHERE hash = ? AND format = ?");
+        query.bindValue(0, hash);
+        query.bindValue(1, static_cast<int>(format));
+
+        //Older projects may not have the table, that's the same as a miss
+        if(!query.exec() || !query.next()) {
+            return cwTriangulatedData();
+        }
+
+        blob = query.value(0).toByteArray();
+    }
+
+    cwTriangulatedData data = fromByteArray(blob, Database.databaseName());
+
+    cwImageDatabase imageDatabase(Database.databaseName());
+    if(!imageDatabase.mipmapsValid(data.croppedImage(), format == cwTextureUploadTask::DXT1Mipmaps)) {
+        return cwTriangulatedData();
+    }
+
+    return data;
+}
+
+/**
+ * Stores data in the cache under hash. This replaces the existing data for hash.
+ */
+void cwTriangulatedDataCache::insert(const QByteArray &hash, cwTextureUploadTask::Format format, const cwTriangulatedData &data)
+{
+    if(!Database.tables().contains("TriangulatedScraps")) {
+        createTable(Database);
+    }
+
+    cwSQLManager::Transaction transaction(Database);
+
+    QSqlQuery query(Database);
+    bool successful = query.prepare("INSERT OR REPLACE INTO TriangulatedScraps (hash, format, croppedImageId, data) "
+                                    "VALUES (?, ?, ?, ?)");
+    if(!successful) {
+        qDebug() << "Couldn't prepare insert triangulated scrap:" << query.lastError() << LOCATION;
+        return;
+    }
+
+    query.bindValue(0, hash);
+    query.bindValue(1, static_cast<int>(format));
+    query.bindValue(2, data.croppedImage().original());
+    query.bindValue(3, toByteArray(data));
+    query.exec();
+}
+
+/**
+ * Removes all the entries that reference croppedImages. This should be called when cropped images
+ * are removed from the project.
+ */
+void cwTriangulatedDataCache::removeCroppedImages(const QList<cwImage> &croppedImages)
+{
+    if(croppedImages.isEmpty() || !Database.tables().contains("TriangulatedScraps")) {
+        return;
+    }
+
+    cwSQLManager::Transaction transaction(Database);
+
+    QSqlQuery query(Database);
+    query.prepare("DELETE FROM TriangulatedScraps WHERE croppedImageId = ?");
+    for(const cwImage& image : croppedImages) {
+        query.bindValue(0, image.original());
+        query.exec();
+    }
+}
+
+/**
+ * Returns the number of entries in the cache
+ */
+int cwTriangulatedDataCache::count() const
+{
+    cwSQLManager::Transaction transaction(Database, cwSQLManager::ReadOnly);
+
+    QSqlQuery query(Database);
+    if(!query.exec("SELECT count(*) FROM TriangulatedScraps") || !query.next()) {
+        return 0;
+    }
+    return query.value(0).toInt();
+}
+
+/**
+ * Creates the TriangulatedScraps table in database, if it doesn't exist
+ */
+void cwTriangulatedDataCache::createTable(const QSqlDatabase &database)
+{
+    QString triangulatedScrapsQuery =
+            QString("CREATE TABLE IF NOT EXISTS TriangulatedScraps (") +
+            QString("hash BLOB,") + //cwTriangulateInData::hash()
+            QString("format INTEGER,") + //The cwTextureUploadTask::Format of the cropped image
+            QString("croppedImageId INTEGER,") + //The original id of the cropped image
+            QString("data BLOB,") + //The cwTriangulatedData, see toByteArray()
+            QString("PRIMARY KEY (hash, format))");
+
+    QSqlQuery query(database);
+    if(!query.exec(triangulatedScrapsQuery)) {
+        qDebug() << "Couldn't create table:" << query.lastError().databaseText() << LOCATION;
+    }
+}
+
+QByteArray cwTriangulatedDataCache::toByteArray(const cwTriangulatedData &data)
+{
+    QByteArray buffer;
+    QDataStream stream(&buffer, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    cwImage image = data.croppedImage();
+    stream << image.original() << image.icon() << image.mipmaps()
+           << image.originalSize() << image.originalDotsPerMeter();
+
+    stream << data.points() << data.texCoords() << data.indices() << data.leadPoints();
+
+    return buffer;
+}
+
+cwTriangulatedData cwTriangulatedDataCache::fromByteArray(const QByteArray &data, const QString &filename)
+{
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    int original;
+    int icon;
+    QList<int> mipmaps;
+    QSize originalSize;
+    int originalDotsPerMeter;
+    stream >> original >> icon >> mipmaps >> originalSize >> originalDotsPerMeter;
+
+    QVector<QVector3D> points;
+    QVector<QVector2D> texCoords;
+    QVector<uint> indices;
+    QVector<QVector3D> leadPoints;
+    stream >> points >> texCoords >> indices >> leadPoints;
+
+    if(stream.status() != QDataStream::Ok) {
+        return cwTriangulatedData();
+    }
+
+    cwImage image;
+    image.setOriginal(original);
+    image.setIcon(icon);
+    image.setMipmaps(mipmaps);
+    image.setOriginalSize(originalSize);
+    image.setOriginalDotsPerMeter(originalDotsPerMeter);
+
+    cwTriangulatedData triangulatedData;
+    triangulatedData.setCroppedImage(cwTrackedImage::createShared(image, filename, cwTrackedImage::NoOwnership));
+    triangulatedData.setPoints(points);
+    triangulatedData.setTexCoords(texCoords);
+    triangulatedData.setIndices(indices);
+    triangulatedData.setLeadPoints(leadPoints);
+    return triangulatedData;
+}
@@ -0,0 +1,43 @@
+#ifndef CWTRIANGULATEDDATACACHE_H
+#define CWTRIANGULATEDDATACACHE_H
+
+//Our includes
+#include "cwGlobals.h"
+#include "cwTriangulatedData.h"
+#include "cwTextureUploadTask.h"
+
+//Qt includes
+#include <QSqlDatabase>
+#include <QByteArray>
+
+/**
+ * @brief The cwTriangulatedDataCache class stores cwTriangulatedData in the project file, keyed
+ * by cwTriangulateInData::hash()
+ *
+ * This allows unchanged scraps to load their geometry instead of re-triangulating them. The
+ * cached data references the scrap's cropped image. If the cropped image has been removed from
+ * the project, find() treats the entry as missing.
+ */
+class CAVEWHERE_LIB_EXPORT cwTriangulatedDataCache
+{
+public:
+    cwTriangulatedDataCache(const QString& filename);
+    cwTriangulatedDataCache(const cwTriangulatedDataCache&) = delete;
+    ~cwTriangulatedDataCache();
+
+    cwTriangulatedData find(const QByteArray& hash, cwTextureUploadTask::Format format) const;
+    void insert(const QByteArray& hash, cwTextureUploadTask::Format format, const cwTriangulatedData& data);
+    void removeCroppedImages(const QList<cwImage>& croppedImages);
+
+    int count() const;
+
+    static void createTable(const QSqlDatabase& database);
+
+    static QByteArray toByteArray(const cwTriangulatedData& data);
+    static cwTriangulatedData fromByteArray(const QByteArray& data, const QString& filename);
+
+private:
+    QSqlDatabase Database;
+};
+
+#endif // CWTRIANGULATEDDATACACHE_H
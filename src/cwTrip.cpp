@@ -65,6 +65,7 @@ void cwTrip::Copy(const cwTrip& object)
     for(int i = 0; i < object.Chunks.size(); i++) {
         cwSurveyChunk* objectsChunk = object.Chunks[i];
         cwSurveyChunk* newChunk = new cwSurveyChunk(*objectsChunk);
+        newChunk->blockSignals(isBulkEditing());
         newChunk->setParent(this);
         newChunk->setParentTrip(this);
         newChunk->errorModel()->setParentModel(ErrorModel);
@@ -201,6 +202,7 @@ void cwTrip::removeChunks(int begin, int end) {
     emit chunksAboutToBeRemoved(begin, end);
 
     for(int i = end; i >= begin; i--) {
+        Chunks.at(i)->blockSignals(false);
         Chunks.at(i)->deleteLater();
         Chunks.removeAt(i);
     }
@@ -219,6 +221,9 @@ void cwTrip::insertChunk(int row, cwSurveyChunk* chunk) {
     if(row < 0) { row = 0; }
     if(row > Chunks.size()) { row = Chunks.size(); }
 
+    //Chunks added during a bulk edit are quiet until endBulkEdit()
+    chunk->blockSignals(isBulkEditing());
+
     //Make this own the chunk
     chunk->setParentTrip(this);
     chunk->errorModel()->setParentModel(errorModel());
@@ -278,6 +283,7 @@ void cwTrip::setChucks(QList<cwSurveyChunk*> chunks) {
     Chunks = chunks;
 
     foreach(cwSurveyChunk* chunk, Chunks) {
+        chunk->blockSignals(isBulkEditing());
         chunk->setParentTrip(this);
     }
 
@@ -362,16 +368,73 @@ void cwTrip::stationPositionModelUpdated()
 QList< cwStation > cwTrip::uniqueStations() const {
     QMap<QString, cwStation> lookup;
     foreach(cwSurveyChunk* chunk, Chunks) {
-        for(int i = 0; i < chunk->stationCount(); i++) {
-            cwStation station = chunk->station(i);
-            if(!station.name().isEmpty()) {
-                lookup[station.name()] = station;
+        const QVector<QString>& names = chunk->surveyData().stationNames();
+        for(int i = 0; i < names.size(); i++) {
+            if(!names.at(i).isEmpty()) {
+                lookup[names.at(i)] = chunk->station(i);
             }
         }
     }
     return lookup.values();
 }
 
+/**
+  \brief Starts a bulk edit of the trip
+
+  While the trip is bulk edited, the trip and it's chunks don't emit signals, so the
+  chunks can be built shot by shot, without listeners redoing their work for every shot.
+  Listeners should drop their connections to the chunks when chunksAboutToBeReset() is
+  emitted, and treat all the chunks as new when endBulkEdit() emits chunksReset().
+
+  Bulk edits can be nested, only the outer most endBulkEdit() emits chunksReset(). Use
+  cwBulkEdit to make sure that endBulkEdit() is always called.
+  */
+void cwTrip::beginBulkEdit() {
+    BulkEditDepth++;
+    if(BulkEditDepth > 1) {
+        return;
+    }
+
+    emit chunksAboutToBeReset();
+
+    BulkEditName = Name;
+    BulkEditDate = DateTime;
+
+    blockSignals(true);
+    foreach(cwSurveyChunk* chunk, Chunks) {
+        chunk->blockSignals(true);
+    }
+}
+
+/**
+  \brief Ends the bulk edit started with beginBulkEdit()
+
+  This emits chunksReset() once for all the changes made in the bulk edit
+  */
+void cwTrip::endBulkEdit() {
+    Q_ASSERT(BulkEditDepth > 0);
+    BulkEditDepth--;
+    if(BulkEditDepth > 0) {
+        return;
+    }
+
+    foreach(cwSurveyChunk* chunk, Chunks) {
+        chunk->blockSignals(false);
+    }
+    blockSignals(false);
+
+    if(BulkEditName != Name) {
+        emit nameChanged();
+    }
+
+    if(BulkEditDate != DateTime) {
+        emit dateChanged(DateTime);
+    }
+
+    emit numberOfChunksChanged();
+    emit chunksReset();
+}
+
 /**
   \brief Sets the undo stack for the child objects
   */
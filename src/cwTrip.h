@@ -92,12 +92,19 @@ public:
     void stationPositionModelUpdated();
 
     cwErrorModel* errorModel() const;
+
+    void beginBulkEdit();
+    void endBulkEdit();
+    bool isBulkEditing() const;
+
 signals:
     void nameChanged();
     void dateChanged(QDateTime date);
     void chunksInserted(int begin, int end);
     void chunksAboutToBeRemoved(int begin, int end);
     void chunksRemoved(int begin, int end);
+    void chunksAboutToBeReset();
+    void chunksReset();
     void teamChanged();
     void calibrationChanged();
     void notesChanged();
@@ -118,6 +125,10 @@ protected:
     cwSurveyNoteModel* Notes;
     cwErrorModel* ErrorModel; //!<
 
+    int BulkEditDepth = 0; //!< The number of nested beginBulkEdit() calls
+    QString BulkEditName; //!< The name when the bulk edit started
+    QDateTime BulkEditDate; //!< The date when the bulk edit started
+
     //Units
 
 
@@ -173,6 +184,13 @@ inline QDateTime cwTrip::date() const {
     return DateTime;
 }
 
+/**
+  \brief Returns true if the trip is between beginBulkEdit() and endBulkEdit()
+  */
+inline bool cwTrip::isBulkEditing() const {
+    return BulkEditDepth > 0;
+}
+
 /**
   \brief Parent's cave
   */
@@ -34,6 +34,8 @@ void cwTripLengthTask::setTrip(cwTrip *trip) {
         if(Trip != nullptr) {
             connect(Trip, SIGNAL(destroyed()), SLOT(disconnectTrip()));
             connect(Trip, SIGNAL(chunksInserted(int,int)), SLOT(chunkAdded(int,int)));
+            connect(Trip, SIGNAL(chunksAboutToBeReset()), SLOT(disconnectResettingChunks()));
+            connect(Trip, SIGNAL(chunksReset()), SLOT(connectResetChunks()));
             connect(Trip->calibrations(), SIGNAL(tapeCalibrationChanged(double)), SLOT(restart()));
             connectChunks();
 
@@ -79,10 +81,11 @@ QPair<double, int> cwTripLengthTask::distanceOfChunk(const cwSurveyChunk *chunk)
 {
     double distance = 0.0;
     int numberOfShots = 0;
-    foreach(cwShot shot, chunk->shots()) {
-        if(shot.distanceState() == cwDistanceStates::Valid &&
-                shot.isDistanceIncluded()) {
-            distance += shot.distance();
+    const cwSurveyChunkData& data = chunk->surveyData();
+    for(int i = 0; i < data.shotCount(); i++) {
+        if(data.distanceStates().at(i) == cwDistanceStates::Valid &&
+                data.distancesIncluded().at(i)) {
+            distance += data.distances().at(i);
             numberOfShots++;
         }
     }
@@ -98,6 +101,23 @@ void cwTripLengthTask::chunkAdded(int begin, int end)
     }
 }
 
+/**
+  Called after the trip's bulk edit, this connects all the chunks and recalculates the length once
+  */
+void cwTripLengthTask::connectResetChunks()
+{
+    connectChunks();
+    restart();
+}
+
+/**
+  Called before the trip's bulk edit, chunks may be removed during the bulk edit
+  */
+void cwTripLengthTask::disconnectResettingChunks()
+{
+    disconnectChunks();
+}
+
 /**
   Disconnects the trip from the task
   */
@@ -46,6 +46,8 @@ signals:
 
 private slots:
    void chunkAdded(int begin, int end);
+   void connectResetChunks();
+   void disconnectResettingChunks();
 
    void disconnectTrip();
 
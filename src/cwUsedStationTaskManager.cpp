@@ -188,6 +188,72 @@ void cwUsedStationTaskManager::disconnectRemovedChunks(int begin, int end)
     }
 }
 
+/**
+ * @brief cwUsedStationTaskManager::connectResetTrips
+ *
+ * Called after the cave's bulk edit. Connects all the trips in the cave and calculates the used
+ * stations once.
+ */
+void cwUsedStationTaskManager::connectResetTrips()
+{
+    Q_ASSERT(dynamic_cast<cwCave*>(sender()) != nullptr);
+    cwCave* cave = static_cast<cwCave*>(sender());
+
+    foreach(cwTrip* trip, cave->trips()) {
+        connectTrip(trip);
+    }
+
+    calculateUsedStations();
+}
+
+/**
+ * @brief cwUsedStationTaskManager::connectResetChunks
+ *
+ * Called after the trip's bulk edit. Connects all the chunks in the trip and calculates the used
+ * stations once.
+ */
+void cwUsedStationTaskManager::connectResetChunks()
+{
+    Q_ASSERT(dynamic_cast<cwTrip*>(sender()) != nullptr);
+    cwTrip* trip = static_cast<cwTrip*>(sender());
+
+    foreach(cwSurveyChunk* chunk, trip->chunks()) {
+        connectChunk(chunk);
+    }
+
+    calculateUsedStations();
+}
+
+/**
+ * @brief cwUsedStationTaskManager::disconnectResettingTrips
+ *
+ * Called before the cave's bulk edit. Disconnects all the trips in the cave
+ */
+void cwUsedStationTaskManager::disconnectResettingTrips()
+{
+    Q_ASSERT(dynamic_cast<cwCave*>(sender()) != nullptr);
+    cwCave* cave = static_cast<cwCave*>(sender());
+
+    foreach(cwTrip* trip, cave->trips()) {
+        disconnectTrip(trip);
+    }
+}
+
+/**
+ * @brief cwUsedStationTaskManager::disconnectResettingChunks
+ *
+ * Called before the trip's bulk edit. Disconnects all the chunks in the trip
+ */
+void cwUsedStationTaskManager::disconnectResettingChunks()
+{
+    Q_ASSERT(dynamic_cast<cwTrip*>(sender()) != nullptr);
+    cwTrip* trip = static_cast<cwTrip*>(sender());
+
+    foreach(cwSurveyChunk* chunk, trip->chunks()) {
+        disconnectChunk(chunk);
+    }
+}
+
 /**
  * @brief cwUsedStationTaskManager::filterChunkDataChanged
  * @param role
@@ -234,6 +300,8 @@ void cwUsedStationTaskManager::connectCave(cwCave *cave)
     connect(cave, SIGNAL(rowsInserted(QModelIndex,int,int)), this, SLOT(calculateUsedStations()));
     connect(cave, SIGNAL(rowsInserted(QModelIndex,int,int)), this, SLOT(connectAddedTrips(QModelIndex,int,int)));
     connect(cave, SIGNAL(rowsRemoved(QModelIndex,int,int)), this, SLOT(calculateUsedStations()));
+    connect(cave, SIGNAL(beginResetTrips()), this, SLOT(disconnectResettingTrips()));
+    connect(cave, SIGNAL(resetTrips()), this, SLOT(connectResetTrips()));
 
     foreach(cwTrip* trip, cave->trips()) {
         connectTrip(trip);
@@ -251,6 +319,8 @@ void cwUsedStationTaskManager::connectTrip(cwTrip *trip)
     connect(trip, SIGNAL(chunksInserted(int,int)), this, SLOT(calculateUsedStations()));
     connect(trip, SIGNAL(chunksInserted(int,int)), this, SLOT(connectAddedChunks(int,int)));
     connect(trip, SIGNAL(chunksRemoved(int,int)), this, SLOT(calculateUsedStations()));
+    connect(trip, SIGNAL(chunksAboutToBeReset()), this, SLOT(disconnectResettingChunks()));
+    connect(trip, SIGNAL(chunksReset()), this, SLOT(connectResetChunks()));
 
     foreach(cwSurveyChunk* chunk, trip->chunks()) {
         connectChunk(chunk);
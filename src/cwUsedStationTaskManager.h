@@ -99,6 +99,12 @@ private slots:
     void disconnectRemovedTrips(QModelIndex parent, int begin, int end);
     void disconnectRemovedChunks(int begin, int end);
 
+    void connectResetTrips();
+    void connectResetChunks();
+
+    void disconnectResettingTrips();
+    void disconnectResettingChunks();
+
     void filterChunkDataChanged(cwSurveyChunk::DataRole role, int index);
 
 private:
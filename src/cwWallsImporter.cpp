@@ -443,7 +443,7 @@ void cwWallsImporter::applyLRUDs(cwTreeImportDataNode* block) {
     {
         for (int i = 0; i < chunk->stationCount(); i++)
         {
-            QString name = chunk->stations()[i].name();
+            QString name = chunk->surveyData().stationNames().at(i);
             if (StationMap.contains(name))
             {
                 chunk->setStation(StationMap[name], i);
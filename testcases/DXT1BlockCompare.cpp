@@ -7,6 +7,10 @@
 #include "cwImageData.h"
 #include "cwOpenGLUtils.h"
 
+//Qt includes
+#include <QImage>
+#include <QtMath>
+
 //Stc3 decompression
 #include "s3tc.h"
 
@@ -42,3 +46,38 @@ void DXT1BlockCompare::compare(const DXT1BlockCompare::TestImage &size, const cw
         }
     }
 }
+
+/**
+ * Returns the peak signal to noise ratio, in dB, of the decompressed dxt1Data against image.
+ * Only rgb is compared. dxt1Data is padded to whole blocks, like cwDXT1Encoder writes it.
+ */
+double DXT1BlockCompare::psnr(const QImage &image, const QByteArray &dxt1Data)
+{
+    //Blocks are 4 by 4, so the decompressed image is padded
+    int paddedWidth = (image.width() + 3) / 4 * 4;
+    int paddedHeight = (image.height() + 3) / 4 * 4;
+
+    QVector<unsigned int> decompressed(paddedWidth * paddedHeight, 0);
+    s3tc::BlockDecompressImageDXT1(paddedWidth, paddedHeight,
+                                   reinterpret_cast<const unsigned char*>(dxt1Data.constData()), decompressed.data());
+
+    double squaredError = 0.0;
+    for(int y = 0; y < image.height(); y++) {
+        for(int x = 0; x < image.width(); x++) {
+            //Compressed data is mirrored vertically
+            QRgb original = image.pixel(x, y);
+            QRgb decompressedColor = cwOpenGLUtils::toQRgba(decompressed.at((image.height() - 1 - y) * paddedWidth + x));
+
+            int red = qRed(original) - qRed(decompressedColor);
+            int green = qGreen(original) - qGreen(decompressedColor);
+            int blue = qBlue(original) - qBlue(decompressedColor);
+            squaredError += red * red + green * green + blue * blue;
+        }
+    }
+
+    double meanSquaredError = squaredError / (3.0 * image.width() * image.height());
+    if(meanSquaredError == 0.0) {
+        return 100.0;
+    }
+    return 10.0 * log10(255.0 * 255.0 / meanSquaredError);
+}
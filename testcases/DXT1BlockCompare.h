@@ -8,6 +8,8 @@
 
 //Our includes
 class cwImageData;
+class QImage;
+class QByteArray;
 
 class DXT1BlockCompare
 {
@@ -32,6 +34,7 @@ public:
     DXT1BlockCompare() = delete;
 
     static void compare(const TestImage& size, const cwImageData& mipmap);
+    static double psnr(const QImage& image, const QByteArray& dxt1Data);
 
 };
 
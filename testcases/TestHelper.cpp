@@ -43,7 +43,8 @@ QString copyToTempFolder(QString filename) {
 }
 
 void checkStationLookup(cwStationPositionLookup lookup1, cwStationPositionLookup lookup2) {
-    foreach(QString stationName, lookup1.positions().keys()) {
+    for(int i = 0; i < lookup1.stationCount(); i++) {
+        QString stationName = lookup1.stationName(i);
         INFO("Checking position for " << stationName);
         CHECK(lookup2.hasPosition(stationName) == true);
         checkQVector3D(lookup1.position(stationName), lookup2.position(stationName));
@@ -25,6 +25,10 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QElapsedTimer>
+#include <QThread>
 
 TEST_CASE("Export/Import Compass", "[Compass]") {
 
@@ -205,3 +209,134 @@ TEST_CASE("Test 15 char format is okay", "[Compass]") {
     QList<cwCave> caves = importFromCompass->caves();
     REQUIRE(caves.size() == 1);
 }
+
+namespace {
+
+/**
+ * Creates a compass data file with a cave that has numberOfTrips trips
+ */
+QByteArray compassDataFile(QString caveName, int numberOfTrips, int shotsPerTrip) {
+    QByteArray data;
+    QTextStream stream(&data);
+
+    for(int t = 0; t < numberOfTrips; t++) {
+        if(t > 0) {
+            stream << "\x0C\r\n";
+        }
+        stream << caveName << "\r\n";
+        stream << "SURVEY NAME: T" << t << "\r\n";
+        stream << "SURVEY DATE: 8 29 1982  COMMENT:\r\n";
+        stream << "SURVEY TEAM:\r\n";
+        stream << "Sauce Sauce Test Test\r\n";
+        stream << "DECLINATION:    0.00  FORMAT: DDDDLRUDLAaDdNF  CORRECTIONS:  0.00 0.00 0.00  CORRECTIONS2:  0.00 0.00\r\n";
+        stream << "\r\n";
+        stream << "FROM TO LENGTH BEARING INC LEFT UP DOWN RIGHT FLAGS COMMENTS\r\n";
+        stream << "\r\n";
+        for(int s = 0; s < shotsPerTrip; s++) {
+            stream << "T" << t << "_" << s << " T" << t << "_" << s + 1
+                   << " 31.93 357.50 0.30 2.00 15.00 4.00 1.50\r\n";
+        }
+    }
+    stream << "\x1A";
+    stream.flush();
+    return data;
+}
+
+QStringList writeCompassDataFiles(const QTemporaryDir& directory, int numberOfFiles, int numberOfTrips, int shotsPerTrip) {
+    QStringList filenames;
+    for(int i = 0; i < numberOfFiles; i++) {
+        QFile file(directory.filePath(QString("cave%1.dat").arg(i)));
+        file.open(QFile::WriteOnly);
+        file.write(compassDataFile(QString("Cave %1").arg(i), numberOfTrips, shotsPerTrip));
+        filenames.append(file.fileName());
+    }
+    return filenames;
+}
+
+}
+
+TEST_CASE("Import many Compass files in the same order", "[Compass]") {
+    QTemporaryDir directory;
+    REQUIRE(directory.isValid());
+
+    const int numberOfFiles = 20;
+    QStringList filenames = writeCompassDataFiles(directory, numberOfFiles, 3, 10);
+    filenames.insert(5, directory.filePath("missing.dat"));
+
+    auto importFromCompass = std::make_unique<cwCompassImporter>();
+    QSignalSpy messageSpy(importFromCompass.get(), &cwCompassImporter::statusMessage);
+
+    importFromCompass->setCompassDataFiles(filenames);
+    importFromCompass->start();
+    importFromCompass->waitToFinish();
+
+    //The missing file doesn't exist, isn't readable, and stops the import after it's merged
+    REQUIRE(messageSpy.size() == 3);
+    CHECK(messageSpy.at(0).at(0).toString().contains("does not exist"));
+    CHECK(messageSpy.at(2).at(0).toString().contains("Couldn't parse cave"));
+
+    QList<cwCave*> caves = importFromCompass->takeCaves();
+    CHECK(importFromCompass->caves().isEmpty());
+    REQUIRE(caves.size() == 5);
+    for(int i = 0; i < caves.size(); i++) {
+        cwCave* cave = caves.at(i);
+        CHECK(cave->name().toStdString() == QString("Cave %1").arg(i).toStdString());
+        CHECK(cave->thread() == nullptr);
+        REQUIRE(cave->trips().size() == 3);
+        CHECK(cave->trips().last()->name().toStdString() == "T2");
+        CHECK(cave->trips().last()->chunks().first()->shotCount() == 10);
+    }
+    qDeleteAll(caves);
+
+    SECTION("Without a missing file") {
+        filenames.removeAt(5);
+        messageSpy.clear();
+
+        importFromCompass->setCompassDataFiles(filenames);
+        importFromCompass->start();
+        importFromCompass->waitToFinish();
+
+        CHECK(messageSpy.isEmpty());
+
+        QList<cwCave> copies = importFromCompass->caves();
+        REQUIRE(copies.size() == numberOfFiles);
+        for(int i = 0; i < copies.size(); i++) {
+            CHECK(copies.at(i).name().toStdString() == QString("Cave %1").arg(i).toStdString());
+        }
+    }
+}
+
+TEST_CASE("Benchmark Compass import", "[Compass][.benchmark]") {
+    QTemporaryDir directory;
+    REQUIRE(directory.isValid());
+
+    const int numberOfFiles = 500;
+    QStringList filenames = writeCompassDataFiles(directory, numberOfFiles, 4, 50);
+
+    auto run = [&filenames](int threads) {
+        int maxThreads = cwTask::threadPool()->maxThreadCount();
+        cwTask::threadPool()->setMaxThreadCount(threads);
+
+        auto importFromCompass = std::make_unique<cwCompassImporter>();
+        importFromCompass->setCompassDataFiles(filenames);
+
+        QElapsedTimer timer;
+        timer.start();
+        importFromCompass->start();
+        importFromCompass->waitToFinish();
+        qint64 time = timer.nsecsElapsed();
+
+        QList<cwCave*> caves = importFromCompass->takeCaves();
+        CHECK(caves.size() == numberOfFiles);
+        qDeleteAll(caves);
+        cwTask::threadPool()->setMaxThreadCount(maxThreads);
+        return time;
+    };
+
+    qint64 oneThread = run(1);
+    qint64 allThreads = run(QThread::idealThreadCount());
+
+    WARN("Files:" << numberOfFiles);
+    WARN("One thread: " << oneThread * 1e-6 << "ms");
+    WARN(QThread::idealThreadCount() << " threads: " << allThreads * 1e-6 << "ms");
+}
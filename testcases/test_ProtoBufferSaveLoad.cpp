@@ -24,6 +24,9 @@
 
 //Qt includes
 #include <QUuid>
+#include <QThread>
+#include <QSqlDatabase>
+#include <QSqlQuery>
 
 //catch includes
 #include "catch.hpp"
@@ -219,3 +222,121 @@ TEST_CASE("Loading should report errors correctly", "[ProtoSaveLoad]") {
     root->taskManagerModel()->waitForTasks();
     root->futureManagerModel()->waitForFinished();
 }
+
+TEST_CASE("Progressive loading should give away the same caves as loading", "[ProtoSaveLoad]") {
+    auto filename = copyToTempFolder("://datasets/test_cwProject/Phake Cave 3000.cw");
+
+    cwRegionLoadTask loadTask;
+    loadTask.setDatabaseFilename(filename);
+    loadTask.setDeleteOldImages(false);
+    auto result = loadTask.load();
+    REQUIRE(result.errors().isEmpty());
+    REQUIRE(result.cavingRegion()->caveCount() > 0);
+
+    cwRegionLoadTask progressiveTask;
+    progressiveTask.setDatabaseFilename(filename);
+    progressiveTask.setDeleteOldImages(false);
+    progressiveTask.setProgressive(true);
+    CHECK(progressiveTask.isProgressive());
+
+    QList<int> indexes;
+    QList<cwCave*> caves;
+    QObject::connect(&progressiveTask, &cwRegionLoadTask::caveLoaded, &progressiveTask,
+                     [&indexes, &caves](int index, cwCave* cave)
+    {
+        CHECK(cave->thread() == nullptr);
+        cave->moveToThread(QThread::currentThread());
+        indexes.append(index);
+        caves.append(cave);
+    }, Qt::DirectConnection);
+
+    auto progressiveResult = progressiveTask.load();
+    CHECK(progressiveResult.errors().isEmpty());
+    CHECK(progressiveResult.cavingRegion()->caveCount() == 0);
+
+    REQUIRE(caves.size() == result.cavingRegion()->caveCount());
+    for(int i = 0; i < caves.size(); i++) {
+        CHECK(indexes.at(i) == i);
+
+        cwCave* loadedCave = result.cavingRegion()->cave(i);
+        cwCave* cave = caves.at(i);
+        CHECK(cave->name().toStdString() == loadedCave->name().toStdString());
+        REQUIRE(cave->tripCount() == loadedCave->tripCount());
+        for(int t = 0; t < cave->tripCount(); t++) {
+            CHECK(cave->trip(t)->name().toStdString() == loadedCave->trip(t)->name().toStdString());
+            CHECK(cave->trip(t)->chunkCount() == loadedCave->trip(t)->chunkCount());
+            CHECK(cave->trip(t)->notes()->rowCount() == loadedCave->trip(t)->notes()->rowCount());
+        }
+    }
+
+    qDeleteAll(caves);
+}
+
+TEST_CASE("Saving should only write the caves and trips that changed", "[ProtoSaveLoad]") {
+    auto filename = copyToTempFolder("://datasets/test_cwProject/Phake Cave 3000.cw");
+
+    auto savedRecords = [filename]() {
+        QSet<QByteArray> hashes;
+        {
+            QSqlDatabase database = cwProject::createDatabaseConnection("savedRecords", filename);
+            QSqlQuery query("SELECT hash FROM ObjectRecords", database);
+            while(query.next()) {
+                hashes.insert(query.value(0).toByteArray());
+            }
+            database.close();
+        }
+        return hashes;
+    };
+
+    auto load = [filename]() {
+        cwRegionLoadTask loadTask;
+        loadTask.setDatabaseFilename(filename);
+        loadTask.setDeleteOldImages(false);
+        auto result = loadTask.load();
+        REQUIRE(result.errors().isEmpty());
+        return result.cavingRegion();
+    };
+
+    auto save = [filename](cwCavingRegion* region) {
+        cwRegionSaveTask saveTask;
+        saveTask.setDatabaseFilename(filename);
+        CHECK(saveTask.save(region).isEmpty());
+    };
+
+    //Converts the file from the single blob format
+    auto region = load();
+    REQUIRE(region->caveCount() >= 1);
+    REQUIRE(region->cave(0)->tripCount() >= 1);
+    save(region.data());
+
+    //One record for each cave, and one for each trip
+    int numberOfRecords = 0;
+    for(cwCave* cave : region->caves()) {
+        numberOfRecords += 1 + cave->tripCount();
+    }
+
+    QSet<QByteArray> firstRecords = savedRecords();
+    CHECK(firstRecords.size() == numberOfRecords);
+
+    SECTION("Saving without changes doesn't write any records") {
+        auto reloaded = load();
+        save(reloaded.data());
+        CHECK(savedRecords() == firstRecords);
+
+        cwRegionSaveTask saveTask;
+        CHECK(saveTask.serializedData(reloaded.data()) == saveTask.serializedData(region.data()));
+    }
+
+    SECTION("Changing a trip only replaces the trip's record") {
+        region->cave(0)->trip(0)->setName("Changed trip");
+        save(region.data());
+
+        QSet<QByteArray> secondRecords = savedRecords();
+        CHECK(secondRecords.size() == firstRecords.size());
+        CHECK((firstRecords - secondRecords).size() == 1);
+
+        auto reloaded = load();
+        CHECK(reloaded->cave(0)->trip(0)->name().toStdString() == "Changed trip");
+        CHECK(reloaded->cave(0)->tripCount() == region->cave(0)->tripCount());
+    }
+}
@@ -0,0 +1,194 @@
+//Catch includes
+#include "catch.hpp"
+
+//Our includes
+#include "cwBulkEdit.h"
+#include "cwCavingRegion.h"
+#include "cwCave.h"
+#include "cwTrip.h"
+#include "cwSurveyChunk.h"
+#include "cwSurveyChunkSignaler.h"
+#include "cwTripCalibration.h"
+#include "SurveyChunkSignalerSlotHelper.h"
+#include "SpyChecker.h"
+
+//Qt includes
+#include <QSignalSpy>
+#include <QUndoStack>
+
+namespace {
+
+void addShots(cwTrip* trip, QString prefix, int count)
+{
+    cwShot shot("10", "0", "180", "0", "0");
+    for(int i = 0; i < count; i++) {
+        trip->addShotToLastChunk(cwStation(QString("%1%2").arg(prefix).arg(i)),
+                                 cwStation(QString("%1%2").arg(prefix).arg(i + 1)),
+                                 shot);
+    }
+}
+
+}
+
+TEST_CASE("cwTrip bulk edits should emit one reset", "[cwBulkEdit]") {
+    cwTrip trip;
+    addShots(&trip, "a", 2);
+    REQUIRE(trip.chunkCount() == 1);
+    cwSurveyChunk* chunk = trip.chunk(0);
+
+    QSignalSpy aboutToBeResetSpy(&trip, &cwTrip::chunksAboutToBeReset);
+    QSignalSpy resetSpy(&trip, &cwTrip::chunksReset);
+    QSignalSpy insertedSpy(&trip, &cwTrip::chunksInserted);
+    QSignalSpy nameSpy(&trip, &cwTrip::nameChanged);
+    QSignalSpy shotsAddedSpy(chunk, &cwSurveyChunk::shotsAdded);
+    QSignalSpy dataChangedSpy(chunk, &cwSurveyChunk::dataChanged);
+
+    SpyChecker checker({
+                           {&aboutToBeResetSpy, 0},
+                           {&resetSpy, 0},
+                           {&insertedSpy, 0},
+                           {&nameSpy, 0},
+                           {&shotsAddedSpy, 0},
+                           {&dataChangedSpy, 0}
+                       });
+
+    {
+        cwBulkEdit<cwTrip> edit(&trip);
+        CHECK(trip.isBulkEditing());
+        checker[&aboutToBeResetSpy] = 1;
+
+        addShots(&trip, "a", 100);
+        addShots(&trip, "b", 100);
+        trip.setName("Bulk");
+        chunk->setData(cwSurveyChunk::ShotDistanceRole, 0, 20.0);
+
+        SECTION("Nested bulk edits only emit at the outer most end") {
+            cwBulkEdit<cwTrip> nestedEdit(&trip);
+            addShots(&trip, "c", 10);
+        }
+
+        checker.checkSpies();
+    }
+
+    CHECK(!trip.isBulkEditing());
+    CHECK(trip.chunkCount() >= 2);
+    CHECK(trip.name() == "Bulk");
+    CHECK(chunk->data(cwSurveyChunk::ShotDistanceRole, 0).toDouble() == 20.0);
+
+    checker[&resetSpy] = 1;
+    checker[&nameSpy] = 1;
+    checker.checkSpies();
+    checker.clearSpyCounts();
+
+    SECTION("Chunks emit signals after the bulk edit") {
+        cwSurveyChunk* lastChunk = trip.chunks().last();
+        QSignalSpy lastShotsAddedSpy(lastChunk, &cwSurveyChunk::shotsAdded);
+
+        lastChunk->appendNewShot();
+        chunk->setData(cwSurveyChunk::ShotDistanceRole, 0, 30.0);
+
+        CHECK(lastShotsAddedSpy.size() == 1);
+        checker[&dataChangedSpy] = 1;
+        checker.checkSpies();
+    }
+}
+
+TEST_CASE("cwSurveyChunk should update calibrations during a bulk edit", "[cwBulkEdit]") {
+    cwTrip trip;
+    addShots(&trip, "a", 3);
+    REQUIRE(trip.chunkCount() == 1);
+    cwSurveyChunk* chunk = trip.chunk(0);
+
+    cwTripCalibration* calibration = new cwTripCalibration();
+    chunk->addCalibration(1, calibration);
+    REQUIRE(chunk->calibrations().value(1) == calibration);
+
+    {
+        cwBulkEdit<cwTrip> edit(&trip);
+        chunk->insertShot(0, cwSurveyChunk::Above);
+        CHECK(chunk->calibrations().value(2) == calibration);
+
+        chunk->removeShot(0, cwSurveyChunk::Above);
+        CHECK(chunk->calibrations().value(1) == calibration);
+    }
+}
+
+TEST_CASE("cwCavingRegion bulk edits should reset the caves", "[cwBulkEdit]") {
+    //Owns the removed caves
+    QUndoStack undoStack;
+
+    cwCavingRegion region;
+    region.setUndoStack(&undoStack);
+    cwCave* cave = new cwCave();
+    region.addCave(cave);
+
+    cwSurveyChunkSignaler signaler;
+    signaler.setRegion(&region);
+
+    SurveyChunkSignalerSlotHelper slotHelper;
+    signaler.addConnectionToTrips(SIGNAL(nameChanged()), &slotHelper, SLOT(tripNameChangedCalled()));
+    signaler.addConnectionToChunks(SIGNAL(stationsAdded(int,int)), &slotHelper, SLOT(chunkStationAdded(int,int)));
+
+    QSignalSpy insertedCavesSpy(&region, &cwCavingRegion::insertedCaves);
+    QSignalSpy resetCavesSpy(&region, &cwCavingRegion::resetCaves);
+    QSignalSpy modelResetSpy(&region, &cwCavingRegion::modelReset);
+    QSignalSpy insertedTripsSpy(cave, &cwCave::insertedTrips);
+    QSignalSpy resetTripsSpy(cave, &cwCave::resetTrips);
+
+    cwTrip* trip = new cwTrip();
+    cwCave* newCave = new cwCave();
+    cwTrip* newTrip = new cwTrip();
+
+    {
+        cwBulkEdit<cwCavingRegion> edit(&region);
+        CHECK(cave->isBulkEditing());
+
+        cave->addTrip(trip);
+        CHECK(trip->isBulkEditing());
+        addShots(trip, "a", 10);
+        trip->setName("Trip");
+
+        region.addCave(newCave);
+        newCave->addTrip(newTrip);
+        CHECK(newCave->isBulkEditing());
+        CHECK(newTrip->isBulkEditing());
+        addShots(newTrip, "b", 10);
+    }
+
+    CHECK(!cave->isBulkEditing());
+    CHECK(!trip->isBulkEditing());
+    CHECK(!newCave->isBulkEditing());
+    CHECK(!newTrip->isBulkEditing());
+
+    CHECK(region.caveCount() == 2);
+    CHECK(insertedCavesSpy.size() == 0);
+    CHECK(insertedTripsSpy.size() == 0);
+    CHECK(resetCavesSpy.size() == 1);
+    CHECK(modelResetSpy.size() == 1);
+
+    //The cave's reset is part of the region's reset
+    CHECK(resetTripsSpy.size() == 1);
+
+    //Nothing reached the signaler's recievers during the bulk edit
+    CHECK(slotHelper.tripNameChanged() == nullptr);
+    CHECK(slotHelper.chunkSender() == nullptr);
+
+    SECTION("The signaler connects the trips and chunks after the bulk edit") {
+        newTrip->setName("New trip");
+        CHECK(slotHelper.tripNameChanged() == newTrip);
+
+        cwSurveyChunk* chunk = trip->chunks().last();
+        chunk->appendNewShot();
+        CHECK(slotHelper.chunkSender() == chunk);
+    }
+
+    SECTION("Removed caves aren't bulk edited") {
+        {
+            cwBulkEdit<cwCavingRegion> edit(&region);
+            region.removeCave(1);
+            CHECK(!newCave->isBulkEditing());
+            CHECK(!newTrip->isBulkEditing());
+        }
+        CHECK(region.caveCount() == 1);
+    }
+}
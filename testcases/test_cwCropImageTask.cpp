@@ -10,6 +10,8 @@
 #include "DXT1BlockCompare.h"
 #include "cwAsyncFuture.h"
 #include "cwImageDatabase.h"
+#include "cwImageCache.h"
+#include "cwMipmapPyramid.h"
 
 //Qt includes
 #include <QColor>
@@ -499,3 +501,90 @@ TEST_CASE("Crop should no crash when cropping a bad image", "[cwCropImageTask]")
         }
     }
 }
+
+TEST_CASE("cwCropImageTask should copy DXT1 blocks out of the original's mipmaps", "[cwCropImageTask]") {
+    cwProject project;
+    QString filename = project.filename();
+
+    cwAddImageTask addImageTask;
+    addImageTask.setNewImages({QImage("://datasets/dx1Cropping/scanCrop.png")});
+    addImageTask.setDatabaseFilename(filename);
+    addImageTask.setImageTypesWithFormat(cwTextureUploadTask::format());
+
+    auto imageFuture = addImageTask.images();
+    REQUIRE(cwAsyncFuture::waitForFinished(imageFuture, 20000));
+    REQUIRE(imageFuture.results().size() == 1);
+    cwImage original = imageFuture.result()->take();
+    REQUIRE(original.isMipmapsValid());
+
+    cwImageCache::instance()->clear();
+
+    cwCropImageTask cropImageTask;
+    cropImageTask.setDatabaseFilename(filename);
+    cropImageTask.setRectF(QRectF(0.25, 0.25, 0.5, 0.5));
+    cropImageTask.setOriginal(original);
+    cropImageTask.setFormatType(cwTextureUploadTask::format());
+
+    auto cropFuture = cropImageTask.crop();
+    REQUIRE(cwAsyncFuture::waitForFinished(cropFuture, 20000));
+    cwImage cropped = cropFuture.result()->take();
+
+    //The original wasn't decoded
+    CHECK(!cwImageCache::instance()->contains(cwImageCache::Key(filename, original.original())));
+
+    CHECK(cropped.originalSize() == QSize(464, 436));
+    REQUIRE(cropped.mipmaps().size() == cwMipmapPyramid::numberOfLevels(QSize(464, 436)));
+
+    cwImageProvider provider;
+    provider.setProjectPath(filename);
+    cwImageData originalLevel = provider.data(original.mipmaps().first());
+    cwImageData croppedLevel = provider.data(cropped.mipmaps().first());
+    REQUIRE(croppedLevel.size() == QSize(464, 436));
+
+    //The crop starts at (232, 216) in the image, which is (232, 220) in the mirrored texture
+    const int originalBlocksPerRow = (originalLevel.size().width() + 3) / 4;
+    const int croppedBlocksPerRow = 464 / 4;
+    const int firstColumn = 232 / 4;
+    const int firstRow = 220 / 4;
+
+    int mismatchedBlocks = 0;
+    for(int row = 0; row < 436 / 4; row++) {
+        for(int column = 0; column < croppedBlocksPerRow; column++) {
+            QByteArray originalBlock = originalLevel.data().mid(((firstRow + row) * originalBlocksPerRow + firstColumn + column) * 8, 8);
+            QByteArray croppedBlock = croppedLevel.data().mid((row * croppedBlocksPerRow + column) * 8, 8);
+            if(originalBlock != croppedBlock) {
+                mismatchedBlocks++;
+            }
+        }
+    }
+    CHECK(mismatchedBlocks == 0);
+
+    SECTION("The lower levels look like the original's lower levels") {
+        cwImageData croppedLevel1 = provider.data(cropped.mipmaps().at(1));
+        REQUIRE(croppedLevel1.size() == QSize(232, 218));
+
+        QImage originalImage1 = cwImageProvider::decompressDxt1(provider.data(original.mipmaps().at(1)));
+        QImage expectedImage1 = originalImage1.copy(QRect(116, 108, 232, 218));
+
+        double psnr = DXT1BlockCompare::psnr(expectedImage1, croppedLevel1.data());
+        INFO("PSNR:" << psnr);
+        CHECK(psnr > 30.0);
+    }
+
+    SECTION("The texture coordinates use the area that was cropped") {
+        QRect cropArea = cwCropImageTask::cropArea(QRectF(0.25, 0.25, 0.5, 0.5), original, cwTextureUploadTask::format());
+        CHECK(cropArea == QRect(232, 216, 464, 436));
+
+        QSizeF size = original.originalSize();
+        QRectF normalized = cwCropImageTask::normalizedCropArea(QRectF(0.25, 0.25, 0.5, 0.5), original, cwTextureUploadTask::format());
+        CHECK(normalized.left() * size.width() == Approx(232.0));
+        CHECK(normalized.width() * size.width() == Approx(464.0));
+        CHECK((1.0 - normalized.bottom()) * size.height() == Approx(216.0));
+        CHECK(normalized.height() * size.height() == Approx(436.0));
+    }
+
+    SECTION("The crop isn't moved above the top of the original") {
+        QRect cropArea = cwCropImageTask::cropArea(QRectF(0.25, 0.5, 0.5, 0.5), original, cwTextureUploadTask::format());
+        CHECK(cropArea.top() == 0);
+    }
+}
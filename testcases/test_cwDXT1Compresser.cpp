@@ -10,6 +10,10 @@
 //Qt includes
 #include <QImage>
 #include <QThreadPool>
+#include <QElapsedTimer>
+
+//Std includes
+#include <algorithm>
 
 //Async future
 #include "asyncfuture.h"
@@ -79,6 +83,26 @@ TEST_CASE("cwDXT1Compresser should be able to compress correctly", "[cwDXT1Compr
         cwAsyncFuture::waitForFinished(completeFuture, 1000);
     }
 
+    SECTION("Native balanced") {
+        auto future = compresser.nativeCompression({image16x16}, cwDXT1Encoder::RangeFit, true);
+        auto completeFuture = AsyncFuture::observe(future).subscribe([future, testCompression](){
+            testCompression(future.results());
+        },
+        [](){ CHECK(false);} //Cancelled
+        ).future();
+        cwAsyncFuture::waitForFinished(completeFuture, 1000);
+    }
+
+    SECTION("Native fast no threading") {
+        auto future = compresser.nativeCompression({image16x16}, cwDXT1Encoder::BoundingBox, false);
+        auto completeFuture = AsyncFuture::observe(future).subscribe([future, testCompression](){
+            testCompression(future.results());
+        },
+        [](){ CHECK(false);} //Cancelled
+        ).future();
+        cwAsyncFuture::waitForFinished(completeFuture, 1000);
+    }
+
     SECTION("Generic") {
         auto future = compresser.compress({image16x16});
         auto completeFuture = AsyncFuture::observe(future).subscribe([future, testCompression](){
@@ -90,6 +114,40 @@ TEST_CASE("cwDXT1Compresser should be able to compress correctly", "[cwDXT1Compr
     }
 };
 
+TEST_CASE("cwDXT1Compresser should pad images without copying them", "[cwDXT1Compresser]") {
+    //Not divisible by 4
+    QImage image(13, 10, QImage::Format_RGB32);
+    for(int y = 0; y < image.height(); y++) {
+        for(int x = 0; x < image.width(); x++) {
+            image.setPixel(x, y, qRgb(x * 19, y * 25, (x * y) % 256));
+        }
+    }
+
+    //Padded at the top and right, by repeating the edge pixels
+    QSize paddedSize(16, 12);
+    int topPadding = paddedSize.height() - image.height();
+    QImage paddedImage(paddedSize, QImage::Format_RGB32);
+    for(int y = 0; y < paddedSize.height(); y++) {
+        for(int x = 0; x < paddedSize.width(); x++) {
+            paddedImage.setPixel(x, y, image.pixel(std::min(x, image.width() - 1),
+                                                   std::max(0, y - topPadding)));
+        }
+    }
+
+    cwDXT1Compresser paddedCompresser;
+    paddedCompresser.setPaddedSize(paddedSize);
+    CHECK(paddedCompresser.paddedSize() == paddedSize);
+
+    cwDXT1Compresser compresser;
+    auto padded = paddedCompresser.results(paddedCompresser.nativeCompression({image}, cwDXT1Encoder::RangeFit, false));
+    auto expected = compresser.results(compresser.nativeCompression({paddedImage}, cwDXT1Encoder::RangeFit, false));
+
+    REQUIRE(padded.size() == 1);
+    REQUIRE(expected.size() == 1);
+    CHECK(padded.first().size == paddedSize);
+    CHECK(padded.first().data == expected.first().data);
+}
+
 TEST_CASE("cwDXT1Compresser should be able to be canceled correctly", "[cwDXT1Compresser]") {
 
     QImage image("://datasets/dx1Cropping/scanCrop.png");
@@ -136,3 +194,85 @@ TEST_CASE("cwDXT1Compresser should be able to be canceled correctly", "[cwDXT1Co
     CHECK(ratio < 0.1); //Canceled ratio should be much much smaller than the normal futures
     CHECK(future.isCanceled());
 }
+
+TEST_CASE("cwDXT1Compresser native encoder quality should be close to squish", "[cwDXT1Compresser]") {
+    QImage image("://datasets/dx1Cropping/scanCrop.png");
+    REQUIRE(!image.isNull());
+    REQUIRE(image.width() % 4 == 0);
+    REQUIRE(image.height() % 4 == 0);
+
+    cwDXT1Compresser compresser;
+
+    auto compress = [](QFuture<cwDXT1Compresser::CompressedImage> future) {
+        REQUIRE(cwAsyncFuture::waitForFinished(future, 60000));
+        REQUIRE(future.resultCount() == 1);
+        return future.result().data;
+    };
+
+    QByteArray squishData = compress(compresser.squishCompression({image}));
+    QByteArray balancedData = compress(compresser.nativeCompression({image}, cwDXT1Encoder::RangeFit));
+    QByteArray fastData = compress(compresser.nativeCompression({image}, cwDXT1Encoder::BoundingBox));
+
+    CHECK(balancedData.size() == squishData.size());
+    CHECK(fastData.size() == squishData.size());
+
+    //The threaded and serial encoders should produce the same blocks
+    CHECK(cwDXT1Encoder::compressImage(image, cwDXT1Encoder::RangeFit) == balancedData);
+
+    double squishPsnr = DXT1BlockCompare::psnr(image, squishData);
+    double balancedPsnr = DXT1BlockCompare::psnr(image, balancedData);
+    double fastPsnr = DXT1BlockCompare::psnr(image, fastData);
+
+    INFO("Squish:" << squishPsnr << "dB balanced:" << balancedPsnr << "dB fast:" << fastPsnr << "dB");
+    CHECK(balancedPsnr > squishPsnr - 1.5);
+    CHECK(fastPsnr > squishPsnr - 4.0);
+    CHECK(balancedPsnr >= fastPsnr);
+}
+
+TEST_CASE("cwDXT1Encoder shouldn't collapse blocks whose principal axis is orthogonal to gray", "[cwDXT1Compresser]") {
+    //Red and blue, the axis between them has no component along (1, 1, 1)
+    QImage image(4, 4, QImage::Format_ARGB32);
+    for(int y = 0; y < image.height(); y++) {
+        for(int x = 0; x < image.width(); x++) {
+            image.setPixel(x, y, x < 2 ? qRgb(255, 0, 0) : qRgb(0, 0, 255));
+        }
+    }
+
+    QByteArray data = cwDXT1Encoder::compressImage(image, cwDXT1Encoder::RangeFit);
+    REQUIRE(data.size() == cwDXT1Encoder::storageSize(image.size()));
+
+    //The endpoints are the first two 565 colors of the block
+    const quint16* endpoints = reinterpret_cast<const quint16*>(data.constData());
+    CHECK(endpoints[0] != endpoints[1]);
+
+    //A collapsed block is a single purple, about 9dB
+    CHECK(DXT1BlockCompare::psnr(image, data) > 40.0);
+}
+
+TEST_CASE("Benchmark cwDXT1Compresser squish against the native encoder", "[cwDXT1Compresser][.benchmark]") {
+    QImage image("://datasets/dx1Cropping/scanCrop.png");
+    REQUIRE(!image.isNull());
+
+    cwDXT1Compresser compresser;
+    double megabytes = image.width() * image.height() * 4 / (1024.0 * 1024.0);
+
+    //Single core, so the results are MB/s per core
+    int maxThreadCount = QThreadPool::globalInstance()->maxThreadCount();
+    QThreadPool::globalInstance()->setMaxThreadCount(1);
+
+    auto run = [&](const QString& name, std::function<QFuture<cwDXT1Compresser::CompressedImage> ()> compress) {
+        QElapsedTimer timer;
+        timer.start();
+        auto future = compress();
+        cwAsyncFuture::waitForFinished(future);
+        double seconds = timer.nsecsElapsed() * 1e-9;
+        double psnr = DXT1BlockCompare::psnr(image, future.result().data);
+        WARN(name.toStdString() << ": " << megabytes / seconds << "MB/s per core, PSNR:" << psnr << "dB");
+    };
+
+    run("Squish iterative cluster fit", [&]() { return compresser.squishCompression({image}); });
+    run("Native balanced (range fit)", [&]() { return compresser.nativeCompression({image}, cwDXT1Encoder::RangeFit); });
+    run("Native fast (bounding box)", [&]() { return compresser.nativeCompression({image}, cwDXT1Encoder::BoundingBox); });
+
+    QThreadPool::globalInstance()->setMaxThreadCount(maxThreadCount);
+}
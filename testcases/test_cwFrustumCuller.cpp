@@ -0,0 +1,124 @@
+//Catch includes
+#include "catch.hpp"
+
+//Our includes
+#include "cwFrustumCuller.h"
+
+//Qt includes
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+
+TEST_CASE("cwFrustumCuller::Box should contain all the points", "[cwFrustumCuller]") {
+    cwFrustumCuller::Box box;
+    CHECK(box.isEmpty());
+
+    box = cwFrustumCuller::Box::fromPoints({QVector3D(1.0, -2.0, 3.0),
+                                            QVector3D(-1.0, 4.0, 0.0),
+                                            QVector3D(0.0, 0.0, 5.0)});
+    CHECK(!box.isEmpty());
+    CHECK(box.Min == QVector3D(-1.0, -2.0, 0.0));
+    CHECK(box.Max == QVector3D(1.0, 4.0, 5.0));
+}
+
+TEST_CASE("cwFrustumCuller should cull boxes that can't be seen", "[cwFrustumCuller]") {
+    QRect viewport(0, 0, 1000, 1000);
+
+    SECTION("Orthographic") {
+        //Shows -10 to 10 in x and y, 1000 pixels is 20 meters
+        QMatrix4x4 projection;
+        projection.ortho(-10.0, 10.0, -10.0, 10.0, -100.0, 100.0);
+        cwFrustumCuller culler(projection, viewport);
+
+        CHECK(culler.test(cwFrustumCuller::Box(QVector3D(-1.0, -1.0, -1.0), QVector3D(1.0, 1.0, 1.0))) == cwFrustumCuller::Visible);
+        CHECK(culler.test(cwFrustumCuller::Box()) == cwFrustumCuller::OutsideFrustum);
+
+        //Outside of each side
+        CHECK(culler.test(cwFrustumCuller::Box(QVector3D(11.0, -1.0, 0.0), QVector3D(12.0, 1.0, 0.0))) == cwFrustumCuller::OutsideFrustum);
+        CHECK(culler.test(cwFrustumCuller::Box(QVector3D(-12.0, -1.0, 0.0), QVector3D(-11.0, 1.0, 0.0))) == cwFrustumCuller::OutsideFrustum);
+        CHECK(culler.test(cwFrustumCuller::Box(QVector3D(-1.0, 11.0, 0.0), QVector3D(1.0, 12.0, 0.0))) == cwFrustumCuller::OutsideFrustum);
+        CHECK(culler.test(cwFrustumCuller::Box(QVector3D(-1.0, -1.0, 101.0), QVector3D(1.0, 1.0, 102.0))) == cwFrustumCuller::OutsideFrustum);
+
+        //Crosses the edge of the frustum
+        CHECK(culler.test(cwFrustumCuller::Box(QVector3D(9.0, -1.0, 0.0), QVector3D(12.0, 1.0, 0.0))) == cwFrustumCuller::Visible);
+
+        //Bigger than the frustum
+        CHECK(culler.test(cwFrustumCuller::Box(QVector3D(-50.0, -50.0, -500.0), QVector3D(50.0, 50.0, 500.0))) == cwFrustumCuller::Visible);
+
+        //0.01 meters is half a pixel
+        cwFrustumCuller::Box small(QVector3D(0.0, 0.0, 0.0), QVector3D(0.01, 0.01, 0.0));
+        CHECK(culler.test(small) == cwFrustumCuller::TooSmall);
+
+        //Long and thin isn't too small
+        CHECK(culler.test(cwFrustumCuller::Box(QVector3D(0.0, 0.0, 0.0), QVector3D(5.0, 0.01, 0.0))) == cwFrustumCuller::Visible);
+
+        culler.setMinimumScreenSize(0.0);
+        CHECK(culler.test(small) == cwFrustumCuller::Visible);
+    }
+
+    SECTION("Perspective") {
+        QMatrix4x4 projection;
+        projection.perspective(90.0, 1.0, 1.0, 1000.0);
+        cwFrustumCuller culler(projection, viewport);
+
+        //The camera looks down -z
+        CHECK(culler.test(cwFrustumCuller::Box(QVector3D(-1.0, -1.0, -11.0), QVector3D(1.0, 1.0, -10.0))) == cwFrustumCuller::Visible);
+        CHECK(culler.test(cwFrustumCuller::Box(QVector3D(-1.0, -1.0, 10.0), QVector3D(1.0, 1.0, 11.0))) == cwFrustumCuller::OutsideFrustum);
+        CHECK(culler.test(cwFrustumCuller::Box(QVector3D(-1.0, -1.0, -2000.0), QVector3D(1.0, 1.0, -1500.0))) == cwFrustumCuller::OutsideFrustum);
+        CHECK(culler.test(cwFrustumCuller::Box(QVector3D(20.0, -1.0, -11.0), QVector3D(22.0, 1.0, -10.0))) == cwFrustumCuller::OutsideFrustum);
+
+        //Far away boxes get small
+        CHECK(culler.test(cwFrustumCuller::Box(QVector3D(0.0, 0.0, -900.0), QVector3D(0.5, 0.5, -900.0))) == cwFrustumCuller::TooSmall);
+
+        //Crosses the camera's plane, it's in view and can't be too small
+        CHECK(culler.test(cwFrustumCuller::Box(QVector3D(-0.001, -0.001, -10.0), QVector3D(0.001, 0.001, 10.0))) == cwFrustumCuller::Visible);
+    }
+}
+
+TEST_CASE("Benchmark cwFrustumCuller", "[cwFrustumCuller][.benchmark]") {
+    //Scraps spread over a 2km cave, viewed from above, zoomed into a 100m area
+    const int numberOfScraps = 20000;
+    QRandomGenerator generator(42);
+
+    QVector<cwFrustumCuller::Box> boxes;
+    boxes.reserve(numberOfScraps);
+    for(int i = 0; i < numberOfScraps; i++) {
+        QVector3D min(generator.bounded(2000.0), generator.bounded(2000.0), generator.bounded(100.0));
+        QVector3D size(0.5 + generator.bounded(10.0), 0.5 + generator.bounded(10.0), generator.bounded(3.0));
+        boxes.append(cwFrustumCuller::Box(min, min + size));
+    }
+
+    QRect viewport(0, 0, 1920, 1080);
+
+    auto run = [&](const QMatrix4x4& viewProjection) {
+        cwFrustumCuller culler(viewProjection, viewport);
+        QElapsedTimer timer;
+        timer.start();
+        int frustumCulled = 0;
+        int smallCulled = 0;
+        for(const auto& box : boxes) {
+            switch(culler.test(box)) {
+            case cwFrustumCuller::OutsideFrustum:
+                frustumCulled++;
+                break;
+            case cwFrustumCuller::TooSmall:
+                smallCulled++;
+                break;
+            case cwFrustumCuller::Visible:
+                break;
+            }
+        }
+        qint64 nsecs = timer.nsecsElapsed();
+        WARN("Scraps:" << numberOfScraps << " frustum culled:" << frustumCulled
+             << " small culled:" << smallCulled << " drawn:" << numberOfScraps - frustumCulled - smallCulled
+             << " time:" << nsecs * 1e-6 << "ms");
+        return frustumCulled + smallCulled;
+    };
+
+    QMatrix4x4 zoomedIn;
+    zoomedIn.ortho(950.0, 1050.0, 950.0, 1050.0, -1000.0, 1000.0);
+    CHECK(run(zoomedIn) > numberOfScraps / 2);
+
+    QMatrix4x4 zoomedOut;
+    zoomedOut.ortho(-50000.0, 52000.0, -50000.0, 52000.0, -1000.0, 1000.0);
+    CHECK(run(zoomedOut) > numberOfScraps / 2);
+}
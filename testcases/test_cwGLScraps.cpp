@@ -0,0 +1,117 @@
+//Catch includes
+#include "catch.hpp"
+
+//Our includes
+#include "cwGLScraps.h"
+#include "cwScene.h"
+#include "cwCamera.h"
+#include "cwScrap.h"
+#include "cwProject.h"
+#include "cwTriangulatedData.h"
+
+//Qt includes
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOpenGLFramebufferObject>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+
+TEST_CASE("Benchmark cwGLScraps culling", "[cwGLScraps][.benchmark]") {
+    QOffscreenSurface surface;
+    surface.create();
+
+    QOpenGLContext context;
+    if(!context.create() || !context.makeCurrent(&surface)) {
+        WARN("Couldn't create an OpenGL context, skipping");
+        return;
+    }
+
+    WARN("Renderer:" << QString::fromLocal8Bit(reinterpret_cast<const char*>(context.functions()->glGetString(GL_RENDERER))).toStdString());
+
+    const QRect viewport(0, 0, 1920, 1080);
+    QOpenGLFramebufferObject framebuffer(viewport.size(), QOpenGLFramebufferObject::Depth);
+    framebuffer.bind();
+
+    cwProject project;
+
+    cwCamera camera;
+    camera.setViewport(viewport);
+    camera.setViewMatrix(QMatrix4x4());
+
+    auto scene = std::make_unique<cwScene>();
+    scene->setCamera(&camera);
+
+    cwGLScraps* glScraps = new cwGLScraps();
+    glScraps->setProject(&project);
+    scene->addItem(glScraps);
+
+    //Scraps spread over a 2km cave, like the cwFrustumCuller benchmark
+    const int numberOfScraps = 20000;
+    QRandomGenerator generator(42);
+
+    QList<cwScrap*> scraps;
+    for(int i = 0; i < numberOfScraps; i++) {
+        QVector3D min(generator.bounded(2000.0), generator.bounded(2000.0), generator.bounded(100.0));
+        QVector3D size(0.5 + generator.bounded(10.0), 0.5 + generator.bounded(10.0), 0.0);
+
+        cwTriangulatedData data;
+        data.setPoints({min,
+                        min + QVector3D(size.x(), 0.0, 0.0),
+                        min + size,
+                        min + QVector3D(0.0, size.y(), 0.0)});
+        data.setTexCoords({QVector2D(0.0, 0.0), QVector2D(1.0, 0.0), QVector2D(1.0, 1.0), QVector2D(0.0, 1.0)});
+        data.setIndices({0, 1, 2, 0, 2, 3});
+
+        cwScrap* scrap = new cwScrap();
+        scrap->setTriangulationData(data);
+        glScraps->addScrapToUpdate(scrap);
+        scraps.append(scrap);
+    }
+
+    auto run = [&](const QMatrix4x4& projection, bool culling) {
+        camera.setCustomProjection(projection);
+        glScraps->setCullingEnabled(culling);
+
+        //Initializes and uploads the scraps on the first frame
+        scene->paint();
+        context.functions()->glFinish();
+
+        const int frames = 10;
+        QElapsedTimer timer;
+        timer.start();
+        for(int i = 0; i < frames; i++) {
+            scene->paint();
+        }
+        context.functions()->glFinish();
+        qint64 nsecs = timer.nsecsElapsed();
+
+        cwGLScraps::CullingStatistics statistics = glScraps->cullingStatistics();
+        CHECK(statistics.Total == numberOfScraps);
+        CHECK(statistics.Drawn + statistics.FrustumCulled + statistics.SmallCulled == statistics.Total);
+
+        WARN("Culling:" << culling
+             << " frustum culled:" << statistics.FrustumCulled
+             << " small culled:" << statistics.SmallCulled
+             << " drawn:" << statistics.Drawn
+             << " frame:" << nsecs * 1e-6 / frames << "ms");
+        return statistics;
+    };
+
+    QMatrix4x4 zoomedIn;
+    zoomedIn.ortho(950.0, 1050.0, 950.0, 1050.0, -1000.0, 1000.0);
+    CHECK(run(zoomedIn, true).Drawn < numberOfScraps / 2);
+    CHECK(run(zoomedIn, false).Drawn == numberOfScraps);
+
+    QMatrix4x4 zoomedOut;
+    zoomedOut.ortho(-50000.0, 52000.0, -50000.0, 52000.0, -1000.0, 1000.0);
+    CHECK(run(zoomedOut, true).Drawn < numberOfScraps / 2);
+    CHECK(run(zoomedOut, false).Drawn == numberOfScraps);
+
+    scene->releaseResources();
+    scene.reset();
+    qDeleteAll(scraps);
+
+    framebuffer.release();
+    context.doneCurrent();
+}
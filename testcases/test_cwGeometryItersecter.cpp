@@ -0,0 +1,224 @@
+//Catch includes
+#include "catch.hpp"
+
+//Our includes
+#include "cwGeometryItersecter.h"
+
+//Qt includes
+#include <QElapsedTimer>
+#include <QtMath>
+#include <QtNumeric>
+
+//Std includes
+#include <random>
+
+namespace {
+
+/**
+ * A height field, like a scrap's mesh, centered at center
+ */
+cwGeometryItersecter::Object createGrid(uint id, QVector3D center, int size, std::default_random_engine& generator)
+{
+    std::uniform_real_distribution<float> height(-0.2f, 0.2f);
+
+    QVector<QVector3D> points;
+    for(int y = 0; y <= size; y++) {
+        for(int x = 0; x <= size; x++) {
+            points.append(center + QVector3D(x - size * 0.5f, y - size * 0.5f, height(generator)));
+        }
+    }
+
+    QVector<uint> indexes;
+    auto index = [size](int x, int y) { return static_cast<uint>(y * (size + 1) + x); };
+    for(int y = 0; y < size; y++) {
+        for(int x = 0; x < size; x++) {
+            indexes << index(x, y) << index(x + 1, y) << index(x, y + 1);
+            indexes << index(x + 1, y) << index(x + 1, y + 1) << index(x, y + 1);
+        }
+    }
+
+    return cwGeometryItersecter::Object(nullptr, id, points, indexes, cwGeometryItersecter::Triangles);
+}
+
+QRay3D downRay(float x, float y)
+{
+    return QRay3D(QVector3D(x, y, 100.0f), QVector3D(0.0f, 0.0f, -1.0f));
+}
+
+/**
+ * The brute force closest hit, every triangle is tested
+ */
+double bruteForceIntersects(const QList<cwGeometryItersecter::Object>& objects, const QRay3D& ray)
+{
+    double bestT = qInf();
+    for(const auto& object : objects) {
+        for(int i = 0; i < object.indexes().size(); i += 3) {
+            QVector3D p0 = object.points().at(object.indexes().at(i));
+            QVector3D p1 = object.points().at(object.indexes().at(i + 1));
+            QVector3D p2 = object.points().at(object.indexes().at(i + 2));
+
+            QVector3D edge1 = p1 - p0;
+            QVector3D edge2 = p2 - p0;
+            QVector3D normal = QVector3D::crossProduct(edge1, edge2);
+            float denominator = QVector3D::dotProduct(normal, ray.direction());
+            if(qAbs(denominator) < 1e-7f) {
+                continue;
+            }
+
+            float t = QVector3D::dotProduct(normal, p0 - ray.origin()) / denominator;
+            QVector3D point = ray.origin() + ray.direction() * t;
+
+            //Barycentric inside test
+            QVector3D c0 = QVector3D::crossProduct(p1 - p0, point - p0);
+            QVector3D c1 = QVector3D::crossProduct(p2 - p1, point - p1);
+            QVector3D c2 = QVector3D::crossProduct(p0 - p2, point - p2);
+            if(t > 0.0f &&
+                    QVector3D::dotProduct(c0, normal) >= 0.0f &&
+                    QVector3D::dotProduct(c1, normal) >= 0.0f &&
+                    QVector3D::dotProduct(c2, normal) >= 0.0f)
+            {
+                bestT = qMin(bestT, static_cast<double>(t));
+            }
+        }
+    }
+    return bestT == qInf() ? qSNaN() : bestT;
+}
+
+}
+
+TEST_CASE("cwGeometryItersecter should find the closest triangle", "[cwGeometryItersecter]") {
+    std::default_random_engine generator(5);
+
+    cwGeometryItersecter intersecter;
+    CHECK(qIsNaN(intersecter.intersects(downRay(0.0f, 0.0f))));
+
+    //Two stacked grids, the top one is closer to the ray
+    QList<cwGeometryItersecter::Object> objects = {
+        createGrid(0, QVector3D(0.0f, 0.0f, 0.0f), 20, generator),
+        createGrid(1, QVector3D(5.0f, 5.0f, 10.0f), 10, generator),
+    };
+    for(const auto& object : objects) {
+        intersecter.addObject(object);
+    }
+
+    CHECK(intersecter.objectCount() == 2);
+    CHECK(intersecter.primitiveCount() == 20 * 20 * 2 + 10 * 10 * 2);
+
+    std::uniform_real_distribution<float> position(-9.5f, 9.5f);
+    for(int i = 0; i < 200; i++) {
+        QRay3D ray = downRay(position(generator), position(generator));
+        INFO("Ray:" << ray.origin().x() << "," << ray.origin().y());
+        CHECK(intersecter.intersects(ray) == Approx(bruteForceIntersects(objects, ray)).margin(1e-3));
+    }
+
+    CHECK(intersecter.intersects(downRay(5.0f, 5.0f)) == Approx(90.0).margin(0.25));
+
+    SECTION("Adding an object with the same id replaces it") {
+        intersecter.addObject(createGrid(1, QVector3D(5.0f, 5.0f, 20.0f), 10, generator));
+        CHECK(intersecter.objectCount() == 2);
+        CHECK(intersecter.intersects(downRay(5.0f, 5.0f)) == Approx(80.0).margin(0.25));
+    }
+
+    SECTION("Removing an object") {
+        intersecter.removeObject(nullptr, 1);
+        CHECK(intersecter.objectCount() == 1);
+        CHECK(intersecter.intersects(downRay(5.0f, 5.0f)) == Approx(100.0).margin(0.25));
+    }
+
+    SECTION("Clear") {
+        intersecter.clear();
+        CHECK(intersecter.objectCount() == 0);
+        CHECK(intersecter.primitiveCount() == 0);
+        CHECK(qIsNaN(intersecter.intersects(downRay(5.0f, 5.0f))));
+    }
+
+    SECTION("Rays that miss use the nearest neighbor") {
+        //Beside the bottom grid, pointing down
+        double t = intersecter.intersects(downRay(12.0f, -5.0f));
+        CHECK(t == Approx(100.0).margin(0.25));
+    }
+}
+
+TEST_CASE("cwGeometryItersecter should find the nearest lines", "[cwGeometryItersecter]") {
+    cwGeometryItersecter intersecter;
+
+    //Three parallel lines along y, at x = 1, 3, and -6
+    QVector<QVector3D> points = {
+        QVector3D(1.0f, -10.0f, 0.0f), QVector3D(1.0f, 10.0f, 0.0f),
+        QVector3D(3.0f, -10.0f, 0.0f), QVector3D(3.0f, 10.0f, 0.0f),
+        QVector3D(-6.0f, -10.0f, 0.0f), QVector3D(-6.0f, 10.0f, 0.0f)
+    };
+    QVector<uint> indexes = {0, 1, 2, 3, 4, 5};
+    intersecter.addObject(cwGeometryItersecter::Object(nullptr, 7, points, indexes, cwGeometryItersecter::Lines));
+
+    QRay3D ray = downRay(0.0f, 0.0f);
+
+    auto neighbors = intersecter.nearestNeighbors(ray, 2);
+    REQUIRE(neighbors.size() == 2);
+    CHECK(neighbors.at(0).Distance == Approx(1.0));
+    CHECK(neighbors.at(0).T == Approx(100.0));
+    CHECK(neighbors.at(0).Id == 7);
+    CHECK(neighbors.at(1).Distance == Approx(3.0));
+
+    CHECK(intersecter.nearestNeighbors(ray, 10).size() == 3);
+
+    //Lines can't be hit by a ray, so this uses the nearest line
+    CHECK(intersecter.intersects(ray) == Approx(100.0));
+
+    //The lines are behind the ray
+    CHECK(qIsNaN(intersecter.intersects(QRay3D(QVector3D(0.0f, 0.0f, 100.0f), QVector3D(0.0f, 0.0f, 1.0f)))));
+
+    SECTION("Invalid indexes are ignored") {
+        intersecter.addObject(cwGeometryItersecter::Object(nullptr, 8, points, {0, 1, 2}, cwGeometryItersecter::Lines));
+        intersecter.addObject(cwGeometryItersecter::Object(nullptr, 9, points, {0, 10}, cwGeometryItersecter::Lines));
+        CHECK(intersecter.objectCount() == 1);
+    }
+}
+
+TEST_CASE("Benchmark cwGeometryItersecter picking", "[cwGeometryItersecter][.benchmark]") {
+    std::default_random_engine generator(10);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+
+    //Many scraps, like a large project
+    QList<cwGeometryItersecter::Object> objects;
+    for(uint i = 0; i < 400; i++) {
+        objects.append(createGrid(i, QVector3D(position(generator), position(generator), position(generator) * 0.1f), 30, generator));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    cwGeometryItersecter intersecter;
+    for(const auto& object : objects) {
+        intersecter.addObject(object);
+    }
+    qint64 buildTime = timer.nsecsElapsed();
+
+    QList<QRay3D> rays;
+    for(int i = 0; i < 1000; i++) {
+        rays.append(downRay(position(generator), position(generator)));
+    }
+
+    timer.restart();
+    int hits = 0;
+    for(const QRay3D& ray : rays) {
+        hits += qIsNaN(intersecter.intersects(ray)) ? 0 : 1;
+    }
+    qint64 pickTime = timer.nsecsElapsed();
+
+    //Brute force is slow, only run a few rays
+    const int numberOfBruteForceRays = 20;
+    timer.restart();
+    for(int i = 0; i < numberOfBruteForceRays; i++) {
+        bruteForceIntersects(objects, rays.at(i));
+    }
+    qint64 bruteForceTime = timer.nsecsElapsed() / numberOfBruteForceRays;
+
+    double perPick = pickTime / static_cast<double>(rays.size());
+    WARN("Triangles:" << intersecter.primitiveCount()
+         << " build:" << buildTime * 1e-6 << "ms"
+         << " hits:" << hits << "/" << rays.size()
+         << " per pick:" << perPick * 1e-3 << "us"
+         << " brute force per pick:" << bruteForceTime * 1e-3 << "us"
+         << " speedup:" << bruteForceTime / perPick << "x");
+    CHECK(perPick < bruteForceTime);
+}
@@ -0,0 +1,165 @@
+//Catch includes
+#include "catch.hpp"
+
+//Our includes
+#include "cwImageCache.h"
+
+//Qt includes
+#include <QtConcurrent>
+#include <QAtomicInt>
+#include <QThread>
+
+static QImage testImage(int width, int height, QColor color) {
+    QImage image(width, height, QImage::Format_ARGB32);
+    image.fill(color);
+    return image;
+}
+
+TEST_CASE("cwImageCache should only decode images once", "[cwImageCache]") {
+    cwImageCache cache;
+
+    int decodeCount = 0;
+    auto decode = [&decodeCount]() {
+        decodeCount++;
+        return testImage(16, 16, Qt::red);
+    };
+
+    cwImageCache::Key key("test.cw", 1);
+    CHECK(!cache.contains(key));
+
+    QImage image1 = cache.image(key, decode);
+    QImage image2 = cache.image(key, decode);
+
+    CHECK(decodeCount == 1);
+    CHECK(cache.contains(key));
+    CHECK(image1 == image2);
+    CHECK(image1.pixelColor(0, 0) == QColor(Qt::red));
+
+    SECTION("Levels, ids and files are different images") {
+        cache.image(cwImageCache::Key("test.cw", 1, 1), decode);
+        cache.image(cwImageCache::Key("test.cw", 2), decode);
+        cache.image(cwImageCache::Key("other.cw", 1), decode);
+        CHECK(decodeCount == 4);
+
+        auto stats = cache.statistics();
+        CHECK(stats.Hits == 1);
+        CHECK(stats.Misses == 4);
+        CHECK(stats.Count == 4);
+        CHECK(stats.Bytes == 4 * image1.sizeInBytes());
+    }
+
+    SECTION("Remove all levels of an image") {
+        cache.image(cwImageCache::Key("test.cw", 1, 1), decode);
+        cache.image(cwImageCache::Key("test.cw", 2), decode);
+
+        cache.remove("test.cw", 1);
+        CHECK(!cache.contains(key));
+        CHECK(!cache.contains(cwImageCache::Key("test.cw", 1, 1)));
+        CHECK(cache.contains(cwImageCache::Key("test.cw", 2)));
+        CHECK(cache.statistics().Count == 1);
+
+        cache.image(key, decode);
+        CHECK(decodeCount == 4);
+    }
+
+    SECTION("Clear") {
+        cache.clear();
+        CHECK(!cache.contains(key));
+        CHECK(cache.statistics().Bytes == 0);
+        CHECK(cache.statistics().Count == 0);
+    }
+
+    SECTION("Null images aren't cached") {
+        int nullCount = 0;
+        auto decodeNull = [&nullCount]() {
+            nullCount++;
+            return QImage();
+        };
+
+        cwImageCache::Key nullKey("test.cw", 3);
+        CHECK(cache.image(nullKey, decodeNull).isNull());
+        CHECK(cache.image(nullKey, decodeNull).isNull());
+        CHECK(nullCount == 2);
+        CHECK(!cache.contains(nullKey));
+    }
+}
+
+TEST_CASE("cwImageCache should evict the least recently used images", "[cwImageCache]") {
+    const QImage image = testImage(16, 16, Qt::blue);
+    const qint64 imageBytes = image.sizeInBytes();
+
+    cwImageCache cache(imageBytes * 3);
+    auto decode = [image]() { return image; };
+
+    cache.image(cwImageCache::Key("test.cw", 1), decode);
+    cache.image(cwImageCache::Key("test.cw", 2), decode);
+    cache.image(cwImageCache::Key("test.cw", 3), decode);
+
+    //Touch 1, so 2 is the least recently used
+    cache.image(cwImageCache::Key("test.cw", 1), decode);
+    cache.image(cwImageCache::Key("test.cw", 4), decode);
+
+    CHECK(cache.contains(cwImageCache::Key("test.cw", 1)));
+    CHECK(!cache.contains(cwImageCache::Key("test.cw", 2)));
+    CHECK(cache.contains(cwImageCache::Key("test.cw", 3)));
+    CHECK(cache.contains(cwImageCache::Key("test.cw", 4)));
+
+    auto stats = cache.statistics();
+    CHECK(stats.Evictions == 1);
+    CHECK(stats.Count == 3);
+    CHECK(stats.Bytes == imageBytes * 3);
+
+    SECTION("Shrinking the budget evicts") {
+        cache.setMaxBytes(imageBytes);
+        CHECK(cache.statistics().Count == 1);
+        CHECK(cache.statistics().Evictions == 3);
+        CHECK(cache.contains(cwImageCache::Key("test.cw", 4)));
+    }
+
+    SECTION("Images larger than the budget are returned, but not cached") {
+        cwImageCache::Key bigKey("test.cw", 5);
+        QImage big = cache.image(bigKey, []() { return testImage(64, 64, Qt::green); });
+        CHECK(!big.isNull());
+        CHECK(!cache.contains(bigKey));
+        CHECK(cache.statistics().Count == 3);
+    }
+
+    SECTION("Reset statistics") {
+        cache.resetStatistics();
+        stats = cache.statistics();
+        CHECK(stats.Hits == 0);
+        CHECK(stats.Misses == 0);
+        CHECK(stats.Evictions == 0);
+        CHECK(stats.Count == 3);
+    }
+}
+
+TEST_CASE("cwImageCache should decode an image once when requested from multiple threads", "[cwImageCache]") {
+    cwImageCache cache;
+    QAtomicInt decodeCount;
+
+    auto decode = [&decodeCount]() {
+        decodeCount.fetchAndAddOrdered(1);
+        QThread::msleep(50);
+        return testImage(32, 32, Qt::yellow);
+    };
+
+    QList<int> requests;
+    for(int i = 0; i < 16; i++) {
+        requests.append(1);
+    }
+    std::function<QImage (int)> requestImage = [&cache, decode](int id) {
+        return cache.image(cwImageCache::Key("test.cw", id), decode);
+    };
+
+    auto images = QtConcurrent::blockingMapped(requests, requestImage);
+
+    CHECK(decodeCount.loadAcquire() == 1);
+    for(const QImage& image : images) {
+        CHECK(image.pixelColor(0, 0) == QColor(Qt::yellow));
+    }
+
+    auto stats = cache.statistics();
+    CHECK(stats.Misses == 1);
+    CHECK(stats.Hits == requests.size() - 1);
+}
@@ -0,0 +1,139 @@
+//Catch includes
+#include "catch.hpp"
+
+//Our includes
+#include "cwImageDatabaseWriter.h"
+#include "cwImageDatabase.h"
+#include "cwImageProvider.h"
+#include "cwProject.h"
+
+//Qt includes
+#include <QElapsedTimer>
+#include <QtConcurrent>
+#include <QSet>
+
+namespace {
+
+cwImageData createImageData(int index)
+{
+    QByteArray data(64 * 1024, static_cast<char>(index));
+    return cwImageData(QSize(128, 128), 0, "test", data);
+}
+
+}
+
+TEST_CASE("cwImageDatabaseWriter should add and update images", "[cwImageDatabaseWriter]") {
+    cwProject project;
+    QString filename = project.filename();
+
+    cwImageProvider provider;
+    provider.setProjectPath(filename);
+
+    QList<QFuture<int>> futures;
+
+    {
+        cwImageDatabaseWriter writer(filename);
+        writer.setMaxBatchSize(3);
+        CHECK(writer.maxBatchSize() == 3);
+
+        for(int i = 0; i < 10; i++) {
+            futures.append(writer.addImage(createImageData(i)));
+        }
+
+        //Waits for a single image
+        int firstId = futures.first().result();
+        CHECK(firstId > 0);
+
+        SECTION("Update an existing image") {
+            int updatedId = writer.addOrUpdateImage(createImageData(20), firstId).result();
+            CHECK(updatedId == firstId);
+            CHECK(provider.data(firstId).data() == createImageData(20).data());
+        }
+
+        SECTION("Update an image that doesn't exist") {
+            int newId = writer.addOrUpdateImage(createImageData(30), 10000).result();
+            CHECK(newId != 10000);
+            CHECK(provider.data(newId).data() == createImageData(30).data());
+        }
+
+        //Destroying the writer, writes all the images that are left
+    }
+
+    QSet<int> ids;
+    for(int i = 0; i < futures.size(); i++) {
+        INFO("Image:" << i);
+        REQUIRE(futures.at(i).isFinished());
+        int id = futures.at(i).result();
+        ids.insert(id);
+
+        CHECK(cwImageDatabase(filename).imageExists(id));
+        if(i > 0) {
+            CHECK(provider.data(id).data() == createImageData(i).data());
+        }
+    }
+    CHECK(ids.size() == futures.size());
+}
+
+TEST_CASE("cwImageDatabaseWriter should add images from many threads", "[cwImageDatabaseWriter]") {
+    cwProject project;
+    QString filename = project.filename();
+
+    QList<int> indexes;
+    for(int i = 0; i < 100; i++) {
+        indexes.append(i);
+    }
+
+    cwImageDatabaseWriter writer(filename);
+
+    std::function<int (int)> addImage = [&writer](int index) {
+        return writer.addImage(createImageData(index)).result();
+    };
+
+    QList<int> ids = QtConcurrent::blockingMapped(indexes, addImage);
+    REQUIRE(ids.size() == indexes.size());
+
+    cwImageProvider provider;
+    provider.setProjectPath(filename);
+    for(int i = 0; i < ids.size(); i++) {
+        INFO("Image:" << i);
+        CHECK(provider.data(ids.at(i)).data() == createImageData(i).data());
+    }
+}
+
+TEST_CASE("Benchmark cwImageDatabaseWriter against a connection per image", "[cwImageDatabaseWriter][.benchmark]") {
+    cwProject project;
+    QString filename = project.filename();
+
+    //Similar to the mipmaps and icons of ~300 scanned note pages
+    QList<int> indexes;
+    for(int i = 0; i < 3000; i++) {
+        indexes.append(i);
+    }
+
+    QElapsedTimer timer;
+
+    timer.start();
+    std::function<int (int)> connectionPerImage = [filename](int index) {
+        return cwImageDatabase(filename).addImage(createImageData(index));
+    };
+    QList<int> connectionIds = QtConcurrent::blockingMapped(indexes, connectionPerImage);
+    qint64 connectionTime = timer.nsecsElapsed();
+
+    timer.restart();
+    QList<int> writerIds;
+    {
+        cwImageDatabaseWriter writer(filename);
+        std::function<int (int)> batched = [&writer](int index) {
+            return writer.addImage(createImageData(index)).result();
+        };
+        writerIds = QtConcurrent::blockingMapped(indexes, batched);
+    }
+    qint64 writerTime = timer.nsecsElapsed();
+
+    CHECK(connectionIds.size() == writerIds.size());
+
+    WARN("Images:" << indexes.size()
+         << " connection per image:" << connectionTime * 1e-6 << "ms"
+         << " cwImageDatabaseWriter:" << writerTime * 1e-6 << "ms"
+         << " speedup:" << connectionTime / static_cast<double>(writerTime) << "x");
+}
@@ -0,0 +1,403 @@
+//Catch includes
+#include "catch.hpp"
+
+//Our includes
+#include "cwImageProvider.h"
+#include "cwImageDatabase.h"
+#include "cwProject.h"
+#include "cwSQLManager.h"
+#include "cwImageCache.h"
+#include "cwDXT1Encoder.h"
+#include "cwOpenGLUtils.h"
+
+//Qt includes
+#include <QElapsedTimer>
+#include <QtConcurrent>
+#include <QSqlQuery>
+#include <QBuffer>
+
+namespace {
+
+cwImageData createImageData(QSize size, int index)
+{
+    QByteArray data(size.width() * size.height() / 2, static_cast<char>(index));
+    return cwImageData(size, 0, "test", data);
+}
+
+cwImageData encodedImageData(QSize size, QColor color, const char* format)
+{
+    QImage image(size, QImage::Format_RGB32);
+    image.fill(color);
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, format);
+    return cwImageData(size, 0, format, data);
+}
+
+cwImageData dxt1ImageData(QSize size, QColor color)
+{
+    QImage image(size, QImage::Format_RGB32);
+    image.fill(color);
+    return cwImageProvider::createDxt1(size, cwDXT1Encoder::compressImage(image, cwDXT1Encoder::RangeFit));
+}
+
+bool fuzzyColor(const QImage& image, QColor color)
+{
+    QColor center = image.pixelColor(image.width() / 2, image.height() / 2);
+    return qAbs(center.red() - color.red()) <= 8
+            && qAbs(center.green() - color.green()) <= 8
+            && qAbs(center.blue() - color.blue()) <= 8;
+}
+
+/**
+ * How cwImageProvider::data() used to read images, a new connection and query for each request
+ */
+cwImageData unpooledData(const QString& filename, int id)
+{
+    static QAtomicInt connectionCounter;
+    QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", QString("unpooled/%1").arg(connectionCounter.fetchAndAddAcquire(1)));
+    database.setDatabaseName(filename);
+    database.open();
+
+    cwImageData imageData;
+    {
+        cwSQLManager::Transaction transaction(database, cwSQLManager::ReadOnly);
+        QSqlQuery query(database);
+        query.prepare("SELECT type,width,height,dotsPerMeter,imageData from Images where id=?");
+        query.bindValue(0, id);
+        query.exec();
+        if(query.next()) {
+            imageData = cwImageData(QSize(query.value(1).toInt(), query.value(2).toInt()),
+                                    query.value(3).toInt(),
+                                    query.value(0).toByteArray(),
+                                    query.value(4).toByteArray());
+        }
+    }
+
+    QString connectionName = database.connectionName();
+    database.close();
+    database = QSqlDatabase();
+    QSqlDatabase::removeDatabase(connectionName);
+    return imageData;
+}
+
+}
+
+TEST_CASE("cwImageProvider should read images with pooled connections", "[cwImageProvider]") {
+    cwProject project;
+    QString filename = project.filename();
+
+    QList<int> ids;
+    {
+        cwImageDatabase database(filename);
+        for(int i = 0; i < 10; i++) {
+            ids.append(database.addImage(createImageData(QSize(16, 16), i)));
+        }
+    }
+
+    cwImageProvider provider;
+    provider.setProjectPath(filename);
+
+    SECTION("Single images") {
+        for(int i = 0; i < ids.size(); i++) {
+            CHECK(provider.data(ids.at(i)).data() == createImageData(QSize(16, 16), i).data());
+            CHECK(provider.data(ids.at(i), true).data().isEmpty());
+            CHECK(provider.data(ids.at(i), true).size() == QSize(16, 16));
+        }
+    }
+
+    SECTION("Batches keep the order of the ids, and missing images are empty") {
+        QList<int> batchIds = {ids.at(3), 100000, ids.at(1)};
+        QList<cwImageData> images = provider.data(batchIds);
+        REQUIRE(images.size() == 3);
+        CHECK(images.at(0).data() == createImageData(QSize(16, 16), 3).data());
+        CHECK(images.at(1).data().isEmpty());
+        CHECK(images.at(2).data() == createImageData(QSize(16, 16), 1).data());
+    }
+
+    SECTION("Images added after the connection is open can be read") {
+        provider.data(ids.first());
+        int newId = cwImageDatabase(filename).addImage(createImageData(QSize(16, 16), 20));
+        CHECK(provider.data(newId).data() == createImageData(QSize(16, 16), 20).data());
+    }
+
+    SECTION("Closing the connections") {
+        auto readInThread = [&provider, &ids]() {
+            return QtConcurrent::run([&provider, &ids]() {
+                return provider.data(ids.last()).data();
+            }).result();
+        };
+
+        provider.data(ids.first());
+        CHECK(readInThread() == createImageData(QSize(16, 16), 9).data());
+
+        cwImageProvider::closeReadConnections();
+        CHECK(provider.data(ids.first()).data() == createImageData(QSize(16, 16), 0).data());
+        CHECK(readInThread() == createImageData(QSize(16, 16), 9).data());
+    }
+
+    SECTION("Retired connections are closed by the thread that owns them") {
+        QThreadPool pool;
+        pool.setMaxThreadCount(1);
+
+        auto readInPool = [&pool](const cwImageProvider& threadProvider, int id) {
+            return QtConcurrent::run(&pool, [&threadProvider, id]() {
+                return threadProvider.data(id).data();
+            }).result();
+        };
+
+        CHECK(readInPool(provider, ids.last()) == createImageData(QSize(16, 16), 9).data());
+        CHECK(cwImageProvider::hasReadConnections(filename));
+
+        QAtomicInt closed(0);
+        cwImageProvider::closeReadConnections();
+        cwImageProvider::whenReadConnectionsClosed(filename, [&closed]() { closed.storeRelease(1); });
+
+        //The pool's thread hasn't read anything, so it still has the connection open
+        CHECK(cwImageProvider::hasReadConnections(filename));
+        CHECK(closed.loadAcquire() == 0);
+
+        //Reading another project closes the retired connection
+        cwImageProvider missingProvider;
+        missingProvider.setProjectPath("this/doesnt/exist.cw");
+        CHECK(readInPool(missingProvider, ids.first()).isEmpty());
+
+        CHECK(!cwImageProvider::hasReadConnections(filename));
+        CHECK(closed.loadAcquire() == 1);
+
+        //Connections are opened again
+        CHECK(readInPool(provider, ids.last()) == createImageData(QSize(16, 16), 9).data());
+        CHECK(cwImageProvider::hasReadConnections(filename));
+    }
+
+    SECTION("Many threads") {
+        std::function<bool (int)> readImage = [filename, ids](int id) {
+            cwImageProvider threadProvider;
+            threadProvider.setProjectPath(filename);
+            return threadProvider.data(id).data() == createImageData(QSize(16, 16), ids.indexOf(id)).data();
+        };
+        QList<bool> results = QtConcurrent::blockingMapped(ids, readImage);
+        CHECK(results == QList<bool>({true, true, true, true, true, true, true, true, true, true}));
+    }
+
+    SECTION("Projects that don't exist return empty images") {
+        cwImageProvider missingProvider;
+        missingProvider.setProjectPath("this/doesnt/exist.cw");
+        CHECK(missingProvider.data(ids.first()).data().isEmpty());
+        CHECK(missingProvider.data(ids).size() == ids.size());
+    }
+}
+
+TEST_CASE("cwImageProvider should decode thumbnails from the cheapest source", "[cwImageProvider]") {
+    cwProject project;
+    QString filename = project.filename();
+
+    //Each source is a different color, so the test can tell which one was used
+    cwImage image;
+    {
+        cwImageDatabase database(filename);
+        image.setOriginal(database.addImage(encodedImageData(QSize(512, 256), Qt::red, "png")));
+        image.setIcon(database.addImage(encodedImageData(QSize(64, 32), Qt::green, "png")));
+        image.setMipmaps({
+                             database.addImage(dxt1ImageData(QSize(512, 256), Qt::white)),
+                             database.addImage(dxt1ImageData(QSize(256, 128), Qt::blue)),
+                             database.addImage(dxt1ImageData(QSize(128, 64), Qt::yellow))
+                         });
+    }
+    image.setOriginalSize(QSize(512, 256));
+
+    cwImageProvider provider;
+    provider.setProjectPath(filename);
+    cwImageCache::instance()->clear();
+
+    QString id = cwImageProvider::imageId(image);
+    QSize size;
+
+    SECTION("Image ids round trip") {
+        cwImage parsed = cwImageProvider::fromImageId(id);
+        CHECK(parsed.original() == image.original());
+        CHECK(parsed.icon() == image.icon());
+        CHECK(parsed.mipmaps() == image.mipmaps());
+
+        cwImage plain = cwImageProvider::fromImageId(QString::number(image.original()));
+        CHECK(plain.original() == image.original());
+        CHECK(!plain.isIconValid());
+        CHECK(plain.mipmaps().isEmpty());
+
+        CHECK(!cwImageProvider::fromImageId("notAnId").isOriginalValid());
+    }
+
+    SECTION("Small requests use the icon") {
+        QImage result = provider.requestImage(id, &size, QSize(64, 64));
+        CHECK(result.size() == QSize(64, 32));
+        CHECK(size == result.size());
+        CHECK(fuzzyColor(result, Qt::green));
+    }
+
+    SECTION("Larger requests use the nearest mipmap") {
+        QImage result = provider.requestImage(id, &size, QSize(100, 100));
+        CHECK(result.size() == QSize(100, 50));
+        CHECK(fuzzyColor(result, Qt::yellow));
+
+        result = provider.requestImage(id, &size, QSize(200, 0));
+        CHECK(result.size() == QSize(200, 100));
+        CHECK(fuzzyColor(result, Qt::blue));
+    }
+
+    SECTION("Plain ids decode a reduced original") {
+        QImage result = provider.requestImage(QString::number(image.original()), &size, QSize(100, 100));
+        CHECK(result.size() == QSize(100, 50));
+        CHECK(fuzzyColor(result, Qt::red));
+        CHECK(cwImageCache::instance()->contains(cwImageCache::Key(filename, image.original(), 2)));
+        CHECK(!cwImageCache::instance()->contains(cwImageCache::Key(filename, image.original())));
+    }
+
+    SECTION("Requests larger than the mipmaps use the original") {
+        QImage result = provider.requestImage(id, &size, QSize(400, 400));
+        CHECK(result.size() == QSize(400, 200));
+        CHECK(fuzzyColor(result, Qt::red));
+        CHECK(cwImageCache::instance()->contains(cwImageCache::Key(filename, image.original())));
+
+        SECTION("Cached originals are used for small requests") {
+            result = provider.requestImage(id, &size, QSize(64, 64));
+            CHECK(fuzzyColor(result, Qt::red));
+        }
+    }
+
+    SECTION("No requested size returns the original") {
+        QImage result = provider.requestImage(id, &size, QSize());
+        CHECK(result.size() == QSize(512, 256));
+        CHECK(fuzzyColor(result, Qt::red));
+    }
+
+    cwImageCache::instance()->clear();
+}
+
+TEST_CASE("cwImageProvider should decompress dxt1 mipmaps", "[cwImageProvider]") {
+    //Not a multiple of 4, so the blocks are padded
+    QImage image(30, 18, QImage::Format_RGB32);
+    image.fill(Qt::blue);
+    for(int y = 0; y < 8; y++) {
+        for(int x = 0; x < image.width(); x++) {
+            image.setPixelColor(x, y, Qt::red);
+        }
+    }
+
+    cwImageData dxt1(image.size(), 0, cwImageProvider::dxt1GzExtension(),
+                     cwDXT1Encoder::compressImage(image, cwDXT1Encoder::RangeFit));
+
+    QImage decompressed = cwImageProvider::decompressDxt1(dxt1);
+    REQUIRE(decompressed.size() == image.size());
+    CHECK(cwOpenGLUtils::fuzzyCompareColors(decompressed.pixelColor(0, 0), Qt::red) <= 16);
+    CHECK(cwOpenGLUtils::fuzzyCompareColors(decompressed.pixelColor(29, 7), Qt::red) <= 16);
+    CHECK(cwOpenGLUtils::fuzzyCompareColors(decompressed.pixelColor(0, 8), Qt::blue) <= 16);
+    CHECK(cwOpenGLUtils::fuzzyCompareColors(decompressed.pixelColor(29, 17), Qt::blue) <= 16);
+
+    cwImageData truncated(image.size(), 0, cwImageProvider::dxt1GzExtension(), QByteArray(8, 0));
+    CHECK(cwImageProvider::decompressDxt1(truncated).isNull());
+}
+
+TEST_CASE("Benchmark cwImageProvider thumbnails", "[cwImageProvider][.benchmark]") {
+    cwProject project;
+    QString filename = project.filename();
+
+    const int numberOfPages = 10;
+    QList<int> ids;
+    {
+        cwImageDatabase database(filename);
+        for(int i = 0; i < numberOfPages; i++) {
+            ids.append(database.addImage(encodedImageData(QSize(4096, 4096), QColor(i * 20, 0, 0), "jpg")));
+        }
+    }
+
+    cwImageProvider provider;
+    provider.setProjectPath(filename);
+
+    //Full resolution decode, then scale, like requestImage used to
+    QElapsedTimer timer;
+    timer.start();
+    for(int id : ids) {
+        QImage image = provider.image(provider.data(id));
+        image.scaled(QSize(200, 200), Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    qint64 fullTime = timer.nsecsElapsed();
+
+    cwImageCache::instance()->clear();
+
+    timer.restart();
+    QSize size;
+    for(int id : ids) {
+        provider.requestImage(QString::number(id), &size, QSize(200, 200));
+    }
+    qint64 thumbnailTime = timer.nsecsElapsed();
+
+    cwImageCache::instance()->clear();
+
+    WARN("Pages:" << numberOfPages
+         << " full decode:" << fullTime * 1e-6 << "ms"
+         << " thumbnail decode:" << thumbnailTime * 1e-6 << "ms"
+         << " speedup:" << fullTime / static_cast<double>(thumbnailTime) << "x");
+}
+
+TEST_CASE("Benchmark cwImageProvider reads", "[cwImageProvider][.benchmark]") {
+    cwProject project;
+    QString filename = project.filename();
+
+    //Icons, and a mipmap chain for a 2048x2048 image
+    QList<int> iconIds;
+    QList<int> mipmapIds;
+    {
+        cwImageDatabase database(filename);
+        for(int i = 0; i < 200; i++) {
+            iconIds.append(database.addImage(createImageData(QSize(64, 64), i)));
+        }
+        for(int size = 2048; size >= 1; size /= 2) {
+            mipmapIds.append(database.addImage(createImageData(QSize(size, size), size)));
+        }
+    }
+
+    cwImageProvider provider;
+    provider.setProjectPath(filename);
+
+    auto requestsPerSecond = [](int requests, qint64 nsecs) {
+        return requests / (nsecs * 1e-9);
+    };
+
+    QElapsedTimer timer;
+
+    timer.start();
+    for(int id : iconIds) {
+        unpooledData(filename, id);
+    }
+    double unpooledIcons = requestsPerSecond(iconIds.size(), timer.nsecsElapsed());
+
+    timer.restart();
+    for(int id : iconIds) {
+        provider.data(id);
+    }
+    double pooledIcons = requestsPerSecond(iconIds.size(), timer.nsecsElapsed());
+
+    const int numberOfChains = 20;
+    timer.restart();
+    for(int i = 0; i < numberOfChains; i++) {
+        for(int id : mipmapIds) {
+            unpooledData(filename, id);
+        }
+    }
+    double unpooledChains = requestsPerSecond(numberOfChains, timer.nsecsElapsed());
+
+    timer.restart();
+    for(int i = 0; i < numberOfChains; i++) {
+        provider.data(mipmapIds);
+    }
+    double pooledChains = requestsPerSecond(numberOfChains, timer.nsecsElapsed());
+
+    WARN("Icons per second, unpooled:" << unpooledIcons << " pooled:" << pooledIcons
+         << " speedup:" << pooledIcons / unpooledIcons << "x");
+    WARN("Mipmap chains (" << mipmapIds.size() << " levels) per second, unpooled:" << unpooledChains
+         << " pooled batch:" << pooledChains
+         << " speedup:" << pooledChains / unpooledChains << "x");
+    CHECK(pooledIcons > unpooledIcons);
+}
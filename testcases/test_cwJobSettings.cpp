@@ -4,6 +4,7 @@
 //Our includes
 #include "cwJobSettings.h"
 #include "SpyChecker.h"
+#include "cwImageCache.h"
 
 //Qt includes
 #include <QThread>
@@ -21,13 +22,16 @@ TEST_CASE("cwJobSettings should initilize correctly and update settings correcly
 
     QSignalSpy threadCountSpy(settings, &cwJobSettings::threadCountChanged);
     QSignalSpy autoUpdateSpy(settings, &cwJobSettings::automaticUpdateChanged);
+    QSignalSpy imageCacheSizeSpy(settings, &cwJobSettings::imageCacheSizeChanged);
 
     threadCountSpy.setObjectName("threadCountSpy");
     autoUpdateSpy.setObjectName("autoUpdateSpy");
+    imageCacheSizeSpy.setObjectName("imageCacheSizeSpy");
 
     SpyChecker checker = {
         {&threadCountSpy, 0},
-        {&autoUpdateSpy, 0}
+        {&autoUpdateSpy, 0},
+        {&imageCacheSizeSpy, 0}
     };
 
     QSettings diskSettings;
@@ -65,6 +69,26 @@ TEST_CASE("cwJobSettings should initilize correctly and update settings correcly
         CHECK(diskSettings.value("automaticUpdate").toBool() == true);
     }
 
+    SECTION("Check image cache size") {
+        CHECK(settings->imageCacheSize() == cwJobSettings::defaultImageCacheSize());
+
+        settings->setImageCacheSize(64);
+        checker[&imageCacheSizeSpy]++;
+        checker.checkSpies();
+
+        CHECK(settings->imageCacheSize() == 64);
+        CHECK(cwImageCache::instance()->maxBytes() == 64 * 1024 * 1024);
+        CHECK(diskSettings.value("imageCacheSize").toInt() == 64);
+
+        settings->setImageCacheSize(-1);
+        checker.checkSpies();
+        CHECK(settings->imageCacheSize() == 64);
+
+        settings->setImageCacheSize(cwJobSettings::defaultImageCacheSize());
+        checker[&imageCacheSizeSpy]++;
+        checker.checkSpies();
+    }
+
     diskSettings.clear();
 
     CHECK(settings->threadCount() == QThread::idealThreadCount());
@@ -0,0 +1,100 @@
+//Catch includes
+#include "catch.hpp"
+
+//Our includes
+#include "cwLabel3dView.h"
+#include "cwGlyphAtlas.h"
+#include "cwSGLabelsNode.h"
+#include "cwLabelDeclutter.h"
+
+TEST_CASE("cwGlyphAtlas should render glyphs once", "[cwLabel3dView]") {
+    cwGlyphAtlas atlas;
+
+    CHECK(atlas.font().pixelSize() == 16);
+    CHECK(!atlas.contains('A'));
+
+    CHECK(atlas.addText("A1"));
+    CHECK(!atlas.addText("1A"));
+    CHECK(atlas.contains('A'));
+    CHECK(atlas.contains('1'));
+
+    cwGlyphAtlas::Glyph glyph = atlas.glyph('A');
+    CHECK(glyph.Advance > 0.0);
+    CHECK(QRect(QPoint(), atlas.image().size()).contains(glyph.AtlasRect));
+    CHECK(glyph.Rect.size() == QSizeF(glyph.AtlasRect.size()));
+
+    QSizeF size = atlas.textSize("A1A");
+    CHECK(size.width() == Approx(glyph.Advance * 2.0 + atlas.glyph('1').Advance));
+    CHECK(size.height() > 0.0);
+
+    SECTION("The atlas grows, without moving glyphs") {
+        QString text;
+        for(ushort i = 0x100; i < 0x400; i++) {
+            text.append(QChar(i));
+        }
+
+        QSize oldSize = atlas.image().size();
+        QImage oldImage = atlas.image();
+        CHECK(atlas.addText(text));
+
+        CHECK(atlas.image().height() > oldSize.height());
+        CHECK(atlas.glyph('A').AtlasRect == glyph.AtlasRect);
+        CHECK(atlas.image().copy(glyph.AtlasRect) == oldImage.copy(glyph.AtlasRect));
+    }
+
+    SECTION("Copies don't change") {
+        cwGlyphAtlas copy = atlas;
+        atlas.addText("xyz");
+        CHECK(!copy.contains('x'));
+        CHECK(atlas.contains('x'));
+    }
+}
+
+TEST_CASE("cwSGLabelsNode should have a quad for each character", "[cwLabel3dView]") {
+    cwGlyphAtlas atlas;
+    atlas.addText("A1");
+
+    QVector<cwSGLabelsNode::Label> labels({
+                                              {QPointF(0.0, 0.0), "A1"},
+                                              {QPointF(10.0, 10.0), "1"},
+                                              {QPointF(20.0, 20.0), "Z"} //Not in the atlas
+                                          });
+
+    CHECK(cwSGLabelsNode::vertexCount(labels, atlas) == 18);
+}
+
+TEST_CASE("cwLabel3dView should place labels off the GUI thread", "[cwLabel3dView]") {
+    cwGlyphAtlas atlas;
+    atlas.addText("a1a2a3a4");
+
+    //With an identity matrix, the center of the viewport is (0, 0, 0)
+    QMatrix4x4 viewProjection;
+    QRect viewport(0, 0, 400, 400);
+
+    QList<cwLabel3dItem> firstGroup({
+                                        cwLabel3dItem("a1", QVector3D(0.0, 0.0, 0.0)),
+                                        cwLabel3dItem("a2", QVector3D(0.0, 0.0, 0.0)), //Overlaps a1
+                                        cwLabel3dItem("a3", QVector3D(2.0, 0.0, 0.0)) //Clipped
+                                    });
+    QList<cwLabel3dItem> secondGroup({
+                                         cwLabel3dItem("a4", QVector3D(-0.5, -0.5, 0.0))
+                                     });
+
+    cwLabelDeclutter declutter;
+    auto labels = cwLabel3dView::placeLabels({firstGroup, secondGroup}, atlas, viewProjection, viewport, &declutter);
+
+    REQUIRE(labels.size() == 2);
+    CHECK(labels.at(0).Text == "a1");
+    CHECK(labels.at(0).Position == QPointF(200.0, 200.0));
+    CHECK(labels.at(1).Text == "a4");
+    CHECK(labels.at(1).Position == QPointF(100.0, 300.0));
+
+    SECTION("Higher priority labels are placed first") {
+        firstGroup[1].setPriority(1);
+        labels = cwLabel3dView::placeLabels({firstGroup, secondGroup}, atlas, viewProjection, viewport, &declutter);
+
+        REQUIRE(labels.size() == 2);
+        CHECK(labels.at(0).Text == "a2");
+        CHECK(labels.at(1).Text == "a4");
+    }
+}
@@ -0,0 +1,183 @@
+//Catch includes
+#include "catch.hpp"
+
+//Our includes
+#include "cwLabelDeclutter.h"
+#include "cwCollisionRectKdTree.h"
+
+//Qt includes
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+
+//Std includes
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+QVector<int> placedIds(const QVector<cwLabelDeclutter::Label>& labels, const QVector<int>& placed)
+{
+    QVector<int> ids;
+    for(int index : placed) {
+        ids.append(labels.at(index).Id);
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+}
+
+TEST_CASE("cwLabelDeclutter should place labels that don't overlap", "[cwLabelDeclutter]") {
+    cwLabelDeclutter declutter;
+    declutter.setCellSize(32);
+    QRect viewport(0, 0, 200, 200);
+
+    SECTION("Overlapping labels are placed by id") {
+        QVector<cwLabelDeclutter::Label> labels({
+                                                    {2, QRect(10, 10, 40, 20), 0},
+                                                    {1, QRect(30, 15, 40, 20), 0},
+                                                    {3, QRect(100, 100, 40, 20), 0},
+                                                    {4, QRect(60, 10, 40, 20), 0} //Overlaps id 1
+                                                });
+        QVector<int> placed = declutter.declutter(labels, viewport);
+        CHECK(placed == QVector<int>({1, 2}));
+        CHECK(declutter.wasVisible(1));
+        CHECK(!declutter.wasVisible(2));
+        CHECK(!declutter.budgetExceeded());
+    }
+
+    SECTION("Higher priority labels are placed first") {
+        QVector<cwLabelDeclutter::Label> labels({
+                                                    {1, QRect(10, 10, 40, 20), 0},
+                                                    {2, QRect(30, 15, 40, 20), 5},
+                                                });
+        CHECK(placedIds(labels, declutter.declutter(labels, viewport)) == QVector<int>({2}));
+    }
+
+    SECTION("Labels that span cells and the edge of the viewport collide") {
+        QVector<cwLabelDeclutter::Label> labels({
+                                                    {1, QRect(-20, 150, 190, 10), 0},
+                                                    {2, QRect(160, 140, 100, 40), 0},
+                                                    {3, QRect(0, 0, 1, 1), 0},
+                                                    {4, QRect(5, 5, 0, 0), 0} //Empty
+                                                });
+        CHECK(placedIds(labels, declutter.declutter(labels, viewport)) == QVector<int>({1, 3}));
+    }
+
+    SECTION("Visible labels stay visible while they fit") {
+        QVector<cwLabelDeclutter::Label> firstFrame({
+                                                        {5, QRect(10, 10, 40, 20), 0}
+                                                    });
+        CHECK(placedIds(firstFrame, declutter.declutter(firstFrame, viewport)) == QVector<int>({5}));
+
+        //Id 1 would normally win, but 5 was visible
+        QVector<cwLabelDeclutter::Label> secondFrame({
+                                                         {1, QRect(20, 12, 40, 20), 0},
+                                                         {5, QRect(12, 10, 40, 20), 0}
+                                                     });
+        CHECK(placedIds(secondFrame, declutter.declutter(secondFrame, viewport)) == QVector<int>({5}));
+
+        //Priority still wins
+        QVector<cwLabelDeclutter::Label> thirdFrame({
+                                                        {1, QRect(20, 12, 40, 20), 1},
+                                                        {5, QRect(12, 10, 40, 20), 0}
+                                                    });
+        CHECK(placedIds(thirdFrame, declutter.declutter(thirdFrame, viewport)) == QVector<int>({1}));
+
+        declutter.declutter(firstFrame, viewport);
+        declutter.clearHistory();
+        CHECK(!declutter.wasVisible(5));
+        CHECK(placedIds(secondFrame, declutter.declutter(secondFrame, viewport)) == QVector<int>({1}));
+    }
+
+    SECTION("The time budget drops the least important labels") {
+        QVector<cwLabelDeclutter::Label> labels;
+        for(int i = 0; i < 100000; i++) {
+            labels.append(cwLabelDeclutter::Label(i, QRect(i % 200, (i / 200) % 200, 2, 2), i == 99999 ? 1 : 0));
+        }
+
+        declutter.setTimeBudget(1);
+        QVector<int> placed = declutter.declutter(labels, viewport);
+        CHECK(declutter.budgetExceeded());
+        REQUIRE(!placed.isEmpty());
+        CHECK(placed.first() == 99999);
+
+        declutter.setTimeBudget(0);
+        declutter.declutter(labels, viewport);
+        CHECK(!declutter.budgetExceeded());
+    }
+}
+
+TEST_CASE("Benchmark cwLabelDeclutter", "[cwLabelDeclutter][.benchmark]") {
+    const int numberOfLabels = 20000;
+    const int numberOfFrames = 30;
+    QRect viewport(0, 0, 1920, 1080);
+
+    QRandomGenerator generator(42);
+    QVector<cwLabelDeclutter::Label> labels;
+    labels.reserve(numberOfLabels);
+    for(int i = 0; i < numberOfLabels; i++) {
+        QRect rect(generator.bounded(viewport.width()), generator.bounded(viewport.height()),
+                   30 + generator.bounded(20), 18);
+        labels.append(cwLabelDeclutter::Label(i, rect, generator.bounded(4)));
+    }
+
+    //Zooms the view in a little each frame, and counts labels that appear or disappear
+    auto runFrames = [&](std::function<QSet<int>(const QVector<cwLabelDeclutter::Label>&)> place,
+                         qint64* nsecs) {
+        QElapsedTimer timer;
+        QSet<int> lastVisible;
+        int changes = 0;
+        *nsecs = 0;
+
+        for(int frame = 0; frame < numberOfFrames; frame++) {
+            double scale = 1.0 + frame * 0.01;
+            QVector<cwLabelDeclutter::Label> frameLabels = labels;
+            for(auto& label : frameLabels) {
+                QPointF fromCenter = label.Rect.topLeft() - viewport.center();
+                label.Rect.moveTopLeft((viewport.center() + fromCenter * scale).toPoint());
+            }
+
+            timer.start();
+            QSet<int> visible = place(frameLabels);
+            *nsecs += timer.nsecsElapsed();
+
+            if(frame > 0) {
+                changes += (visible - lastVisible).size() + (lastVisible - visible).size();
+            }
+            lastVisible = visible;
+        }
+        return changes;
+    };
+
+    qint64 kdTreeTime;
+    int kdTreeChanges = runFrames([](const QVector<cwLabelDeclutter::Label>& frameLabels) {
+        //The old placement, in label order, rebuilt every frame
+        cwCollisionRectKdTree kdTree;
+        QSet<int> visible;
+        for(const auto& label : frameLabels) {
+            if(kdTree.addRect(label.Rect)) {
+                visible.insert(label.Id);
+            }
+        }
+        return visible;
+    }, &kdTreeTime);
+
+    cwLabelDeclutter declutter;
+    qint64 declutterTime;
+    int declutterChanges = runFrames([&declutter, viewport](const QVector<cwLabelDeclutter::Label>& frameLabels) {
+        QSet<int> visible;
+        for(int index : declutter.declutter(frameLabels, viewport)) {
+            visible.insert(frameLabels.at(index).Id);
+        }
+        return visible;
+    }, &declutterTime);
+
+    WARN("Labels:" << numberOfLabels << " frames:" << numberOfFrames);
+    WARN("kd-tree: " << kdTreeTime * 1e-6 / numberOfFrames << "ms/frame"
+         << " label changes:" << kdTreeChanges);
+    WARN("cwLabelDeclutter: " << declutterTime * 1e-6 / numberOfFrames << "ms/frame"
+         << " label changes:" << declutterChanges);
+
+    CHECK(declutterChanges <= kdTreeChanges);
+}
@@ -19,6 +19,7 @@
 #include "cwErrorModel.h"
 #include "cwErrorListModel.h"
 #include "cwProject.h"
+#include "cwBulkEdit.h"
 
 //Our includes
 #include "TestHelper.h"
@@ -109,6 +110,33 @@ TEST_CASE("Changing data adding and removing caves trips survey chunks should ru
             CHECK(cave->stationPositionLookup().position("b2") == QVector3D(0.0, 10.0, 0.0));
         }
 
+        SECTION("A bulk edit should re-run line plot when it's done") {
+            {
+                cwBulkEdit<cwTrip> edit(trip);
+                for(int i = 0; i < 10; i++) {
+                    cwShot shot;
+                    shot.setDistance(20);
+                    shot.setCompass(0.0);
+                    shot.setClino(0.0);
+                    trip->addShotToLastChunk(chunk->stations().last(), cwStation(QString("a3-%1").arg(i)), shot);
+                }
+            }
+
+            plotManager->waitToFinish();
+
+            CHECK(cave->length()->value() == Approx(10.0 + 20.0 * 10).epsilon(0.01));
+            CHECK(cave->stationPositionLookup().position("a3-9") == QVector3D(0.0, 210.0, 0.0));
+
+            SECTION("Chunks are connected after the bulk edit") {
+                chunk->setData(cwSurveyChunk::ShotDistanceRole, 0, 20.0);
+
+                plotManager->waitToFinish();
+
+                CHECK(cave->length()->value() == Approx(20.0 + 20.0 * 10).epsilon(0.01));
+                CHECK(cave->stationPositionLookup().position("a3-9") == QVector3D(0.0, 220.0, 0.0));
+            }
+        }
+
         SECTION("Setting shot distance data should re-run line plot") {
             chunk->setData(cwSurveyChunk::ShotDistanceRole, 0, 20.0);
 
@@ -840,3 +868,143 @@ TEST_CASE("cwLinePlotManager automatic update should work", "[cwLinePlotManager]
 }
 
 
+
+TEST_CASE("Only caves that have changed should be re-solved", "[cwLinePlotManager]") {
+    cwCavingRegion region;
+
+    auto addCave = [&region](QString name) {
+        cwCave* cave = new cwCave();
+        cave->setName(name);
+        region.addCave(cave);
+
+        cwTrip* trip = new cwTrip();
+        trip->setName("Trip 1");
+        cave->addTrip(trip);
+
+        cwSurveyChunk* chunk = new cwSurveyChunk();
+        trip->addChunk(chunk);
+
+        cwShot shot;
+        shot.setDistance("10.0");
+        shot.setCompass("0.0");
+        shot.setClino("0.0");
+        chunk->appendShot(cwStation("a1"), cwStation("a2"), shot);
+
+        return cave;
+    };
+
+    cwCave* cave1 = addCave("Cave 1");
+    cwCave* cave2 = addCave("Cave 2");
+
+    auto plotManager = std::make_unique<cwLinePlotManager>();
+    plotManager->setRegion(&region);
+    plotManager->waitToFinish();
+
+    CHECK(cave1->stationPositionLookup().position("a2") == QVector3D(0.0, 10.0, 0.0));
+    CHECK(cave2->stationPositionLookup().position("a2") == QVector3D(0.0, 10.0, 0.0));
+
+    QList<QList<cwCave*>> changedCaves;
+    QList<QList<cwTrip*>> changedTrips;
+    QObject::connect(plotManager.get(), &cwLinePlotManager::stationPositionInCavesChanged,
+                     [&changedCaves](QList<cwCave*> caves) { changedCaves.append(caves); });
+    QObject::connect(plotManager.get(), &cwLinePlotManager::stationPositionInTripsChanged,
+                     [&changedTrips](QList<cwTrip*> trips) { changedTrips.append(trips); });
+
+    cave1->trip(0)->chunk(0)->setData(cwSurveyChunk::ShotDistanceRole, 0, "20.0");
+    plotManager->waitToFinish();
+
+    CHECK(cave1->stationPositionLookup().position("a2") == QVector3D(0.0, 20.0, 0.0));
+    CHECK(cave2->stationPositionLookup().position("a2") == QVector3D(0.0, 10.0, 0.0));
+    CHECK(cave1->length()->value() == 20.0);
+    CHECK(cave2->length()->value() == 10.0);
+
+    REQUIRE(changedCaves.size() == 1);
+    CHECK(changedCaves.first() == QList<cwCave*>({cave1}));
+
+    REQUIRE(changedTrips.size() == 1);
+    CHECK(changedTrips.first() == QList<cwTrip*>({cave1->trip(0)}));
+
+    SECTION("Editing the other cave only re-solves that cave") {
+        cave2->trip(0)->chunk(0)->setData(cwSurveyChunk::ShotCompassRole, 0, "90.0");
+        plotManager->waitToFinish();
+
+        CHECK(cave1->stationPositionLookup().position("a2") == QVector3D(0.0, 20.0, 0.0));
+        CHECK(cave2->stationPositionLookup().position("a2") == QVector3D(10.0, 0.0, 0.0));
+
+        REQUIRE(changedCaves.size() == 2);
+        CHECK(changedCaves.last() == QList<cwCave*>({cave2}));
+    }
+
+    SECTION("Removing a cave re-solves the remaining caves") {
+        region.removeCave(0);
+        plotManager->waitToFinish();
+
+        CHECK(cave2->stationPositionLookup().position("a2") == QVector3D(0.0, 10.0, 0.0));
+    }
+}
+
+TEST_CASE("Solver warnings should only be replaced for caves that are re-solved", "[cwLinePlotManager]") {
+    cwCavingRegion region;
+
+    auto addCave = [&region](QString name) {
+        cwCave* cave = new cwCave();
+        cave->setName(name);
+        region.addCave(cave);
+
+        cwTrip* trip = new cwTrip();
+        trip->setName("Trip 1");
+        trip->calibrations()->setBackSights(false);
+        cave->addTrip(trip);
+
+        cwSurveyChunk* chunk = new cwSurveyChunk();
+        trip->addChunk(chunk);
+
+        chunk->appendShot(cwStation("a1"), cwStation("a2"), cwShot("10.0", "0.0", "", "0.0", ""));
+
+        //The solver can't reduce this shot, only the backsight compass was entered
+        chunk->appendShot(cwStation("a2"), cwStation("a3"), cwShot("10.0", "", "90.0", "0.0", ""));
+
+        return cave;
+    };
+
+    auto solverWarnings = [](cwCave* cave) {
+        QStringList messages;
+        foreach(cwErrorModel* model, cave->errorModel()->childModels()) {
+            foreach(cwError error, model->errors()->toList()) {
+                if(error.message().contains("Can't reduce shot")) {
+                    CHECK(error.type() == cwError::Warning);
+                    messages.append(error.message());
+                }
+            }
+        }
+        return messages;
+    };
+
+    cwCave* cave1 = addCave("Cave 1");
+    cwCave* cave2 = addCave("Cave 2");
+
+    cwError otherError("Not from the solver", cwError::Warning);
+    cave1->errorModel()->errors()->append(otherError);
+
+    auto plotManager = std::make_unique<cwLinePlotManager>();
+    plotManager->setRegion(&region);
+    plotManager->waitToFinish();
+
+    CHECK(solverWarnings(cave1).size() == 1);
+    CHECK(solverWarnings(cave2).size() == 1);
+
+    //Re-solving cave 2 keeps cave 1's warnings
+    cave2->trip(0)->chunk(0)->setData(cwSurveyChunk::ShotDistanceRole, 0, "20.0");
+    plotManager->waitToFinish();
+
+    CHECK(solverWarnings(cave1).size() == 1);
+    CHECK(solverWarnings(cave2).size() == 1);
+
+    //Fixing the shot in cave 1 only removes the solver's warning
+    cave1->trip(0)->chunk(0)->setData(cwSurveyChunk::ShotCompassRole, 1, "90.0");
+    plotManager->waitToFinish();
+
+    CHECK(solverWarnings(cave1).isEmpty());
+    CHECK(solverWarnings(cave2).size() == 1);
+    CHECK(cave1->errorModel()->errors()->toList() == QList<cwError>({otherError}));
+}
@@ -0,0 +1,350 @@
+//Catch includes
+#include "catch.hpp"
+
+//Cavewhere includes
+#include "cwLoopClosureSolver.h"
+#include "cwLinePlotManager.h"
+#include "cwCavingRegion.h"
+#include "cwCave.h"
+#include "cwTrip.h"
+#include "cwSurveyChunk.h"
+#include "cwTripCalibration.h"
+#include "cwShot.h"
+#include "cwProject.h"
+
+//Our includes
+#include "TestHelper.h"
+
+//Qt includes
+#include <QElapsedTimer>
+
+//Std includes
+#include <random>
+
+namespace {
+
+void checkPosition(const cwStationPositionLookup& lookup, const QString& stationName, const QVector3D& position, double margin = 0.0001) {
+    INFO("Station:" << stationName);
+    REQUIRE(lookup.hasPosition(stationName));
+    QVector3D found = lookup.position(stationName);
+    CHECK(found.x() == Approx(position.x()).margin(margin));
+    CHECK(found.y() == Approx(position.y()).margin(margin));
+    CHECK(found.z() == Approx(position.z()).margin(margin));
+}
+
+QMap<cwCave*, cwStationPositionLookup> solveRegion(cwCavingRegion* region, cwLinePlotTask::Solver solver) {
+    for(cwCave* cave : region->caves()) {
+        cave->setStationPositionLookup(cwStationPositionLookup());
+    }
+
+    auto plotManager = std::make_unique<cwLinePlotManager>();
+    plotManager->setSolver(solver);
+    plotManager->setRegion(region);
+    plotManager->waitToFinish();
+
+    QMap<cwCave*, cwStationPositionLookup> lookups;
+    for(cwCave* cave : region->caves()) {
+        lookups.insert(cave, cave->stationPositionLookup());
+    }
+    return lookups;
+}
+
+}
+
+TEST_CASE("cwLoopClosureSolver should distribute loop misclosure", "[cwLoopClosureSolver]") {
+    QVector3D variance(1.0, 1.0, 1.0);
+
+    cwLoopClosureSolver solver;
+    solver.fixStation("a1", QVector3D(0.0, 0.0, 0.0));
+
+    SECTION("Square loop") {
+        solver.addLeg("a1", "a2", QVector3D(10.0, 0.0, 0.0), variance);
+        solver.addLeg("a2", "a3", QVector3D(0.0, 10.0, 0.0), variance);
+        solver.addLeg("a3", "a4", QVector3D(-10.0, 0.0, 0.0), variance);
+        solver.addLeg("a4", "A1", QVector3D(0.0, -9.0, 0.0), variance); //1 meter misclosure
+        solver.addLeg("a4", "a5", QVector3D(0.0, 0.0, 5.0), variance); //Spur
+
+        CHECK(solver.stationCount() == 5);
+        CHECK(solver.legCount() == 5);
+
+        cwStationPositionLookup lookup = solver.solve();
+        CHECK(lookup.positions().size() == 5);
+        checkPosition(lookup, "a1", QVector3D(0.0, 0.0, 0.0));
+        checkPosition(lookup, "a2", QVector3D(10.0, -0.25, 0.0));
+        checkPosition(lookup, "a3", QVector3D(10.0, 9.5, 0.0));
+        checkPosition(lookup, "a4", QVector3D(0.0, 9.25, 0.0));
+        checkPosition(lookup, "a5", QVector3D(0.0, 9.25, 5.0));
+    }
+
+    SECTION("Parallel legs are weighted by variance") {
+        solver.addLeg("a1", "a2", QVector3D(10.0, 0.0, 0.0), QVector3D(1.0, 1.0, 1.0));
+        solver.addLeg("a1", "a2", QVector3D(13.0, 0.0, 0.0), QVector3D(2.0, 2.0, 2.0));
+
+        cwStationPositionLookup lookup = solver.solve();
+        checkPosition(lookup, "a2", QVector3D(11.0, 0.0, 0.0));
+    }
+
+    SECTION("Junction stations") {
+        //Two loops that share the a2 to a3 leg
+        solver.addLeg("a1", "a2", QVector3D(10.0, 0.0, 0.0), variance);
+        solver.addLeg("a2", "a3", QVector3D(0.0, 10.0, 0.0), variance);
+        solver.addLeg("a3", "a1", QVector3D(-10.0, -10.0, 0.0), variance);
+        solver.addLeg("a2", "b1", QVector3D(10.0, 0.0, 0.0), variance);
+        solver.addLeg("b1", "a3", QVector3D(-10.0, 10.0, 0.0), variance);
+
+        cwStationPositionLookup lookup = solver.solve();
+        checkPosition(lookup, "a2", QVector3D(10.0, 0.0, 0.0));
+        checkPosition(lookup, "a3", QVector3D(10.0, 10.0, 0.0));
+        checkPosition(lookup, "b1", QVector3D(20.0, 0.0, 0.0));
+    }
+
+    SECTION("Stations that aren't connected to a fixed station aren't solved") {
+        solver.addLeg("a1", "a2", QVector3D(10.0, 0.0, 0.0), variance);
+        solver.addLeg("b1", "b2", QVector3D(10.0, 0.0, 0.0), variance);
+
+        cwStationPositionLookup lookup = solver.solve();
+        CHECK(lookup.hasPosition("a2"));
+        CHECK(!lookup.hasPosition("b1"));
+        CHECK(!lookup.hasPosition("b2"));
+    }
+
+    SECTION("Nothing is solved without a fixed station") {
+        solver.clear();
+        solver.addLeg("a1", "a2", QVector3D(10.0, 0.0, 0.0), variance);
+        CHECK(solver.solve().positions().isEmpty());
+    }
+}
+
+TEST_CASE("cwLoopClosureSolver should match a dense least squares solve", "[cwLoopClosureSolver]") {
+    std::default_random_engine generator(5);
+    std::uniform_real_distribution<double> deltaDistribution(-5.0, 5.0);
+    std::uniform_real_distribution<double> varianceDistribution(0.1, 2.0);
+
+    const int numberOfStations = 60;
+
+    struct TestLeg {
+        int From;
+        int To;
+        double Delta;
+        double Variance;
+    };
+
+    //A random tree, with extra legs to make loops
+    QVector<TestLeg> legs;
+    for(int i = 1; i < numberOfStations; i++) {
+        legs.append({static_cast<int>(generator() % i), i, deltaDistribution(generator), varianceDistribution(generator)});
+    }
+    for(int i = 0; i < 15; i++) {
+        int from = generator() % numberOfStations;
+        int to = generator() % numberOfStations;
+        legs.append({from, to, deltaDistribution(generator), varianceDistribution(generator)});
+    }
+
+    cwLoopClosureSolver solver;
+    solver.fixStation("0", QVector3D(0.0, 0.0, 0.0));
+    for(const TestLeg& leg : legs) {
+        solver.addLeg(QString::number(leg.From),
+                      QString::number(leg.To),
+                      QVector3D(leg.Delta, -leg.Delta, 0.5 * leg.Delta),
+                      QVector3D(leg.Variance, leg.Variance, leg.Variance));
+    }
+    cwStationPositionLookup lookup = solver.solve();
+
+    //Solve the normal equations with gauss seidel
+    QVector<double> x(numberOfStations, 0.0);
+    for(int iteration = 0; iteration < 5000; iteration++) {
+        for(int station = 1; station < numberOfStations; station++) {
+            double weightSum = 0.0;
+            double sum = 0.0;
+            for(const TestLeg& leg : legs) {
+                if(leg.From == leg.To) {
+                    continue;
+                }
+                if(leg.To == station) {
+                    weightSum += 1.0 / leg.Variance;
+                    sum += (x.at(leg.From) + leg.Delta) / leg.Variance;
+                } else if(leg.From == station) {
+                    weightSum += 1.0 / leg.Variance;
+                    sum += (x.at(leg.To) - leg.Delta) / leg.Variance;
+                }
+            }
+            x[station] = sum / weightSum;
+        }
+    }
+
+    for(int i = 0; i < numberOfStations; i++) {
+        checkPosition(lookup, QString::number(i), QVector3D(x.at(i), -x.at(i), 0.5 * x.at(i)), 0.001);
+    }
+}
+
+TEST_CASE("cwLoopClosureSolver should reduce shots with calibrations", "[cwLoopClosureSolver]") {
+    cwTripCalibration calibration;
+    calibration.setFrontSights(true);
+    calibration.setBackSights(true);
+
+    cwShot shot;
+    shot.setDistance("10.0");
+
+    QVector3D delta;
+    QVector3D variance;
+
+    SECTION("Frontsight") {
+        shot.setCompass("90.0");
+        shot.setClino("0.0");
+        REQUIRE(cwLoopClosureSolver::reduceShot(shot, &calibration, &delta, &variance));
+        CHECK(delta.x() == Approx(10.0));
+        CHECK(delta.y() == Approx(0.0).margin(0.0001));
+        CHECK(delta.z() == Approx(0.0).margin(0.0001));
+        CHECK(variance.x() > 0.0);
+    }
+
+    SECTION("Frontsight and backsight are averaged") {
+        shot.setCompass("0.0");
+        shot.setBackCompass("90.0");
+        shot.setClino("0.0");
+        shot.setBackClino("45.0");
+        REQUIRE(cwLoopClosureSolver::reduceShot(shot, &calibration, &delta, &variance));
+        CHECK(delta.x() == Approx(-6.5328).epsilon(0.001));
+        CHECK(delta.y() == Approx(6.5328).epsilon(0.001));
+        CHECK(delta.z() == Approx(-3.8268).epsilon(0.001));
+    }
+
+    SECTION("Corrected backsights and declination") {
+        calibration.setCorrectedCompassBacksight(true);
+        calibration.setCorrectedClinoBacksight(true);
+        calibration.setDeclination(10.0);
+        shot.setBackCompass("80.0");
+        shot.setBackClino("30.0");
+        REQUIRE(cwLoopClosureSolver::reduceShot(shot, &calibration, &delta, &variance));
+        CHECK(delta.x() == Approx(10.0 * cos(M_PI / 6.0)).epsilon(0.001));
+        CHECK(delta.y() == Approx(0.0).margin(0.001));
+        CHECK(delta.z() == Approx(5.0).epsilon(0.001));
+    }
+
+    SECTION("Vertical shots") {
+        shot.setClino("Down");
+        REQUIRE(cwLoopClosureSolver::reduceShot(shot, &calibration, &delta, &variance));
+        CHECK(delta == QVector3D(0.0, 0.0, -10.0));
+
+        shot.setClinoState(cwClinoStates::Empty);
+        shot.setBackClino("Down");
+        REQUIRE(cwLoopClosureSolver::reduceShot(shot, &calibration, &delta, &variance));
+        CHECK(delta == QVector3D(0.0, 0.0, 10.0));
+    }
+
+    SECTION("Missing compass") {
+        shot.setClino("10.0");
+        CHECK(!cwLoopClosureSolver::reduceShot(shot, &calibration, &delta, &variance));
+    }
+
+    SECTION("Missing distance") {
+        shot.setDistanceState(cwDistanceStates::Empty);
+        shot.setCompass("90.0");
+        shot.setClino("0.0");
+        CHECK(!cwLoopClosureSolver::reduceShot(shot, &calibration, &delta, &variance));
+    }
+}
+
+TEST_CASE("cwLoopClosureSolver should skip half entered shots like cavern", "[cwLoopClosureSolver]") {
+    cwCavingRegion region;
+    cwCave* cave = new cwCave();
+    cave->setName("Cave");
+    region.addCave(cave);
+
+    cwTrip* trip = new cwTrip();
+    trip->setName("Trip 1");
+    cave->addTrip(trip);
+
+    cwSurveyChunk* chunk = new cwSurveyChunk();
+    trip->addChunk(chunk);
+    chunk->appendShot(cwStation("a1"), cwStation("a2"), cwShot("10.0", "0.0", "180.0", "0.0", "0.0"));
+
+    //The distance hasn't been entered yet
+    chunk->appendShot(cwStation("a2"), cwStation("a3"), cwShot("", "90.0", "270.0", "0.0", "0.0"));
+
+    cwSurveyChunk* loopChunk = new cwSurveyChunk();
+    trip->addChunk(loopChunk);
+    loopChunk->appendShot(cwStation("a1"), cwStation("a3"), cwShot("5.0", "90.0", "270.0", "0.0", "0.0"));
+
+    cwLoopClosureSolver solver;
+    solver.addCave(cave);
+    cwStationPositionLookup nativeLookup = solver.solve();
+    CHECK(solver.errors().isEmpty());
+
+    //A zero length leg would pull a2 and a3 together
+    checkPosition(nativeLookup, "a1", QVector3D(0.0, 0.0, 0.0));
+    checkPosition(nativeLookup, "a2", QVector3D(0.0, 10.0, 0.0));
+    checkPosition(nativeLookup, "a3", QVector3D(5.0, 0.0, 0.0));
+
+    //The missing distance is a fatal error, so the line plot won't run cavern on the half entered
+    //shot. Cavern should find the same positions without it.
+    chunk->removeStation(2, cwSurveyChunk::Above);
+    REQUIRE(chunk->shotCount() == 1);
+
+    cwStationPositionLookup cavernLookup = solveRegion(&region, cwLinePlotTask::CavernSolver).value(cave);
+    CHECK(cavernLookup.positions().keys() == nativeLookup.positions().keys());
+
+    QMapIterator<QString, QVector3D> iter(cavernLookup.positions());
+    while(iter.hasNext()) {
+        iter.next();
+        checkPosition(nativeLookup, iter.key(), iter.value(), 0.01);
+    }
+}
+
+TEST_CASE("cwLoopClosureSolver should match cavern", "[cwLoopClosureSolver]") {
+    QString filename;
+
+    SECTION("network.cw") {
+        filename = ":/datasets/network.cw";
+    }
+
+    SECTION("runningProfile.cw") {
+        filename = ":/datasets/runningProfile.cw";
+    }
+
+    SECTION("compassImportExport.cw") {
+        filename = ":/datasets/compass/compassImportExport.cw";
+    }
+
+    auto project = fileToProject(filename);
+    cwCavingRegion* region = project->cavingRegion();
+    REQUIRE(region->caveCount() > 0);
+
+    auto cavernLookups = solveRegion(region, cwLinePlotTask::CavernSolver);
+    auto nativeLookups = solveRegion(region, cwLinePlotTask::NativeSolver);
+
+    for(cwCave* cave : region->caves()) {
+        INFO("Cave:" << cave->name() << " file:" << filename);
+        cwStationPositionLookup cavernLookup = cavernLookups.value(cave);
+        cwStationPositionLookup nativeLookup = nativeLookups.value(cave);
+
+        CHECK(cavernLookup.positions().keys() == nativeLookup.positions().keys());
+
+        //Cavern uses the full covariance of each leg, the native solver only uses its diagonal,
+        //so loop closures are distributed slightly differently
+        QMapIterator<QString, QVector3D> iter(cavernLookup.positions());
+        while(iter.hasNext()) {
+            iter.next();
+            checkPosition(nativeLookup, iter.key(), iter.value(), 0.1);
+        }
+    }
+}
+
+TEST_CASE("Benchmark cwLoopClosureSolver against cavern", "[cwLoopClosureSolver][.benchmark]") {
+    auto project = fileToProject(":/datasets/compass/compassImportExport.cw");
+    cwCavingRegion* region = project->cavingRegion();
+
+    QElapsedTimer timer;
+
+    timer.start();
+    solveRegion(region, cwLinePlotTask::CavernSolver);
+    qint64 cavernTime = timer.nsecsElapsed();
+
+    timer.restart();
+    solveRegion(region, cwLinePlotTask::NativeSolver);
+    qint64 nativeTime = timer.nsecsElapsed();
+
+    WARN("Cavern line plot:" << cavernTime * 1e-6 << "ms"
+         << " native line plot:" << nativeTime * 1e-6 << "ms"
+         << " speedup:" << cavernTime / static_cast<double>(nativeTime) << "x");
+}
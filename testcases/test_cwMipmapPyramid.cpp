@@ -0,0 +1,194 @@
+//Catch includes
+#include "catch.hpp"
+
+//Our includes
+#include "cwMipmapPyramid.h"
+#include "cwAddImageTask.h"
+
+//Qt includes
+#include <QElapsedTimer>
+#include <QPainter>
+
+//Std includes
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+QImage createNoiseImage(QSize size, QImage::Format format)
+{
+    std::default_random_engine generator(size.width() * 31 + size.height());
+    std::uniform_int_distribution<int> channel(0, 255);
+
+    QImage image(size, QImage::Format_RGB32);
+    for(int y = 0; y < size.height(); y++) {
+        for(int x = 0; x < size.width(); x++) {
+            image.setPixel(x, y, qRgb(channel(generator), channel(generator), channel(generator)));
+        }
+    }
+    return image.convertToFormat(format);
+}
+
+/**
+ * The reference box filter, one channel and pixel at a time
+ */
+QRgb boxAverage(const QImage& image, int x, int y)
+{
+    int x0 = std::min(2 * x, image.width() - 1);
+    int x1 = std::min(2 * x + 1, image.width() - 1);
+    int y0 = std::min(2 * y, image.height() - 1);
+    int y1 = std::min(2 * y + 1, image.height() - 1);
+
+    QRgb pixels[4] = {image.pixel(x0, y0), image.pixel(x1, y0), image.pixel(x0, y1), image.pixel(x1, y1)};
+
+    auto average = [&pixels](int (*channel)(QRgb)) {
+        int sum = 0;
+        for(QRgb pixel : pixels) {
+            sum += channel(pixel);
+        }
+        return (sum + 2) / 4;
+    };
+
+    return qRgba(average(qRed), average(qGreen), average(qBlue), average(qAlpha));
+}
+
+}
+
+TEST_CASE("cwMipmapPyramid should halve images with a box filter", "[cwMipmapPyramid]") {
+    QList<QSize> sizes = {{8, 8}, {7, 5}, {1, 6}, {9, 1}, {1, 1}};
+    QList<QImage::Format> formats = {QImage::Format_RGB32,
+                                     QImage::Format_ARGB32_Premultiplied,
+                                     QImage::Format_Grayscale8};
+
+    for(QSize size : sizes) {
+        for(QImage::Format format : formats) {
+            QImage image = createNoiseImage(size, format);
+            QImage half = cwMipmapPyramid::halfImage(image);
+
+            INFO("Size:" << size.width() << "x" << size.height() << " format:" << format);
+            REQUIRE(half.size() == cwAddImageTask::half(size));
+
+            if(format == QImage::Format_Grayscale8) {
+                CHECK(half.format() == QImage::Format_ARGB32_Premultiplied);
+            } else {
+                CHECK(half.format() == format);
+            }
+
+            QImage reference = image.convertToFormat(QImage::Format_ARGB32);
+            for(int y = 0; y < half.height(); y++) {
+                for(int x = 0; x < half.width(); x++) {
+                    INFO("Pixel:" << x << "," << y);
+                    CHECK(half.pixel(x, y) == boxAverage(reference, x, y));
+                }
+            }
+        }
+    }
+
+    CHECK(cwMipmapPyramid::halfImage(QImage()).isNull());
+}
+
+TEST_CASE("cwMipmapPyramid should pad level 0 without copying it", "[cwMipmapPyramid]") {
+    QImage image = createNoiseImage(QSize(13, 10), QImage::Format_RGB32);
+    QSize paddedSize(16, 12);
+
+    //Padded at the top and right, by repeating the edge pixels
+    int topPadding = paddedSize.height() - image.height();
+    QImage paddedImage(paddedSize, QImage::Format_RGB32);
+    for(int y = 0; y < paddedSize.height(); y++) {
+        for(int x = 0; x < paddedSize.width(); x++) {
+            paddedImage.setPixel(x, y, image.pixel(std::min(x, image.width() - 1),
+                                                   std::max(0, y - topPadding)));
+        }
+    }
+
+    CHECK(cwMipmapPyramid::halfImage(image, paddedSize) == cwMipmapPyramid::halfImage(paddedImage));
+
+    cwMipmapPyramid pyramid;
+    pyramid.setImage(image, paddedSize);
+    CHECK(pyramid.level() == image);
+    CHECK(pyramid.levelSize() == paddedSize);
+    CHECK(pyramid.numberOfLevels() == cwMipmapPyramid::numberOfLevels(paddedSize));
+
+    cwMipmapPyramid paddedPyramid(paddedImage);
+    while(pyramid.hasNextLevel()) {
+        REQUIRE(paddedPyramid.hasNextLevel());
+        pyramid.nextLevel();
+        paddedPyramid.nextLevel();
+
+        INFO("Level:" << pyramid.levelIndex());
+        CHECK(pyramid.levelSize() == pyramid.level().size());
+        CHECK(pyramid.level() == paddedPyramid.level());
+    }
+    CHECK(!paddedPyramid.hasNextLevel());
+}
+
+TEST_CASE("cwMipmapPyramid should create the same levels as QImage::scaled", "[cwMipmapPyramid]") {
+    QImage image(932, 872, QImage::Format_RGB32);
+    image.fill(Qt::white);
+    QPainter painter(&image);
+    painter.setPen(QPen(Qt::black, 6));
+    painter.drawEllipse(QRect(100, 100, 700, 600));
+    painter.end();
+
+    cwMipmapPyramid pyramid(image);
+    CHECK(pyramid.numberOfLevels() == cwAddImageTask::numberOfMipmapLevels(image.size()));
+    CHECK(pyramid.levelIndex() == 0);
+    CHECK(pyramid.level() == image);
+
+    QImage scaledImage = image;
+    QSize scaledSize = image.size();
+    int levels = 1;
+    while(pyramid.hasNextLevel()) {
+        pyramid.nextLevel();
+        levels++;
+
+        scaledSize = cwAddImageTask::half(scaledSize);
+        scaledImage = scaledImage.scaled(scaledSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+        QImage level = pyramid.level();
+        INFO("Level:" << pyramid.levelIndex());
+        REQUIRE(level.size() == scaledSize);
+
+        //Both are area averages, so they should be close
+        double error = 0.0;
+        for(int y = 0; y < level.height(); y++) {
+            for(int x = 0; x < level.width(); x++) {
+                error += std::abs(qGray(level.pixel(x, y)) - qGray(scaledImage.pixel(x, y)));
+            }
+        }
+        CHECK(error / (level.width() * level.height()) < 16.0);
+    }
+
+    CHECK(levels == pyramid.numberOfLevels());
+    CHECK(pyramid.level().size() == QSize(1, 1));
+}
+
+TEST_CASE("Benchmark cwMipmapPyramid against QImage::scaled", "[cwMipmapPyramid][.benchmark]") {
+    //A 600 dpi scan of a letter size page
+    QImage image = createNoiseImage(QSize(5100, 6600), QImage::Format_RGB32);
+
+    QElapsedTimer timer;
+    timer.start();
+    QImage scaledImage = image;
+    QSize scaledSize = image.size();
+    for(int i = 1; i < cwAddImageTask::numberOfMipmapLevels(image.size()); i++) {
+        scaledSize = cwAddImageTask::half(scaledSize);
+        scaledImage = scaledImage.scaled(scaledSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+    qint64 scaledTime = timer.nsecsElapsed();
+
+    timer.restart();
+    cwMipmapPyramid pyramid(image);
+    while(pyramid.hasNextLevel()) {
+        pyramid.nextLevel();
+    }
+    qint64 pyramidTime = timer.nsecsElapsed();
+
+    CHECK(pyramid.level().size() == scaledImage.size());
+
+    WARN("Image:" << image.width() << "x" << image.height()
+         << " QImage::scaled:" << scaledTime * 1e-6 << "ms"
+         << " cwMipmapPyramid:" << pyramidTime * 1e-6 << "ms"
+         << " speedup:" << scaledTime / static_cast<double>(pyramidTime) << "x");
+}
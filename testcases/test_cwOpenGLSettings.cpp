@@ -260,6 +260,15 @@ TEST_CASE("cwOpenGLSettings should initilize correctly", "[cwOpenGLSettings]") {
                                                                 }));
         }
 
+        SECTION("DXT1 quality should return correctly") {
+            //Don't reorder, if this fails make sure you don't reorder these options
+            CHECK(initSettings->dxt1QualityModel() == QStringList({
+                                                                      "Best",
+                                                                      "Balanced",
+                                                                      "Fast"
+                                                                  }));
+        }
+
         SECTION("rendererModel should return correctly") {
             QStringList renderers;
 #ifdef Q_OS_WIN
@@ -0,0 +1,113 @@
+//Catch includes
+#include "catch.hpp"
+
+//Our includes
+#include "cwStationPositionLookup.h"
+
+//Qt includes
+#include <QElapsedTimer>
+
+TEST_CASE("cwStationPositionLookup should intern stations case insensitively", "[cwStationPositionLookup]") {
+    cwStationPositionLookup lookup;
+    CHECK(lookup.isEmpty());
+
+    lookup.setPosition("A1", QVector3D(1.0, 2.0, 3.0));
+    lookup.setPosition("a2", QVector3D(4.0, 5.0, 6.0));
+
+    CHECK(lookup.stationCount() == 2);
+    CHECK(lookup.hasPosition("a1"));
+    CHECK(lookup.hasPosition("A2"));
+    CHECK(!lookup.hasPosition("a3"));
+    CHECK(lookup.position("a1") == QVector3D(1.0, 2.0, 3.0));
+    CHECK(lookup.position("a3") == QVector3D());
+
+    SECTION("Station ids are dense and in insertion order") {
+        CHECK(lookup.stationId("a1") == 0);
+        CHECK(lookup.stationId("A2") == 1);
+        CHECK(lookup.stationId("a3") == -1);
+        CHECK(lookup.stationName(0) == "a1");
+        CHECK(lookup.position(1) == QVector3D(4.0, 5.0, 6.0));
+    }
+
+    SECTION("Setting an existing station overwrites it") {
+        lookup.setPosition("a1", QVector3D(7.0, 8.0, 9.0));
+        CHECK(lookup.stationCount() == 2);
+        CHECK(lookup.stationId("A1") == 0);
+        CHECK(lookup.position("A1") == QVector3D(7.0, 8.0, 9.0));
+    }
+
+    SECTION("positions() is keyed by lower case names") {
+        QMap<QString, QVector3D> positions = lookup.positions();
+        CHECK(positions.keys() == QStringList({"a1", "a2"}));
+        CHECK(positions.value("a2") == QVector3D(4.0, 5.0, 6.0));
+    }
+
+    SECTION("Copies are independent") {
+        cwStationPositionLookup copy = lookup;
+        CHECK(copy == lookup);
+
+        copy.setPosition("a3", QVector3D(1.0, 1.0, 1.0));
+        CHECK(copy != lookup);
+        CHECK(copy.stationCount() == 3);
+        CHECK(lookup.stationCount() == 2);
+    }
+
+    SECTION("Equality doesn't depend on insertion order") {
+        cwStationPositionLookup other;
+        other.setPosition("a2", QVector3D(4.0, 5.0, 6.0));
+        other.setPosition("a1", QVector3D(1.0, 2.0, 3.0));
+        CHECK(other == lookup);
+
+        other.setPosition("a1", QVector3D(1.0, 2.0, 3.5));
+        CHECK(other != lookup);
+    }
+
+    SECTION("Clear") {
+        lookup.clearStations();
+        CHECK(lookup.isEmpty());
+        CHECK(!lookup.hasPosition("a1"));
+    }
+}
+
+TEST_CASE("Benchmark cwStationPositionLookup", "[cwStationPositionLookup][.benchmark]") {
+    const int numberOfStations = 100000;
+
+    QStringList names;
+    names.reserve(numberOfStations);
+    for(int i = 0; i < numberOfStations; i++) {
+        names.append(QString("A%1").arg(i));
+    }
+
+    QElapsedTimer timer;
+
+    //The old implementation, a map keyed by lower case names
+    timer.start();
+    QMap<QString, QVector3D> map;
+    for(int i = 0; i < numberOfStations; i++) {
+        map[names.at(i).toLower()] = QVector3D(i, i, i);
+    }
+    double mapSum = 0.0;
+    for(const QString& name : names) {
+        mapSum += map.value(name.toLower()).x();
+    }
+    qint64 mapTime = timer.nsecsElapsed();
+
+    timer.restart();
+    cwStationPositionLookup lookup;
+    lookup.reserve(numberOfStations);
+    for(int i = 0; i < numberOfStations; i++) {
+        lookup.setPosition(names.at(i), QVector3D(i, i, i));
+    }
+    double lookupSum = 0.0;
+    for(const QString& name : names) {
+        lookupSum += lookup.position(name).x();
+    }
+    qint64 lookupTime = timer.nsecsElapsed();
+
+    CHECK(mapSum == lookupSum);
+
+    WARN("Stations:" << numberOfStations
+         << " QMap:" << mapTime * 1e-6 << "ms"
+         << " cwStationPositionLookup:" << lookupTime * 1e-6 << "ms"
+         << " speedup:" << mapTime / static_cast<double>(lookupTime) << "x");
+}
@@ -14,6 +14,10 @@
 #include "cwTrip.h"
 #include "cwSurveyChunk.h"
 #include "cwTripCalibration.h"
+#include "cwTreeImportDataNode.h"
+
+//Qt includes
+#include <QTemporaryDir>
 
 TEST_CASE("Import LRUD data correctly", "[SurvexImport]") {
     class Row {
@@ -130,3 +134,86 @@ TEST_CASE("Import chunk calibration", "[SurvexImport]") {
     delete importer;
 }
 
+
+TEST_CASE("Import included files in order", "[SurvexImport]") {
+    QTemporaryDir directory;
+    REQUIRE(directory.isValid());
+
+    auto writeFile = [&directory](QString filename, QByteArray data) {
+        QFile file(directory.filePath(filename));
+        REQUIRE(file.open(QFile::WriteOnly));
+        file.write(data);
+    };
+
+    writeFile("root.svx",
+              "*begin cave\n"
+              "*include trip1\n"
+              "*include trip2.svx ; with the extension\n"
+              "*include trip1 ; already included\n"
+              "*include missing\n"
+              "*end cave\n");
+
+    writeFile("trip1.svx",
+              "*begin trip1\n"
+              "*data normal from to tape compass clino\n"
+              "a1 a2 10 0 0\n"
+              "*end trip1\n");
+
+    writeFile("trip2.svx",
+              "*begin trip2\n"
+              "*data normal from to tape compass clino\n"
+              "b1 b2 5 90 0\n"
+              "\n"
+              "b2 b3 5 90 0\n"
+              "*end trip2\n");
+
+    cwSurvexImporter* importer = new cwSurvexImporter();
+    importer->setInputFiles(QStringList() << directory.filePath("root.svx"));
+    importer->start();
+    importer->waitToFinish();
+
+    REQUIRE(importer->parseErrors().size() == 1);
+    CHECK(importer->parseErrors().first().toStdString() == QString("Error: Couldn't open " + directory.filePath("missing.svx")).toStdString());
+
+    REQUIRE(importer->data()->nodes().size() == 1);
+    cwTreeImportDataNode* cave = importer->data()->nodes().first();
+    CHECK(cave->name().toStdString() == "cave");
+
+    auto trips = cave->childNodes();
+    REQUIRE(trips.size() == 2);
+    CHECK(trips.at(0)->name().toStdString() == "trip1");
+    CHECK(trips.at(1)->name().toStdString() == "trip2");
+
+    REQUIRE(trips.at(0)->chunkCount() == 1);
+    CHECK(trips.at(0)->chunks().first()->stationCount() == 2);
+
+    REQUIRE(trips.at(1)->chunkCount() == 1);
+    CHECK(trips.at(1)->chunks().first()->stationCount() == 3);
+    CHECK(trips.at(1)->chunks().first()->station(2).name().toStdString() == "b3");
+
+    delete importer;
+}
+
+TEST_CASE("Survex import errors should have the line number", "[SurvexImport]") {
+    QTemporaryDir directory;
+    REQUIRE(directory.isValid());
+
+    QFile file(directory.filePath("errors.svx"));
+    REQUIRE(file.open(QFile::WriteOnly));
+    file.write("*begin cave\n"
+               "\n"
+               "; A comment\n"
+               "*units tape\n"
+               "*end cave\n");
+    file.close();
+
+    cwSurvexImporter* importer = new cwSurvexImporter();
+    importer->setInputFiles(QStringList() << file.fileName());
+    importer->start();
+    importer->waitToFinish();
+
+    REQUIRE(importer->parseErrors().size() == 1);
+    CHECK(importer->parseErrors().first().toStdString() == QString("Error: %1::Line 4::Couldn't read units").arg(file.fileName()).toStdString());
+
+    delete importer;
+}
@@ -0,0 +1,145 @@
+//Catch includes
+#include "catch.hpp"
+
+//Our includes
+#include "cwSurvexLexer.h"
+#include "cwSurvexImporter.h"
+
+//Qt includes
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+TEST_CASE("cwSurvexLexer should split lines into tokens", "[cwSurvexLexer]") {
+    QByteArray data("\xEF\xBB\xBF*begin Cave ; comment\n"
+                    "\n"
+                    "  a1\ta2 10.5 \"Some Name\" ;x\r\n"
+                    "; only a comment\n"
+                    "*DATA normal from to\n"
+                    "*unknown\n"
+                    "* begin\n"
+                    "end");
+
+    cwSurvexLexer lexer;
+    lexer.lex(data);
+
+    CHECK(lexer.size() == data.size());
+    CHECK(lexer.numberOfLines() == 8);
+    REQUIRE(lexer.lineCount() == 6);
+
+    auto tokens = [&lexer](int index) {
+        QStringList strings;
+        cwSurvexLexer::Line line = lexer.line(index);
+        for(const auto& token : line) {
+            strings.append(token.toString());
+        }
+        return strings;
+    };
+
+    CHECK(lexer.line(0).number() == 1);
+    CHECK(tokens(0) == QStringList({"*begin", "Cave"}));
+    CHECK(lexer.line(0).span(1).toString().toStdString() == "Cave");
+    CHECK(cwSurvexLexer::directive(lexer.line(0)) == cwSurvexLexer::BeginDirective);
+
+    CHECK(lexer.line(1).number() == 3);
+    CHECK(tokens(1) == QStringList({"a1", "a2", "10.5", "Some Name"}));
+    CHECK(!lexer.line(1).at(2).isQuoted());
+    CHECK(lexer.line(1).at(3).isQuoted());
+    CHECK(cwSurvexLexer::directive(lexer.line(1)) == cwSurvexLexer::NoDirective);
+
+    CHECK(lexer.line(2).number() == 5);
+    CHECK(lexer.line(2).at(1).equals("NORMAL"));
+    CHECK(!lexer.line(2).at(1).equals("norm"));
+    CHECK(cwSurvexLexer::directive(lexer.line(2)) == cwSurvexLexer::DataDirective);
+
+    CHECK(cwSurvexLexer::directive(lexer.line(3)) == cwSurvexLexer::UnknownDirective);
+    CHECK(cwSurvexLexer::directive(lexer.line(4)) == cwSurvexLexer::NoDirective);
+
+    CHECK(lexer.line(5).number() == 8);
+    CHECK(tokens(5) == QStringList({"end"}));
+}
+
+TEST_CASE("cwSurvexLexer should report files that can't be opened", "[cwSurvexLexer]") {
+    cwSurvexLexer lexer;
+    CHECK(!lexer.open("/this/file/does/not/exist.svx"));
+    CHECK(!lexer.errorString().isEmpty());
+    CHECK(lexer.lineCount() == 0);
+
+    //Resources can be read, even if they can't be mapped
+    CHECK(lexer.open("://datasets/survex/dakeng.svx"));
+    CHECK(lexer.lineCount() > 0);
+    CHECK(cwSurvexLexer::directive(lexer.line(0)) == cwSurvexLexer::BeginDirective);
+}
+
+TEST_CASE("Benchmark survex import throughput", "[cwSurvexLexer][.benchmark]") {
+    //A survey archive with lots of included files
+    const int numberOfFiles = 200;
+    const int shotsPerFile = 2000;
+
+    QTemporaryDir directory;
+    REQUIRE(directory.isValid());
+
+    qint64 totalBytes = 0;
+    QStringList filenames;
+
+    QFile rootFile(directory.filePath("archive.svx"));
+    REQUIRE(rootFile.open(QFile::WriteOnly));
+    QTextStream root(&rootFile);
+    root << "*begin archive\n";
+
+    for(int f = 0; f < numberOfFiles; f++) {
+        QString name = QString("cave%1").arg(f);
+        root << "*include " << name << "\n";
+
+        QFile file(directory.filePath(name + ".svx"));
+        REQUIRE(file.open(QFile::WriteOnly));
+        QTextStream stream(&file);
+        stream << "*begin " << name << "\n";
+        stream << "*date 2001.02.03\n";
+        stream << "*team \"Some Surveyor\" notes\n";
+        stream << "*calibrate tape 0.1\n";
+        stream << "*data normal from to tape compass clino\n";
+        for(int s = 0; s < shotsPerFile; s++) {
+            stream << s << "\t" << s + 1 << "\t" << 3.25 + (s % 7) << "\t" << (s * 13) % 360 << "\t" << (s % 20) - 10 << " ; shot\n";
+        }
+        stream << "*end " << name << "\n";
+        stream.flush();
+        totalBytes += file.size();
+        filenames.append(file.fileName());
+    }
+
+    root << "*end archive\n";
+    root.flush();
+    totalBytes += rootFile.size();
+    rootFile.close();
+
+    auto megabytesPerSecond = [totalBytes](qint64 nsecs) {
+        return (totalBytes / 1.0e6) / (nsecs * 1.0e-9);
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+    int lines = 0;
+    for(const QString& filename : filenames) {
+        cwSurvexLexer lexer;
+        lexer.open(filename);
+        lines += lexer.numberOfLines();
+    }
+    qint64 lexerTime = timer.nsecsElapsed();
+    CHECK(lines == numberOfFiles * (shotsPerFile + 6));
+
+    timer.restart();
+    cwSurvexImporter importer;
+    importer.setInputFiles({rootFile.fileName()});
+    importer.start();
+    importer.waitToFinish();
+    qint64 importTime = timer.nsecsElapsed();
+
+    CHECK(importer.parseErrors().isEmpty());
+    REQUIRE(importer.data()->nodes().size() == 1);
+    CHECK(importer.data()->nodes().first()->childNodes().size() == numberOfFiles);
+
+    WARN("Files:" << numberOfFiles << " size:" << totalBytes / 1.0e6 << "MB");
+    WARN("Lexer: " << lexerTime * 1e-6 << "ms " << megabytesPerSecond(lexerTime) << "MB/s");
+    WARN("Import: " << importTime * 1e-6 << "ms " << megabytesPerSecond(importTime) << "MB/s");
+}
@@ -0,0 +1,179 @@
+//Catch includes
+#include "catch.hpp"
+
+//Our includes
+#include "cwSurveyChunkConnectivity.h"
+#include "cwFindUnconnectedSurveyChunksTask.h"
+#include "cwSurveyChunk.h"
+#include "cwCave.h"
+#include "cwTrip.h"
+#include "cwStation.h"
+#include "cwShot.h"
+
+//Qt includes
+#include <QElapsedTimer>
+#include <QSet>
+
+//Std includes
+#include <memory>
+
+namespace {
+
+cwSurveyChunk* createChunk(const QStringList& stationNames)
+{
+    cwShot shot("10", "0", "180", "0", "0");
+
+    cwSurveyChunk* chunk = new cwSurveyChunk();
+    for(int i = 0; i + 1 < stationNames.size(); i++) {
+        chunk->appendShot(cwStation(stationNames.at(i)), cwStation(stationNames.at(i + 1)), shot);
+    }
+    return chunk;
+}
+
+}
+
+TEST_CASE("cwSurveyChunkConnectivity should connect chunks that share stations", "[cwSurveyChunkConnectivity]") {
+    std::unique_ptr<cwSurveyChunk> a(createChunk({"a1", "a2", "a3"}));
+    std::unique_ptr<cwSurveyChunk> b(createChunk({"A3", "b1", "b2"})); //Shares a3
+    std::unique_ptr<cwSurveyChunk> c(createChunk({"c1", "c2"}));
+    std::unique_ptr<cwSurveyChunk> d(createChunk({"b2", "c1"})); //Joins b and c
+    std::unique_ptr<cwSurveyChunk> empty(new cwSurveyChunk());
+
+    cwSurveyChunkConnectivity connectivity;
+    connectivity.addChunk(a.get());
+    connectivity.addChunk(b.get());
+    connectivity.addChunk(c.get());
+    connectivity.addChunk(empty.get());
+
+    CHECK(connectivity.chunkCount() == 4);
+    CHECK(connectivity.stationCount() == 7);
+
+    CHECK(connectivity.isConnected(a.get(), a.get()));
+    CHECK(connectivity.isConnected(a.get(), b.get()));
+    CHECK(!connectivity.isConnected(a.get(), c.get()));
+    CHECK(!connectivity.isConnected(a.get(), empty.get()));
+    CHECK(!connectivity.isConnected(empty.get(), empty.get()));
+    CHECK(!connectivity.isConnected(a.get(), d.get())); //Not added
+
+    SECTION("Adding a chunk joins the chunks") {
+        connectivity.addChunk(d.get());
+        CHECK(connectivity.contains(d.get()));
+        CHECK(connectivity.isConnected(a.get(), c.get()));
+        CHECK(connectivity.isConnected(c.get(), d.get()));
+
+        SECTION("Removing a chunk splits the chunks") {
+            connectivity.removeChunk(d.get());
+            CHECK(!connectivity.contains(d.get()));
+            CHECK(!connectivity.isConnected(a.get(), c.get()));
+            CHECK(connectivity.isConnected(a.get(), b.get()));
+        }
+
+        SECTION("Editing a chunk updates the connections") {
+            d->setData(cwSurveyChunk::StationNameRole, 1, "x1");
+            connectivity.updateChunk(d.get());
+            CHECK(!connectivity.isConnected(a.get(), c.get()));
+            CHECK(connectivity.isConnected(a.get(), d.get()));
+
+            d->setData(cwSurveyChunk::StationNameRole, 1, "C2");
+            connectivity.updateChunk(d.get());
+            CHECK(connectivity.isConnected(a.get(), c.get()));
+        }
+    }
+
+    SECTION("Clear removes everything") {
+        connectivity.clear();
+        CHECK(connectivity.chunkCount() == 0);
+        CHECK(connectivity.stationCount() == 0);
+        CHECK(!connectivity.isConnected(a.get(), b.get()));
+    }
+}
+
+TEST_CASE("Benchmark cwFindUnconnectedSurveyChunksTask", "[cwSurveyChunkConnectivity][.benchmark]") {
+    //A long passage of chunks, each tied into the last, and a few floating chunks
+    const int numberOfChunks = 4000;
+    const int shotsPerChunk = 8;
+
+    auto cave = std::make_unique<cwCave>();
+    cwTrip* trip = new cwTrip();
+    cave->addTrip(trip);
+
+    QList<cwSurveyChunk*> chunks;
+    int lastStation = 0;
+    for(int c = 0; c < numberOfChunks; c++) {
+        QStringList names;
+        bool floating = c % 500 == 499;
+        for(int s = 0; s <= shotsPerChunk; s++) {
+            names.append(floating ? QString("f%1_%2").arg(c).arg(s) : QString("s%1").arg(lastStation + s));
+        }
+        if(!floating) {
+            lastStation += shotsPerChunk;
+        }
+
+        cwSurveyChunk* chunk = createChunk(names);
+        trip->addChunk(chunk);
+        chunks.append(chunk);
+    }
+
+    const int expectedUnconnected = numberOfChunks / 500;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    cwFindUnconnectedSurveyChunksTask task;
+    task.setUsingThreadPool(false);
+    task.setCave(cave.get());
+    task.start();
+    qint64 taskTime = timer.nsecsElapsed();
+    CHECK(task.results().size() == expectedUnconnected);
+
+    //The pairwise comparison that the task used to do
+    timer.restart();
+    QList<QSet<QString>> stationSets;
+    for(cwSurveyChunk* chunk : chunks) {
+        QSet<QString> names;
+        for(int i = 0; i < chunk->stationCount(); i++) {
+            names.insert(chunk->station(i).name().toUpper());
+        }
+        stationSets.append(names);
+    }
+
+    QVector<QList<int>> connectedTo(chunks.size());
+    for(int i = 0; i < chunks.size(); i++) {
+        for(int j = 0; j < chunks.size(); j++) {
+            if(i != j && stationSets.at(i).intersects(stationSets.at(j))) {
+                connectedTo[i].append(j);
+            }
+        }
+    }
+
+    QSet<int> connected;
+    QList<int> toVisit({0});
+    while(!toVisit.isEmpty()) {
+        int current = toVisit.takeLast();
+        if(!connected.contains(current)) {
+            connected.insert(current);
+            toVisit.append(connectedTo.at(current));
+        }
+    }
+    qint64 pairwiseTime = timer.nsecsElapsed();
+    CHECK(chunks.size() - connected.size() == expectedUnconnected);
+
+    //Editing one chunk
+    cwSurveyChunkConnectivity connectivity;
+    for(cwSurveyChunk* chunk : chunks) {
+        connectivity.addChunk(chunk);
+    }
+
+    timer.restart();
+    cwSurveyChunk* edited = chunks.at(499);
+    edited->setData(cwSurveyChunk::StationNameRole, 0, "s0");
+    connectivity.updateChunk(edited);
+    bool editConnected = connectivity.isConnected(chunks.first(), edited);
+    qint64 incrementalTime = timer.nsecsElapsed();
+    CHECK(editConnected);
+
+    WARN("Chunks:" << numberOfChunks << " stations:" << connectivity.stationCount());
+    WARN("cwFindUnconnectedSurveyChunksTask: " << taskTime * 1e-6 << "ms");
+    WARN("Pairwise: " << pairwiseTime * 1e-6 << "ms");
+    WARN("Incremental edit: " << incrementalTime * 1e-6 << "ms");
+}
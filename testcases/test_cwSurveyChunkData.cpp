@@ -0,0 +1,190 @@
+//Catch includes
+#include "catch.hpp"
+
+//Our includes
+#include "cwSurveyChunkData.h"
+#include "cwSurveyChunk.h"
+#include "TestHelper.h"
+
+//Qt includes
+#include <QElapsedTimer>
+
+TEST_CASE("cwSurveyChunkData should store stations and shots in columns", "[cwSurveyChunkData]") {
+    cwStation a1("a1");
+    a1.setLeft(1.5);
+    a1.setRight("2");
+    a1.setUp(3.0);
+
+    cwStation a2("a2");
+
+    cwShot shot("10.5", "45", "225", "down", "");
+    shot.setDistanceIncluded(false);
+
+    cwSurveyChunkData data;
+    data.appendStation(a1);
+    data.appendStation(a2);
+    data.appendShot(shot);
+
+    REQUIRE(data.stationCount() == 2);
+    REQUIRE(data.shotCount() == 1);
+
+    CHECK(data.stationNames() == QVector<QString>({"a1", "a2"}));
+    CHECK(data.lefts().at(0) == 1.5);
+    CHECK(data.rights().at(0) == 2.0);
+    CHECK(data.ups().at(0) == 3.0);
+    CHECK(data.downStates().at(0) == cwDistanceStates::Empty);
+    CHECK(data.leftStates().at(1) == cwDistanceStates::Empty);
+
+    CHECK(data.distances().at(0) == 10.5);
+    CHECK(data.compasses().at(0) == 45.0);
+    CHECK(data.backCompasses().at(0) == 225.0);
+    CHECK(data.clinoStates().at(0) == cwClinoStates::Down);
+    CHECK(data.backClinoStates().at(0) == cwClinoStates::Empty);
+    CHECK(data.distancesIncluded().at(0) == false);
+
+    SECTION("Stations and shots are rebuilt from the columns") {
+        cwStation station = data.station(0);
+        CHECK(station.name() == "a1");
+        CHECK(station.left() == 1.5);
+        CHECK(station.leftInputState() == cwDistanceStates::Valid);
+        CHECK(station.right() == 2.0);
+        CHECK(station.up() == 3.0);
+        CHECK(station.downInputState() == cwDistanceStates::Empty);
+
+        cwShot newShot = data.shot(0);
+        CHECK(newShot.distance() == 10.5);
+        CHECK(newShot.distanceState() == cwDistanceStates::Valid);
+        CHECK(newShot.compass() == 45.0);
+        CHECK(newShot.backCompass() == 225.0);
+        CHECK(newShot.clinoState() == cwClinoStates::Down);
+        CHECK(newShot.backClinoState() == cwClinoStates::Empty);
+        CHECK(newShot.isDistanceIncluded() == false);
+    }
+
+    SECTION("Insert, set and remove keep the columns aligned") {
+        data.insertStation(1, cwStation("b1"));
+        data.insertShot(0, cwShot("20", "90", "", "0", ""));
+
+        CHECK(data.stationNames() == QVector<QString>({"a1", "b1", "a2"}));
+        CHECK(data.lefts().size() == 3);
+        CHECK(data.downStates().size() == 3);
+        CHECK(data.distances() == QVector<double>({20.0, 10.5}));
+        CHECK(data.distancesIncluded() == QVector<bool>({true, false}));
+        CHECK(data.backClinos().size() == 2);
+
+        cwStation station = data.station(2);
+        station.setDown(4.0);
+        data.setStation(2, station);
+        CHECK(data.downs().at(2) == 4.0);
+        CHECK(data.downStates().at(2) == cwDistanceStates::Valid);
+
+        data.removeStations(0, 2);
+        data.removeShots(0);
+        CHECK(data.stationNames() == QVector<QString>({"a2"}));
+        CHECK(data.downs() == QVector<double>({4.0}));
+        CHECK(data.distances() == QVector<double>({10.5}));
+        CHECK(data.clinoStates() == QVector<cwClinoStates::State>({cwClinoStates::Down}));
+
+        data.clear();
+        CHECK(data.stationCount() == 0);
+        CHECK(data.shotCount() == 0);
+        CHECK(data.upStates().isEmpty());
+        CHECK(data.compassStates().isEmpty());
+    }
+}
+
+TEST_CASE("cwSurveyChunk survey data should match the chunk's stations and shots", "[cwSurveyChunkData]") {
+    cwSurveyChunk chunk;
+    for(int i = 0; i < 4; i++) {
+        chunk.appendShot(cwStation(QString("a%1").arg(i)),
+                         cwStation(QString("a%1").arg(i + 1)),
+                         cwShot(QString::number(i + 1), "0", "180", "0", "0"));
+    }
+
+    auto checkSurveyData = [](const cwSurveyChunk& chunk) {
+        const cwSurveyChunkData& data = chunk.surveyData();
+        REQUIRE(data.stationCount() == chunk.stationCount());
+        REQUIRE(data.shotCount() == chunk.shotCount());
+
+        for(int i = 0; i < chunk.stationCount(); i++) {
+            INFO("Station:" << i);
+            CHECK(data.stationNames().at(i) == chunk.station(i).name());
+            CHECK(data.lefts().at(i) == chunk.station(i).left());
+            CHECK(data.leftStates().at(i) == chunk.station(i).leftInputState());
+        }
+
+        for(int i = 0; i < chunk.shotCount(); i++) {
+            INFO("Shot:" << i);
+            CHECK(data.distances().at(i) == chunk.shot(i).distance());
+            CHECK(data.distanceStates().at(i) == chunk.shot(i).distanceState());
+            CHECK(data.compassStates().at(i) == chunk.shot(i).compassState());
+        }
+    };
+
+    checkSurveyData(chunk);
+    CHECK(chunk.surveyData().distances() == QVector<double>({1.0, 2.0, 3.0, 4.0}));
+
+    chunk.setData(cwSurveyChunk::StationLeftRole, 2, QString("5.5"));
+    chunk.setData(cwSurveyChunk::ShotCompassRole, 1, QString());
+    CHECK(chunk.surveyData().lefts().at(2) == 5.5);
+    CHECK(chunk.surveyData().compassStates().at(1) == cwCompassStates::Empty);
+    checkSurveyData(chunk);
+
+    chunk.insertShot(1, cwSurveyChunk::Above);
+    CHECK(chunk.surveyData().stationNames().at(2).isEmpty());
+    CHECK(chunk.surveyData().distanceStates().at(1) == cwDistanceStates::Empty);
+    checkSurveyData(chunk);
+
+    chunk.removeStation(2, cwSurveyChunk::Above);
+    CHECK(chunk.surveyData().distances() == QVector<double>({1.0, 2.0, 3.0, 4.0}));
+    checkSurveyData(chunk);
+
+    cwSurveyChunk copy(chunk);
+    checkSurveyData(copy);
+    CHECK(copy.surveyData().lefts().at(2) == 5.5);
+
+    cwSurveyChunk* newChunk = chunk.splitAtStation(2);
+    REQUIRE(newChunk != nullptr);
+    CHECK(newChunk->surveyData().stationNames().at(1) == "a2");
+    checkSurveyData(chunk);
+    checkSurveyData(*newChunk);
+    delete newChunk;
+}
+
+TEST_CASE("Benchmark reading survey data columns", "[cwSurveyChunkData][.benchmark]") {
+    const int numberOfShots = 100000;
+
+    cwSurveyChunk chunk;
+    for(int i = 0; i < numberOfShots; i++) {
+        chunk.appendShot(cwStation(QString("a%1").arg(i)),
+                         cwStation(QString("a%1").arg(i + 1)),
+                         cwShot("10", "0", "180", "0", "0"));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    double shotsLength = 0.0;
+    foreach(cwShot shot, chunk.shots()) {
+        if(shot.distanceState() == cwDistanceStates::Valid && shot.isDistanceIncluded()) {
+            shotsLength += shot.distance();
+        }
+    }
+    qint64 shotsTime = timer.nsecsElapsed();
+
+    timer.restart();
+    double columnsLength = 0.0;
+    const cwSurveyChunkData& data = chunk.surveyData();
+    for(int i = 0; i < data.shotCount(); i++) {
+        if(data.distanceStates().at(i) == cwDistanceStates::Valid && data.distancesIncluded().at(i)) {
+            columnsLength += data.distances().at(i);
+        }
+    }
+    qint64 columnsTime = timer.nsecsElapsed();
+
+    CHECK(shotsLength == columnsLength);
+    CHECK(columnsLength == numberOfShots * 10.0);
+
+    WARN("Shots:" << numberOfShots);
+    WARN("shots(): " << shotsTime * 1e-6 << "ms");
+    WARN("surveyData(): " << columnsTime * 1e-6 << "ms");
+}
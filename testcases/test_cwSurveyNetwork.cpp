@@ -7,6 +7,7 @@
 //Qt include
 #include <QStringList>
 #include <QSet>
+#include <QElapsedTimer>
 
 TEST_CASE("cwSurveyNetwork should compare changedStation correctly", "[cwSurveyNetwork]") {
     cwSurveyNetwork n1;
@@ -53,3 +54,124 @@ TEST_CASE("cwSurveyNetwork should compare changedStation correctly", "[cwSurveyN
         CHECK(networkSet == testSet);
     }
 }
+
+TEST_CASE("cwSurveyNetwork should intern stations and iterate neighbor ids", "[cwSurveyNetwork]") {
+    cwSurveyNetwork network;
+    CHECK(network.isEmpty());
+    CHECK(network.neighborIds(0).isEmpty());
+
+    network.addShot("a1", "a2");
+    network.addShot("A1", "a3");
+    network.addShot("a2", "A1"); //Already added
+    network.addShot("a3", "");
+
+    CHECK(network.stationCount() == 3);
+    CHECK(network.shotCount() == 2);
+    CHECK(network.stations() == QStringList({"A1", "A2", "A3"}));
+
+    CHECK(network.stationId("a1") == 0);
+    CHECK(network.stationId("A3") == 2);
+    CHECK(network.stationId("a4") == -1);
+    CHECK(network.stationName(1) == "A2");
+
+    QVector<int> neighborIds;
+    for(int id : network.neighborIds(network.stationId("a1"))) {
+        neighborIds.append(id);
+    }
+    CHECK(neighborIds == QVector<int>({1, 2}));
+    CHECK(network.neighborIds(-1).isEmpty());
+    CHECK(network.neighborIds(3).isEmpty());
+
+    CHECK(network.neighbors("a1") == QStringList({"A2", "A3"}));
+    CHECK(network.neighbors("a2") == QStringList({"A1"}));
+    CHECK(network.neighbors("a4").isEmpty());
+
+    SECTION("Modifying a copy doesn't change the original") {
+        cwSurveyNetwork copy = network;
+        copy.addShot("a2", "a3");
+        CHECK(copy.neighbors("a2") == QStringList({"A1", "A3"}));
+        CHECK(network.neighbors("a2") == QStringList({"A1"}));
+        CHECK(copy != network);
+    }
+
+    SECTION("Equality doesn't depend on the order shots are added") {
+        cwSurveyNetwork other;
+        other.addShot("a3", "a1");
+        other.addShot("a2", "a1");
+        CHECK(other == network);
+        CHECK(cwSurveyNetwork::changedStations(other, network).isEmpty());
+    }
+}
+
+TEST_CASE("cwSurveyNetwork should find connected components", "[cwSurveyNetwork]") {
+    cwSurveyNetwork network;
+
+    int count = -1;
+    CHECK(network.connectedComponents(&count).isEmpty());
+    CHECK(count == 0);
+
+    network.addShot("a1", "a2");
+    network.addShot("b1", "b2");
+    network.addShot("a2", "a3");
+    network.addShot("c1", "c1");
+    network.addShot("b3", "b2");
+
+    CHECK(network.connectedComponents(&count) == QVector<int>({0, 0, 1, 1, 0, 2, 1}));
+    CHECK(count == 3);
+
+    network.addShot("a3", "b3");
+    CHECK(network.connectedComponents(&count) == QVector<int>({0, 0, 0, 0, 0, 1, 0}));
+    CHECK(count == 2);
+}
+
+TEST_CASE("Benchmark cwSurveyNetwork", "[cwSurveyNetwork][.benchmark]") {
+    //A long passage with a loop every 10 stations, similar to a large cave
+    const int numberOfStations = 100000;
+
+    QStringList names;
+    names.reserve(numberOfStations);
+    for(int i = 0; i < numberOfStations; i++) {
+        names.append(QString("A%1").arg(i));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    cwSurveyNetwork network;
+    for(int i = 1; i < numberOfStations; i++) {
+        network.addShot(names.at(i - 1), names.at(i));
+        if(i % 10 == 0) {
+            network.addShot(names.at(i), names.at(i / 2));
+        }
+    }
+    qint64 buildTime = timer.nsecsElapsed();
+
+    timer.restart();
+    qint64 degreeSum = 0;
+    for(int id = 0; id < network.stationCount(); id++) {
+        degreeSum += network.neighborIds(id).size();
+    }
+    qint64 iterateTime = timer.nsecsElapsed();
+    CHECK(degreeSum == network.shotCount() * 2);
+
+    cwSurveyNetwork changed = network;
+    changed.addShot(names.at(5), names.last());
+
+    timer.restart();
+    QStringList changedStations = cwSurveyNetwork::changedStations(network, changed);
+    qint64 diffTime = timer.nsecsElapsed();
+    CHECK(changedStations == QStringList({names.at(5).toUpper(), names.last().toUpper()}));
+
+    timer.restart();
+    int count = 0;
+    network.connectedComponents(&count);
+    qint64 componentTime = timer.nsecsElapsed();
+    CHECK(count == 1);
+
+    WARN("Stations:" << network.stationCount()
+         << " shots:" << network.shotCount()
+         << " build:" << buildTime * 1e-6 << "ms"
+         << " iterate neighbors:" << iterateTime * 1e-6 << "ms"
+         << " changedStations:" << diffTime * 1e-6 << "ms"
+         << " connectedComponents:" << componentTime * 1e-6 << "ms");
+}
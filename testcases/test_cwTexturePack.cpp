@@ -0,0 +1,322 @@
+//Catch includes
+#include "catch.hpp"
+
+//Our includes
+#include "TestHelper.h"
+#include "cwTexturePack.h"
+#include "cwTextureUploadTask.h"
+#include "cwImageProvider.h"
+#include "cwImageDatabase.h"
+#include "cwProject.h"
+#include "cwCave.h"
+#include "cwTrip.h"
+#include "cwCavingRegion.h"
+#include "cwSurveyNoteModel.h"
+#include "cwNote.h"
+#include "cwAsyncFuture.h"
+
+//Qt includes
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QFile>
+#include <QFileInfo>
+
+namespace {
+
+QByteArray randomDxt1Data(QSize size, quint32 seed)
+{
+    int blocks = qMax(1, (size.width() + 3) / 4) * qMax(1, (size.height() + 3) / 4);
+    QByteArray data(blocks * 8, 0);
+    QRandomGenerator generator(seed);
+    for(char& byte : data) {
+        //Only a couple of bits change, so zlib has something to compress, like real DXT1 data
+        byte = static_cast<char>(generator.bounded(4));
+    }
+    return data;
+}
+
+QList<int> addMipmapChain(const QString& filename, int firstLevelSize, quint32 seed)
+{
+    QList<int> ids;
+    cwImageDatabase database(filename);
+    for(int size = firstLevelSize; size >= 1; size /= 2) {
+        QSize levelSize(size, size);
+        ids.append(database.addImage(cwImageProvider::createDxt1(levelSize, randomDxt1Data(levelSize, seed + size))));
+    }
+    return ids;
+}
+
+}
+
+TEST_CASE("cwTexturePack should hold the project's DXT1 mipmaps", "[cwTexturePack]") {
+    cwProject project;
+    QString filename = project.filename();
+    cwTexturePack::invalidate(filename);
+
+    QList<int> ids = addMipmapChain(filename, 256, 0);
+    int originalId = cwImageDatabase(filename).addImage(cwImageData(QSize(10, 10), 0, "png", QByteArray(100, 'a')));
+
+    CHECK(cwTexturePack::packFilename(filename) == filename + "tex");
+    CHECK(cwTexturePack::packFilename(QString()).isEmpty());
+
+    SECTION("There's no pack until it's converted") {
+        cwTexturePack pack(filename);
+        CHECK(!pack.isOpen());
+        CHECK(pack.count() == 0);
+        CHECK(pack.level(ids.first()).first.isEmpty());
+    }
+
+    SECTION("Converted levels match the project") {
+        REQUIRE(cwTexturePack::convert(filename));
+
+        cwTexturePack pack(filename);
+        REQUIRE(pack.isOpen());
+        CHECK(pack.count() == ids.size());
+        CHECK(!pack.contains(originalId));
+
+        cwImageProvider provider;
+        provider.setProjectPath(filename);
+
+        for(int id : ids) {
+            INFO("id:" << id);
+            cwImageData imageData = provider.data(id);
+            auto level = pack.level(id);
+            CHECK(level.first == imageData.data());
+            CHECK(level.second == imageData.size());
+
+            //Each level is page aligned in the file
+            CHECK((level.first.constData() - pack.level(ids.first()).first.constData()) % cwTexturePack::PageSize == 0);
+        }
+    }
+
+    SECTION("Updating an image invalidates the pack") {
+        REQUIRE(cwTexturePack::convert(filename));
+
+        cwImageDatabase database(filename);
+        QSize size(256, 256);
+        database.updateImage(cwImageProvider::createDxt1(size, randomDxt1Data(size, 10)), ids.first());
+
+        CHECK(!QFile::exists(cwTexturePack::packFilename(filename)));
+        CHECK(!cwTexturePack(filename).isOpen());
+    }
+
+    SECTION("Removing an image invalidates the pack") {
+        REQUIRE(cwTexturePack::convert(filename));
+
+        cwImageDatabase(filename).removeImages({ids.last()});
+        CHECK(!cwTexturePack(filename).isOpen());
+    }
+
+    SECTION("Packs are shared until they're replaced") {
+        auto noPack = cwTexturePack::shared(filename);
+        CHECK(!noPack->isOpen());
+        CHECK(cwTexturePack::shared(filename) == noPack);
+
+        REQUIRE(cwTexturePack::convert(filename));
+        auto pack = cwTexturePack::shared(filename);
+        CHECK(pack != noPack);
+        CHECK(pack->isOpen());
+        CHECK(cwTexturePack::shared(filename) == pack);
+
+        cwTexturePack::invalidate(filename);
+        CHECK(cwTexturePack::shared(filename) != pack);
+        CHECK(!cwTexturePack::shared(filename)->isOpen());
+
+        //The old pack is still mapped for readers that have it
+        CHECK(pack->level(ids.first()).second == QSize(256, 256));
+    }
+
+    SECTION("Update converts the pack when it's missing mipmaps") {
+        REQUIRE(cwTexturePack::update(filename));
+        auto pack = cwTexturePack::shared(filename);
+        REQUIRE(pack->isOpen());
+        CHECK(pack->count() == ids.size());
+
+        //Up to date packs aren't converted again
+        REQUIRE(cwTexturePack::update(filename));
+        CHECK(cwTexturePack::shared(filename) == pack);
+
+        QList<int> newIds = addMipmapChain(filename, 64, 20);
+        REQUIRE(cwTexturePack::update(filename));
+        auto newPack = cwTexturePack::shared(filename);
+        CHECK(newPack != pack);
+        CHECK(newPack->count() == ids.size() + newIds.size());
+        CHECK(newPack->contains(newIds.first()));
+    }
+
+    SECTION("Update appends the missing mipmaps without moving the old ones") {
+        REQUIRE(cwTexturePack::convert(filename));
+        auto pack = cwTexturePack::shared(filename);
+        REQUIRE(pack->isOpen());
+        qint64 oldSize = QFileInfo(cwTexturePack::packFilename(filename)).size();
+
+        QList<int> newIds = addMipmapChain(filename, 64, 20);
+        REQUIRE(cwTexturePack::update(filename));
+        CHECK(QFileInfo(cwTexturePack::packFilename(filename)).size() > oldSize);
+
+        auto newPack = cwTexturePack::shared(filename);
+        REQUIRE(newPack->isOpen());
+        CHECK(newPack->count() == ids.size() + newIds.size());
+
+        cwImageProvider provider;
+        provider.setProjectPath(filename);
+        for(int id : ids + newIds) {
+            INFO("id:" << id);
+            CHECK(newPack->level(id).first == provider.data(id).data());
+        }
+
+        //The old pack is still mapped, and it's levels weren't overwritten
+        for(int id : ids) {
+            INFO("id:" << id);
+            CHECK(pack->level(id).first == provider.data(id).data());
+        }
+    }
+
+    SECTION("Packs that don't match the project aren't opened") {
+        cwProject otherProject;
+        QString otherFilename = otherProject.filename();
+        addMipmapChain(otherFilename, 128, 5);
+        REQUIRE(cwTexturePack::convert(otherFilename));
+        REQUIRE(cwTexturePack(otherFilename).isOpen());
+
+        QFile::remove(cwTexturePack::packFilename(filename));
+        REQUIRE(QFile::copy(cwTexturePack::packFilename(otherFilename), cwTexturePack::packFilename(filename)));
+        CHECK(!cwTexturePack(filename).isOpen());
+
+        cwTexturePack::invalidate(otherFilename);
+    }
+
+    SECTION("Truncated packs aren't opened") {
+        REQUIRE(cwTexturePack::convert(filename));
+
+        QFile file(cwTexturePack::packFilename(filename));
+        REQUIRE(file.open(QIODevice::ReadWrite));
+        REQUIRE(file.resize(file.size() - 8));
+        file.close();
+
+        CHECK(!cwTexturePack(filename).isOpen());
+    }
+
+    cwTexturePack::invalidate(filename);
+}
+
+TEST_CASE("cwTextureUploadTask should load mipmaps from the texture pack", "[cwTexturePack]") {
+    auto project = fileToProject("://datasets/test_cwTextureUploadTask/cwTextureUploadTask.cw");
+    cwTexturePack::invalidate(project->filename());
+
+    REQUIRE(project->cavingRegion()->caveCount() == 1);
+    REQUIRE(project->cavingRegion()->cave(0)->tripCount() == 1);
+    auto trip = project->cavingRegion()->cave(0)->trip(0);
+    REQUIRE(trip->notes()->notes().size() == 1);
+    auto note = trip->notes()->notes().first();
+
+    auto upload = [&]() {
+        cwTextureUploadTask task;
+        task.setImage(note->image());
+        task.setProjectFilename(project->filename());
+        task.setType(cwTextureUploadTask::DXT1Mipmaps);
+        auto future = task.mipmaps();
+        cwAsyncFuture::waitForFinished(future);
+        REQUIRE(future.resultCount() == 1);
+        return future.result();
+    };
+
+    auto fromProject = upload();
+    CHECK(fromProject.pack.isNull());
+    REQUIRE(fromProject.mipmaps.size() == 10);
+
+    REQUIRE(cwTexturePack::convert(project->filename()));
+
+    auto fromPack = upload();
+    CHECK(!fromPack.pack.isNull());
+    CHECK(fromPack.type == cwTextureUploadTask::DXT1Mipmaps);
+    CHECK(fromPack.scaleTexCoords == fromProject.scaleTexCoords);
+    REQUIRE(fromPack.mipmaps.size() == fromProject.mipmaps.size());
+    for(int i = 0; i < fromPack.mipmaps.size(); i++) {
+        INFO("i:" << i);
+        CHECK(fromPack.mipmaps.at(i).first == fromProject.mipmaps.at(i).first);
+        CHECK(fromPack.mipmaps.at(i).second == fromProject.mipmaps.at(i).second);
+    }
+
+    cwTexturePack::invalidate(project->filename());
+}
+
+TEST_CASE("cwProject should update the texture pack when it's saved", "[cwTexturePack]") {
+    auto project = fileToProject("://datasets/test_cwTextureUploadTask/cwTextureUploadTask.cw");
+    auto note = project->cavingRegion()->cave(0)->trip(0)->notes()->notes().first();
+
+    QString filename = prependTempFolder("test_cwTexturePack-save.cw");
+    QFile::remove(filename);
+    cwTexturePack::invalidate(filename);
+
+    project->saveAs(filename);
+    project->waitSaveToFinish();
+
+    auto pack = cwTexturePack::shared(filename);
+    REQUIRE(pack->isOpen());
+    REQUIRE(!note->image().mipmaps().isEmpty());
+    for(int id : note->image().mipmaps()) {
+        INFO("id:" << id);
+        CHECK(pack->contains(id));
+    }
+
+    pack.clear();
+    cwTexturePack::invalidate(filename);
+}
+
+TEST_CASE("Benchmark cwTexturePack mipmap loading", "[cwTexturePack][.benchmark]") {
+    cwProject project;
+    QString filename = project.filename();
+
+    const int numberOfImages = 20;
+    QList<QList<int>> chains;
+    for(int i = 0; i < numberOfImages; i++) {
+        chains.append(addMipmapChain(filename, 2048, static_cast<quint32>(i) * 10000));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    REQUIRE(cwTexturePack::convert(filename));
+    qint64 convertTime = timer.nsecsElapsed();
+
+    //Sum every byte, like the driver does when it copies the upload
+    auto checksum = [](const QByteArray& data) {
+        quint64 sum = 0;
+        for(char byte : data) {
+            sum += static_cast<uchar>(byte);
+        }
+        return sum;
+    };
+
+    cwImageProvider provider;
+    provider.setProjectPath(filename);
+
+    timer.restart();
+    quint64 projectSum = 0;
+    for(const auto& chain : chains) {
+        for(const cwImageData& imageData : provider.data(chain)) {
+            projectSum += checksum(imageData.data());
+        }
+    }
+    qint64 projectTime = timer.nsecsElapsed();
+
+    timer.restart();
+    quint64 packSum = 0;
+    for(const auto& chain : chains) {
+        cwTexturePack pack(filename);
+        for(int id : chain) {
+            packSum += checksum(pack.level(id).first);
+        }
+    }
+    qint64 packTime = timer.nsecsElapsed();
+
+    CHECK(projectSum == packSum);
+
+    WARN("Images:" << numberOfImages << " (2048x2048 mipmap chains)"
+         << " convert:" << convertTime * 1e-6 << "ms"
+         << " project load:" << projectTime * 1e-6 << "ms"
+         << " pack load:" << packTime * 1e-6 << "ms"
+         << " speedup:" << projectTime / static_cast<double>(packTime) << "x");
+
+    cwTexturePack::invalidate(filename);
+}
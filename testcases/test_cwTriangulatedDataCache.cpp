@@ -0,0 +1,169 @@
+//Catch includes
+#include "catch.hpp"
+
+//Our includes
+#include "cwTriangulatedDataCache.h"
+#include "cwTriangulateInData.h"
+#include "cwImageDatabase.h"
+#include "cwProject.h"
+
+namespace {
+
+cwTriangulateInData createInData()
+{
+    cwImage noteImage;
+    noteImage.setOriginal(1);
+    noteImage.setIcon(2);
+    noteImage.setMipmaps({3, 4});
+    noteImage.setOriginalSize(QSize(1024, 768));
+    noteImage.setOriginalDotsPerMeter(3000);
+
+    cwTriangulateStation station;
+    station.setName("a1");
+    station.setNotePosition(QPointF(0.25, 0.5));
+    station.setPosition(QVector3D(1.0, 2.0, 3.0));
+
+    cwTriangulateInData data;
+    data.setNoteImage(noteImage);
+    data.setNoteImageResolution(3000.0);
+    data.setOutline(QPolygonF({QPointF(0.0, 0.0), QPointF(1.0, 0.0), QPointF(1.0, 1.0)}));
+    data.setStations({station});
+    data.setType(cwScrap::Plan);
+    return data;
+}
+
+cwTriangulatedData createTriangulatedData(const cwImage& croppedImage)
+{
+    cwTriangulatedData data;
+    data.setCroppedImage(cwTrackedImage::createShared(croppedImage, QString(), cwTrackedImage::NoOwnership));
+    data.setPoints({QVector3D(0.0, 0.0, 0.0), QVector3D(1.0, 0.0, 0.0), QVector3D(1.0, 1.0, 0.0)});
+    data.setTexCoords({QVector2D(0.0, 0.0), QVector2D(1.0, 0.0), QVector2D(1.0, 1.0)});
+    data.setIndices({0, 1, 2});
+    data.setLeadPoints({QVector3D(0.5, 0.5, 0.0)});
+    return data;
+}
+
+void checkEqual(const cwTriangulatedData& data, const cwTriangulatedData& expected)
+{
+    CHECK(data.croppedImage() == expected.croppedImage());
+    CHECK(data.points() == expected.points());
+    CHECK(data.texCoords() == expected.texCoords());
+    CHECK(data.indices() == expected.indices());
+    CHECK(data.leadPoints() == expected.leadPoints());
+    CHECK(!data.isStale());
+}
+
+}
+
+TEST_CASE("cwTriangulateInData hash should only change when the input changes", "[cwTriangulatedDataCache]") {
+    cwTriangulateInData data = createInData();
+    QByteArray hash = data.hash();
+
+    CHECK(!hash.isEmpty());
+    CHECK(createInData().hash() == hash);
+
+    cwTriangulateInData changed = createInData();
+
+    SECTION("Outline") {
+        QPolygonF outline = changed.outline();
+        outline[1] = QPointF(1.0, 0.001);
+        changed.setOutline(outline);
+    }
+
+    SECTION("Station position") {
+        auto stations = changed.stations();
+        stations[0].setPosition(QVector3D(1.0, 2.0, 3.01));
+        changed.setStations(stations);
+    }
+
+    SECTION("Station note position") {
+        auto stations = changed.stations();
+        stations[0].setNotePosition(QPointF(0.25, 0.51));
+        changed.setStations(stations);
+    }
+
+    SECTION("Note image") {
+        cwImage image = changed.noteImage();
+        image.setMipmaps({3, 5});
+        changed.setNoteImage(image);
+    }
+
+    SECTION("Resolution") {
+        changed.setNoteImageResolution(3001.0);
+    }
+
+    SECTION("Type") {
+        changed.setType(cwScrap::RunningProfile);
+    }
+
+    SECTION("Leads") {
+        cwLead lead;
+        lead.setPositionOnNote(QPointF(0.5, 0.5));
+        changed.setLeads({lead});
+    }
+
+    CHECK(changed.hash() != hash);
+}
+
+TEST_CASE("cwTriangulatedDataCache should store triangulated data by hash", "[cwTriangulatedDataCache]") {
+    cwProject project;
+    QString filename = project.filename();
+
+    //The cropped image needs to be in the database for the cache entry to be valid
+    int croppedId = cwImageDatabase(filename).addImage(cwImageData(QSize(4, 4), 0, "png", QByteArray(16, 'a')));
+    REQUIRE(croppedId > 0);
+
+    cwImage croppedImage;
+    croppedImage.setOriginal(croppedId);
+    croppedImage.setOriginalSize(QSize(4, 4));
+
+    cwTriangulatedData data = createTriangulatedData(croppedImage);
+    QByteArray hash = createInData().hash();
+
+    cwTriangulatedDataCache cache(filename);
+    CHECK(cache.count() == 0);
+    CHECK(cache.find(hash, cwTextureUploadTask::OpenGL_RGBA).isNull());
+
+    cache.insert(hash, cwTextureUploadTask::OpenGL_RGBA, data);
+    CHECK(cache.count() == 1);
+
+    checkEqual(cache.find(hash, cwTextureUploadTask::OpenGL_RGBA), data);
+
+    SECTION("Different formats are cached separately") {
+        CHECK(cache.find(hash, cwTextureUploadTask::DXT1Mipmaps).isNull());
+    }
+
+    SECTION("Inserting the same hash replaces the data") {
+        cwTriangulatedData other = createTriangulatedData(croppedImage);
+        other.setIndices({2, 1, 0});
+        cache.insert(hash, cwTextureUploadTask::OpenGL_RGBA, other);
+        CHECK(cache.count() == 1);
+        checkEqual(cache.find(hash, cwTextureUploadTask::OpenGL_RGBA), other);
+    }
+
+    SECTION("Missing cropped images are a miss") {
+        cwImageDatabase(filename).removeImage(croppedImage);
+        CHECK(cache.find(hash, cwTextureUploadTask::OpenGL_RGBA).isNull());
+    }
+
+    SECTION("Removing cropped images removes their entries") {
+        cache.removeCroppedImages({croppedImage});
+        CHECK(cache.count() == 0);
+        CHECK(cache.find(hash, cwTextureUploadTask::OpenGL_RGBA).isNull());
+    }
+}
+
+TEST_CASE("cwTriangulatedDataCache should serialize triangulated data", "[cwTriangulatedDataCache]") {
+    cwImage croppedImage;
+    croppedImage.setOriginal(10);
+    croppedImage.setIcon(11);
+    croppedImage.setMipmaps({12, 13, 14});
+    croppedImage.setOriginalSize(QSize(64, 32));
+    croppedImage.setOriginalDotsPerMeter(2000);
+
+    cwTriangulatedData data = createTriangulatedData(croppedImage);
+    QByteArray bytes = cwTriangulatedDataCache::toByteArray(data);
+
+    checkEqual(cwTriangulatedDataCache::fromByteArray(bytes, QString()), data);
+    CHECK(cwTriangulatedDataCache::fromByteArray(bytes.left(bytes.size() / 2), QString()).isNull());
+}